@@ -0,0 +1,165 @@
+/**
+ * @file bench_coro.cpp
+ * @brief Many-device orchestration on hal_coro.hpp: one coroutine per device,
+ *        no thread per wait.
+ *
+ * Each "device" is straight-line code: connect, then loop
+ * PRESS / GETLED / RELEASE with an optional think time (timer await).
+ *  - default: every device gets an in-process peer over a socketpair that
+ *    answers like gpio_daemon, so thousands of devices can run;
+ *  - -s sock: devices talk to a running gpio_daemon instead (the daemon
+ *    accepts a limited number of clients, see MAX_CLIENTS there).
+ *
+ * Before the run, -S rounds of ExecutorPool Start(RUN_UNTIL_STOP) + Stop() +
+ * Join() with no task: a Stop() that lands before a worker enters Run() must
+ * not be lost (a watchdog fails the bench if a round hangs).
+ *
+ * Usage:
+ *   bench_coro [-n devices] [-i iterations] [-z think_ms] [-P threads] [-S rounds] [-s sock]
+ */
+#include "bench_hist.h"
+#include "hal_coro.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace coro = hal::coro;
+
+struct Shard {           /* one per executor: no sharing between threads */
+    BenchHist hist;
+    uint64_t  errors = 0;
+    uint64_t  done   = 0;
+};
+
+/* In-process stand-in for gpio_daemon: one line in, one line out. */
+static coro::Task<void> PeerDevice(int fd) {
+    coro::LineSocket s(fd);
+    char line[128];
+    unsigned led = 0;
+    for (;;) {
+        long n = co_await s.ReadLine(line, sizeof line);
+        if (n < 0) break;
+        if (!strncmp(line, "PRESS ", 6))        led |= 1u << (atoi(line + 6) & 3);
+        else if (!strncmp(line, "RELEASE ", 8)) led &= ~(1u << (atoi(line + 8) & 3));
+        char reply[64];
+        snprintf(reply, sizeof reply, "LED %u %u %u %u", led & 1, (led >> 1) & 1, (led >> 2) & 1, (led >> 3) & 1);
+        if (co_await s.WriteLine(reply) < 0) break;
+    }
+}
+
+static coro::Task<void> HostDevice(int id, int fd, const char* sock, int iters, uint32_t think_ms, Shard* sh) {
+    coro::LineSocket s(fd);
+    if (fd < 0 && co_await s.Open(sock, 2000) < 0) { sh->errors++; co_return; }
+
+    static const char* const kOps[3] = { "PRESS %d", "GETLED", "RELEASE %d" };
+    char cmd[32], reply[64];
+    for (int i = 0; i < iters; ++i) {
+        snprintf(cmd, sizeof cmd, kOps[i % 3], id & 3);
+        uint64_t t0 = coro::detail::NowNs();
+        long r = co_await s.Request(cmd, reply, sizeof reply, 1000);
+        if (r < 0) { sh->errors++; break; }
+        BenchHist_Record(&sh->hist, coro::detail::NowNs() - t0);
+        sh->done++;
+        if (think_ms) co_await coro::Sleep(think_ms);
+    }
+}
+
+static void usage(const char* p) {
+    fprintf(stderr, "usage: %s [-n devices] [-i iterations] [-z think_ms] [-P threads] [-S rounds] [-s sock]\n", p);
+}
+
+/* Start + Stop ngay + Join, lặp lại; Stop() thường tới trước khi thread vào Run(). */
+static int StartStopRounds(int rounds, unsigned threads) {
+    std::atomic<int> done{0};
+    std::thread watchdog([&done, rounds] {
+        for (int t = 0; t < 2000 && done.load() < rounds; ++t)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        if (done.load() < rounds) {
+            printf("start/stop: hung in round %d of %d\n", done.load() + 1, rounds);
+            fflush(stdout);
+            _exit(1);
+        }
+    });
+    uint64_t t0 = coro::detail::NowNs();
+    for (int r = 0; r < rounds; ++r) {
+        coro::ExecutorPool p(threads);
+        p.Start(coro::Executor::RUN_UNTIL_STOP, false);
+        p.Stop();
+        p.Join();
+        done.fetch_add(1);
+    }
+    watchdog.join();
+    printf("start/stop: %d rounds x %u threads ok, %.1f us/round\n", rounds, threads,
+           (double)(coro::detail::NowNs() - t0) / 1e3 / rounds);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int devices = 1000, iters = 300, threads = 1, rounds = 200;
+    uint32_t think_ms = 0;
+    const char* sock = NULL;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:i:z:P:S:s:h")) != -1) {
+        switch (c) {
+        case 'n': devices  = atoi(optarg); break;
+        case 'i': iters    = atoi(optarg); break;
+        case 'z': think_ms = (uint32_t)atoi(optarg); break;
+        case 'P': threads  = atoi(optarg); break;
+        case 'S': rounds   = atoi(optarg); break;
+        case 's': sock     = optarg; break;
+        default:  usage(argv[0]); return c == 'h' ? 0 : 2;
+        }
+    }
+    if (devices < 1 || iters < 1 || threads < 1 || rounds < 0) { usage(argv[0]); return 2; }
+    if (rounds) StartStopRounds(rounds, threads > 1 ? (unsigned)threads : 4u);
+
+    coro::ExecutorPool pool((unsigned)threads);
+    std::unique_ptr<Shard[]> shards(new Shard[threads]);
+    for (int t = 0; t < threads; ++t) BenchHist_Reset(&shards[t].hist);
+
+    for (int i = 0; i < devices; ++i) {
+        const unsigned e = (unsigned)(i % threads);
+        int fd = -1;
+        if (!sock) {
+            int sv[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0) {
+                perror("socketpair");
+                return 1;
+            }
+            pool.Spawn(e, PeerDevice(sv[1]));
+            fd = sv[0];
+        }
+        pool.Spawn(e, HostDevice(i, fd, sock, iters, think_ms, &shards[e]));
+    }
+
+    /* peers exit when their host closes the socket, so "idle" = all done */
+    uint64_t t0 = coro::detail::NowNs();
+    pool.Start(coro::Executor::RUN_UNTIL_IDLE);
+    pool.Join();
+    double secs = (double)(coro::detail::NowNs() - t0) / 1e9;
+
+    BenchHist all;
+    BenchHist_Reset(&all);
+    uint64_t done = 0, errors = 0;
+    for (int t = 0; t < threads; ++t) {
+        BenchHist_Merge(&all, &shards[t].hist);
+        done   += shards[t].done;
+        errors += shards[t].errors;
+    }
+    printf("devices=%d threads=%d target=%s think=%ums\n", devices, threads, sock ? sock : "socketpair", think_ms);
+    printf("requests=%llu errors=%llu elapsed=%.3fs rate=%.0f req/s\n",
+           (unsigned long long)done, (unsigned long long)errors, secs, secs > 0 ? (double)done / secs : 0.0);
+    BenchHist_PrintSummary(stdout, "rtt", &all, 1000.0, "us");
+    return errors ? 1 : 0;
+}
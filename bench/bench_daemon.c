@@ -0,0 +1,439 @@
+/**
+ * @file bench_daemon.c
+ * @brief Load generator / latency benchmark for the gpio_daemon socket protocol.
+ *
+ * Opens N connections to the daemon UNIX socket and issues a weighted mix of
+ * PRESS / RELEASE / GETLED commands, either:
+ *  - open loop  (--rate R): requests are scheduled at a fixed aggregate rate,
+ *    latency is measured from the *scheduled* send time, so a stalled daemon
+ *    is charged for the queueing it causes (coordinated-omission corrected);
+ *  - closed loop (default): every connection keeps --depth requests in
+ *    flight and sends the next one as soon as a reply arrives.
+ *
+ * With -x the same closed-loop mix is sent over the shared-memory command
+ * ring instead (gpio_shm.h, negotiated with "SHM" on the socket); depth may
+ * then go up to GPIO_SHM_CPL_SLOTS.
+ *
+ * Output: throughput and p50/p90/p99/p999/max latency per command and total.
+ *
+ * Usage:
+ *   bench_daemon [-s sock] [-c conns] [-d depth] [-r rate] [-t secs]
+ *                [-w warmup_secs] [-m press:release:getled] [-x] [-j]
+ */
+#define _GNU_SOURCE
+#include "bench_hist.h"
+#include "gpio_shm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define DEFAULT_SOCK   "/tmp/gpio_sim.sock"
+#define MAX_CONNS      64
+#define MAX_DEPTH      256
+#define STALL_TIMEOUT_NS (2000ull * 1000000ull)
+
+typedef enum { OP_PRESS = 0, OP_RELEASE, OP_GETLED, OP_COUNT } BenchOp;
+static const char* const s_op_name[OP_COUNT] = { "PRESS", "RELEASE", "GETLED" };
+
+typedef struct {
+    uint64_t start_ns;   /* scheduled (open loop) or actual (closed loop) send time */
+    uint8_t  op;
+} InFlight;
+
+typedef struct {
+    int      fd;
+    InFlight q[MAX_DEPTH];   /* FIFO: daemon replies in order */
+    unsigned head, count;
+    uint64_t next_send_ns;   /* open loop schedule */
+    uint64_t last_rx_ns;
+    uint64_t last_tx_ns;     /* lần gửi cuối (thật, không phải lịch) */
+    char     rx[1024];
+    size_t   rx_len;
+    char     tx[8192];
+    size_t   tx_len;
+} Conn;
+
+typedef struct {
+    const char* sock_path;
+    int         conns;
+    int         depth;
+    double      rate;        /* req/s aggregate, 0 = closed loop */
+    double      secs;
+    double      warmup;
+    unsigned    mix[OP_COUNT];
+    int         json;
+    int         shm;         /* -x: shared-memory ring instead of socket text */
+} BenchArgs;
+
+static BenchHist s_hist[OP_COUNT];
+static uint64_t  s_errors;
+static uint64_t  s_done;
+
+static uint64_t _now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Có lệnh đang bay mà không gửi / nhận gì trong STALL_TIMEOUT_NS. Tính từ mốc
+ * muộn hơn của lần gửi và lần nhận cuối: open loop rate thấp thì khoảng cách
+ * giữa hai lần gửi có thể gần bằng timeout mà daemon vẫn khoẻ. */
+static int _stalled(int in_flight, uint64_t now, uint64_t last_tx_ns, uint64_t last_rx_ns) {
+    uint64_t last = (last_tx_ns > last_rx_ns) ? last_tx_ns : last_rx_ns;
+    return in_flight && now > last && now - last > STALL_TIMEOUT_NS;
+}
+
+/* xorshift: cheap and good enough to pick ops */
+static uint32_t s_rng = 0x12345678u;
+static uint32_t _rand32(void) {
+    uint32_t x = s_rng;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return s_rng = x;
+}
+
+static BenchOp _pick_op(const BenchArgs* a) {
+    unsigned total = a->mix[0] + a->mix[1] + a->mix[2];
+    unsigned r = _rand32() % total;
+    if (r < a->mix[0]) return OP_PRESS;
+    if (r < a->mix[0] + a->mix[1]) return OP_RELEASE;
+    return OP_GETLED;
+}
+
+static int _connect(const char* path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+static void _enqueue(Conn* c, const BenchArgs* a, uint64_t start_ns) {
+    BenchOp op = _pick_op(a);
+    char cmd[32];
+    int n;
+    if (op == OP_GETLED) n = snprintf(cmd, sizeof(cmd), "GETLED\n");
+    else                 n = snprintf(cmd, sizeof(cmd), "%s %u\n", s_op_name[op], _rand32() & 1u);
+    if (c->tx_len + (size_t)n > sizeof(c->tx)) return;
+    memcpy(c->tx + c->tx_len, cmd, (size_t)n);
+    c->tx_len += (size_t)n;
+
+    unsigned tail = (c->head + c->count) % MAX_DEPTH;
+    c->q[tail].start_ns = start_ns;
+    c->q[tail].op       = (uint8_t)op;
+    c->count++;
+}
+
+static int _flush(Conn* c) {
+    while (c->tx_len) {
+        ssize_t w = write(c->fd, c->tx, c->tx_len);
+        if (w < 0) {
+            if (errno == EAGAIN || errno == EINTR) return 0;
+            return -1;
+        }
+        memmove(c->tx, c->tx + w, c->tx_len - (size_t)w);
+        c->tx_len -= (size_t)w;
+    }
+    return 0;
+}
+
+static int _drain(Conn* c, uint64_t now, int recording) {
+    for (;;) {
+        ssize_t n = read(c->fd, c->rx + c->rx_len, sizeof(c->rx) - c->rx_len);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EINTR) break;
+            return -1;
+        }
+        if (n == 0) return -1;
+        c->rx_len += (size_t)n;
+        c->last_rx_ns = now;
+
+        char* p = c->rx;
+        char* nl;
+        while ((nl = memchr(p, '\n', c->rx_len - (size_t)(p - c->rx))) != NULL) {
+            if (!c->count) return -1;  /* reply without request: protocol broken */
+            InFlight* f = &c->q[c->head];
+            if (recording) {
+                BenchHist_Record(&s_hist[f->op], now - f->start_ns);
+                s_done++;
+                if (strncmp(p, "ERR", 3) == 0) s_errors++;
+            }
+            c->head = (c->head + 1) % MAX_DEPTH;
+            c->count--;
+            p = nl + 1;
+        }
+        size_t rest = c->rx_len - (size_t)(p - c->rx);
+        memmove(c->rx, p, rest);
+        c->rx_len = rest;
+    }
+    return 0;
+}
+
+/* ---- -x: shared-memory transport, closed loop ---- */
+
+typedef struct {
+    GpioShmClient* cl;
+    uint32_t       seq;                         /* tag của lệnh kế tiếp */
+    uint64_t       start_ns[GPIO_SHM_CPL_SLOTS];  /* theo tag % slots */
+    uint8_t        op[GPIO_SHM_CPL_SLOTS];
+    uint64_t       last_rx_ns;
+    uint64_t       last_tx_ns;
+} ShmConn;
+
+static const GpioShmOp s_shm_op[OP_COUNT] = { GPIO_SHM_OP_PRESS, GPIO_SHM_OP_RELEASE, GPIO_SHM_OP_GETLED };
+
+static int _shm_collect(ShmConn* c, const GpioShmCpl* cpl, int n, uint64_t now, uint64_t t_record) {
+    for (int k = 0; k < n; ++k) {
+        uint32_t i = cpl[k].tag % GPIO_SHM_CPL_SLOTS;
+        if (c->start_ns[i] >= t_record) {
+            BenchHist_Record(&s_hist[c->op[i]], now - c->start_ns[i]);
+            s_done++;
+            if (cpl[k].status) s_errors++;
+        }
+    }
+    if (n) c->last_rx_ns = now;
+    return n;
+}
+
+/* *t_stop = lúc vòng đo thật sự dừng (sớm hơn t_end nếu stall) */
+static int _run_shm(const BenchArgs* a, uint64_t t_begin, uint64_t t_record, uint64_t t_end, uint64_t* t_stop) {
+    static ShmConn conns[MAX_CONNS];
+    for (int i = 0; i < a->conns; ++i) {
+        memset(&conns[i], 0, sizeof(conns[i]));
+        conns[i].cl = GpioShmClient_Connect(a->sock_path);
+        if (!conns[i].cl) {
+            fprintf(stderr, "[BENCH] shm attach %s failed (conn %d)\n", a->sock_path, i);
+            return -1;
+        }
+        conns[i].last_rx_ns = t_begin;
+        conns[i].last_tx_ns = t_begin;
+    }
+
+    GpioShmCpl cpl[256];
+    int stalled = 0;
+    uint64_t now = t_begin;
+    while (now < t_end && !stalled) {
+        int got = 0;
+        for (int i = 0; i < a->conns; ++i) {
+            ShmConn* c = &conns[i];
+            now = _now_ns();
+            while (GpioShmClient_InFlight(c->cl) < (uint32_t)a->depth) {
+                BenchOp op = _pick_op(a);
+                uint32_t k = c->seq % GPIO_SHM_CPL_SLOTS;
+                c->start_ns[k] = now;
+                c->op[k]       = (uint8_t)op;
+                if (GpioShmClient_Submit(c->cl, s_shm_op[op], (uint8_t)(_rand32() & 1u), c->seq) != 0) break;
+                c->seq++;
+                c->last_tx_ns = now;
+            }
+            int n = GpioShmClient_Poll(c->cl, cpl, 256);
+            if (n) { now = _now_ns(); got += _shm_collect(c, cpl, n, now, t_record); }
+            if (_stalled(GpioShmClient_InFlight(c->cl) != 0, now, c->last_tx_ns, c->last_rx_ns)) stalled = 1;
+        }
+        if (!got) {
+            /* không có gì về: ngủ trên doorbell của conn đầu tiên còn lệnh đang bay */
+            for (int i = 0; i < a->conns; ++i) {
+                if (!GpioShmClient_InFlight(conns[i].cl)) continue;
+                int n = GpioShmClient_Wait(conns[i].cl, cpl, 256, 10);
+                if (n < 0) { fprintf(stderr, "[BENCH] shm wait failed on conn %d\n", i); return -1; }
+                _shm_collect(&conns[i], cpl, n, _now_ns(), t_record);
+                break;
+            }
+        }
+        now = _now_ns();
+    }
+    *t_stop = now;
+    if (stalled)
+        fprintf(stderr, "[BENCH] no completion for %.1f s, daemon stalled or dropped commands\n",
+                STALL_TIMEOUT_NS / 1e9);
+    for (int i = 0; i < a->conns; ++i) GpioShmClient_Close(conns[i].cl);
+    return stalled;
+}
+
+static void _usage(const char* prog) {
+    fprintf(stderr,
+        "usage: %s [-s sock] [-c conns] [-d depth] [-r rate] [-t secs] [-w warmup] [-m p:r:g] [-x] [-j]\n"
+        "  -s  socket path (default %s)\n"
+        "  -c  number of connections (1..%d, default 1)\n"
+        "  -d  pipelining depth per connection (1..%d, -x: 1..%u, default 1)\n"
+        "  -r  open-loop aggregate rate in req/s (default 0 = closed loop)\n"
+        "  -t  measured duration in seconds (default 5)\n"
+        "  -w  warmup seconds, not recorded (default 1)\n"
+        "  -m  weights PRESS:RELEASE:GETLED (default 1:1:2)\n"
+        "  -x  shared-memory command ring instead of socket text (closed loop only)\n"
+        "  -j  print JSON instead of text\n",
+        prog, DEFAULT_SOCK, MAX_CONNS, MAX_DEPTH, GPIO_SHM_CPL_SLOTS);
+}
+
+static int _parse_args(int argc, char** argv, BenchArgs* a) {
+    a->sock_path = DEFAULT_SOCK;
+    a->conns = 1; a->depth = 1; a->rate = 0.0;
+    a->secs = 5.0; a->warmup = 1.0;
+    a->mix[0] = 1; a->mix[1] = 1; a->mix[2] = 2;
+    a->json = 0;
+    a->shm = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:c:d:r:t:w:m:xjh")) != -1) {
+        switch (opt) {
+            case 's': a->sock_path = optarg; break;
+            case 'c': a->conns  = atoi(optarg); break;
+            case 'd': a->depth  = atoi(optarg); break;
+            case 'r': a->rate   = atof(optarg); break;
+            case 't': a->secs   = atof(optarg); break;
+            case 'w': a->warmup = atof(optarg); break;
+            case 'm':
+                if (sscanf(optarg, "%u:%u:%u", &a->mix[0], &a->mix[1], &a->mix[2]) != 3) return -1;
+                break;
+            case 'x': a->shm  = 1; break;
+            case 'j': a->json = 1; break;
+            default: return -1;
+        }
+    }
+    if (a->conns < 1 || a->conns > MAX_CONNS) return -1;
+    if (a->depth < 1 || a->depth > (a->shm ? (int)GPIO_SHM_CPL_SLOTS : MAX_DEPTH)) return -1;
+    if (a->shm && a->rate > 0.0) return -1;
+    if (a->secs <= 0.0 || a->warmup < 0.0 || a->rate < 0.0) return -1;
+    if (a->mix[0] + a->mix[1] + a->mix[2] == 0) return -1;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    BenchArgs a;
+    if (_parse_args(argc, argv, &a) != 0) {
+        _usage(argv[0]);
+        return 2;
+    }
+
+    static Conn conns[MAX_CONNS];
+    struct pollfd pfds[MAX_CONNS];
+    for (int i = 0; i < a.conns && !a.shm; ++i) {
+        memset(&conns[i], 0, sizeof(conns[i]));
+        conns[i].fd = _connect(a.sock_path);
+        if (conns[i].fd < 0) {
+            fprintf(stderr, "[BENCH] connect %s failed (conn %d): %s\n", a.sock_path, i, strerror(errno));
+            return 1;
+        }
+    }
+    for (int i = 0; i < OP_COUNT; ++i) BenchHist_Reset(&s_hist[i]);
+
+    /* Open loop: each connection gets rate/conns, phases staggered. */
+    const uint64_t per_conn_ns = (a.rate > 0.0) ? (uint64_t)(1e9 * a.conns / a.rate) : 0;
+    const uint64_t t_begin   = _now_ns();
+    const uint64_t t_record  = t_begin + (uint64_t)(a.warmup * 1e9);
+    const uint64_t t_end     = t_record + (uint64_t)(a.secs * 1e9);
+    for (int i = 0; i < a.conns; ++i) {
+        conns[i].next_send_ns = t_begin + (per_conn_ns * (uint64_t)i) / (uint64_t)a.conns;
+        conns[i].last_rx_ns   = t_begin;
+        conns[i].last_tx_ns   = t_begin;
+    }
+
+    int stalled = 0;
+    uint64_t t_stop = t_end;
+    if (a.shm) {
+        stalled = _run_shm(&a, t_begin, t_record, t_end, &t_stop);
+        if (stalled < 0) return 1;
+    }
+    uint64_t now = a.shm ? t_end : t_begin;
+    while (now < t_end) {
+        int recording = (now >= t_record);
+        uint64_t next_wake = t_end;
+
+        for (int i = 0; i < a.conns; ++i) {
+            Conn* c = &conns[i];
+            unsigned queued = c->count;
+            if (per_conn_ns) {
+                /* issue everything that is due; keep the schedule even when
+                 * the pipe is full so queueing delay is charged to the daemon */
+                while (c->next_send_ns <= now && c->count < (unsigned)a.depth) {
+                    _enqueue(c, &a, c->next_send_ns);
+                    c->next_send_ns += per_conn_ns;
+                }
+                if (c->count < (unsigned)a.depth && c->next_send_ns < next_wake)
+                    next_wake = c->next_send_ns;
+            } else {
+                while (c->count < (unsigned)a.depth) _enqueue(c, &a, now);
+            }
+            if (c->count != queued) c->last_tx_ns = now;
+            if (_flush(c) < 0) { fprintf(stderr, "[BENCH] write failed on conn %d\n", i); return 1; }
+            if (_stalled(c->count != 0, now, c->last_tx_ns, c->last_rx_ns)) stalled = 1;
+
+            pfds[i].fd      = c->fd;
+            pfds[i].events  = POLLIN | (c->tx_len ? POLLOUT : 0);
+            pfds[i].revents = 0;
+        }
+        if (stalled) {
+            fprintf(stderr, "[BENCH] no reply for %.1f s, daemon stalled or dropped commands\n",
+                    STALL_TIMEOUT_NS / 1e9);
+            t_stop = now;
+            break;
+        }
+
+        /* ppoll: ns timeout so the open-loop schedule is not rounded to ms */
+        uint64_t wait_ns = (next_wake > now) ? next_wake - now : 0;
+        if (wait_ns > 100000000ull) wait_ns = 100000000ull;
+        struct timespec tmo = { (time_t)(wait_ns / 1000000000ull), (long)(wait_ns % 1000000000ull) };
+        int rv = ppoll(pfds, (nfds_t)a.conns, &tmo, NULL);
+        if (rv < 0 && errno != EINTR) { perror("poll"); return 1; }
+
+        now = _now_ns();
+        for (int i = 0; i < a.conns && rv > 0; ++i) {
+            if (!(pfds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            if (_drain(&conns[i], now, recording && conns[i].q[conns[i].head].start_ns >= t_record) < 0) {
+                fprintf(stderr, "[BENCH] connection %d closed / protocol error\n", i);
+                return 1;
+            }
+        }
+    }
+
+    BenchHist all;
+    BenchHist_Reset(&all);
+    for (int i = 0; i < OP_COUNT; ++i) BenchHist_Merge(&all, &s_hist[i]);
+    /* chia cho thời gian đo thật: stall làm vòng đo dừng trước t_end */
+    double elapsed = (t_stop > t_record) ? (double)((t_stop < t_end ? t_stop : t_end) - t_record) / 1e9 : 0.0;
+    double tput = (elapsed > 0.0) ? (double)s_done / elapsed : 0.0;
+
+    if (a.json) {
+        printf("{\"shm\":%d,\"conns\":%d,\"depth\":%d,\"rate\":%.1f,\"secs\":%.2f,\"elapsed\":%.3f,"
+               "\"completed\":%llu,\"errors\":%llu,\"stalled\":%d,\"throughput\":%.1f,\"latency_ns\":{",
+               a.shm, a.conns, a.depth, a.rate, a.secs, elapsed, (unsigned long long)s_done,
+               (unsigned long long)s_errors, stalled, tput);
+        for (int i = 0; i < OP_COUNT; ++i) {
+            printf("\"%s\":", s_op_name[i]);
+            BenchHist_PrintJson(stdout, &s_hist[i]);
+            printf(",");
+        }
+        printf("\"ALL\":");
+        BenchHist_PrintJson(stdout, &all);
+        printf("}}\n");
+    } else {
+        printf("=== bench-daemon: %s%s, %d conn(s), depth %d, %s ===\n",
+               a.sock_path, a.shm ? " (shm)" : "", a.conns, a.depth, (a.rate > 0.0) ? "open loop" : "closed loop");
+        if (a.rate > 0.0) printf("target rate : %.1f req/s\n", a.rate);
+        printf("completed   : %llu in %.2f s (%llu ERR)%s\n",
+               (unsigned long long)s_done, elapsed, (unsigned long long)s_errors,
+               stalled ? " [STALLED]" : "");
+        printf("throughput  : %.1f req/s\n", tput);
+        for (int i = 0; i < OP_COUNT; ++i) BenchHist_PrintSummary(stdout, s_op_name[i], &s_hist[i], 1000.0, "us");
+        BenchHist_PrintSummary(stdout, "ALL", &all, 1000.0, "us");
+    }
+
+    for (int i = 0; i < a.conns && !a.shm; ++i) close(conns[i].fd);
+    return stalled ? 1 : 0;
+}
@@ -0,0 +1,406 @@
+/**
+ * @file bench_debounce.c
+ * @brief Correctness + CPU cost of the repo's debouncers against simulated
+ *        contact bounce, threshold chatter and glitches (hal_gpio_sim.h).
+ *
+ * A seeded stimulus (press, hold, release, idle, ...) is played on a sim line
+ * with a signal shape, on the sim's virtual timeline (no sleeping). Each
+ * debouncer gets its own pass over the identical waveform (same shape seed):
+ *
+ *  - integrate : GpioDemoCore_Tick itself (gpio_daemon logic), called every
+ *                -P ms: a level must read the same for debounce_ms before it
+ *                is taken (BTN0 of a GpioDemoCore instance on the sim chip)
+ *  - shift8    : poll every 1 ms, level taken after 8 equal samples
+ *  - lockout   : HAL soft debounce (debounce_ms on the line request): the
+ *                first edge wins, edges within debounce_ms after it dropped;
+ *                the app trusts the edge type
+ *  - settle    : DemoGpio_SettleStep, the GpioTask event-mode debouncer:
+ *                every edge pushes a deadline = t_edge + debounce_ms, read the
+ *                level when it expires
+ *
+ * For every intended transition the first output change to the right level
+ * counts as detected (latency = output time - transition time); any other
+ * output change is a leaked spurious edge; a transition with no detection
+ * before the next one is missed. CPU cost is the pass time minus a pass with
+ * no debouncer (stimulus + sim only), per simulated second; a debouncer
+ * cheaper than the timing noise of that difference is reported as n/a.
+ *
+ * Usage:
+ *   bench_debounce [-p preset] [-n transitions] [-d debounce_ms] [-P poll_ms]
+ *                  [-H min:max] [-I min:max] [-b min:max] [-G min:max] [-e]
+ *                  [-S slow_us:chatter] [-g hz:min_us:max_us] [-t step_us]
+ *                  [-s seed] [-j]
+ */
+#define _GNU_SOURCE
+#include "bench_hist.h"
+#include "bench_util.h"
+
+#include "demo_gpio_hal.h"
+#include "gpio_demo_core.h"
+#include "hal_gpio.h"
+#include "hal_gpio_sim.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_OFF 0
+/* integrate: các line khác của GpioDemoCore (không có stimulus) */
+#define CORE_LED_OFF  1
+#define CORE_BTN1_OFF 2
+
+typedef enum { DB_NONE = 0, DB_INTEGRATE, DB_SHIFT8, DB_LOCKOUT, DB_SETTLE, DB_COUNT } DbKind;
+static const char* const s_db_name[DB_COUNT] = { "none", "integrate", "shift8", "lockout", "settle" };
+
+typedef struct {
+    const char*      preset;
+    HAL_GpioSimShape shape;
+    int              transitions;
+    int              debounce_ms;
+    int              poll_ms;
+    unsigned         hold_min_ms, hold_max_ms;
+    unsigned         idle_min_ms, idle_max_ms;
+    unsigned         step_us;
+    uint32_t         seed;
+    int              json;
+} DbArgs;
+
+typedef struct {
+    uint64_t  detected, missed, leaked;
+    uint64_t  calls;             /* debouncer invocations (polls / events / deadline checks) */
+    uint64_t  pass_ns;
+    BenchHist lat;               /* ns, intended transition -> output */
+    HAL_GpioSimStats sim;
+} DbResult;
+
+/* ---- stimulus: alternating press/release times in µs ---- */
+
+static uint32_t s_rng;
+static uint32_t _rand32(void) {
+    uint32_t x = s_rng;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return s_rng = x;
+}
+
+static unsigned _between(unsigned lo, unsigned hi) {
+    return (hi <= lo) ? lo : lo + _rand32() % (hi - lo + 1u);
+}
+
+static uint64_t* _make_stimulus(const DbArgs* a) {
+    uint64_t* t = malloc(sizeof(uint64_t) * (size_t)(a->transitions + 1));
+    if (!t) return NULL;
+    s_rng = a->seed ? a->seed : 1u;
+    uint64_t now = 10000;                           /* 10 ms settle at start */
+    for (int i = 0; i < a->transitions; ++i) {
+        t[i] = now;
+        unsigned ms = (i & 1) ? _between(a->idle_min_ms, a->idle_max_ms)
+                              : _between(a->hold_min_ms, a->hold_max_ms);
+        now += (uint64_t)ms * 1000u;
+    }
+    t[a->transitions] = now;                        /* end of the last window */
+    return t;
+}
+
+/* ---- accounting ---- */
+
+typedef struct {
+    const uint64_t* t;
+    int             n;
+    int             win;          /* current window = last transition <= now */
+    int             got;          /* window already detected */
+    DbResult*       r;
+} Acct;
+
+static void _acct_advance(Acct* ac, uint64_t now_us) {
+    while (ac->win + 1 < ac->n && ac->t[ac->win + 1] <= now_us) {
+        if (ac->win >= 0 && !ac->got) ac->r->missed++;
+        ac->win++;
+        ac->got = 0;
+    }
+}
+
+/* output of a debouncer changed to level at t_us */
+static void _acct_output(Acct* ac, uint64_t t_us, int level) {
+    int expect = (ac->win >= 0) ? !(ac->win & 1) : 0;   /* even transitions = press */
+    if (ac->win >= 0 && level == expect && !ac->got) {
+        ac->got = 1;
+        ac->r->detected++;
+        BenchHist_Record(&ac->r->lat, (t_us - ac->t[ac->win]) * 1000u);
+    } else {
+        ac->r->leaked++;
+    }
+}
+
+/* ---- one pass ---- */
+
+static int _run(DbKind kind, const DbArgs* a, const uint64_t* stim, DbResult* r) {
+    memset(r, 0, sizeof(*r));
+    BenchHist_Reset(&r->lat);
+
+    HAL_GpioChip* chip = NULL;
+    HAL_GpioLine* line = NULL;
+    GpioDemoCore  core;
+    const int     use_core = (kind == DB_INTEGRATE);
+
+    if (use_core) {
+        /* logic daemon nguyên bản: BTN0 = line có stimulus */
+        GpioDemoCoreCfg dc = {
+            .chip_name   = "sim:debounce",
+            .led_count   = 1,
+            .led_offsets = { CORE_LED_OFF },
+            .btn0_offset = LINE_OFF,
+            .btn1_offset = CORE_BTN1_OFF,
+            .debounce_ms = a->debounce_ms,
+        };
+        if (GpioDemoCore_Init(&core, &dc) != 0) return -1;
+        chip = core.chip;
+        line = core.btn[0];
+    } else {
+        HAL_GpioChipConfig cc = { .chip_name = "sim:debounce" };
+        if (HAL_GpioChip_Open(&cc, &chip) != HAL_GPIO_OK) return -1;
+
+        int events = (kind == DB_LOCKOUT || kind == DB_SETTLE);
+        HAL_GpioLineConfig lc = {
+            .offset      = LINE_OFF,
+            .dir         = HAL_GPIO_DIR_IN,
+            .active      = HAL_GPIO_ACTIVE_HIGH,
+            .edge        = events ? HAL_GPIO_EDGE_BOTH : HAL_GPIO_EDGE_NONE,
+            .debounce_ms = (kind == DB_LOCKOUT) ? (uint32_t)a->debounce_ms : 0,
+        };
+        if (HAL_GpioLine_Request(chip, &lc, &line) != HAL_GPIO_OK) {
+            HAL_GpioChip_Close(chip);
+            return -1;
+        }
+    }
+    HAL_GpioSim_UseVirtualTime(chip, 0);
+    if (HAL_GpioSim_SetShape(chip, LINE_OFF, &a->shape) != HAL_GPIO_OK) {
+        if (use_core) GpioDemoCore_Deinit(&core);
+        else { HAL_GpioLine_Release(line); HAL_GpioChip_Close(chip); }
+        return -1;
+    }
+
+    Acct ac = { .t = stim, .n = a->transitions, .win = -1, .got = 0, .r = r };
+    const uint64_t db_us   = (uint64_t)a->debounce_ms * 1000u;
+    const uint64_t poll_us = (uint64_t)a->poll_ms * 1000u;
+    const uint64_t end_us  = stim[a->transitions];
+
+    /* debouncer state */
+    int out = 0;                                 /* debounced level */
+    uint8_t hist = 0;                            /* shift8 */
+    DemoGpioSettle sb;                           /* settle */
+    uint64_t next_poll = 0;
+    if (kind == DB_SETTLE) DemoGpio_SettleInit(&sb, line);
+
+    uint64_t t0 = Bench_NowNs();
+    int next = 0;
+    for (uint64_t now = 0; now < end_us; now += a->step_us) {
+        HAL_GpioSim_Advance(chip, (now == 0) ? 0 : a->step_us);
+        while (next < a->transitions && stim[next] <= now) {
+            HAL_GpioSim_SetInput(chip, LINE_OFF, !(next & 1));
+            next++;
+        }
+        if (kind != DB_NONE) _acct_advance(&ac, now);
+
+        switch (kind) {
+        case DB_NONE:
+            break;
+        case DB_INTEGRATE:
+            if (now >= next_poll) {
+                GpioDemoCore_Tick(&core, a->poll_ms);
+                if (core.stable[0] != out) { out = core.stable[0]; _acct_output(&ac, now, out); }
+                next_poll += poll_us;
+                r->calls++;
+            }
+            break;
+        case DB_SHIFT8:
+            if (now >= next_poll) {
+                int v = 0;
+                HAL_GpioLine_Read(line, &v);
+                hist = (uint8_t)((hist << 1) | (v & 1));
+                if ((hist == 0xFF && !out) || (hist == 0x00 && out)) { out = !out; _acct_output(&ac, now, out); }
+                next_poll += 1000u;
+                r->calls++;
+            }
+            break;
+        case DB_LOCKOUT: {
+            HAL_GpioEvent ev;
+            /* như app thật: rút tới lần ENOENT đầu (event bị debounce cũng trả ENOENT) */
+            while (HAL_GpioLine_WaitEvent(line, 0, &ev) == HAL_GPIO_OK) {
+                int v = (ev.edge == HAL_GPIO_EDGE_RISING);
+                if (v != out) { out = v; _acct_output(&ac, now, out); }
+                r->calls++;
+            }
+            break;
+        }
+        case DB_SETTLE:
+            if (DemoGpio_SettleStep(&sb, now * 1000u, db_us * 1000u, 1)) { out = sb.stable; _acct_output(&ac, now, out); }
+            break;
+        default:
+            break;
+        }
+    }
+    r->pass_ns = Bench_NowNs() - t0;
+    if (kind != DB_NONE) _acct_advance(&ac, end_us);
+    if (kind != DB_NONE && ac.win >= 0 && !ac.got) r->missed++;
+
+    if (kind == DB_SETTLE) r->calls = sb.edges + sb.settles;
+
+    HAL_GpioSim_GetStats(chip, LINE_OFF, &r->sim);
+    if (use_core) {
+        GpioDemoCore_Deinit(&core);
+    } else {
+        HAL_GpioLine_Release(line);
+        HAL_GpioChip_Close(chip);
+    }
+    return 0;
+}
+
+/* CPU ns / sim-s so với pass không debouncer; nhỏ hơn nhiễu đo (âm) -> na */
+static void _cpu_str(char* buf, size_t len, const DbResult* r, const DbResult* none, double sim_s,
+                     const char* fmt, const char* na) {
+    if (r->pass_ns <= none->pass_ns || sim_s <= 0.0) {
+        snprintf(buf, len, "%s", na);
+        return;
+    }
+    snprintf(buf, len, fmt, (double)(r->pass_ns - none->pass_ns) / sim_s);
+}
+
+/* ---- CLI ---- */
+
+static void _usage(const char* prog) {
+    fprintf(stderr,
+        "usage: %s [-p preset] [-n transitions] [-d debounce_ms] [-P poll_ms] [-H min:max] [-I min:max]\n"
+        "          [-b min:max] [-G min:max] [-e] [-S slow_us:chatter] [-g hz:min_us:max_us] [-t step_us] [-s seed] [-j]\n"
+        "  -p  sim shape preset: clean, tactile, worn, noisy, slow (default tactile)\n"
+        "  -n  intended transitions, press+release = 2 (default 20000)\n"
+        "  -d  debounce window in ms (default 5)\n"
+        "  -P  poll period of 'integrate' in ms (default 5, as gpio_daemon)\n"
+        "  -H  hold time range in ms (default 30:300)\n"
+        "  -I  idle time range in ms (default 30:500)\n"
+        "  -b  override bounce count range\n"
+        "  -G  override bounce gap range in us\n"
+        "  -e  exponential bounce gaps (default: preset)\n"
+        "  -S  override slow edge duration (us) and threshold chatter pairs\n"
+        "  -g  override glitch rate and width range\n"
+        "  -t  timeline step in us (default 50)\n"
+        "  -s  seed for stimulus and shape (default 1)\n"
+        "  -j  print JSON instead of text\n",
+        prog);
+}
+
+static int _parse_args(int argc, char** argv, DbArgs* a) {
+    memset(a, 0, sizeof(*a));
+    a->preset = "tactile";
+    a->transitions = 20000;
+    a->debounce_ms = 5;
+    a->poll_ms = 5;
+    a->hold_min_ms = 30;  a->hold_max_ms = 300;
+    a->idle_min_ms = 30;  a->idle_max_ms = 500;
+    a->step_us = 50;
+    a->seed = 1;
+
+    /* preset trước, các override áp lên sau */
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (strcmp(argv[i], "-p") == 0) a->preset = argv[i + 1];
+    }
+    if (HAL_GpioSim_ShapePreset(a->preset, &a->shape) != HAL_GPIO_OK) {
+        fprintf(stderr, "unknown preset '%s'\n", a->preset);
+        return -1;
+    }
+
+    int opt;
+    while ((opt = getopt(argc, argv, "p:n:d:P:H:I:b:G:eS:g:t:s:jh")) != -1) {
+        switch (opt) {
+            case 'p': break;
+            case 'n': a->transitions = atoi(optarg); break;
+            case 'd': a->debounce_ms = atoi(optarg); break;
+            case 'P': a->poll_ms     = atoi(optarg); break;
+            case 'H': if (sscanf(optarg, "%u:%u", &a->hold_min_ms, &a->hold_max_ms) != 2) return -1; break;
+            case 'I': if (sscanf(optarg, "%u:%u", &a->idle_min_ms, &a->idle_max_ms) != 2) return -1; break;
+            case 'b': if (sscanf(optarg, "%d:%d", &a->shape.bounce_min, &a->shape.bounce_max) != 2) return -1; break;
+            case 'G': if (sscanf(optarg, "%u:%u", &a->shape.gap_min_us, &a->shape.gap_max_us) != 2) return -1; break;
+            case 'e': a->shape.gap_dist = HAL_GPIO_SIM_DIST_EXP; break;
+            case 'S': if (sscanf(optarg, "%u:%d", &a->shape.slow_edge_us, &a->shape.slow_chatter) != 2) return -1; break;
+            case 'g':
+                if (sscanf(optarg, "%lf:%u:%u", &a->shape.glitch_hz, &a->shape.glitch_min_us, &a->shape.glitch_max_us) != 3)
+                    return -1;
+                break;
+            case 't': a->step_us = (unsigned)atoi(optarg); break;
+            case 's': a->seed    = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'j': a->json = 1; break;
+            default: return -1;
+        }
+    }
+    a->shape.seed = a->seed * 2654435761u;
+    if (a->transitions < 1 || a->debounce_ms < 1 || a->poll_ms < 1 || a->step_us < 1) return -1;
+    if (a->hold_min_ms > a->hold_max_ms || a->idle_min_ms > a->idle_max_ms) return -1;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    DbArgs a;
+    if (_parse_args(argc, argv, &a) != 0) {
+        _usage(argv[0]);
+        return 2;
+    }
+    uint64_t* stim = _make_stimulus(&a);
+    if (!stim) return 1;
+    const double sim_s = (double)stim[a.transitions] / 1e6;
+
+    static DbResult res[DB_COUNT];
+    for (int k = 0; k < DB_COUNT; ++k) {
+        if (_run((DbKind)k, &a, stim, &res[k]) != 0) {
+            fprintf(stderr, "[BENCH] sim chip / line setup failed\n");
+            free(stim);
+            return 1;
+        }
+    }
+    const HAL_GpioSimStats* st = &res[DB_NONE].sim;
+
+    if (a.json) {
+        printf("{\"preset\":\"%s\",\"transitions\":%d,\"debounce_ms\":%d,\"poll_ms\":%d,\"sim_s\":%.1f,"
+               "\"sim\":{\"edges\":%llu,\"spurious\":%llu,\"glitches\":%llu,\"events_dropped\":%llu},\"debouncers\":{",
+               a.preset, a.transitions, a.debounce_ms, a.poll_ms, sim_s,
+               (unsigned long long)st->edges, (unsigned long long)st->spurious,
+               (unsigned long long)st->glitches, (unsigned long long)res[DB_LOCKOUT].sim.events_dropped);
+        for (int k = DB_INTEGRATE; k < DB_COUNT; ++k) {
+            const DbResult* r = &res[k];
+            char cpu[32];
+            _cpu_str(cpu, sizeof(cpu), r, &res[DB_NONE], sim_s, "%.1f", "null");
+            printf("%s\"%s\":{\"detected\":%llu,\"missed\":%llu,\"leaked\":%llu,\"calls\":%llu,"
+                   "\"cpu_ns_per_sim_s\":%s,\"latency_ns\":",
+                   (k == DB_INTEGRATE) ? "" : ",", s_db_name[k],
+                   (unsigned long long)r->detected, (unsigned long long)r->missed,
+                   (unsigned long long)r->leaked, (unsigned long long)r->calls, cpu);
+            BenchHist_PrintJson(stdout, &r->lat);
+            printf("}");
+        }
+        printf("}}\n");
+    } else {
+        printf("=== bench-debounce: shape '%s', %d transitions, debounce %d ms, %.1f s simulated ===\n",
+               a.preset, a.transitions, a.debounce_ms, sim_s);
+        printf("sim edges   : %llu (%llu spurious, %llu glitches)\n",
+               (unsigned long long)st->edges, (unsigned long long)st->spurious, (unsigned long long)st->glitches);
+        printf("%-10s %9s %7s %7s %10s %12s\n", "debouncer", "detected", "missed", "leaked", "calls", "cpu ns/sim-s");
+        for (int k = DB_INTEGRATE; k < DB_COUNT; ++k) {
+            const DbResult* r = &res[k];
+            char cpu[32];
+            _cpu_str(cpu, sizeof(cpu), r, &res[DB_NONE], sim_s, "%.0f", "n/a");
+            printf("%-10s %9llu %7llu %7llu %10llu %12s\n", s_db_name[k],
+                   (unsigned long long)r->detected, (unsigned long long)r->missed,
+                   (unsigned long long)r->leaked, (unsigned long long)r->calls, cpu);
+        }
+        printf("latency (intended transition -> debounced output):\n");
+        for (int k = DB_INTEGRATE; k < DB_COUNT; ++k) BenchHist_PrintSummary(stdout, s_db_name[k], &res[k].lat, 1000.0, "us");
+        if (res[DB_LOCKOUT].sim.events_dropped)
+            printf("warning: %llu sim events dropped (queue full)\n", (unsigned long long)res[DB_LOCKOUT].sim.events_dropped);
+    }
+    free(stim);
+
+    /* exit 1 nếu debouncer nào bỏ sót hoặc để lọt cạnh: dùng được làm gate trong CI */
+    for (int k = DB_INTEGRATE; k < DB_COUNT; ++k) {
+        if (res[k].missed || res[k].leaked) return 1;
+    }
+    return 0;
+}
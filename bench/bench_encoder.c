@@ -0,0 +1,238 @@
+/**
+ * @file bench_encoder.c
+ * @brief Quadrature decoder throughput and correctness on the sim backend
+ *        (virtual timeline, no sleeping).
+ *
+ * A seeded A/B waveform at a fixed edge rate, with random direction changes
+ * and an index pulse every -c counts, is played on sim lines. Two passes over
+ * the identical waveform:
+ *
+ *  - encoder : BoardEncoder_Poll every -b edges (batched ReadEvents per line,
+ *              merge, table decode)
+ *  - single  : one HAL_GpioLine_WaitEvent per event, alternating lines, the
+ *              pattern a per-line polling task would use (drain cost only)
+ *
+ * The encoder pass must end at the expected position with no illegal or late
+ * transitions; ns/edge is the decode-side CPU time only (stimulus excluded).
+ * A sim event read is a function call, so the two passes cost about the same
+ * here; on uapi/gpiod the batch path is one poll + one read() per line per
+ * batch instead of poll + read per event.
+ *
+ * Usage:
+ *   bench_encoder [-r edge_hz] [-n edges] [-b poll_every] [-c counts_per_index] [-s seed] [-j]
+ */
+#define _GNU_SOURCE
+#include "bench_util.h"
+
+#include "board_encoder.h"
+#include "hal_gpio.h"
+#include "hal_gpio_sim.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LINE_A 0
+#define LINE_B 1
+#define LINE_Z 2
+
+typedef struct {
+    unsigned rate_hz;
+    unsigned edges;
+    unsigned poll_every;
+    unsigned cpi;          /* counts per index pulse */
+    uint32_t seed;
+    int      json;
+} EncArgs;
+
+typedef struct {
+    double   ns_per_edge;
+    uint64_t events;
+    int64_t  pos, expect;
+    double   vel, vel_expect;
+    BoardEncoderStats st;
+} EncResult;
+
+/* chiều thuận: 00 -> 10 -> 11 -> 01 (bit1 = A, bit0 = B) */
+static const uint8_t k_seq[4] = { 0, 2, 3, 1 };
+
+static uint32_t _rng(uint32_t* s) {
+    uint32_t x = *s;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return *s = x;
+}
+
+static uint64_t _sim_now_ns(void* ctx) {
+    return HAL_GpioSim_Now((HAL_GpioChip*)ctx) * 1000ull;
+}
+
+/* dạng sóng A/B + Z trên chip sim, pos = position mong đợi */
+typedef struct {
+    HAL_GpioChip* chip;
+    uint32_t      rng;
+    int           phase;       /* chỉ số trong k_seq */
+    int           dir;         /* +1 / -1 */
+    unsigned      run_left;    /* số cạnh còn lại trước khi đổi chiều */
+    int64_t       pos;
+    unsigned      cpi;
+} Wave;
+
+/* phát cạnh kế tiếp; đổi chiều sau một đoạn ngẫu nhiên */
+static void _wave_step(Wave* w) {
+    if (w->run_left == 0) {
+        w->dir      = (_rng(&w->rng) & 1u) ? 1 : -1;
+        w->run_left = 200u + _rng(&w->rng) % 5000u;
+    }
+    w->run_left--;
+    uint8_t prev = k_seq[w->phase];
+    w->phase = (w->phase + w->dir + 4) & 3;
+    uint8_t next = k_seq[w->phase];
+    if ((prev ^ next) & 2u) HAL_GpioSim_SetInput(w->chip, LINE_A, (next >> 1) & 1);
+    else                    HAL_GpioSim_SetInput(w->chip, LINE_B, next & 1);
+    w->pos += w->dir;
+    /* xung index hẹp ở mỗi cpi count (theo vị trí tuyệt đối) */
+    if (w->cpi && w->dir > 0 && w->pos > 0 && (w->pos % (int64_t)w->cpi) == 0) {
+        HAL_GpioSim_SetInput(w->chip, LINE_Z, 1);
+        HAL_GpioSim_SetInput(w->chip, LINE_Z, 0);
+    }
+}
+
+static int _open_chip(Wave* w, const EncArgs* a) {
+    HAL_GpioChipConfig cc = { .chip_name = "sim:encoder" };
+    if (HAL_GpioChip_Open(&cc, &w->chip) != HAL_GPIO_OK) return -1;
+    HAL_GpioSim_UseVirtualTime(w->chip, 1);
+    w->rng = a->seed ? a->seed : 1u;
+    w->cpi = a->cpi;
+    return 0;
+}
+
+static int _run_encoder(const EncArgs* a, EncResult* r) {
+    Wave w = { 0 };
+    if (_open_chip(&w, a) != 0) return -1;
+    BoardEncoderCfg cfg = {
+        .chip = w.chip, .a_offset = LINE_A, .b_offset = LINE_B, .z_offset = a->cpi ? LINE_Z : -1,
+        .now_ns = _sim_now_ns, .now_ctx = w.chip,
+    };
+    BoardEncoder* enc = NULL;
+    if (BoardEncoder_Open(&cfg, &enc) != 0) { HAL_GpioChip_Close(w.chip); return -1; }
+
+    uint64_t period_us = 1000000ull / a->rate_hz;
+    uint64_t ticks = 0;
+    for (unsigned i = 0; i < a->edges; ++i) {
+        _wave_step(&w);
+        HAL_GpioSim_Advance(w.chip, period_us ? period_us : 1);
+        if ((i + 1) % a->poll_every == 0) {
+            uint64_t t0 = Bench_Ticks();
+            int n = BoardEncoder_Poll(enc, 0);
+            ticks += Bench_Ticks() - t0;
+            if (n > 0) r->events += (uint64_t)n;
+        }
+    }
+    /* vận tốc của đoạn cuối (trước khi dừng) */
+    r->vel        = BoardEncoder_Velocity(enc);
+    r->vel_expect = (double)w.dir * (double)a->rate_hz;
+    HAL_GpioSim_Advance(w.chip, 1000);            /* qua merge guard */
+    uint64_t t0 = Bench_Ticks();
+    int n = BoardEncoder_Poll(enc, 0);
+    ticks += Bench_Ticks() - t0;
+    if (n > 0) r->events += (uint64_t)n;
+
+    r->pos    = BoardEncoder_Position(enc);
+    r->expect = w.pos;
+    BoardEncoder_GetStats(enc, &r->st);
+    r->ns_per_edge = r->st.edges ? (double)Bench_TicksToNs(ticks) / (double)r->st.edges : 0.0;
+    BoardEncoder_Close(enc);
+    HAL_GpioChip_Close(w.chip);
+    return 0;
+}
+
+static int _run_single(const EncArgs* a, EncResult* r) {
+    Wave w = { 0 };
+    if (_open_chip(&w, a) != 0) return -1;
+    HAL_GpioLine* ln[2] = { NULL, NULL };
+    for (int i = 0; i < 2; ++i) {
+        HAL_GpioLineConfig lc = { .offset = i, .dir = HAL_GPIO_DIR_IN, .edge = HAL_GPIO_EDGE_BOTH };
+        if (HAL_GpioLine_Request(w.chip, &lc, &ln[i]) != HAL_GPIO_OK) return -1;
+    }
+    uint64_t period_us = 1000000ull / a->rate_hz;
+    uint64_t ticks = 0;
+    w.cpi = 0;
+    for (unsigned i = 0; i < a->edges; ++i) {
+        _wave_step(&w);
+        HAL_GpioSim_Advance(w.chip, period_us ? period_us : 1);
+        if ((i + 1) % a->poll_every == 0) {
+            uint64_t t0 = Bench_Ticks();
+            HAL_GpioEvent ev;
+            for (int k = 0; k < 2; ++k)
+                while (HAL_GpioLine_WaitEvent(ln[k], 0, &ev) == HAL_GPIO_OK) r->events++;
+            ticks += Bench_Ticks() - t0;
+        }
+    }
+    r->ns_per_edge = r->events ? (double)Bench_TicksToNs(ticks) / (double)r->events : 0.0;
+    for (int i = 0; i < 2; ++i) HAL_GpioLine_Release(ln[i]);
+    HAL_GpioChip_Close(w.chip);
+    return 0;
+}
+
+static void _usage(void) {
+    fprintf(stderr,
+            "usage: bench_encoder [-r edge_hz] [-n edges] [-b poll_every] [-c counts_per_index] [-s seed] [-j]\n"
+            "  -r  edge rate on A+B combined (default 50000, max 1000000)\n"
+            "  -n  edges to play (default 1000000)\n"
+            "  -b  poll the decoder every N edges (default 64, max 200)\n"
+            "  -c  index pulse every N counts, 0 = no Z line (default 4096)\n");
+}
+
+int main(int argc, char** argv) {
+    EncArgs a = { .rate_hz = 50000, .edges = 1000000, .poll_every = 64, .cpi = 4096, .seed = 12345 };
+    int opt;
+    while ((opt = getopt(argc, argv, "r:n:b:c:s:jh")) != -1) {
+        switch (opt) {
+        case 'r': a.rate_hz    = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'n': a.edges      = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'b': a.poll_every = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'c': a.cpi        = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 's': a.seed       = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'j': a.json       = 1; break;
+        default:  _usage(); return 2;
+        }
+    }
+    /* sim giữ 256 event / line: poll trước khi hàng đợi đầy */
+    if (!a.rate_hz || a.rate_hz > 1000000 || !a.edges || !a.poll_every || a.poll_every > 200) {
+        _usage();
+        return 2;
+    }
+    Bench_ClockInit(0);
+
+    EncResult enc = { 0 }, single = { 0 };
+    if (_run_encoder(&a, &enc) != 0 || _run_single(&a, &single) != 0) {
+        fprintf(stderr, "[BENCH] sim chip / encoder setup failed\n");
+        return 1;
+    }
+    int ok = (enc.pos == enc.expect && enc.st.illegal == 0 && enc.st.late == 0);
+
+    if (a.json) {
+        printf("{\"rate_hz\":%u,\"edges\":%u,\"poll_every\":%u,\"ok\":%s,"
+               "\"encoder\":{\"ns_per_edge\":%.1f,\"pos\":%lld,\"expect\":%lld,\"illegal\":%llu,\"late\":%llu,"
+               "\"index\":%llu,\"batches\":%llu,\"max_batch\":%llu,\"vel\":%.0f,\"vel_expect\":%.0f},"
+               "\"single\":{\"ns_per_edge\":%.1f,\"events\":%llu}}\n",
+               a.rate_hz, a.edges, a.poll_every, ok ? "true" : "false",
+               enc.ns_per_edge, (long long)enc.pos, (long long)enc.expect,
+               (unsigned long long)enc.st.illegal, (unsigned long long)enc.st.late,
+               (unsigned long long)enc.st.index, (unsigned long long)enc.st.batches,
+               (unsigned long long)enc.st.max_batch, enc.vel, enc.vel_expect,
+               single.ns_per_edge, (unsigned long long)single.events);
+    } else {
+        printf("=== bench-encoder: %u edges at %u Hz, poll every %u edges ===\n", a.edges, a.rate_hz, a.poll_every);
+        printf("encoder : %7.1f ns/edge  pos %lld (expect %lld)  illegal %llu  late %llu  index %llu\n",
+               enc.ns_per_edge, (long long)enc.pos, (long long)enc.expect,
+               (unsigned long long)enc.st.illegal, (unsigned long long)enc.st.late,
+               (unsigned long long)enc.st.index);
+        printf("          batches %llu (max %llu events)  velocity %.0f count/s (expect %.0f)\n",
+               (unsigned long long)enc.st.batches, (unsigned long long)enc.st.max_batch, enc.vel, enc.vel_expect);
+        printf("single  : %7.1f ns/edge  (WaitEvent per event, drain only, %llu events)\n",
+               single.ns_per_edge, (unsigned long long)single.events);
+        printf("result  : %s\n", ok ? "OK" : "MISMATCH");
+    }
+    return ok ? 0 : 1;
+}
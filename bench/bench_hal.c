@@ -0,0 +1,504 @@
+/**
+ * @file bench_hal.c
+ * @brief HAL microbenchmarks (GPIO / SPI / I2C / UART) for regression tracking.
+ *
+ * Each case runs a warmup loop, then times every call individually and
+ * records it into a histogram (ns). The GPIO backend is whatever the binary
+ * was linked with (makefile_dev: BENCH_GPIO_BACKEND=linux|sim|uapi).
+ *
+ * Cases (skipped when the resource is not given / cannot be opened):
+ *  - gpio.read / gpio.write / gpio.toggle        : single line ops
+ *  - gpio.group_write / gpio.group_read          : HAL_GpioGroup_* over N lines
+ *  - gpio.event_wake                             : write(out) -> WaitEvent(in) returns
+ *                                                  (needs an out->in jumper, or -S:
+ *                                                  gpio-sim pull -> WaitEvent(in); on
+ *                                                  the sim backend out->in is linked;
+ *                                                  skipped after a few timeouts in a row)
+ *  - spi.xfer_<n>                                : HAL_Spi_Transfer of n bytes
+ *  - i2c.readreg8                                : HAL_I2c_ReadReg8 of 1 byte
+ *  - uart.rtt_<n>                                : n bytes through a PTY pair and back
+ *
+ * Usage:
+ *   bench_hal [-c chip] [-o out_off] [-i in_off] [-g base:count] [-E out:in]
+ *             [-s spidev] [-b i2cdev:addr:reg] [-U] [-n reps] [-w warmup]
+ *             [-C cpu] [-T] [-j out.json] [-S lines]
+ *
+ * -S creates a kernel gpio-sim chip (gpiosim.h) and runs the GPIO cases on it
+ * through the real character device; exits 77 when that is not possible.
+ */
+#define _GNU_SOURCE
+#include "bench_hist.h"
+#include "bench_util.h"
+#include "gpiosim.h"
+
+#include "hal_gpio.h"
+#if BENCH_GPIO_SIM
+#include "hal_gpio_sim.h"
+#endif
+#include "hal_spi.h"
+#include "hal_i2c.h"
+#include "hal_uart.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <pthread.h>
+#include <pty.h>
+#include <termios.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef BENCH_GPIO_BACKEND
+#define BENCH_GPIO_BACKEND "linux"
+#endif
+
+#define MAX_RESULTS     32
+#define MAX_GROUP_LINES 32
+#define EV_MAX_TIMEOUTS 3      ///< event_wake: timeout liên tiếp -> coi như chưa nối out->in
+
+typedef struct {
+    char      name[32];
+    BenchHist hist;
+} BenchResult;
+
+typedef struct {
+    const char* chip;
+    int         out_off;
+    int         in_off;
+    int         grp_base, grp_count;
+    int         ev_out, ev_in;
+    const char* spidev;
+    const char* i2cdev;
+    unsigned    i2c_addr, i2c_reg;
+    int         uart_pty;
+    unsigned    reps;
+    unsigned    warmup;
+    int         cpu;
+    int         tsc;
+    const char* json_path;
+    int         sim_lines;
+    GpioSim*    sim;        ///< -S: event_wake is driven by the sim pull, not ev_out
+} BenchArgs;
+
+static BenchResult s_res[MAX_RESULTS];
+static unsigned    s_nres;
+
+static BenchHist* _new_result(const char* name) {
+    if (s_nres >= MAX_RESULTS) return NULL;
+    BenchResult* r = &s_res[s_nres++];
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    BenchHist_Reset(&r->hist);
+    return &r->hist;
+}
+
+typedef struct {
+    char name[32];
+    char why[96];
+} BenchSkip;
+
+static BenchSkip s_skip[MAX_RESULTS];
+static unsigned  s_nskip = 0;
+
+/* Bỏ case đã bắt đầu (phải là result cuối cùng) và ghi lý do vào báo cáo */
+static void _skip_result(const char* name, const char* why) {
+    if (s_nres > 0 && strcmp(s_res[s_nres - 1].name, name) == 0) --s_nres;
+    if (s_nskip >= MAX_RESULTS) return;
+    snprintf(s_skip[s_nskip].name, sizeof(s_skip[s_nskip].name), "%s", name);
+    snprintf(s_skip[s_nskip].why, sizeof(s_skip[s_nskip].why), "%s", why);
+    ++s_nskip;
+}
+
+/* Time `stmt` reps times after `warmup` untimed runs. */
+#define BENCH_LOOP(hist, a, stmt)                                       \
+    do {                                                                \
+        for (unsigned _w = 0; _w < (a)->warmup; ++_w) { stmt; }         \
+        for (unsigned _r = 0; _r < (a)->reps; ++_r) {                   \
+            uint64_t _t0 = Bench_Ticks();                               \
+            stmt;                                                       \
+            uint64_t _t1 = Bench_Ticks();                               \
+            BenchHist_Record((hist), Bench_TicksToNs(_t1 - _t0));       \
+        }                                                               \
+    } while (0)
+
+/* ---------- GPIO ---------- */
+
+static HAL_GpioLine* _request(HAL_GpioChip* chip, int off, HAL_GpioDir dir, HAL_GpioEdge edge) {
+    HAL_GpioLineConfig lc = {
+        .offset = off, .name = NULL, .dir = dir,
+        .active = HAL_GPIO_ACTIVE_HIGH, .drive = HAL_GPIO_DRIVE_PUSHPULL,
+        .bias = HAL_GPIO_BIAS_AS_IS, .initial = 0, .edge = edge, .debounce_ms = 0
+    };
+    HAL_GpioLine* ln = NULL;
+    if (HAL_GpioLine_Request(chip, &lc, &ln) != HAL_GPIO_OK) return NULL;
+    return ln;
+}
+
+typedef struct {
+    HAL_GpioLine*     out;
+    GpioSim*          sim;
+    int               sim_off;
+    volatile uint64_t t_write;
+    volatile int      stop;
+    volatile unsigned seq, ack;
+} EventCtx;
+
+/* writer thread: toggles the output once per request from the main thread */
+static void* _event_writer(void* arg) {
+    EventCtx* e = (EventCtx*)arg;
+    unsigned done = 0;
+    int v = 0;
+    while (!e->stop) {
+        if (e->seq == done) { usleep(50); continue; }
+        done = e->seq;
+        v ^= 1;
+        __atomic_store_n(&e->t_write, Bench_Ticks(), __ATOMIC_RELEASE);
+        if (e->sim) GpioSim_SetPull(e->sim, e->sim_off, v);
+        else        HAL_GpioLine_Write(e->out, v);
+        e->ack = done;
+    }
+    return NULL;
+}
+
+static void _bench_gpio(const BenchArgs* a) {
+    HAL_GpioChipConfig cc = { .chip_name = a->chip };
+    HAL_GpioChip* chip = NULL;
+    if (HAL_GpioChip_Open(&cc, &chip) != HAL_GPIO_OK) {
+        fprintf(stderr, "[BENCH][GPIO] chip %s open failed, skip\n", a->chip);
+        return;
+    }
+
+    if (a->out_off >= 0) {
+        HAL_GpioLine* out = _request(chip, a->out_off, HAL_GPIO_DIR_OUT, HAL_GPIO_EDGE_NONE);
+        if (out) {
+            unsigned i = 0;
+            BenchHist* h = _new_result("gpio.write");
+            if (h) BENCH_LOOP(h, a, HAL_GpioLine_Write(out, (int)(++i & 1u)));
+            h = _new_result("gpio.toggle");
+            if (h) BENCH_LOOP(h, a, HAL_GpioLine_Toggle(out));
+            HAL_GpioLine_Release(out);
+        } else {
+            fprintf(stderr, "[BENCH][GPIO] out line %d request failed, skip\n", a->out_off);
+        }
+    }
+
+    if (a->in_off >= 0) {
+        HAL_GpioLine* in = _request(chip, a->in_off, HAL_GPIO_DIR_IN, HAL_GPIO_EDGE_NONE);
+        if (in) {
+            int v = 0;
+            BenchHist* h = _new_result("gpio.read");
+            if (h) BENCH_LOOP(h, a, HAL_GpioLine_Read(in, &v));
+            HAL_GpioLine_Release(in);
+        } else {
+            fprintf(stderr, "[BENCH][GPIO] in line %d request failed, skip\n", a->in_off);
+        }
+    }
+
+    if (a->grp_count > 0) {
+        HAL_GpioLine* lines[MAX_GROUP_LINES] = {0};
+        int n = 0;
+        for (; n < a->grp_count; ++n) {
+            lines[n] = _request(chip, a->grp_base + n, HAL_GPIO_DIR_OUT, HAL_GPIO_EDGE_NONE);
+            if (!lines[n]) break;
+        }
+        if (n == a->grp_count) {
+            HAL_GpioGroup grp = { .lines = lines, .count = (size_t)n };
+            uint32_t all = (n >= 32) ? 0xFFFFFFFFu : ((1u << n) - 1u);
+            uint32_t val = 0, bm = 0;
+            BenchHist* h = _new_result("gpio.group_write");
+            if (h) BENCH_LOOP(h, a, HAL_GpioGroup_WriteMask(&grp, all, (val = ~val)));
+            h = _new_result("gpio.group_read");
+            if (h) BENCH_LOOP(h, a, HAL_GpioGroup_ReadBitmap(&grp, &bm));
+        } else {
+            fprintf(stderr, "[BENCH][GPIO] group line %d request failed, skip\n", a->grp_base + n);
+        }
+        for (int i = 0; i < n; ++i) HAL_GpioLine_Release(lines[i]);
+    }
+
+    if ((a->ev_out >= 0 || a->sim) && a->ev_in >= 0) {
+        HAL_GpioLine* out = a->sim ? NULL : _request(chip, a->ev_out, HAL_GPIO_DIR_OUT, HAL_GPIO_EDGE_NONE);
+        if (a->sim) GpioSim_SetPull(a->sim, a->ev_in, 0);
+        HAL_GpioLine* in  = _request(chip, a->ev_in,  HAL_GPIO_DIR_IN,  HAL_GPIO_EDGE_BOTH);
+        HAL_GpioEvent ev;
+        if ((out || a->sim) && in && HAL_GpioLine_WaitEvent(in, 0, &ev) != HAL_GPIO_ENOSUP) {
+#if BENCH_GPIO_SIM
+            /* backend sim không có dây thật: nối out -> in trong sim */
+            if (out) HAL_GpioSim_Link(chip, a->ev_out, a->ev_in);
+#endif
+            EventCtx e = { .out = out, .sim = a->sim, .sim_off = a->ev_in };
+            pthread_t th;
+            pthread_create(&th, NULL, _event_writer, &e);
+            BenchHist* h = _new_result("gpio.event_wake");
+            unsigned reps = a->reps > 10000u ? 10000u : a->reps;
+            unsigned lost = 0, in_row = 0;
+            for (unsigned r = 0; h && r < reps + a->warmup; ++r) {
+                e.seq = r + 1;
+                if (HAL_GpioLine_WaitEvent(in, 1000, &ev) != HAL_GPIO_OK) {
+                    ++lost;
+                    /* không nối thì mỗi vòng mất trọn 1 s: dừng sớm thay vì treo hàng giờ */
+                    if (++in_row >= EV_MAX_TIMEOUTS) break;
+                    continue;
+                }
+                in_row = 0;
+                uint64_t t1 = Bench_Ticks();
+                uint64_t t0 = __atomic_load_n(&e.t_write, __ATOMIC_ACQUIRE);
+                if (r >= a->warmup && t1 > t0) BenchHist_Record(h, Bench_TicksToNs(t1 - t0));
+                while (e.ack != e.seq) { /* writer finished the write call */ }
+            }
+            e.stop = 1;
+            pthread_join(th, NULL);
+            if (in_row >= EV_MAX_TIMEOUTS) {
+                char why[96];
+                snprintf(why, sizeof(why), "pair not connected (out %d -> in %d: %u timeouts in a row)",
+                         a->ev_out, a->ev_in, in_row);
+                fprintf(stderr, "[BENCH][GPIO] event_wake: %s, skip\n", why);
+                _skip_result("gpio.event_wake", why);
+            } else if (lost) {
+                fprintf(stderr, "[BENCH][GPIO] event_wake: %u events lost/timed out (jumper?)\n", lost);
+            }
+#if BENCH_GPIO_SIM
+            if (out) HAL_GpioSim_Link(chip, a->ev_out, -1);
+#endif
+        } else {
+            fprintf(stderr, "[BENCH][GPIO] event lines unavailable or backend has no events, skip\n");
+        }
+        if (out) HAL_GpioLine_Release(out);
+        if (in)  HAL_GpioLine_Release(in);
+    }
+
+    HAL_GpioChip_Close(chip);
+}
+
+/* ---------- SPI ---------- */
+
+static void _bench_spi(const BenchArgs* a) {
+    if (!a->spidev) return;
+    HAL_SpiStatus st;
+    HAL_SpiConfig cfg = {
+        .dev_name = a->spidev, .mode = HAL_SPI_MODE0,
+        .max_speed_hz = 1000000, .bits_per_word = 8, .lsb_first = 0
+    };
+    HAL_SpiBus* bus = HAL_Spi_Open(&cfg, &st);
+    if (!bus) {
+        fprintf(stderr, "[BENCH][SPI] open %s failed (%d), skip\n", a->spidev, st);
+        return;
+    }
+    static const size_t sizes[] = { 1, 4, 16, 64, 256, 1024, 4096 };
+    static uint8_t tx[4096], rx[4096];
+    for (size_t i = 0; i < sizeof(tx); ++i) tx[i] = (uint8_t)i;
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); ++k) {
+        char name[32];
+        snprintf(name, sizeof(name), "spi.xfer_%zu", sizes[k]);
+        BenchHist* h = _new_result(name);
+        if (h) BENCH_LOOP(h, a, HAL_Spi_Transfer(bus, tx, rx, sizes[k]));
+    }
+    HAL_Spi_Close(bus);
+}
+
+/* ---------- I2C ---------- */
+
+static void _bench_i2c(const BenchArgs* a) {
+    if (!a->i2cdev) return;
+    HAL_I2cStatus st;
+    HAL_I2cBusConfig cfg = { .bus_name = a->i2cdev, .bus_speed_hz = 100000 };
+    HAL_I2cBus* bus = HAL_I2cBus_Open(&cfg, &st);
+    if (!bus) {
+        fprintf(stderr, "[BENCH][I2C] open %s failed (%d), skip\n", a->i2cdev, st);
+        return;
+    }
+    uint8_t v = 0;
+    if (HAL_I2c_ReadReg8(bus, (uint8_t)a->i2c_addr, (uint8_t)a->i2c_reg, &v, 1) != HAL_I2C_OK) {
+        fprintf(stderr, "[BENCH][I2C] addr 0x%02X not responding, skip\n", a->i2c_addr);
+    } else {
+        BenchHist* h = _new_result("i2c.readreg8");
+        if (h) BENCH_LOOP(h, a, HAL_I2c_ReadReg8(bus, (uint8_t)a->i2c_addr, (uint8_t)a->i2c_reg, &v, 1));
+    }
+    HAL_I2cBus_Close(bus);
+}
+
+/* ---------- UART via PTY ---------- */
+
+/* HAL side writes n bytes, PTY master echoes them back, HAL side reads them. */
+static int _uart_rtt(HAL_Uart* u, int master, const uint8_t* tx, uint8_t* rx, size_t n) {
+    if (HAL_Uart_Write(u, tx, n) != (long)n) return -1;
+    size_t got = 0;
+    uint8_t echo[256];
+    while (got < n) {
+        struct pollfd p = { .fd = master, .events = POLLIN };
+        if (poll(&p, 1, 1000) <= 0) return -1;
+        ssize_t r = read(master, echo + got, n - got);
+        if (r <= 0) return -1;
+        got += (size_t)r;
+    }
+    if (write(master, echo, n) != (ssize_t)n) return -1;
+    got = 0;
+    while (got < n) {
+        long r = HAL_Uart_Read(u, rx + got, n - got, 1000);
+        if (r <= 0) return -1;
+        got += (size_t)r;
+    }
+    return 0;
+}
+
+static void _bench_uart(const BenchArgs* a) {
+    if (!a->uart_pty) return;
+    int master = -1, slave = -1;
+    char name[64];
+    if (openpty(&master, &slave, name, NULL, NULL) != 0) {
+        fprintf(stderr, "[BENCH][UART] openpty failed errno=%d, skip\n", errno);
+        return;
+    }
+    /* raw master side so the echo is byte-exact */
+    struct termios tio;
+    if (tcgetattr(master, &tio) == 0) { cfmakeraw(&tio); tcsetattr(master, TCSANOW, &tio); }
+
+    HAL_UartStatus st;
+    HAL_UartConfig cfg = {
+        .device = name, .baud = 115200, .data_bits = 8, .stop_bits = 1,
+        .parity = HAL_UART_PARITY_NONE, .non_blocking = 0, .hw_flow = 0
+    };
+    HAL_Uart* u = HAL_Uart_Open(&cfg, &st);
+    if (!u) {
+        fprintf(stderr, "[BENCH][UART] HAL_Uart_Open(%s) failed (%d), skip\n", name, st);
+        close(master); close(slave);
+        return;
+    }
+    static const size_t sizes[] = { 1, 16, 64, 256 };
+    uint8_t tx[256], rx[256];
+    for (size_t i = 0; i < sizeof(tx); ++i) tx[i] = (uint8_t)i;
+    /* PTY round trips are slow; cap reps */
+    BenchArgs la = *a;
+    if (la.reps > 2000u) la.reps = 2000u;
+    if (la.warmup > 100u) la.warmup = 100u;
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); ++k) {
+        char nm[32];
+        snprintf(nm, sizeof(nm), "uart.rtt_%zu", sizes[k]);
+        BenchHist* h = _new_result(nm);
+        int fail = 0;
+        if (h) BENCH_LOOP(h, &la, fail |= _uart_rtt(u, master, tx, rx, sizes[k]));
+        if (fail) fprintf(stderr, "[BENCH][UART] %s: some round trips failed\n", nm);
+    }
+    HAL_Uart_Close(u);
+    close(master);
+    close(slave);
+}
+
+/* ---------- main ---------- */
+
+static void _usage(const char* prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -c chip        GPIO chip name (default gpiochip0)\n"
+        "  -o off         output line for write/toggle (-1 = skip, default -1)\n"
+        "  -i off         input line for read (-1 = skip, default -1)\n"
+        "  -g base:count  output group for group_write/group_read\n"
+        "  -E out:in      jumpered lines for event wake latency\n"
+        "  -s spidev      SPI device (e.g. /dev/spidev0.0)\n"
+        "  -b dev:addr:reg I2C register read (e.g. /dev/i2c-0:0x48:0)\n"
+        "  -U             UART round trip through a PTY pair\n"
+        "  -n reps        timed repetitions per case (default 100000)\n"
+        "  -w warmup      untimed repetitions per case (default 1000)\n"
+        "  -C cpu         pin to CPU\n"
+        "  -T             use TSC instead of CLOCK_MONOTONIC_RAW (x86)\n"
+        "  -j file        write JSON results\n"
+        "  -S lines       create a kernel gpio-sim chip with that many lines and use it\n"
+        "                 (defaults -o 0 -i 1 -g 2:lines-3, event_wake on the last line)\n", prog);
+}
+
+static int _parse_args(int argc, char** argv, BenchArgs* a) {
+    memset(a, 0, sizeof(*a));
+    a->chip = "gpiochip0";
+    a->out_off = a->in_off = a->ev_out = a->ev_in = -1;
+    a->reps = 100000; a->warmup = 1000; a->cpu = -1;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:o:i:g:E:s:b:Un:w:C:Tj:S:h")) != -1) {
+        switch (opt) {
+            case 'c': a->chip = optarg; break;
+            case 'o': a->out_off = atoi(optarg); break;
+            case 'i': a->in_off = atoi(optarg); break;
+            case 'g':
+                if (sscanf(optarg, "%d:%d", &a->grp_base, &a->grp_count) != 2 ||
+                    a->grp_count < 1 || a->grp_count > MAX_GROUP_LINES) return -1;
+                break;
+            case 'E': if (sscanf(optarg, "%d:%d", &a->ev_out, &a->ev_in) != 2) return -1; break;
+            case 's': a->spidev = optarg; break;
+            case 'b': {
+                static char dev[64];
+                if (sscanf(optarg, "%63[^:]:%i:%i", dev, (int*)&a->i2c_addr, (int*)&a->i2c_reg) != 3) return -1;
+                a->i2cdev = dev;
+                break;
+            }
+            case 'U': a->uart_pty = 1; break;
+            case 'n': a->reps = (unsigned)strtoul(optarg, NULL, 0); break;
+            case 'w': a->warmup = (unsigned)strtoul(optarg, NULL, 0); break;
+            case 'C': a->cpu = atoi(optarg); break;
+            case 'T': a->tsc = 1; break;
+            case 'j': a->json_path = optarg; break;
+            case 'S':
+                a->sim_lines = atoi(optarg);
+                if (a->sim_lines < 2 || a->sim_lines > GPIOSIM_MAX_LINES) return -1;
+                break;
+            default: return -1;
+        }
+    }
+    return (a->reps > 0) ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+    BenchArgs a;
+    if (_parse_args(argc, argv, &a) != 0) {
+        _usage(argv[0]);
+        return 2;
+    }
+    if (Bench_PinCpu(a.cpu) != 0) fprintf(stderr, "[BENCH] pin to CPU %d failed\n", a.cpu);
+    const char* clk = Bench_ClockInit(a.tsc);
+
+    static GpioSim sim;
+    if (a.sim_lines) {
+        char why[256];
+        if (GpioSim_Create(&sim, a.sim_lines, why, sizeof(why)) != 0) {
+            printf("SKIP: %s\n", why);
+            return GPIOSIM_EXIT_SKIP;
+        }
+        int n = sim.num_lines;
+        a.sim  = &sim;
+        a.chip = sim.chip;
+        if (a.out_off < 0) a.out_off = 0;
+        if (a.in_off  < 0) a.in_off  = 1;
+        if (a.grp_count == 0 && n > 3) { a.grp_base = 2; a.grp_count = (n - 3 > MAX_GROUP_LINES) ? MAX_GROUP_LINES : n - 3; }
+        if (a.ev_in   < 0 && n > 2) a.ev_in = n - 1;
+    }
+
+    _bench_gpio(&a);
+    _bench_spi(&a);
+    _bench_i2c(&a);
+    _bench_uart(&a);
+    if (a.sim) GpioSim_Destroy(a.sim);
+
+    printf("=== bench-hal: gpio backend=%s chip=%s clock=%s cpu=%d reps=%u ===\n",
+           BENCH_GPIO_BACKEND, a.chip, clk, a.cpu, a.reps);
+    for (unsigned i = 0; i < s_nres; ++i)
+        BenchHist_PrintSummary(stdout, s_res[i].name, &s_res[i].hist, 1.0, "ns");
+    for (unsigned i = 0; i < s_nskip; ++i)
+        printf("%-12s skipped: %s\n", s_skip[i].name, s_skip[i].why);
+
+    if (a.json_path) {
+        FILE* f = fopen(a.json_path, "w");
+        if (!f) { perror(a.json_path); return 1; }
+        fprintf(f, "{\"meta\":{\"gpio_backend\":\"%s\",\"chip\":\"%s\",\"clock\":\"%s\",\"cpu\":%d,"
+                   "\"reps\":%u,\"warmup\":%u},\"unit\":\"ns\",\"results\":{",
+                BENCH_GPIO_BACKEND, a.chip, clk, a.cpu, a.reps, a.warmup);
+        for (unsigned i = 0; i < s_nres; ++i) {
+            fprintf(f, "%s\"%s\":", i ? "," : "", s_res[i].name);
+            BenchHist_PrintJson(f, &s_res[i].hist);
+        }
+        fprintf(f, "},\"skipped\":{");
+        for (unsigned i = 0; i < s_nskip; ++i)
+            fprintf(f, "%s\"%s\":\"%s\"", i ? "," : "", s_skip[i].name, s_skip[i].why);
+        fprintf(f, "}}\n");
+        fclose(f);
+    }
+    return 0;
+}
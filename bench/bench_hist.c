@@ -0,0 +1,140 @@
+/**
+ * @file bench_hist.c
+ * @brief Log-linear latency histogram (see bench_hist.h).
+ */
+#include "bench_hist.h"
+#include <string.h>
+
+static unsigned _msb64(uint64_t v) {
+    return 63u - (unsigned)__builtin_clzll(v);
+}
+
+static unsigned _index_of(uint64_t v) {
+    if (v < BENCH_HIST_SUB_COUNT) return (unsigned)v;
+    unsigned shift = _msb64(v) - (BENCH_HIST_SUB_BITS - 1u);
+    if (shift > BENCH_HIST_MAX_SHIFT) return BENCH_HIST_BUCKETS - 1u;
+    unsigned sub = (unsigned)(v >> shift);                 /* 64..127 */
+    unsigned idx = shift * BENCH_HIST_HALF_COUNT + sub;
+    return (idx < BENCH_HIST_BUCKETS) ? idx : BENCH_HIST_BUCKETS - 1u;
+}
+
+/* Highest value that still maps into bucket idx. */
+static uint64_t _upper_of(unsigned idx) {
+    if (idx < BENCH_HIST_SUB_COUNT) return idx;
+    unsigned shift = idx / BENCH_HIST_HALF_COUNT - 1u;
+    uint64_t sub   = idx - shift * BENCH_HIST_HALF_COUNT;
+    return ((sub + 1u) << shift) - 1u;
+}
+
+void BenchHist_Reset(BenchHist* h) {
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+void BenchHist_Record(BenchHist* h, uint64_t value) {
+    h->counts[_index_of(value)]++;
+    h->total++;
+    h->sum += (double)value;
+    if (value < h->min) h->min = value;
+    if (value > h->max) h->max = value;
+}
+
+void BenchHist_RecordCorrected(BenchHist* h, uint64_t value, uint64_t expected_interval) {
+    BenchHist_Record(h, value);
+    if (expected_interval == 0 || value <= expected_interval) return;
+    for (uint64_t missing = value - expected_interval;
+         missing >= expected_interval;
+         missing -= expected_interval) {
+        BenchHist_Record(h, missing);
+    }
+}
+
+void BenchHist_Merge(BenchHist* dst, const BenchHist* src) {
+    if (!src->total) return;
+    for (unsigned i = 0; i < BENCH_HIST_BUCKETS; ++i) dst->counts[i] += src->counts[i];
+    dst->total += src->total;
+    dst->sum   += src->sum;
+    if (src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+}
+
+uint64_t BenchHist_Quantile(const BenchHist* h, double q) {
+    if (!h->total) return 0;
+    if (q <= 0.0) return h->min;
+    if (q >= 1.0) return h->max;
+    uint64_t want = (uint64_t)(q * (double)h->total + 0.5);
+    if (want == 0) want = 1;
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < BENCH_HIST_BUCKETS; ++i) {
+        seen += h->counts[i];
+        if (seen >= want) {
+            uint64_t up = _upper_of(i);
+            return (up > h->max) ? h->max : up;
+        }
+    }
+    return h->max;
+}
+
+double BenchHist_Mean(const BenchHist* h) {
+    return h->total ? h->sum / (double)h->total : 0.0;
+}
+
+void BenchHist_PrintSummary(FILE* f, const char* label, const BenchHist* h, double scale, const char* unit) {
+    if (scale <= 0.0) scale = 1.0;
+    if (!h->total) {
+        fprintf(f, "%-12s n=0\n", label);
+        return;
+    }
+    fprintf(f, "%-12s n=%llu min=%.2f p50=%.2f p90=%.2f p99=%.2f p999=%.2f max=%.2f mean=%.2f (%s)\n",
+            label, (unsigned long long)h->total,
+            (double)h->min / scale,
+            (double)BenchHist_Quantile(h, 0.50)  / scale,
+            (double)BenchHist_Quantile(h, 0.90)  / scale,
+            (double)BenchHist_Quantile(h, 0.99)  / scale,
+            (double)BenchHist_Quantile(h, 0.999) / scale,
+            (double)h->max / scale,
+            BenchHist_Mean(h) / scale, unit ? unit : "");
+}
+
+/* Re-bin the log-linear buckets into rows of width step: every bucket lands in the
+ * row of its lower edge. Row label = row_scale ? row * step : row index. */
+static void _print_rows(FILE* f, const BenchHist* h, uint64_t step, uint64_t limit, int row_scale) {
+    if (!step) step = 1;
+    uint64_t nrows    = limit / step;
+    uint64_t mul      = row_scale ? step : 1u;
+    uint64_t cur_row  = 0, cur_n = 0, overflow = 0;
+    for (unsigned i = 0; i < BENCH_HIST_BUCKETS; ++i) {
+        if (!h->counts[i]) continue;
+        uint64_t lo  = (i == 0) ? 0 : _upper_of(i - 1) + 1u;
+        uint64_t row = lo / step;
+        if (row >= nrows) { overflow += h->counts[i]; continue; }
+        if (row != cur_row && cur_n) {
+            fprintf(f, "%06llu %llu\n", (unsigned long long)(cur_row * mul), (unsigned long long)cur_n);
+            cur_n = 0;
+        }
+        cur_row = row;
+        cur_n  += h->counts[i];
+    }
+    if (cur_n) fprintf(f, "%06llu %llu\n", (unsigned long long)(cur_row * mul), (unsigned long long)cur_n);
+    fprintf(f, "# overflow(>=%llu) %llu\n", (unsigned long long)(nrows * step), (unsigned long long)overflow);
+}
+
+void BenchHist_PrintTable(FILE* f, const BenchHist* h, uint64_t step, uint64_t limit) {
+    _print_rows(f, h, step, limit, 1);
+}
+
+void BenchHist_PrintTableRows(FILE* f, const BenchHist* h, uint64_t step, uint64_t limit) {
+    _print_rows(f, h, step, limit, 0);
+}
+
+void BenchHist_PrintJson(FILE* f, const BenchHist* h) {
+    fprintf(f, "{\"n\":%llu,\"min\":%llu,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu,\"mean\":%.1f}",
+            (unsigned long long)h->total,
+            (unsigned long long)(h->total ? h->min : 0),
+            (unsigned long long)BenchHist_Quantile(h, 0.50),
+            (unsigned long long)BenchHist_Quantile(h, 0.90),
+            (unsigned long long)BenchHist_Quantile(h, 0.99),
+            (unsigned long long)BenchHist_Quantile(h, 0.999),
+            (unsigned long long)h->max,
+            BenchHist_Mean(h));
+}
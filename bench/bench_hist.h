@@ -0,0 +1,55 @@
+/**
+ * @file bench_hist.h
+ * @brief Small HDR-style latency histogram shared by the bench tools.
+ *
+ * Notes:
+ *  - Log-linear buckets: values below 128 are exact, above that every power
+ *    of two is split into 64 sub-buckets (< 1.6% relative error).
+ *  - Values are unit-less (the tools record nanoseconds).
+ *  - Record_Corrected() back-fills the samples a stalled caller would have
+ *    taken (coordinated-omission correction, same rule as HdrHistogram).
+ */
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BENCH_HIST_SUB_BITS   7
+#define BENCH_HIST_SUB_COUNT  (1u << BENCH_HIST_SUB_BITS)        /* 128 */
+#define BENCH_HIST_HALF_COUNT (BENCH_HIST_SUB_COUNT / 2u)        /* 64  */
+#define BENCH_HIST_MAX_SHIFT  40                                 /* up to ~2^46 */
+#define BENCH_HIST_BUCKETS    (BENCH_HIST_SUB_COUNT + BENCH_HIST_MAX_SHIFT * BENCH_HIST_HALF_COUNT)
+
+typedef struct {
+    uint64_t counts[BENCH_HIST_BUCKETS];
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    double   sum;
+} BenchHist;
+
+void     BenchHist_Reset(BenchHist* h);
+void     BenchHist_Record(BenchHist* h, uint64_t value);
+/* Record value; if it exceeds expected_interval, also record the samples
+ * (value - k*interval) that were omitted while the caller was stalled. */
+void     BenchHist_RecordCorrected(BenchHist* h, uint64_t value, uint64_t expected_interval);
+void     BenchHist_Merge(BenchHist* dst, const BenchHist* src);
+/* q in [0,1]; returns the upper edge of the bucket holding that quantile */
+uint64_t BenchHist_Quantile(const BenchHist* h, double q);
+double   BenchHist_Mean(const BenchHist* h);
+
+/* Print "label n= min= p50= p99= p999= max=" with values divided by scale (e.g. 1000 -> us). */
+void     BenchHist_PrintSummary(FILE* f, const char* label, const BenchHist* h, double scale, const char* unit);
+/* Print a cyclictest-like "<bucket> <count>" table, bucket width = step (same unit as values). */
+void     BenchHist_PrintTable(FILE* f, const BenchHist* h, uint64_t step, uint64_t limit);
+/* Same table, but the first column is the row index (value / step), as cyclictest -h prints. */
+void     BenchHist_PrintTableRows(FILE* f, const BenchHist* h, uint64_t step, uint64_t limit);
+/* JSON object: {"n":..,"min":..,"p50":..,"p90":..,"p99":..,"p999":..,"max":..,"mean":..} */
+void     BenchHist_PrintJson(FILE* f, const BenchHist* h);
+
+#ifdef __cplusplus
+}
+#endif
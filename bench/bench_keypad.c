@@ -0,0 +1,366 @@
+/**
+ * @file bench_keypad.c
+ * @brief Matrix keypad scanner (board_keypad.c) against a simulated key
+ *        matrix: debounce, ghost masking, idle / wake, scan cost.
+ *
+ * A "kpm:" GPIO backend registered by this file models an N x M matrix
+ * without diodes: reading a column returns 1 when any selected row has a
+ * pressed key on it (ghost keys appear like on real hardware). Time is
+ * virtual (now_ns), every BoardKeypad_Poll(kp, 0) is one scan_us step.
+ * Steps:
+ *
+ *  - press   : one key down / up -> exactly one press and one release,
+ *              each debounce_scans scans after the change
+ *  - ghost   : (0,0) (0,1) then (1,0) -> (1,1) appears as a ghost; new
+ *              presses on row 1 are held until (0,1) is released, then only
+ *              (1,0) is reported, never (1,1)
+ *  - idle    : idle_ms after the last release the scanner goes idle and
+ *              stops scanning; a press wakes it and is reported
+ *  - leak    : a column that reads pressed only while every row is selected
+ *              (row-to-column leakage) must not make every scan retry idle:
+ *              all-row selects at most once per idle_ms
+ *
+ * ns/scan is the Poll cost for the whole matrix (fake GPIO included).
+ *
+ * Usage:
+ *   bench_keypad [-r rows] [-c cols] [-d debounce_scans] [-n scans] [-j]
+ */
+#define _GNU_SOURCE
+#include "bench_util.h"
+
+#include "board_keypad.h"
+#include "hal_gpio.h"
+#include "hal_gpio_backend.h"
+#include "osal_queue.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COL_BASE  32          /* offset line cột = COL_BASE + c */
+#define SCAN_US   1000u
+#define IDLE_MS   50u
+
+/* ---------------- ma trận giả ("kpm:") ---------------- */
+
+typedef struct {
+    uint32_t sel;                          /* hàng đang chọn (mức logic) */
+    uint32_t keys[BOARD_KEYPAD_MAX_ROWS];  /* bitmap cột của phím đang ấn */
+    uint32_t all_rows;
+    uint32_t leak;                         /* cột đọc 1 khi mọi hàng được chọn */
+    uint64_t row_writes, all_selects;
+} KpMatrix;
+
+typedef struct {
+    KpMatrix* m;
+    int       off;
+} KpLine;
+
+static KpMatrix s_m;
+
+static HAL_GpioStatus _kpm_open(const char* name, void** out) {
+    (void)name;
+    *out = &s_m;
+    return HAL_GPIO_OK;
+}
+
+static void _kpm_close(void* chip) {
+    (void)chip;
+}
+
+static HAL_GpioStatus _kpm_request(void* chip, const HAL_GpioLineConfig* cfg, void** out) {
+    KpLine* l = (KpLine*)calloc(1, sizeof(*l));
+    if (!l) return HAL_GPIO_EIO;
+    l->m   = (KpMatrix*)chip;
+    l->off = cfg->offset;
+    *out = l;
+    return HAL_GPIO_OK;
+}
+
+static void _kpm_release(void* line) {
+    free(line);
+}
+
+static HAL_GpioStatus _kpm_write(void* line, int v) {
+    KpLine* l = (KpLine*)line;
+    if (l->off >= COL_BASE) return HAL_GPIO_EINVAL;
+    uint32_t bit = 1u << l->off;
+    l->m->sel = v ? (l->m->sel | bit) : (l->m->sel & ~bit);
+    l->m->row_writes++;
+    if (l->m->all_rows && l->m->sel == l->m->all_rows) l->m->all_selects++;
+    return HAL_GPIO_OK;
+}
+
+static HAL_GpioStatus _kpm_read(void* line, int* out) {
+    KpLine* l = (KpLine*)line;
+    if (l->off < COL_BASE) {
+        *out = (int)((l->m->sel >> l->off) & 1u);
+        return HAL_GPIO_OK;
+    }
+    /* không diode: dòng đi hàng -> phím -> cột -> phím -> hàng khác ... */
+    uint32_t rows = l->m->sel, cols = 0, prev;
+    do {
+        prev = cols;
+        for (int r = 0; r < BOARD_KEYPAD_MAX_ROWS; ++r)
+            if ((rows >> r) & 1u) cols |= l->m->keys[r];
+        for (int r = 0; r < BOARD_KEYPAD_MAX_ROWS; ++r)
+            if (l->m->keys[r] & cols) rows |= 1u << r;
+    } while (cols != prev);
+    if (l->m->all_rows && l->m->sel == l->m->all_rows) cols |= l->m->leak;
+    *out = (int)((cols >> (l->off - COL_BASE)) & 1u);
+    return HAL_GPIO_OK;
+}
+
+static const HAL_GpioOps k_kpm_ops = {
+    .scheme = "kpm", .priority = -10,
+    .chip_open = _kpm_open, .chip_close = _kpm_close,
+    .line_request = _kpm_request, .line_release = _kpm_release,
+    .line_write = _kpm_write, .line_read = _kpm_read,
+};
+HAL_GPIO_BACKEND_REGISTER(k_kpm_ops)
+
+/* ---------------- harness ---------------- */
+
+typedef struct {
+    unsigned rows, cols;
+    unsigned deb;
+    unsigned scans;
+    int      json;
+} KpArgs;
+
+typedef struct {
+    BoardKeypad* kp;
+    uint64_t     now;                  /* ns ảo */
+    unsigned     deb;
+} Kp;
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...) do {                          \
+        if (!(cond)) {                                 \
+            s_fail++;                                  \
+            printf("  FAIL: " __VA_ARGS__);            \
+            printf("\n");                              \
+        }                                              \
+    } while (0)
+
+static uint64_t _virt_now(void* ctx) {
+    return ((Kp*)ctx)->now;
+}
+
+static int _open(Kp* k, const KpArgs* a) {
+    static int rows[BOARD_KEYPAD_MAX_ROWS], cols[BOARD_KEYPAD_MAX_COLS];
+    for (unsigned i = 0; i < a->rows; ++i) rows[i] = (int)i;
+    for (unsigned i = 0; i < a->cols; ++i) cols[i] = COL_BASE + (int)i;
+    memset(&s_m, 0, sizeof(s_m));
+    s_m.all_rows = (a->rows == 32) ? ~0u : ((1u << a->rows) - 1u);
+    k->now = 0;
+    k->deb = a->deb;
+    BoardKeypadCfg c = {
+        .chip_name = "kpm:matrix", .row_offsets = rows, .nrows = (uint8_t)a->rows,
+        .col_offsets = cols, .ncols = (uint8_t)a->cols, .scan_us = SCAN_US,
+        .debounce_scans = (uint8_t)a->deb, .idle_ms = IDLE_MS, .now_ns = _virt_now, .now_ctx = k,
+    };
+    return BoardKeypad_Open(&c, &k->kp);
+}
+
+/* n bước scan_us; trả về tổng event */
+static int _step(Kp* k, unsigned n) {
+    int ev = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        k->now += SCAN_US * 1000ull;
+        int rc = BoardKeypad_Poll(k->kp, 0);
+        if (rc > 0) ev += rc;
+    }
+    return ev;
+}
+
+/* lấy một event; 0 nếu queue rỗng */
+static int _next(Kp* k, BoardKeypadEvent* ev) {
+    return OSAL_QueueReceive(BoardKeypad_Queue(k->kp), ev, 0) == OSAL_OK;
+}
+
+static int _expect(Kp* k, int row, int col, int pressed, const char* what) {
+    BoardKeypadEvent ev;
+    if (!_next(k, &ev)) {
+        CHECK(0, "%s: no event (want %d,%d %s)", what, row, col, pressed ? "press" : "release");
+        return 0;
+    }
+    CHECK(ev.row == row && ev.col == col && ev.pressed == pressed,
+          "%s: got %u,%u %s, want %d,%d %s", what, ev.row, ev.col, ev.pressed ? "press" : "release",
+          row, col, pressed ? "press" : "release");
+    return 1;
+}
+
+static void _expect_none(Kp* k, const char* what) {
+    BoardKeypadEvent ev;
+    if (_next(k, &ev))
+        CHECK(0, "%s: unexpected %u,%u %s", what, ev.row, ev.col, ev.pressed ? "press" : "release");
+}
+
+static void _press(int row, int col, int down) {
+    if (down) s_m.keys[row] |= 1u << col;
+    else      s_m.keys[row] &= ~(1u << col);
+}
+
+/* ---------------- steps ---------------- */
+
+static void _check_press(Kp* k) {
+    unsigned r = 2, c = 3;
+    _press((int)r, (int)c, 1);
+    CHECK(_step(k, k->deb - 1u) == 0, "press: reported before %u scans", k->deb);
+    CHECK(_step(k, 1) == 1, "press: not reported after %u scans", k->deb);
+    _expect(k, (int)r, (int)c, 1, "press");
+    CHECK(BoardKeypad_RowState(k->kp, (int)r) == (1u << c), "press: row state %#x",
+          BoardKeypad_RowState(k->kp, (int)r));
+    _step(k, 20);
+    _expect_none(k, "hold");
+    _press((int)r, (int)c, 0);
+    CHECK(_step(k, k->deb - 1u) == 0, "release: reported before %u scans", k->deb);
+    CHECK(_step(k, 1) == 1, "release: not reported after %u scans", k->deb);
+    _expect(k, (int)r, (int)c, 0, "release");
+}
+
+static void _check_ghost(Kp* k) {
+    BoardKeypadStats st0, st;
+    BoardKeypad_GetStats(k->kp, &st0);
+    _press(0, 0, 1);
+    _step(k, k->deb);
+    _press(0, 1, 1);
+    _step(k, k->deb);
+    _expect(k, 0, 0, 1, "ghost");
+    _expect(k, 0, 1, 1, "ghost");
+    _press(1, 0, 1);                    /* (1,1) ma xuất hiện cùng lúc */
+    _step(k, k->deb * 3u);
+    _expect_none(k, "ghost held");
+    BoardKeypad_GetStats(k->kp, &st);
+    CHECK(st.ghost > st0.ghost, "ghost: not counted");
+    _press(0, 1, 0);                    /* hết hình chữ nhật */
+    _step(k, k->deb * 2u);
+    _expect(k, 0, 1, 0, "ghost clear");
+    _expect(k, 1, 0, 1, "ghost clear");
+    _expect_none(k, "ghost clear");
+    _press(0, 0, 0);
+    _press(1, 0, 0);
+    _step(k, k->deb * 2u);
+    _expect(k, 0, 0, 0, "ghost release");
+    _expect(k, 1, 0, 0, "ghost release");
+    _expect_none(k, "ghost release");
+}
+
+static void _check_idle(Kp* k) {
+    BoardKeypadStats st0, st;
+    _step(k, IDLE_MS + 2u);
+    CHECK(BoardKeypad_IsIdle(k->kp), "idle: not idle %u ms after release", IDLE_MS + 2u);
+    BoardKeypad_GetStats(k->kp, &st0);
+    _step(k, 100);
+    BoardKeypad_GetStats(k->kp, &st);
+    CHECK(st.scans == st0.scans, "idle: %llu scans while idle",
+          (unsigned long long)(st.scans - st0.scans));
+    _press(4, 5, 1);
+    _step(k, k->deb + 1u);
+    BoardKeypad_GetStats(k->kp, &st);
+    CHECK(!BoardKeypad_IsIdle(k->kp) && st.wakeups == st0.wakeups + 1, "wake: not woken");
+    _expect(k, 4, 5, 1, "wake");
+    _press(4, 5, 0);
+    _step(k, k->deb);
+    _expect(k, 4, 5, 0, "wake release");
+}
+
+static void _check_leak(Kp* k, uint64_t* selects, unsigned scans) {
+    _step(k, IDLE_MS + 2u);
+    CHECK(BoardKeypad_IsIdle(k->kp), "leak: not idle before test");
+    s_m.leak = 1u;                      /* cột 0 chỉ "thấy phím" khi mọi hàng được chọn */
+    _press(0, 0, 1);                    /* thức dậy */
+    _step(k, k->deb);
+    _press(0, 0, 0);
+    _step(k, k->deb);
+    while (_next(k, &(BoardKeypadEvent){ 0 })) { }
+    uint64_t a0 = s_m.all_selects;
+    _step(k, scans);
+    *selects = s_m.all_selects - a0;
+    uint64_t max = scans / IDLE_MS + 2u;
+    CHECK(!BoardKeypad_IsIdle(k->kp), "leak: went idle with a column stuck");
+    CHECK(*selects <= max, "leak: %llu all-row selects in %u scans (max %llu)",
+          (unsigned long long)*selects, scans, (unsigned long long)max);
+    _expect_none(k, "leak");
+    s_m.leak = 0;
+}
+
+static double _bench_scan(Kp* k, unsigned scans) {
+    _press(0, 0, 1);                    /* giữ active */
+    uint64_t t0 = Bench_Ticks();
+    _step(k, scans);
+    uint64_t ns = Bench_TicksToNs(Bench_Ticks() - t0);
+    _press(0, 0, 0);
+    return scans ? (double)ns / scans : 0.0;
+}
+
+static void _usage(void) {
+    fprintf(stderr,
+            "usage: bench_keypad [-r rows] [-c cols] [-d debounce_scans] [-n scans] [-j]\n"
+            "  -r  rows, 6..32 (default 8)\n"
+            "  -c  columns, 6..32 (default 8)\n"
+            "  -d  debounce scans, 1..%d (default 4)\n"
+            "  -n  scans for the timing and leak passes (default 10000)\n", BOARD_KEYPAD_DEB_MAX);
+}
+
+int main(int argc, char** argv) {
+    KpArgs a = { .rows = 8, .cols = 8, .deb = 4, .scans = 10000 };
+    int opt;
+    while ((opt = getopt(argc, argv, "r:c:d:n:jh")) != -1) {
+        switch (opt) {
+        case 'r': a.rows  = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'c': a.cols  = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'd': a.deb   = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'n': a.scans = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'j': a.json  = 1; break;
+        default:  _usage(); return 2;
+        }
+    }
+    /* các bước dùng hàng / cột tới 5; hàng đợi event 32 */
+    if (a.rows < 6 || a.rows > BOARD_KEYPAD_MAX_ROWS || a.cols < 6 || a.cols > BOARD_KEYPAD_MAX_COLS ||
+        a.deb < 1 || a.deb > BOARD_KEYPAD_DEB_MAX || a.scans < 100) {
+        _usage();
+        return 2;
+    }
+    Bench_ClockInit(0);
+
+    Kp k = { 0 };
+    if (_open(&k, &a) != 0) {
+        fprintf(stderr, "[BENCH] keypad open on fake matrix failed\n");
+        return 1;
+    }
+    if (!a.json) printf("=== bench-keypad: %ux%u matrix, debounce %u scans, idle %u ms ===\n",
+                        a.rows, a.cols, a.deb, IDLE_MS);
+    _check_press(&k);
+    _check_ghost(&k);
+    _check_idle(&k);
+    uint64_t selects = 0;
+    _check_leak(&k, &selects, a.scans);
+    double ns_scan = _bench_scan(&k, a.scans);
+    uint64_t writes = s_m.row_writes;
+    BoardKeypadStats st;
+    BoardKeypad_GetStats(k.kp, &st);
+    BoardKeypad_Close(k.kp);
+
+    if (a.json) {
+        printf("{\"rows\":%u,\"cols\":%u,\"debounce\":%u,\"ok\":%s,\"ns_per_scan\":%.1f,\"scans\":%llu,"
+               "\"events\":%llu,\"dropped\":%llu,\"ghost\":%llu,\"wakeups\":%llu,\"row_writes\":%llu,"
+               "\"leak_all_selects\":%llu}\n",
+               a.rows, a.cols, a.deb, s_fail ? "false" : "true", ns_scan,
+               (unsigned long long)st.scans, (unsigned long long)st.events, (unsigned long long)st.dropped,
+               (unsigned long long)st.ghost, (unsigned long long)st.wakeups, (unsigned long long)writes,
+               (unsigned long long)selects);
+    } else {
+        printf("scan    : %7.1f ns/scan  (%llu scans, %llu row line writes)\n",
+               ns_scan, (unsigned long long)st.scans, (unsigned long long)writes);
+        printf("events  : %llu  dropped %llu  ghost scans %llu  wakeups %llu\n",
+               (unsigned long long)st.events, (unsigned long long)st.dropped,
+               (unsigned long long)st.ghost, (unsigned long long)st.wakeups);
+        printf("leak    : %llu all-row selects in %u scans\n", (unsigned long long)selects, a.scans);
+        printf("result  : %s (%d failure(s))\n", s_fail ? "FAIL" : "OK", s_fail);
+    }
+    return s_fail ? 1 : 0;
+}
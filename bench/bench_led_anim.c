@@ -0,0 +1,223 @@
+/**
+ * @file bench_led_anim.c
+ * @brief LED animation service (board_led_anim.c) against a simulated LED
+ *        panel: overlapping patterns, committed frames, GPIO writes per tick.
+ *
+ * BoardLed is replaced by an in-memory panel (state + log of every masked
+ * write), so the real animation task, priorities and commit path run
+ * unchanged without libgpiod. LED 7 is driven by "someone else" and must
+ * survive every step. Steps:
+ *
+ *  - overlap : SOLID 0x0F (prio 0) under COUNTER 0x3C = 5 (prio 1)
+ *              -> frame 0x17, owned 0x3F, then no writes while it is static
+ *  - blink   : BLINK 0x30 (prio 2) on top; every committed frame must keep
+ *              LED 0..3 = 0x7 and LED 4/5 equal (one pattern owns both)
+ *  - remove  : blink removed -> back to 0x17
+ *  - error   : the next -e panel writes fail; the frame must still land,
+ *              failures counted in commit_errors and not in commits
+ *  - release : COUNTER removed -> LED 4/5 cleared once, owned 0x0F
+ *  - stop    : only owned LED cleared, LED 7 still on
+ *
+ * Usage:
+ *   bench_led_anim [-t tick_us] [-p blink_period_ms] [-d blink_ms] [-e fail_writes] [-j]
+ */
+#define _GNU_SOURCE
+#include "bench_util.h"
+
+#include "board_led.h"
+#include "board_led_anim.h"
+
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define EXT_LED     (1ull << 7)   /* LED không thuộc animation */
+#define LOG_MAX     4096
+
+typedef struct {
+    unsigned tick_us;
+    unsigned blink_ms;     /* chu kỳ BLINK */
+    unsigned run_ms;       /* thời gian quan sát blink */
+    unsigned fail;         /* số lần ghi panel lỗi ở bước error */
+    int      json;
+} AnimArgs;
+
+/* --- panel giả thay cho board_led_linux.c --- */
+
+static pthread_mutex_t s_pmtx = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t        s_panel;
+static uint64_t        s_writes;
+static unsigned        s_fail_left;
+static uint64_t        s_log[LOG_MAX];
+static unsigned        s_log_n;
+
+int BoardLed_WriteMasked(uint64_t mask, uint64_t value) {
+    pthread_mutex_lock(&s_pmtx);
+    int rc = 0;
+    if (s_fail_left) {
+        s_fail_left--;
+        rc = -1;
+    } else {
+        s_panel = (s_panel & ~mask) | (value & mask);
+        s_writes++;
+        if (s_log_n < LOG_MAX) s_log[s_log_n++] = s_panel;
+    }
+    pthread_mutex_unlock(&s_pmtx);
+    return rc;
+}
+
+int BoardLed_WriteMask(uint64_t mask) { return BoardLed_WriteMasked(~0ull, mask); }
+
+static uint64_t _panel(void) {
+    pthread_mutex_lock(&s_pmtx);
+    uint64_t v = s_panel;
+    pthread_mutex_unlock(&s_pmtx);
+    return v;
+}
+
+static void _sleep_ms(unsigned ms) {
+    struct timespec ts = { .tv_sec = ms / 1000u, .tv_nsec = (long)(ms % 1000u) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+/* chờ tới khi frame đã commit = frame và panel khớp, tối đa timeout_ms */
+static int _wait_frame(uint64_t frame, uint64_t panel, unsigned timeout_ms) {
+    BoardLedAnimStats st;
+    for (unsigned t = 0; t <= timeout_ms; ++t) {
+        BoardLedAnim_GetStats(&st);
+        if (st.frame == frame && _panel() == panel) return 1;
+        _sleep_ms(1);
+    }
+    fprintf(stderr, "[BENCH] timeout: frame 0x%llx (want 0x%llx) panel 0x%llx (want 0x%llx)\n",
+            (unsigned long long)st.frame, (unsigned long long)frame,
+            (unsigned long long)_panel(), (unsigned long long)panel);
+    return 0;
+}
+
+static void _usage(void) {
+    fprintf(stderr,
+            "usage: bench_led_anim [-t tick_us] [-p blink_period_ms] [-d blink_ms] [-e fail_writes] [-j]\n"
+            "  -t  animation tick (default 1000 us)\n"
+            "  -p  blink period of the top pattern (default 20 ms)\n"
+            "  -d  how long to watch the blink step (default 300 ms)\n"
+            "  -e  panel writes that fail in the error step (default 3)\n");
+}
+
+int main(int argc, char** argv) {
+    AnimArgs a = { .tick_us = 1000, .blink_ms = 20, .run_ms = 300, .fail = 3 };
+    int opt;
+    while ((opt = getopt(argc, argv, "t:p:d:e:jh")) != -1) {
+        switch (opt) {
+        case 't': a.tick_us  = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'p': a.blink_ms = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'd': a.run_ms   = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'e': a.fail     = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'j': a.json     = 1; break;
+        default:  _usage(); return 2;
+        }
+    }
+    if (a.tick_us < 100 || a.blink_ms < 2 || !a.run_ms) {
+        _usage();
+        return 2;
+    }
+    const unsigned tmo = 500u + a.tick_us / 10u;   /* ms, rộng cho máy CI chậm */
+    int ok_overlap = 0, ok_static = 0, ok_blink = 0, ok_remove = 0, ok_error = 0, ok_release = 0, ok_stop = 0;
+    unsigned blink_frames = 0, blink_bad = 0;
+    uint64_t err_count = 0;
+    BoardLedAnimStats st0, st1;
+
+    s_panel = EXT_LED;
+    BoardLedAnimCfg cfg = { .tick_us = a.tick_us };
+    if (BoardLedAnim_Start(&cfg) != 0) {
+        fprintf(stderr, "[BENCH] BoardLedAnim_Start failed\n");
+        return 1;
+    }
+
+    /* overlap: SOLID 0..3 dưới COUNTER 2..5 = 5 -> LED 2, 4 */
+    BoardLedAnimSpec solid = { .kind = BOARD_LED_ANIM_SOLID,   .mask = 0x0F, .value = 1, .priority = 0 };
+    BoardLedAnimSpec cnt   = { .kind = BOARD_LED_ANIM_COUNTER, .mask = 0x3C, .value = 5, .priority = 1 };
+    BoardLedAnimId id_solid = BoardLedAnim_Add(&solid);
+    BoardLedAnimId id_cnt   = BoardLedAnim_Add(&cnt);
+    ok_overlap = id_solid > 0 && id_cnt > 0 && _wait_frame(0x17, 0x17 | EXT_LED, tmo);
+    BoardLedAnim_GetStats(&st0);
+    ok_overlap = ok_overlap && st0.owned == 0x3F && st0.active == 2;
+
+    /* frame tĩnh: tick chạy, không commit thêm */
+    _sleep_ms(50);
+    BoardLedAnim_GetStats(&st1);
+    ok_static = st1.commits == st0.commits && st1.ticks > st0.ticks;
+
+    /* blink 4/5 đè COUNTER */
+    pthread_mutex_lock(&s_pmtx);
+    unsigned log0 = s_log_n;
+    pthread_mutex_unlock(&s_pmtx);
+    BoardLedAnimSpec blink = { .kind = BOARD_LED_ANIM_BLINK, .mask = 0x30, .period_ms = a.blink_ms, .priority = 2 };
+    BoardLedAnimId id_blink = BoardLedAnim_Add(&blink);
+    _sleep_ms(a.run_ms);
+    BoardLedAnim_Remove(id_blink);
+    ok_remove = _wait_frame(0x17, 0x17 | EXT_LED, tmo);
+    pthread_mutex_lock(&s_pmtx);
+    unsigned log1 = s_log_n;
+    pthread_mutex_unlock(&s_pmtx);
+    for (unsigned i = log0; i < log1 && i < LOG_MAX; ++i) {
+        uint64_t v = s_log[i];
+        int b4 = (int)((v >> 4) & 1u), b5 = (int)((v >> 5) & 1u);
+        /* frame cuối (remove) là 0x17: LED 4 = COUNTER, không phải blink */
+        if ((v & 0x0F) != 0x07 || !(v & EXT_LED) || (v & ~0xBFull)) blink_bad++;
+        else if (b4 == b5) blink_frames++;
+        else if (v != (0x17 | EXT_LED)) blink_bad++;
+    }
+    /* ~2 commit / chu kỳ blink */
+    ok_blink = id_blink > 0 && blink_bad == 0 && blink_frames >= a.run_ms / a.blink_ms;
+
+    /* error: ghi panel lỗi a.fail lần, frame vẫn phải tới nơi */
+    BoardLedAnim_GetStats(&st0);
+    pthread_mutex_lock(&s_pmtx);
+    s_fail_left = a.fail;
+    pthread_mutex_unlock(&s_pmtx);
+    BoardLedAnim_SetValue(id_cnt, 2);                 /* COUNTER = 2 -> LED 3 */
+    ok_error = _wait_frame(0x0B, 0x0B | EXT_LED, tmo);
+    BoardLedAnim_GetStats(&st1);
+    err_count = st1.commit_errors - st0.commit_errors;
+    ok_error = ok_error && err_count == a.fail && st1.commits == st0.commits + 1;
+
+    /* release: LED 4/5 hết chủ -> tắt, owned = 0x0F */
+    BoardLedAnim_Remove(id_cnt);
+    ok_release = _wait_frame(0x0F, 0x0F | EXT_LED, tmo);
+    BoardLedAnim_GetStats(&st1);
+    ok_release = ok_release && st1.owned == 0x0F;
+
+    BoardLedAnim_Stop();
+    ok_stop = _panel() == EXT_LED;
+
+    BoardLedAnim_GetStats(&st1);
+    const int ok = ok_overlap && ok_static && ok_blink && ok_remove && ok_error && ok_release && ok_stop;
+
+    if (a.json) {
+        printf("{\"tick_us\":%u,\"ok\":%s,\"overlap\":%s,\"static\":%s,\"blink\":%s,\"blink_frames\":%u,"
+               "\"blink_bad\":%u,\"remove\":%s,\"error\":%s,\"commit_errors\":%llu,\"release\":%s,"
+               "\"stop\":%s,\"ticks\":%llu,\"writes\":%llu}\n",
+               a.tick_us, ok ? "true" : "false", ok_overlap ? "true" : "false",
+               ok_static ? "true" : "false", ok_blink ? "true" : "false", blink_frames, blink_bad,
+               ok_remove ? "true" : "false", ok_error ? "true" : "false", (unsigned long long)err_count,
+               ok_release ? "true" : "false", ok_stop ? "true" : "false",
+               (unsigned long long)st1.ticks, (unsigned long long)s_writes);
+    } else {
+        printf("=== bench-led-anim: tick %u us, blink %u ms for %u ms, %u failing writes ===\n",
+               a.tick_us, a.blink_ms, a.run_ms, a.fail);
+        printf("overlap : %s  (SOLID 0x0F + COUNTER 0x3C=5 -> 0x17, owned 0x3F)\n", ok_overlap ? "ok" : "FAIL");
+        printf("static  : %s  (no writes while the frame does not change)\n", ok_static ? "ok" : "FAIL");
+        printf("blink   : %s  (%u frames, %u bad)\n", ok_blink ? "ok" : "FAIL", blink_frames, blink_bad);
+        printf("remove  : %s\n", ok_remove ? "ok" : "FAIL");
+        printf("error   : %s  (%llu commit errors, frame landed after retry)\n",
+               ok_error ? "ok" : "FAIL", (unsigned long long)err_count);
+        printf("release : %s  (LED 4/5 cleared, owned 0x0F)\n", ok_release ? "ok" : "FAIL");
+        printf("stop    : %s  (panel 0x%llx, LED 7 untouched)\n", ok_stop ? "ok" : "FAIL",
+               (unsigned long long)_panel());
+        printf("writes  : %llu over %llu ticks\n", (unsigned long long)s_writes, (unsigned long long)st1.ticks);
+        printf("result  : %s\n", ok ? "OK" : "MISMATCH");
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,403 @@
+/**
+ * @file bench_ledmatrix.c
+ * @brief LED matrix refresh (board_ledmatrix.c) on a simulated panel: BCM
+ *        slot timing and triple-slot frame hand-off, real refresh task.
+ *
+ * An "lmx:" GPIO backend registered by this file stands in for the row and
+ * column lines. Every line write is timestamped (CLOCK_MONOTONIC) and the
+ * panel integrates, per pixel, how long it was lit (row selected and column
+ * on). Two passes:
+ *
+ *  - bcm     : 4 x 8 pixels at levels 0..2^bits-1, recorded frame by frame
+ *              for -t seconds. The median lit time of each pixel per frame
+ *              must be level BCM units (within half a unit), level 0 never
+ *              lit; the refresh rate must be within 5 %. The median keeps a
+ *              few preempted frames from failing the check.
+ *  - handoff : 4 x 16, a producer thread commits numbered frames (row bitmap
+ *              = frame number, full level) every -c us while the task scans.
+ *              Every fully scanned frame must show one committed frame on all
+ *              rows (no tearing) and frame numbers must never go backwards.
+ *
+ * Without SCHED_FIFO (not root) the default 312 us unit holds in the
+ * median; late_max / overruns show how far single slots moved. Units below
+ * ~50 us (e.g. -r 100 -b 6) need SCHED_FIFO, as BoardLedMatrix_Open warns.
+ *
+ * Usage:
+ *   bench_ledmatrix [-r refresh_hz] [-b bcm_bits] [-t seconds] [-c commit_us] [-P prio] [-j]
+ */
+#define _GNU_SOURCE
+#include "bench_util.h"
+
+#include "board_ledmatrix.h"
+#include "hal_gpio.h"
+#include "hal_gpio_backend.h"
+
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NROWS     4
+#define COL_BASE  32          /* offset line cột = COL_BASE + c */
+#define REC_MAX   3000        /* frame ghi lại cho pass bcm */
+
+/* ---------------- panel giả ("lmx:") ---------------- */
+
+typedef struct {
+    pthread_mutex_t mu;
+    uint32_t        rows, cols;                /* mức logic đang ghi */
+    uint64_t        t_last;
+    uint64_t        on_ns[NROWS][BOARD_LEDMATRIX_MAX_COLS];
+    /* theo frame (hàng 0 được chọn lại = frame mới) */
+    int             track;
+    int             cur_row;
+    uint32_t        shown[NROWS];
+    uint32_t        last_id;
+    uint64_t        frames, torn, backwards, ids;
+    /* bcm: thời gian sáng của từng pixel trong từng frame */
+    int             rec;
+    unsigned        nrec;
+    uint64_t        on_frame0[NROWS][8];
+} LmPanel;
+
+typedef struct {
+    LmPanel* p;
+    int      off;
+} LmLine;
+
+static LmPanel  s_p = { .mu = PTHREAD_MUTEX_INITIALIZER };
+static uint32_t s_rec[REC_MAX][NROWS][8];
+
+/* frame vừa quét xong (hàng 0 được chọn lại): cùng một frame trên mọi hàng?
+ * Pass bcm: lưu thời gian sáng của frame cho từng pixel. */
+static void _frame_done(LmPanel* p) {
+    if (p->rec && p->nrec < REC_MAX) {
+        for (int r = 0; r < NROWS; ++r)
+            for (int c = 0; c < 8; ++c) s_rec[p->nrec][r][c] = (uint32_t)(p->on_ns[r][c] - p->on_frame0[r][c]);
+        p->nrec++;
+    }
+    for (int r = 0; r < NROWS; ++r) memcpy(p->on_frame0[r], p->on_ns[r], sizeof(p->on_frame0[r]));
+
+    uint32_t id = p->shown[0];
+    for (int r = 1; r < NROWS; ++r)
+        if (p->shown[r] != id) { p->torn++; id = 0; break; }
+    if (id) {
+        if (id < p->last_id)  p->backwards++;
+        if (id != p->last_id) p->ids++;
+        p->last_id = id;
+    }
+    p->frames++;
+}
+
+static HAL_GpioStatus _lmx_open(const char* name, void** out) {
+    (void)name;
+    *out = &s_p;
+    return HAL_GPIO_OK;
+}
+
+static void _lmx_close(void* chip) {
+    (void)chip;
+}
+
+static HAL_GpioStatus _lmx_request(void* chip, const HAL_GpioLineConfig* cfg, void** out) {
+    if (cfg->dir != HAL_GPIO_DIR_OUT) return HAL_GPIO_EINVAL;
+    LmLine* l = (LmLine*)calloc(1, sizeof(*l));
+    if (!l) return HAL_GPIO_EIO;
+    l->p   = (LmPanel*)chip;
+    l->off = cfg->offset;
+    *out = l;
+    return HAL_GPIO_OK;
+}
+
+static void _lmx_release(void* line) {
+    free(line);
+}
+
+static HAL_GpioStatus _lmx_write(void* line, int v) {
+    LmLine*  l = (LmLine*)line;
+    LmPanel* p = l->p;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t now = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+
+    pthread_mutex_lock(&p->mu);
+    /* trạng thái cũ sáng từ lần ghi trước tới giờ */
+    if (p->t_last && p->cols) {
+        for (int r = 0; r < NROWS; ++r) {
+            if (!((p->rows >> r) & 1u)) continue;
+            for (uint32_t c = p->cols; c; c &= c - 1u) p->on_ns[r][__builtin_ctz(c)] += now - p->t_last;
+        }
+    }
+    p->t_last = now;
+    if (l->off < COL_BASE) {
+        uint32_t bit = 1u << l->off;
+        p->rows = v ? (p->rows | bit) : (p->rows & ~bit);
+        /* hàng mới được chọn một mình (đổi hàng có thể qua 0 hoặc 2 hàng) */
+        int r = (__builtin_popcount(p->rows) == 1) ? __builtin_ctz(p->rows) : -1;
+        if (p->track && r >= 0 && r != p->cur_row) {
+            if (r == 0) {
+                if (p->track > 1) _frame_done(p);
+                else for (int i = 0; i < NROWS; ++i) memcpy(p->on_frame0[i], p->on_ns[i], sizeof(p->on_frame0[i]));
+                p->track = 2;                    /* từ đây là frame đầy đủ */
+            }
+            p->shown[r] = 0;
+            p->cur_row  = r;
+        }
+    } else {
+        uint32_t bit = 1u << (l->off - COL_BASE);
+        p->cols = v ? (p->cols | bit) : (p->cols & ~bit);
+        /* chỉ khi bật cột: blank đổi hàng tắt từng cột một */
+        if (p->track && v && __builtin_popcount(p->rows) == 1)
+            p->shown[__builtin_ctz(p->rows)] = p->cols;
+    }
+    pthread_mutex_unlock(&p->mu);
+    return HAL_GPIO_OK;
+}
+
+static HAL_GpioStatus _lmx_read(void* line, int* out) {
+    LmLine* l = (LmLine*)line;
+    pthread_mutex_lock(&l->p->mu);
+    uint32_t v = (l->off < COL_BASE) ? (l->p->rows >> l->off) : (l->p->cols >> (l->off - COL_BASE));
+    pthread_mutex_unlock(&l->p->mu);
+    *out = (int)(v & 1u);
+    return HAL_GPIO_OK;
+}
+
+static const HAL_GpioOps k_lmx_ops = {
+    .scheme = "lmx", .priority = -10,
+    .chip_open = _lmx_open, .chip_close = _lmx_close,
+    .line_request = _lmx_request, .line_release = _lmx_release,
+    .line_write = _lmx_write, .line_read = _lmx_read,
+};
+HAL_GPIO_BACKEND_REGISTER(k_lmx_ops)
+
+/* ---------------- harness ---------------- */
+
+typedef struct {
+    unsigned refresh_hz;
+    unsigned bits;
+    unsigned secs;
+    unsigned commit_us;
+    unsigned prio;
+    int      json;
+} LmArgs;
+
+typedef struct {
+    BoardLedMatrixStats st;
+    unsigned            frames;        /* frame đã ghi */
+    double              worst_err;     /* sai lệch lớn nhất của trung vị thời gian sáng / frame, đơn vị BCM unit */
+    uint64_t            lit_zero_ns;   /* thời gian sáng của pixel level 0 */
+    int                 ok;
+} BcmResult;
+
+typedef struct {
+    BoardLedMatrixStats st;
+    uint64_t            committed, frames, ids, torn, backwards;
+    int                 ok;
+} HandoffResult;
+
+static void _sleep_us(uint64_t us) {
+    struct timespec ts = { .tv_sec = (time_t)(us / 1000000u), .tv_nsec = (long)(us % 1000000u) * 1000L };
+    nanosleep(&ts, NULL);
+}
+
+static int _open(const LmArgs* a, unsigned ncols, BoardLedMatrix** out) {
+    static const int rows[NROWS] = { 0, 1, 2, 3 };
+    static int cols[BOARD_LEDMATRIX_MAX_COLS];
+    for (unsigned c = 0; c < ncols; ++c) cols[c] = COL_BASE + (int)c;
+    pthread_mutex_lock(&s_p.mu);
+    memset(s_p.on_ns, 0, sizeof(s_p.on_ns));
+    memset(s_p.shown, 0, sizeof(s_p.shown));
+    s_p.rows = s_p.cols = 0;
+    s_p.t_last = 0;
+    s_p.cur_row = -1;
+    s_p.last_id = 0;
+    s_p.frames = s_p.torn = s_p.backwards = s_p.ids = 0;
+    s_p.rec = 0;
+    s_p.nrec = 0;
+    s_p.track = 1;
+    pthread_mutex_unlock(&s_p.mu);
+    BoardLedMatrixCfg c = {
+        .chip_name = "lmx:panel", .row_offsets = rows, .nrows = NROWS,
+        .col_offsets = cols, .ncols = (uint8_t)ncols,
+        .refresh_hz = a->refresh_hz, .bcm_bits = (uint8_t)a->bits,
+    };
+    return BoardLedMatrix_Open(&c, out);
+}
+
+static unsigned _level(int r, int c, unsigned max) {
+    return (unsigned)(r * 8 + c) % (max + 1u);
+}
+
+static int _cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int _run_bcm(const LmArgs* a, BcmResult* res) {
+    BoardLedMatrix* m = NULL;
+    if (_open(a, 8, &m) != 0) return -1;
+    const unsigned max = (1u << a->bits) - 1u;
+    for (int r = 0; r < NROWS; ++r)
+        for (int c = 0; c < 8; ++c) BoardLedMatrix_SetPixel(m, r, c, (uint8_t)_level(r, c, max));
+    BoardLedMatrix_Commit(m);
+    if (BoardLedMatrix_Start(m, (uint8_t)a->prio) != 0) { BoardLedMatrix_Close(m); return -1; }
+
+    /* bỏ khởi động, rồi ghi từng frame trong -t giây */
+    _sleep_us(200000);
+    pthread_mutex_lock(&s_p.mu);
+    s_p.rec = 1;
+    pthread_mutex_unlock(&s_p.mu);
+    BoardLedMatrix_ResetStats(m);
+    _sleep_us((uint64_t)a->secs * 1000000u);
+    pthread_mutex_lock(&s_p.mu);
+    s_p.rec = 0;
+    unsigned n = s_p.nrec;
+    pthread_mutex_unlock(&s_p.mu);
+    BoardLedMatrix_GetStats(m, &res->st);
+    BoardLedMatrix_Close(m);
+    if (!n) return -1;
+
+    /* trung vị theo frame: một lần bị preempt chỉ làm lệch vài frame */
+    static uint32_t col[REC_MAX];
+    double unit_ns = (double)res->st.unit_us * 1000.0;
+    res->frames      = n;
+    res->worst_err   = 0.0;
+    res->lit_zero_ns = 0;
+    for (int r = 0; r < NROWS; ++r) {
+        for (int c = 0; c < 8; ++c) {
+            unsigned lv = _level(r, c, max);
+            for (unsigned f = 0; f < n; ++f) {
+                col[f] = s_rec[f][r][c];
+                if (!lv) res->lit_zero_ns += col[f];
+            }
+            if (!lv) continue;
+            qsort(col, n, sizeof(col[0]), _cmp_u32);
+            double err = ((double)col[n / 2] - (double)lv * unit_ns) / unit_ns;
+            if (err < 0) err = -err;
+            if (err > res->worst_err) res->worst_err = err;
+        }
+    }
+    double rate_err = (res->st.refresh_hz - (double)a->refresh_hz) / (double)a->refresh_hz;
+    if (rate_err < 0) rate_err = -rate_err;
+    res->ok = res->worst_err <= 0.5 && res->lit_zero_ns == 0 && rate_err <= 0.05;
+    return 0;
+}
+
+typedef struct {
+    BoardLedMatrix* m;
+    unsigned        commit_us;
+    volatile int    run;
+    uint64_t        committed;
+} Producer;
+
+static void* _producer(void* arg) {
+    Producer* pr = (Producer*)arg;
+    const uint8_t full = 0xFF;             /* bị kẹp về max level */
+    for (uint32_t id = 1; pr->run && id < 0xFFFFu; ++id) {
+        for (int r = 0; r < NROWS; ++r) BoardLedMatrix_SetRow(pr->m, r, id, full);
+        BoardLedMatrix_Commit(pr->m);
+        pr->committed++;
+        _sleep_us(pr->commit_us);
+    }
+    return NULL;
+}
+
+static int _run_handoff(const LmArgs* a, HandoffResult* res) {
+    BoardLedMatrix* m = NULL;
+    if (_open(a, 16, &m) != 0) return -1;
+    if (BoardLedMatrix_Start(m, (uint8_t)a->prio) != 0) { BoardLedMatrix_Close(m); return -1; }
+
+    Producer pr = { .m = m, .commit_us = a->commit_us, .run = 1 };
+    pthread_t th;
+    if (pthread_create(&th, NULL, _producer, &pr) != 0) { BoardLedMatrix_Close(m); return -1; }
+    _sleep_us((uint64_t)a->secs * 1000000u);
+    pr.run = 0;
+    pthread_join(th, NULL);
+    BoardLedMatrix_GetStats(m, &res->st);
+    BoardLedMatrix_Close(m);
+
+    pthread_mutex_lock(&s_p.mu);
+    res->frames    = s_p.frames;
+    res->ids       = s_p.ids;
+    res->torn      = s_p.torn;
+    res->backwards = s_p.backwards;
+    pthread_mutex_unlock(&s_p.mu);
+    res->committed = pr.committed;
+    /* frame mới phải tới được panel: ít nhất một nửa số frame quét mang số mới */
+    res->ok = res->torn == 0 && res->backwards == 0 && res->frames > 0 &&
+              res->st.commits > 0 && res->ids * 2u >= res->frames;
+    return 0;
+}
+
+static void _usage(void) {
+    fprintf(stderr,
+            "usage: bench_ledmatrix [-r refresh_hz] [-b bcm_bits] [-t seconds] [-c commit_us] [-P prio] [-j]\n"
+            "  -r  frame rate (default 50; BCM unit = 1 s / (rate * 4 rows * 2^bits))\n"
+            "  -b  BCM bits, 1..%d (default 4)\n"
+            "  -t  seconds per pass (default 2)\n"
+            "  -c  producer commit period in us (default 500)\n"
+            "  -P  refresh task priority (default 90, SCHED_FIFO needs root)\n", BOARD_LEDMATRIX_MAX_BITS);
+}
+
+int main(int argc, char** argv) {
+    LmArgs a = { .refresh_hz = 50, .bits = 4, .secs = 2, .commit_us = 500, .prio = 90 };
+    int opt;
+    while ((opt = getopt(argc, argv, "r:b:t:c:P:jh")) != -1) {
+        switch (opt) {
+        case 'r': a.refresh_hz = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'b': a.bits       = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 't': a.secs       = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'c': a.commit_us  = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'P': a.prio       = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'j': a.json       = 1; break;
+        default:  _usage(); return 2;
+        }
+    }
+    if (!a.refresh_hz || a.bits < 1 || a.bits > BOARD_LEDMATRIX_MAX_BITS || !a.secs || a.secs > 60 ||
+        !a.commit_us || a.prio > 99) {
+        _usage();
+        return 2;
+    }
+    Bench_ClockInit(0);
+
+    BcmResult bcm = { 0 };
+    HandoffResult ho = { 0 };
+    if (_run_bcm(&a, &bcm) != 0 || _run_handoff(&a, &ho) != 0) {
+        fprintf(stderr, "[BENCH] matrix open / task start failed (BCM unit < 1 us?)\n");
+        return 1;
+    }
+    int ok = bcm.ok && ho.ok;
+
+    if (a.json) {
+        printf("{\"refresh_hz\":%u,\"bits\":%u,\"secs\":%u,\"ok\":%s,"
+               "\"bcm\":{\"unit_us\":%u,\"refresh_hz\":%.2f,\"frames\":%u,\"worst_err_units\":%.3f,\"lit_zero_ns\":%llu,"
+               "\"late_avg_us\":%u,\"late_max_us\":%u,\"overruns\":%llu,\"resyncs\":%llu,\"ok\":%s},"
+               "\"handoff\":{\"committed\":%llu,\"taken\":%llu,\"frames\":%llu,\"ids\":%llu,\"torn\":%llu,"
+               "\"backwards\":%llu,\"ok\":%s}}\n",
+               a.refresh_hz, a.bits, a.secs, ok ? "true" : "false",
+               bcm.st.unit_us, bcm.st.refresh_hz, bcm.frames, bcm.worst_err, (unsigned long long)bcm.lit_zero_ns,
+               bcm.st.late_avg_us, bcm.st.late_max_us, (unsigned long long)bcm.st.overruns,
+               (unsigned long long)bcm.st.resyncs, bcm.ok ? "true" : "false",
+               (unsigned long long)ho.committed, (unsigned long long)ho.st.commits,
+               (unsigned long long)ho.frames, (unsigned long long)ho.ids, (unsigned long long)ho.torn,
+               (unsigned long long)ho.backwards, ho.ok ? "true" : "false");
+    } else {
+        printf("=== bench-ledmatrix: %u rows, %u Hz, %u BCM bits, %u s per pass ===\n",
+               NROWS, a.refresh_hz, a.bits, a.secs);
+        printf("bcm     : unit %u us  refresh %.2f Hz  %u frames  worst median lit-time error %.3f unit  level-0 lit %llu ns  %s\n",
+               bcm.st.unit_us, bcm.st.refresh_hz, bcm.frames, bcm.worst_err,
+               (unsigned long long)bcm.lit_zero_ns, bcm.ok ? "ok" : "FAIL");
+        printf("          late avg %u us  max %u us  overruns %llu  resyncs %llu\n",
+               bcm.st.late_avg_us, bcm.st.late_max_us, (unsigned long long)bcm.st.overruns,
+               (unsigned long long)bcm.st.resyncs);
+        printf("handoff : %llu committed, %llu taken, %llu frames scanned (%llu new), torn %llu, backwards %llu  %s\n",
+               (unsigned long long)ho.committed, (unsigned long long)ho.st.commits,
+               (unsigned long long)ho.frames, (unsigned long long)ho.ids, (unsigned long long)ho.torn,
+               (unsigned long long)ho.backwards, ho.ok ? "ok" : "FAIL");
+        printf("result  : %s\n", ok ? "OK" : "MISMATCH");
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,289 @@
+/**
+ * @file bench_ledstrip.c
+ * @brief WS2812 SPI encoder speed / correctness and frame rate, on a fake
+ *        spidev (no hardware).
+ *
+ * hal_spi_port_open/close/ioctl (weak in hal_spi_linux.c) are replaced here:
+ * every SPI_IOC_MESSAGE is appended to a capture buffer, rejected with
+ * EMSGSIZE above spidev's bufsiz like the kernel does, and (with -w) takes as
+ * long as the bytes would on the wire at the requested clock.
+ *
+ *  - verify : each encoder (3-bit LUT, 4-bit LUT, 4-bit SIMD) encodes random
+ *             frames; the captured stream is decoded symbol by symbol and
+ *             compared with the expected scaled pixel bytes + zero reset tail
+ *  - encode : ns per LED for Show()'s scale + encode step
+ *  - fps    : render (rainbow) + Show for -f frames, in the caller's thread
+ *             (sync) and with the TX task (double buffer, render overlaps TX)
+ *
+ * Usage:
+ *   bench_ledstrip [-n leds] [-f frames] [-B brightness] [-m bufsiz] [-w] [-s seed] [-j]
+ */
+#define _GNU_SOURCE
+#include "bench_util.h"
+
+#include "board_ledstrip.h"
+#include "hal_spi.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <linux/spi/spidev.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FAKE_FD 77
+
+typedef struct {
+    unsigned leds;
+    unsigned frames;
+    unsigned bright;
+    unsigned bufsiz;
+    int      wire;          /* ioctl ngủ đúng thời gian trên dây */
+    uint32_t seed;
+    int      json;
+} StripArgs;
+
+typedef struct {
+    const char* name;
+    uint8_t     sym_bits;
+    uint8_t     no_simd;
+    int         ok;
+    int         simd;
+    double      ns_per_led;
+} EncResult;
+
+/* --- fake spidev --- */
+
+static struct {
+    unsigned bufsiz;
+    int      wire;
+    uint8_t* cap;
+    size_t   cap_len, cap_max;
+    uint64_t messages, rejected;
+} g_dev;
+
+int hal_spi_port_open(const char* path, int flags) {
+    (void)path; (void)flags;
+    return FAKE_FD;
+}
+
+int hal_spi_port_close(int fd) {
+    (void)fd;
+    return 0;
+}
+
+int hal_spi_port_ioctl(int fd, unsigned long req, void* arg) {
+    if (fd != FAKE_FD) { errno = EBADF; return -1; }
+    if (_IOC_TYPE(req) != SPI_IOC_MAGIC || _IOC_NR(req) != 0) return 0;   /* mode / speed / bits... */
+
+    const struct spi_ioc_transfer* x = (const struct spi_ioc_transfer*)arg;
+    unsigned n = _IOC_SIZE(req) / sizeof(*x);
+    size_t total = 0;
+    for (unsigned i = 0; i < n; ++i) total += x[i].len;
+    if (g_dev.bufsiz && total > g_dev.bufsiz) {
+        g_dev.rejected++;
+        errno = EMSGSIZE;
+        return -1;
+    }
+    uint64_t wire_ns = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        if (g_dev.cap && x[i].tx_buf && g_dev.cap_len + x[i].len <= g_dev.cap_max)
+            memcpy(g_dev.cap + g_dev.cap_len, (const void*)(uintptr_t)x[i].tx_buf, x[i].len);
+        g_dev.cap_len += x[i].len;
+        if (x[i].speed_hz) wire_ns += (uint64_t)x[i].len * 8ull * 1000000000ull / x[i].speed_hz;
+    }
+    g_dev.messages++;
+    if (g_dev.wire && wire_ns) {
+        struct timespec ts = { (time_t)(wire_ns / 1000000000ull), (long)(wire_ns % 1000000000ull) };
+        nanosleep(&ts, NULL);
+    }
+    return (int)total;
+}
+
+/* --- helpers --- */
+
+static uint32_t _rng(uint32_t* s) {
+    uint32_t x = *s;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return *s = x;
+}
+
+/* Giải mã stream SPI về byte màu; trả số bit symbol sai (+ đuôi khác 0) */
+static size_t _decode(const uint8_t* w, size_t wlen, unsigned sym, uint8_t* out, size_t nbytes) {
+    size_t bad = 0, bit = 0;
+    for (size_t i = 0; i < nbytes; ++i) {
+        uint8_t v = 0;
+        for (int k = 0; k < 8; ++k) {
+            unsigned s = 0;
+            for (unsigned j = 0; j < sym; ++j, ++bit) s = (s << 1) | ((w[bit >> 3] >> (7 - (bit & 7))) & 1u);
+            unsigned one = (sym == 4) ? 0xE : 0x6, zero = (sym == 4) ? 0x8 : 0x4;
+            if (s != one && s != zero) bad++;
+            v = (uint8_t)(v << 1 | (s == one));
+        }
+        out[i] = v;
+    }
+    for (size_t i = (bit + 7) >> 3; i < wlen; ++i) bad += (w[i] != 0);
+    return bad;
+}
+
+static int _open(const StripArgs* a, uint8_t sym, uint8_t no_simd, BoardLedStrip** s) {
+    BoardLedStripCfg c = { .spi_dev = "/dev/spidev-fake", .count = a->leds, .sym_bits = sym,
+                           .brightness = (uint8_t)a->bright, .no_simd = no_simd };
+    return BoardLedStrip_Open(&c, s);
+}
+
+static int _run_encode(const StripArgs* a, EncResult* r) {
+    BoardLedStrip* s = NULL;
+    if (_open(a, r->sym_bits, r->no_simd, &s) != 0) return -1;
+    BoardLedStripStats st;
+    BoardLedStrip_GetStats(s, &st);
+    r->simd = st.simd;
+
+    size_t nbytes = (size_t)a->leds * 3u;
+    uint8_t* want = (uint8_t*)malloc(nbytes);
+    uint8_t* got  = (uint8_t*)malloc(nbytes);
+    g_dev.cap_max = st.frame_bytes;
+    g_dev.cap     = (uint8_t*)malloc(g_dev.cap_max);
+    if (!want || !got || !g_dev.cap) return -1;
+
+    uint32_t seed = a->seed;
+    r->ok = 1;
+    uint64_t enc_ns = 0;
+    for (unsigned f = 0; f < a->frames; ++f) {
+        for (unsigned i = 0; i < a->leds; ++i) {
+            uint32_t c = _rng(&seed);
+            uint8_t rr = (uint8_t)c, gg = (uint8_t)(c >> 8), bb = (uint8_t)(c >> 16);
+            BoardLedStrip_SetPixel(s, i, rr, gg, bb, 0);
+            const uint8_t v[3] = { gg, rr, bb };          /* GRB trên dây */
+            for (int k = 0; k < 3; ++k) want[i * 3u + k] = (uint8_t)((v[k] * a->bright + 127u) / 255u);
+        }
+        g_dev.cap_len = 0;
+        if (BoardLedStrip_Show(s) != 0) { r->ok = 0; break; }
+        BoardLedStrip_GetStats(s, &st);
+        enc_ns += st.encode_ns;
+        if (g_dev.cap_len != st.frame_bytes ||
+            _decode(g_dev.cap, g_dev.cap_len, r->sym_bits, got, nbytes) != 0 ||
+            memcmp(got, want, nbytes) != 0) {
+            r->ok = 0;
+            break;
+        }
+    }
+    r->ns_per_led = (double)enc_ns / ((double)a->frames * a->leds);
+    BoardLedStrip_Close(s);
+    free(g_dev.cap);
+    g_dev.cap = NULL;
+    free(want);
+    free(got);
+    return 0;
+}
+
+static void _render(BoardLedStrip* s, unsigned leds, unsigned frame) {
+    for (unsigned i = 0; i < leds; ++i) {
+        unsigned h = (i * 3u + frame * 5u) % 768u;
+        uint8_t  x = (uint8_t)(h & 255u);
+        switch (h >> 8) {
+        case 0:  BoardLedStrip_SetPixel(s, i, (uint8_t)(255 - x), x, 0, 0); break;
+        case 1:  BoardLedStrip_SetPixel(s, i, 0, (uint8_t)(255 - x), x, 0); break;
+        default: BoardLedStrip_SetPixel(s, i, x, 0, (uint8_t)(255 - x), 0); break;
+        }
+    }
+}
+
+/* fps với render + Show; task = 1: TX task double buffer */
+static double _run_fps(const StripArgs* a, int task, BoardLedStripStats* st) {
+    BoardLedStrip* s = NULL;
+    if (_open(a, 4, 0, &s) != 0) return -1.0;
+    if (task && BoardLedStrip_Start(s, 0) != 0) { BoardLedStrip_Close(s); return -1.0; }
+    uint64_t t0 = Bench_NowNs();
+    for (unsigned f = 0; f < a->frames; ++f) {
+        _render(s, a->leds, f);
+        BoardLedStrip_Show(s);
+    }
+    BoardLedStrip_Flush(s);
+    uint64_t dt = Bench_NowNs() - t0;
+    BoardLedStrip_GetStats(s, st);
+    BoardLedStrip_Close(s);
+    return dt ? (double)a->frames * 1e9 / (double)dt : 0.0;
+}
+
+static void _usage(void) {
+    fprintf(stderr,
+            "usage: bench_ledstrip [-n leds] [-f frames] [-B brightness] [-m bufsiz] [-w] [-s seed] [-j]\n"
+            "  -n  LEDs (RGB, default 1000)\n"
+            "  -f  frames per pass (default 200)\n"
+            "  -B  brightness 1..255 (default 255)\n"
+            "  -m  fake spidev bufsiz: longer messages fail with EMSGSIZE, 0 = unlimited (default 4096)\n"
+            "  -w  fake ioctl sleeps for the wire time (fps limited by 800 kHz)\n");
+}
+
+int main(int argc, char** argv) {
+    StripArgs a = { .leds = 1000, .frames = 200, .bright = 255, .bufsiz = 4096, .seed = 12345 };
+    int opt;
+    while ((opt = getopt(argc, argv, "n:f:B:m:ws:jh")) != -1) {
+        switch (opt) {
+        case 'n': a.leds   = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'f': a.frames = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'B': a.bright = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'm': a.bufsiz = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'w': a.wire   = 1; break;
+        case 's': a.seed   = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'j': a.json   = 1; break;
+        default:  _usage(); return 2;
+        }
+    }
+    if (!a.leds || a.leds > 100000 || !a.frames || !a.bright || a.bright > 255) {
+        _usage();
+        return 2;
+    }
+    Bench_ClockInit(0);
+    g_dev.bufsiz = a.bufsiz;
+
+    EncResult enc[3] = {
+        { .name = "lut3", .sym_bits = 3, .no_simd = 1 },
+        { .name = "lut4", .sym_bits = 4, .no_simd = 1 },
+        { .name = "simd4", .sym_bits = 4, .no_simd = 0 },
+    };
+    int ok = 1;
+    for (int i = 0; i < 3; ++i) {
+        if (_run_encode(&a, &enc[i]) != 0) {
+            fprintf(stderr, "[BENCH] fake spidev / strip setup failed\n");
+            return 1;
+        }
+        ok &= enc[i].ok;
+    }
+
+    g_dev.wire = a.wire;
+    BoardLedStripStats st_sync = { 0 }, st_task = { 0 };
+    double fps_sync = _run_fps(&a, 0, &st_sync);
+    double fps_task = _run_fps(&a, 1, &st_task);
+    ok &= (fps_sync > 0 && fps_task > 0 && !st_sync.tx_errors && !st_task.tx_errors);
+    /* giới hạn dây: 24 bit x 1.25 µs / LED + đuôi reset 300 µs */
+    double wire_fps = 1e6 / (a.leds * 30.0 + 300.0);
+
+    if (a.json) {
+        printf("{\"leds\":%u,\"frames\":%u,\"brightness\":%u,\"bufsiz\":%u,\"wire\":%s,\"ok\":%s,\"encode\":{",
+               a.leds, a.frames, a.bright, a.bufsiz, a.wire ? "true" : "false", ok ? "true" : "false");
+        for (int i = 0; i < 3; ++i)
+            printf("%s\"%s\":{\"ok\":%s,\"simd\":%d,\"ns_per_led\":%.2f}", i ? "," : "", enc[i].name,
+                   enc[i].ok ? "true" : "false", enc[i].simd, enc[i].ns_per_led);
+        printf("},\"fps\":{\"sync\":%.1f,\"task\":%.1f,\"wire_limit\":%.1f,\"frame_bytes\":%u,"
+               "\"messages_per_frame\":%.2f}}\n",
+               fps_sync, fps_task, wire_fps, st_task.frame_bytes,
+               st_task.frames ? (double)st_task.messages / (double)st_task.frames : 0.0);
+    } else {
+        printf("=== bench-ledstrip: %u LEDs, %u frames, brightness %u, bufsiz %u%s ===\n",
+               a.leds, a.frames, a.bright, a.bufsiz, a.wire ? ", wire-timed" : "");
+        for (int i = 0; i < 3; ++i)
+            printf("encode %-5s: %6.2f ns/LED  %s%s\n", enc[i].name, enc[i].ns_per_led,
+                   enc[i].ok ? "decode OK" : "decode MISMATCH",
+                   (enc[i].sym_bits == 4 && !enc[i].no_simd && !enc[i].simd) ? "  (no SIMD on this CPU)" : "");
+        printf("fps sync    : %8.1f  (render + encode + TX in one thread)\n", fps_sync);
+        printf("fps task    : %8.1f  (double buffer, TX task)  wire limit %.1f fps\n", fps_task, wire_fps);
+        printf("frame       : %u byte SPI, %.2f message/frame, tx errors %llu\n", st_task.frame_bytes,
+               st_task.frames ? (double)st_task.messages / (double)st_task.frames : 0.0,
+               (unsigned long long)(st_sync.tx_errors + st_task.tx_errors));
+        printf("result      : %s\n", ok ? "OK" : "MISMATCH");
+    }
+    return ok ? 0 : 1;
+}
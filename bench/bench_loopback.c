@@ -0,0 +1,320 @@
+/**
+ * @file bench_loopback.c
+ * @brief End-to-end reaction latency: output toggled -> application handler
+ *        sees the edge on a looped-back input, per input strategy.
+ *
+ * The output line is wired to the input: a jumper on real hardware, or
+ * HAL_GpioSim_Link() on a "sim:" chip (default). The main thread writes the
+ * output and takes t0 just before the write; a responder thread runs one
+ * input strategy and stamps t1 in its handler. latency = t1 - t0, both on
+ * CLOCK_MONOTONIC_RAW, so the number includes the write, the wakeup and the
+ * strategy's own delay (poll period, scheduler, event read).
+ *
+ * Strategies (-m, comma separated; default all):
+ *  - poll:<us> : HAL_GpioLine_Read every <us> (absolute-deadline sleep)
+ *  - wait      : HAL_GpioLine_WaitEvent, one event per call
+ *  - batch     : HAL_GpioLine_ReadEvents, handler per event of the batch
+ *  - epoll     : epoll_wait on HAL_GpioLine_GetEventFd, then WaitEvent(0)
+ *                (skipped when the backend has no event fd, e.g. sim)
+ *
+ * Toggles are spaced by -g us plus a random 0..g/2 so polling strategies are
+ * not phase-locked to the stimulus. A toggle the handler does not see within
+ * 1 s counts as missed.
+ *
+ * Usage:
+ *   bench_loopback [-c chip] [-o out_off] [-i in_off] [-m modes] [-n toggles]
+ *                  [-g gap_us] [-C cpu] [-F fifo_prio] [-t] [-j]
+ */
+#define _GNU_SOURCE
+#include "bench_hist.h"
+#include "bench_util.h"
+
+#include "hal_gpio.h"
+#include "hal_gpio_sim.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_MODES   8
+#define MISS_NS     1000000000ull
+#define EV_BATCH    16
+
+typedef enum { LB_POLL = 0, LB_WAIT, LB_BATCH, LB_EPOLL } LbKind;
+
+typedef struct {
+    LbKind   kind;
+    unsigned period_us;     /* LB_POLL */
+    char     name[24];
+} LbMode;
+
+typedef struct {
+    const char* chip;
+    int         out_off, in_off;
+    LbMode      modes[MAX_MODES];
+    int         nmodes;
+    unsigned    toggles;
+    unsigned    gap_us;
+    int         cpu;
+    int         fifo;
+    int         table;
+    int         json;
+} LbArgs;
+
+typedef struct {
+    BenchHist hist;
+    uint64_t  missed;
+    int       skipped;
+} LbResult;
+
+/* responder -> main: số lần handler chạy + thời điểm của lần gần nhất */
+static uint64_t     s_seen_ns;
+static uint32_t     s_seen_seq;
+static volatile int s_run;
+
+typedef struct {
+    HAL_GpioLine* in;
+    LbMode        mode;
+    int           epfd;
+} Responder;
+
+/* "handler của ứng dụng": việc duy nhất là đóng dấu thời gian */
+static void _handler(void) {
+    __atomic_store_n(&s_seen_ns, Bench_NowNs(), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&s_seen_seq, 1u, __ATOMIC_RELEASE);
+}
+
+static void* _responder(void* arg) {
+    Responder* r = (Responder*)arg;
+    HAL_GpioEvent evs[EV_BATCH];
+    int last = -1;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (s_run) {
+        switch (r->mode.kind) {
+        case LB_POLL: {
+            int v = 0;
+            if (HAL_GpioLine_Read(r->in, &v) == HAL_GPIO_OK) {
+                if (last >= 0 && v != last) _handler();
+                last = v;
+            }
+            next.tv_nsec += (long)r->mode.period_us * 1000L;
+            while (next.tv_nsec >= 1000000000L) { next.tv_nsec -= 1000000000L; next.tv_sec++; }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+            break;
+        }
+        case LB_WAIT:
+            if (HAL_GpioLine_WaitEvent(r->in, 100, &evs[0]) == HAL_GPIO_OK) _handler();
+            break;
+        case LB_BATCH: {
+            size_t n = 0;
+            if (HAL_GpioLine_ReadEvents(r->in, 100, evs, EV_BATCH, &n) == HAL_GPIO_OK)
+                for (size_t i = 0; i < n; ++i) _handler();
+            break;
+        }
+        case LB_EPOLL: {
+            struct epoll_event ee;
+            if (epoll_wait(r->epfd, &ee, 1, 100) > 0)
+                while (HAL_GpioLine_WaitEvent(r->in, 0, &evs[0]) == HAL_GPIO_OK) _handler();
+            break;
+        }
+        }
+    }
+    return NULL;
+}
+
+static uint32_t _rng(uint32_t* s) {
+    uint32_t x = *s;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return *s = x;
+}
+
+static void _sleep_us(unsigned us) {
+    struct timespec ts = { (time_t)(us / 1000000u), (long)(us % 1000000u) * 1000L };
+    nanosleep(&ts, NULL);
+}
+
+static int _run_mode(const LbArgs* a, HAL_GpioChip* chip, HAL_GpioLine* out, const LbMode* m, LbResult* res) {
+    BenchHist_Reset(&res->hist);
+    HAL_GpioLineConfig ic = {
+        .offset = a->in_off, .dir = HAL_GPIO_DIR_IN,
+        .edge = (m->kind == LB_POLL) ? HAL_GPIO_EDGE_NONE : HAL_GPIO_EDGE_BOTH,
+    };
+    Responder r = { .mode = *m, .epfd = -1 };
+    if (HAL_GpioLine_Request(chip, &ic, &r.in) != HAL_GPIO_OK) {
+        fprintf(stderr, "[BENCH] request input %d failed\n", a->in_off);
+        return -1;
+    }
+    if (m->kind == LB_EPOLL) {
+        int fd = HAL_GpioLine_GetEventFd(r.in);
+        if (fd < 0) {
+            res->skipped = 1;
+            HAL_GpioLine_Release(r.in);
+            return 0;
+        }
+        struct epoll_event ee = { .events = EPOLLIN, .data.fd = fd };
+        r.epfd = epoll_create1(EPOLL_CLOEXEC);
+        if (r.epfd < 0 || epoll_ctl(r.epfd, EPOLL_CTL_ADD, fd, &ee) != 0) {
+            fprintf(stderr, "[BENCH] epoll setup failed: %s\n", strerror(errno));
+            HAL_GpioLine_Release(r.in);
+            return -1;
+        }
+    }
+
+    s_run = 1;
+    __atomic_store_n(&s_seen_seq, 0u, __ATOMIC_RELAXED);
+    pthread_t th;
+    if (pthread_create(&th, NULL, _responder, &r) != 0) {
+        HAL_GpioLine_Release(r.in);
+        return -1;
+    }
+    _sleep_us(20000);     /* responder vào vòng chờ trước khi kích */
+
+    uint32_t rng = 0x9e3779b9u;
+    int level = 0;
+    HAL_GpioLine_Write(out, level);
+    _sleep_us(a->gap_us);
+    uint32_t seq = __atomic_load_n(&s_seen_seq, __ATOMIC_ACQUIRE);
+
+    for (unsigned k = 0; k < a->toggles; ++k) {
+        level ^= 1;
+        uint64_t t0 = Bench_NowNs();
+        HAL_GpioLine_Write(out, level);
+        for (;;) {
+            uint32_t s = __atomic_load_n(&s_seen_seq, __ATOMIC_ACQUIRE);
+            if (s != seq) {
+                uint64_t t1 = __atomic_load_n(&s_seen_ns, __ATOMIC_RELAXED);
+                BenchHist_Record(&res->hist, t1 > t0 ? t1 - t0 : 0);
+                seq = s;
+                break;
+            }
+            if (Bench_NowNs() - t0 > MISS_NS) {
+                res->missed++;
+                break;
+            }
+            _sleep_us(10);    /* không tranh CPU với responder trên máy 1 core */
+        }
+        _sleep_us(a->gap_us + _rng(&rng) % (a->gap_us / 2u + 1u));
+    }
+
+    s_run = 0;
+    pthread_join(th, NULL);
+    if (r.epfd >= 0) close(r.epfd);
+    HAL_GpioLine_Release(r.in);
+    return 0;
+}
+
+static int _parse_modes(LbArgs* a, const char* spec) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", spec);
+    a->nmodes = 0;
+    for (char* tok = strtok(buf, ","); tok && a->nmodes < MAX_MODES; tok = strtok(NULL, ",")) {
+        LbMode* m = &a->modes[a->nmodes];
+        memset(m, 0, sizeof(*m));
+        if (strncmp(tok, "poll:", 5) == 0) {
+            m->kind = LB_POLL;
+            m->period_us = (unsigned)strtoul(tok + 5, NULL, 0);
+            if (!m->period_us) return -1;
+        } else if (strcmp(tok, "wait")  == 0) m->kind = LB_WAIT;
+        else if (strcmp(tok, "batch") == 0) m->kind = LB_BATCH;
+        else if (strcmp(tok, "epoll") == 0) m->kind = LB_EPOLL;
+        else return -1;
+        snprintf(m->name, sizeof(m->name), "%.23s", tok);
+        a->nmodes++;
+    }
+    return a->nmodes ? 0 : -1;
+}
+
+static void _usage(void) {
+    fprintf(stderr,
+            "usage: bench_loopback [-c chip] [-o out_off] [-i in_off] [-m modes] [-n toggles]\n"
+            "                      [-g gap_us] [-C cpu] [-F fifo_prio] [-t] [-j]\n"
+            "  -c  chip (default sim:loopback, linked internally; real chips need a jumper)\n"
+            "  -m  poll:<us>,wait,batch,epoll (default poll:100,poll:1000,wait,batch,epoll)\n"
+            "  -n  toggles per strategy (default 2000), -g gap between toggles (default 1000 us)\n"
+            "  -t  also print the histogram table (10 us buckets up to 1 ms)\n");
+}
+
+int main(int argc, char** argv) {
+    LbArgs a = { .chip = "sim:loopback", .out_off = 0, .in_off = 1, .toggles = 2000, .gap_us = 1000, .cpu = -1 };
+    const char* modes = "poll:100,poll:1000,wait,batch,epoll";
+    int opt;
+    while ((opt = getopt(argc, argv, "c:o:i:m:n:g:C:F:tjh")) != -1) {
+        switch (opt) {
+        case 'c': a.chip    = optarg; break;
+        case 'o': a.out_off = atoi(optarg); break;
+        case 'i': a.in_off  = atoi(optarg); break;
+        case 'm': modes     = optarg; break;
+        case 'n': a.toggles = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'g': a.gap_us  = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'C': a.cpu     = atoi(optarg); break;
+        case 'F': a.fifo    = atoi(optarg); break;
+        case 't': a.table   = 1; break;
+        case 'j': a.json    = 1; break;
+        default:  _usage(); return 2;
+        }
+    }
+    if (_parse_modes(&a, modes) != 0 || !a.toggles || !a.gap_us) {
+        _usage();
+        return 2;
+    }
+    Bench_ClockInit(0);
+    if (Bench_PinCpu(a.cpu) != 0) fprintf(stderr, "[BENCH] pin to CPU %d failed\n", a.cpu);
+    if (a.fifo && Bench_SetFifo(a.fifo) != 0) fprintf(stderr, "[BENCH] SCHED_FIFO %d failed\n", a.fifo);
+
+    HAL_GpioChip* chip = NULL;
+    HAL_GpioChipConfig cc = { .chip_name = a.chip };
+    if (HAL_GpioChip_Open(&cc, &chip) != HAL_GPIO_OK) {
+        fprintf(stderr, "[BENCH] open chip %s failed\n", a.chip);
+        return 1;
+    }
+    HAL_GpioLineConfig oc = { .offset = a.out_off, .dir = HAL_GPIO_DIR_OUT };
+    HAL_GpioLine* out = NULL;
+    if (HAL_GpioLine_Request(chip, &oc, &out) != HAL_GPIO_OK) {
+        fprintf(stderr, "[BENCH] request output %d failed\n", a.out_off);
+        return 1;
+    }
+    /* chip sim: nối dây trong sim; chip thật: cần jumper out -> in */
+    int sim = (HAL_GpioSim_Link(chip, a.out_off, a.in_off) == HAL_GPIO_OK);
+
+    static LbResult res[MAX_MODES];
+    for (int i = 0; i < a.nmodes; ++i) {
+        if (_run_mode(&a, chip, out, &a.modes[i], &res[i]) != 0) return 1;
+    }
+
+    if (a.json) {
+        printf("{\"chip\":\"%s\",\"toggles\":%u,\"gap_us\":%u,\"modes\":{", a.chip, a.toggles, a.gap_us);
+        for (int i = 0; i < a.nmodes; ++i) {
+            printf("%s\"%s\":", i ? "," : "", a.modes[i].name);
+            if (res[i].skipped) { printf("null"); continue; }
+            printf("{\"missed\":%llu,\"latency_ns\":", (unsigned long long)res[i].missed);
+            BenchHist_PrintJson(stdout, &res[i].hist);
+            printf("}");
+        }
+        printf("}}\n");
+    } else {
+        printf("=== bench-loopback: %s out %d -> in %d (%s), %u toggles, gap %u us ===\n",
+               a.chip, a.out_off, a.in_off, sim ? "sim link" : "jumper", a.toggles, a.gap_us);
+        for (int i = 0; i < a.nmodes; ++i) {
+            if (res[i].skipped) {
+                printf("%-12s skipped (backend has no event fd)\n", a.modes[i].name);
+                continue;
+            }
+            BenchHist_PrintSummary(stdout, a.modes[i].name, &res[i].hist, 1000.0, "us");
+            if (res[i].missed) printf("%-12s missed %llu\n", "", (unsigned long long)res[i].missed);
+            if (a.table) BenchHist_PrintTable(stdout, &res[i].hist, 10000, 1000000);
+        }
+    }
+
+    if (sim) HAL_GpioSim_Link(chip, a.out_off, -1);
+    HAL_GpioLine_Release(out);
+    HAL_GpioChip_Close(chip);
+    return 0;
+}
@@ -0,0 +1,319 @@
+/**
+ * @file bench_osal.c
+ * @brief cyclictest-style scheduling latency benchmark for the OSAL Linux backend.
+ *
+ * For every requested OSAL priority one measuring task is created through
+ * OSAL_TaskCreate and, in turn, measures:
+ *  - delay   : OSAL_TaskDelayMs(period) overshoot (relative sleep)
+ *  - abs     : OSAL_TaskDelayUntilUs(period) overshoot (absolute deadline)
+ * Then a victim task at the same priority is suspended / resumed by the
+ * controller to measure:
+ *  - park    : OSAL_TaskSuspend() -> task actually parked (state SUSPENDED)
+ *  - resume  : OSAL_TaskResume()  -> task runs again
+ *
+ * The scheduling policy each task really obtained (SCHED_FIFO, or the
+ * SCHED_OTHER fallback without CAP_SYS_NICE) is reported with the results.
+ *
+ * Background load (optional): CPU hog threads, I/O threads (write+fsync)
+ * and extra OSAL tasks doing 1 ms delays.
+ *
+ * Usage:
+ *   bench_osal [-p prio,prio,..] [-i period_us] [-l loops] [-S cycles]
+ *              [-L hogs] [-I io_threads] [-O osal_tasks] [-H max_us] [-j out.json]
+ */
+#define _GNU_SOURCE
+#include "bench_hist.h"
+
+#include "osal.h"
+#include "osal_task.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_PRIOS  8
+#define MAX_LOAD   32
+
+typedef enum { M_DELAY = 0, M_ABS, M_PARK, M_RESUME, M_COUNT } Measure;
+static const char* const s_mname[M_COUNT] = { "delay", "abs", "park", "resume" };
+
+typedef struct {
+    uint8_t          prio;
+    int              policy;        /* observed inside the task */
+    int              rt_prio;
+    BenchHist        h[M_COUNT];
+    volatile int     done;
+    /* victim state for park/resume */
+    volatile uint64_t last_run_ns;
+} PrioCtx;
+
+typedef struct {
+    unsigned    nprio;
+    uint8_t     prios[MAX_PRIOS];
+    uint32_t    period_us;
+    unsigned    loops;
+    unsigned    cycles;          /* suspend/resume cycles */
+    unsigned    hogs, io, osal_bg;
+    unsigned    hist_max_us;
+    const char* json_path;
+} BenchArgs;
+
+static BenchArgs     s_args;
+static volatile int  s_load_stop;
+
+static uint64_t _now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void _quiet_log(const char* fmt, ...) {
+    /* OSAL logs go to stderr so they do not mix with results */
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+}
+
+static void _observe_policy(PrioCtx* c) {
+    struct sched_param sp;
+    int pol = 0;
+    pthread_getschedparam(pthread_self(), &pol, &sp);
+    c->policy  = pol;
+    c->rt_prio = sp.sched_priority;
+}
+
+/* ---------- measuring tasks ---------- */
+
+static void MeasureTask(void* arg) {
+    PrioCtx* c = (PrioCtx*)arg;
+    _observe_policy(c);
+
+    const uint32_t ms = (s_args.period_us + 999u) / 1000u;
+    for (unsigned i = 0; i < s_args.loops; ++i) {
+        uint64_t t0 = _now_ns();
+        OSAL_TaskDelayMs(ms);
+        uint64_t t1 = _now_ns();
+        uint64_t want = (uint64_t)ms * 1000000ull;
+        BenchHist_Record(&c->h[M_DELAY], (t1 - t0 > want) ? (t1 - t0 - want) : 0);
+    }
+
+    uint64_t wake_us = 0;
+    OSAL_TaskDelayUntilUs(&wake_us, s_args.period_us);  /* arm */
+    for (unsigned i = 0; i < s_args.loops; ++i) {
+        OSAL_TaskDelayUntilUs(&wake_us, s_args.period_us);
+        uint64_t t = _now_ns();
+        uint64_t deadline = wake_us * 1000ull;
+        BenchHist_Record(&c->h[M_ABS], (t > deadline) ? t - deadline : 0);
+    }
+    c->done = 1;
+}
+
+/* Victim: runs 1 ms delays forever, stamps every return. */
+static void VictimTask(void* arg) {
+    PrioCtx* c = (PrioCtx*)arg;
+    for (;;) {
+        OSAL_TaskDelayMs(1);
+        __atomic_store_n(&c->last_run_ns, _now_ns(), __ATOMIC_RELEASE);
+    }
+}
+
+static void _measure_suspend(PrioCtx* c) {
+    OSAL_TaskHandle h = NULL;
+    OSAL_TaskAttr a = { .name = "bench_victim", .stack_size = 16384, .prio = c->prio };
+    if (OSAL_TaskCreate(&h, VictimTask, c, &a) != OSAL_OK) {
+        fprintf(stderr, "[BENCH][OSAL] victim create failed (prio %u)\n", c->prio);
+        return;
+    }
+    usleep(20000);
+    for (unsigned i = 0; i < s_args.cycles; ++i) {
+        OSAL_TaskState st = OSAL_TASK_STATE_INVALID;
+        uint64_t t_s = _now_ns();
+        OSAL_TaskSuspend(h);
+        uint64_t limit = t_s + 1000000000ull;
+        do {
+            OSAL_TaskGetState(h, &st);
+        } while (st != OSAL_TASK_STATE_SUSPENDED && _now_ns() < limit);
+        if (st == OSAL_TASK_STATE_SUSPENDED) BenchHist_Record(&c->h[M_PARK], _now_ns() - t_s);
+
+        usleep(2000);
+        uint64_t t_r = _now_ns();
+        OSAL_TaskResume(h);
+        limit = t_r + 1000000000ull;
+        uint64_t run;
+        while ((run = __atomic_load_n(&c->last_run_ns, __ATOMIC_ACQUIRE)) < t_r && _now_ns() < limit) {
+        }
+        if (run >= t_r) BenchHist_Record(&c->h[M_RESUME], run - t_r);
+        usleep(2000);
+    }
+    OSAL_TaskDelete(h);
+}
+
+/* ---------- background load ---------- */
+
+static void* _hog(void* arg) {
+    (void)arg;
+    volatile uint64_t x = 0;
+    while (!s_load_stop) x++;
+    return NULL;
+}
+
+static void* _io(void* arg) {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/bench_osal_io.%d.%ld", (int)getpid(), (long)(intptr_t)arg);
+    int fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0600);
+    unlink(path);
+    if (fd < 0) return NULL;
+    char buf[4096];
+    memset(buf, 0xA5, sizeof(buf));
+    unsigned n = 0;
+    while (!s_load_stop) {
+        if (write(fd, buf, sizeof(buf)) < 0) break;
+        if ((++n & 15u) == 0) { fsync(fd); lseek(fd, 0, SEEK_SET); }
+    }
+    close(fd);
+    return NULL;
+}
+
+static void BgOsalTask(void* arg) {
+    (void)arg;
+    for (;;) {
+        volatile unsigned spin = 0;
+        for (unsigned i = 0; i < 20000u; ++i) spin += i;
+        OSAL_TaskDelayMs(1);
+    }
+}
+
+/* ---------- main ---------- */
+
+static void _usage(const char* prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -p list    OSAL priorities (0..255, comma separated, default 10,128,250)\n"
+        "  -i us      period in microseconds (default 1000)\n"
+        "  -l loops   samples per priority for delay/abs (default 2000)\n"
+        "  -S cycles  suspend/resume cycles per priority (default 200)\n"
+        "  -L n       CPU hog threads\n"
+        "  -I n       I/O (write+fsync) threads\n"
+        "  -O n       background OSAL tasks (1 ms delay + busy work)\n"
+        "  -H max_us  print histogram table up to max_us (1 us buckets)\n"
+        "  -j file    write JSON results\n", prog);
+}
+
+static int _parse_args(int argc, char** argv, BenchArgs* a) {
+    memset(a, 0, sizeof(*a));
+    a->nprio = 3; a->prios[0] = 10; a->prios[1] = 128; a->prios[2] = 250;
+    a->period_us = 1000; a->loops = 2000; a->cycles = 200;
+    int opt;
+    while ((opt = getopt(argc, argv, "p:i:l:S:L:I:O:H:j:h")) != -1) {
+        switch (opt) {
+            case 'p': {
+                a->nprio = 0;
+                char* save = NULL;
+                for (char* tok = strtok_r(optarg, ",", &save); tok && a->nprio < MAX_PRIOS;
+                     tok = strtok_r(NULL, ",", &save)) {
+                    a->prios[a->nprio++] = (uint8_t)atoi(tok);
+                }
+                break;
+            }
+            case 'i': a->period_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'l': a->loops = (unsigned)strtoul(optarg, NULL, 0); break;
+            case 'S': a->cycles = (unsigned)strtoul(optarg, NULL, 0); break;
+            case 'L': a->hogs = (unsigned)atoi(optarg); break;
+            case 'I': a->io = (unsigned)atoi(optarg); break;
+            case 'O': a->osal_bg = (unsigned)atoi(optarg); break;
+            case 'H': a->hist_max_us = (unsigned)atoi(optarg); break;
+            case 'j': a->json_path = optarg; break;
+            default: return -1;
+        }
+    }
+    if (!a->nprio || !a->period_us || !a->loops) return -1;
+    if (a->hogs > MAX_LOAD || a->io > MAX_LOAD || a->osal_bg > MAX_LOAD) return -1;
+    return 0;
+}
+
+static const char* _policy_name(int p) {
+    return (p == SCHED_FIFO) ? "FIFO" : (p == SCHED_RR) ? "RR" : "OTHER";
+}
+
+int main(int argc, char** argv) {
+    if (_parse_args(argc, argv, &s_args) != 0) {
+        _usage(argv[0]);
+        return 2;
+    }
+    OSAL_Config cfg = { .backend = OSAL_BACKEND_LINUX, .log = _quiet_log, .platform_ctx = NULL };
+    OSAL_Init(&cfg);
+
+    pthread_t load[2 * MAX_LOAD];
+    unsigned nload = 0;
+    for (unsigned i = 0; i < s_args.hogs; ++i) pthread_create(&load[nload++], NULL, _hog, NULL);
+    for (unsigned i = 0; i < s_args.io; ++i)   pthread_create(&load[nload++], NULL, _io, (void*)(intptr_t)i);
+    OSAL_TaskHandle bg[MAX_LOAD] = {0};
+    for (unsigned i = 0; i < s_args.osal_bg; ++i) {
+        OSAL_TaskAttr a = { .name = "bench_bg", .stack_size = 16384, .prio = 64 };
+        if (OSAL_TaskCreate(&bg[i], BgOsalTask, NULL, &a) != OSAL_OK) {
+            fprintf(stderr, "[BENCH][OSAL] only %u background tasks (OSAL_MAX_TASKS)\n", i);
+            break;
+        }
+    }
+
+    static PrioCtx ctx[MAX_PRIOS];
+    for (unsigned p = 0; p < s_args.nprio; ++p) {
+        PrioCtx* c = &ctx[p];
+        memset(c, 0, sizeof(*c));
+        c->prio = s_args.prios[p];
+        for (int m = 0; m < M_COUNT; ++m) BenchHist_Reset(&c->h[m]);
+
+        OSAL_TaskHandle h = NULL;
+        OSAL_TaskAttr a = { .name = "bench_meas", .stack_size = 16384, .prio = c->prio };
+        if (OSAL_TaskCreate(&h, MeasureTask, c, &a) != OSAL_OK) {
+            fprintf(stderr, "[BENCH][OSAL] task create failed (prio %u)\n", c->prio);
+            continue;
+        }
+        while (!c->done) usleep(10000);
+        OSAL_TaskDelete(h);
+        _measure_suspend(c);
+    }
+
+    s_load_stop = 1;
+    for (unsigned i = 0; i < nload; ++i) pthread_join(load[i], NULL);
+    for (unsigned i = 0; i < s_args.osal_bg; ++i) if (bg[i]) OSAL_TaskDelete(bg[i]);
+
+    printf("=== bench-osal: period=%u us loops=%u load: hogs=%u io=%u osal=%u ===\n",
+           s_args.period_us, s_args.loops, s_args.hogs, s_args.io, s_args.osal_bg);
+    for (unsigned p = 0; p < s_args.nprio; ++p) {
+        PrioCtx* c = &ctx[p];
+        printf("-- prio %u -> %s %d\n", c->prio, _policy_name(c->policy), c->rt_prio);
+        for (int m = 0; m < M_COUNT; ++m) {
+            BenchHist_PrintSummary(stdout, s_mname[m], &c->h[m], 1000.0, "us");
+            if (s_args.hist_max_us) BenchHist_PrintTableRows(stdout, &c->h[m], 1000, (uint64_t)s_args.hist_max_us * 1000u);
+        }
+    }
+
+    if (s_args.json_path) {
+        FILE* f = fopen(s_args.json_path, "w");
+        if (!f) { perror(s_args.json_path); return 1; }
+        fprintf(f, "{\"period_us\":%u,\"loops\":%u,\"load\":{\"hogs\":%u,\"io\":%u,\"osal\":%u},\"unit\":\"ns\",\"prios\":[",
+                s_args.period_us, s_args.loops, s_args.hogs, s_args.io, s_args.osal_bg);
+        for (unsigned p = 0; p < s_args.nprio; ++p) {
+            PrioCtx* c = &ctx[p];
+            fprintf(f, "%s{\"prio\":%u,\"policy\":\"%s\",\"rt_prio\":%d", p ? "," : "",
+                    c->prio, _policy_name(c->policy), c->rt_prio);
+            for (int m = 0; m < M_COUNT; ++m) {
+                fprintf(f, ",\"%s\":", s_mname[m]);
+                BenchHist_PrintJson(f, &c->h[m]);
+            }
+            fprintf(f, "}");
+        }
+        fprintf(f, "]}\n");
+        fclose(f);
+    }
+    return 0;
+}
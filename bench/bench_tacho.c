@@ -0,0 +1,243 @@
+/**
+ * @file bench_tacho.c
+ * @brief Tacho service accuracy and cost on the sim backend (virtual
+ *        timeline, no sleeping, no task: BoardTacho_Poll is called inline).
+ *
+ * A seeded PWM is played on one sim line; every period is drawn uniformly
+ * from T ± J (expected jitter = J / sqrt(3)). Three passes:
+ *
+ *  - fast  : -f Hz (default 1 kHz) at -d % duty. Faster than
+ *            BOARD_TACHO_RING / window_ms, so the window must hold exactly
+ *            BOARD_TACHO_RING periods and window_ns ~ BOARD_TACHO_RING * T.
+ *  - slow  : 20 Hz, the time window (1 s) is the limit: ~20 samples.
+ *  - stall : the signal stops; after stall_ms the channel reports
+ *            stalled, no samples, freq 0.
+ *
+ * Checks: freq within 1 %, duty within 1 point, jitter within 25 % of the
+ * expected value. ns/edge is the Poll cost (drain + ring + publish) only.
+ *
+ * Usage:
+ *   bench_tacho [-f freq_hz] [-d duty_pct] [-J jitter_us] [-n periods] [-s seed] [-j]
+ */
+#define _GNU_SOURCE
+#include "bench_util.h"
+
+#include "board_tacho.h"
+#include "hal_gpio.h"
+#include "hal_gpio_sim.h"
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LINE_TACHO 0
+#define WINDOW_MS  1000u
+#define POLL_EVERY 50u     /* chu kỳ giữa hai lần Poll: 100 event < 256 của sim */
+
+typedef struct {
+    unsigned freq_hz;
+    unsigned duty_pct;
+    unsigned jitter_us;
+    unsigned periods;
+    uint32_t seed;
+    int      json;
+} TachoArgs;
+
+typedef struct {
+    unsigned         freq_hz;
+    double           jitter_expect_ns;
+    BoardTachoResult r;
+    double           ns_per_edge;
+    int              ok;
+} TachoPass;
+
+static uint32_t _rng(uint32_t* s) {
+    uint32_t x = *s;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return *s = x;
+}
+
+static uint64_t _sim_now_ns(void* ctx) {
+    return HAL_GpioSim_Now((HAL_GpioChip*)ctx) * 1000ull;
+}
+
+/* chip sim + service không task, một kênh trên LINE_TACHO */
+static int _open(HAL_GpioChip** chip, int* id) {
+    HAL_GpioChipConfig cc = { .chip_name = "sim:tacho" };
+    if (HAL_GpioChip_Open(&cc, chip) != HAL_GPIO_OK) return -1;
+    HAL_GpioSim_UseVirtualTime(*chip, 1);
+    BoardTachoCfg cfg = { .now_ns = _sim_now_ns, .now_ctx = *chip };
+    BoardTachoSpec spec = { .name = "tacho0", .chip = *chip, .offset = LINE_TACHO, .window_ms = WINDOW_MS };
+    if (BoardTacho_Init(&cfg, 1) != 0 || (*id = BoardTacho_Add(&spec)) < 0) {
+        BoardTacho_Stop();
+        HAL_GpioChip_Close(*chip);
+        return -1;
+    }
+    return 0;
+}
+
+static void _close(HAL_GpioChip* chip) {
+    BoardTacho_Stop();
+    HAL_GpioChip_Close(chip);
+}
+
+/* phát n chu kỳ PWM, Poll mỗi POLL_EVERY chu kỳ; trả về tick của Poll */
+static uint64_t _play(HAL_GpioChip* chip, unsigned freq_hz, unsigned duty_pct, unsigned jitter_us,
+                      unsigned n, uint32_t* rng) {
+    uint64_t period_us = 1000000ull / freq_hz;
+    uint64_t ticks = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        int64_t  j   = jitter_us ? (int64_t)(_rng(rng) % (2u * jitter_us + 1u)) - (int64_t)jitter_us : 0;
+        uint64_t per = (uint64_t)((int64_t)period_us + j);
+        uint64_t hi  = per * duty_pct / 100u;
+        HAL_GpioSim_SetInput(chip, LINE_TACHO, 1);
+        HAL_GpioSim_Advance(chip, hi);
+        HAL_GpioSim_SetInput(chip, LINE_TACHO, 0);
+        HAL_GpioSim_Advance(chip, per - hi);
+        if ((i + 1) % POLL_EVERY == 0) {
+            uint64_t t0 = Bench_Ticks();
+            BoardTacho_Poll(0);
+            ticks += Bench_Ticks() - t0;
+        }
+    }
+    /* cạnh lên kết thúc chu kỳ cuối */
+    HAL_GpioSim_SetInput(chip, LINE_TACHO, 1);
+    uint64_t t0 = Bench_Ticks();
+    BoardTacho_Poll(0);
+    return ticks + Bench_Ticks() - t0;
+}
+
+/* freq / duty / jitter so với giá trị đặt */
+static int _check(const TachoPass* p, unsigned duty_pct) {
+    double f = (double)p->freq_hz;
+    int ok = !p->r.stalled && fabs(p->r.freq_hz - f) < f * 0.01 &&
+             fabs(p->r.duty_pct - (double)duty_pct) <= 1.0;
+    if (p->jitter_expect_ns > 0.0)
+        ok = ok && fabs(p->r.jitter_ns - p->jitter_expect_ns) <= p->jitter_expect_ns * 0.25;
+    return ok;
+}
+
+static int _run(const TachoArgs* a, unsigned freq_hz, unsigned periods, TachoPass* p) {
+    HAL_GpioChip* chip = NULL;
+    int id = -1;
+    if (_open(&chip, &id) != 0) return -1;
+    uint32_t rng = a->seed ? a->seed : 1u;
+    uint64_t ticks = _play(chip, freq_hz, a->duty_pct, a->jitter_us, periods, &rng);
+    BoardTacho_Get(id, &p->r);
+    p->freq_hz          = freq_hz;
+    p->jitter_expect_ns = (double)a->jitter_us * 1000.0 / sqrt(3.0);
+    p->ns_per_edge      = p->r.edges ? (double)Bench_TicksToNs(ticks) / (double)p->r.edges : 0.0;
+    p->ok               = _check(p, a->duty_pct);
+    _close(chip);
+    return 0;
+}
+
+static int _run_fast(const TachoArgs* a, TachoPass* p) {
+    if (_run(a, a->freq_hz, a->periods, p) != 0) return -1;
+    /* cửa sổ giới hạn bởi ring: đủ BOARD_TACHO_RING chu kỳ, ngắn hơn window_ms */
+    double t_ns = 1e9 / (double)a->freq_hz;
+    p->ok = p->ok && p->r.samples == BOARD_TACHO_RING &&
+            fabs((double)p->r.window_ns - BOARD_TACHO_RING * t_ns) < BOARD_TACHO_RING * t_ns * 0.01;
+    return 0;
+}
+
+static int _run_slow(const TachoArgs* a, TachoPass* p) {
+    TachoArgs s = *a;
+    s.jitter_us = 0;    /* 20 mẫu: độ lệch chuẩn ước lượng quá thô để so ±25 % */
+    if (_run(&s, 20, 100, p) != 0) return -1;
+    /* cửa sổ giới hạn bởi thời gian: ~20 chu kỳ, phủ ~window_ms */
+    p->ok = p->ok && p->r.samples >= 19 && p->r.samples <= 21 &&
+            p->r.window_ns <= (WINDOW_MS + 50u) * 1000000ull;
+    return 0;
+}
+
+static int _run_stall(const TachoArgs* a, TachoPass* p) {
+    HAL_GpioChip* chip = NULL;
+    int id = -1;
+    if (_open(&chip, &id) != 0) return -1;
+    uint32_t rng = a->seed ? a->seed : 1u;
+    _play(chip, 100, a->duty_pct, 0, 200, &rng);
+    BoardTachoResult before;
+    BoardTacho_Get(id, &before);
+    HAL_GpioSim_SetInput(chip, LINE_TACHO, 0);
+    HAL_GpioSim_Advance(chip, (2u * WINDOW_MS + 10u) * 1000u);   /* stall_ms mặc định = 2 * window */
+    BoardTacho_Poll(0);
+    BoardTacho_Get(id, &p->r);
+    p->freq_hz = 0;
+    p->ok = !before.stalled && before.samples > 0 &&
+            p->r.stalled && p->r.samples == 0 && p->r.freq_hz == 0.0;
+    _close(chip);
+    return 0;
+}
+
+static void _print(const char* name, const TachoPass* p) {
+    printf("%-6s  : %9.3f Hz  duty %5.2f %%  jitter %8.0f ns (expect %6.0f)  samples %2u  window %6.1f ms  "
+           "%s%6.1f ns/edge  %s\n",
+           name, p->r.freq_hz, p->r.duty_pct, p->r.jitter_ns, p->jitter_expect_ns, p->r.samples,
+           (double)p->r.window_ns / 1e6, p->r.stalled ? "stalled  " : "", p->ns_per_edge, p->ok ? "ok" : "FAIL");
+}
+
+static void _json(const char* name, const TachoPass* p, int last) {
+    printf("\"%s\":{\"freq_hz\":%.3f,\"duty_pct\":%.2f,\"jitter_ns\":%.0f,\"jitter_expect_ns\":%.0f,"
+           "\"samples\":%u,\"window_ns\":%llu,\"stalled\":%s,\"ns_per_edge\":%.1f,\"ok\":%s}%s",
+           name, p->r.freq_hz, p->r.duty_pct, p->r.jitter_ns, p->jitter_expect_ns, p->r.samples,
+           (unsigned long long)p->r.window_ns, p->r.stalled ? "true" : "false", p->ns_per_edge,
+           p->ok ? "true" : "false", last ? "" : ",");
+}
+
+static void _usage(void) {
+    fprintf(stderr,
+            "usage: bench_tacho [-f freq_hz] [-d duty_pct] [-J jitter_us] [-n periods] [-s seed] [-j]\n"
+            "  -f  fast pass frequency, 100..10000 (default 1000)\n"
+            "  -d  duty cycle %%, 10..90 (default 30)\n"
+            "  -J  uniform period jitter +-us, < 10%% of the period (default 20)\n"
+            "  -n  fast pass periods (default 100000)\n");
+}
+
+int main(int argc, char** argv) {
+    TachoArgs a = { .freq_hz = 1000, .duty_pct = 30, .jitter_us = 20, .periods = 100000, .seed = 12345 };
+    int opt;
+    while ((opt = getopt(argc, argv, "f:d:J:n:s:jh")) != -1) {
+        switch (opt) {
+        case 'f': a.freq_hz   = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'd': a.duty_pct  = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'J': a.jitter_us = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'n': a.periods   = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 's': a.seed      = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'j': a.json      = 1; break;
+        default:  _usage(); return 2;
+        }
+    }
+    /* nhanh hơn BOARD_TACHO_RING / window để ring là giới hạn; 1 µs phân giải của sim */
+    if (a.freq_hz < 100 || a.freq_hz > 10000 || a.duty_pct < 10 || a.duty_pct > 90 ||
+        a.jitter_us * 10u * a.freq_hz >= 1000000u || a.periods < BOARD_TACHO_RING + 1u) {
+        _usage();
+        return 2;
+    }
+    Bench_ClockInit(0);
+
+    TachoPass fast = { 0 }, slow = { 0 }, stall = { 0 };
+    if (_run_fast(&a, &fast) != 0 || _run_slow(&a, &slow) != 0 || _run_stall(&a, &stall) != 0) {
+        fprintf(stderr, "[BENCH] sim chip / tacho setup failed\n");
+        return 1;
+    }
+    int ok = fast.ok && slow.ok && stall.ok;
+
+    if (a.json) {
+        printf("{\"freq_hz\":%u,\"duty_pct\":%u,\"jitter_us\":%u,\"periods\":%u,\"ok\":%s,",
+               a.freq_hz, a.duty_pct, a.jitter_us, a.periods, ok ? "true" : "false");
+        _json("fast", &fast, 0);
+        _json("slow", &slow, 0);
+        _json("stall", &stall, 1);
+        printf("}\n");
+    } else {
+        printf("=== bench-tacho: %u periods at %u Hz, duty %u %%, jitter +-%u us, window %u ms ===\n",
+               a.periods, a.freq_hz, a.duty_pct, a.jitter_us, WINDOW_MS);
+        _print("fast", &fast);
+        _print("slow", &slow);
+        _print("stall", &stall);
+        printf("result  : %s\n", ok ? "OK" : "MISMATCH");
+    }
+    return ok ? 0 : 1;
+}
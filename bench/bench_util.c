@@ -0,0 +1,80 @@
+/**
+ * @file bench_util.c
+ * @brief Clock / CPU helpers for the bench tools (see bench_util.h).
+ */
+#define _GNU_SOURCE
+#include "bench_util.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#else
+#define BENCH_HAVE_TSC 0
+#endif
+
+static int    s_use_tsc     = 0;
+static double s_ns_per_tick = 1.0;
+
+uint64_t Bench_NowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+const char* Bench_ClockInit(int use_tsc) {
+    s_use_tsc = 0;
+    s_ns_per_tick = 1.0;
+#if BENCH_HAVE_TSC
+    if (use_tsc) {
+        /* calibrate over ~50 ms */
+        uint64_t n0 = Bench_NowNs();
+        uint64_t t0 = __rdtsc();
+        struct timespec d = { 0, 50 * 1000000L };
+        nanosleep(&d, NULL);
+        uint64_t n1 = Bench_NowNs();
+        uint64_t t1 = __rdtsc();
+        if (t1 > t0 && n1 > n0) {
+            s_ns_per_tick = (double)(n1 - n0) / (double)(t1 - t0);
+            s_use_tsc = 1;
+            return "tsc";
+        }
+    }
+#else
+    (void)use_tsc;
+#endif
+    return "monotonic_raw";
+}
+
+uint64_t Bench_Ticks(void) {
+#if BENCH_HAVE_TSC
+    if (s_use_tsc) {
+        _mm_lfence();
+        return __rdtsc();
+    }
+#endif
+    return Bench_NowNs();
+}
+
+uint64_t Bench_TicksToNs(uint64_t ticks) {
+    return s_use_tsc ? (uint64_t)((double)ticks * s_ns_per_tick + 0.5) : ticks;
+}
+
+int Bench_PinCpu(int cpu) {
+    if (cpu < 0) return 0;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+int Bench_SetFifo(int prio) {
+    struct sched_param sp;
+    memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = prio;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+}
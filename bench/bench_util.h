@@ -0,0 +1,35 @@
+/**
+ * @file bench_util.h
+ * @brief Timing and CPU placement helpers shared by the bench tools.
+ *
+ * Notes:
+ *  - Default clock is CLOCK_MONOTONIC_RAW (not slewed by NTP).
+ *  - On x86-64 the TSC can be used instead (Bench_ClockInit(1)); it is
+ *    calibrated against CLOCK_MONOTONIC_RAW once, ticks are converted to ns.
+ */
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* use_tsc: 1 = prefer TSC when available. Returns the clock actually used ("tsc" / "monotonic_raw"). */
+const char* Bench_ClockInit(int use_tsc);
+
+/* Raw timestamp in clock units (TSC ticks or ns); convert deltas with Bench_TicksToNs. */
+uint64_t    Bench_Ticks(void);
+uint64_t    Bench_TicksToNs(uint64_t ticks);
+
+/* Always CLOCK_MONOTONIC_RAW in ns (cheap enough for non-hot paths). */
+uint64_t    Bench_NowNs(void);
+
+/* Pin the calling thread to one CPU (cpu < 0: no-op). Returns 0 on success. */
+int         Bench_PinCpu(int cpu);
+
+/* Best-effort SCHED_FIFO for the calling thread (prio 1..99). Returns 0 on success. */
+int         Bench_SetFifo(int prio);
+
+#ifdef __cplusplus
+}
+#endif
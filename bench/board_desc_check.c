@@ -0,0 +1,231 @@
+/**
+ * @file board_desc_check.c
+ * @brief Board description checks: parse every board file given on the
+ *        command line, then a set of built-in cases (no hardware needed).
+ *
+ * Per board file:
+ *  - loads without error, every entry has a name and a dev/kind,
+ *    every line resolves to its chip (BoardDesc_LineInfo);
+ *  - if all chips are on the sim backend ("sim:..."): bring-up opens the
+ *    chips, every line and group opens, closing a chip drops its lines.
+ *
+ * Built-in cases:
+ *  - malformed text (unknown chip / kind, duplicate name, bad option,
+ *    too many tokens, ...) fails with "line N: ..." on the right line;
+ *  - a uart declared before 40 more entries (the table is realloc'd while
+ *    parsing) still opens on its pty;
+ *  - hot-plug: injected tty remove / add uevents close and reopen that
+ *    uart through BoardDevMgr and notify the subscriber.
+ *
+ * Usage:
+ *   board_desc_check [board files...]      (make board-desc-check)
+ */
+#define _GNU_SOURCE
+#include "board_desc.h"
+#include "board_devmgr.h"
+#include "hal_gpio.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...) do {                          \
+        if (!(cond)) {                                 \
+            s_fail++;                                  \
+            printf("  FAIL: " __VA_ARGS__);            \
+            printf("\n");                              \
+        }                                              \
+    } while (0)
+
+static void _sleep_ms(unsigned ms) {
+    struct timespec ts = { .tv_sec = ms / 1000u, .tv_nsec = (long)(ms % 1000u) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+/* ---------------- board files ---------------- */
+
+static void _check_file(const char* path) {
+    char err[160];
+    printf("%s\n", path);
+    BoardDesc* bd = BoardDesc_Load(path, err, sizeof(err));
+    CHECK(bd != NULL, "load: %s", err);
+    if (!bd) return;
+
+    unsigned n = BoardDesc_Count(bd), lines = 0, groups = 0, chips = 0, sim_chips = 0;
+    CHECK(n > 0, "no entries");
+    for (unsigned i = 0; i < n; ++i) {
+        BoardResInfo ri;
+        CHECK(BoardDesc_Info(bd, i, &ri) == 0 && ri.name[0], "entry %u: no info", i);
+        if (ri.kind == BOARD_RES_CHIP) {
+            chips++;
+            if (!strncmp(ri.dev, "sim:", 4)) sim_chips++;
+        } else if (ri.kind == BOARD_RES_LINE) {
+            BoardLineInfo li;
+            lines++;
+            CHECK(BoardDesc_LineInfo(bd, ri.name, &li) == 0 && li.chip_dev && li.chip_dev[0],
+                  "line %s: no chip", ri.name);
+        } else if (ri.kind == BOARD_RES_GROUP) {
+            groups++;
+        }
+        if (ri.kind != BOARD_RES_LINE && ri.kind != BOARD_RES_GROUP && ri.kind != BOARD_RES_DEVICE)
+            CHECK(ri.dev[0], "%s: empty dev", ri.name);
+    }
+    printf("  %u entries: %u chip(s), %u line(s), %u group(s)\n", n, chips, lines, groups);
+
+    if (chips && sim_chips == chips) {
+        CHECK(BoardDesc_BringUp(bd, NULL, 0, 2) == 0, "bring-up failed");
+        for (unsigned i = 0; i < n; ++i) {
+            BoardResInfo ri;
+            BoardDesc_Info(bd, i, &ri);
+            if (ri.kind == BOARD_RES_LINE)
+                CHECK(BoardDesc_Line(bd, ri.name) != NULL, "line %s: open failed", ri.name);
+            if (ri.kind == BOARD_RES_GROUP) {
+                HAL_GpioGroup g;
+                CHECK(BoardDesc_Group(bd, ri.name, &g) == 0 && g.count > 0, "group %s: open failed", ri.name);
+            }
+        }
+        /* đóng chip -> line con bị đóng theo, lần dùng sau mở lại */
+        for (unsigned i = 0; i < n; ++i) {
+            BoardResInfo ri;
+            BoardDesc_Info(bd, i, &ri);
+            if (ri.kind == BOARD_RES_CHIP) BoardDesc_Close(bd, ri.name);
+        }
+        for (unsigned i = 0; i < n; ++i) {
+            BoardResInfo ri;
+            BoardDesc_Info(bd, i, &ri);
+            if (ri.kind == BOARD_RES_LINE) {
+                CHECK(BoardDesc_Peek(bd, ri.name) == NULL, "line %s still open after chip close", ri.name);
+                CHECK(BoardDesc_Line(bd, ri.name) != NULL, "line %s: reopen failed", ri.name);
+            }
+        }
+        printf("  sim bring-up / open / close: done\n");
+    }
+    BoardDesc_Free(bd);
+}
+
+/* ---------------- malformed text ---------------- */
+
+typedef struct {
+    const char* text;
+    int         line;      /* dòng phải được báo lỗi */
+} BadCase;
+
+static void _check_errors(void) {
+    static char many[512];
+    snprintf(many, sizeof(many), "chip g sim:x\ngroup big");
+    for (int i = 0; i < 40; ++i) strcat(many, " L");   /* > BD_TOK_MAX token */
+    strcat(many, "\n");
+
+    const BadCase cases[] = {
+        { "chip g sim:x\nline L g:0 out\nline L g:1 out\n",             3 },  /* trùng tên */
+        { "line L g:0 out\n",                                            1 },  /* chip chưa khai báo */
+        { "chip g sim:x\n\n# comment\nline L g:x out\n",                 4 },  /* offset sai */
+        { "chip g sim:x\nline L g:0 out edge=up\n",                      2 },
+        { "chip g sim:x\nline L g:0 sideways\n",                         2 },
+        { "chip g sim:x\ngroup grp L\n",                                 2 },  /* line chưa khai báo */
+        { "i2c b /dev/i2c-0 speed=fast\n",                               1 },
+        { "uart u /dev/ttyS0\ndevice d nobus addr=0x48\n",               2 },
+        { "i2c b /dev/i2c-0\ndevice d b addr=0x80\n",                    2 },
+        { "led x y\n",                                                   1 },  /* kind lạ */
+        { "chip g\n",                                                    1 },  /* thiếu target */
+        { many,                                                          2 },  /* quá nhiều token */
+    };
+    printf("malformed text\n");
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        char err[160] = "";
+        char want[16];
+        BoardDesc* bd = BoardDesc_Parse(cases[i].text, err, sizeof(err));
+        snprintf(want, sizeof(want), "line %d:", cases[i].line);
+        CHECK(bd == NULL && strncmp(err, want, strlen(want)) == 0,
+              "case %u: expected '%s...', got '%s'", i, want, bd ? "(parsed)" : err);
+        if (bd) BoardDesc_Free(bd);
+    }
+    printf("  %u case(s)\n", (unsigned)(sizeof(cases) / sizeof(cases[0])));
+}
+
+/* ---------------- table growth + hot-plug (pty) ---------------- */
+
+static volatile int s_added, s_removed;
+
+static void _on_dev(const char* name, BoardDevEvent ev, void* handle, void* user) {
+    (void)name; (void)handle; (void)user;
+    if (ev == BOARD_DEV_ADDED) __atomic_fetch_add(&s_added, 1, __ATOMIC_RELAXED);
+    else                       __atomic_fetch_add(&s_removed, 1, __ATOMIC_RELAXED);
+}
+
+static int _wait_count(volatile int* v, int want) {
+    for (int t = 0; t < 1000; ++t) {
+        if (__atomic_load_n(v, __ATOMIC_RELAXED) >= want) return 1;
+        _sleep_ms(1);
+    }
+    return 0;
+}
+
+static void _check_pty(void) {
+    printf("uart on pty (table growth, hot-plug)\n");
+    int mfd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (mfd < 0 || grantpt(mfd) != 0 || unlockpt(mfd) != 0 || !ptsname(mfd)) {
+        printf("  skipped (no pty)\n");
+        if (mfd >= 0) close(mfd);
+        return;
+    }
+    const char* pts = ptsname(mfd);
+
+    /* uart là entry đầu tiên; 40 entry sau buộc bảng realloc nhiều lần */
+    static char text[4096];
+    int off = snprintf(text, sizeof(text), "uart u0 %s baud=9600\nchip g sim:x\n", pts);
+    for (int i = 0; i < 40; ++i) off += snprintf(text + off, sizeof(text) - (size_t)off, "line L%d g:%d in\n", i, i);
+
+    char err[160];
+    BoardDesc* bd = BoardDesc_Parse(text, err, sizeof(err));
+    CHECK(bd != NULL, "parse: %s", err);
+    if (!bd) { close(mfd); return; }
+    CHECK(BoardDesc_Count(bd) == 42, "count %u", BoardDesc_Count(bd));
+    CHECK(BoardDesc_Uart(bd, "u0") != NULL, "uart on %s did not open", pts);
+
+    BoardDevMgrCfg mc = { .no_netlink = 1, .retry_ms = 5 };
+    if (BoardDevMgr_Start(bd, &mc) != 0) {
+        CHECK(0, "BoardDevMgr_Start failed");
+    } else {
+        int id = BoardDevMgr_Subscribe("u0", _on_dev, NULL);
+        CHECK(id >= 0 && _wait_count(&s_added, 1), "no ADDED at subscribe");
+
+        char ev[256];
+        const char* dn = pts + 5;   /* bỏ "/dev/" */
+        int n = snprintf(ev, sizeof(ev), "remove@/devices/virtual/tty/x%cACTION=remove%cDEVPATH=/devices/virtual/tty/x%cSUBSYSTEM=tty%cDEVNAME=%s",
+                     0, 0, 0, 0, dn);
+        BoardDevMgr_Inject(ev, (size_t)n + 1u);
+        CHECK(_wait_count(&s_removed, 1), "no REMOVED");
+        for (int t = 0; t < 1000 && BoardDesc_Peek(bd, "u0"); ++t) _sleep_ms(1);
+        CHECK(BoardDesc_Peek(bd, "u0") == NULL, "uart still open after remove");
+
+        n = snprintf(ev, sizeof(ev), "add@/devices/virtual/tty/x%cACTION=add%cDEVPATH=/devices/virtual/tty/x%cSUBSYSTEM=tty%cDEVNAME=%s",
+                     0, 0, 0, 0, dn);
+        BoardDevMgr_Inject(ev, (size_t)n + 1u);
+        CHECK(_wait_count(&s_added, 2), "no ADDED after add");
+        CHECK(BoardDesc_Peek(bd, "u0") != NULL, "uart not reopened");
+
+        BoardDevMgrStats st;
+        BoardDevMgr_GetStats(&st);
+        printf("  uevents %llu, matched %llu, opened %llu, removed %llu\n",
+               (unsigned long long)st.uevents, (unsigned long long)st.matched,
+               (unsigned long long)st.opened, (unsigned long long)st.removed);
+        BoardDevMgr_Unsubscribe(id);
+        BoardDevMgr_Stop();
+    }
+    BoardDesc_Free(bd);
+    close(mfd);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) _check_file(argv[i]);
+    _check_errors();
+    _check_pty();
+    printf("result  : %s (%d failure(s))\n", s_fail ? "FAIL" : "OK", s_fail);
+    return s_fail ? 1 : 0;
+}
@@ -0,0 +1,197 @@
+/**
+ * @file gpiosim.c
+ * @brief gpio-sim (configfs) / gpio-mockup (debugfs) chip helper, see gpiosim.h.
+ */
+#define _GNU_SOURCE
+#include "gpiosim.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define _CONFIGFS     "/sys/kernel/config"
+#define _SIM_ROOT     _CONFIGFS "/gpio-sim"
+#define _MOCKUP_ROOT  "/sys/kernel/debug/gpio-mockup"
+
+static void _why(char* why, size_t len, const char* fmt, ...) {
+    if (!why || !len) return;
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(why, len, fmt, ap);
+    va_end(ap);
+}
+
+static int _write_file(const char* path, const char* val) {
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    ssize_t n = write(fd, val, strlen(val));
+    close(fd);
+    return (n == (ssize_t)strlen(val)) ? 0 : -1;
+}
+
+static int _read_line(const char* path, char* buf, size_t len) {
+    FILE* f = fopen(path, "re");
+    if (!f) return -1;
+    char* r = fgets(buf, (int)len, f);
+    fclose(f);
+    if (!r) return -1;
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+static int _is_dir(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+/* ---------- gpio-sim ---------- */
+
+static int _sim_create(GpioSim* s, int num_lines, char* why, size_t why_len) {
+    if (!_is_dir(_SIM_ROOT)) {
+        /* best effort: module not loaded and/or configfs not mounted (EBUSY if it is) */
+        if (system("modprobe -q gpio-sim 2>/dev/null") != 0) { /* checked below */ }
+        if (!_is_dir(_SIM_ROOT) && _is_dir(_CONFIGFS))
+            (void)mount("configfs", _CONFIGFS, "configfs", 0, NULL);
+    }
+    if (!_is_dir(_SIM_ROOT)) {
+        _why(why, why_len, "gpio-sim configfs not available (%s)", _SIM_ROOT);
+        return -1;
+    }
+
+    char path[256], val[64];
+    snprintf(s->cfg_dir, sizeof(s->cfg_dir), _SIM_ROOT "/bench-%d", (int)getpid());
+    if (mkdir(s->cfg_dir, 0755) != 0) {
+        _why(why, why_len, "mkdir %s: %s", s->cfg_dir, strerror(errno));
+        s->cfg_dir[0] = '\0';
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/bank0", s->cfg_dir);
+    int ok = (mkdir(path, 0755) == 0);
+    snprintf(val, sizeof(val), "%d", num_lines);
+    snprintf(path, sizeof(path), "%s/bank0/num_lines", s->cfg_dir);
+    ok = ok && _write_file(path, val) == 0;
+    snprintf(path, sizeof(path), "%s/bank0/label", s->cfg_dir);
+    ok = ok && _write_file(path, "bench-gpiosim") == 0;
+    snprintf(path, sizeof(path), "%s/live", s->cfg_dir);
+    ok = ok && _write_file(path, "1") == 0;
+
+    char dev[64] = "";
+    if (ok) {
+        snprintf(path, sizeof(path), "%s/dev_name", s->cfg_dir);
+        ok = _read_line(path, dev, sizeof(dev)) == 0;
+        snprintf(path, sizeof(path), "%s/bank0/chip_name", s->cfg_dir);
+        ok = ok && _read_line(path, s->chip, sizeof(s->chip)) == 0;
+    }
+    if (!ok) {
+        _why(why, why_len, "gpio-sim setup under %s failed: %s", s->cfg_dir, strerror(errno));
+        GpioSim_Destroy(s);
+        return -1;
+    }
+    s->kind      = GPIOSIM_KIND_SIM;
+    s->num_lines = num_lines;
+    snprintf(s->ctl_dir, sizeof(s->ctl_dir), "/sys/devices/platform/%s/%s", dev, s->chip);
+    return 0;
+}
+
+/* ---------- gpio-mockup (attach only) ---------- */
+
+static int _mockup_attach(GpioSim* s, int num_lines, char* why, size_t why_len) {
+    DIR* d = opendir(_MOCKUP_ROOT);
+    if (!d) {
+        _why(why, why_len, "neither gpio-sim nor a loaded gpio-mockup (%s) is available", _MOCKUP_ROOT);
+        return -1;
+    }
+    struct dirent* de;
+    int found = 0;
+    while (!found && (de = readdir(d)) != NULL) {
+        if (strncmp(de->d_name, "gpiochip", 8) != 0) continue;
+        char dir[192];
+        snprintf(dir, sizeof(dir), _MOCKUP_ROOT "/%.31s", de->d_name);
+        DIR* ld = opendir(dir);
+        if (!ld) continue;
+        int n = 0;
+        struct dirent* le;
+        while ((le = readdir(ld)) != NULL) if (le->d_name[0] >= '0' && le->d_name[0] <= '9') ++n;
+        closedir(ld);
+        if (n >= num_lines) {
+            snprintf(s->chip, sizeof(s->chip), "%.31s", de->d_name);
+            snprintf(s->ctl_dir, sizeof(s->ctl_dir), "%s", dir);
+            s->num_lines = n;
+            found = 1;
+        }
+    }
+    closedir(d);
+    if (!found) {
+        _why(why, why_len, "no gpio-mockup chip with >= %d lines (gpio_mockup_ranges=-1,%d)", num_lines, num_lines);
+        return -1;
+    }
+    s->kind = GPIOSIM_KIND_MOCKUP;
+    return 0;
+}
+
+int GpioSim_Create(GpioSim* s, int num_lines, char* why, size_t why_len) {
+    memset(s, 0, sizeof(*s));
+    for (int i = 0; i < GPIOSIM_MAX_LINES; ++i) s->pull_fd[i] = -1;
+    if (num_lines < 1 || num_lines > GPIOSIM_MAX_LINES) {
+        _why(why, why_len, "num_lines must be 1..%d", GPIOSIM_MAX_LINES);
+        return -1;
+    }
+    if (geteuid() != 0) {
+        _why(why, why_len, "needs root for configfs/debugfs");
+        return -1;
+    }
+    char sim_why[160] = "";
+    if (_sim_create(s, num_lines, sim_why, sizeof(sim_why)) == 0) return 0;
+    if (_mockup_attach(s, num_lines, why, why_len) == 0) return 0;
+    if (sim_why[0]) _why(why, why_len, "%s; no gpio-mockup fallback", sim_why);
+    return -1;
+}
+
+void GpioSim_Destroy(GpioSim* s) {
+    for (int i = 0; i < GPIOSIM_MAX_LINES; ++i) {
+        if (s->pull_fd[i] >= 0) close(s->pull_fd[i]);
+        s->pull_fd[i] = -1;
+    }
+    if (s->kind != GPIOSIM_KIND_SIM || !s->cfg_dir[0]) return;
+    char path[256];
+    snprintf(path, sizeof(path), "%s/live", s->cfg_dir);
+    (void)_write_file(path, "0");
+    snprintf(path, sizeof(path), "%s/bank0", s->cfg_dir);
+    (void)rmdir(path);
+    (void)rmdir(s->cfg_dir);
+    s->cfg_dir[0] = '\0';
+}
+
+int GpioSim_SetPull(GpioSim* s, int off, int up) {
+    if (off < 0 || off >= s->num_lines || off >= GPIOSIM_MAX_LINES) return -1;
+    if (s->pull_fd[off] < 0) {
+        char path[256];
+        if (s->kind == GPIOSIM_KIND_SIM)
+            snprintf(path, sizeof(path), "%s/sim_gpio%d/pull", s->ctl_dir, off);
+        else
+            snprintf(path, sizeof(path), "%s/%d", s->ctl_dir, off);
+        s->pull_fd[off] = open(path, O_WRONLY | O_CLOEXEC);
+        if (s->pull_fd[off] < 0) return -1;
+    }
+    const char* v = (s->kind == GPIOSIM_KIND_SIM) ? (up ? "pull-up" : "pull-down") : (up ? "1" : "0");
+    /* attribute store ignores the offset, pwrite keeps the fd reusable */
+    return (pwrite(s->pull_fd[off], v, strlen(v), 0) == (ssize_t)strlen(v)) ? 0 : -1;
+}
+
+int GpioSim_GetValue(const GpioSim* s, int off) {
+    if (off < 0 || off >= s->num_lines) return -1;
+    char path[256], buf[16];
+    if (s->kind == GPIOSIM_KIND_SIM)
+        snprintf(path, sizeof(path), "%s/sim_gpio%d/value", s->ctl_dir, off);
+    else
+        snprintf(path, sizeof(path), "%s/%d", s->ctl_dir, off);
+    if (_read_line(path, buf, sizeof(buf)) != 0) return -1;
+    return (buf[0] == '1') ? 1 : (buf[0] == '0') ? 0 : -1;
+}
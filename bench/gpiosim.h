@@ -0,0 +1,50 @@
+/**
+ * @file gpiosim.h
+ * @brief Virtual GPIO chips from the kernel (gpio-sim / gpio-mockup) for the
+ *        bench tools, so the character-device backends (gpiod:, uapi:) can be
+ *        exercised without a board.
+ *
+ * Notes:
+ *  - gpio-sim (configfs, kernel >= 5.17) is preferred: the chip is created on
+ *    GpioSim_Create and removed on GpioSim_Destroy. Pull values are driven
+ *    through /sys/devices/platform/<dev>/<chip>/sim_gpio<N>/pull.
+ *  - Fallback: an already loaded gpio-mockup chip (debugfs
+ *    /sys/kernel/debug/gpio-mockup/<chip>/<N>). It is only attached, never
+ *    created or removed.
+ *  - Needs root (configfs / debugfs writes). When neither is usable,
+ *    GpioSim_Create fails with a reason and callers exit GPIOSIM_EXIT_SKIP.
+ */
+#pragma once
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GPIOSIM_MAX_LINES 32
+#define GPIOSIM_EXIT_SKIP 77     ///< automake/ctest convention for "skipped"
+
+typedef enum { GPIOSIM_KIND_SIM = 0, GPIOSIM_KIND_MOCKUP } GpioSimKind;
+
+typedef struct {
+    GpioSimKind kind;
+    char        chip[32];        ///< e.g. "gpiochip5" (HAL chip_name)
+    int         num_lines;
+    char        cfg_dir[128];    ///< configfs device dir (gpio-sim only)
+    char        ctl_dir[192];    ///< dir holding per-line pull/value controls
+    int         pull_fd[GPIOSIM_MAX_LINES];  ///< opened lazily, kept for cheap writes
+} GpioSim;
+
+/* Create (gpio-sim) or attach (gpio-mockup) a chip with at least num_lines lines.
+ * Returns 0 on success; -1 with a human readable reason in why[] otherwise. */
+int  GpioSim_Create(GpioSim* s, int num_lines, char* why, size_t why_len);
+void GpioSim_Destroy(GpioSim* s);
+
+/* Drive the simulated pin of an input line: up=1 pull-up, 0 pull-down. Returns 0 on success. */
+int  GpioSim_SetPull(GpioSim* s, int off, int up);
+/* Physical level seen by the simulator (output value or pulled input). 0/1, -1 on error. */
+int  GpioSim_GetValue(const GpioSim* s, int off);
+
+#ifdef __cplusplus
+}
+#endif
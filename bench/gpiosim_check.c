@@ -0,0 +1,252 @@
+/**
+ * @file gpiosim_check.c
+ * @brief Functional checks of the linked HAL GPIO backend (gpiod: / uapi:)
+ *        against a kernel gpio-sim chip, through the real character device.
+ *
+ * The chip is created with GpioSim_Create (gpiosim.h); the test side drives
+ * input pins through the simulator's pull attribute and reads output pins
+ * back from its value attribute, so every case below needs no wiring:
+ *
+ *  - out.write / out.active_low : Write/Toggle -> sim value
+ *  - in.read / in.active_low    : sim pull -> Read
+ *  - ev.both / ev.rising        : sim pull -> WaitEvent edges, timestamps
+ *  - ev.fd                      : GetEventFd becomes readable on an edge
+ *  - ev.debounce                : a burst inside debounce_ms yields one event
+ *  - grp.write / grp.read       : HAL_GpioGroup_* vs sim values / pulls
+ *
+ * Exit: 0 all pass, 1 a check failed, 77 (GPIOSIM_EXIT_SKIP) when no virtual
+ * chip can be created (module absent, not root, ...).
+ *
+ * Usage:
+ *   gpiosim_check [-d debounce_ms]
+ */
+#define _GNU_SOURCE
+#include "gpiosim.h"
+#include "bench_util.h"
+
+#include "hal_gpio.h"
+
+#include <getopt.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef BENCH_GPIO_BACKEND
+#define BENCH_GPIO_BACKEND "linux"
+#endif
+
+#define SIM_LINES  8
+#define L_OUT      0
+#define L_IN       1
+#define L_EV       2
+#define L_DB       3
+#define L_GRP      4     /* 4..7 */
+#define GRP_N      4
+
+static GpioSim       s_sim;
+static HAL_GpioChip* s_chip;
+static int           s_fail, s_pass;
+
+#define CHECK(name, cond, ...)                                          \
+    do {                                                                \
+        if (cond) { ++s_pass; printf("[PASS] %s\n", name); }            \
+        else { ++s_fail; printf("[FAIL] %s: ", name);                   \
+               printf(__VA_ARGS__); printf("\n"); }                     \
+    } while (0)
+
+static HAL_GpioLine* _request(int off, HAL_GpioDir dir, HAL_GpioActive act, HAL_GpioEdge edge, uint32_t db_ms) {
+    HAL_GpioLineConfig lc = {
+        .offset = off, .name = NULL, .dir = dir,
+        .active = act, .drive = HAL_GPIO_DRIVE_PUSHPULL,
+        .bias = HAL_GPIO_BIAS_AS_IS, .initial = 0, .edge = edge, .debounce_ms = db_ms
+    };
+    HAL_GpioLine* ln = NULL;
+    if (HAL_GpioLine_Request(s_chip, &lc, &ln) != HAL_GPIO_OK) return NULL;
+    return ln;
+}
+
+/* gom các event tới hạn timeout_ms (event bị debounce bỏ cũng trả ENOENT, nên chờ theo đồng hồ) */
+static int _collect(HAL_GpioLine* ln, int timeout_ms, HAL_GpioEvent* evs, int max) {
+    uint64_t end = Bench_NowNs() + (uint64_t)timeout_ms * 1000000ull;
+    int n = 0;
+    for (;;) {
+        uint64_t now = Bench_NowNs();
+        if (now >= end) break;
+        HAL_GpioEvent ev;
+        HAL_GpioStatus st = HAL_GpioLine_WaitEvent(ln, (int)((end - now) / 1000000ull) + 1, &ev);
+        if (st == HAL_GPIO_OK && n < max) evs[n++] = ev;
+        else if (st != HAL_GPIO_OK && st != HAL_GPIO_ENOENT) break;
+    }
+    return n;
+}
+
+static void _check_out(void) {
+    HAL_GpioLine* ln = _request(L_OUT, HAL_GPIO_DIR_OUT, HAL_GPIO_ACTIVE_HIGH, HAL_GPIO_EDGE_NONE, 0);
+    if (!ln) { CHECK("out.write", 0, "request line %d failed", L_OUT); return; }
+    int v0 = GpioSim_GetValue(&s_sim, L_OUT);
+    HAL_GpioLine_Write(ln, 1);
+    int v1 = GpioSim_GetValue(&s_sim, L_OUT);
+    HAL_GpioLine_Toggle(ln);
+    int v2 = GpioSim_GetValue(&s_sim, L_OUT);
+    CHECK("out.write", v0 == 0 && v1 == 1 && v2 == 0, "sim value initial/write1/toggle = %d/%d/%d, want 0/1/0", v0, v1, v2);
+    HAL_GpioLine_Release(ln);
+
+    ln = _request(L_OUT, HAL_GPIO_DIR_OUT, HAL_GPIO_ACTIVE_LOW, HAL_GPIO_EDGE_NONE, 0);
+    if (!ln) { CHECK("out.active_low", 0, "request failed"); return; }
+    HAL_GpioLine_Write(ln, 1);
+    v1 = GpioSim_GetValue(&s_sim, L_OUT);
+    HAL_GpioLine_Write(ln, 0);
+    v0 = GpioSim_GetValue(&s_sim, L_OUT);
+    CHECK("out.active_low", v1 == 0 && v0 == 1, "logical 1/0 -> physical %d/%d, want 0/1", v1, v0);
+    HAL_GpioLine_Release(ln);
+}
+
+static void _check_in(void) {
+    HAL_GpioLine* ln = _request(L_IN, HAL_GPIO_DIR_IN, HAL_GPIO_ACTIVE_HIGH, HAL_GPIO_EDGE_NONE, 0);
+    if (!ln) { CHECK("in.read", 0, "request line %d failed", L_IN); return; }
+    int up = -1, down = -1;
+    GpioSim_SetPull(&s_sim, L_IN, 1);
+    HAL_GpioLine_Read(ln, &up);
+    GpioSim_SetPull(&s_sim, L_IN, 0);
+    HAL_GpioLine_Read(ln, &down);
+    CHECK("in.read", up == 1 && down == 0, "pull-up/pull-down read %d/%d, want 1/0", up, down);
+    HAL_GpioLine_Release(ln);
+
+    ln = _request(L_IN, HAL_GPIO_DIR_IN, HAL_GPIO_ACTIVE_LOW, HAL_GPIO_EDGE_NONE, 0);
+    if (!ln) { CHECK("in.active_low", 0, "request failed"); return; }
+    GpioSim_SetPull(&s_sim, L_IN, 1);
+    HAL_GpioLine_Read(ln, &up);
+    GpioSim_SetPull(&s_sim, L_IN, 0);
+    HAL_GpioLine_Read(ln, &down);
+    CHECK("in.active_low", up == 0 && down == 1, "pull-up/pull-down read %d/%d, want 0/1", up, down);
+    HAL_GpioLine_Release(ln);
+}
+
+static void _check_events(void) {
+    HAL_GpioEvent evs[8];
+    GpioSim_SetPull(&s_sim, L_EV, 0);
+    HAL_GpioLine* ln = _request(L_EV, HAL_GPIO_DIR_IN, HAL_GPIO_ACTIVE_HIGH, HAL_GPIO_EDGE_BOTH, 0);
+    if (!ln) { CHECK("ev.both", 0, "request line %d failed", L_EV); return; }
+    GpioSim_SetPull(&s_sim, L_EV, 1);
+    GpioSim_SetPull(&s_sim, L_EV, 0);
+    int n = _collect(ln, 100, evs, 8);
+    CHECK("ev.both", n == 2 && evs[0].edge == HAL_GPIO_EDGE_RISING && evs[1].edge == HAL_GPIO_EDGE_FALLING &&
+                     evs[0].timestamp_ns != 0 && evs[1].timestamp_ns >= evs[0].timestamp_ns,
+          "got %d events (want rising, falling with ordered timestamps)", n);
+
+    int fd = HAL_GpioLine_GetEventFd(ln);
+    if (fd >= 0) {
+        GpioSim_SetPull(&s_sim, L_EV, 1);
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int rv = poll(&pfd, 1, 1000);
+        HAL_GpioEvent ev;
+        HAL_GpioStatus st = (rv > 0) ? HAL_GpioLine_WaitEvent(ln, 0, &ev) : HAL_GPIO_ENOENT;
+        CHECK("ev.fd", rv > 0 && st == HAL_GPIO_OK && ev.edge == HAL_GPIO_EDGE_RISING,
+              "poll rv=%d, WaitEvent(0)=%d", rv, (int)st);
+        GpioSim_SetPull(&s_sim, L_EV, 0);
+        (void)_collect(ln, 20, evs, 8);
+    } else {
+        printf("[SKIP] ev.fd: backend has no event fd\n");
+    }
+    HAL_GpioLine_Release(ln);
+
+    ln = _request(L_EV, HAL_GPIO_DIR_IN, HAL_GPIO_ACTIVE_HIGH, HAL_GPIO_EDGE_RISING, 0);
+    if (!ln) { CHECK("ev.rising", 0, "request failed"); return; }
+    GpioSim_SetPull(&s_sim, L_EV, 1);
+    GpioSim_SetPull(&s_sim, L_EV, 0);
+    GpioSim_SetPull(&s_sim, L_EV, 1);
+    GpioSim_SetPull(&s_sim, L_EV, 0);
+    n = _collect(ln, 100, evs, 8);
+    CHECK("ev.rising", n == 2 && evs[0].edge == HAL_GPIO_EDGE_RISING && evs[1].edge == HAL_GPIO_EDGE_RISING,
+          "got %d events, want 2 rising", n);
+    HAL_GpioLine_Release(ln);
+}
+
+static void _check_debounce(int db_ms) {
+    HAL_GpioEvent evs[16];
+    GpioSim_SetPull(&s_sim, L_DB, 0);
+    HAL_GpioLine* ln = _request(L_DB, HAL_GPIO_DIR_IN, HAL_GPIO_ACTIVE_HIGH, HAL_GPIO_EDGE_BOTH, (uint32_t)db_ms);
+    if (!ln) { CHECK("ev.debounce", 0, "request line %d failed", L_DB); return; }
+    /* bounce: 5 cạnh liên tiếp, cách nhau vài µs (một lần ghi sysfs) */
+    for (int i = 0; i < 5; ++i) GpioSim_SetPull(&s_sim, L_DB, !(i & 1));
+    int n1 = _collect(ln, db_ms * 2, evs, 16);
+    int ok1 = (n1 == 1 && evs[0].edge == HAL_GPIO_EDGE_RISING);
+    /* sau cửa sổ lockout: cạnh tiếp theo phải qua */
+    GpioSim_SetPull(&s_sim, L_DB, 0);
+    int n2 = _collect(ln, db_ms / 2 + 10, evs, 16);
+    int ok2 = (n2 == 1 && evs[0].edge == HAL_GPIO_EDGE_FALLING);
+    CHECK("ev.debounce", ok1 && ok2, "burst -> %d events (want 1 rising), later edge -> %d (want 1 falling)", n1, n2);
+    HAL_GpioLine_Release(ln);
+}
+
+static void _check_group(void) {
+    HAL_GpioLine* lines[GRP_N] = { 0 };
+    HAL_GpioGroup grp = { lines, GRP_N };
+    int ok = 1;
+    for (int i = 0; i < GRP_N; ++i)
+        ok = ok && (lines[i] = _request(L_GRP + i, HAL_GPIO_DIR_OUT, HAL_GPIO_ACTIVE_HIGH, HAL_GPIO_EDGE_NONE, 0));
+    if (ok) {
+        uint32_t sim = 0, bm = 0;
+        HAL_GpioGroup_WriteMask(&grp, 0xF, 0xA);
+        HAL_GpioGroup_WriteMask(&grp, 0x1, 0x1);           /* chỉ bit 0 đổi */
+        for (int i = 0; i < GRP_N; ++i) if (GpioSim_GetValue(&s_sim, L_GRP + i) == 1) sim |= 1u << i;
+        HAL_GpioGroup_ReadBitmap(&grp, &bm);
+        CHECK("grp.write", sim == 0xB && bm == 0xB, "sim 0x%X, read back 0x%X, want 0xB", sim, bm);
+    } else {
+        CHECK("grp.write", 0, "request failed");
+    }
+    for (int i = 0; i < GRP_N; ++i) if (lines[i]) HAL_GpioLine_Release(lines[i]);
+
+    ok = 1;
+    for (int i = 0; i < GRP_N; ++i) {
+        GpioSim_SetPull(&s_sim, L_GRP + i, (0x6 >> i) & 1);
+        lines[i] = _request(L_GRP + i, HAL_GPIO_DIR_IN, HAL_GPIO_ACTIVE_HIGH, HAL_GPIO_EDGE_NONE, 0);
+        ok = ok && lines[i];
+    }
+    uint32_t bm = 0;
+    if (ok) HAL_GpioGroup_ReadBitmap(&grp, &bm);
+    CHECK("grp.read", ok && bm == 0x6, "pulls 0x6, read 0x%X", bm);
+    for (int i = 0; i < GRP_N; ++i) if (lines[i]) HAL_GpioLine_Release(lines[i]);
+}
+
+int main(int argc, char** argv) {
+    int db_ms = 100;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:h")) != -1) {
+        switch (opt) {
+            case 'd': db_ms = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-d debounce_ms]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (db_ms < 10) db_ms = 10;
+    Bench_ClockInit(0);
+
+    char why[256];
+    if (GpioSim_Create(&s_sim, SIM_LINES, why, sizeof(why)) != 0) {
+        printf("SKIP: %s\n", why);
+        return GPIOSIM_EXIT_SKIP;
+    }
+    printf("=== gpiosim-check: gpio backend=%s chip=%s (%s, %d lines) ===\n", BENCH_GPIO_BACKEND,
+           s_sim.chip, s_sim.kind == GPIOSIM_KIND_SIM ? "gpio-sim" : "gpio-mockup", s_sim.num_lines);
+
+    HAL_GpioChipConfig cc = { .chip_name = s_sim.chip };
+    if (HAL_GpioChip_Open(&cc, &s_chip) != HAL_GPIO_OK) {
+        printf("[FAIL] chip.open: %s\n", s_sim.chip);
+        GpioSim_Destroy(&s_sim);
+        return 1;
+    }
+    _check_out();
+    _check_in();
+    _check_events();
+    _check_debounce(db_ms);
+    _check_group();
+
+    HAL_GpioChip_Close(s_chip);
+    GpioSim_Destroy(&s_sim);
+    printf("%d passed, %d failed\n", s_pass, s_fail);
+    return s_fail ? 1 : 0;
+}
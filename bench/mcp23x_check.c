@@ -0,0 +1,448 @@
+/**
+ * @file mcp23x_check.c
+ * @brief "mcp23x:" GPIO backend checks against a simulated MCP23017 /
+ *        MCP23008 register map (no I2C bus, no hardware).
+ *
+ * HAL_I2cBus_Open / Close / WriteReg8 / ReadReg8 are replaced here (this
+ * target does not link hal_i2c_linux.c): every transfer hits an in-memory
+ * register file with BANK=0 layout, interrupt-on-change (INTF / INTCAP,
+ * cleared by reading INTCAP or GPIO) and an open-drain INT pin. The INT pin
+ * is exposed to the backend through a small "fint:" GPIO backend whose line
+ * reads / waits on that pin.
+ *
+ * Checks:
+ *  - open     : IOCON = ODR | MIRROR, interrupts and IPOL cleared, bad names
+ *               and addresses rejected;
+ *  - outputs  : group write of 8 lines = one OLAT write, unchanged = no bus
+ *               traffic, output Read from cache, Write on an input line
+ *               -> EINVAL, open-drain emulated with IODIR;
+ *  - inputs   : with INT idle, group reads never touch the bus; a change is
+ *               one INTF + INTCAP + GPIO burst; edges arrive as events, a
+ *               short pulse read late still gives both edges (INTCAP);
+ *  - no INT   : MCP23008 without INT rejects edges, reads the bus per Read;
+ *  - errors   : PULL_DOWN / OPENSOURCE -> ENOSUP, a NACK -> EIO.
+ *
+ * Usage:
+ *   mcp23x_check      (make mcp23x-check)
+ */
+#define _GNU_SOURCE
+#include "hal_gpio.h"
+#include "hal_gpio_backend.h"
+#include "hal_gpio_mcp23x.h"
+#include "hal_i2c.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...) do {                          \
+        if (!(cond)) {                                 \
+            s_fail++;                                  \
+            printf("  FAIL: " __VA_ARGS__);            \
+            printf("\n");                              \
+        }                                              \
+    } while (0)
+
+/* ---------------- MCP23x giả ---------------- */
+
+/* chỉ số thanh ghi theo MCP23008; MCP23017 BANK=0: A ở 2r, B ở 2r + 1 */
+enum { R_IODIR = 0, R_IPOL, R_GPINTEN, R_DEFVAL, R_INTCON, R_IOCON, R_GPPU, R_INTF, R_INTCAP, R_GPIO, R_OLAT, R_N };
+
+typedef struct {
+    pthread_mutex_t mu;
+    pthread_cond_t  cv;
+    int             npins;
+    uint8_t         reg[2 * R_N];
+    uint16_t        ext;          /* mức bên ngoài của pin input */
+    int             int_low;      /* mức vật lý chân INT (open-drain, active-low) */
+    unsigned        int_edges;    /* cạnh INT chưa đọc (cho "fint:") */
+    int             nack;         /* > 0: n transfer tiếp theo lỗi */
+    unsigned        writes, reads;
+} FakeMcp;
+
+static FakeMcp s_mcp = { .mu = PTHREAD_MUTEX_INITIALIZER, .cv = PTHREAD_COND_INITIALIZER };
+
+static uint16_t _get(int r) {
+    return (s_mcp.npins == 16) ? (uint16_t)(s_mcp.reg[2 * r] | s_mcp.reg[2 * r + 1] << 8) : s_mcp.reg[r];
+}
+
+static void _set(int r, uint16_t v) {
+    if (s_mcp.npins == 16) { s_mcp.reg[2 * r] = (uint8_t)v; s_mcp.reg[2 * r + 1] = (uint8_t)(v >> 8); }
+    else                   s_mcp.reg[r] = (uint8_t)v;
+}
+
+/* pin input theo mức ngoài, pin output theo OLAT */
+static uint16_t _pins(void) {
+    uint16_t d = _get(R_IODIR);
+    return (uint16_t)((s_mcp.ext & d) | (_get(R_OLAT) & ~d));
+}
+
+static void _update_int(void) {
+    int low = _get(R_INTF) ? 1 : 0;
+    if (low != s_mcp.int_low) {
+        s_mcp.int_low = low;
+        s_mcp.int_edges++;
+        pthread_cond_broadcast(&s_mcp.cv);
+    }
+}
+
+/* pin ngoài đổi: interrupt-on-change chụp INTCAP nếu chưa có INT chờ */
+static void _drive(uint16_t ext) {
+    pthread_mutex_lock(&s_mcp.mu);
+    uint16_t old = _pins();
+    s_mcp.ext = ext;
+    uint16_t ch = (uint16_t)((old ^ _pins()) & _get(R_GPINTEN) & _get(R_IODIR));
+    if (ch && !_get(R_INTF)) {
+        _set(R_INTF, ch);
+        _set(R_INTCAP, _pins());
+    }
+    _update_int();
+    pthread_mutex_unlock(&s_mcp.mu);
+}
+
+static void _reset(int npins, uint16_t ext) {
+    pthread_mutex_lock(&s_mcp.mu);
+    memset(s_mcp.reg, 0, sizeof(s_mcp.reg));
+    s_mcp.npins = npins;
+    _set(R_IODIR, npins == 16 ? 0xFFFF : 0xFF);      /* mặc định sau POR: mọi pin input */
+    _set(R_GPINTEN, 0x0F);                           /* rác từ lần chạy trước */
+    s_mcp.ext = ext;
+    s_mcp.int_low = 0;
+    s_mcp.int_edges = 0;
+    s_mcp.nack = 0;
+    s_mcp.writes = s_mcp.reads = 0;
+    pthread_mutex_unlock(&s_mcp.mu);
+}
+
+static unsigned _writes(void) { return __atomic_load_n(&s_mcp.writes, __ATOMIC_RELAXED); }
+static unsigned _reads(void)  { return __atomic_load_n(&s_mcp.reads, __ATOMIC_RELAXED); }
+
+static uint16_t _reg(int r) {
+    pthread_mutex_lock(&s_mcp.mu);
+    uint16_t v = _get(r);
+    pthread_mutex_unlock(&s_mcp.mu);
+    return v;
+}
+
+/* ---------------- HAL I2C thay cho hal_i2c_linux.c ---------------- */
+
+struct HAL_I2cBus { int unused; };
+
+HAL_I2cBus* HAL_I2cBus_Open(const HAL_I2cBusConfig* cfg, HAL_I2cStatus* out_status) {
+    (void)cfg;
+    HAL_I2cBus* b = (HAL_I2cBus*)calloc(1, sizeof(*b));
+    if (out_status) *out_status = b ? HAL_I2C_OK : HAL_I2C_EBUS;
+    return b;
+}
+
+void HAL_I2cBus_Close(HAL_I2cBus* bus) {
+    free(bus);
+}
+
+static int _nack(void) {
+    if (s_mcp.nack <= 0) return 0;
+    s_mcp.nack--;
+    return 1;
+}
+
+/* địa chỉ tự tăng trong cả map (SEQOP = 0); IOCON B là bản sao của IOCON A */
+HAL_I2cStatus HAL_I2c_WriteReg8(HAL_I2cBus* bus, uint8_t addr7, uint8_t reg, const uint8_t* data, size_t len) {
+    (void)bus; (void)addr7;
+    pthread_mutex_lock(&s_mcp.mu);
+    if (_nack()) { pthread_mutex_unlock(&s_mcp.mu); return HAL_I2C_ENODEV; }
+    s_mcp.writes++;
+    int size = (s_mcp.npins == 16) ? 2 * R_N : R_N;
+    for (size_t i = 0; i < len; ++i) {
+        int r = (reg + (int)i) % size;
+        if (s_mcp.npins == 16 && r == 2 * R_IOCON + 1) r = 2 * R_IOCON;
+        s_mcp.reg[r] = data[i];
+    }
+    _set(R_GPIO, _pins());
+    pthread_mutex_unlock(&s_mcp.mu);
+    return HAL_I2C_OK;
+}
+
+HAL_I2cStatus HAL_I2c_ReadReg8(HAL_I2cBus* bus, uint8_t addr7, uint8_t reg, uint8_t* data, size_t len) {
+    (void)bus; (void)addr7;
+    pthread_mutex_lock(&s_mcp.mu);
+    if (_nack()) { pthread_mutex_unlock(&s_mcp.mu); return HAL_I2C_ENODEV; }
+    s_mcp.reads++;
+    _set(R_GPIO, _pins());
+    int size = (s_mcp.npins == 16) ? 2 * R_N : R_N;
+    int clear = 0;
+    for (size_t i = 0; i < len; ++i) {
+        int r = (reg + (int)i) % size;
+        data[i] = s_mcp.reg[r];
+        int base = (s_mcp.npins == 16) ? r / 2 : r;
+        if (base == R_INTCAP || base == R_GPIO) clear = 1;
+    }
+    if (clear) _set(R_INTF, 0);
+    _update_int();
+    pthread_mutex_unlock(&s_mcp.mu);
+    return HAL_I2C_OK;
+}
+
+/* ---------------- line INT trên host ("fint:") ---------------- */
+
+static int s_int_line;
+
+static HAL_GpioStatus _fint_open(const char* name, void** out) {
+    (void)name;
+    *out = &s_mcp;
+    return HAL_GPIO_OK;
+}
+
+static HAL_GpioStatus _fint_request(void* chip, const HAL_GpioLineConfig* cfg, void** out) {
+    (void)chip;
+    if (cfg->dir != HAL_GPIO_DIR_IN || cfg->active != HAL_GPIO_ACTIVE_LOW) return HAL_GPIO_EINVAL;
+    *out = &s_int_line;
+    return HAL_GPIO_OK;
+}
+
+static HAL_GpioStatus _fint_write(void* line, int v) {
+    (void)line; (void)v;
+    return HAL_GPIO_EINVAL;
+}
+
+/* active-low: logic 1 = INT đang kéo thấp */
+static HAL_GpioStatus _fint_read(void* line, int* out) {
+    (void)line;
+    pthread_mutex_lock(&s_mcp.mu);
+    *out = s_mcp.int_low;
+    pthread_mutex_unlock(&s_mcp.mu);
+    return HAL_GPIO_OK;
+}
+
+static HAL_GpioStatus _fint_wait(void* line, int timeout_ms, HAL_GpioEvent* ev) {
+    (void)line;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec  += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) { ts.tv_sec++; ts.tv_nsec -= 1000000000L; }
+    pthread_mutex_lock(&s_mcp.mu);
+    while (!s_mcp.int_edges && timeout_ms != 0) {
+        if (timeout_ms < 0) pthread_cond_wait(&s_mcp.cv, &s_mcp.mu);
+        else if (pthread_cond_timedwait(&s_mcp.cv, &s_mcp.mu, &ts) != 0) break;
+    }
+    HAL_GpioStatus st = HAL_GPIO_ENOENT;
+    if (s_mcp.int_edges) {
+        s_mcp.int_edges--;
+        ev->timestamp_ns = 0;
+        ev->edge = s_mcp.int_low ? HAL_GPIO_EDGE_RISING : HAL_GPIO_EDGE_FALLING;
+        st = HAL_GPIO_OK;
+    }
+    pthread_mutex_unlock(&s_mcp.mu);
+    return st;
+}
+
+static const HAL_GpioOps k_fint_ops = {
+    .scheme = "fint", .priority = -10,
+    .chip_open = _fint_open, .line_request = _fint_request,
+    .line_write = _fint_write, .line_read = _fint_read, .line_wait_event = _fint_wait,
+};
+HAL_GPIO_BACKEND_REGISTER(k_fint_ops)
+
+/* ---------------- checks ---------------- */
+
+static HAL_GpioLine* _req(HAL_GpioChip* c, int off, HAL_GpioDir dir, HAL_GpioEdge edge, HAL_GpioDrive drive) {
+    HAL_GpioLineConfig lc = {
+        .offset = off, .dir = dir, .edge = edge, .drive = drive,
+        .bias = HAL_GPIO_BIAS_PULL_UP, .active = HAL_GPIO_ACTIVE_LOW,
+    };
+    HAL_GpioLine* l = NULL;
+    HAL_GpioStatus st = HAL_GpioLine_Request(c, &lc, &l);
+    CHECK(st == HAL_GPIO_OK, "request line %d: status %d", off, (int)st);
+    return l;
+}
+
+static void _check_names(void) {
+    static const char* bad[] = {
+        "mcp23x:/dev/i2c-9",              /* thiếu @addr */
+        "mcp23x:/dev/i2c-9@0x80",         /* ngoài 7 bit */
+        "mcp23x:/dev/i2c-9@0x20,12",      /* số pin lạ */
+        "mcp23x:/dev/i2c-9@0x20,int=x",   /* int thiếu /offset */
+    };
+    printf("chip names\n");
+    for (unsigned i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        HAL_GpioChipConfig cc = { .chip_name = bad[i] };
+        HAL_GpioChip* c = NULL;
+        CHECK(HAL_GpioChip_Open(&cc, &c) != HAL_GPIO_OK, "'%s' accepted", bad[i]);
+        if (c) HAL_GpioChip_Close(c);
+    }
+    _reset(16, 0xFFFF);
+    s_mcp.nack = 1;                        /* không có chip ở địa chỉ này */
+    HAL_GpioChipConfig cc = { .chip_name = "mcp23x:/dev/i2c-9@0x21" };
+    HAL_GpioChip* c = NULL;
+    CHECK(HAL_GpioChip_Open(&cc, &c) == HAL_GPIO_EIO, "open with NACK did not fail with EIO");
+    if (c) HAL_GpioChip_Close(c);
+}
+
+typedef struct {
+    HAL_GpioLine* line;
+    int           want;
+    int           got;
+    HAL_GpioEdge  edge[4];
+} Waiter;
+
+static void* _waiter(void* arg) {
+    Waiter* w = (Waiter*)arg;
+    HAL_GpioEvent ev;
+    while (w->got < w->want && HAL_GpioLine_WaitEvent(w->line, 2000, &ev) == HAL_GPIO_OK)
+        w->edge[w->got++] = ev.edge;
+    return NULL;
+}
+
+static void _sleep_ms(unsigned ms) {
+    struct timespec ts = { .tv_sec = ms / 1000u, .tv_nsec = (long)(ms % 1000u) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+static void _check_17(void) {
+    printf("MCP23017 with INT\n");
+    _reset(16, 0xFFFF);
+    HAL_GpioChipConfig cc = { .chip_name = "mcp23x:/dev/i2c-9@0x20,16,int=fint:host/3" };
+    HAL_GpioChip* c = NULL;
+    CHECK(HAL_GpioChip_Open(&cc, &c) == HAL_GPIO_OK, "open failed");
+    if (!c) return;
+    CHECK((_reg(R_IOCON) & 0xFF) == 0x44, "IOCON %#x, want ODR | MIRROR", _reg(R_IOCON));
+    CHECK(_reg(R_GPINTEN) == 0, "GPINTEN %#x left from before open", _reg(R_GPINTEN));
+
+    /* outputs GPB0..7 */
+    HAL_GpioLine* out[8];
+    for (int i = 0; i < 8; ++i) out[i] = _req(c, 8 + i, HAL_GPIO_DIR_OUT, HAL_GPIO_EDGE_NONE, HAL_GPIO_DRIVE_PUSHPULL);
+    HAL_GpioGroup g = { .lines = out, .count = 8 };
+    unsigned w0 = _writes();
+    CHECK(HAL_GpioGroup_WriteMask(&g, 0xFF, 0xA5) == HAL_GPIO_OK, "group write failed");
+    CHECK(_writes() - w0 == 1, "group write: %u bus writes, want 1", _writes() - w0);
+    /* active-low: logic 0xA5 -> mức 0x5A trên GPB */
+    CHECK((_reg(R_OLAT) >> 8) == 0x5A && (_reg(R_IODIR) >> 8) == 0x00,
+          "OLAT %#x IODIR %#x", _reg(R_OLAT), _reg(R_IODIR));
+    w0 = _writes();
+    HAL_GpioGroup_WriteMask(&g, 0xFF, 0xA5);
+    CHECK(_writes() == w0, "unchanged group write hit the bus");
+    unsigned r0 = _reads();
+    int v = -1;
+    CHECK(HAL_GpioLine_Read(out[0], &v) == HAL_GPIO_OK && v == 1 && _reads() == r0,
+          "output read: value %d, %u bus reads", v, _reads() - r0);
+
+    /* inputs GPA0..3, pull-up, edge: mọi input bật interrupt-on-change */
+    HAL_GpioLine* in[4];
+    for (int i = 0; i < 4; ++i) in[i] = _req(c, i, HAL_GPIO_DIR_IN, HAL_GPIO_EDGE_BOTH, HAL_GPIO_DRIVE_PUSHPULL);
+    CHECK((_reg(R_GPPU) & 0x0F) == 0x0F && (_reg(R_GPINTEN) & 0xFFFF) == 0x0F,
+          "GPPU %#x GPINTEN %#x", _reg(R_GPPU), _reg(R_GPINTEN));
+    CHECK(HAL_GpioLine_Write(in[0], 1) == HAL_GPIO_EINVAL, "write on an input line is not EINVAL");
+
+    HAL_GpioGroup gi = { .lines = in, .count = 4 };
+    uint32_t bm = ~0u;
+    r0 = _reads();
+    for (int k = 0; k < 100; ++k) HAL_GpioGroup_ReadBitmap(&gi, &bm);
+    CHECK(_reads() == r0 && bm == 0, "idle group reads: %u bus reads, bitmap %#x", _reads() - r0, bm);
+    HAL_GpioEvent ev;
+    for (int i = 0; i < 4; ++i) while (HAL_GpioLine_WaitEvent(in[i], 0, &ev) == HAL_GPIO_OK) { }
+
+    _drive(0xFFFF & ~(1u << 2));           /* ấn GPA2 */
+    r0 = _reads();
+    HAL_GpioGroup_ReadBitmap(&gi, &bm);
+    CHECK(bm == 0x4 && _reads() - r0 == 1, "after press: bitmap %#x, %u bus reads (want 0x4, 1)", bm, _reads() - r0);
+    CHECK(HAL_GpioLine_WaitEvent(in[2], 0, &ev) == HAL_GPIO_OK && ev.edge == HAL_GPIO_EDGE_RISING,
+          "no rising event for the press on GPA2");
+    _drive(0xFFFF);
+    HAL_GpioGroup_ReadBitmap(&gi, &bm);
+    while (HAL_GpioLine_WaitEvent(in[2], 0, &ev) == HAL_GPIO_OK) { }
+
+    /* event chờ INT từ thread khác */
+    Waiter w = { .line = in[1], .want = 2 };
+    pthread_t th;
+    pthread_create(&th, NULL, _waiter, &w);
+    _sleep_ms(20);
+    _drive(0xFFFF & ~(1u << 1));
+    _sleep_ms(20);
+    _drive(0xFFFF);
+    pthread_join(th, NULL);
+    CHECK(w.got == 2 && w.edge[0] == HAL_GPIO_EDGE_RISING && w.edge[1] == HAL_GPIO_EDGE_FALLING,
+          "waiter got %d event(s), want rising + falling", w.got);
+
+    /* xung ngắn đọc muộn: INTCAP giữ cạnh đầu, GPIO cho mức cuối */
+    _drive(0xFFFF & ~1u);
+    _drive(0xFFFF);
+    int n = 0;
+    HAL_GpioEdge e[4];
+    while (n < 4 && HAL_GpioLine_WaitEvent(in[0], 100, &ev) == HAL_GPIO_OK) e[n++] = ev.edge;
+    CHECK(n == 2 && e[0] == HAL_GPIO_EDGE_RISING && e[1] == HAL_GPIO_EDGE_FALLING,
+          "short pulse: %d event(s), want rising + falling", n);
+
+    /* open-drain = IODIR: logic 1 (active-low) kéo thấp, logic 0 thả nổi */
+    HAL_GpioLine* od = _req(c, 4, HAL_GPIO_DIR_OUT, HAL_GPIO_EDGE_NONE, HAL_GPIO_DRIVE_OPENDRAIN);
+    HAL_GpioLine_Write(od, 1);
+    CHECK(!(_reg(R_IODIR) & 0x10) && !(_reg(R_OLAT) & 0x10), "open-drain on: IODIR %#x OLAT %#x",
+          _reg(R_IODIR), _reg(R_OLAT));
+    HAL_GpioLine_Write(od, 0);
+    CHECK(_reg(R_IODIR) & 0x10, "open-drain off: IODIR %#x", _reg(R_IODIR));
+
+    /* không hỗ trợ / lỗi bus */
+    HAL_GpioLineConfig lc = { .offset = 5, .dir = HAL_GPIO_DIR_IN, .bias = HAL_GPIO_BIAS_PULL_DOWN };
+    HAL_GpioLine* l = NULL;
+    CHECK(HAL_GpioLine_Request(c, &lc, &l) == HAL_GPIO_ENOSUP, "PULL_DOWN not ENOSUP");
+    lc = (HAL_GpioLineConfig){ .offset = 5, .dir = HAL_GPIO_DIR_OUT, .drive = HAL_GPIO_DRIVE_OPENSOURCE };
+    CHECK(HAL_GpioLine_Request(c, &lc, &l) == HAL_GPIO_ENOSUP, "OPENSOURCE not ENOSUP");
+    lc = (HAL_GpioLineConfig){ .offset = 16, .dir = HAL_GPIO_DIR_IN };
+    CHECK(HAL_GpioLine_Request(c, &lc, &l) != HAL_GPIO_OK, "offset 16 accepted on a 16-pin chip");
+    s_mcp.nack = 1;
+    CHECK(HAL_GpioLine_Write(out[1], 1) == HAL_GPIO_EIO, "NACK on write not EIO");   /* bit 1 đang 0 -> phải ra bus */
+
+    HAL_GpioMcp23xStats st;
+    HAL_GpioMcp23x_GetStats(c, &st);
+    printf("  bus writes %llu, reads %llu, cached writes %llu, cached reads %llu, INT services %llu, events %llu\n",
+           (unsigned long long)st.reg_writes, (unsigned long long)st.reg_reads,
+           (unsigned long long)st.writes_cached, (unsigned long long)st.reads_cached,
+           (unsigned long long)st.int_services, (unsigned long long)st.events);
+    CHECK(st.events_dropped == 0, "%llu events dropped", (unsigned long long)st.events_dropped);
+    HAL_GpioChip_Close(c);
+}
+
+static void _check_08(void) {
+    printf("MCP23008 without INT\n");
+    _reset(8, 0xFF);
+    HAL_GpioChipConfig cc = { .chip_name = "mcp23x:/dev/i2c-9@0x27,8" };
+    HAL_GpioChip* c = NULL;
+    CHECK(HAL_GpioChip_Open(&cc, &c) == HAL_GPIO_OK, "open failed");
+    if (!c) return;
+    CHECK(_reg(R_IOCON) == 0x04, "IOCON %#x, want ODR", _reg(R_IOCON));
+    HAL_GpioLineConfig lc = { .offset = 0, .dir = HAL_GPIO_DIR_IN, .edge = HAL_GPIO_EDGE_BOTH };
+    HAL_GpioLine* l = NULL;
+    CHECK(HAL_GpioLine_Request(c, &lc, &l) == HAL_GPIO_ENOSUP, "edge without INT not ENOSUP");
+    lc = (HAL_GpioLineConfig){ .offset = 8, .dir = HAL_GPIO_DIR_IN };
+    CHECK(HAL_GpioLine_Request(c, &lc, &l) != HAL_GPIO_OK, "offset 8 accepted on an 8-pin chip");
+
+    HAL_GpioLine* in = _req(c, 0, HAL_GPIO_DIR_IN, HAL_GPIO_EDGE_NONE, HAL_GPIO_DRIVE_PUSHPULL);
+    HAL_GpioLine* out[4];
+    for (int i = 0; i < 4; ++i) out[i] = _req(c, 4 + i, HAL_GPIO_DIR_OUT, HAL_GPIO_EDGE_NONE, HAL_GPIO_DRIVE_PUSHPULL);
+    unsigned r0 = _reads();
+    int v = -1;
+    for (int k = 0; k < 10; ++k) HAL_GpioLine_Read(in, &v);
+    CHECK(_reads() - r0 == 10 && v == 0, "input reads: %u bus reads (want 10), value %d", _reads() - r0, v);
+    _drive(0xFE);
+    HAL_GpioLine_Read(in, &v);
+    CHECK(v == 1, "input after press: %d", v);
+    CHECK(HAL_GpioLine_Write(in, 1) == HAL_GPIO_EINVAL, "write on an input line is not EINVAL");
+
+    HAL_GpioGroup g = { .lines = out, .count = 4 };
+    unsigned w0 = _writes();
+    HAL_GpioGroup_WriteMask(&g, 0xF, 0x5);
+    CHECK(_writes() - w0 == 1 && _reg(R_OLAT) == 0xA0, "group write: %u bus writes, OLAT %#x (want 1, 0xa0)",
+          _writes() - w0, _reg(R_OLAT));
+    HAL_GpioChip_Close(c);
+}
+
+int main(void) {
+    _check_names();
+    _check_17();
+    _check_08();
+    printf("result  : %s (%d failure(s))\n", s_fail ? "FAIL" : "OK", s_fail);
+    return s_fail ? 1 : 0;
+}
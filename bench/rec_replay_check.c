@@ -0,0 +1,161 @@
+/**
+ * @file rec_replay_check.c
+ * @brief Record -> replay round trip on the sim backend: replay must hand the
+ *        app exactly what it got while recording, call by call.
+ *
+ * Record: chip "sim:rr", output 0, input 1 (edge BOTH). N rounds of
+ * SetInput (only on some rounds) / Read / Write / WaitEvent(10 ms), so the
+ * log has reads, writes, events and WaitEvent timeouts interleaved.
+ *
+ * Replay (AFAP, then REALTIME): the same call sequence with the chip opened
+ * through replay (SetInput has no effect there). Per mode:
+ *  - every Read returns the recorded value, every WaitEvent the recorded
+ *    status / edge (a timeout stays a timeout at the same call);
+ *  - writes match (0 mismatches), no call finds its channel exhausted;
+ *  - REALTIME is pacing only: the run takes about as long as the recording,
+ *    AFAP much less.
+ *
+ * Usage:
+ *   rec_replay_check [-n rounds] [-f log]      (make rec-replay-check; -f giữ lại log)
+ */
+#define _GNU_SOURCE
+#include "hal_gpio.h"
+#include "hal_gpio_sim.h"
+#include "hal_rec.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RR_MAX_ROUNDS 256
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...) do {                          \
+        if (!(cond)) {                                 \
+            s_fail++;                                  \
+            printf("  FAIL: " __VA_ARGS__);            \
+            printf("\n");                              \
+        }                                              \
+    } while (0)
+
+typedef struct {
+    int          read[RR_MAX_ROUNDS];
+    int          ev_st[RR_MAX_ROUNDS];
+    HAL_GpioEdge ev_edge[RR_MAX_ROUNDS];
+    uint64_t     elapsed_ns;
+} RrTrace;
+
+static uint64_t _now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* chuỗi call giống hệt nhau khi ghi và khi replay; trả 0 nếu mở được chip/line */
+static int _run(int rounds, RrTrace* tr) {
+    HAL_GpioChipConfig cc = { .chip_name = "sim:rr" };
+    HAL_GpioChip* c = NULL;
+    if (HAL_GpioChip_Open(&cc, &c) != HAL_GPIO_OK) return -1;
+    HAL_GpioLineConfig oc = { .offset = 0, .dir = HAL_GPIO_DIR_OUT };
+    HAL_GpioLineConfig ic = { .offset = 1, .dir = HAL_GPIO_DIR_IN, .edge = HAL_GPIO_EDGE_BOTH };
+    HAL_GpioLine *out = NULL, *in = NULL;
+    if (HAL_GpioLine_Request(c, &oc, &out) != HAL_GPIO_OK || HAL_GpioLine_Request(c, &ic, &in) != HAL_GPIO_OK) {
+        HAL_GpioChip_Close(c);
+        return -1;
+    }
+
+    uint64_t t0 = _now_ns();
+    for (int i = 0; i < rounds; ++i) {
+        /* đổi input ở 2 round trên 3: round còn lại WaitEvent phải timeout */
+        if (i % 3 != 2) HAL_GpioSim_SetInput(c, 1, (i / 3 + i) & 1);
+        int v = -1;
+        HAL_GpioLine_Read(in, &v);
+        tr->read[i] = v;
+        HAL_GpioLine_Write(out, i & 1);
+        HAL_GpioEvent ev = {0};
+        tr->ev_st[i]   = (int)HAL_GpioLine_WaitEvent(in, 10, &ev);
+        tr->ev_edge[i] = (tr->ev_st[i] == HAL_GPIO_OK) ? ev.edge : HAL_GPIO_EDGE_NONE;
+    }
+    tr->elapsed_ns = _now_ns() - t0;
+    HAL_GpioChip_Close(c);
+    return 0;
+}
+
+static void _compare(const char* mode, int rounds, const RrTrace* rec, const RrTrace* rp) {
+    int bad_read = 0, bad_ev = 0, timeouts = 0;
+    for (int i = 0; i < rounds; ++i) {
+        if (rp->read[i] != rec->read[i]) bad_read++;
+        if (rp->ev_st[i] != rec->ev_st[i] || rp->ev_edge[i] != rec->ev_edge[i]) bad_ev++;
+        if (rec->ev_st[i] == HAL_GPIO_ENOENT) timeouts++;
+    }
+    HAL_ReplayStats st;
+    HAL_Replay_GetStats(&st);
+    printf("  %-8s: %.1f ms, served %llu, mismatches %llu, exhausted %llu, %d timeout(s) replayed\n",
+           mode, (double)rp->elapsed_ns / 1e6, (unsigned long long)st.served,
+           (unsigned long long)st.mismatches, (unsigned long long)st.exhausted, timeouts);
+    CHECK(bad_read == 0, "%s: %d read(s) differ from the recording", mode, bad_read);
+    CHECK(bad_ev == 0, "%s: %d WaitEvent result(s) differ from the recording", mode, bad_ev);
+    CHECK(st.mismatches == 0, "%s: %llu write mismatch(es)", mode, (unsigned long long)st.mismatches);
+    CHECK(st.exhausted == 0, "%s: %llu call(s) found the log exhausted", mode, (unsigned long long)st.exhausted);
+}
+
+static void usage(const char* p) {
+    fprintf(stderr, "usage: %s [-n rounds] [-f log]\n", p);
+}
+
+int main(int argc, char** argv) {
+    int rounds = 30, keep = 0;
+    char path[128];
+    snprintf(path, sizeof(path), "/tmp/rec_replay_check.%d.halrec", (int)getpid());
+
+    int c;
+    while ((c = getopt(argc, argv, "n:f:h")) != -1) {
+        switch (c) {
+        case 'n': rounds = atoi(optarg); break;
+        case 'f': snprintf(path, sizeof(path), "%s", optarg); keep = 1; break;
+        default:  usage(argv[0]); return c == 'h' ? 0 : 2;
+        }
+    }
+    if (rounds < 1 || rounds > RR_MAX_ROUNDS) { usage(argv[0]); return 2; }
+
+    static RrTrace rec, rp;
+    printf("record  : %s, %d round(s)\n", path, rounds);
+    if (HAL_Rec_Open(path) != 0) { printf("result  : FAIL (cannot open %s)\n", path); return 1; }
+    int rc = _run(rounds, &rec);
+    HAL_Rec_Close();
+    CHECK(rc == 0, "record: chip / line open failed");
+    int sum = 0, events = 0;
+    for (int i = 0; i < rounds; ++i) {
+        sum += rec.read[i] * (i + 1);
+        events += rec.ev_st[i] == HAL_GPIO_OK;
+    }
+    printf("  %.1f ms, read checksum %d, %d event(s), %d timeout(s)\n",
+           (double)rec.elapsed_ns / 1e6, sum, events, rounds - events);
+    CHECK(events > 0 && events < rounds, "recording should have both events and timeouts");
+
+    static const struct { const char* name; HAL_ReplaySpeed speed; } modes[] = {
+        { "afap",     HAL_REPLAY_AFAP },
+        { "realtime", HAL_REPLAY_REALTIME },
+    };
+    printf("replay\n");
+    for (unsigned m = 0; m < sizeof(modes) / sizeof(modes[0]) && rc == 0; ++m) {
+        memset(&rp, 0, sizeof(rp));
+        CHECK(HAL_Replay_Open(path, modes[m].speed) == 0, "%s: replay open failed", modes[m].name);
+        CHECK(_run(rounds, &rp) == 0, "%s: chip / line open failed", modes[m].name);
+        _compare(modes[m].name, rounds, &rec, &rp);
+        HAL_Replay_Close();
+        if (modes[m].speed == HAL_REPLAY_REALTIME)
+            CHECK(rp.elapsed_ns * 10 >= rec.elapsed_ns * 8, "realtime replay ran too fast (%.1f ms)",
+                  (double)rp.elapsed_ns / 1e6);
+        else
+            CHECK(rp.elapsed_ns * 2 <= rec.elapsed_ns, "afap replay not faster than the recording (%.1f ms)",
+                  (double)rp.elapsed_ns / 1e6);
+    }
+    if (!keep) unlink(path);
+    printf("result  : %s (%d failure(s))\n", s_fail ? "FAIL" : "OK", s_fail);
+    return s_fail ? 1 : 0;
+}
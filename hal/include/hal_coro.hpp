@@ -0,0 +1,727 @@
+/**
+ * @file hal_coro.hpp
+ * @brief Header-only C++20 coroutine adapters for HAL waits on an epoll executor.
+ *
+ * Notes:
+ *  - One Executor = one thread, one epoll fd, one timerfd (all deadlines share
+ *    it through a min-heap) and one eventfd for cross-thread Spawn()/Stop().
+ *    A parked coroutine costs its frame plus one epoll registration; there is
+ *    no thread per wait.
+ *  - ExecutorPool runs N executors on N threads (optionally pinned, one per
+ *    core). A task stays on the executor it was spawned on.
+ *  - Task<T> is lazy; co_await on it runs it inline (symmetric transfer).
+ *    Spawn() detaches a Task<void>; its frame is freed when it finishes.
+ *  - No exceptions (like the rest of the HAL): results are status codes;
+ *    an exception escaping a coroutine terminates.
+ *  - fd waits use EPOLLONESHOT and stay registered between waits (re-armed
+ *    with one EPOLL_CTL_MOD). Only one coroutine may wait on a given fd at a
+ *    time on a given executor.
+ *
+ * Example (one "device" of many, all on one thread):
+ *   hal::coro::Task<void> Device(const char* sock, int id) {
+ *       hal::coro::LineSocket s;
+ *       if (co_await s.Open(sock, 1000) < 0) co_return;
+ *       char reply[64];
+ *       for (int i = 0; i < 100; ++i) {
+ *           co_await s.Request("PRESS 0", reply, sizeof reply, 500);
+ *           co_await hal::coro::Sleep(10);
+ *       }
+ *   }
+ *   hal::coro::Executor ex;
+ *   for (int i = 0; i < 1000; ++i) ex.Spawn(Device("/tmp/gpio_sim.sock", i));
+ *   ex.Run();
+ */
+#pragma once
+#include "hal_gpio.h"
+#include "hal_uart.h"
+
+#include <atomic>
+#include <climits>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace hal::coro {
+
+class Executor;
+template <class T = void> class Task;
+
+namespace detail {
+
+inline thread_local Executor* t_current = nullptr;
+
+inline uint64_t NowNs() noexcept {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* ms -> absolute deadline; timeout_ms < 0 = no deadline */
+inline uint64_t DeadlineNs(int timeout_ms) noexcept {
+    return timeout_ms < 0 ? UINT64_MAX : NowNs() + (uint64_t)timeout_ms * 1000000ull;
+}
+
+/* Remaining ms until deadline, rounded up; -1 = no deadline, 0 = expired */
+inline int RemainingMs(uint64_t deadline_ns) noexcept {
+    if (deadline_ns == UINT64_MAX) return -1;
+    uint64_t now = NowNs();
+    if (now >= deadline_ns) return 0;
+    uint64_t ms = (deadline_ns - now + 999999ull) / 1000000ull;
+    return ms > (uint64_t)INT_MAX ? INT_MAX : (int)ms;
+}
+
+constexpr uint32_t kNoTimer = UINT32_MAX;
+
+/* One parked coroutine: resumed by fd readiness or by its deadline. */
+struct Waiter {
+    std::coroutine_handle<> h;
+    int      fd     = -1;
+    uint32_t events = 0;
+    int      result = 0;          ///< revents (>0), 0 = timeout, <0 = -errno
+    uint32_t timer  = kNoTimer;   ///< timer slot while a deadline is armed
+    bool     done   = false;
+};
+
+struct PromiseBase {
+    std::coroutine_handle<> cont;          ///< awaiting parent (if any)
+    Executor*               owner = nullptr; ///< set for Spawn()ed roots
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    void unhandled_exception() noexcept { std::terminate(); }
+};
+
+template <class T> struct PromiseResult {
+    T value{};
+    void return_value(T v) noexcept { value = std::move(v); }
+    T take() noexcept { return std::move(value); }
+};
+template <> struct PromiseResult<void> {
+    void return_void() noexcept {}
+    void take() noexcept {}
+};
+
+template <class P> struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept;
+    void await_resume() noexcept {}
+};
+
+}  // namespace detail
+
+/* ------------------------------------------------------------------ */
+/* Task                                                                */
+/* ------------------------------------------------------------------ */
+
+template <class T>
+class Task {
+public:
+    struct promise_type : detail::PromiseBase, detail::PromiseResult<T> {
+        Task get_return_object() noexcept { return Task(handle::from_promise(*this)); }
+        detail::FinalAwaiter<promise_type> final_suspend() noexcept { return {}; }
+    };
+    using handle = std::coroutine_handle<promise_type>;
+
+    Task() noexcept = default;
+    explicit Task(handle h) noexcept : h_(h) {}
+    ~Task() { if (h_) h_.destroy(); }
+
+    Task(const Task&)            = delete;
+    Task& operator=(const Task&) = delete;
+    Task(Task&& o) noexcept : h_(std::exchange(o.h_, {})) {}
+    Task& operator=(Task&& o) noexcept {
+        if (this != &o) { if (h_) h_.destroy(); h_ = std::exchange(o.h_, {}); }
+        return *this;
+    }
+
+    bool await_ready() const noexcept { return !h_ || h_.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> parent) noexcept {
+        h_.promise().cont = parent;
+        return h_;
+    }
+    T await_resume() noexcept { return h_.promise().take(); }
+
+    handle Release() noexcept { return std::exchange(h_, {}); }
+
+private:
+    handle h_;
+};
+
+/* ------------------------------------------------------------------ */
+/* Executor                                                            */
+/* ------------------------------------------------------------------ */
+
+class Executor {
+public:
+    enum RunMode { RUN_UNTIL_IDLE = 0, RUN_UNTIL_STOP = 1 };
+
+    Executor() noexcept {
+        ep_   = epoll_create1(EPOLL_CLOEXEC);
+        wake_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        tfd_  = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (ep_ >= 0 && wake_ >= 0) _add_internal(wake_, &wake_);
+        if (ep_ >= 0 && tfd_ >= 0)  _add_internal(tfd_, &tfd_);
+    }
+    ~Executor() {
+        for (void* a : roots_) std::coroutine_handle<>::from_address(a).destroy();
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            for (auto h : inbox_) h.destroy();
+        }
+        if (tfd_ >= 0)  close(tfd_);
+        if (wake_ >= 0) close(wake_);
+        if (ep_ >= 0)   close(ep_);
+    }
+    Executor(const Executor&)            = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    bool Ok() const noexcept { return ep_ >= 0 && wake_ >= 0 && tfd_ >= 0; }
+
+    /** Executor running on the calling thread (nullptr outside Run()). */
+    static Executor* Current() noexcept { return detail::t_current; }
+
+    /** Detach a task onto this executor. Thread-safe. */
+    void Spawn(Task<void> t) noexcept {
+        auto h = t.Release();
+        if (!h) return;
+        h.promise().owner = this;
+        live_.fetch_add(1, std::memory_order_relaxed);
+        if (detail::t_current == this) {
+            roots_.insert(h.address());
+            ready_.push_back(h);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            inbox_.push_back(h);
+        }
+        pending_inbox_.store(true, std::memory_order_release);
+        _wake();
+    }
+
+    /** Ask Run() to return. Thread-safe. A Stop() issued before Run() starts
+     *  is kept: that Run() returns at once. */
+    void Stop() noexcept {
+        stop_.store(true, std::memory_order_relaxed);
+        _wake();
+    }
+
+    /** Forget an earlier Stop() so Run() can be entered again. Call it before
+     *  starting the thread that will Run(), never concurrently with Stop(). */
+    void ClearStop() noexcept { stop_.store(false, std::memory_order_relaxed); }
+
+    /** Number of spawned tasks that have not finished. */
+    int Live() const noexcept { return live_.load(std::memory_order_relaxed); }
+
+    /** Drive tasks on the calling thread until idle (no live task) or Stop(). */
+    void Run(RunMode mode = RUN_UNTIL_IDLE) noexcept {
+        Executor* prev = detail::t_current;
+        detail::t_current = this;
+        while (!stop_.load(std::memory_order_relaxed)) {
+            _drain_inbox();
+            /* run only what is ready now, so fds/timers are not starved */
+            for (size_t n = ready_.size(); n > 0 && !ready_.empty(); --n) {
+                auto h = ready_.front();
+                ready_.pop_front();
+                h.resume();
+            }
+            if (!ready_.empty()) { _poll(0); continue; }
+            if (mode == RUN_UNTIL_IDLE && Live() == 0) break;
+            _poll(-1);
+        }
+        detail::t_current = prev;
+    }
+
+    /* --- used by the awaitables below --- */
+
+    /** Park @p w until fd readiness or timeout. false = completed synchronously. */
+    bool ArmFd(detail::Waiter* w, int timeout_ms) noexcept {
+        if (timeout_ms == 0) {
+            struct pollfd p = { w->fd, (short)w->events, 0 };
+            int rc = poll(&p, 1, 0);
+            w->result = rc < 0 ? -errno : (rc > 0 ? (int)p.revents : 0);
+            return false;
+        }
+        struct epoll_event ev;
+        ev.events   = w->events | EPOLLONESHOT;
+        ev.data.ptr = w;
+        if (epoll_ctl(ep_, EPOLL_CTL_MOD, w->fd, &ev) != 0) {
+            if (errno != ENOENT || epoll_ctl(ep_, EPOLL_CTL_ADD, w->fd, &ev) != 0) {
+                w->result = -errno;
+                return false;
+            }
+        }
+        if (timeout_ms > 0) ArmTimer(w, detail::NowNs() + (uint64_t)timeout_ms * 1000000ull);
+        return true;
+    }
+
+    /** Resume @p w at @p deadline_ns (CLOCK_MONOTONIC). */
+    void ArmTimer(detail::Waiter* w, uint64_t deadline_ns) noexcept {
+        uint32_t slot;
+        if (!free_slots_.empty()) { slot = free_slots_.back(); free_slots_.pop_back(); }
+        else { slot = (uint32_t)slots_.size(); slots_.push_back({nullptr, 0}); }
+        slots_[slot].w = w;
+        w->timer = slot;
+        timers_.push({deadline_ns, slot, slots_[slot].gen});
+        if (deadline_ns < armed_ns_) _arm_timerfd(deadline_ns);
+    }
+
+    /** Queue a handle to run on the next turn (same thread only). */
+    void Schedule(std::coroutine_handle<> h) noexcept { ready_.push_back(h); }
+
+    /* called from FinalAwaiter when a Spawn()ed root finishes */
+    void OnRootDone(std::coroutine_handle<> h) noexcept {
+        roots_.erase(h.address());
+        live_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot { detail::Waiter* w; uint32_t gen; };
+    struct TimerEntry {
+        uint64_t deadline;
+        uint32_t slot;
+        uint32_t gen;
+        bool operator>(const TimerEntry& o) const noexcept { return deadline > o.deadline; }
+    };
+
+    void _add_internal(int fd, void* tag) noexcept {
+        struct epoll_event ev;
+        ev.events   = EPOLLIN;
+        ev.data.ptr = tag;
+        epoll_ctl(ep_, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void _wake() noexcept {
+        uint64_t one = 1;
+        ssize_t r = write(wake_, &one, sizeof one);
+        (void)r;
+    }
+
+    void _drain_inbox() noexcept {
+        if (!pending_inbox_.exchange(false, std::memory_order_acquire)) return;
+        std::lock_guard<std::mutex> lk(mu_);
+        for (auto h : inbox_) { roots_.insert(h.address()); ready_.push_back(h); }
+        inbox_.clear();
+    }
+
+    void _cancel_timer(detail::Waiter* w) noexcept {
+        if (w->timer == detail::kNoTimer) return;
+        slots_[w->timer].gen++;
+        slots_[w->timer].w = nullptr;
+        free_slots_.push_back(w->timer);
+        w->timer = detail::kNoTimer;
+    }
+
+    void _arm_timerfd(uint64_t deadline_ns) noexcept {
+        struct itimerspec its;
+        memset(&its, 0, sizeof its);
+        if (deadline_ns != UINT64_MAX) {
+            its.it_value.tv_sec  = (time_t)(deadline_ns / 1000000000ull);
+            its.it_value.tv_nsec = (long)(deadline_ns % 1000000000ull);
+            if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0) its.it_value.tv_nsec = 1;
+        }
+        timerfd_settime(tfd_, TFD_TIMER_ABSTIME, &its, nullptr);
+        armed_ns_ = deadline_ns;
+    }
+
+    void _fire_timers() noexcept {
+        const uint64_t now = detail::NowNs();
+        while (!timers_.empty() && timers_.top().deadline <= now) {
+            TimerEntry e = timers_.top();
+            timers_.pop();
+            Slot& s = slots_[e.slot];
+            if (s.gen != e.gen || !s.w) continue;      /* cancelled */
+            detail::Waiter* w = s.w;
+            _cancel_timer(w);
+            if (w->done) continue;
+            w->done   = true;
+            w->result = 0;
+            if (w->fd >= 0) epoll_ctl(ep_, EPOLL_CTL_DEL, w->fd, nullptr);
+            ready_.push_back(w->h);
+        }
+        _arm_timerfd(timers_.empty() ? UINT64_MAX : timers_.top().deadline);
+    }
+
+    void _poll(int timeout_ms) noexcept {
+        struct epoll_event evs[64];
+        int n = epoll_wait(ep_, evs, 64, timeout_ms);
+        bool timers_due = false;
+        /* Mark fd waiters first, then timers: no coroutine runs in between, so
+         * every Waiter* returned by this epoll_wait is still alive. */
+        for (int i = 0; i < n; ++i) {
+            void* p = evs[i].data.ptr;
+            if (p == &wake_) {
+                uint64_t v;
+                ssize_t r = read(wake_, &v, sizeof v);
+                (void)r;
+            } else if (p == &tfd_) {
+                uint64_t v;
+                ssize_t r = read(tfd_, &v, sizeof v);
+                (void)r;
+                timers_due = true;
+            } else {
+                auto* w = static_cast<detail::Waiter*>(p);
+                if (w->done) continue;
+                w->done   = true;
+                w->result = (int)evs[i].events;
+                _cancel_timer(w);
+                ready_.push_back(w->h);
+            }
+        }
+        if (timers_due || (!timers_.empty() && timers_.top().deadline <= detail::NowNs())) _fire_timers();
+    }
+
+    int ep_ = -1, wake_ = -1, tfd_ = -1;
+    std::deque<std::coroutine_handle<>> ready_;
+    std::unordered_set<void*> roots_;
+    std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>> timers_;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_slots_;
+    uint64_t armed_ns_ = UINT64_MAX;
+
+    std::mutex mu_;
+    std::vector<std::coroutine_handle<>> inbox_;
+    std::atomic<bool> pending_inbox_{false};
+    std::atomic<bool> stop_{false};
+    std::atomic<int>  live_{0};
+};
+
+template <class P>
+std::coroutine_handle<> detail::FinalAwaiter<P>::await_suspend(std::coroutine_handle<P> h) noexcept {
+    auto& p = h.promise();
+    if (p.cont) return p.cont;
+    if (p.owner) {
+        p.owner->OnRootDone(h);
+        h.destroy();
+    }
+    return std::noop_coroutine();
+}
+
+/* ------------------------------------------------------------------ */
+/* Primitive awaitables                                                */
+/* ------------------------------------------------------------------ */
+
+/** co_await WaitFd(fd, EPOLLIN, ms) -> revents (>0), 0 on timeout, -errno. */
+struct FdAwaiter {
+    detail::Waiter w;
+    int timeout_ms;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> h) noexcept {
+        Executor* ex = Executor::Current();
+        if (!ex) { w.result = -EPERM; return false; }
+        w.h = h;
+        return ex->ArmFd(&w, timeout_ms);
+    }
+    int await_resume() const noexcept { return w.result; }
+};
+
+inline FdAwaiter WaitFd(int fd, uint32_t events, int timeout_ms = -1) noexcept {
+    FdAwaiter a{};
+    a.w.fd      = fd;
+    a.w.events  = events;
+    a.timeout_ms = timeout_ms;
+    return a;
+}
+
+/** co_await SleepUntilNs(t) / Sleep(ms): timer on the executor's timerfd. */
+struct SleepAwaiter {
+    detail::Waiter w;
+    uint64_t deadline_ns;
+
+    bool await_ready() const noexcept { return deadline_ns <= detail::NowNs(); }
+    bool await_suspend(std::coroutine_handle<> h) noexcept {
+        Executor* ex = Executor::Current();
+        if (!ex) return false;
+        w.h = h;
+        ex->ArmTimer(&w, deadline_ns);
+        return true;
+    }
+    void await_resume() const noexcept {}
+};
+
+inline SleepAwaiter SleepUntilNs(uint64_t deadline_ns) noexcept {
+    SleepAwaiter a{};
+    a.deadline_ns = deadline_ns;
+    return a;
+}
+inline SleepAwaiter Sleep(uint32_t ms) noexcept {
+    return SleepUntilNs(detail::NowNs() + (uint64_t)ms * 1000000ull);
+}
+
+/** co_await Yield(): let other ready tasks run. */
+struct YieldAwaiter {
+    bool await_ready() const noexcept { return Executor::Current() == nullptr; }
+    void await_suspend(std::coroutine_handle<> h) noexcept { Executor::Current()->Schedule(h); }
+    void await_resume() const noexcept {}
+};
+inline YieldAwaiter Yield() noexcept { return {}; }
+
+/* ------------------------------------------------------------------ */
+/* HAL adapters                                                        */
+/* ------------------------------------------------------------------ */
+
+/* poll period when a backend has no event fd but reports ENOENT */
+constexpr uint32_t kGpioPollFallbackMs = 1;
+
+/**
+ * @brief Awaitable HAL_GpioLine_WaitEvent.
+ * @return HAL_GPIO_OK with *ev filled, HAL_GPIO_ENOENT on timeout, or the
+ *         backend error (HAL_GPIO_ENOSUP if the line has no events).
+ */
+inline Task<HAL_GpioStatus> GpioEvent(HAL_GpioLine* line, int timeout_ms, HAL_GpioEvent* ev) {
+    const uint64_t deadline = detail::DeadlineNs(timeout_ms);
+    const int fd = HAL_GpioLine_GetEventFd(line);
+    for (;;) {
+        /* ENOENT = nothing pending (or dropped by HAL debounce): wait again */
+        HAL_GpioStatus st = HAL_GpioLine_WaitEvent(line, 0, ev);
+        if (st != HAL_GPIO_ENOENT) co_return st;
+        const int left = detail::RemainingMs(deadline);
+        if (left == 0) co_return HAL_GPIO_ENOENT;
+        if (fd >= 0) {
+            int r = co_await WaitFd(fd, EPOLLIN, left);
+            if (r < 0) co_return HAL_GPIO_EIO;
+        } else {
+            co_await Sleep(kGpioPollFallbackMs);
+        }
+    }
+}
+
+/**
+ * @brief Awaitable HAL_Uart_Read. Same return convention:
+ *        bytes read, 0 on timeout, <0 on error.
+ */
+inline Task<long> UartRead(HAL_Uart* u, void* buf, size_t len, int timeout_ms) {
+    const int fd = HAL_Uart_GetFd(u);
+    if (fd < 0)  /* no fd: blocking fallback */
+        co_return HAL_Uart_Read(u, buf, len, timeout_ms < 0 ? 0xFFFFFFFFu : (uint32_t)timeout_ms);
+    int r = co_await WaitFd(fd, EPOLLIN, timeout_ms);
+    if (r == 0) co_return 0;
+    if (r < 0)  co_return -2;
+    co_return HAL_Uart_Read(u, buf, len, 0);
+}
+
+/* ------------------------------------------------------------------ */
+/* Sockets (stream; fds need not be O_NONBLOCK, MSG_DONTWAIT is used)  */
+/* ------------------------------------------------------------------ */
+
+/** @return bytes (>0), 0 on EOF, -ETIMEDOUT, or -errno. */
+inline Task<long> Recv(int fd, void* buf, size_t len, int timeout_ms = -1) {
+    const uint64_t deadline = detail::DeadlineNs(timeout_ms);
+    for (;;) {
+        ssize_t n = recv(fd, buf, len, MSG_DONTWAIT);
+        if (n >= 0) co_return (long)n;
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) co_return -errno;
+        const int left = detail::RemainingMs(deadline);
+        if (left == 0) co_return -ETIMEDOUT;
+        int r = co_await WaitFd(fd, EPOLLIN | EPOLLRDHUP, left);
+        if (r == 0) co_return -ETIMEDOUT;
+        if (r < 0)  co_return r;
+    }
+}
+
+/** Send all @p len bytes. @return len, -ETIMEDOUT, or -errno. */
+inline Task<long> SendAll(int fd, const void* buf, size_t len, int timeout_ms = -1) {
+    const uint64_t deadline = detail::DeadlineNs(timeout_ms);
+    const char* p = static_cast<const char*>(buf);
+    size_t off = 0;
+    while (off < len) {
+        ssize_t n = send(fd, p + off, len - off, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n > 0) { off += (size_t)n; continue; }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) co_return -errno;
+        const int left = detail::RemainingMs(deadline);
+        if (left == 0) co_return -ETIMEDOUT;
+        int r = co_await WaitFd(fd, EPOLLOUT, left);
+        if (r == 0) co_return -ETIMEDOUT;
+        if (r < 0)  co_return r;
+    }
+    co_return (long)len;
+}
+
+/** Accept one connection (non-blocking, close-on-exec). @return fd or -errno. */
+inline Task<int> Accept(int listen_fd, int timeout_ms = -1) {
+    const uint64_t deadline = detail::DeadlineNs(timeout_ms);
+    for (;;) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd >= 0) co_return fd;
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) co_return -errno;
+        const int left = detail::RemainingMs(deadline);
+        if (left == 0) co_return -ETIMEDOUT;
+        int r = co_await WaitFd(listen_fd, EPOLLIN, left);
+        if (r == 0) co_return -ETIMEDOUT;
+        if (r < 0)  co_return r;
+    }
+}
+
+/** Connect a UNIX stream socket. @return fd or -errno. */
+inline Task<int> ConnectUnix(const char* path, int timeout_ms = -1) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    const uint64_t deadline = detail::DeadlineNs(timeout_ms);
+    for (;;) {
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) co_return -errno;
+        if (connect(fd, (struct sockaddr*)&addr, sizeof addr) == 0) co_return fd;
+        int err = errno;
+        close(fd);
+        /* AF_UNIX: EAGAIN = listen backlog full, the connect must be retried */
+        if (err != EAGAIN) co_return -err;
+        if (detail::RemainingMs(deadline) == 0) co_return -ETIMEDOUT;
+        co_await Sleep(1);
+    }
+}
+
+/**
+ * @brief Newline-framed stream socket (the gpio_daemon text protocol).
+ *        Owns the fd. Not for concurrent use by two coroutines.
+ */
+class LineSocket {
+public:
+    LineSocket() noexcept = default;
+    explicit LineSocket(int fd) noexcept : fd_(fd) {}
+    ~LineSocket() { Close(); }
+    LineSocket(const LineSocket&)            = delete;
+    LineSocket& operator=(const LineSocket&) = delete;
+
+    /** @return 0 or -errno */
+    Task<int> Open(const char* path, int timeout_ms = -1) {
+        Close();
+        int fd = co_await ConnectUnix(path, timeout_ms);
+        if (fd < 0) co_return fd;
+        fd_ = fd;
+        co_return 0;
+    }
+
+    void Close() noexcept {
+        if (fd_ >= 0) close(fd_);
+        fd_  = -1;
+        len_ = 0;
+    }
+
+    int Fd() const noexcept { return fd_; }
+
+    /** Send @p line plus '\n'. @return 0 or -errno. */
+    Task<int> WriteLine(const char* line, int timeout_ms = -1) {
+        char buf[sizeof rx_];
+        size_t n = strnlen(line, sizeof buf - 1);
+        memcpy(buf, line, n);
+        buf[n++] = '\n';
+        long r = co_await SendAll(fd_, buf, n, timeout_ms);
+        co_return r < 0 ? (int)r : 0;
+    }
+
+    /**
+     * @brief Read one line into @p out (without '\n', NUL-terminated).
+     * @return line length, -ECONNRESET on EOF, -EMSGSIZE if it did not fit
+     *         (the line is dropped), -ETIMEDOUT, or -errno.
+     */
+    Task<long> ReadLine(char* out, size_t cap, int timeout_ms = -1) {
+        const uint64_t deadline = detail::DeadlineNs(timeout_ms);
+        for (;;) {
+            char* nl = static_cast<char*>(memchr(rx_, '\n', len_));
+            if (nl) {
+                size_t ln = (size_t)(nl - rx_);
+                long ret;
+                if (ln + 1 > cap) ret = -EMSGSIZE;
+                else { memcpy(out, rx_, ln); out[ln] = '\0'; ret = (long)ln; }
+                len_ -= ln + 1;
+                memmove(rx_, nl + 1, len_);
+                co_return ret;
+            }
+            if (len_ == sizeof rx_) { len_ = 0; co_return -EMSGSIZE; }
+            long n = co_await Recv(fd_, rx_ + len_, sizeof rx_ - len_, detail::RemainingMs(deadline));
+            if (n == 0) co_return -ECONNRESET;
+            if (n < 0)  co_return n;
+            len_ += (size_t)n;
+        }
+    }
+
+    /** WriteLine(cmd) then ReadLine(reply). */
+    Task<long> Request(const char* cmd, char* reply, size_t cap, int timeout_ms = -1) {
+        const uint64_t deadline = detail::DeadlineNs(timeout_ms);
+        int w = co_await WriteLine(cmd, timeout_ms);
+        if (w < 0) co_return w;
+        co_return co_await ReadLine(reply, cap, detail::RemainingMs(deadline));
+    }
+
+private:
+    int    fd_  = -1;
+    size_t len_ = 0;
+    char   rx_[512];
+};
+
+/* ------------------------------------------------------------------ */
+/* Pool: one executor per thread (per core when pinned)                */
+/* ------------------------------------------------------------------ */
+
+class ExecutorPool {
+public:
+    explicit ExecutorPool(unsigned n = 0) {
+        if (n == 0) n = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+        for (unsigned i = 0; i < n; ++i) execs_.emplace_back(new Executor());
+    }
+    ~ExecutorPool() { Stop(); Join(); }
+
+    unsigned  size() const noexcept { return (unsigned)execs_.size(); }
+    Executor& operator[](unsigned i) noexcept { return *execs_[i % execs_.size()]; }
+
+    /** Spawn on executor i % size(). Thread-safe. */
+    void Spawn(unsigned i, Task<void> t) noexcept { (*this)[i].Spawn(std::move(t)); }
+
+    /** Start one thread per executor; pin_cpus: thread i -> CPU i % ncpu. */
+    void Start(Executor::RunMode mode = Executor::RUN_UNTIL_IDLE, bool pin_cpus = true) {
+        const unsigned ncpu = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+        /* clear here, not in Run(): a Stop() racing with thread start-up must not be lost */
+        for (auto& e : execs_) e->ClearStop();
+        for (unsigned i = 0; i < execs_.size(); ++i) {
+            threads_.emplace_back([this, i, mode, pin_cpus, ncpu] {
+                if (pin_cpus) {
+                    cpu_set_t set;
+                    CPU_ZERO(&set);
+                    CPU_SET(i % ncpu, &set);
+                    pthread_setaffinity_np(pthread_self(), sizeof set, &set);
+                }
+                execs_[i]->Run(mode);
+            });
+        }
+    }
+
+    void Stop() noexcept { for (auto& e : execs_) e->Stop(); }
+    void Join() {
+        for (auto& t : threads_) if (t.joinable()) t.join();
+        threads_.clear();
+    }
+
+private:
+    std::vector<std::unique_ptr<Executor>> execs_;
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace hal::coro
@@ -71,6 +71,19 @@ typedef struct {
 
 HAL_GpioStatus HAL_GpioLine_WaitEvent(HAL_GpioLine* line, int timeout_ms, HAL_GpioEvent* out_ev);
 
+/* Pollable fd that becomes readable when an event is pending (for epoll/select
+ * loops; then call WaitEvent(line, 0, ...)). Returns -1 if the backend or the
+ * line has no event fd. The fd is owned by the line: do not close it. */
+int            HAL_GpioLine_GetEventFd(HAL_GpioLine* line);
+
+/* Batched event read: wait up to timeout_ms for the first event (same rules as
+ * WaitEvent), then return every event already queued, up to max, oldest first.
+ * *out_n = number of events stored. HAL_GPIO_ENOENT if none arrived in time.
+ * Backends with a native batch path (uapi, gpiod, sim) drain the queue in one
+ * read; others fall back to repeated WaitEvent calls. */
+HAL_GpioStatus HAL_GpioLine_ReadEvents(HAL_GpioLine* line, int timeout_ms,
+                                       HAL_GpioEvent* out_evs, size_t max, size_t* out_n);
+
 /* Convenience: Groups (array of lines) */
 typedef struct { HAL_GpioLine** lines; size_t count; } HAL_GpioGroup;
 
@@ -0,0 +1,295 @@
+/**
+ * @file hal_gpio.hpp
+ * @brief Header-only C++17 RAII layer over hal_gpio.h with compile-time pin maps.
+ *
+ * Notes:
+ *  - Move-only owners for HAL_GpioChip / HAL_GpioLine / groups; the handle is
+ *    released in the destructor, so early returns no longer leak.
+ *  - No exceptions: factories return HAL_GpioStatus, like the C API.
+ *  - Pin<Chip, Offset, ActiveLow> describes a board pin at compile time.
+ *    Pin lines are requested ACTIVE_HIGH and the active-low inversion is an
+ *    XOR with a constant, so PinLine::Write() is exactly one
+ *    HAL_GpioLine_Write() call with a folded value.
+ *  - PinGroup<Pins...> turns masks and active-low inversion into constants;
+ *    Write()/Read() are one HAL_GpioGroup_* call each.
+ *
+ * Example:
+ *   using Led0 = hal::Pin<0, 0>;
+ *   using Btn0 = hal::Pin<0, 8, true>;             // pressed = low
+ *   using Leds = hal::PinGroup<Led0, hal::Pin<0,1>, hal::Pin<0,2>>;
+ *
+ *   hal::GpioChip chip;
+ *   if (hal::GpioChip::Open("gpiochip0", chip) != HAL_GPIO_OK) return;
+ *   hal::PinLine<Btn0> btn;
+ *   hal::PinLine<Btn0>::Request(chip, HAL_GPIO_DIR_IN, btn);
+ *   Leds leds;
+ *   Leds::Request(chip, leds);
+ *   leds.Write(Leds::mask, 0x5);                   // masked group write
+ */
+#pragma once
+#include "hal_gpio.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace hal {
+
+/* ------------------------------------------------------------------ */
+/* Owners                                                              */
+/* ------------------------------------------------------------------ */
+
+class GpioChip {
+public:
+    GpioChip() noexcept = default;
+    explicit GpioChip(HAL_GpioChip* h) noexcept : h_(h) {}
+    ~GpioChip() { Reset(); }
+
+    GpioChip(const GpioChip&)            = delete;
+    GpioChip& operator=(const GpioChip&) = delete;
+    GpioChip(GpioChip&& o) noexcept : h_(o.Release()) {}
+    GpioChip& operator=(GpioChip&& o) noexcept {
+        if (this != &o) Reset(o.Release());
+        return *this;
+    }
+
+    static HAL_GpioStatus Open(const char* chip_name, GpioChip& out) noexcept {
+        HAL_GpioChipConfig cc = { chip_name };
+        HAL_GpioChip* h = nullptr;
+        HAL_GpioStatus st = HAL_GpioChip_Open(&cc, &h);
+        if (st == HAL_GPIO_OK) out.Reset(h);
+        return st;
+    }
+
+    HAL_GpioChip* Get() const noexcept { return h_; }
+    explicit operator bool() const noexcept { return h_ != nullptr; }
+
+    HAL_GpioChip* Release() noexcept { return std::exchange(h_, nullptr); }
+    void Reset(HAL_GpioChip* h = nullptr) noexcept {
+        if (h_) HAL_GpioChip_Close(h_);
+        h_ = h;
+    }
+
+private:
+    HAL_GpioChip* h_ = nullptr;
+};
+
+class GpioLine {
+public:
+    GpioLine() noexcept = default;
+    explicit GpioLine(HAL_GpioLine* h) noexcept : h_(h) {}
+    ~GpioLine() { Reset(); }
+
+    GpioLine(const GpioLine&)            = delete;
+    GpioLine& operator=(const GpioLine&) = delete;
+    GpioLine(GpioLine&& o) noexcept : h_(o.Release()) {}
+    GpioLine& operator=(GpioLine&& o) noexcept {
+        if (this != &o) Reset(o.Release());
+        return *this;
+    }
+
+    static HAL_GpioStatus Request(const GpioChip& chip, const HAL_GpioLineConfig& cfg, GpioLine& out) noexcept {
+        HAL_GpioLine* h = nullptr;
+        HAL_GpioStatus st = HAL_GpioLine_Request(chip.Get(), &cfg, &h);
+        if (st == HAL_GPIO_OK) out.Reset(h);
+        return st;
+    }
+
+    HAL_GpioStatus Write(int value) const noexcept          { return HAL_GpioLine_Write(h_, value); }
+    HAL_GpioStatus Toggle() const noexcept                  { return HAL_GpioLine_Toggle(h_); }
+    HAL_GpioStatus Read(int& value) const noexcept          { return HAL_GpioLine_Read(h_, &value); }
+    HAL_GpioStatus WaitEvent(int timeout_ms, HAL_GpioEvent& ev) const noexcept {
+        return HAL_GpioLine_WaitEvent(h_, timeout_ms, &ev);
+    }
+    HAL_GpioStatus ReadEvents(int timeout_ms, HAL_GpioEvent* evs, size_t max, size_t& n) const noexcept {
+        return HAL_GpioLine_ReadEvents(h_, timeout_ms, evs, max, &n);
+    }
+
+    HAL_GpioLine* Get() const noexcept { return h_; }
+    explicit operator bool() const noexcept { return h_ != nullptr; }
+
+    HAL_GpioLine* Release() noexcept { return std::exchange(h_, nullptr); }
+    void Reset(HAL_GpioLine* h = nullptr) noexcept {
+        if (h_) HAL_GpioLine_Release(h_);
+        h_ = h;
+    }
+
+private:
+    HAL_GpioLine* h_ = nullptr;
+};
+
+/** Runtime group of N owned lines (bit i = lines[i]). */
+template <std::size_t N>
+class GpioGroup {
+    static_assert(N >= 1 && N <= 32, "HAL groups carry a 32-bit mask");
+public:
+    GpioGroup() noexcept = default;
+    ~GpioGroup() { Reset(); }
+
+    GpioGroup(const GpioGroup&)            = delete;
+    GpioGroup& operator=(const GpioGroup&) = delete;
+    GpioGroup(GpioGroup&& o) noexcept : lines_(std::exchange(o.lines_, {})) {}
+    GpioGroup& operator=(GpioGroup&& o) noexcept {
+        if (this != &o) { Reset(); lines_ = std::exchange(o.lines_, {}); }
+        return *this;
+    }
+
+    /** All-or-nothing: on failure every line already requested is released. */
+    static HAL_GpioStatus Request(const GpioChip& chip, const std::array<HAL_GpioLineConfig, N>& cfgs,
+                                  GpioGroup& out) noexcept {
+        GpioGroup g;
+        for (std::size_t i = 0; i < N; ++i) {
+            HAL_GpioStatus st = HAL_GpioLine_Request(chip.Get(), &cfgs[i], &g.lines_[i]);
+            if (st != HAL_GPIO_OK) return st;   /* g's destructor releases lines[0..i) */
+        }
+        out = std::move(g);
+        return HAL_GPIO_OK;
+    }
+
+    HAL_GpioStatus WriteMask(uint32_t mask, uint32_t value) noexcept {
+        HAL_GpioGroup grp = { lines_.data(), N };
+        return HAL_GpioGroup_WriteMask(&grp, mask, value);
+    }
+    HAL_GpioStatus ReadBitmap(uint32_t& bitmap) noexcept {
+        HAL_GpioGroup grp = { lines_.data(), N };
+        return HAL_GpioGroup_ReadBitmap(&grp, &bitmap);
+    }
+
+    HAL_GpioLine* Line(std::size_t i) const noexcept { return lines_[i]; }
+    static constexpr std::size_t size() noexcept { return N; }
+
+    void Reset() noexcept {
+        for (auto& l : lines_) {
+            if (l) HAL_GpioLine_Release(l);
+            l = nullptr;
+        }
+    }
+
+private:
+    std::array<HAL_GpioLine*, N> lines_{};
+};
+
+/* ------------------------------------------------------------------ */
+/* Compile-time pin map                                                */
+/* ------------------------------------------------------------------ */
+
+/**
+ * @brief One board pin: chip index (into the board's chip table), line offset,
+ *        and polarity. Everything is a constant expression.
+ */
+template <unsigned Chip, unsigned Offset, bool ActiveLow = false>
+struct Pin {
+    static constexpr unsigned chip       = Chip;
+    static constexpr unsigned offset     = Offset;
+    static constexpr bool     active_low = ActiveLow;
+
+    /** logical (1 = asserted) <-> physical level */
+    static constexpr int ToPhysical(int logical) noexcept { return (logical != 0) ^ ActiveLow; }
+    static constexpr int ToLogical(int physical) noexcept { return (physical != 0) ^ ActiveLow; }
+
+    /** Line config: requested active-high, inversion done at compile time. */
+    static constexpr HAL_GpioLineConfig Config(HAL_GpioDir dir, int initial_logical = 0,
+                                               HAL_GpioEdge edge = HAL_GPIO_EDGE_NONE,
+                                               HAL_GpioBias bias = HAL_GPIO_BIAS_AS_IS) noexcept {
+        return HAL_GpioLineConfig{
+            static_cast<int>(Offset), nullptr, dir, HAL_GPIO_ACTIVE_HIGH,
+            HAL_GPIO_DRIVE_PUSHPULL, bias, ToPhysical(initial_logical), edge, 0u
+        };
+    }
+};
+
+template <class P>
+class PinLine {
+public:
+    using pin = P;
+
+    static HAL_GpioStatus Request(const GpioChip& chip, HAL_GpioDir dir, PinLine& out,
+                                  int initial_logical = 0, HAL_GpioEdge edge = HAL_GPIO_EDGE_NONE) noexcept {
+        return GpioLine::Request(chip, P::Config(dir, initial_logical, edge), out.line_);
+    }
+
+    HAL_GpioStatus Write(int logical) const noexcept { return HAL_GpioLine_Write(line_.Get(), P::ToPhysical(logical)); }
+    HAL_GpioStatus Toggle() const noexcept           { return HAL_GpioLine_Toggle(line_.Get()); }
+    HAL_GpioStatus Read(int& logical) const noexcept {
+        int phys = 0;
+        HAL_GpioStatus st = HAL_GpioLine_Read(line_.Get(), &phys);
+        logical = P::ToLogical(phys);
+        return st;
+    }
+
+    /** Physical edge that means "asserted" for this pin. */
+    static constexpr HAL_GpioEdge kAssertEdge = P::active_low ? HAL_GPIO_EDGE_FALLING : HAL_GPIO_EDGE_RISING;
+
+    const GpioLine& Line() const noexcept { return line_; }
+
+private:
+    GpioLine line_;
+};
+
+namespace detail {
+template <class T, class... Ts>
+struct IndexOf;
+template <class T, class... Ts>
+struct IndexOf<T, T, Ts...> : std::integral_constant<unsigned, 0> {};
+template <class T, class U, class... Ts>
+struct IndexOf<T, U, Ts...> : std::integral_constant<unsigned, 1 + IndexOf<T, Ts...>::value> {};
+}  // namespace detail
+
+/**
+ * @brief Group of pins on one chip; bit i = i-th pin in the parameter list.
+ *        mask / invert_mask are constants, so masked writes fold to one call.
+ */
+template <class... Pins>
+class PinGroup {
+    static constexpr std::size_t N = sizeof...(Pins);
+    static_assert(N >= 1 && N <= 32, "HAL groups carry a 32-bit mask");
+    static constexpr unsigned kChip = std::tuple_element_t<0, std::tuple<Pins...>>::chip;
+    static_assert(((Pins::chip == kChip) && ...), "PinGroup pins must share one chip");
+
+public:
+    static constexpr uint32_t mask        = (N == 32) ? 0xFFFFFFFFu : ((1u << N) - 1u);
+    static constexpr uint32_t invert_mask = [] {
+        uint32_t m = 0; unsigned i = 0;
+        ((m |= (Pins::active_low ? (1u << i) : 0u), ++i), ...);
+        return m;
+    }();
+
+    /** Bit of pin P inside this group (compile error if P is not a member). */
+    template <class P>
+    static constexpr uint32_t Bit() noexcept { return 1u << detail::IndexOf<P, Pins...>::value; }
+
+    static HAL_GpioStatus Request(const GpioChip& chip, PinGroup& out,
+                                  HAL_GpioDir dir = HAL_GPIO_DIR_OUT, uint32_t initial_logical = 0) noexcept {
+        unsigned i = 0;
+        std::array<HAL_GpioLineConfig, N> cfgs = {
+            Pins::Config(dir, static_cast<int>((initial_logical >> (i++)) & 1u))...
+        };
+        return GpioGroup<N>::Request(chip, cfgs, out.grp_);
+    }
+
+    /** Logical masked write: one HAL_GpioGroup_WriteMask with constant inversion. */
+    HAL_GpioStatus Write(uint32_t m, uint32_t logical) noexcept {
+        return grp_.WriteMask(m & mask, logical ^ invert_mask);
+    }
+    template <uint32_t M>
+    HAL_GpioStatus WriteMasked(uint32_t logical) noexcept {
+        static_assert((M & ~mask) == 0, "mask outside group");
+        return grp_.WriteMask(M, logical ^ invert_mask);
+    }
+    HAL_GpioStatus Read(uint32_t& logical) noexcept {
+        uint32_t phys = 0;
+        HAL_GpioStatus st = grp_.ReadBitmap(phys);
+        logical = (phys ^ invert_mask) & mask;
+        return st;
+    }
+
+    GpioGroup<N>& Lines() noexcept { return grp_; }
+
+private:
+    GpioGroup<N> grp_;
+};
+
+}  // namespace hal
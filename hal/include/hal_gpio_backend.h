@@ -0,0 +1,94 @@
+#pragma once
+#include "hal_gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file hal_gpio_backend.h
+ * @brief GPIO backend registry: one binary, several backends chosen per chip.
+ *
+ * HAL_GpioChip_Open() chọn backend theo URI trong chip_name:
+ *   "sim:board0"      -> backend "sim"
+ *   "gpiod:gpiochip0" -> libgpiod v1
+ *   "uapi:gpiochip0"  -> ioctl GPIO v2 trực tiếp (không cần libgpiod)
+ *   "rec:<uri>"       -> ghi mọi call của backend <uri> vào log (hal_rec.h)
+ *   "replay:<chip>"   -> trả kết quả từ log đã ghi
+ *   "mcp23x:/dev/i2c-1@0x20,16,int=gpiochip0/17"
+ *                     -> expander I2C MCP23008 / MCP23017 (hal_gpio_mcp23x.h)
+ *   "gpiochip0"       -> backend mặc định: $HAL_GPIO_BACKEND, nếu không có thì
+ *                        backend đã đăng ký có priority cao nhất.
+ * Prefix không khớp backend nào được coi là một phần của tên chip.
+ *
+ * Backend tự đăng ký bằng HAL_GPIO_BACKEND_REGISTER(ops) (constructor):
+ * link file backend vào binary = backend có sẵn.
+ *
+ * Hot path: khi request line, con trỏ write/read của backend được copy vào
+ * handle line, nên HAL_GpioLine_Write/Read chỉ gọi gián tiếp một lần.
+ *
+ * Phạm vi: chỉ GPIO có registry. I2C / SPI / UART vẫn bind lúc link (mỗi
+ * binary một hal_*_linux.c, API hal_i2c.h / hal_spi.h / hal_uart.h gọi thẳng
+ * vào đó); record / replay của bus nằm trong chính các file đó
+ * (HAL_Replay_Target(), tiền tố "replay:" trên tên thiết bị). Muốn chọn
+ * backend bus theo URI thì làm một bảng ops + front end riêng cho từng bus
+ * theo mẫu file này; hiện chưa có backend bus thứ hai nào cần tới.
+ */
+
+#define HAL_GPIO_BACKEND_MAX 8
+
+typedef struct HAL_GpioOps {
+    const char* scheme;      ///< "sim", "gpiod", "uapi"...
+    int         priority;    ///< chọn mặc định khi chip_name không có scheme (cao thắng)
+
+    HAL_GpioStatus (*chip_open)   (const char* name, void** out_chip);
+    void           (*chip_close)  (void* chip);
+    HAL_GpioStatus (*line_request)(void* chip, const HAL_GpioLineConfig* cfg, void** out_line);
+    void           (*line_release)(void* line);
+
+    /* hot path: giá trị logic (active-aware) */
+    HAL_GpioStatus (*line_write)  (void* line, int value);
+    HAL_GpioStatus (*line_read)   (void* line, int* out_value);
+
+    /* tuỳ chọn (NULL -> ENOSUP / -1) */
+    HAL_GpioStatus (*line_wait_event)(void* line, int timeout_ms, HAL_GpioEvent* out_ev);
+    int            (*line_event_fd)  (void* line);
+    /* tuỳ chọn: đọc cả lô event (NULL -> front end lặp line_wait_event) */
+    HAL_GpioStatus (*line_read_events)(void* line, int timeout_ms, HAL_GpioEvent* out_evs,
+                                       size_t max, size_t* out_n);
+    /* tuỳ chọn: cả group trong một lần (vd. expander I2C: một lần ghi OLAT / đọc
+     * GPIO). Front end chỉ gọi khi mọi line của group thuộc backend này; trả
+     * HAL_GPIO_ENOSUP (vd. line của nhiều chip) -> front end lặp từng line. */
+    HAL_GpioStatus (*group_write)(void* const* lines, size_t n, uint32_t mask, uint32_t value);
+    HAL_GpioStatus (*group_read) (void* const* lines, size_t n, uint32_t* out_bitmap);
+
+    int         wrapper;     ///< 1: priv chip/line bắt đầu bằng HAL_GpioWrap (vd. "rec:")
+    int         kernel_io;   ///< 1: mỗi read/write line là một syscall (hal_metrics đếm)
+} HAL_GpioOps;
+
+/* Backend bọc backend khác: priv của chip và line phải bắt đầu bằng struct này
+ * để HAL_Gpio*_BackendPriv() tìm xuyên qua tới backend bên trong. */
+typedef struct {
+    const HAL_GpioOps* inner;
+    void*              priv;
+} HAL_GpioWrap;
+
+/* Trả 0 nếu OK, -1 nếu đầy / trùng scheme */
+int                HAL_GpioBackend_Register(const HAL_GpioOps* ops);
+const HAL_GpioOps* HAL_GpioBackend_Find(const char* scheme);
+/* backend cho chip_name (không mở gì); *out_name = phần tên sau scheme */
+const HAL_GpioOps* HAL_GpioBackend_Resolve(const char* chip_name, const char** out_name);
+
+/* Dữ liệu riêng của backend nếu handle thuộc ops, ngược lại NULL (cho API riêng như HAL_GpioSim_*) */
+void*              HAL_GpioChip_BackendPriv(HAL_GpioChip* chip, const HAL_GpioOps* ops);
+void*              HAL_GpioLine_BackendPriv(HAL_GpioLine* line, const HAL_GpioOps* ops);
+const char*        HAL_GpioChip_Scheme(const HAL_GpioChip* chip);
+
+#define HAL_GPIO_BACKEND_REGISTER(ops_)                                         \
+    __attribute__((constructor)) static void _hal_gpio_backend_reg_##ops_(void) { \
+        HAL_GpioBackend_Register(&(ops_));                                      \
+    }
+
+#ifdef __cplusplus
+}
+#endif
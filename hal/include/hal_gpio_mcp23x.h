@@ -0,0 +1,65 @@
+#pragma once
+#include <stdint.h>
+#include "hal_gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file hal_gpio_mcp23x.h
+ * @brief Backend "mcp23x:": expander I2C MCP23008 (8 pin) / MCP23017 (16 pin)
+ *        dùng như một HAL_GpioChip bình thường (line, group, event).
+ *
+ * Tên chip:
+ *   "mcp23x:<i2c bus>@<addr7>[,8|,16][,int=<gpio chip>/<offset>]"
+ *   vd. "mcp23x:/dev/i2c-1@0x20,16,int=gpiochip0/17"
+ * Mặc định 16 pin (MCP23017, BANK=0); ",8" cho MCP23008. Line offset 0..7 =
+ * GPA0..7 (hoặc GP0..7), 8..15 = GPB0..7.
+ *
+ * Giảm traffic bus:
+ *  - IODIR / GPPU / GPINTEN / OLAT được cache; ghi line / group chỉ ghi
+ *    thanh ghi (và chỉ nửa A / B) thực sự đổi, không đổi thì không ra bus;
+ *  - HAL_GpioGroup_WriteMask trên các line cùng expander = một lần ghi OLAT,
+ *    HAL_GpioGroup_ReadBitmap = một lần đọc GPIO (burst A + B);
+ *  - Read của output trả từ cache OLAT.
+ *
+ * INT (tuỳ chọn, ",int=..."): chân INT của expander (MIRROR=1, open-drain,
+ * active-low) nối vào một line GPIO host, request với edge + pull-up. Mọi
+ * input của expander bật interrupt-on-change, nên:
+ *  - Read input: đọc mức INT trên host; không assert -> trả cache, không chạm
+ *    bus; assert -> một burst đọc INTF + INTCAP + GPIO rồi trả;
+ *  - WaitEvent / ReadEvents trên line có edge: chờ event cạnh của line INT
+ *    host (không poll), rồi một burst đọc phân phát event cho mọi line. Một
+ *    pin đổi hai lần trước khi được đọc (xung ngắn) vẫn ra đủ hai event nhờ
+ *    INTCAP; đổi nhiều hơn thì chỉ thấy lần đầu và mức cuối.
+ * Không có INT: edge != NONE bị từ chối (ENOSUP), Read input đọc bus mỗi lần.
+ *
+ * Drive: push-pull; OPENDRAIN được giả lập bằng IODIR (1 = thả nổi, 0 = kéo
+ * thấp). OPENSOURCE / PULL_DOWN không có trên chip này -> ENOSUP. Bias
+ * PULL_UP = GPPU (100 kΩ nội).
+ *
+ * Line event không có fd để poll (HAL_GpioLine_GetEventFd = -1); vòng epoll
+ * dùng HAL_GpioMcp23x_IntFd() rồi gọi HAL_GpioMcp23x_Service().
+ */
+
+typedef struct {
+    uint64_t reg_writes;      ///< lần ghi thanh ghi qua I2C
+    uint64_t reg_reads;       ///< lần đọc (burst) qua I2C
+    uint64_t writes_cached;   ///< ghi line / group không đổi thanh ghi nào -> không ra bus
+    uint64_t reads_cached;    ///< Read input trả từ cache (INT không assert)
+    uint64_t int_services;    ///< lần đọc INTF + INTCAP + GPIO
+    uint64_t events;          ///< event đã xếp hàng cho line
+    uint64_t events_dropped;  ///< hàng đợi event của line đầy
+} HAL_GpioMcp23xStats;
+
+/* fd event của line INT host (poll/epoll), -1 nếu không có INT / backend host không có fd */
+int            HAL_GpioMcp23x_IntFd  (HAL_GpioChip* chip);
+/* Xử lý INT nếu đang assert (không chặn): event vào hàng đợi của các line.
+ * Trả HAL_GPIO_OK, ENOENT nếu không có INT đang chờ, EIO nếu lỗi bus. */
+HAL_GpioStatus HAL_GpioMcp23x_Service(HAL_GpioChip* chip);
+HAL_GpioStatus HAL_GpioMcp23x_GetStats(HAL_GpioChip* chip, HAL_GpioMcp23xStats* out);
+
+#ifdef __cplusplus
+}
+#endif
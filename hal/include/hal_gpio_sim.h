@@ -0,0 +1,92 @@
+#pragma once
+#include <stdint.h>
+#include "hal_gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file hal_gpio_sim.h
+ * @brief API riêng của backend "sim:": giả lập input, đọc output, và tầng
+ *        tạo dạng tín hiệu (bounce / glitch / cạnh chậm) trên timeline µs.
+ *
+ * Mặc định SetInput đổi mức sạch và ngay lập tức (như trước). Gắn một
+ * HAL_GpioSimShape cho line thì mỗi lần SetInput sinh ra chuỗi cạnh vật lý:
+ *
+ *   mức cũ ──┐  chatter quanh ngưỡng   bounce                  mức mới
+ *            └─┐┌┐┌──────┐  ┌────┐ ┌──────────────────────────────
+ *              └┘└┘      └──┘    └─┘
+ *            |<- slow_edge_us ->|<- gap ->|...
+ *
+ * cộng glitch Poisson (xung ngắn lật mức rồi trở lại) khi line đang ổn định.
+ * Read() thấy mức vật lý tại "bây giờ"; line request với edge != NONE nhận
+ * HAL_GpioEvent cho từng cạnh (timestamp = thời điểm trên timeline, ns) và
+ * qua soft debounce của HAL y như backend gpiod/uapi.
+ *
+ * Timeline:
+ *  - mặc định theo CLOCK_MONOTONIC (daemon/demo chạy thời gian thật);
+ *  - HAL_GpioSim_UseVirtualTime(): thời gian chỉ chạy khi gọi Advance()
+ *    (bench, scenario runner: tất định, nhanh hơn thời gian thật). Khi đó
+ *    WaitEvent không bao giờ chặn: hết event thì trả HAL_GPIO_ENOENT.
+ *
+ * Ngẫu nhiên: mỗi line có RNG riêng (xorshift) seed theo shape.seed, nên hai
+ * line cùng shape + cùng chuỗi SetInput/Advance cho ra cùng dạng sóng.
+ */
+
+typedef enum {
+    HAL_GPIO_SIM_DIST_UNIFORM = 0,  ///< khoảng cách đều trong [min, max]
+    HAL_GPIO_SIM_DIST_EXP,          ///< mũ, mean = (min+max)/2, kẹp trong [min, max]
+} HAL_GpioSimDist;
+
+typedef struct {
+    /* bounce: sau khi qua ngưỡng, tiếp điểm nảy n lần (n đều trong [min, max]),
+     * mỗi lần nảy = 2 cạnh cách nhau một khoảng gap */
+    int             bounce_min, bounce_max;
+    HAL_GpioSimDist gap_dist;
+    uint32_t        gap_min_us, gap_max_us;
+    /* cạnh chậm (RC, cáp dài): qua ngưỡng ở giữa slow_edge_us, kèm slow_chatter
+     * cặp cạnh thừa rải trong nửa giữa của đoạn chuyển mức */
+    uint32_t        slow_edge_us;
+    int             slow_chatter;
+    /* glitch: xung nhiễu trên line ổn định, tần suất trung bình glitch_hz */
+    double          glitch_hz;
+    uint32_t        glitch_min_us, glitch_max_us;
+    uint32_t        seed;           ///< 0 = theo offset của line
+} HAL_GpioSimShape;
+
+typedef struct {
+    uint64_t transitions;     ///< số lần SetInput đổi mức (cạnh "thật")
+    uint64_t edges;           ///< cạnh vật lý đã xảy ra (gồm cả cạnh thật)
+    uint64_t spurious;        ///< cạnh thừa: bounce + chatter + glitch
+    uint64_t glitches;
+    uint64_t events_dropped;  ///< hàng đợi event của line bị đầy
+} HAL_GpioSimStats;
+
+/* Đặt mức cho 1 line input (mô phỏng người dùng ấn nút); có shape thì đi qua tầng tạo dạng */
+HAL_GpioStatus HAL_GpioSim_SetInput (HAL_GpioChip* chip, int offset, int logic_val);
+/* Lấy giá trị thực tế của 1 line output (để biết LED đang on/off) */
+HAL_GpioStatus HAL_GpioSim_GetOutput(HAL_GpioChip* chip, int offset, int* out_logic);
+/* Dây nối trong sim: mỗi lần ghi output out_offset, mức vật lý của nó được đặt
+ * lên input in_offset như SetInput (qua shape / event / đánh thức WaitEvent).
+ * in_offset < 0: bỏ nối. Dùng cho loopback (bench_loopback). */
+HAL_GpioStatus HAL_GpioSim_Link     (HAL_GpioChip* chip, int out_offset, int in_offset);
+
+/* shape = NULL: trở lại đổi mức sạch (cạnh đang chờ bị bỏ, line về thẳng mức đích).
+ * Gọi lúc setup: không đổi shape khi thread khác đang Read line đó. */
+HAL_GpioStatus HAL_GpioSim_SetShape (HAL_GpioChip* chip, int offset, const HAL_GpioSimShape* shape);
+/* Profile dựng sẵn: "clean", "tactile", "worn", "noisy", "slow". HAL_GPIO_ENOENT nếu không có. */
+HAL_GpioStatus HAL_GpioSim_ShapePreset(const char* name, HAL_GpioSimShape* out);
+
+/* Chuyển chip sang timeline ảo bắt đầu tại start_us (gọi trước khi dùng line) */
+HAL_GpioStatus HAL_GpioSim_UseVirtualTime(HAL_GpioChip* chip, uint64_t start_us);
+/* Chỉ với timeline ảo: tiến thời gian */
+HAL_GpioStatus HAL_GpioSim_Advance  (HAL_GpioChip* chip, uint64_t us);
+/* Thời điểm hiện tại của timeline chip (µs) */
+uint64_t       HAL_GpioSim_Now      (HAL_GpioChip* chip);
+/* Thống kê cạnh của line tính tới "bây giờ" */
+HAL_GpioStatus HAL_GpioSim_GetStats (HAL_GpioChip* chip, int offset, HAL_GpioSimStats* out);
+
+#ifdef __cplusplus
+}
+#endif
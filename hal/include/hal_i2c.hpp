@@ -0,0 +1,91 @@
+/**
+ * @file hal_i2c.hpp
+ * @brief Header-only C++17 RAII owner for HAL_I2cBus (see hal_i2c.h).
+ *
+ * Move-only; the bus is closed in the destructor. Methods forward 1:1 to the
+ * C API and are inlined, so there is no cost over calling it directly.
+ */
+#pragma once
+#include "hal_i2c.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace hal {
+
+class I2cBus {
+public:
+    I2cBus() noexcept = default;
+    explicit I2cBus(HAL_I2cBus* h) noexcept : h_(h) {}
+    ~I2cBus() { Reset(); }
+
+    I2cBus(const I2cBus&)            = delete;
+    I2cBus& operator=(const I2cBus&) = delete;
+    I2cBus(I2cBus&& o) noexcept : h_(o.Release()) {}
+    I2cBus& operator=(I2cBus&& o) noexcept {
+        if (this != &o) Reset(o.Release());
+        return *this;
+    }
+
+    static HAL_I2cStatus Open(const HAL_I2cBusConfig& cfg, I2cBus& out) noexcept {
+        HAL_I2cStatus st = HAL_I2C_EBUS;
+        HAL_I2cBus* h = HAL_I2cBus_Open(&cfg, &st);
+        if (h) out.Reset(h);
+        return h ? HAL_I2C_OK : st;
+    }
+
+    HAL_I2cStatus Probe(uint8_t addr7) const noexcept { return HAL_I2c_Probe(h_, addr7); }
+    HAL_I2cStatus Write(uint8_t addr7, const uint8_t* d, std::size_t n) const noexcept { return HAL_I2c_Write(h_, addr7, d, n); }
+    HAL_I2cStatus Read(uint8_t addr7, uint8_t* d, std::size_t n) const noexcept { return HAL_I2c_Read(h_, addr7, d, n); }
+    HAL_I2cStatus WriteReg8(uint8_t addr7, uint8_t reg, const uint8_t* d, std::size_t n) const noexcept {
+        return HAL_I2c_WriteReg8(h_, addr7, reg, d, n);
+    }
+    HAL_I2cStatus ReadReg8(uint8_t addr7, uint8_t reg, uint8_t* d, std::size_t n) const noexcept {
+        return HAL_I2c_ReadReg8(h_, addr7, reg, d, n);
+    }
+    HAL_I2cStatus WriteReg8(uint8_t addr7, uint8_t reg, uint8_t v) const noexcept { return HAL_I2c_WriteReg8_U8(h_, addr7, reg, v); }
+    HAL_I2cStatus ReadReg8(uint8_t addr7, uint8_t reg, uint8_t& v) const noexcept { return HAL_I2c_ReadReg8_U8(h_, addr7, reg, &v); }
+    HAL_I2cStatus WriteReg16(uint8_t addr7, uint16_t reg, const uint8_t* d, std::size_t n) const noexcept {
+        return HAL_I2c_WriteReg16(h_, addr7, reg, d, n);
+    }
+    HAL_I2cStatus ReadReg16(uint8_t addr7, uint16_t reg, uint8_t* d, std::size_t n) const noexcept {
+        return HAL_I2c_ReadReg16(h_, addr7, reg, d, n);
+    }
+    HAL_I2cStatus BurstTransfer(uint8_t addr7, const uint8_t* tx, std::size_t tx_len,
+                                uint8_t* rx, std::size_t rx_len) const noexcept {
+        return HAL_I2c_BurstTransfer(h_, addr7, tx, tx_len, rx, rx_len);
+    }
+    int Scan(uint8_t* found, int max_found) const noexcept { return HAL_I2cBus_Scan(h_, found, max_found); }
+
+    HAL_I2cBus* Get() const noexcept { return h_; }
+    explicit operator bool() const noexcept { return h_ != nullptr; }
+
+    HAL_I2cBus* Release() noexcept { return std::exchange(h_, nullptr); }
+    void Reset(HAL_I2cBus* h = nullptr) noexcept {
+        if (h_) HAL_I2cBus_Close(h_);
+        h_ = h;
+    }
+
+private:
+    HAL_I2cBus* h_ = nullptr;
+};
+
+/** One device on a bus: binds the 7-bit address at compile time. */
+template <uint8_t Addr7>
+class I2cDevice {
+    static_assert(Addr7 < 0x80, "7-bit address");
+public:
+    static constexpr uint8_t addr = Addr7;
+    explicit I2cDevice(const I2cBus& bus) noexcept : bus_(&bus) {}
+
+    HAL_I2cStatus ReadReg8(uint8_t reg, uint8_t& v) const noexcept { return bus_->ReadReg8(Addr7, reg, v); }
+    HAL_I2cStatus WriteReg8(uint8_t reg, uint8_t v) const noexcept { return bus_->WriteReg8(Addr7, reg, v); }
+    HAL_I2cStatus ReadReg8(uint8_t reg, uint8_t* d, std::size_t n) const noexcept { return bus_->ReadReg8(Addr7, reg, d, n); }
+    HAL_I2cStatus WriteReg8(uint8_t reg, const uint8_t* d, std::size_t n) const noexcept { return bus_->WriteReg8(Addr7, reg, d, n); }
+
+private:
+    const I2cBus* bus_;
+};
+
+}  // namespace hal
@@ -0,0 +1,94 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file hal_log.h
+ * @brief Log của HAL: có level, lọc lúc compile, giới hạn tần suất theo
+ *        từng call site, sink thay được (OSAL_LOG, ring không chặn).
+ *
+ *   HAL_LOGE("[I2C][LINUX]", "read addr=0x%02X failed errno=%d", addr, errno);
+ *
+ * - Compile: call site có level > HAL_LOG_LEVEL (mặc định INFO) bị bỏ hẳn
+ *   (điều kiện hằng, compiler xoá cả lời gọi lẫn chuỗi format).
+ * - Runtime: HAL_Log_SetLevel() / env HAL_LOG_LEVEL=err|warn|info|debug|off
+ *   (đọc một lần lúc log đầu tiên). Log bị tắt chỉ tốn một load + so sánh.
+ * - Rate limit: mỗi call site có token bucket riêng (HAL_LOG_BURST dòng, hồi
+ *   HAL_LOG_PER_SEC dòng/giây). Dòng bị bỏ được đếm, dòng kế tiếp qua được
+ *   kèm "(+N suppressed)". Cảm biến chập chờn không làm ngập console nữa.
+ * - Sink:
+ *     mặc định      : một write(2) cho cả dòng vào stderr (không qua lock stdio).
+ *     HAL_Log_UseRing(bytes): caller chỉ copy vào ring (trylock, đầy/tranh
+ *                     chấp thì bỏ + đếm), không bao giờ chờ I/O; app gọi
+ *                     HAL_Log_Drain(fd) từ thread/vòng lặp ít ưu tiên.
+ *     HAL_Log_SetSink(fn, ctx): tuỳ ý, vd. chuyển qua OSAL_LOG.
+ */
+
+typedef enum {
+    HAL_LOG_OFF = -1,
+    HAL_LOG_ERR = 0,
+    HAL_LOG_WARN,
+    HAL_LOG_INFO,
+    HAL_LOG_DEBUG,
+} HAL_LogLevel;
+
+#ifndef HAL_LOG_LEVEL
+#define HAL_LOG_LEVEL HAL_LOG_INFO    ///< ngưỡng compile: level lớn hơn bị bỏ
+#endif
+#ifndef HAL_LOG_BURST
+#define HAL_LOG_BURST   5             ///< số dòng liền nhau tối đa của một call site
+#endif
+#ifndef HAL_LOG_PER_SEC
+#define HAL_LOG_PER_SEC 1             ///< tốc độ hồi token (dòng/giây)
+#endif
+#define HAL_LOG_LINE_MAX 256
+
+/* sink nhận một dòng đã format (không có "\r\n"), tag như call site truyền vào */
+typedef void (*HAL_LogSink)(void* ctx, HAL_LogLevel lvl, const char* tag, const char* msg);
+
+/* trạng thái rate limit của một call site (static, zero-init) */
+typedef struct {
+    uint64_t last_ns;       ///< mốc hồi token gần nhất
+    uint32_t tokens;        ///< token còn lại (khởi tạo lười khi last_ns == 0)
+    uint32_t suppressed;    ///< số dòng bị bỏ từ lần in trước
+} HAL_LogSite;
+
+void         HAL_Log_SetLevel(HAL_LogLevel lvl);
+HAL_LogLevel HAL_Log_GetLevel(void);
+void         HAL_Log_SetSink(HAL_LogSink fn, void* ctx);     /* NULL = sink mặc định */
+/* Chuyển sang ring không chặn dung lượng bytes (0 = về sink mặc định). 0 nếu OK. */
+int          HAL_Log_UseRing(size_t bytes);
+/* Xả ring ra fd; trả về số byte đã ghi. Gọi từ một thread duy nhất. */
+size_t       HAL_Log_Drain(int fd);
+/* Tổng số dòng bị bỏ: do rate limit, do ring đầy/tranh chấp */
+void         HAL_Log_Stats(uint64_t* rate_limited, uint64_t* ring_dropped);
+
+/* dùng qua macro; trả về sớm nếu site đang bị giới hạn */
+void         HAL_Log_Write(HAL_LogSite* site, HAL_LogLevel lvl, const char* tag, const char* fmt, ...)
+                           __attribute__((format(printf, 4, 5)));
+
+extern volatile int g_hal_log_level;   /* runtime level, -2 = chưa đọc env */
+
+#define HAL_LOG_ENABLED(lvl_) ((lvl_) <= HAL_LOG_LEVEL && \
+                               ((lvl_) <= g_hal_log_level || g_hal_log_level == -2))
+
+#define HAL_LOG(lvl_, tag_, ...)                                        \
+    do {                                                                \
+        if (HAL_LOG_ENABLED(lvl_)) {                                    \
+            static HAL_LogSite _hal_log_site;                           \
+            HAL_Log_Write(&_hal_log_site, (lvl_), (tag_), __VA_ARGS__); \
+        }                                                               \
+    } while (0)
+
+#define HAL_LOGE(tag_, ...) HAL_LOG(HAL_LOG_ERR,   tag_, __VA_ARGS__)
+#define HAL_LOGW(tag_, ...) HAL_LOG(HAL_LOG_WARN,  tag_, __VA_ARGS__)
+#define HAL_LOGI(tag_, ...) HAL_LOG(HAL_LOG_INFO,  tag_, __VA_ARGS__)
+#define HAL_LOGD(tag_, ...) HAL_LOG(HAL_LOG_DEBUG, tag_, __VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,120 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file hal_metrics.h
+ * @brief Bộ đếm + histogram latency cho từng handle HAL (GPIO chip/line,
+ *        UART, I2C bus, SPI bus): thiết bị nào chiếm thời gian I/O.
+ *
+ * Bật khi build với -DHAL_METRICS=1 (makefile chính bật cho daemon, METRICS=0
+ * để bỏ; makefile_dev/bench mặc định tắt). Tắt thì các macro HAL_MX_* rỗng,
+ * handle không có trường metrics, hot path không đổi một lệnh nào; API đọc
+ * vẫn link được nhưng không có handle.
+ *
+ * Mỗi handle đăng ký một tên ("gpio:gpiochip0/17", "uart:/dev/ttyS1",
+ * "i2c:/dev/i2c-1", "spi:/dev/spidev0.0") -> id. Mở lại cùng tên dùng lại id,
+ * số liệu cộng dồn. Mỗi op ghi:
+ *   ops, bytes, errors, syscalls, và latency (ns) vào histogram log2
+ *   (bucket i = [2^(i-1), 2^i) ns). Call chờ thế giới bên ngoài (WaitEvent,
+ *   poll của UART read) chỉ được đếm, không tính latency.
+ *
+ * Ghi: mỗi thread có shard riêng (lazily, thread-local), chỉ thread đó ghi
+ * -> load + store relaxed, không lock, không RMW atomic, không chia sẻ cache
+ * line giữa các thread. Đọc (Snapshot) cộng các shard bằng load relaxed: số
+ * có thể lệch vài op so với "cùng một thời điểm", không bao giờ bị rách.
+ * Thread kết thúc trả shard về pool, thread sau dùng tiếp (không mất số).
+ *
+ * Chi phí: bộ đếm ~10 ns/op; latency cần 2 lần clock_gettime (vDSO, 20..50
+ * ns mỗi lần). HAL_METRICS_SAMPLE_LOG2=k chỉ đo latency 1/2^k op (mỗi thread
+ * đếm vòng), bộ đếm vẫn đủ; avg/percentile không lệch, chỉ ít mẫu hơn.
+ *
+ * Dùng trong backend:
+ *   HAL_MX_T0(t0);
+ *   ssize_t n = write(fd, buf, len);
+ *   HAL_MX_REC(h->mx, t0, n < 0, n > 0 ? n : 0, 1);
+ */
+
+#ifndef HAL_METRICS
+#define HAL_METRICS 0
+#endif
+
+#ifndef HAL_METRICS_MAX_HANDLES
+#define HAL_METRICS_MAX_HANDLES 64    ///< id 0 = "(overflow)" khi hết chỗ
+#endif
+#define HAL_METRICS_BUCKETS     32    ///< bucket cuối gom mọi thứ >= 2^30 ns
+#ifndef HAL_METRICS_SAMPLE_LOG2
+#define HAL_METRICS_SAMPLE_LOG2 0     ///< đo latency 1/2^k op
+#endif
+
+typedef enum {
+    HAL_METRICS_GPIO_CHIP = 0,
+    HAL_METRICS_GPIO_LINE,
+    HAL_METRICS_UART,
+    HAL_METRICS_I2C,
+    HAL_METRICS_SPI,
+    HAL_METRICS_OTHER,
+} HAL_MetricsClass;
+
+typedef struct {
+    uint64_t ops;
+    uint64_t bytes;
+    uint64_t errors;
+    uint64_t syscalls;
+    uint64_t lat_n;                       ///< số op có đo latency
+    uint64_t lat_sum_ns;
+    uint64_t hist[HAL_METRICS_BUCKETS];
+} HAL_MetricsCounters;
+
+typedef struct {
+    uint16_t            id;
+    HAL_MetricsClass    cls;
+    char                name[48];
+    HAL_MetricsCounters c;
+} HAL_MetricsSnapshot;
+
+/* ---- ghi (backend) ---- */
+uint16_t HAL_Metrics_Handle (HAL_MetricsClass cls, const char* name);
+uint16_t HAL_Metrics_Handlef(HAL_MetricsClass cls, const char* fmt, ...)
+                             __attribute__((format(printf, 2, 3)));
+uint64_t HAL_Metrics_Now    (void);   /* CLOCK_MONOTONIC ns */
+uint64_t HAL_Metrics_Start  (void);   /* Now(), hoặc 0 nếu op này không được lấy mẫu latency */
+/* t0_ns = 0: không đo latency */
+void     HAL_Metrics_Record (uint16_t id, uint64_t t0_ns, int error, uint64_t bytes, uint32_t syscalls);
+
+/* ---- đọc ---- */
+int         HAL_Metrics_Enabled(void);
+/* Ghi tối đa max handle (theo id) vào out, trả về số handle đã đăng ký */
+int         HAL_Metrics_Snapshot(HAL_MetricsSnapshot* out, int max);
+typedef void (*HAL_MetricsVisitor)(const HAL_MetricsSnapshot* s, void* ctx);
+void        HAL_Metrics_ForEach(HAL_MetricsVisitor fn, void* ctx);
+/* Mốc 0 mới cho mọi bộ đếm (không đụng tới shard đang ghi) */
+void        HAL_Metrics_Reset(void);
+/* Cận trên (ns) của bucket chứa percentile p (0..1); 0 nếu chưa có mẫu */
+uint64_t    HAL_Metrics_Percentile(const HAL_MetricsCounters* c, double p);
+/* Mỗi handle có op một dòng:
+ *   "<name> ops=.. bytes=.. err=.. sys=.. avg_ns=.. p50_ns=.. p99_ns=.. max_ns=..\n"
+ * Trả về số byte đã ghi (không tính '\0', cắt ở dòng cuối vừa buf). */
+size_t      HAL_Metrics_Format(char* buf, size_t len);
+const char* HAL_Metrics_ClassName(HAL_MetricsClass cls);
+
+/* ---- macro cho call site: rỗng khi HAL_METRICS=0 ---- */
+#if HAL_METRICS
+#define HAL_MX_OPEN(id_, cls_, ...)                    ((id_) = HAL_Metrics_Handlef((cls_), __VA_ARGS__))
+#define HAL_MX_T0(t0_)                                 uint64_t t0_ = HAL_Metrics_Start()
+#define HAL_MX_REC(id_, t0_, err_, bytes_, sys_)       HAL_Metrics_Record((id_), (t0_), (err_), (uint64_t)(bytes_), (sys_))
+#define HAL_MX_COUNT(id_, err_, bytes_, sys_)          HAL_Metrics_Record((id_), 0, (err_), (uint64_t)(bytes_), (sys_))
+#else
+#define HAL_MX_OPEN(id_, cls_, ...)                    ((void)0)
+#define HAL_MX_T0(t0_)                                 ((void)0)
+#define HAL_MX_REC(id_, t0_, err_, bytes_, sys_)       ((void)0)
+#define HAL_MX_COUNT(id_, err_, bytes_, sys_)          ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
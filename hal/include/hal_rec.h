@@ -0,0 +1,109 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file hal_rec.h
+ * @brief Record every HAL call into an append-only binary log, replay it later.
+ *
+ * Record:
+ *   HAL_Rec_Open("run.halrec");      // hoặc env HAL_REC=run.halrec trước khi mở chip/bus
+ *   ... app chạy bình thường: GPIO (chip mở qua front end), UART, I2C, SPI đều được ghi ...
+ *   HAL_Rec_Close();
+ *
+ * Replay (không cần phần cứng):
+ *   HAL_Replay_Open("run.halrec", HAL_REPLAY_REALTIME);   // hoặc env HAL_REPLAY=run.halrec
+ *                                                          // (HAL_REPLAY_SPEED=afap)
+ *   -> mọi chip/bus mở sau đó đi qua replay, app không cần sửa; hoặc chỉ một
+ *      thiết bị: chip_name "replay:gpiochip0", device "replay:/dev/ttyPS1"...
+ *   -> read/event trả về đúng giá trị đã ghi, write được so với bản ghi
+ *      (khác -> HAL_ReplayStats.mismatches++ : dùng làm regression check).
+ *
+ * Format (little-endian, varint = LEB128):
+ *   header : "HALREC\x01\n" + u64 t0_ns (CLOCK_MONOTONIC lúc mở)
+ *   record : u8 type | varint chan | varint dt_ns | zigzag status | varint alen | a | varint blen | b
+ *   HAL_REC_CHAN định nghĩa tên kênh (a = name) trước lần dùng đầu tiên.
+ *   Bản ghi tự phân định -> file bị cắt ngang (crash) vẫn đọc được phần đầu.
+ *
+ * Kênh: "gpio:<chip>/<offset>", "uart:<device>", "i2c:<bus>", "spi:<device>".
+ */
+
+typedef enum {
+    HAL_REC_CHAN = 0,     ///< a = tên kênh
+    HAL_REC_GPIO_READ,    ///< a = u8 value
+    HAL_REC_GPIO_WRITE,   ///< a = u8 value
+    HAL_REC_GPIO_EVENT,   ///< a = u8 edge, b = u64 timestamp_ns; status != 0 (timeout...) không có a/b
+    HAL_REC_UART_TX,      ///< a = bytes đã ghi
+    HAL_REC_UART_RX,      ///< a = bytes đã đọc (timeout không ghi)
+    HAL_REC_I2C_WR,       ///< a = u8 addr7, b = bytes
+    HAL_REC_I2C_RD,       ///< a = u8 addr7, b = bytes
+    HAL_REC_SPI_XFER,     ///< a = tx, b = rx
+    HAL_REC_TYPE_MAX
+} HAL_RecType;
+
+typedef enum {
+    HAL_REPLAY_AFAP = 0,  ///< nhanh nhất có thể
+    HAL_REPLAY_REALTIME,  ///< chỉ nhịp: read/event không trả về trước thời điểm đã ghi
+} HAL_ReplaySpeed;
+
+typedef struct {
+    HAL_RecType    type;
+    uint16_t       chan;
+    int32_t        status;
+    uint64_t       t_ns;      ///< tính từ đầu log
+    uint64_t       due_ns;    ///< CLOCK_MONOTONIC lúc bản ghi "tới hạn" khi replay
+    const uint8_t* a; size_t alen;
+    const uint8_t* b; size_t blen;
+} HAL_RecEntry;
+
+typedef struct {
+    uint64_t served;       ///< bản ghi đã trả cho app
+    uint64_t mismatches;   ///< write/tx khác bản ghi
+    uint64_t exhausted;    ///< app gọi nhưng kênh đã hết bản ghi
+} HAL_ReplayStats;
+
+/* ---- record ---- */
+int      HAL_Rec_Open (const char* path);      /* 0 nếu OK */
+void     HAL_Rec_Close(void);
+int      HAL_Rec_Active(void);
+uint16_t HAL_Rec_Channel(const char* name);    /* tạo (hoặc lấy) id kênh */
+void     HAL_Rec_Put(HAL_RecType type, uint16_t chan, int32_t status,
+                     const void* a, size_t alen, const void* b, size_t blen);
+
+/* ---- replay ---- */
+int      HAL_Replay_Open (const char* path, HAL_ReplaySpeed speed);
+void     HAL_Replay_Close(void);
+int      HAL_Replay_Active(void);
+HAL_ReplaySpeed HAL_Replay_Speed(void);
+int      HAL_Replay_Channel(const char* name);  /* -1 nếu log không có kênh này */
+/* Bản ghi kế tiếp (chan, type) mà không lấy ra. 0 OK, -1 hết */
+int      HAL_Replay_Peek(int chan, HAL_RecType type, HAL_RecEntry* out);
+/**
+ * @brief Lấy bản ghi kế tiếp (chan, type).
+ * REALTIME: chờ tới due_ns, nhưng không quá timeout_ms (<0 = chờ mãi, 0 = không chờ).
+ * @return 0 OK, 1 chưa tới hạn (timeout), -1 hết bản ghi
+ */
+int      HAL_Replay_Next(int chan, HAL_RecType type, int timeout_ms, HAL_RecEntry* out);
+/* Lấy ngay bản ghi kế tiếp (chan, type), không chờ due. 0 OK, -1 hết */
+int      HAL_Replay_Take(int chan, HAL_RecType type, HAL_RecEntry* out);
+/**
+ * @brief Write/TX/transfer: lấy ngay bản ghi kế tiếp (không chờ due), so payload a
+ *        (và b nếu b != NULL) với bản ghi; khác -> mismatches++.
+ * @param out bản ghi đã lấy (vd. phần RX của SPI), có thể NULL
+ * @return status đã ghi, hoặc -1 nếu kênh đã hết bản ghi
+ */
+int      HAL_Replay_Expect(int chan, HAL_RecType type, const void* a, size_t alen,
+                           const void* b, size_t blen, HAL_RecEntry* out);
+void     HAL_Replay_GetStats(HAL_ReplayStats* out);
+
+/* Thiết bị/chip nào phải đi qua replay: "replay:xxx" -> "xxx"; khi replay đang
+ * bật (HAL_REPLAY=<path> hoặc HAL_Replay_Open) thì mọi tên đều replay. Ngược lại NULL. */
+const char* HAL_Replay_Target(const char* name);
+
+#ifdef __cplusplus
+}
+#endif
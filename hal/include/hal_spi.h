@@ -147,6 +147,16 @@ HAL_SpiStatus HAL_Spi_SetSpeed(HAL_SpiBus* bus, uint32_t hz);
  * @brief Query current SPI config (mode, speed, bpw, etc) for logging.
  */
 HAL_SpiStatus HAL_Spi_GetInfo(HAL_SpiBus* bus, HAL_SpiInfo* out_info);
+
+/**
+ * @brief Largest message (sum of all segments) one transfer call accepts;
+ *        0 = no known limit.
+ *
+ * Linux spidev rejects longer messages (EMSGSIZE). The limit is the module
+ * parameter bufsiz (default 4096); raise it with spidev.bufsiz=N on the
+ * kernel command line for long streaming transfers (LED strips, displays).
+ */
+size_t HAL_Spi_MaxMessage(HAL_SpiBus* bus);
 HAL_SpiStatus HAL_Spi_Write(HAL_SpiBus* bus,const uint8_t* tx, size_t len);
 HAL_SpiStatus HAL_Spi_Read(HAL_SpiBus* bus, uint8_t* rx, size_t len);
 HAL_SpiStatus HAL_Spi_BurstTransfer(HAL_SpiBus* bus, const uint8_t* tx, uint8_t* rx, size_t len, int cs_hold);
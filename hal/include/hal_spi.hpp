@@ -0,0 +1,62 @@
+/**
+ * @file hal_spi.hpp
+ * @brief Header-only C++17 RAII owner for HAL_SpiBus (see hal_spi.h).
+ *
+ * Move-only; the bus is closed in the destructor. Methods forward 1:1 to the
+ * C API and are inlined.
+ */
+#pragma once
+#include "hal_spi.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace hal {
+
+class SpiBus {
+public:
+    SpiBus() noexcept = default;
+    explicit SpiBus(HAL_SpiBus* h) noexcept : h_(h) {}
+    ~SpiBus() { Reset(); }
+
+    SpiBus(const SpiBus&)            = delete;
+    SpiBus& operator=(const SpiBus&) = delete;
+    SpiBus(SpiBus&& o) noexcept : h_(o.Release()) {}
+    SpiBus& operator=(SpiBus&& o) noexcept {
+        if (this != &o) Reset(o.Release());
+        return *this;
+    }
+
+    static HAL_SpiStatus Open(const HAL_SpiConfig& cfg, SpiBus& out) noexcept {
+        HAL_SpiStatus st = HAL_SPI_EBUS;
+        HAL_SpiBus* h = HAL_Spi_Open(&cfg, &st);
+        if (h) out.Reset(h);
+        return h ? HAL_SPI_OK : st;
+    }
+
+    HAL_SpiStatus Transfer(const uint8_t* tx, uint8_t* rx, std::size_t n) const noexcept { return HAL_Spi_Transfer(h_, tx, rx, n); }
+    HAL_SpiStatus Write(const uint8_t* tx, std::size_t n) const noexcept { return HAL_Spi_Write(h_, tx, n); }
+    HAL_SpiStatus Read(uint8_t* rx, std::size_t n) const noexcept { return HAL_Spi_Read(h_, rx, n); }
+    HAL_SpiStatus TransferSegments(const uint8_t* tx0, std::size_t len0, const uint8_t* tx1, std::size_t len1,
+                                   uint8_t* rx, std::size_t rx_len) const noexcept {
+        return HAL_Spi_TransferSegments(h_, tx0, len0, tx1, len1, rx, rx_len);
+    }
+    HAL_SpiStatus SetSpeed(uint32_t hz) const noexcept { return HAL_Spi_SetSpeed(h_, hz); }
+    HAL_SpiStatus GetInfo(HAL_SpiInfo& info) const noexcept { return HAL_Spi_GetInfo(h_, &info); }
+    std::size_t MaxMessage() const noexcept { return HAL_Spi_MaxMessage(h_); }
+
+    HAL_SpiBus* Get() const noexcept { return h_; }
+    explicit operator bool() const noexcept { return h_ != nullptr; }
+
+    HAL_SpiBus* Release() noexcept { return std::exchange(h_, nullptr); }
+    void Reset(HAL_SpiBus* h = nullptr) noexcept {
+        if (h_) HAL_Spi_Close(h_);
+        h_ = h;
+    }
+
+private:
+    HAL_SpiBus* h_ = nullptr;
+};
+
+}  // namespace hal
@@ -0,0 +1,57 @@
+/**
+ * @file hal_uart.hpp
+ * @brief Header-only C++17 RAII owner for HAL_Uart (see hal_uart.h).
+ *
+ * Move-only; the port is closed in the destructor. Methods forward 1:1 to the
+ * C API and are inlined.
+ */
+#pragma once
+#include "hal_uart.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace hal {
+
+class Uart {
+public:
+    Uart() noexcept = default;
+    explicit Uart(HAL_Uart* h) noexcept : h_(h) {}
+    ~Uart() { Reset(); }
+
+    Uart(const Uart&)            = delete;
+    Uart& operator=(const Uart&) = delete;
+    Uart(Uart&& o) noexcept : h_(o.Release()) {}
+    Uart& operator=(Uart&& o) noexcept {
+        if (this != &o) Reset(o.Release());
+        return *this;
+    }
+
+    static HAL_UartStatus Open(const HAL_UartConfig& cfg, Uart& out) noexcept {
+        HAL_UartStatus st = HAL_UART_EIO;
+        HAL_Uart* h = HAL_Uart_Open(&cfg, &st);
+        if (h) out.Reset(h);
+        return h ? HAL_UART_OK : st;
+    }
+
+    long Write(const void* buf, std::size_t n) const noexcept { return HAL_Uart_Write(h_, buf, n); }
+    long WriteString(const char* s) const noexcept { return HAL_Uart_WriteString(h_, s); }
+    long Read(void* buf, std::size_t n, uint32_t timeout_ms) const noexcept { return HAL_Uart_Read(h_, buf, n, timeout_ms); }
+    HAL_UartStatus Flush(int which) const noexcept { return HAL_Uart_Flush(h_, which); }
+    int Fd() const noexcept { return HAL_Uart_GetFd(h_); }
+
+    HAL_Uart* Get() const noexcept { return h_; }
+    explicit operator bool() const noexcept { return h_ != nullptr; }
+
+    HAL_Uart* Release() noexcept { return std::exchange(h_, nullptr); }
+    void Reset(HAL_Uart* h = nullptr) noexcept {
+        if (h_) HAL_Uart_Close(h_);
+        h_ = h;
+    }
+
+private:
+    HAL_Uart* h_ = nullptr;
+};
+
+}  // namespace hal
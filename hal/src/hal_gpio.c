@@ -0,0 +1,319 @@
+/**
+ * @file hal_gpio.c
+ * @brief HAL GPIO front end: backend registry + dispatch.
+ *
+ * Chip/line handle ở đây chỉ là vỏ: { ops, priv }. Line giữ sẵn con trỏ
+ * write/read của backend để hot path không phải đi qua chip->ops.
+ * Build với HAL_METRICS=1: mỗi chip/line có thêm id hal_metrics, mọi op đi
+ * qua front end được đếm ở đây (backend không phải biết).
+ */
+#include "hal_gpio.h"
+#include "hal_gpio_backend.h"
+#include "hal_log.h"
+#include "hal_metrics.h"
+#include "hal_rec.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct HAL_GpioChip {
+    const HAL_GpioOps* ops;
+    void*              priv;
+#if HAL_METRICS
+    uint16_t           mx;
+    uint8_t            mx_sys;      ///< backend trong cùng (qua rec:) có vào kernel không
+    char               mx_name[32];
+#endif
+};
+
+struct HAL_GpioLine {
+    HAL_GpioStatus   (*write)(void* priv, int value);   /* resolve sẵn lúc request */
+    HAL_GpioStatus   (*read)(void* priv, int* out_value);
+    void*              priv;
+    const HAL_GpioOps* ops;
+#if HAL_METRICS
+    uint16_t           mx;
+    uint8_t            mx_sys;
+#endif
+};
+
+static const HAL_GpioOps* s_backends[HAL_GPIO_BACKEND_MAX];
+static unsigned           s_nbackends = 0;
+
+/* --- registry --- */
+
+int HAL_GpioBackend_Register(const HAL_GpioOps* ops) {
+    if (!ops || !ops->scheme || !ops->chip_open || !ops->line_request ||
+        !ops->line_write || !ops->line_read) return -1;
+    if (HAL_GpioBackend_Find(ops->scheme) || s_nbackends >= HAL_GPIO_BACKEND_MAX) return -1;
+    s_backends[s_nbackends++] = ops;
+    return 0;
+}
+
+const HAL_GpioOps* HAL_GpioBackend_Find(const char* scheme) {
+    if (!scheme) return NULL;
+    for (unsigned i = 0; i < s_nbackends; ++i)
+        if (strcmp(s_backends[i]->scheme, scheme) == 0) return s_backends[i];
+    return NULL;
+}
+
+static const HAL_GpioOps* _default_backend(void) {
+    const char* env = getenv("HAL_GPIO_BACKEND");
+    const HAL_GpioOps* best = env ? HAL_GpioBackend_Find(env) : NULL;
+    if (best) return best;
+    for (unsigned i = 0; i < s_nbackends; ++i)
+        if (!best || s_backends[i]->priority > best->priority) best = s_backends[i];
+    return best;
+}
+
+const HAL_GpioOps* HAL_GpioBackend_Resolve(const char* chip_name, const char** out_name) {
+    const char* colon = chip_name ? strchr(chip_name, ':') : NULL;
+    if (colon && (size_t)(colon - chip_name) < 16) {
+        char scheme[16];
+        memcpy(scheme, chip_name, (size_t)(colon - chip_name));
+        scheme[colon - chip_name] = '\0';
+        const HAL_GpioOps* ops = HAL_GpioBackend_Find(scheme);
+        if (ops) {
+            if (out_name) *out_name = colon + 1;
+            return ops;
+        }
+    }
+    if (out_name) *out_name = chip_name;
+    return _default_backend();
+}
+
+/* đi xuyên qua các lớp bọc (rec:) tới priv của backend ops */
+static void* _unwrap(const HAL_GpioOps* have, void* priv, const HAL_GpioOps* ops) {
+    while (have != ops && have->wrapper && priv) {
+        const HAL_GpioWrap* w = (const HAL_GpioWrap*)priv;
+        have = w->inner;
+        priv = w->priv;
+    }
+    return (have == ops) ? priv : NULL;
+}
+
+void* HAL_GpioChip_BackendPriv(HAL_GpioChip* chip, const HAL_GpioOps* ops) {
+    return chip ? _unwrap(chip->ops, chip->priv, ops) : NULL;
+}
+
+void* HAL_GpioLine_BackendPriv(HAL_GpioLine* line, const HAL_GpioOps* ops) {
+    return line ? _unwrap(line->ops, line->priv, ops) : NULL;
+}
+
+const char* HAL_GpioChip_Scheme(const HAL_GpioChip* chip) {
+    return chip ? chip->ops->scheme : NULL;
+}
+
+#if HAL_METRICS
+static uint8_t _kernel_io(const HAL_GpioOps* ops, void* priv) {
+    while (ops && ops->wrapper && priv) {
+        const HAL_GpioWrap* w = (const HAL_GpioWrap*)priv;
+        ops  = w->inner;
+        priv = w->priv;
+    }
+    return (ops && ops->kernel_io) ? 1 : 0;
+}
+#endif
+
+/* --- chip / line lifetime --- */
+
+HAL_GpioStatus HAL_GpioChip_Open(const HAL_GpioChipConfig* cfg, HAL_GpioChip** out_chip) {
+    if (!cfg || !out_chip) return HAL_GPIO_EINVAL;
+
+    const char* name = NULL;
+    const HAL_GpioOps* ops = HAL_GpioBackend_Resolve(cfg->chip_name, &name);
+    if (!ops) {
+        HAL_LOGE("[GPIO]", "no backend for '%s'", cfg->chip_name ? cfg->chip_name : "(null)");
+        return HAL_GPIO_ENOSUP;
+    }
+    /* record/replay toàn cục: bọc backend thật (chip_open của rec/replay tự resolve lại tên đầy đủ) */
+    if (strcmp(ops->scheme, "rec") != 0 && strcmp(ops->scheme, "replay") != 0) {
+        const HAL_GpioOps* wrap = HAL_Replay_Active() ? HAL_GpioBackend_Find("replay")
+                                : HAL_Rec_Active()    ? HAL_GpioBackend_Find("rec") : NULL;
+        if (wrap) { ops = wrap; name = cfg->chip_name; }
+    }
+
+    HAL_GpioChip* c = (HAL_GpioChip*)calloc(1, sizeof(*c));
+    if (!c) return HAL_GPIO_EIO;
+    HAL_GpioStatus st = ops->chip_open(name, &c->priv);
+    if (st != HAL_GPIO_OK) {
+        free(c);
+        return st;
+    }
+    c->ops = ops;
+#if HAL_METRICS
+    snprintf(c->mx_name, sizeof(c->mx_name), "%s", cfg->chip_name ? cfg->chip_name : "");
+    c->mx_sys = _kernel_io(ops, c->priv);
+#endif
+    HAL_MX_OPEN(c->mx, HAL_METRICS_GPIO_CHIP, "gpiochip:%s", c->mx_name);
+    *out_chip = c;
+    return HAL_GPIO_OK;
+}
+
+void HAL_GpioChip_Close(HAL_GpioChip* chip) {
+    if (!chip) return;
+    if (chip->ops->chip_close) chip->ops->chip_close(chip->priv);
+    free(chip);
+}
+
+HAL_GpioStatus HAL_GpioLine_Request(HAL_GpioChip* chip, const HAL_GpioLineConfig* cfg, HAL_GpioLine** out_line) {
+    if (!chip || !cfg || !out_line) return HAL_GPIO_EINVAL;
+
+    HAL_GpioLine* l = (HAL_GpioLine*)calloc(1, sizeof(*l));
+    if (!l) return HAL_GPIO_EIO;
+    HAL_MX_T0(t0);
+    HAL_GpioStatus st = chip->ops->line_request(chip->priv, cfg, &l->priv);
+    HAL_MX_REC(chip->mx, t0, st != HAL_GPIO_OK, 0, chip->mx_sys);
+    if (st != HAL_GPIO_OK) {
+        free(l);
+        return st;
+    }
+    l->ops   = chip->ops;
+    l->write = chip->ops->line_write;
+    l->read  = chip->ops->line_read;
+#if HAL_METRICS
+    l->mx_sys = chip->mx_sys;
+    if (cfg->offset >= 0) HAL_MX_OPEN(l->mx, HAL_METRICS_GPIO_LINE, "gpio:%s/%d", chip->mx_name, cfg->offset);
+    else                  HAL_MX_OPEN(l->mx, HAL_METRICS_GPIO_LINE, "gpio:%s/%s", chip->mx_name, cfg->name ? cfg->name : "?");
+#endif
+    *out_line = l;
+    return HAL_GPIO_OK;
+}
+
+void HAL_GpioLine_Release(HAL_GpioLine* line) {
+    if (!line) return;
+    if (line->ops->line_release) line->ops->line_release(line->priv);
+    free(line);
+}
+
+/* --- hot path --- */
+
+HAL_GpioStatus HAL_GpioLine_Write(HAL_GpioLine* line, int value) {
+    if (!line) return HAL_GPIO_EINVAL;
+    HAL_MX_T0(t0);
+    HAL_GpioStatus st = line->write(line->priv, value);
+    HAL_MX_REC(line->mx, t0, st != HAL_GPIO_OK, 0, line->mx_sys);
+    return st;
+}
+
+HAL_GpioStatus HAL_GpioLine_Read(HAL_GpioLine* line, int* out_value) {
+    if (!line || !out_value) return HAL_GPIO_EINVAL;
+    HAL_MX_T0(t0);
+    HAL_GpioStatus st = line->read(line->priv, out_value);
+    HAL_MX_REC(line->mx, t0, st != HAL_GPIO_OK, 0, line->mx_sys);
+    return st;
+}
+
+HAL_GpioStatus HAL_GpioLine_Toggle(HAL_GpioLine* line) {
+    if (!line) return HAL_GPIO_EINVAL;
+    HAL_MX_T0(t0);
+    int v = 0;
+    HAL_GpioStatus st = line->read(line->priv, &v);
+    if (st == HAL_GPIO_OK) st = line->write(line->priv, !v);
+    HAL_MX_REC(line->mx, t0, st != HAL_GPIO_OK, 0, 2u * line->mx_sys);
+    return st;
+}
+
+/* --- events --- */
+
+HAL_GpioStatus HAL_GpioLine_WaitEvent(HAL_GpioLine* line, int timeout_ms, HAL_GpioEvent* out_ev) {
+    if (!line) return HAL_GPIO_EINVAL;
+    if (!line->ops->line_wait_event) return HAL_GPIO_ENOSUP;
+    HAL_GpioStatus st = line->ops->line_wait_event(line->priv, timeout_ms, out_ev);
+    /* thời gian chờ là của thế giới bên ngoài: chỉ đếm, không tính latency (poll + read event) */
+    HAL_MX_COUNT(line->mx, st != HAL_GPIO_OK && st != HAL_GPIO_ENOENT, 0,
+                 (st == HAL_GPIO_OK ? 2u : 1u) * line->mx_sys);
+    return st;
+}
+
+HAL_GpioStatus HAL_GpioLine_ReadEvents(HAL_GpioLine* line, int timeout_ms,
+                                       HAL_GpioEvent* out_evs, size_t max, size_t* out_n) {
+    if (!line || !out_evs || !out_n || !max) return HAL_GPIO_EINVAL;
+    *out_n = 0;
+    if (line->ops->line_read_events) {
+        HAL_GpioStatus st = line->ops->line_read_events(line->priv, timeout_ms, out_evs, max, out_n);
+        HAL_MX_COUNT(line->mx, st != HAL_GPIO_OK && st != HAL_GPIO_ENOENT, 0,
+                     (st == HAL_GPIO_OK ? 2u : 1u) * line->mx_sys);
+        return st;
+    }
+    /* backend không có đường lô (rec/replay...): lặp WaitEvent, chỉ chờ ở event đầu */
+    HAL_GpioStatus st = HAL_GpioLine_WaitEvent(line, timeout_ms, &out_evs[0]);
+    if (st != HAL_GPIO_OK) return st;
+    size_t n = 1;
+    while (n < max && HAL_GpioLine_WaitEvent(line, 0, &out_evs[n]) == HAL_GPIO_OK) ++n;
+    *out_n = n;
+    return HAL_GPIO_OK;
+}
+
+int HAL_GpioLine_GetEventFd(HAL_GpioLine* line) {
+    if (!line || !line->ops->line_event_fd) return -1;
+    return line->ops->line_event_fd(line->priv);
+}
+
+/* --- group (lines có thể thuộc backend khác nhau) --- */
+
+/* Mọi line cùng backend có op group -> priv của chúng vào privs[], trả ops; ngược lại NULL */
+static const HAL_GpioOps* _group_ops(const HAL_GpioGroup* grp, void** privs) {
+    if (!grp->count || grp->count > 32) return NULL;
+    const HAL_GpioOps* ops = grp->lines[0]->ops;
+    for (size_t i = 0; i < grp->count; ++i) {
+        if (grp->lines[i]->ops != ops) return NULL;
+        privs[i] = grp->lines[i]->priv;
+    }
+    return ops;
+}
+
+HAL_GpioStatus HAL_GpioGroup_WriteMask(HAL_GpioGroup* grp, uint32_t mask, uint32_t value) {
+    if (!grp || !grp->lines) return HAL_GPIO_EINVAL;
+    void* privs[32];
+    const HAL_GpioOps* ops = _group_ops(grp, privs);
+    if (ops && ops->group_write) {
+        /* một op cho cả group: metrics tính vào line đầu */
+        HAL_MX_T0(t0);
+        HAL_GpioStatus st = ops->group_write(privs, grp->count, mask, value);
+        if (st != HAL_GPIO_ENOSUP) {
+            HAL_MX_REC(grp->lines[0]->mx, t0, st != HAL_GPIO_OK, 0, grp->lines[0]->mx_sys);
+            return st;
+        }
+    }
+    /* từng line: vẫn ghi các line còn lại, trả lỗi đầu tiên */
+    HAL_GpioStatus rc = HAL_GPIO_OK;
+    for (size_t i = 0; i < grp->count; ++i) {
+        if (mask & (1u << i)) {
+            HAL_GpioLine* l = grp->lines[i];
+            HAL_MX_T0(t0);
+            HAL_GpioStatus st = l->write(l->priv, (value >> i) & 1u);
+            HAL_MX_REC(l->mx, t0, st != HAL_GPIO_OK, 0, l->mx_sys);
+            if (rc == HAL_GPIO_OK) rc = st;
+        }
+    }
+    return rc;
+}
+
+HAL_GpioStatus HAL_GpioGroup_ReadBitmap(HAL_GpioGroup* grp, uint32_t* out_bitmap) {
+    if (!grp || !grp->lines || !out_bitmap) return HAL_GPIO_EINVAL;
+    void* privs[32];
+    const HAL_GpioOps* ops = _group_ops(grp, privs);
+    if (ops && ops->group_read) {
+        HAL_MX_T0(t0);
+        HAL_GpioStatus st = ops->group_read(privs, grp->count, out_bitmap);
+        if (st != HAL_GPIO_ENOSUP) {
+            HAL_MX_REC(grp->lines[0]->mx, t0, st != HAL_GPIO_OK, 0, grp->lines[0]->mx_sys);
+            return st;
+        }
+    }
+    uint32_t bm = 0;
+    HAL_GpioStatus rc = HAL_GPIO_OK;
+    for (size_t i = 0; i < grp->count; ++i) {
+        HAL_GpioLine* l = grp->lines[i];
+        int v = 0;
+        HAL_MX_T0(t0);
+        HAL_GpioStatus st = l->read(l->priv, &v);
+        HAL_MX_REC(l->mx, t0, st != HAL_GPIO_OK, 0, l->mx_sys);
+        if (st == HAL_GPIO_OK && v) bm |= (1u << i);
+        if (rc == HAL_GPIO_OK) rc = st;
+    }
+    *out_bitmap = bm;
+    return rc;
+}
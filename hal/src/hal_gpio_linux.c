@@ -1,49 +1,51 @@
 /**
  * @file hal_gpio_linux.c
- * @brief Linux backend for HAL GPIO using libgpiod v1.x
+ * @brief Linux backend for HAL GPIO using libgpiod v1.x (scheme "gpiod:")
  *
  * Build: link with -lgpiod
  */
 
 #include "hal_gpio.h"
+#include "hal_gpio_backend.h"
+#include "hal_log.h"
 #include <stdio.h>
 #include <gpiod.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
-struct HAL_GpioChip {
+typedef struct {
     struct gpiod_chip* chip;
     char name[64];
-};
+} GpiodChip;
 
 typedef struct {
     uint32_t debounce_ms;
     uint64_t last_evt_ns;
 } _HalDebounce;
 
-struct HAL_GpioLine {
-    HAL_GpioChip*        hchip;
+typedef struct {
+    GpiodChip*           hchip;
     struct gpiod_line*   line;
     HAL_GpioLineConfig   cfg;
     int                  have_event;    /* 1 if requested with events */
     _HalDebounce         db;
-};
+} GpiodLine;
 
 /* --- helpers --- */
 
-uint64_t _timespec_to_ns(const struct timespec* ts) {
+static uint64_t _timespec_to_ns(const struct timespec* ts) {
     if (!ts) return 0;
     return ((uint64_t)ts->tv_sec * 1000000000ull) + (uint64_t)ts->tv_nsec;
 }
 
 /* Map logical value to physical considering active low/high */
-int _logical_to_physical(const HAL_GpioLineConfig* c, int logical) {
+static int _logical_to_physical(const HAL_GpioLineConfig* c, int logical) {
     return (c->active == HAL_GPIO_ACTIVE_LOW) ? (!logical) : (logical != 0);
 }
 
 /* Map physical read to logical */
-int _physical_to_logical(const HAL_GpioLineConfig* c, int physical) {
+static int _physical_to_logical(const HAL_GpioLineConfig* c, int physical) {
     int v = physical ? 1 : 0;
     return (c->active == HAL_GPIO_ACTIVE_LOW) ? !v : v;
 }
@@ -67,58 +69,50 @@ static int _resolve_offset_by_name(struct gpiod_chip* chip, const char* name) {
 
 /* --- API impl --- */
 
-HAL_GpioStatus HAL_GpioChip_Open(const HAL_GpioChipConfig* cfg, HAL_GpioChip** out_chip) {
-    if (!cfg || !cfg->chip_name || !cfg->chip_name[0] || !out_chip) {
-        printf("[GPIO][LINUX] invalid chip config (name missing)\r\n");
+static HAL_GpioStatus gpiod_chip_open_op(const char* chip_name, void** out_chip) {
+    if (!chip_name || !chip_name[0]) {
+        HAL_LOGE("[GPIO][LINUX]", "invalid chip config (name missing)");
         return HAL_GPIO_EINVAL;
     }
-    HAL_GpioChip* hc = (HAL_GpioChip*)calloc(1, sizeof(*hc));
+    GpiodChip* hc = (GpiodChip*)calloc(1, sizeof(*hc));
     if (!hc) return HAL_GPIO_EIO;
 
-    hc->chip = gpiod_chip_open_by_name(cfg->chip_name);
+    hc->chip = gpiod_chip_open_by_name(chip_name);
     if (!hc->chip) {
-        printf("[GPIO][LINUX] gpiod_chip_open_by_name('%s') failed\r\n", cfg->chip_name);
+        HAL_LOGE("[GPIO][LINUX]", "gpiod_chip_open_by_name('%s') failed", chip_name);
         free(hc);
         return HAL_GPIO_EIO;
     }
-    strncpy(hc->name, cfg->chip_name, sizeof(hc->name)-1);
-    printf("[GPIO][LINUX] chip opened: %s\r\n", hc->name);
+    strncpy(hc->name, chip_name, sizeof(hc->name)-1);
+    HAL_LOGI("[GPIO][LINUX]", "chip opened: %s", hc->name);
     *out_chip = hc;
     return HAL_GPIO_OK;
 }
 
-void HAL_GpioChip_Close(HAL_GpioChip* chip) {
-    if (!chip) return;
+static void gpiod_chip_close_op(void* c) {
+    GpiodChip* chip = (GpiodChip*)c;
     if (chip->chip) gpiod_chip_close(chip->chip);
     free(chip);
 }
 
-HAL_GpioStatus HAL_GpioLine_Request(HAL_GpioChip* chip, const HAL_GpioLineConfig* cfg, HAL_GpioLine** out_line) {
-    if (!chip || !chip->chip || !cfg || !out_line) return HAL_GPIO_EINVAL;
+static HAL_GpioStatus gpiod_line_request_op(void* c, const HAL_GpioLineConfig* cfg, void** out_line) {
+    GpiodChip* chip = (GpiodChip*)c;
+    if (!chip->chip) return HAL_GPIO_EINVAL;
 
     int offset = cfg->offset;
-    // printf("offset : %d/r/n",offset);
     if (offset < 0 && cfg->name) {
         offset = _resolve_offset_by_name(chip->chip, cfg->name);
         if (offset < 0) {
-            printf("[GPIO][LINUX] line '%s' not found on %s\r\n", cfg->name, chip->name);
+            HAL_LOGE("[GPIO][LINUX]", "line '%s' not found on %s", cfg->name, chip->name);
             return HAL_GPIO_ENOENT;
         }
     }
     if (offset < 0) return HAL_GPIO_EINVAL;
 
-    if (!chip->chip) {
-        printf("open chip failed\n");
-    }
-    else{
-        printf("open chip passed\n");
-    }
-    printf("offset : %d\r\n",offset);
-
     struct gpiod_line* ln = gpiod_chip_get_line(chip->chip, offset);
-    printf("ln : %d\r\n",ln);
+    HAL_LOGD("[GPIO][LINUX]", "request %s:%d -> %p", chip->name, offset, (void*)ln);
     if (!ln) {
-        printf("ln : %d\r\n",ln);
+        HAL_LOGE("[GPIO][LINUX]", "line %d not available on %s", offset, chip->name);
         return HAL_GPIO_EIO;
     }
 
@@ -143,7 +137,7 @@ HAL_GpioStatus HAL_GpioLine_Request(HAL_GpioChip* chip, const HAL_GpioLineConfig
         return HAL_GPIO_EIO;
     }
 
-    HAL_GpioLine* h = (HAL_GpioLine*)calloc(1, sizeof(*h));
+    GpiodLine* h = (GpiodLine*)calloc(1, sizeof(*h));
     if (!h) { gpiod_line_release(ln); return HAL_GPIO_EIO; }
     h->hchip      = chip;
     h->line       = ln;
@@ -156,40 +150,31 @@ HAL_GpioStatus HAL_GpioLine_Request(HAL_GpioChip* chip, const HAL_GpioLineConfig
     return HAL_GPIO_OK;
 }
 
-void HAL_GpioLine_Release(HAL_GpioLine* line) {
-    if (!line) return;
+static void gpiod_line_release_op(void* l) {
+    GpiodLine* line = (GpiodLine*)l;
     if (line->line) gpiod_line_release(line->line);
     free(line);
 }
 
-HAL_GpioStatus HAL_GpioLine_Write(HAL_GpioLine* line, int value) {
-    if (!line || !line->line) return HAL_GPIO_EINVAL;
+static HAL_GpioStatus gpiod_line_write_op(void* l, int value) {
+    GpiodLine* line = (GpiodLine*)l;
     if (line->cfg.dir != HAL_GPIO_DIR_OUT) return HAL_GPIO_EINVAL;
     int phys = _logical_to_physical(&line->cfg, value);
     return (gpiod_line_set_value(line->line, phys) < 0) ? HAL_GPIO_EIO : HAL_GPIO_OK;
 }
 
-HAL_GpioStatus HAL_GpioLine_Toggle(HAL_GpioLine* line) {
-    if (!line || !line->line) return HAL_GPIO_EINVAL;
-    int phys = gpiod_line_get_value(line->line);
-    if (phys < 0) return HAL_GPIO_EIO;
-    int logi = _physical_to_logical(&line->cfg, phys);
-    return HAL_GpioLine_Write(line, !logi);
-}
-
-HAL_GpioStatus HAL_GpioLine_Read(HAL_GpioLine* line, int* out) {
-    if (!line || !line->line || !out) return HAL_GPIO_EINVAL;
+static HAL_GpioStatus gpiod_line_read_op(void* l, int* out) {
+    GpiodLine* line = (GpiodLine*)l;
     int phys = gpiod_line_get_value(line->line);
     if (phys < 0) return HAL_GPIO_EIO;
     *out = _physical_to_logical(&line->cfg, phys);
     return HAL_GPIO_OK;
 }
 
-HAL_GpioStatus HAL_GpioLine_WaitEvent(HAL_GpioLine* line, int timeout_ms, HAL_GpioEvent* out_ev) {
-    if (!line || !line->line) return HAL_GPIO_EINVAL;
+static HAL_GpioStatus gpiod_line_wait_event_op(void* l, int timeout_ms, HAL_GpioEvent* out_ev) {
+    GpiodLine* line = (GpiodLine*)l;
     if (!line->have_event)    return HAL_GPIO_ENOSUP;
 
-    struct timespec ts = {0,0};
     int rc = gpiod_line_event_wait(line->line,
                                    (timeout_ms < 0) ? NULL :
                                    (&(struct timespec){ .tv_sec = timeout_ms/1000, .tv_nsec = (timeout_ms%1000)*1000000 }));
@@ -220,25 +205,59 @@ HAL_GpioStatus HAL_GpioLine_WaitEvent(HAL_GpioLine* line, int timeout_ms, HAL_Gp
     return HAL_GPIO_OK;
 }
 
-/* --- Group helpers (simple loops; no libgpiod bulk dependency) --- */
-HAL_GpioStatus HAL_GpioGroup_WriteMask(HAL_GpioGroup* grp, uint32_t mask, uint32_t value) {
-    if (!grp || !grp->lines) return HAL_GPIO_EINVAL;
-    for (size_t i = 0; i < grp->count; ++i) {
-        if (mask & (1u << i)) {
-            int bit = (value >> i) & 1u;
-            HAL_GpioLine_Write(grp->lines[i], bit);
+/* Cả lô: gpiod_line_event_read_multiple() = một read() cho tối đa GPIOD_EV_BATCH event */
+#define GPIOD_EV_BATCH 16   /* libgpiod v1 đọc tối đa 16 event / lần */
+static HAL_GpioStatus gpiod_line_read_events_op(void* l, int timeout_ms, HAL_GpioEvent* out,
+                                                size_t max, size_t* out_n) {
+    GpiodLine* line = (GpiodLine*)l;
+    if (!line->have_event)    return HAL_GPIO_ENOSUP;
+
+    int rc = gpiod_line_event_wait(line->line,
+                                   (timeout_ms < 0) ? NULL :
+                                   (&(struct timespec){ .tv_sec = timeout_ms/1000, .tv_nsec = (timeout_ms%1000)*1000000 }));
+    if (rc < 0) return HAL_GPIO_EIO;
+    if (rc == 0) return HAL_GPIO_ENOENT;
+
+    struct gpiod_line_event evs[GPIOD_EV_BATCH];
+    if (max > GPIOD_EV_BATCH) max = GPIOD_EV_BATCH;
+    int got = gpiod_line_event_read_multiple(line->line, evs, (unsigned)max);
+    if (got < 0) return HAL_GPIO_EIO;
+
+    size_t n = 0;
+    for (int i = 0; i < got; ++i) {
+        uint64_t t_ns = _timespec_to_ns(&evs[i].ts);
+        if (line->db.debounce_ms > 0 && line->db.last_evt_ns != 0) {
+            uint64_t dt = (t_ns > line->db.last_evt_ns) ? (t_ns - line->db.last_evt_ns) : 0;
+            if (dt < (uint64_t)line->db.debounce_ms * 1000000ull) continue;
         }
+        line->db.last_evt_ns = t_ns;
+        out[n].timestamp_ns = t_ns;
+        out[n].edge = (evs[i].event_type == GPIOD_LINE_EVENT_RISING_EDGE) ? HAL_GPIO_EDGE_RISING
+                                                                          : HAL_GPIO_EDGE_FALLING;
+        ++n;
     }
-    return HAL_GPIO_OK;
+    *out_n = n;
+    return n ? HAL_GPIO_OK : HAL_GPIO_ENOENT;
 }
 
-HAL_GpioStatus HAL_GpioGroup_ReadBitmap(HAL_GpioGroup* grp, uint32_t* out_bitmap) {
-    if (!grp || !grp->lines || !out_bitmap) return HAL_GPIO_EINVAL;
-    uint32_t bm = 0;
-    for (size_t i = 0; i < grp->count; ++i) {
-        int v=0;
-        if (HAL_GpioLine_Read(grp->lines[i], &v) == HAL_GPIO_OK && v) bm |= (1u << i);
-    }
-    *out_bitmap = bm;
-    return HAL_GPIO_OK;
+static int gpiod_line_event_fd_op(void* l) {
+    GpiodLine* line = (GpiodLine*)l;
+    if (!line->have_event) return -1;
+    return gpiod_line_event_get_fd(line->line);
 }
+
+static const HAL_GpioOps s_gpiod_ops = {
+    .scheme          = "gpiod",
+    .priority        = 20,
+    .chip_open       = gpiod_chip_open_op,
+    .chip_close      = gpiod_chip_close_op,
+    .line_request    = gpiod_line_request_op,
+    .line_release    = gpiod_line_release_op,
+    .line_write      = gpiod_line_write_op,
+    .line_read       = gpiod_line_read_op,
+    .line_wait_event = gpiod_line_wait_event_op,
+    .line_event_fd   = gpiod_line_event_fd_op,
+    .line_read_events = gpiod_line_read_events_op,
+    .kernel_io       = 1,
+};
+HAL_GPIO_BACKEND_REGISTER(s_gpiod_ops)
@@ -0,0 +1,625 @@
+/**
+ * @file hal_gpio_mcp23x.c
+ * @brief GPIO backend "mcp23x:": MCP23008 / MCP23017 trên HAL I2C, thanh ghi
+ *        cache, group một lần ghi / đọc, INT qua event cạnh của line GPIO host.
+ *
+ * Notes:
+ *  - Map thanh ghi viết theo MCP23008; MCP23017 dùng BANK=0 nên thanh ghi r
+ *    nửa A ở 2r, nửa B ở 2r + 1, và burst đọc liên tiếp (SEQOP=0) ra A, B
+ *    của r rồi A, B của r + 1... Cùng một code cho cả hai chip.
+ *  - Mọi truy cập bus + cache nằm dưới c->mu. Thread chờ INT host (servicing)
+ *    không giữ mu; thread khác chờ event trên cv.
+ *  - c->in luôn là GPIO của lần đọc bus cuối; mọi lần đọc GPIO khi có INT đều
+ *    đi qua _service() để không "nuốt" mất INT của thread đang chờ event.
+ */
+#include "hal_gpio.h"
+#include "hal_gpio_backend.h"
+#include "hal_gpio_mcp23x.h"
+#include "hal_i2c.h"
+#include "hal_log.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MCP_MAX_PINS 16
+#define MCP_EVQ      64          /* event chờ đọc / line có edge */
+#define MCP_I2C_HZ   400000
+
+enum {
+    MCP_IODIR = 0, MCP_IPOL, MCP_GPINTEN, MCP_DEFVAL, MCP_INTCON, MCP_IOCON,
+    MCP_GPPU, MCP_INTF, MCP_INTCAP, MCP_GPIO, MCP_OLAT, MCP_NREGS
+};
+#define MCP_IOCON_MIRROR 0x40    /* INTA = INTB = OR của cả hai port */
+#define MCP_IOCON_ODR    0x04    /* INT open-drain */
+
+typedef struct McpChip McpChip;
+
+typedef struct {
+    McpChip*       chip;
+    int            used;
+    uint8_t        pin;
+    HAL_GpioDir    dir;
+    HAL_GpioActive active;
+    uint8_t        od;            /* open-drain giả lập bằng IODIR */
+    HAL_GpioEdge   edge;
+    uint32_t       debounce_ms;
+    uint64_t       last_evt_ns;
+    HAL_GpioEvent* evq;
+    unsigned       ehead, ecount;
+} McpLine;
+
+struct McpChip {
+    HAL_I2cBus*     bus;
+    uint8_t         addr;
+    uint8_t         npins;
+    uint16_t        iodir, gppu, gpinten, olat;   /* cache thanh ghi */
+    uint16_t        in;                           /* GPIO lần đọc cuối */
+    HAL_GpioChip*   int_chip;
+    HAL_GpioLine*   int_line;                     /* logic 1 = INT assert */
+    pthread_mutex_t mu;
+    pthread_cond_t  cv;                           /* có event mới / hết servicing */
+    int             servicing;                    /* một thread đang chờ INT host */
+    HAL_GpioMcp23xStats st;
+    McpLine         lines[MCP_MAX_PINS];
+};
+
+static uint64_t _mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* --- thanh ghi --- */
+
+/* Ghi thanh ghi reg; chỉ nửa có bit trong changed (không đổi gì thì không ra bus) */
+static HAL_GpioStatus _reg_write(McpChip* c, int reg, uint16_t val, uint16_t changed)
+{
+    if (!changed) return HAL_GPIO_OK;
+    const uint8_t b[2] = { (uint8_t)val, (uint8_t)(val >> 8) };
+    HAL_I2cStatus st;
+    if (c->npins == 8)          st = HAL_I2c_WriteReg8(c->bus, c->addr, (uint8_t)reg, b, 1);
+    else if (!(changed >> 8))   st = HAL_I2c_WriteReg8(c->bus, c->addr, (uint8_t)(2 * reg), b, 1);
+    else if (!(changed & 0xFF)) st = HAL_I2c_WriteReg8(c->bus, c->addr, (uint8_t)(2 * reg + 1), b + 1, 1);
+    else                        st = HAL_I2c_WriteReg8(c->bus, c->addr, (uint8_t)(2 * reg), b, 2);
+    c->st.reg_writes++;
+    return (st == HAL_I2C_OK) ? HAL_GPIO_OK : HAL_GPIO_EIO;
+}
+
+/* Burst đọc n thanh ghi liên tiếp từ reg (cả A và B nếu 16 pin) */
+static HAL_GpioStatus _reg_read(McpChip* c, int reg, int n, uint16_t* out)
+{
+    uint8_t b[2 * MCP_NREGS];
+    int w = (c->npins == 8) ? 1 : 2;
+    HAL_I2cStatus st = HAL_I2c_ReadReg8(c->bus, c->addr, (uint8_t)(w * reg), b, (size_t)(w * n));
+    c->st.reg_reads++;
+    if (st != HAL_I2C_OK) return HAL_GPIO_EIO;
+    for (int i = 0; i < n; ++i) out[i] = (w == 1) ? b[i] : (uint16_t)(b[2 * i] | b[2 * i + 1] << 8);
+    return HAL_GPIO_OK;
+}
+
+/* Đưa OLAT / IODIR về giá trị mới, chỉ phần đổi. OLAT trước để pin chuyển
+ * sang output ra luôn đúng mức. */
+static HAL_GpioStatus _apply(McpChip* c, uint16_t iodir, uint16_t olat)
+{
+    uint16_t d_olat = olat ^ c->olat, d_dir = iodir ^ c->iodir;
+    if (!d_olat && !d_dir) {
+        c->st.writes_cached++;
+        return HAL_GPIO_OK;
+    }
+    HAL_GpioStatus st = _reg_write(c, MCP_OLAT, olat, d_olat);
+    if (st != HAL_GPIO_OK) return st;
+    c->olat = olat;
+    st = _reg_write(c, MCP_IODIR, iodir, d_dir);
+    if (st == HAL_GPIO_OK) c->iodir = iodir;
+    return st;
+}
+
+static void _stage(const McpLine* ln, int val, uint16_t* iodir, uint16_t* olat)
+{
+    uint16_t bit = (uint16_t)(1u << ln->pin);
+    int phys = (val ? 1 : 0) ^ (ln->active == HAL_GPIO_ACTIVE_LOW);
+    if (ln->od) {
+        *olat &= (uint16_t)~bit;                          /* kéo thấp khi là output */
+        if (phys) *iodir |= bit; else *iodir &= (uint16_t)~bit;
+    } else {
+        if (phys) *olat |= bit; else *olat &= (uint16_t)~bit;
+    }
+}
+
+/* giá trị logic của line theo cache */
+static int _value(const McpChip* c, const McpLine* ln)
+{
+    uint16_t bit = (uint16_t)(1u << ln->pin);
+    int phys = (ln->dir == HAL_GPIO_DIR_OUT && !ln->od) ? !!(c->olat & bit) : !!(c->in & bit);
+    return phys ^ (ln->active == HAL_GPIO_ACTIVE_LOW);
+}
+
+/* --- INT / event --- */
+
+static void _push(McpChip* c, McpLine* ln, int phys, uint64_t t_ns)
+{
+    int logic = phys ^ (ln->active == HAL_GPIO_ACTIVE_LOW);
+    HAL_GpioEdge e = logic ? HAL_GPIO_EDGE_RISING : HAL_GPIO_EDGE_FALLING;
+    if (ln->edge != HAL_GPIO_EDGE_BOTH && ln->edge != e) return;
+    if (ln->ecount == MCP_EVQ) {
+        c->st.events_dropped++;
+        return;
+    }
+    HAL_GpioEvent* ev = &ln->evq[(ln->ehead + ln->ecount++) % MCP_EVQ];
+    ev->timestamp_ns = t_ns;
+    ev->edge         = e;
+    c->st.events++;
+}
+
+static int _pop(McpLine* ln, HAL_GpioEvent* out)
+{
+    while (ln->ecount) {
+        HAL_GpioEvent ev = ln->evq[ln->ehead];
+        ln->ehead = (ln->ehead + 1u) % MCP_EVQ;
+        ln->ecount--;
+        if (ln->debounce_ms > 0 && ln->last_evt_ns != 0) {
+            uint64_t dt = (ev.timestamp_ns > ln->last_evt_ns) ? (ev.timestamp_ns - ln->last_evt_ns) : 0;
+            if (dt < (uint64_t)ln->debounce_ms * 1000000ull) continue;
+        }
+        ln->last_evt_ns = ev.timestamp_ns;
+        if (out) *out = ev;
+        return 1;
+    }
+    return 0;
+}
+
+/* Một burst INTF + INTCAP + GPIO (đọc INTCAP / GPIO cũng xoá INT), rồi phát
+ * event: mỗi pin đi cũ -> INTCAP (nếu có trong INTF) -> GPIO hiện tại. */
+static HAL_GpioStatus _service(McpChip* c, uint64_t t_ns)
+{
+    uint16_t r[3];
+    if (_reg_read(c, MCP_INTF, 3, r) != HAL_GPIO_OK) return HAL_GPIO_EIO;
+    c->st.int_services++;
+    uint16_t old = c->in, now = r[2];
+    uint16_t cand = (uint16_t)((r[0] | (old ^ now)) & c->gpinten);
+    c->in = now;
+    if (!cand) return HAL_GPIO_OK;
+
+    if (!t_ns) t_ns = _mono_ns();
+    int any = 0;
+    for (int p = 0; p < c->npins; ++p) {
+        McpLine* ln = &c->lines[p];
+        if (!(cand & (1u << p)) || !ln->used || !ln->evq) continue;
+        int a = (old >> p) & 1, d = (now >> p) & 1;
+        int b = ((r[0] >> p) & 1) ? ((r[1] >> p) & 1) : d;
+        unsigned before = ln->ecount;
+        if (a != b) _push(c, ln, b, t_ns);
+        if (b != d) _push(c, ln, d, t_ns);
+        any |= (ln->ecount != before);
+    }
+    if (any) pthread_cond_broadcast(&c->cv);
+    return HAL_GPIO_OK;
+}
+
+static int _int_asserted(McpChip* c)
+{
+    int a = 1;   /* không đọc được INT host: coi như assert (đọc bus cho chắc) */
+    (void)HAL_GpioLine_Read(c->int_line, &a);
+    return a;
+}
+
+/* Cập nhật c->in cho các pin trong need. Có INT và mọi pin cần đều bật
+ * interrupt-on-change: INT không assert = cache còn đúng, không ra bus. */
+static HAL_GpioStatus _inputs(McpChip* c, uint16_t need)
+{
+    if (!need) return HAL_GPIO_OK;
+    if (c->int_line) {
+        if (!(need & ~c->gpinten) && !_int_asserted(c)) {
+            c->st.reads_cached++;
+            return HAL_GPIO_OK;
+        }
+        return _service(c, 0);
+    }
+    uint16_t v;
+    if (_reg_read(c, MCP_GPIO, 1, &v) != HAL_GPIO_OK) return HAL_GPIO_EIO;
+    c->in = v;
+    return HAL_GPIO_OK;
+}
+
+/* --- chip --- */
+
+/* "<bus>@<addr7>[,8|,16][,int=<chip>/<offset>]" */
+static int _parse(const char* name, char* bus, size_t bus_sz, unsigned* addr, unsigned* npins,
+                  char* int_chip, size_t int_sz, int* int_off)
+{
+    const char* at = name ? strchr(name, '@') : NULL;
+    if (!at || at == name || (size_t)(at - name) >= bus_sz) return -1;
+    memcpy(bus, name, (size_t)(at - name));
+    bus[at - name] = '\0';
+
+    char opt[128];
+    snprintf(opt, sizeof(opt), "%s", at + 1);
+    char* save = NULL;
+    char* tok = strtok_r(opt, ",", &save);
+    char* end = NULL;
+    if (!tok) return -1;
+    *addr = (unsigned)strtoul(tok, &end, 0);
+    if (*end || *addr < 0x03 || *addr > 0x77) return -1;
+    while ((tok = strtok_r(NULL, ",", &save)) != NULL) {
+        if (strcmp(tok, "8") == 0 || strcmp(tok, "16") == 0) {
+            *npins = (unsigned)atoi(tok);
+        } else if (strncmp(tok, "int=", 4) == 0) {
+            const char* slash = strrchr(tok + 4, '/');
+            if (!slash || slash == tok + 4 || (size_t)(slash - tok - 4) >= int_sz) return -1;
+            memcpy(int_chip, tok + 4, (size_t)(slash - tok - 4));
+            int_chip[slash - tok - 4] = '\0';
+            *int_off = (int)strtol(slash + 1, &end, 0);
+            if (*end || *int_off < 0) return -1;
+        } else {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void mcp_chip_close(void* chip)
+{
+    McpChip* c = (McpChip*)chip;
+    if (!c) return;
+    if (c->int_line) HAL_GpioLine_Release(c->int_line);
+    if (c->int_chip) HAL_GpioChip_Close(c->int_chip);
+    if (c->bus) HAL_I2cBus_Close(c->bus);
+    for (int i = 0; i < MCP_MAX_PINS; ++i) free(c->lines[i].evq);
+    pthread_cond_destroy(&c->cv);
+    pthread_mutex_destroy(&c->mu);
+    free(c);
+}
+
+static HAL_GpioStatus mcp_chip_open(const char* name, void** out_chip)
+{
+    char bus_name[64], int_name[64];
+    unsigned addr = 0, npins = 16;
+    int int_off = -1;
+    if (_parse(name, bus_name, sizeof(bus_name), &addr, &npins, int_name, sizeof(int_name), &int_off) != 0) {
+        HAL_LOGE("[GPIO][MCP23X]", "bad chip name '%s' (want <bus>@<addr>[,8|,16][,int=<chip>/<off>])",
+                 name ? name : "(null)");
+        return HAL_GPIO_EINVAL;
+    }
+
+    McpChip* c = (McpChip*)calloc(1, sizeof(*c));
+    if (!c) return HAL_GPIO_EIO;
+    c->addr  = (uint8_t)addr;
+    c->npins = (uint8_t)npins;
+    pthread_mutex_init(&c->mu, NULL);
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    pthread_cond_init(&c->cv, &ca);
+    pthread_condattr_destroy(&ca);
+    for (int i = 0; i < MCP_MAX_PINS; ++i) {
+        c->lines[i].chip = c;
+        c->lines[i].pin  = (uint8_t)i;
+    }
+
+    HAL_I2cBusConfig bc = { .bus_name = bus_name, .bus_speed_hz = MCP_I2C_HZ };
+    HAL_I2cStatus ist = HAL_I2C_EBUS;
+    c->bus = HAL_I2cBus_Open(&bc, &ist);
+    if (!c->bus) {
+        mcp_chip_close(c);
+        return HAL_GPIO_EIO;
+    }
+
+    /* IOCON: INT open-drain (+ MIRROR trên 16 pin); chỉ ghi byte của port A */
+    uint16_t iocon = (uint16_t)(MCP_IOCON_ODR | (npins == 16 ? MCP_IOCON_MIRROR : 0));
+    uint16_t r[MCP_NREGS];
+    if (_reg_write(c, MCP_IOCON, iocon, 0x00FF) != HAL_GPIO_OK ||
+        _reg_read(c, MCP_IODIR, MCP_NREGS, r) != HAL_GPIO_OK) {
+        HAL_LOGE("[GPIO][MCP23X]", "no MCP23x%s at %s@0x%02X", npins == 8 ? "08" : "17", bus_name, addr);
+        mcp_chip_close(c);
+        return HAL_GPIO_EIO;
+    }
+    /* giữ IODIR / OLAT / GPPU (mở lại không làm giật output); interrupt và
+     * đảo cực do HAL quản lý nên về 0 */
+    c->iodir = r[MCP_IODIR];
+    c->gppu  = r[MCP_GPPU];
+    c->olat  = r[MCP_OLAT];
+    c->in    = r[MCP_GPIO];
+    c->gpinten = r[MCP_GPINTEN];
+    HAL_GpioStatus st = _reg_write(c, MCP_GPINTEN, 0, c->gpinten);
+    c->gpinten = 0;
+    if (st == HAL_GPIO_OK) st = _reg_write(c, MCP_INTCON, 0, r[MCP_INTCON]);
+    if (st == HAL_GPIO_OK) st = _reg_write(c, MCP_IPOL, 0, r[MCP_IPOL]);
+    if (st != HAL_GPIO_OK) {
+        mcp_chip_close(c);
+        return st;
+    }
+
+    if (int_off >= 0) {
+        HAL_GpioChipConfig hc = { .chip_name = int_name };
+        HAL_GpioLineConfig lc = {
+            .offset = int_off, .dir = HAL_GPIO_DIR_IN, .active = HAL_GPIO_ACTIVE_LOW,
+            .bias = HAL_GPIO_BIAS_PULL_UP, .edge = HAL_GPIO_EDGE_BOTH,
+        };
+        if (HAL_GpioChip_Open(&hc, &c->int_chip) != HAL_GPIO_OK ||
+            HAL_GpioLine_Request(c->int_chip, &lc, &c->int_line) != HAL_GPIO_OK) {
+            HAL_LOGE("[GPIO][MCP23X]", "INT line %s/%d unavailable", int_name, int_off);
+            mcp_chip_close(c);
+            return HAL_GPIO_EIO;
+        }
+    }
+    *out_chip = c;
+    return HAL_GPIO_OK;
+}
+
+/* --- line --- */
+
+static HAL_GpioStatus mcp_line_request(void* chip, const HAL_GpioLineConfig* cfg, void** out_line)
+{
+    McpChip* c = (McpChip*)chip;
+    if (cfg->offset < 0 || cfg->offset >= c->npins) return HAL_GPIO_ENOENT;
+    if (cfg->drive == HAL_GPIO_DRIVE_OPENSOURCE || cfg->bias == HAL_GPIO_BIAS_PULL_DOWN) return HAL_GPIO_ENOSUP;
+    if (cfg->dir == HAL_GPIO_DIR_IN && cfg->edge != HAL_GPIO_EDGE_NONE && !c->int_line) return HAL_GPIO_ENOSUP;
+
+    McpLine* ln = &c->lines[cfg->offset];
+    uint16_t bit = (uint16_t)(1u << ln->pin);
+    pthread_mutex_lock(&c->mu);
+    if (ln->used) {
+        pthread_mutex_unlock(&c->mu);
+        return HAL_GPIO_EINVAL;
+    }
+    ln->dir         = cfg->dir;
+    ln->active      = cfg->active;
+    ln->od          = (cfg->dir == HAL_GPIO_DIR_OUT && cfg->drive == HAL_GPIO_DRIVE_OPENDRAIN);
+    ln->edge        = (cfg->dir == HAL_GPIO_DIR_IN) ? cfg->edge : HAL_GPIO_EDGE_NONE;
+    ln->debounce_ms = cfg->debounce_ms;
+    ln->last_evt_ns = 0;
+    ln->ehead = ln->ecount = 0;
+    if (ln->edge != HAL_GPIO_EDGE_NONE && !ln->evq) {
+        ln->evq = (HAL_GpioEvent*)calloc(MCP_EVQ, sizeof(HAL_GpioEvent));
+        if (!ln->evq) {
+            pthread_mutex_unlock(&c->mu);
+            return HAL_GPIO_EIO;
+        }
+    }
+
+    uint16_t gppu = c->gppu;
+    if (cfg->bias == HAL_GPIO_BIAS_PULL_UP)      gppu |= bit;
+    else if (cfg->bias == HAL_GPIO_BIAS_DISABLE) gppu &= (uint16_t)~bit;
+    uint16_t iodir = c->iodir, olat = c->olat;
+    if (cfg->dir == HAL_GPIO_DIR_OUT) {
+        if (!ln->od) iodir &= (uint16_t)~bit;
+        _stage(ln, cfg->initial, &iodir, &olat);
+    } else {
+        iodir |= bit;
+    }
+    /* mọi input bật interrupt-on-change khi có INT: cache c->in luôn đúng */
+    uint16_t gpinten = (c->int_line && cfg->dir == HAL_GPIO_DIR_IN) ? (c->gpinten | bit)
+                                                                    : (c->gpinten & (uint16_t)~bit);
+
+    HAL_GpioStatus st = _reg_write(c, MCP_GPPU, gppu, gppu ^ c->gppu);
+    if (st == HAL_GPIO_OK) {
+        c->gppu = gppu;
+        st = _apply(c, iodir, olat);
+    }
+    if (st == HAL_GPIO_OK) st = _reg_write(c, MCP_GPINTEN, gpinten, gpinten ^ c->gpinten);
+    if (st == HAL_GPIO_OK) {
+        int newly = !!(gpinten & ~c->gpinten);
+        c->gpinten = gpinten;
+        /* pin vừa bật interrupt: mức trong cache có thể cũ -> đọc lại một lần */
+        if (newly) st = _service(c, 0);
+    }
+    if (st == HAL_GPIO_OK) ln->used = 1;
+    pthread_mutex_unlock(&c->mu);
+    if (st != HAL_GPIO_OK) return st;
+    *out_line = ln;
+    return HAL_GPIO_OK;
+}
+
+static void mcp_line_release(void* line)
+{
+    McpLine* ln = (McpLine*)line;
+    McpChip* c  = ln->chip;
+    pthread_mutex_lock(&c->mu);
+    uint16_t bit = (uint16_t)(1u << ln->pin);
+    if (c->gpinten & bit) {
+        uint16_t g = (uint16_t)(c->gpinten & ~bit);
+        if (_reg_write(c, MCP_GPINTEN, g, bit) == HAL_GPIO_OK) c->gpinten = g;
+    }
+    ln->used = 0;
+    ln->edge = HAL_GPIO_EDGE_NONE;
+    free(ln->evq);
+    ln->evq    = NULL;
+    ln->ecount = 0;
+    pthread_mutex_unlock(&c->mu);
+}
+
+static HAL_GpioStatus mcp_line_write(void* line, int value)
+{
+    McpLine* ln = (McpLine*)line;
+    McpChip* c  = ln->chip;
+    if (ln->dir != HAL_GPIO_DIR_OUT) return HAL_GPIO_EINVAL;
+    pthread_mutex_lock(&c->mu);
+    uint16_t iodir = c->iodir, olat = c->olat;
+    _stage(ln, value, &iodir, &olat);
+    HAL_GpioStatus st = _apply(c, iodir, olat);
+    pthread_mutex_unlock(&c->mu);
+    return st;
+}
+
+static HAL_GpioStatus mcp_line_read(void* line, int* out_value)
+{
+    McpLine* ln = (McpLine*)line;
+    McpChip* c  = ln->chip;
+    uint16_t need = (ln->dir == HAL_GPIO_DIR_OUT && !ln->od) ? 0 : (uint16_t)(1u << ln->pin);
+    pthread_mutex_lock(&c->mu);
+    HAL_GpioStatus st = _inputs(c, need);
+    if (st == HAL_GPIO_OK) *out_value = _value(c, ln);
+    pthread_mutex_unlock(&c->mu);
+    return st;
+}
+
+/* Line INT host là nguồn đánh thức duy nhất: một thread chờ event của nó
+ * (servicing), các thread khác chờ cv. */
+static HAL_GpioStatus mcp_line_wait_event(void* line, int timeout_ms, HAL_GpioEvent* out_ev)
+{
+    McpLine* ln = (McpLine*)line;
+    McpChip* c  = ln->chip;
+    if (!ln->evq) return HAL_GPIO_ENOSUP;
+
+    uint64_t deadline = (timeout_ms < 0) ? UINT64_MAX : _mono_ns() + (uint64_t)timeout_ms * 1000000ull;
+    HAL_GpioStatus st = HAL_GPIO_ENOENT;
+    pthread_mutex_lock(&c->mu);
+    for (;;) {
+        if (_pop(ln, out_ev)) {
+            st = HAL_GPIO_OK;
+            break;
+        }
+        uint64_t now = _mono_ns();
+        if (!c->servicing) {
+            int wait_ms = (deadline == UINT64_MAX) ? -1
+                        : (now >= deadline) ? 0 : (int)((deadline - now + 999999ull) / 1000000ull);
+            c->servicing = 1;
+            pthread_mutex_unlock(&c->mu);
+            HAL_GpioEvent hev;
+            HAL_GpioStatus hs = HAL_GpioLine_WaitEvent(c->int_line, wait_ms, &hev);
+            pthread_mutex_lock(&c->mu);
+            c->servicing = 0;
+            /* event nhả INT, hoặc INT đã được Read khác xử lý: không cần ra bus */
+            if (hs == HAL_GPIO_OK && _int_asserted(c) && _service(c, hev.timestamp_ns) != HAL_GPIO_OK) {
+                st = HAL_GPIO_EIO;
+                pthread_cond_broadcast(&c->cv);
+                break;
+            }
+            pthread_cond_broadcast(&c->cv);
+            if (hs != HAL_GPIO_OK && hs != HAL_GPIO_ENOENT) {
+                st = HAL_GPIO_EIO;
+                break;
+            }
+            if (hs == HAL_GPIO_ENOENT && _mono_ns() >= deadline) {
+                if (_pop(ln, out_ev)) st = HAL_GPIO_OK;
+                break;
+            }
+            continue;
+        }
+        if (now >= deadline) break;
+        if (deadline == UINT64_MAX) {
+            pthread_cond_wait(&c->cv, &c->mu);
+        } else {
+            struct timespec ts = { (time_t)(deadline / 1000000000ull), (long)(deadline % 1000000000ull) };
+            pthread_cond_timedwait(&c->cv, &c->mu, &ts);
+        }
+    }
+    pthread_mutex_unlock(&c->mu);
+    return st;
+}
+
+static HAL_GpioStatus mcp_line_read_events(void* line, int timeout_ms, HAL_GpioEvent* out,
+                                           size_t max, size_t* out_n)
+{
+    McpLine* ln = (McpLine*)line;
+    HAL_GpioStatus st = mcp_line_wait_event(line, timeout_ms, &out[0]);
+    if (st != HAL_GPIO_OK) return st;
+    size_t n = 1;
+    pthread_mutex_lock(&ln->chip->mu);
+    while (n < max && _pop(ln, &out[n])) ++n;
+    pthread_mutex_unlock(&ln->chip->mu);
+    *out_n = n;
+    return HAL_GPIO_OK;
+}
+
+/* --- group: một lần ghi OLAT (+ IODIR cho open-drain) / một lần đọc GPIO --- */
+
+static McpChip* _group_chip(void* const* lines, size_t n)
+{
+    McpChip* c = n ? ((McpLine*)lines[0])->chip : NULL;
+    for (size_t i = 1; i < n; ++i)
+        if (((McpLine*)lines[i])->chip != c) return NULL;
+    return c;
+}
+
+static HAL_GpioStatus mcp_group_write(void* const* lines, size_t n, uint32_t mask, uint32_t value)
+{
+    McpChip* c = _group_chip(lines, n);
+    if (!c) return HAL_GPIO_ENOSUP;
+    pthread_mutex_lock(&c->mu);
+    uint16_t iodir = c->iodir, olat = c->olat;
+    HAL_GpioStatus st = HAL_GPIO_OK;
+    for (size_t i = 0; i < n; ++i) {
+        if (!(mask & (1u << i))) continue;
+        const McpLine* ln = (const McpLine*)lines[i];
+        if (ln->dir != HAL_GPIO_DIR_OUT) { st = HAL_GPIO_EIO; continue; }
+        _stage(ln, (int)((value >> i) & 1u), &iodir, &olat);
+    }
+    HAL_GpioStatus ast = _apply(c, iodir, olat);
+    pthread_mutex_unlock(&c->mu);
+    return (ast != HAL_GPIO_OK) ? ast : st;
+}
+
+static HAL_GpioStatus mcp_group_read(void* const* lines, size_t n, uint32_t* out_bitmap)
+{
+    McpChip* c = _group_chip(lines, n);
+    if (!c) return HAL_GPIO_ENOSUP;
+    uint16_t need = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const McpLine* ln = (const McpLine*)lines[i];
+        if (!(ln->dir == HAL_GPIO_DIR_OUT && !ln->od)) need |= (uint16_t)(1u << ln->pin);
+    }
+    pthread_mutex_lock(&c->mu);
+    HAL_GpioStatus st = _inputs(c, need);
+    uint32_t bm = 0;
+    if (st == HAL_GPIO_OK)
+        for (size_t i = 0; i < n; ++i)
+            if (_value(c, (const McpLine*)lines[i])) bm |= 1u << i;
+    pthread_mutex_unlock(&c->mu);
+    *out_bitmap = bm;
+    return st;
+}
+
+static const HAL_GpioOps s_mcp_ops = {
+    .scheme           = "mcp23x",
+    .priority         = -1,     /* chỉ chọn khi chip_name có "mcp23x:" */
+    .chip_open        = mcp_chip_open,
+    .chip_close       = mcp_chip_close,
+    .line_request     = mcp_line_request,
+    .line_release     = mcp_line_release,
+    .line_write       = mcp_line_write,
+    .line_read        = mcp_line_read,
+    .line_wait_event  = mcp_line_wait_event,
+    .line_read_events = mcp_line_read_events,
+    .group_write      = mcp_group_write,
+    .group_read       = mcp_group_read,
+};
+HAL_GPIO_BACKEND_REGISTER(s_mcp_ops)
+
+/* ---- API riêng (hal_gpio_mcp23x.h) ---- */
+
+int HAL_GpioMcp23x_IntFd(HAL_GpioChip* chip)
+{
+    McpChip* c = (McpChip*)HAL_GpioChip_BackendPriv(chip, &s_mcp_ops);
+    return (c && c->int_line) ? HAL_GpioLine_GetEventFd(c->int_line) : -1;
+}
+
+HAL_GpioStatus HAL_GpioMcp23x_Service(HAL_GpioChip* chip)
+{
+    McpChip* c = (McpChip*)HAL_GpioChip_BackendPriv(chip, &s_mcp_ops);
+    if (!c) return HAL_GPIO_EINVAL;
+    if (!c->int_line) return HAL_GPIO_ENOSUP;
+    pthread_mutex_lock(&c->mu);
+    uint64_t t_ns = 0;
+    HAL_GpioEvent hev;
+    /* xả event host để fd hết readable (thread servicing tự xả phần của nó) */
+    if (!c->servicing)
+        while (HAL_GpioLine_WaitEvent(c->int_line, 0, &hev) == HAL_GPIO_OK) t_ns = hev.timestamp_ns;
+    HAL_GpioStatus st = _int_asserted(c) ? _service(c, t_ns) : HAL_GPIO_ENOENT;
+    pthread_mutex_unlock(&c->mu);
+    return st;
+}
+
+HAL_GpioStatus HAL_GpioMcp23x_GetStats(HAL_GpioChip* chip, HAL_GpioMcp23xStats* out)
+{
+    McpChip* c = (McpChip*)HAL_GpioChip_BackendPriv(chip, &s_mcp_ops);
+    if (!c || !out) return HAL_GPIO_EINVAL;
+    pthread_mutex_lock(&c->mu);
+    *out = c->st;
+    pthread_mutex_unlock(&c->mu);
+    return HAL_GPIO_OK;
+}
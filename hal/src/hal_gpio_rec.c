@@ -0,0 +1,285 @@
+/**
+ * @file hal_gpio_rec.c
+ * @brief GPIO backends "rec:" (ghi lại mọi call của backend bên trong) và
+ *        "replay:" (trả lại kết quả từ log, không cần phần cứng).
+ *
+ * Notes:
+ *  - Front end (hal_gpio.c) tự bọc chip bằng "rec:" khi HAL_Rec_Active(), và
+ *    chuyển sang "replay:" khi HAL_Replay_Active() -> app không phải sửa tên chip.
+ *  - Kênh: "gpio:<chip>/<offset>" (hoặc "/<line name>" nếu offset < 0), <chip> là
+ *    tên đã bỏ scheme, nên log ghi trên "gpiod:gpiochip0" replay được với "gpiochip0".
+ *  - Mỗi call ghi đúng một bản ghi, kể cả kết quả lỗi / timeout của WaitEvent;
+ *    replay trả từng call theo đúng thứ tự đã ghi (read thứ n = bản ghi read thứ
+ *    n, WaitEvent thứ n = event hoặc timeout thứ n) -> tất định ở mọi tốc độ.
+ *    REALTIME chỉ là nhịp: call không trả về trước thời điểm bản ghi của nó.
+ *  - Replay event fd: timerfd hẹn giờ tới due của event kế tiếp.
+ */
+#define _GNU_SOURCE
+#include "hal_gpio.h"
+#include "hal_gpio_backend.h"
+#include "hal_log.h"
+#include "hal_rec.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+static void _chan_name(char* buf, size_t n, const char* chip, const HAL_GpioLineConfig* cfg) {
+    if (cfg->offset >= 0) snprintf(buf, n, "gpio:%s/%d", chip, cfg->offset);
+    else                  snprintf(buf, n, "gpio:%s/%s", chip, cfg->name ? cfg->name : "?");
+}
+
+/* ======================= rec: ======================= */
+
+typedef struct {
+    HAL_GpioWrap w;       /* phải đứng đầu (HAL_GpioChip_BackendPriv đi xuyên qua) */
+    char         name[64];
+} RecChip;
+
+typedef struct {
+    HAL_GpioWrap w;
+    uint16_t     chan;
+} RecLine;
+
+static HAL_GpioStatus rec_chip_open(const char* name, void** out_chip) {
+    const char* inner_name = NULL;
+    const HAL_GpioOps* inner = HAL_GpioBackend_Resolve(name, &inner_name);
+    if (!inner || strcmp(inner->scheme, "rec") == 0 || strcmp(inner->scheme, "replay") == 0)
+        return HAL_GPIO_ENOSUP;
+
+    RecChip* c = (RecChip*)calloc(1, sizeof(*c));
+    if (!c) return HAL_GPIO_EIO;
+    HAL_GpioStatus st = inner->chip_open(inner_name, &c->w.priv);
+    if (st != HAL_GPIO_OK) { free(c); return st; }
+    c->w.inner = inner;
+    snprintf(c->name, sizeof(c->name), "%s", inner_name);
+    *out_chip = c;
+    return HAL_GPIO_OK;
+}
+
+static void rec_chip_close(void* chip) {
+    RecChip* c = (RecChip*)chip;
+    if (c->w.inner->chip_close) c->w.inner->chip_close(c->w.priv);
+    free(c);
+}
+
+static HAL_GpioStatus rec_line_request(void* chip, const HAL_GpioLineConfig* cfg, void** out_line) {
+    RecChip* c = (RecChip*)chip;
+    RecLine* l = (RecLine*)calloc(1, sizeof(*l));
+    if (!l) return HAL_GPIO_EIO;
+    HAL_GpioStatus st = c->w.inner->line_request(c->w.priv, cfg, &l->w.priv);
+    if (st != HAL_GPIO_OK) { free(l); return st; }
+
+    char chan[96];
+    _chan_name(chan, sizeof(chan), c->name, cfg);
+    l->w.inner = c->w.inner;
+    l->chan  = HAL_Rec_Channel(chan);
+    *out_line = l;
+    return HAL_GPIO_OK;
+}
+
+static void rec_line_release(void* line) {
+    RecLine* l = (RecLine*)line;
+    if (l->w.inner->line_release) l->w.inner->line_release(l->w.priv);
+    free(l);
+}
+
+static HAL_GpioStatus rec_line_write(void* line, int value) {
+    RecLine* l = (RecLine*)line;
+    HAL_GpioStatus st = l->w.inner->line_write(l->w.priv, value);
+    uint8_t v = value ? 1 : 0;
+    HAL_Rec_Put(HAL_REC_GPIO_WRITE, l->chan, (int32_t)st, &v, 1, NULL, 0);
+    return st;
+}
+
+static HAL_GpioStatus rec_line_read(void* line, int* out) {
+    RecLine* l = (RecLine*)line;
+    HAL_GpioStatus st = l->w.inner->line_read(l->w.priv, out);
+    uint8_t v = (st == HAL_GPIO_OK && *out) ? 1 : 0;
+    HAL_Rec_Put(HAL_REC_GPIO_READ, l->chan, (int32_t)st, &v, 1, NULL, 0);
+    return st;
+}
+
+static HAL_GpioStatus rec_line_wait_event(void* line, int timeout_ms, HAL_GpioEvent* out_ev) {
+    RecLine* l = (RecLine*)line;
+    if (!l->w.inner->line_wait_event) return HAL_GPIO_ENOSUP;
+    HAL_GpioEvent ev = {0};
+    HAL_GpioStatus st = l->w.inner->line_wait_event(l->w.priv, timeout_ms, &ev);
+    /* ghi cả timeout (ENOENT): replay phải trả đúng kết quả cho đúng call */
+    if (st == HAL_GPIO_OK) {
+        uint8_t edge = (uint8_t)ev.edge;
+        HAL_Rec_Put(HAL_REC_GPIO_EVENT, l->chan, 0, &edge, 1, &ev.timestamp_ns, sizeof(ev.timestamp_ns));
+        if (out_ev) *out_ev = ev;
+    } else {
+        HAL_Rec_Put(HAL_REC_GPIO_EVENT, l->chan, (int32_t)st, NULL, 0, NULL, 0);
+    }
+    return st;
+}
+
+static int rec_line_event_fd(void* line) {
+    RecLine* l = (RecLine*)line;
+    return l->w.inner->line_event_fd ? l->w.inner->line_event_fd(l->w.priv) : -1;
+}
+
+static const HAL_GpioOps s_rec_ops = {
+    .scheme          = "rec",
+    .priority        = -1,     /* không bao giờ là mặc định */
+    .chip_open       = rec_chip_open,
+    .chip_close      = rec_chip_close,
+    .line_request    = rec_line_request,
+    .line_release    = rec_line_release,
+    .line_write      = rec_line_write,
+    .line_read       = rec_line_read,
+    .line_wait_event = rec_line_wait_event,
+    .line_event_fd   = rec_line_event_fd,
+    .wrapper         = 1,
+};
+HAL_GPIO_BACKEND_REGISTER(s_rec_ops)
+
+/* ======================= replay: ======================= */
+
+typedef struct {
+    char name[64];
+} RpChip;
+
+typedef struct {
+    int chan;
+    int have_event;
+    int tfd;          /* timerfd cho event fd, -1 nếu chưa tạo */
+    int last;         /* giá trị read gần nhất (hold khi log hết) */
+} RpLine;
+
+static HAL_GpioStatus replay_chip_open(const char* name, void** out_chip) {
+    const char* plain = NULL;
+    HAL_GpioBackend_Resolve(name, &plain);     /* chỉ để bỏ scheme "sim:"/"gpiod:"... */
+    RpChip* c = (RpChip*)calloc(1, sizeof(*c));
+    if (!c) return HAL_GPIO_EIO;
+    snprintf(c->name, sizeof(c->name), "%s", plain ? plain : "");
+    *out_chip = c;
+    return HAL_GPIO_OK;
+}
+
+static void replay_chip_close(void* chip) {
+    free(chip);
+}
+
+/* hẹn timerfd tới due của event kế tiếp (hết event -> disarm) */
+static void _rp_arm(RpLine* l) {
+    if (l->tfd < 0) return;
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    HAL_RecEntry e;
+    if (HAL_Replay_Peek(l->chan, HAL_REC_GPIO_EVENT, &e) == 0) {
+        its.it_value.tv_sec  = (time_t)(e.due_ns / 1000000000ull);
+        its.it_value.tv_nsec = (long)(e.due_ns % 1000000000ull);
+    }
+    timerfd_settime(l->tfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+static HAL_GpioStatus replay_line_request(void* chip, const HAL_GpioLineConfig* cfg, void** out_line) {
+    RpChip* c = (RpChip*)chip;
+    char chan[96];
+    _chan_name(chan, sizeof(chan), c->name, cfg);
+    int id = HAL_Replay_Channel(chan);
+    if (id < 0) {
+        HAL_LOGE("[GPIO][REPLAY]", "%s not in recording", chan);
+        return HAL_GPIO_ENOENT;
+    }
+
+    RpLine* l = (RpLine*)calloc(1, sizeof(*l));
+    if (!l) return HAL_GPIO_EIO;
+    l->chan       = id;
+    l->have_event = (cfg->dir == HAL_GPIO_DIR_IN && cfg->edge != HAL_GPIO_EDGE_NONE);
+    l->tfd        = -1;
+    l->last       = (cfg->dir == HAL_GPIO_DIR_OUT) ? (cfg->initial ? 1 : 0) : 0;
+    *out_line = l;
+    return HAL_GPIO_OK;
+}
+
+static void replay_line_release(void* line) {
+    RpLine* l = (RpLine*)line;
+    if (l->tfd >= 0) close(l->tfd);
+    free(l);
+}
+
+static HAL_GpioStatus replay_line_write(void* line, int value) {
+    RpLine* l = (RpLine*)line;
+    uint8_t v = value ? 1 : 0;
+    int st = HAL_Replay_Expect(l->chan, HAL_REC_GPIO_WRITE, &v, 1, NULL, 0, NULL);
+    l->last = v;
+    return (st < 0) ? HAL_GPIO_OK : (HAL_GpioStatus)st;
+}
+
+static HAL_GpioStatus replay_line_read(void* line, int* out) {
+    RpLine* l = (RpLine*)line;
+    HAL_RecEntry e;
+    HAL_GpioStatus st = HAL_GPIO_OK;
+
+    /* một read = một bản ghi; REALTIME chờ tới thời điểm của nó, log hết -> giữ giá trị cuối */
+    if (HAL_Replay_Next(l->chan, HAL_REC_GPIO_READ, -1, &e) == 0) {
+        st = (HAL_GpioStatus)e.status;
+        if (e.alen) l->last = e.a[0];
+    }
+    *out = l->last;
+    return st;
+}
+
+static HAL_GpioStatus replay_line_wait_event(void* line, int timeout_ms, HAL_GpioEvent* out_ev) {
+    RpLine* l = (RpLine*)line;
+    if (!l->have_event) return HAL_GPIO_ENOSUP;
+
+    if (l->tfd >= 0) {           /* xả timerfd để epoll không báo lại */
+        uint64_t ticks;
+        ssize_t r = read(l->tfd, &ticks, sizeof(ticks));
+        (void)r;
+    }
+
+    /* bản ghi kế tiếp là kết quả của call này (event hoặc timeout). REALTIME: chờ
+     * tới thời điểm đã ghi nhưng không quá timeout_ms, rồi vẫn trả bản ghi đó */
+    HAL_RecEntry e;
+    int rc = HAL_Replay_Next(l->chan, HAL_REC_GPIO_EVENT, timeout_ms, &e);
+    if (rc > 0) rc = HAL_Replay_Take(l->chan, HAL_REC_GPIO_EVENT, &e);
+    if (rc < 0) {
+        /* log hết: như line không còn event nào – chờ hết timeout rồi báo timeout */
+        int ms = (timeout_ms < 0) ? 100 : timeout_ms;
+        struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000L };
+        nanosleep(&ts, NULL);
+        return HAL_GPIO_ENOENT;
+    }
+    _rp_arm(l);
+    if (e.status != 0) return (HAL_GpioStatus)e.status;
+
+    if (out_ev) {
+        out_ev->edge = (e.alen) ? (HAL_GpioEdge)e.a[0] : HAL_GPIO_EDGE_RISING;
+        out_ev->timestamp_ns = 0;
+        if (e.blen == sizeof(uint64_t)) memcpy(&out_ev->timestamp_ns, e.b, sizeof(uint64_t));
+    }
+    return HAL_GPIO_OK;
+}
+
+static int replay_line_event_fd(void* line) {
+    RpLine* l = (RpLine*)line;
+    if (!l->have_event) return -1;
+    if (l->tfd < 0) {
+        l->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        _rp_arm(l);
+    }
+    return l->tfd;
+}
+
+static const HAL_GpioOps s_replay_ops = {
+    .scheme          = "replay",
+    .priority        = -1,
+    .chip_open       = replay_chip_open,
+    .chip_close      = replay_chip_close,
+    .line_request    = replay_line_request,
+    .line_release    = replay_line_release,
+    .line_write      = replay_line_write,
+    .line_read       = replay_line_read,
+    .line_wait_event = replay_line_wait_event,
+    .line_event_fd   = replay_line_event_fd,
+};
+HAL_GPIO_BACKEND_REGISTER(s_replay_ops)
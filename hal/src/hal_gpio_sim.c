@@ -1,23 +1,58 @@
 // hal_gpio_sim.c
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <time.h>
 #include "hal_gpio.h"   // dùng lại header gốc
+#include "hal_gpio_backend.h"
+#include "hal_gpio_sim.h"
 
 #define HAL_GPIO_SIM_MAX_LINES 64
+#define HAL_GPIO_SIM_MAX_PEND  256   // cạnh vật lý đang chờ / line có shape
+#define HAL_GPIO_SIM_EVQ       256   // event chờ đọc / line có edge (kernel mặc định 16)
+
+typedef struct HalGpioSimChip HalGpioSimChip;
+
+/* tầng tạo dạng tín hiệu, chỉ cấp phát cho line có shape */
+typedef struct {
+    HAL_GpioSimShape  shape;
+    uint32_t          rng;
+    unsigned          phead, npend;
+    uint64_t          last_us;         // thời điểm cạnh cuối đã xảy ra
+    uint64_t          next_glitch_us;
+    uint64_t          pend[HAL_GPIO_SIM_MAX_PEND];  // (t_us << 1) | spurious, tăng dần theo t
+} HalGpioSimShaper;
 
 typedef struct {
     int used;
     int offset;
     HAL_GpioDir   dir;
     HAL_GpioActive active;
-    int value;          // 0/1 hiện tại
+    int value;          // 0/1 hiện tại (mức vật lý tại "bây giờ")
+    int target;         // mức của lần SetInput cuối (sau khi hết bounce)
+    HalGpioSimChip* chip;
+
+    HalGpioSimShaper* sh;              // NULL = đổi mức sạch
+    void*             link;            // HalGpioSimLine input do output này lái (NULL = không)
+    HAL_GpioSimStats  st;
+
+    /* event (chỉ khi request với edge != NONE) */
+    HAL_GpioEdge      edge;
+    uint32_t          debounce_ms;
+    uint64_t          last_evt_ns;
+    HAL_GpioEvent*    evq;
+    unsigned          ehead, ecount;
 } HalGpioSimLine;
 
-typedef struct {
+struct HalGpioSimChip {
     char name[32];
     int  line_count;
+    int  virt;          // 1 = timeline ảo (chỉ chạy khi Advance)
+    uint64_t now_us;    // timeline ảo
+    pthread_mutex_t mu;
+    pthread_cond_t  cv; // SetInput đánh thức WaitEvent đang chờ (timeline thật)
     HalGpioSimLine lines[HAL_GPIO_SIM_MAX_LINES];
-} HalGpioSimChip;
+};
 
 /* --------- Helpers nội bộ ---------- */
 
@@ -32,17 +67,226 @@ static HalGpioSimLine* sim_find_line(HalGpioSimChip* chip, int offset)
     return NULL;
 }
 
-/* --------- API giống hal_gpio_linux.c ---------- */
+static uint64_t sim_mono_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+static uint64_t sim_now(const HalGpioSimChip* c)
+{
+    return c->virt ? c->now_us : sim_mono_us();
+}
+
+/* xorshift32: đủ cho nhiễu, tất định theo seed */
+static uint32_t sim_rand(HalGpioSimShaper* sh)
+{
+    uint32_t x = sh->rng;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return sh->rng = x;
+}
+
+static uint32_t sim_uniform(HalGpioSimShaper* sh, uint32_t lo, uint32_t hi)
+{
+    if (hi <= lo) return lo;
+    return lo + sim_rand(sh) % (hi - lo + 1u);
+}
+
+/* ln(u), u = r / 2^24 với r trong [1, 2^24]; không kéo libm vào HAL */
+static double sim_ln_u24(uint32_t r)
+{
+    const double LN2 = 0.69314718055994531;
+    int e = 31 - __builtin_clz(r);
+    double m = (double)r / (double)(1u << e);          // [1, 2)
+    double z = (m - 1.0) / (m + 1.0), z2 = z * z;      // |z| <= 1/3
+    double lnm = 2.0 * z * (1.0 + z2 * (1.0 / 3 + z2 * (1.0 / 5 + z2 * (1.0 / 7 + z2 / 9))));
+    return (double)(e - 24) * LN2 + lnm;
+}
+
+/* mẫu phân phối mũ với trung bình mean_us */
+static uint64_t sim_exp(HalGpioSimShaper* sh, double mean_us)
+{
+    uint32_t r = (sim_rand(sh) >> 8) + 1u;
+    return (uint64_t)(-mean_us * sim_ln_u24(r));
+}
+
+static uint32_t sim_gap(HalGpioSimShaper* sh)
+{
+    const HAL_GpioSimShape* s = &sh->shape;
+    uint32_t g;
+    if (s->gap_dist == HAL_GPIO_SIM_DIST_EXP) {
+        uint64_t e = sim_exp(sh, 0.5 * ((double)s->gap_min_us + (double)s->gap_max_us));
+        g = (e < s->gap_min_us) ? s->gap_min_us : (e > s->gap_max_us) ? s->gap_max_us : (uint32_t)e;
+    } else {
+        g = sim_uniform(sh, s->gap_min_us, s->gap_max_us);
+    }
+    return g ? g : 1u;
+}
+
+static uint64_t sim_glitch_gap(HalGpioSimShaper* sh)
+{
+    uint64_t g = sim_exp(sh, 1e6 / sh->shape.glitch_hz);
+    return g ? g : 1u;
+}
+
+static void sim_push_event(HalGpioSimLine* ln, uint64_t t_us)
+{
+    if (!ln->evq) return;
+    int logical = (ln->active == HAL_GPIO_ACTIVE_LOW) ? !ln->value : ln->value;
+    HAL_GpioEdge e = logical ? HAL_GPIO_EDGE_RISING : HAL_GPIO_EDGE_FALLING;
+    if (ln->edge != HAL_GPIO_EDGE_BOTH && ln->edge != e) return;
+    if (ln->ecount == HAL_GPIO_SIM_EVQ) { ln->st.events_dropped++; return; }
+    HAL_GpioEvent* ev = &ln->evq[(ln->ehead + ln->ecount) % HAL_GPIO_SIM_EVQ];
+    ev->timestamp_ns = t_us * 1000ull;
+    ev->edge         = e;
+    ln->ecount++;
+}
+
+/* một cạnh vật lý tại t_us */
+static void sim_edge(HalGpioSimLine* ln, uint64_t t_us, int spurious)
+{
+    ln->value ^= 1;
+    ln->st.edges++;
+    if (spurious) ln->st.spurious++;
+    if (ln->sh) ln->sh->last_us = t_us;
+    sim_push_event(ln, t_us);
+}
+
+static void sim_pend(HalGpioSimShaper* sh, uint64_t t_us, int spurious)
+{
+    sh->pend[(sh->phead + sh->npend) % HAL_GPIO_SIM_MAX_PEND] = (t_us << 1) | (spurious ? 1u : 0u);
+    sh->npend++;
+}
+
+/* cho các cạnh đã tới hạn xảy ra (và sinh glitch) tới thời điểm now */
+static void sim_sync(HalGpioSimLine* ln, uint64_t now)
+{
+    HalGpioSimShaper* sh = ln->sh;
+    if (!sh) return;
+    for (;;) {
+        if (!sh->npend && sh->shape.glitch_hz > 0.0) {
+            /* không chồng glitch lên đoạn chuyển mức vừa xong */
+            if (sh->next_glitch_us < sh->last_us) sh->next_glitch_us = sh->last_us + sim_glitch_gap(sh);
+            if (sh->next_glitch_us <= now) {
+                uint64_t t = sh->next_glitch_us;
+                uint32_t w = sim_uniform(sh, sh->shape.glitch_min_us, sh->shape.glitch_max_us);
+                if (!w) w = 1;
+                sim_pend(sh, t, 1);
+                sim_pend(sh, t + w, 1);
+                ln->st.glitches++;
+                sh->next_glitch_us = t + w + sim_glitch_gap(sh);
+            }
+        }
+        if (!sh->npend) break;
+        uint64_t e = sh->pend[sh->phead];
+        if ((e >> 1) > now) break;
+        sh->phead = (sh->phead + 1u) % HAL_GPIO_SIM_MAX_PEND;
+        sh->npend--;
+        sim_edge(ln, e >> 1, (int)(e & 1u));
+    }
+}
 
-HAL_GpioStatus HAL_GpioChip_Open(const HAL_GpioChipConfig* cfg, HAL_GpioChip** out_chip)
+/* lên lịch chuỗi cạnh cho một lần đổi mức (đã sync tới now) */
+static void sim_schedule(HalGpioSimLine* ln, uint64_t now)
 {
-    if (!cfg || !out_chip) return HAL_GPIO_EINVAL;
+    HalGpioSimShaper* sh = ln->sh;
+    const HAL_GpioSimShape* s = &sh->shape;
+    uint64_t t0 = now;
+    if (sh->npend) {
+        uint64_t last = sh->pend[(sh->phead + sh->npend - 1u) % HAL_GPIO_SIM_MAX_PEND] >> 1;
+        if (last > t0) t0 = last;
+    }
+
+    unsigned room = HAL_GPIO_SIM_MAX_PEND - sh->npend;
+    if (room == 0) {
+        /* đầy: bỏ các cạnh đang chờ, đổi thẳng sang mức đích */
+        sh->npend = 0;
+        if (ln->value != ln->target) sim_edge(ln, now, 0);
+        return;
+    }
+
+    int chatter = (s->slow_edge_us && s->slow_chatter > 0) ? s->slow_chatter : 0;
+    int bounces = (s->bounce_max > 0) ? (int)sim_uniform(sh, (uint32_t)(s->bounce_min > 0 ? s->bounce_min : 0),
+                                                         (uint32_t)s->bounce_max) : 0;
+    while (chatter > 0 && 1u + 2u * (unsigned)chatter > room) chatter--;
+    while (bounces > 0 && 1u + 2u * (unsigned)(chatter + bounces) > room) bounces--;
+
+    /* qua ngưỡng: cạnh chính ở giữa đoạn chậm, chatter rải trong nửa giữa */
+    uint64_t t = t0 + s->slow_edge_us / 2u;
+    if (chatter) {
+        uint64_t ts[HAL_GPIO_SIM_MAX_PEND];
+        int k = 1 + 2 * chatter;
+        uint32_t lo = s->slow_edge_us / 4u, hi = s->slow_edge_us - s->slow_edge_us / 4u;
+        for (int i = 0; i < k; ++i) {
+            uint64_t v = t0 + sim_uniform(sh, lo, hi);
+            int j = i;
+            for (; j > 0 && ts[j - 1] > v; --j) ts[j] = ts[j - 1];
+            ts[j] = v;
+        }
+        for (int i = 0; i < k; ++i) sim_pend(sh, ts[i], i != chatter);
+        t = ts[k - 1];
+    } else {
+        sim_pend(sh, t, 0);
+    }
 
+    for (int i = 0; i < bounces; ++i) {
+        t += sim_gap(sh); sim_pend(sh, t, 1);
+        t += sim_gap(sh); sim_pend(sh, t, 1);
+    }
+}
+
+/* Đặt mức cho một line input (SetInput, hoặc output đã Link sang nó) */
+static void sim_drive(HalGpioSimLine* ln, int logic_val)
+{
+    HalGpioSimChip* c = ln->chip;
+    // ép line này về input luôn cũng được
+    ln->dir   = HAL_GPIO_DIR_IN;
+    // lưu trực tiếp theo logic (chưa tính active)
+    int v = logic_val ? 1 : 0;
+
+    if (!ln->sh && !ln->evq) {
+        /* đường nhanh như trước: không shape, không ai chờ event */
+        if (v != ln->target) {
+            ln->target = ln->value = v;
+            ln->st.transitions++;
+            ln->st.edges++;
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&c->mu);
+    uint64_t now = sim_now(c);
+    sim_sync(ln, now);
+    if (v != ln->target) {
+        ln->target = v;
+        ln->st.transitions++;
+        if (ln->sh) {
+            sim_schedule(ln, now);
+            sim_sync(ln, now);
+        } else {
+            sim_edge(ln, now, 0);   // đổi mức sạch, ngay lập tức
+        }
+        pthread_cond_broadcast(&c->cv);
+    }
+    pthread_mutex_unlock(&c->mu);
+}
+
+/* --------- Ops (đăng ký vào registry, scheme "sim:") ---------- */
+
+static HAL_GpioStatus sim_chip_open(const char* name, void** out_chip)
+{
     HalGpioSimChip* c = (HalGpioSimChip*)malloc(sizeof(HalGpioSimChip));
     if (!c) return HAL_GPIO_EIO;
 
     memset(c, 0, sizeof(*c));
-    strncpy(c->name, cfg->chip_name ? cfg->chip_name : "sim-gpio", sizeof(c->name)-1);
+    strncpy(c->name, (name && name[0]) ? name : "sim-gpio", sizeof(c->name)-1);
+    pthread_mutex_init(&c->mu, NULL);
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    pthread_cond_init(&c->cv, &ca);
+    pthread_condattr_destroy(&ca);
 
     // giả lập có 32 line, offset 0..31
     c->line_count = 32;
@@ -52,25 +296,30 @@ HAL_GpioStatus HAL_GpioChip_Open(const HAL_GpioChipConfig* cfg, HAL_GpioChip** o
         c->lines[i].dir    = HAL_GPIO_DIR_IN;
         c->lines[i].active = HAL_GPIO_ACTIVE_HIGH;
         c->lines[i].value  = 0;
+        c->lines[i].chip   = c;
     }
 
-    *out_chip = (HAL_GpioChip*)c;
+    *out_chip = c;
     return HAL_GPIO_OK;
 }
 
-void HAL_GpioChip_Close(HAL_GpioChip* chip)
+static void sim_chip_close(void* chip)
 {
-    if (!chip) return;
-    free(chip);
+    HalGpioSimChip* c = (HalGpioSimChip*)chip;
+    for (int i = 0; i < c->line_count; ++i) {
+        free(c->lines[i].sh);
+        free(c->lines[i].evq);
+    }
+    pthread_cond_destroy(&c->cv);
+    pthread_mutex_destroy(&c->mu);
+    free(c);
 }
 
-HAL_GpioStatus HAL_GpioLine_Request(HAL_GpioChip* chip,
-                                    const HAL_GpioLineConfig* cfg,
-                                    HAL_GpioLine** out_line)
+static HAL_GpioStatus sim_line_request(void* chip,
+                                       const HAL_GpioLineConfig* cfg,
+                                       void** out_line)
 {
     HalGpioSimChip* c = (HalGpioSimChip*)chip;
-    if (!c || !cfg || !out_line) return HAL_GPIO_EINVAL;
-
     HalGpioSimLine* ln = sim_find_line(c, cfg->offset);
     if (!ln) return HAL_GPIO_ENOENT;
 
@@ -80,27 +329,50 @@ HAL_GpioStatus HAL_GpioLine_Request(HAL_GpioChip* chip,
     ln->active = cfg->active;
     // nếu là output thì set initial
     if (cfg->dir == HAL_GPIO_DIR_OUT) {
-        ln->value = cfg->initial ? 1 : 0;
+        ln->value = ln->target = cfg->initial ? 1 : 0;
     }
 
-    *out_line = (HAL_GpioLine*)ln;
+    // event: chỉ input có edge
+    ln->edge        = (cfg->dir == HAL_GPIO_DIR_IN) ? cfg->edge : HAL_GPIO_EDGE_NONE;
+    ln->debounce_ms = cfg->debounce_ms;
+    ln->last_evt_ns = 0;
+    ln->ehead = ln->ecount = 0;
+    if (ln->edge != HAL_GPIO_EDGE_NONE && !ln->evq) {
+        ln->evq = (HAL_GpioEvent*)calloc(HAL_GPIO_SIM_EVQ, sizeof(HAL_GpioEvent));
+        if (!ln->evq) {
+            ln->used = 0;
+            return HAL_GPIO_EIO;
+        }
+    }
+
+    *out_line = ln;
     return HAL_GPIO_OK;
 }
 
-void HAL_GpioLine_Release(HAL_GpioLine* line)
+static void sim_line_release(void* line)
 {
-    if (!line) return;
     HalGpioSimLine* ln = (HalGpioSimLine*)line;
     ln->used = 0;
+    ln->edge = HAL_GPIO_EDGE_NONE;
+    free(ln->evq);
+    ln->evq = NULL;
+    ln->ecount = 0;
 }
 
 /* đọc từ line */
-HAL_GpioStatus HAL_GpioLine_Read(HAL_GpioLine* line, int* out_val)
+static HAL_GpioStatus sim_line_read(void* line, int* out_val)
 {
-    if (!line || !out_val) return HAL_GPIO_EINVAL;
     HalGpioSimLine* ln = (HalGpioSimLine*)line;
 
-    int v = ln->value;
+    int v;
+    if (ln->sh) {
+        pthread_mutex_lock(&ln->chip->mu);
+        sim_sync(ln, sim_now(ln->chip));
+        v = ln->value;
+        pthread_mutex_unlock(&ln->chip->mu);
+    } else {
+        v = ln->value;  // đổi mức sạch: không có gì phải đồng bộ
+    }
     // nếu active low thì giá trị logic ngược lại
     if (ln->active == HAL_GPIO_ACTIVE_LOW) {
         v = v ? 0 : 1;
@@ -110,9 +382,8 @@ HAL_GpioStatus HAL_GpioLine_Read(HAL_GpioLine* line, int* out_val)
 }
 
 /* ghi ra line */
-HAL_GpioStatus HAL_GpioLine_Write(HAL_GpioLine* line, int val)
+static HAL_GpioStatus sim_line_write(void* line, int val)
 {
-    if (!line) return HAL_GPIO_EINVAL;
     HalGpioSimLine* ln = (HalGpioSimLine*)line;
 
     if (ln->dir != HAL_GPIO_DIR_OUT) {
@@ -125,29 +396,132 @@ HAL_GpioStatus HAL_GpioLine_Write(HAL_GpioLine* line, int val)
     } else {
         ln->value = val ? 1 : 0;
     }
+    if (ln->link) sim_drive((HalGpioSimLine*)ln->link, ln->value);
     return HAL_GPIO_OK;
 }
 
-/* ---- Các hàm chỉ dùng cho SIM, không nhất thiết khai báo trong hal_gpio.h ---- */
+/* Event theo timeline sim + soft debounce (giống backend gpiod/uapi).
+ * Timeline ảo: không chặn, hết event -> ENOENT (thời gian chỉ chạy khi Advance). */
+static HAL_GpioStatus sim_line_wait_event(void* line, int timeout_ms, HAL_GpioEvent* out_ev)
+{
+    HalGpioSimLine* ln = (HalGpioSimLine*)line;
+    HalGpioSimChip* c  = ln->chip;
+    if (!ln->evq) return HAL_GPIO_ENOSUP;
+
+    HAL_GpioStatus st = HAL_GPIO_ENOENT;
+    pthread_mutex_lock(&c->mu);
+    uint64_t deadline = (timeout_ms < 0) ? UINT64_MAX : sim_now(c) + (uint64_t)timeout_ms * 1000ull;
+    for (;;) {
+        uint64_t now = sim_now(c);
+        sim_sync(ln, now);
+        if (ln->ecount) {
+            HAL_GpioEvent ev = ln->evq[ln->ehead];
+            ln->ehead = (ln->ehead + 1u) % HAL_GPIO_SIM_EVQ;
+            ln->ecount--;
+            if (ln->debounce_ms > 0 && ln->last_evt_ns != 0) {
+                uint64_t dt = (ev.timestamp_ns > ln->last_evt_ns) ? (ev.timestamp_ns - ln->last_evt_ns) : 0;
+                if (dt < (uint64_t)ln->debounce_ms * 1000000ull) break;
+            }
+            ln->last_evt_ns = ev.timestamp_ns;
+            if (out_ev) *out_ev = ev;
+            st = HAL_GPIO_OK;
+            break;
+        }
+        if (c->virt || now >= deadline || !ln->evq) break;
+
+        /* ngủ tới cạnh đã lên lịch kế tiếp / glitch kế tiếp / SetInput, không quá deadline */
+        uint64_t wake = deadline;
+        HalGpioSimShaper* sh = ln->sh;
+        if (sh && sh->npend && (sh->pend[sh->phead] >> 1) < wake) wake = sh->pend[sh->phead] >> 1;
+        else if (sh && !sh->npend && sh->shape.glitch_hz > 0.0 && sh->next_glitch_us < wake)
+            wake = sh->next_glitch_us;
+        if (wake == UINT64_MAX) {
+            pthread_cond_wait(&c->cv, &c->mu);
+        } else {
+            struct timespec ts = { (time_t)(wake / 1000000ull), (long)(wake % 1000000ull) * 1000L };
+            pthread_cond_timedwait(&c->cv, &c->mu, &ts);
+        }
+    }
+    pthread_mutex_unlock(&c->mu);
+    return st;
+}
+
+/* Cả lô: chờ event đầu như WaitEvent, rồi lấy hết event đã tới hạn trong một lần giữ lock */
+static HAL_GpioStatus sim_line_read_events(void* line, int timeout_ms, HAL_GpioEvent* out,
+                                           size_t max, size_t* out_n)
+{
+    HalGpioSimLine* ln = (HalGpioSimLine*)line;
+    HalGpioSimChip* c  = ln->chip;
+    HAL_GpioStatus st = sim_line_wait_event(line, timeout_ms, &out[0]);
+    if (st != HAL_GPIO_OK) return st;
+
+    size_t n = 1;
+    pthread_mutex_lock(&c->mu);
+    sim_sync(ln, sim_now(c));
+    while (n < max && ln->ecount) {
+        HAL_GpioEvent ev = ln->evq[ln->ehead];
+        ln->ehead = (ln->ehead + 1u) % HAL_GPIO_SIM_EVQ;
+        ln->ecount--;
+        if (ln->debounce_ms > 0 && ln->last_evt_ns != 0) {
+            uint64_t dt = (ev.timestamp_ns > ln->last_evt_ns) ? (ev.timestamp_ns - ln->last_evt_ns) : 0;
+            if (dt < (uint64_t)ln->debounce_ms * 1000000ull) continue;
+        }
+        ln->last_evt_ns = ev.timestamp_ns;
+        out[n++] = ev;
+    }
+    pthread_mutex_unlock(&c->mu);
+    *out_n = n;
+    return HAL_GPIO_OK;
+}
+
+/* SIM có event (WaitEvent) nhưng không có fd để poll: line_event_fd = NULL */
+static const HAL_GpioOps s_sim_ops = {
+    .scheme          = "sim",
+    .priority        = 0,      /* chỉ là mặc định khi không có backend thật */
+    .chip_open       = sim_chip_open,
+    .chip_close      = sim_chip_close,
+    .line_request    = sim_line_request,
+    .line_release    = sim_line_release,
+    .line_write      = sim_line_write,
+    .line_read       = sim_line_read,
+    .line_wait_event = sim_line_wait_event,
+    .line_read_events = sim_line_read_events,
+};
+HAL_GPIO_BACKEND_REGISTER(s_sim_ops)
+
+/* ---- Các hàm chỉ dùng cho SIM (hal_gpio_sim.h) ---- */
 
 /* Set giá trị cho 1 line input (mô phỏng người dùng ấn nút) */
 HAL_GpioStatus HAL_GpioSim_SetInput(HAL_GpioChip* chip, int offset, int logic_val)
 {
-    HalGpioSimChip* c = (HalGpioSimChip*)chip;
+    HalGpioSimChip* c = (HalGpioSimChip*)HAL_GpioChip_BackendPriv(chip, &s_sim_ops);
     HalGpioSimLine* ln = sim_find_line(c, offset);
     if (!ln) return HAL_GPIO_ENOENT;
+    sim_drive(ln, logic_val);
+    return HAL_GPIO_OK;
+}
 
-    // ép line này về input luôn cũng được
-    ln->dir   = HAL_GPIO_DIR_IN;
-    // lưu trực tiếp theo logic (chưa tính active)
-    ln->value = logic_val ? 1 : 0;
+/* Nối dây output -> input: mỗi lần ghi output lái input như SetInput */
+HAL_GpioStatus HAL_GpioSim_Link(HAL_GpioChip* chip, int out_offset, int in_offset)
+{
+    HalGpioSimChip* c = (HalGpioSimChip*)HAL_GpioChip_BackendPriv(chip, &s_sim_ops);
+    HalGpioSimLine* out = sim_find_line(c, out_offset);
+    if (!out) return HAL_GPIO_ENOENT;
+    if (in_offset < 0) {
+        out->link = NULL;
+        return HAL_GPIO_OK;
+    }
+    HalGpioSimLine* in = sim_find_line(c, in_offset);
+    if (!in || in == out) return HAL_GPIO_EINVAL;
+    out->link = in;
+    sim_drive(in, out->value);
     return HAL_GPIO_OK;
 }
 
 /* Lấy giá trị thực tế của 1 line output (để biết LED đang on/off) */
 HAL_GpioStatus HAL_GpioSim_GetOutput(HAL_GpioChip* chip, int offset, int* out_logic)
 {
-    HalGpioSimChip* c = (HalGpioSimChip*)chip;
+    HalGpioSimChip* c = (HalGpioSimChip*)HAL_GpioChip_BackendPriv(chip, &s_sim_ops);
     HalGpioSimLine* ln = sim_find_line(c, offset);
     if (!ln || !out_logic) return HAL_GPIO_EINVAL;
 
@@ -158,3 +532,115 @@ HAL_GpioStatus HAL_GpioSim_GetOutput(HAL_GpioChip* chip, int offset, int* out_lo
     *out_logic = v;
     return HAL_GPIO_OK;
 }
+
+HAL_GpioStatus HAL_GpioSim_SetShape(HAL_GpioChip* chip, int offset, const HAL_GpioSimShape* shape)
+{
+    HalGpioSimChip* c = (HalGpioSimChip*)HAL_GpioChip_BackendPriv(chip, &s_sim_ops);
+    HalGpioSimLine* ln = sim_find_line(c, offset);
+    if (!ln) return HAL_GPIO_ENOENT;
+    if (shape && (shape->bounce_min > shape->bounce_max || shape->gap_min_us > shape->gap_max_us ||
+                  shape->glitch_min_us > shape->glitch_max_us || shape->glitch_hz < 0.0)) {
+        return HAL_GPIO_EINVAL;
+    }
+
+    pthread_mutex_lock(&c->mu);
+    uint64_t now = sim_now(c);
+    sim_sync(ln, now);
+    if (!shape) {
+        /* bỏ các cạnh đang chờ, về thẳng mức đích */
+        free(ln->sh);
+        ln->sh = NULL;
+        if (ln->value != ln->target) sim_edge(ln, now, 0);
+    } else {
+        HalGpioSimShaper* sh = ln->sh;
+        if (!sh) {
+            sh = (HalGpioSimShaper*)calloc(1, sizeof(*sh));
+            if (!sh) {
+                pthread_mutex_unlock(&c->mu);
+                return HAL_GPIO_EIO;
+            }
+            sh->last_us = now;
+            ln->sh = sh;
+        }
+        sh->shape = *shape;
+        sh->rng   = shape->seed ? shape->seed : 0x9E3779B9u * (uint32_t)(ln->offset + 1);
+        if (!sh->rng) sh->rng = 1;
+        sh->next_glitch_us = (shape->glitch_hz > 0.0) ? now + sim_glitch_gap(sh) : UINT64_MAX;
+    }
+    pthread_cond_broadcast(&c->cv);
+    pthread_mutex_unlock(&c->mu);
+    return HAL_GPIO_OK;
+}
+
+/* số liệu tham khảo (datasheet switch + đo thực tế), đủ để so sánh debouncer */
+HAL_GpioStatus HAL_GpioSim_ShapePreset(const char* name, HAL_GpioSimShape* out)
+{
+    static const struct { const char* name; HAL_GpioSimShape s; } k_presets[] = {
+        { "clean",   { 0 } },
+        /* nút tactile mới: vài lần nảy, tổng < ~1 ms */
+        { "tactile", { .bounce_min = 2, .bounce_max = 6,  .gap_dist = HAL_GPIO_SIM_DIST_EXP,
+                       .gap_min_us = 10, .gap_max_us = 300 } },
+        /* tiếp điểm mòn: nảy 5..20 ms, có khoảng hở tới 1.5 ms */
+        { "worn",    { .bounce_min = 4, .bounce_max = 12, .gap_dist = HAL_GPIO_SIM_DIST_EXP,
+                       .gap_min_us = 20, .gap_max_us = 1500 } },
+        /* tactile + nhiễu EMI (relay, motor gần dây) */
+        { "noisy",   { .bounce_min = 2, .bounce_max = 6,  .gap_dist = HAL_GPIO_SIM_DIST_EXP,
+                       .gap_min_us = 10, .gap_max_us = 300,
+                       .glitch_hz = 20.0, .glitch_min_us = 1, .glitch_max_us = 200 } },
+        /* lọc RC / cáp dài, không có Schmitt trigger: chatter quanh ngưỡng */
+        { "slow",    { .bounce_min = 0, .bounce_max = 2,  .gap_dist = HAL_GPIO_SIM_DIST_UNIFORM,
+                       .gap_min_us = 50, .gap_max_us = 200,
+                       .slow_edge_us = 4000, .slow_chatter = 4 } },
+    };
+    if (!name || !out) return HAL_GPIO_EINVAL;
+    for (size_t i = 0; i < sizeof(k_presets) / sizeof(k_presets[0]); ++i) {
+        if (strcmp(name, k_presets[i].name) == 0) {
+            *out = k_presets[i].s;
+            return HAL_GPIO_OK;
+        }
+    }
+    return HAL_GPIO_ENOENT;
+}
+
+HAL_GpioStatus HAL_GpioSim_UseVirtualTime(HAL_GpioChip* chip, uint64_t start_us)
+{
+    HalGpioSimChip* c = (HalGpioSimChip*)HAL_GpioChip_BackendPriv(chip, &s_sim_ops);
+    if (!c) return HAL_GPIO_EINVAL;
+    pthread_mutex_lock(&c->mu);
+    c->virt   = 1;
+    c->now_us = start_us;
+    pthread_mutex_unlock(&c->mu);
+    return HAL_GPIO_OK;
+}
+
+HAL_GpioStatus HAL_GpioSim_Advance(HAL_GpioChip* chip, uint64_t us)
+{
+    HalGpioSimChip* c = (HalGpioSimChip*)HAL_GpioChip_BackendPriv(chip, &s_sim_ops);
+    if (!c || !c->virt) return HAL_GPIO_EINVAL;
+    pthread_mutex_lock(&c->mu);
+    c->now_us += us;
+    pthread_mutex_unlock(&c->mu);
+    return HAL_GPIO_OK;
+}
+
+uint64_t HAL_GpioSim_Now(HAL_GpioChip* chip)
+{
+    HalGpioSimChip* c = (HalGpioSimChip*)HAL_GpioChip_BackendPriv(chip, &s_sim_ops);
+    if (!c) return 0;
+    pthread_mutex_lock(&c->mu);
+    uint64_t now = sim_now(c);
+    pthread_mutex_unlock(&c->mu);
+    return now;
+}
+
+HAL_GpioStatus HAL_GpioSim_GetStats(HAL_GpioChip* chip, int offset, HAL_GpioSimStats* out)
+{
+    HalGpioSimChip* c = (HalGpioSimChip*)HAL_GpioChip_BackendPriv(chip, &s_sim_ops);
+    HalGpioSimLine* ln = sim_find_line(c, offset);
+    if (!ln || !out) return HAL_GPIO_EINVAL;
+    pthread_mutex_lock(&c->mu);
+    sim_sync(ln, sim_now(c));
+    *out = ln->st;
+    pthread_mutex_unlock(&c->mu);
+    return HAL_GPIO_OK;
+}
@@ -0,0 +1,243 @@
+/**
+ * @file hal_gpio_uapi.c
+ * @brief Linux backend for HAL GPIO using the GPIO v2 character device uAPI
+ *        directly (scheme "uapi:"), no libgpiod needed.
+ *
+ * Notes:
+ *  - Một line = một request (GPIO_V2_GET_LINE_IOCTL) -> một fd; active-low,
+ *    bias, drive, edge do kernel xử lý nên read/write là giá trị logic.
+ *  - Debounce vẫn làm mềm trong HAL (giống backend gpiod) để hành vi giống nhau.
+ *  - Build trên kernel header không có v2 uAPI: file này rỗng (không đăng ký).
+ */
+#include "hal_gpio.h"
+#include "hal_gpio_backend.h"
+#include "hal_log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+#ifdef GPIO_V2_GET_LINE_IOCTL
+
+#define UAPI_EV_BATCH   64      /* event / read() trong ReadEvents */
+#define UAPI_EV_KBUF    256     /* hàng đợi event trong kernel / line có edge (mặc định 16) */
+
+typedef struct {
+    int  fd;
+    char name[80];
+    unsigned nlines;
+} UapiChip;
+
+typedef struct {
+    int      fd;            /* line request fd (cũng là event fd) */
+    int      dir_out;
+    int      have_event;
+    uint32_t debounce_ms;
+    uint64_t last_evt_ns;
+} UapiLine;
+
+static HAL_GpioStatus uapi_chip_open(const char* name, void** out_chip) {
+    if (!name || !name[0]) return HAL_GPIO_EINVAL;
+
+    char path[80];
+    if (name[0] == '/') snprintf(path, sizeof(path), "%s", name);
+    else                snprintf(path, sizeof(path), "/dev/%s", name);
+
+    int fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        HAL_LOGE("[GPIO][UAPI]", "open %s failed errno=%d", path, errno);
+        return HAL_GPIO_EIO;
+    }
+    struct gpiochip_info info;
+    memset(&info, 0, sizeof(info));
+    if (ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, &info) < 0) {
+        HAL_LOGE("[GPIO][UAPI]", "%s is not a gpiochip", path);
+        close(fd);
+        return HAL_GPIO_EIO;
+    }
+
+    UapiChip* c = (UapiChip*)calloc(1, sizeof(*c));
+    if (!c) { close(fd); return HAL_GPIO_EIO; }
+    c->fd     = fd;
+    c->nlines = info.lines;
+    snprintf(c->name, sizeof(c->name), "%s", path);
+    *out_chip = c;
+    return HAL_GPIO_OK;
+}
+
+static void uapi_chip_close(void* chip) {
+    UapiChip* c = (UapiChip*)chip;
+    close(c->fd);
+    free(c);
+}
+
+static int _resolve_offset_by_name(UapiChip* c, const char* name) {
+    for (unsigned off = 0; off < c->nlines; ++off) {
+        struct gpio_v2_line_info li;
+        memset(&li, 0, sizeof(li));
+        li.offset = off;
+        if (ioctl(c->fd, GPIO_V2_GET_LINEINFO_IOCTL, &li) == 0 && strcmp(li.name, name) == 0)
+            return (int)off;
+    }
+    return -1;
+}
+
+static HAL_GpioStatus uapi_line_request(void* chip, const HAL_GpioLineConfig* cfg, void** out_line) {
+    UapiChip* c = (UapiChip*)chip;
+
+    int offset = cfg->offset;
+    if (offset < 0 && cfg->name) offset = _resolve_offset_by_name(c, cfg->name);
+    if (offset < 0 || (unsigned)offset >= c->nlines) return HAL_GPIO_ENOENT;
+
+    struct gpio_v2_line_request req;
+    memset(&req, 0, sizeof(req));
+    req.offsets[0] = (uint32_t)offset;
+    req.num_lines  = 1;
+    strncpy(req.consumer, "hal_gpio", sizeof(req.consumer) - 1);
+
+    uint64_t fl = (cfg->active == HAL_GPIO_ACTIVE_LOW) ? GPIO_V2_LINE_FLAG_ACTIVE_LOW : 0;
+    switch (cfg->bias) {
+    case HAL_GPIO_BIAS_PULL_UP:   fl |= GPIO_V2_LINE_FLAG_BIAS_PULL_UP;   break;
+    case HAL_GPIO_BIAS_PULL_DOWN: fl |= GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN; break;
+    case HAL_GPIO_BIAS_DISABLE:   fl |= GPIO_V2_LINE_FLAG_BIAS_DISABLED;  break;
+    default: break;
+    }
+
+    if (cfg->dir == HAL_GPIO_DIR_OUT) {
+        fl |= GPIO_V2_LINE_FLAG_OUTPUT;
+        if (cfg->drive == HAL_GPIO_DRIVE_OPENDRAIN)  fl |= GPIO_V2_LINE_FLAG_OPEN_DRAIN;
+        if (cfg->drive == HAL_GPIO_DRIVE_OPENSOURCE) fl |= GPIO_V2_LINE_FLAG_OPEN_SOURCE;
+        req.config.num_attrs            = 1;
+        req.config.attrs[0].mask        = 1;
+        req.config.attrs[0].attr.id     = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+        req.config.attrs[0].attr.values = cfg->initial ? 1 : 0;
+    } else {
+        fl |= GPIO_V2_LINE_FLAG_INPUT;
+        if (cfg->edge == HAL_GPIO_EDGE_RISING  || cfg->edge == HAL_GPIO_EDGE_BOTH) fl |= GPIO_V2_LINE_FLAG_EDGE_RISING;
+        if (cfg->edge == HAL_GPIO_EDGE_FALLING || cfg->edge == HAL_GPIO_EDGE_BOTH) fl |= GPIO_V2_LINE_FLAG_EDGE_FALLING;
+        /* encoder/tacho ra hàng chục kHz cạnh: 16 event mặc định tràn chỉ sau vài trăm µs trễ */
+        if (cfg->edge != HAL_GPIO_EDGE_NONE) req.event_buffer_size = UAPI_EV_KBUF;
+    }
+    req.config.flags = fl;
+
+    if (ioctl(c->fd, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+        HAL_LOGE("[GPIO][UAPI]", "request %s:%d failed errno=%d", c->name, offset, errno);
+        return HAL_GPIO_EIO;
+    }
+
+    UapiLine* l = (UapiLine*)calloc(1, sizeof(*l));
+    if (!l) { close(req.fd); return HAL_GPIO_EIO; }
+    l->fd          = req.fd;
+    l->dir_out     = (cfg->dir == HAL_GPIO_DIR_OUT);
+    l->have_event  = (!l->dir_out && cfg->edge != HAL_GPIO_EDGE_NONE);
+    l->debounce_ms = cfg->debounce_ms;
+    *out_line = l;
+    return HAL_GPIO_OK;
+}
+
+static void uapi_line_release(void* line) {
+    UapiLine* l = (UapiLine*)line;
+    close(l->fd);
+    free(l);
+}
+
+static HAL_GpioStatus uapi_line_write(void* line, int value) {
+    UapiLine* l = (UapiLine*)line;
+    if (!l->dir_out) return HAL_GPIO_EINVAL;
+    struct gpio_v2_line_values v = { .bits = value ? 1u : 0u, .mask = 1u };
+    return (ioctl(l->fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &v) < 0) ? HAL_GPIO_EIO : HAL_GPIO_OK;
+}
+
+static HAL_GpioStatus uapi_line_read(void* line, int* out) {
+    UapiLine* l = (UapiLine*)line;
+    struct gpio_v2_line_values v = { .bits = 0, .mask = 1u };
+    if (ioctl(l->fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &v) < 0) return HAL_GPIO_EIO;
+    *out = (int)(v.bits & 1u);
+    return HAL_GPIO_OK;
+}
+
+static HAL_GpioStatus uapi_line_wait_event(void* line, int timeout_ms, HAL_GpioEvent* out_ev) {
+    UapiLine* l = (UapiLine*)line;
+    if (!l->have_event) return HAL_GPIO_ENOSUP;
+
+    struct pollfd pfd = { .fd = l->fd, .events = POLLIN };
+    int rc = poll(&pfd, 1, timeout_ms);
+    if (rc < 0)  return HAL_GPIO_EIO;
+    if (rc == 0) return HAL_GPIO_ENOENT;    /* timeout */
+
+    struct gpio_v2_line_event ev;
+    if (read(l->fd, &ev, sizeof(ev)) != (ssize_t)sizeof(ev)) return HAL_GPIO_EIO;
+
+    /* Soft debounce (giống backend gpiod) */
+    if (l->debounce_ms > 0 && l->last_evt_ns != 0) {
+        uint64_t dt = (ev.timestamp_ns > l->last_evt_ns) ? (ev.timestamp_ns - l->last_evt_ns) : 0;
+        if (dt < (uint64_t)l->debounce_ms * 1000000ull) return HAL_GPIO_ENOENT;
+    }
+    l->last_evt_ns = ev.timestamp_ns;
+
+    if (out_ev) {
+        out_ev->timestamp_ns = ev.timestamp_ns;
+        out_ev->edge = (ev.id == GPIO_V2_LINE_EVENT_RISING_EDGE) ? HAL_GPIO_EDGE_RISING : HAL_GPIO_EDGE_FALLING;
+    }
+    return HAL_GPIO_OK;
+}
+
+/* Cả lô: một read() lấy mọi event kernel đang giữ (tối đa max) */
+static HAL_GpioStatus uapi_line_read_events(void* line, int timeout_ms, HAL_GpioEvent* out,
+                                            size_t max, size_t* out_n) {
+    UapiLine* l = (UapiLine*)line;
+    if (!l->have_event) return HAL_GPIO_ENOSUP;
+
+    struct pollfd pfd = { .fd = l->fd, .events = POLLIN };
+    int rc = poll(&pfd, 1, timeout_ms);
+    if (rc < 0)  return HAL_GPIO_EIO;
+    if (rc == 0) return HAL_GPIO_ENOENT;
+
+    struct gpio_v2_line_event evs[UAPI_EV_BATCH];
+    if (max > UAPI_EV_BATCH) max = UAPI_EV_BATCH;
+    ssize_t r = read(l->fd, evs, max * sizeof(evs[0]));
+    if (r < (ssize_t)sizeof(evs[0])) return HAL_GPIO_EIO;
+
+    size_t n = 0;
+    for (size_t i = 0; i < (size_t)r / sizeof(evs[0]); ++i) {
+        if (l->debounce_ms > 0 && l->last_evt_ns != 0) {
+            uint64_t dt = (evs[i].timestamp_ns > l->last_evt_ns) ? (evs[i].timestamp_ns - l->last_evt_ns) : 0;
+            if (dt < (uint64_t)l->debounce_ms * 1000000ull) continue;
+        }
+        l->last_evt_ns = evs[i].timestamp_ns;
+        out[n].timestamp_ns = evs[i].timestamp_ns;
+        out[n].edge = (evs[i].id == GPIO_V2_LINE_EVENT_RISING_EDGE) ? HAL_GPIO_EDGE_RISING : HAL_GPIO_EDGE_FALLING;
+        ++n;
+    }
+    *out_n = n;
+    return n ? HAL_GPIO_OK : HAL_GPIO_ENOENT;
+}
+
+static int uapi_line_event_fd(void* line) {
+    UapiLine* l = (UapiLine*)line;
+    return l->have_event ? l->fd : -1;
+}
+
+static const HAL_GpioOps s_uapi_ops = {
+    .scheme          = "uapi",
+    .priority        = 10,
+    .chip_open       = uapi_chip_open,
+    .chip_close      = uapi_chip_close,
+    .line_request    = uapi_line_request,
+    .line_release    = uapi_line_release,
+    .line_write      = uapi_line_write,
+    .line_read       = uapi_line_read,
+    .line_wait_event = uapi_line_wait_event,
+    .line_event_fd   = uapi_line_event_fd,
+    .line_read_events = uapi_line_read_events,
+    .kernel_io       = 1,
+};
+HAL_GPIO_BACKEND_REGISTER(s_uapi_ops)
+
+#endif /* GPIO_V2_GET_LINE_IOCTL */
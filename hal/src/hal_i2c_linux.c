@@ -17,6 +17,7 @@
  */
 
 #include "hal_i2c.h"
+#include "hal_log.h"
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -28,6 +29,9 @@
 
 #include <linux/i2c-dev.h>   // I2C_SLAVE, etc.
 
+#include "hal_metrics.h"
+#include "hal_rec.h"
+
 /* ------------------------------
  * Internal HAL_I2cBus definition
  * ------------------------------ */
@@ -36,19 +40,56 @@ struct HAL_I2cBus {
     int      fd;             // file descriptor for /dev/i2c-X
     char     dev_name[64];   // "/dev/i2c-0" etc
     uint32_t speed_hz_hint;  // we keep this for info only
+    uint8_t  addr;           // slave hiện tại (dùng khi ghi/replay)
+    uint16_t rec_chan;       // kênh ghi, 0xFFFF = không ghi
+    int      rp_chan;        // kênh replay, -1 = bus thật
+#if HAL_METRICS
+    uint16_t mx;             // hal_metrics id ("i2c:<dev>")
+#endif
 };
 
 /* Helper: do ioctl to select which slave address we're talking to right now */
 static HAL_I2cStatus _i2c_set_addr(struct HAL_I2cBus* bus, uint8_t addr7) {
     if (!bus) return HAL_I2C_EINVAL;
-    if (ioctl(bus->fd, I2C_SLAVE, addr7) < 0) {
-        printf("[I2C][LINUX] ioctl(I2C_SLAVE,0x%02X) failed errno=%d\r\n",
+    bus->addr = addr7;
+    if (bus->rp_chan >= 0) return HAL_I2C_OK;
+    HAL_MX_T0(t0);
+    int rc = ioctl(bus->fd, I2C_SLAVE, addr7);
+    HAL_MX_REC(bus->mx, t0, rc < 0, 0, 1);
+    if (rc < 0) {
+        HAL_LOGE("[I2C][LINUX]", "ioctl(I2C_SLAVE,0x%02X) failed errno=%d",
                  addr7, errno);
         return HAL_I2C_ENODEV; // often errno=ENODEV or EBUSY if NACK or locked
     }
     return HAL_I2C_OK;
 }
 
+/* Mọi transfer đi qua 2 hàm này để record/replay cùng một chỗ.
+ * Trả về như write()/read(). */
+static ssize_t _i2c_wr(struct HAL_I2cBus* bus, const void* buf, size_t len) {
+    if (bus->rp_chan >= 0)
+        return HAL_Replay_Expect(bus->rp_chan, HAL_REC_I2C_WR, &bus->addr, 1, buf, len, NULL);
+    HAL_MX_T0(t0);
+    ssize_t w = write(bus->fd, buf, len);
+    HAL_MX_REC(bus->mx, t0, w < 0, (w > 0) ? w : 0, 1);
+    HAL_Rec_Put(HAL_REC_I2C_WR, bus->rec_chan, (int32_t)w, &bus->addr, 1, buf, len);
+    return w;
+}
+
+static ssize_t _i2c_rd(struct HAL_I2cBus* bus, void* buf, size_t len) {
+    if (bus->rp_chan >= 0) {
+        HAL_RecEntry e;
+        if (HAL_Replay_Next(bus->rp_chan, HAL_REC_I2C_RD, -1, &e) != 0) return -1;
+        memcpy(buf, e.b, (e.blen < len) ? e.blen : len);
+        return e.status;
+    }
+    HAL_MX_T0(t0);
+    ssize_t r = read(bus->fd, buf, len);
+    HAL_MX_REC(bus->mx, t0, r < 0, (r > 0) ? r : 0, 1);
+    HAL_Rec_Put(HAL_REC_I2C_RD, bus->rec_chan, (int32_t)r, &bus->addr, 1, buf, (r > 0) ? (size_t)r : 0);
+    return r;
+}
+
 /* ------------------------------
  * Bus open/close/info
  * ------------------------------ */
@@ -66,9 +107,29 @@ HAL_I2cBus* HAL_I2cBus_Open(const HAL_I2cBusConfig* cfg, HAL_I2cStatus* out_stat
         return NULL;
     }
 
+    char chan[80];
+    const char* rp = HAL_Replay_Target(cfg->bus_name);
+    bus->rec_chan = 0xFFFF;
+    bus->rp_chan  = -1;
+    if (rp) {
+        snprintf(chan, sizeof(chan), "i2c:%s", rp);
+        bus->rp_chan = HAL_Replay_Channel(chan);
+        if (bus->rp_chan < 0) {
+            HAL_LOGE("[I2C][REPLAY]", "%s not in recording", chan);
+            free(bus);
+            if (out_status) *out_status = HAL_I2C_EBUS;
+            return NULL;
+        }
+        bus->fd = -1;
+        strncpy(bus->dev_name, rp, sizeof(bus->dev_name)-1);
+        bus->speed_hz_hint = cfg->bus_speed_hz;
+        if (out_status) *out_status = HAL_I2C_OK;
+        return bus;
+    }
+
     int fd = open(cfg->bus_name, O_RDWR);
     if (fd < 0) {
-        printf("[I2C][LINUX] open %s failed errno=%d\r\n", cfg->bus_name, errno);
+        HAL_LOGE("[I2C][LINUX]", "open %s failed errno=%d", cfg->bus_name, errno);
         free(bus);
         if (out_status) *out_status = HAL_I2C_EBUS;
         return NULL;
@@ -77,8 +138,13 @@ HAL_I2cBus* HAL_I2cBus_Open(const HAL_I2cBusConfig* cfg, HAL_I2cStatus* out_stat
     bus->fd = fd;
     bus->speed_hz_hint = cfg->bus_speed_hz;
     strncpy(bus->dev_name, cfg->bus_name, sizeof(bus->dev_name)-1);
+    if (HAL_Rec_Active()) {
+        snprintf(chan, sizeof(chan), "i2c:%s", cfg->bus_name);
+        bus->rec_chan = HAL_Rec_Channel(chan);
+    }
+    HAL_MX_OPEN(bus->mx, HAL_METRICS_I2C, "i2c:%s", cfg->bus_name);
 
-    printf("[I2C][LINUX] opened %s (speed hint %u Hz)\r\n",
+    HAL_LOGI("[I2C][LINUX]", "opened %s (speed hint %u Hz)",
              bus->dev_name, (unsigned)bus->speed_hz_hint);
 
     if (out_status) *out_status = HAL_I2C_OK;
@@ -135,7 +201,7 @@ HAL_I2cStatus HAL_I2c_Probe(HAL_I2cBus* bus, uint8_t addr7)
     }
 
     uint8_t dummy;
-    ssize_t r = read(bus->fd, &dummy, 1);
+    ssize_t r = _i2c_rd(bus, &dummy, 1);
     if (r == 1 || r == 0) {
         // device responded somehow (some devices allow direct read,
         // others might just return 0 bytes)
@@ -159,9 +225,9 @@ HAL_I2cStatus HAL_I2c_Write(HAL_I2cBus* bus,
     HAL_I2cStatus st = _i2c_set_addr(bus, addr7);
     if (st != HAL_I2C_OK) return st;
 
-    ssize_t w = write(bus->fd, data_out, len);
+    ssize_t w = _i2c_wr(bus, data_out, len);
     if ((size_t)w != len) {
-        printf("[I2C][LINUX] Write addr=0x%02X len=%u failed (errno=%d wrote=%d)\r\n",
+        HAL_LOGE("[I2C][LINUX]", "Write addr=0x%02X len=%u failed (errno=%d wrote=%d)",
                  addr7, (unsigned)len, errno, (int)w);
         return HAL_I2C_EIO;
     }
@@ -177,9 +243,9 @@ HAL_I2cStatus HAL_I2c_Read(HAL_I2cBus* bus,
     HAL_I2cStatus st = _i2c_set_addr(bus, addr7);
     if (st != HAL_I2C_OK) return st;
 
-    ssize_t r = read(bus->fd, data_in, len);
+    ssize_t r = _i2c_rd(bus, data_in, len);
     if ((size_t)r != len) {
-        printf("[I2C][LINUX] Read addr=0x%02X len=%u failed (errno=%d read=%d)\r\n",
+        HAL_LOGE("[I2C][LINUX]", "Read addr=0x%02X len=%u failed (errno=%d read=%d)",
                  addr7, (unsigned)len, errno, (int)r);
         return HAL_I2C_EIO;
     }
@@ -209,9 +275,9 @@ HAL_I2cStatus HAL_I2c_WriteReg8(HAL_I2cBus* bus,
     buf[0] = reg;
     memcpy(&buf[1], data_out, len);
 
-    ssize_t w = write(bus->fd, buf, len + 1);
+    ssize_t w = _i2c_wr(bus, buf, len + 1);
     if ((size_t)w != (len + 1)) {
-        printf("[I2C][LINUX] WriteReg8 addr=0x%02X reg=0x%02X len=%u failed (errno=%d wrote=%d)\r\n",
+        HAL_LOGE("[I2C][LINUX]", "WriteReg8 addr=0x%02X reg=0x%02X len=%u failed (errno=%d wrote=%d)",
                  addr7, reg, (unsigned)len, errno, (int)w);
         return HAL_I2C_EIO;
     }
@@ -233,17 +299,17 @@ HAL_I2cStatus HAL_I2c_ReadReg8(HAL_I2cBus* bus,
     // 1) Write the register pointer (no stop condition in Linux userspace;
     //    Actually i2c-dev will send a STOP after write() and then a repeated
     //    START before read(), but for 99% sensors this is fine.)
-    ssize_t w = write(bus->fd, &reg, 1);
+    ssize_t w = _i2c_wr(bus, &reg, 1);
     if (w != 1) {
-        printf("[I2C][LINUX] ReadReg8(addr=0x%02X) set reg=0x%02X failed errno=%d wrote=%d\r\n",
+        HAL_LOGE("[I2C][LINUX]", "ReadReg8(addr=0x%02X) set reg=0x%02X failed errno=%d wrote=%d",
                  addr7, reg, errno, (int)w);
         return HAL_I2C_EIO;
     }
 
     // 2) Read data bytes
-    ssize_t r = read(bus->fd, data_in, len);
+    ssize_t r = _i2c_rd(bus, data_in, len);
     if ((size_t)r != len) {
-        printf("[I2C][LINUX] ReadReg8 addr=0x%02X reg=0x%02X len=%u readfail errno=%d read=%d\r\n",
+        HAL_LOGE("[I2C][LINUX]", "ReadReg8 addr=0x%02X reg=0x%02X len=%u readfail errno=%d read=%d",
                  addr7, reg, (unsigned)len, errno, (int)r);
         return HAL_I2C_EIO;
     }
@@ -276,9 +342,9 @@ HAL_I2cStatus HAL_I2c_WriteReg16(HAL_I2cBus* bus,
     buf[1] = (uint8_t)(reg16 & 0xFF);
     memcpy(&buf[2], data_out, len);
 
-    ssize_t w = write(bus->fd, buf, len + 2);
+    ssize_t w = _i2c_wr(bus, buf, len + 2);
     if ((size_t)w != (len + 2)) {
-        printf("[I2C][LINUX] WriteReg16 addr=0x%02X reg16=0x%04X len=%u failed errno=%d wrote=%d\r\n",
+        HAL_LOGE("[I2C][LINUX]", "WriteReg16 addr=0x%02X reg16=0x%04X len=%u failed errno=%d wrote=%d",
                  addr7, reg16, (unsigned)len, errno, (int)w);
         return HAL_I2C_EIO;
     }
@@ -302,17 +368,17 @@ HAL_I2cStatus HAL_I2c_ReadReg16(HAL_I2cBus* bus,
     addrbuf[1] = (uint8_t)(reg16 & 0xFF);
 
     // write 16-bit register pointer
-    ssize_t w = write(bus->fd, addrbuf, 2);
+    ssize_t w = _i2c_wr(bus, addrbuf, 2);
     if (w != 2) {
-        printf("[I2C][LINUX] ReadReg16 set reg16=0x%04X failed errno=%d wrote=%d\r\n",
+        HAL_LOGE("[I2C][LINUX]", "ReadReg16 set reg16=0x%04X failed errno=%d wrote=%d",
                  reg16, errno, (int)w);
         return HAL_I2C_EIO;
     }
 
     // read response
-    ssize_t r = read(bus->fd, data_in, len);
+    ssize_t r = _i2c_rd(bus, data_in, len);
     if ((size_t)r != len) {
-        printf("[I2C][LINUX] ReadReg16 addr=0x%02X reg16=0x%04X len=%u readfail errno=%d read=%d\r\n",
+        HAL_LOGE("[I2C][LINUX]", "ReadReg16 addr=0x%02X reg16=0x%04X len=%u readfail errno=%d read=%d",
                  addr7, reg16, (unsigned)len, errno, (int)r);
         return HAL_I2C_EIO;
     }
@@ -356,18 +422,18 @@ HAL_I2cStatus HAL_I2c_BurstTransfer(HAL_I2cBus* bus,
     if (st != HAL_I2C_OK) return st;
 
     if (tx_buf && tx_len > 0) {
-        ssize_t w = write(bus->fd, tx_buf, tx_len);
+        ssize_t w = _i2c_wr(bus, tx_buf, tx_len);
         if ((size_t)w != tx_len) {
-            printf("[I2C][LINUX] BurstTransfer write addr=0x%02X tx_len=%u failed errno=%d wrote=%d\r\n",
+            HAL_LOGE("[I2C][LINUX]", "BurstTransfer write addr=0x%02X tx_len=%u failed errno=%d wrote=%d",
                      addr7, (unsigned)tx_len, errno, (int)w);
             return HAL_I2C_EIO;
         }
     }
 
     if (rx_buf && rx_len > 0) {
-        ssize_t r = read(bus->fd, rx_buf, rx_len);
+        ssize_t r = _i2c_rd(bus, rx_buf, rx_len);
         if ((size_t)r != rx_len) {
-            printf("[I2C][LINUX] BurstTransfer read addr=0x%02X rx_len=%u failed errno=%d read=%d\r\n",
+            HAL_LOGE("[I2C][LINUX]", "BurstTransfer read addr=0x%02X rx_len=%u failed errno=%d read=%d",
                      addr7, (unsigned)rx_len, errno, (int)r);
             return HAL_I2C_EIO;
         }
@@ -0,0 +1,173 @@
+/**
+ * @file hal_log.c
+ * @brief Level, rate limit theo call site và các sink của log HAL (xem hal_log.h).
+ */
+#define _GNU_SOURCE
+#include "hal_log.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+volatile int g_hal_log_level = -2;
+
+static pthread_mutex_t s_site_lock = PTHREAD_MUTEX_INITIALIZER;   /* chỉ phép tính token, không I/O */
+static HAL_LogSink     s_sink;
+static void*           s_sink_ctx;
+static uint64_t        s_rate_limited;
+static uint64_t        s_ring_dropped;
+
+/* ring không chặn: producer trylock, đầy/tranh chấp thì bỏ dòng */
+static pthread_mutex_t s_ring_lock = PTHREAD_MUTEX_INITIALIZER;
+static char*           s_ring;
+static size_t          s_ring_size;
+static size_t          s_ring_head, s_ring_tail;                  /* tăng dần, chia lấy dư khi truy cập */
+
+static void _level_init(void) {
+    const char* e = getenv("HAL_LOG_LEVEL");
+    int lvl = HAL_LOG_INFO;
+    if (e) {
+        if      (!strcasecmp(e, "off"))   lvl = HAL_LOG_OFF;
+        else if (!strcasecmp(e, "err") || !strcasecmp(e, "error")) lvl = HAL_LOG_ERR;
+        else if (!strcasecmp(e, "warn"))  lvl = HAL_LOG_WARN;
+        else if (!strcasecmp(e, "info"))  lvl = HAL_LOG_INFO;
+        else if (!strcasecmp(e, "debug")) lvl = HAL_LOG_DEBUG;
+    }
+    int unset = -2;
+    __atomic_compare_exchange_n(&g_hal_log_level, &unset, lvl, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+void HAL_Log_SetLevel(HAL_LogLevel lvl) {
+    __atomic_store_n(&g_hal_log_level, (int)lvl, __ATOMIC_RELAXED);
+}
+
+HAL_LogLevel HAL_Log_GetLevel(void) {
+    if (g_hal_log_level == -2) _level_init();
+    return (HAL_LogLevel)g_hal_log_level;
+}
+
+void HAL_Log_SetSink(HAL_LogSink fn, void* ctx) {
+    s_sink_ctx = ctx;
+    __atomic_store_n(&s_sink, fn, __ATOMIC_RELEASE);
+}
+
+int HAL_Log_UseRing(size_t bytes) {
+    char* buf = bytes ? (char*)malloc(bytes) : NULL;
+    if (bytes && !buf) return -1;
+    pthread_mutex_lock(&s_ring_lock);
+    char* old = s_ring;
+    s_ring      = buf;
+    s_ring_size = bytes;
+    s_ring_head = s_ring_tail = 0;
+    pthread_mutex_unlock(&s_ring_lock);
+    free(old);
+    return 0;
+}
+
+size_t HAL_Log_Drain(int fd) {
+    char chunk[1024];
+    size_t total = 0;
+    for (;;) {
+        /* copy ra ngoài rồi mới write: producer không bao giờ chờ I/O của drain */
+        pthread_mutex_lock(&s_ring_lock);
+        size_t n = s_ring ? s_ring_head - s_ring_tail : 0;
+        if (n > sizeof(chunk)) n = sizeof(chunk);
+        for (size_t i = 0; i < n; ++i) chunk[i] = s_ring[(s_ring_tail + i) % s_ring_size];
+        s_ring_tail += n;
+        pthread_mutex_unlock(&s_ring_lock);
+        if (!n) break;
+        if (write(fd, chunk, n) < 0) break;
+        total += n;
+    }
+    return total;
+}
+
+void HAL_Log_Stats(uint64_t* rate_limited, uint64_t* ring_dropped) {
+    if (rate_limited) *rate_limited = __atomic_load_n(&s_rate_limited, __ATOMIC_RELAXED);
+    if (ring_dropped) *ring_dropped = __atomic_load_n(&s_ring_dropped, __ATOMIC_RELAXED);
+}
+
+/* token bucket của call site; trả về số dòng đã bỏ trước dòng này, -1 nếu dòng này cũng bị bỏ */
+static long _site_admit(HAL_LogSite* site) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    uint64_t now    = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+    uint64_t period = 1000000000ull / (HAL_LOG_PER_SEC > 0 ? HAL_LOG_PER_SEC : 1);
+    long ret;
+
+    pthread_mutex_lock(&s_site_lock);
+    if (site->last_ns == 0) {
+        site->last_ns = now ? now : 1;
+        site->tokens  = HAL_LOG_BURST;
+    } else if (now > site->last_ns) {
+        uint64_t refill = (now - site->last_ns) / period;
+        if (refill) {
+            uint64_t t = site->tokens + refill;
+            site->tokens  = (t > HAL_LOG_BURST) ? HAL_LOG_BURST : (uint32_t)t;
+            site->last_ns += refill * period;
+        }
+    }
+    if (site->tokens == 0) {
+        site->suppressed++;
+        ret = -1;
+    } else {
+        site->tokens--;
+        ret = (long)site->suppressed;
+        site->suppressed = 0;
+    }
+    pthread_mutex_unlock(&s_site_lock);
+    if (ret < 0) __atomic_add_fetch(&s_rate_limited, 1, __ATOMIC_RELAXED);
+    return ret;
+}
+
+static void _ring_put(const char* line, size_t n) {
+    if (pthread_mutex_trylock(&s_ring_lock) != 0) {
+        __atomic_add_fetch(&s_ring_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    if (!s_ring || s_ring_size - (s_ring_head - s_ring_tail) < n) {
+        pthread_mutex_unlock(&s_ring_lock);
+        __atomic_add_fetch(&s_ring_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) s_ring[(s_ring_head + i) % s_ring_size] = line[i];
+    s_ring_head += n;
+    pthread_mutex_unlock(&s_ring_lock);
+}
+
+void HAL_Log_Write(HAL_LogSite* site, HAL_LogLevel lvl, const char* tag, const char* fmt, ...) {
+    if (g_hal_log_level == -2) _level_init();
+    if ((int)lvl > g_hal_log_level) return;
+    long dropped = _site_admit(site);
+    if (dropped < 0) return;
+
+    char msg[HAL_LOG_LINE_MAX];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if ((size_t)n >= sizeof(msg)) n = (int)sizeof(msg) - 1;
+    if (dropped > 0) snprintf(msg + n, sizeof(msg) - (size_t)n, " (+%ld suppressed)", dropped);
+
+    HAL_LogSink sink = __atomic_load_n(&s_sink, __ATOMIC_ACQUIRE);
+    if (sink) {
+        sink(s_sink_ctx, lvl, tag ? tag : "", msg);
+        return;
+    }
+    char line[HAL_LOG_LINE_MAX + 64];
+    int len = snprintf(line, sizeof(line), "%s %s\r\n", tag ? tag : "", msg);
+    if (len < 0) return;
+    if ((size_t)len >= sizeof(line)) len = (int)sizeof(line) - 1;
+    if (__atomic_load_n(&s_ring, __ATOMIC_RELAXED)) {
+        _ring_put(line, (size_t)len);
+    } else {
+        /* một write() cho cả dòng: không lock stdio, các thread không xen giữa dòng */
+        if (write(STDERR_FILENO, line, (size_t)len) < 0) { /* không có chỗ nào để báo */ }
+    }
+}
@@ -0,0 +1,271 @@
+/**
+ * @file hal_metrics.c
+ * @brief Registry tên handle + shard bộ đếm theo thread (xem hal_metrics.h).
+ */
+#define _GNU_SOURCE
+#include "hal_metrics.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+uint64_t HAL_Metrics_Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+const char* HAL_Metrics_ClassName(HAL_MetricsClass cls) {
+    switch (cls) {
+        case HAL_METRICS_GPIO_CHIP: return "gpiochip";
+        case HAL_METRICS_GPIO_LINE: return "gpio";
+        case HAL_METRICS_UART:      return "uart";
+        case HAL_METRICS_I2C:       return "i2c";
+        case HAL_METRICS_SPI:       return "spi";
+        default:                    return "other";
+    }
+}
+
+uint64_t HAL_Metrics_Percentile(const HAL_MetricsCounters* c, double p) {
+    uint64_t n = 0;
+    for (int i = 0; i < HAL_METRICS_BUCKETS; ++i) n += c->hist[i];
+    if (!n) return 0;
+    uint64_t want = (uint64_t)(p * (double)n);
+    if (want >= n) want = n - 1;
+    uint64_t acc = 0;
+    for (int i = 0; i < HAL_METRICS_BUCKETS; ++i) {
+        acc += c->hist[i];
+        if (acc > want) return 1ull << i;
+    }
+    return 1ull << (HAL_METRICS_BUCKETS - 1);
+}
+
+#if HAL_METRICS
+
+typedef struct HalMxShard {
+    HAL_MetricsCounters cell[HAL_METRICS_MAX_HANDLES];
+    struct HalMxShard*  next;
+    int                 in_use;      ///< có thread sở hữu (s_lock)
+} HalMxShard;
+
+typedef struct {
+    char             name[48];
+    HAL_MetricsClass cls;
+} HalMxName;
+
+static pthread_mutex_t     s_lock = PTHREAD_MUTEX_INITIALIZER;
+static HalMxName           s_names[HAL_METRICS_MAX_HANDLES];
+static unsigned            s_nnames;                      /* đọc không lock: acquire */
+static HalMxShard*         s_shards;                      /* chỉ thêm, không bao giờ free */
+static HAL_MetricsCounters s_base[HAL_METRICS_MAX_HANDLES];
+static pthread_key_t       s_key;
+static pthread_once_t      s_key_once = PTHREAD_ONCE_INIT;
+static __thread HalMxShard* t_shard;
+#if HAL_METRICS_SAMPLE_LOG2 > 0
+static __thread unsigned    t_sample;
+#endif
+
+static void _shard_release(void* p) {
+    pthread_mutex_lock(&s_lock);
+    ((HalMxShard*)p)->in_use = 0;
+    pthread_mutex_unlock(&s_lock);
+}
+
+static void _key_init(void) {
+    pthread_key_create(&s_key, _shard_release);
+}
+
+static HalMxShard* _shard_attach(void) {
+    pthread_once(&s_key_once, _key_init);
+    pthread_mutex_lock(&s_lock);
+    HalMxShard* s = s_shards;
+    while (s && s->in_use) s = s->next;
+    if (!s) {
+        void* p = NULL;
+        if (posix_memalign(&p, 64, sizeof(HalMxShard)) == 0) {
+            s = (HalMxShard*)p;
+            memset(s, 0, sizeof(*s));
+            s->next = s_shards;
+            __atomic_store_n(&s_shards, s, __ATOMIC_RELEASE);
+        }
+    }
+    if (s) s->in_use = 1;
+    pthread_mutex_unlock(&s_lock);
+    if (s) pthread_setspecific(s_key, s);
+    t_shard = s;
+    return s;
+}
+
+static int _bucket(uint64_t ns) {
+    if (!ns) return 0;
+    int b = 64 - __builtin_clzll(ns);
+    return (b < HAL_METRICS_BUCKETS) ? b : HAL_METRICS_BUCKETS - 1;
+}
+
+/* chỉ thread sở hữu shard ghi: load + store relaxed là đủ (không cần lock add) */
+static inline void _add(uint64_t* p, uint64_t v) {
+    __atomic_store_n(p, __atomic_load_n(p, __ATOMIC_RELAXED) + v, __ATOMIC_RELAXED);
+}
+
+uint64_t HAL_Metrics_Start(void) {
+#if HAL_METRICS_SAMPLE_LOG2 > 0
+    if ((t_sample++ & ((1u << HAL_METRICS_SAMPLE_LOG2) - 1u)) != 0) return 0;
+#endif
+    return HAL_Metrics_Now();
+}
+
+uint16_t HAL_Metrics_Handle(HAL_MetricsClass cls, const char* name) {
+    if (!name) return 0;
+    pthread_mutex_lock(&s_lock);
+    if (s_nnames == 0) {
+        snprintf(s_names[0].name, sizeof(s_names[0].name), "(overflow)");
+        s_names[0].cls = HAL_METRICS_OTHER;
+        __atomic_store_n(&s_nnames, 1u, __ATOMIC_RELEASE);
+    }
+    uint16_t id = 0;
+    for (unsigned i = 1; i < s_nnames; ++i)
+        if (strncmp(s_names[i].name, name, sizeof(s_names[i].name) - 1) == 0) { id = (uint16_t)i; break; }
+    if (!id && s_nnames < HAL_METRICS_MAX_HANDLES) {
+        id = (uint16_t)s_nnames;
+        snprintf(s_names[id].name, sizeof(s_names[id].name), "%s", name);
+        s_names[id].cls = cls;
+        __atomic_store_n(&s_nnames, s_nnames + 1u, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&s_lock);
+    return id;
+}
+
+uint16_t HAL_Metrics_Handlef(HAL_MetricsClass cls, const char* fmt, ...) {
+    char name[48];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(name, sizeof(name), fmt, ap);
+    va_end(ap);
+    return HAL_Metrics_Handle(cls, name);
+}
+
+void HAL_Metrics_Record(uint16_t id, uint64_t t0_ns, int error, uint64_t bytes, uint32_t syscalls) {
+    HalMxShard* s = t_shard ? t_shard : _shard_attach();
+    if (!s || id >= HAL_METRICS_MAX_HANDLES) return;
+    HAL_MetricsCounters* c = &s->cell[id];
+    _add(&c->ops, 1);
+    if (bytes)    _add(&c->bytes, bytes);
+    if (error)    _add(&c->errors, 1);
+    if (syscalls) _add(&c->syscalls, syscalls);
+    if (t0_ns) {
+        uint64_t now = HAL_Metrics_Now();
+        uint64_t dt  = (now > t0_ns) ? now - t0_ns : 0;
+        _add(&c->lat_n, 1);
+        _add(&c->lat_sum_ns, dt);
+        _add(&c->hist[_bucket(dt)], 1);
+    }
+}
+
+int HAL_Metrics_Enabled(void) { return 1; }
+
+static void _sum(unsigned id, HAL_MetricsCounters* out) {
+    memset(out, 0, sizeof(*out));
+    for (HalMxShard* s = __atomic_load_n(&s_shards, __ATOMIC_ACQUIRE); s; s = s->next) {
+        const HAL_MetricsCounters* c = &s->cell[id];
+        out->ops        += __atomic_load_n(&c->ops,        __ATOMIC_RELAXED);
+        out->bytes      += __atomic_load_n(&c->bytes,      __ATOMIC_RELAXED);
+        out->errors     += __atomic_load_n(&c->errors,     __ATOMIC_RELAXED);
+        out->syscalls   += __atomic_load_n(&c->syscalls,   __ATOMIC_RELAXED);
+        out->lat_n      += __atomic_load_n(&c->lat_n,      __ATOMIC_RELAXED);
+        out->lat_sum_ns += __atomic_load_n(&c->lat_sum_ns, __ATOMIC_RELAXED);
+        for (int b = 0; b < HAL_METRICS_BUCKETS; ++b)
+            out->hist[b] += __atomic_load_n(&c->hist[b], __ATOMIC_RELAXED);
+    }
+}
+
+static void _sub(HAL_MetricsCounters* a, const HAL_MetricsCounters* b) {
+    uint64_t* pa = (uint64_t*)a;
+    const uint64_t* pb = (const uint64_t*)b;
+    for (size_t i = 0; i < sizeof(*a) / sizeof(uint64_t); ++i) pa[i] = (pa[i] > pb[i]) ? pa[i] - pb[i] : 0;
+}
+
+int HAL_Metrics_Snapshot(HAL_MetricsSnapshot* out, int max) {
+    unsigned n = __atomic_load_n(&s_nnames, __ATOMIC_ACQUIRE);
+    pthread_mutex_lock(&s_lock);             /* chỉ để s_base/s_names ổn định, writer không lock */
+    for (unsigned i = 0; i < n && (int)i < max; ++i) {
+        out[i].id  = (uint16_t)i;
+        out[i].cls = s_names[i].cls;
+        memcpy(out[i].name, s_names[i].name, sizeof(out[i].name));
+        _sum(i, &out[i].c);
+        _sub(&out[i].c, &s_base[i]);
+    }
+    pthread_mutex_unlock(&s_lock);
+    return (int)n;
+}
+
+void HAL_Metrics_ForEach(HAL_MetricsVisitor fn, void* ctx) {
+    HAL_MetricsSnapshot s;
+    unsigned n = __atomic_load_n(&s_nnames, __ATOMIC_ACQUIRE);
+    for (unsigned i = 0; i < n; ++i) {
+        pthread_mutex_lock(&s_lock);
+        s.id  = (uint16_t)i;
+        s.cls = s_names[i].cls;
+        memcpy(s.name, s_names[i].name, sizeof(s.name));
+        _sum(i, &s.c);
+        _sub(&s.c, &s_base[i]);
+        pthread_mutex_unlock(&s_lock);
+        fn(&s, ctx);
+    }
+}
+
+void HAL_Metrics_Reset(void) {
+    unsigned n = __atomic_load_n(&s_nnames, __ATOMIC_ACQUIRE);
+    pthread_mutex_lock(&s_lock);
+    for (unsigned i = 0; i < n; ++i) _sum(i, &s_base[i]);
+    pthread_mutex_unlock(&s_lock);
+}
+
+typedef struct { char* buf; size_t len, used; } FmtCtx;
+
+static void _fmt_one(const HAL_MetricsSnapshot* s, void* ctx) {
+    FmtCtx* f = (FmtCtx*)ctx;
+    const HAL_MetricsCounters* c = &s->c;
+    if (!c->ops) return;
+    uint64_t max_ns = 0;
+    for (int b = HAL_METRICS_BUCKETS - 1; b >= 0; --b) if (c->hist[b]) { max_ns = 1ull << b; break; }
+    char line[256];
+    int n = snprintf(line, sizeof(line),
+                     "%s ops=%llu bytes=%llu err=%llu sys=%llu avg_ns=%llu p50_ns=%llu p99_ns=%llu max_ns=%llu\n",
+                     s->name, (unsigned long long)c->ops, (unsigned long long)c->bytes,
+                     (unsigned long long)c->errors, (unsigned long long)c->syscalls,
+                     (unsigned long long)(c->lat_n ? c->lat_sum_ns / c->lat_n : 0),
+                     (unsigned long long)HAL_Metrics_Percentile(c, 0.50),
+                     (unsigned long long)HAL_Metrics_Percentile(c, 0.99),
+                     (unsigned long long)max_ns);
+    if (n <= 0 || (size_t)n >= sizeof(line) || f->used + (size_t)n >= f->len) return;
+    memcpy(f->buf + f->used, line, (size_t)n);
+    f->used += (size_t)n;
+    f->buf[f->used] = '\0';
+}
+
+size_t HAL_Metrics_Format(char* buf, size_t len) {
+    if (!buf || !len) return 0;
+    buf[0] = '\0';
+    FmtCtx f = { buf, len, 0 };
+    HAL_Metrics_ForEach(_fmt_one, &f);
+    return f.used;
+}
+
+#else  /* !HAL_METRICS: API đọc vẫn có để app link được, không có handle nào */
+
+uint64_t HAL_Metrics_Start(void) { return 0; }
+uint16_t HAL_Metrics_Handle(HAL_MetricsClass cls, const char* name) { (void)cls; (void)name; return 0; }
+uint16_t HAL_Metrics_Handlef(HAL_MetricsClass cls, const char* fmt, ...) { (void)cls; (void)fmt; return 0; }
+void     HAL_Metrics_Record(uint16_t id, uint64_t t0_ns, int error, uint64_t bytes, uint32_t syscalls) {
+    (void)id; (void)t0_ns; (void)error; (void)bytes; (void)syscalls;
+}
+int      HAL_Metrics_Enabled(void) { return 0; }
+int      HAL_Metrics_Snapshot(HAL_MetricsSnapshot* out, int max) { (void)out; (void)max; return 0; }
+void     HAL_Metrics_ForEach(HAL_MetricsVisitor fn, void* ctx) { (void)fn; (void)ctx; }
+void     HAL_Metrics_Reset(void) {}
+size_t   HAL_Metrics_Format(char* buf, size_t len) { if (buf && len) buf[0] = '\0'; return 0; }
+
+#endif
@@ -0,0 +1,392 @@
+/**
+ * @file hal_rec.c
+ * @brief HAL I/O recorder (append-only varint log) and replay engine.
+ *
+ * Notes:
+ *  - Recorder: một FILE* đệm lớn, ghi dưới mutex; mỗi bản ghi vài byte +
+ *    payload, flush mỗi ~100 ms. HAL_REC=<path> trong env bật ghi từ lúc
+ *    process khởi động, HAL_REPLAY=<path> bật replay.
+ *  - Replay: đọc cả file vào RAM, dựng danh sách liên kết "bản ghi kế tiếp
+ *    cùng (kênh, loại)" nên mỗi lần lấy là O(1) dù log có nhiều kênh xen kẽ.
+ *  - HAL không phụ thuộc OSAL nên dùng pthread trực tiếp.
+ */
+#define _GNU_SOURCE
+#include "hal_rec.h"
+#include "hal_log.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define REC_MAGIC     "HALREC\x01\n"
+#define REC_MAGIC_LEN 8
+#define REC_MAX_CHAN  1024
+#define REC_FLUSH_NS  100000000ull
+
+static uint64_t _now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* ======================= record ======================= */
+
+static pthread_mutex_t s_rec_mtx = PTHREAD_MUTEX_INITIALIZER;
+static FILE*           s_rec_f   = NULL;
+static volatile int    s_rec_on  = 0;
+static uint64_t        s_rec_last_ns = 0;
+static uint64_t        s_rec_flush_ns = 0;
+static char*           s_rec_names[REC_MAX_CHAN];
+static uint16_t        s_rec_nchan = 0;
+
+static void _put_varint(FILE* f, uint64_t v) {
+    while (v >= 0x80) { fputc((int)(v & 0x7F) | 0x80, f); v >>= 7; }
+    fputc((int)v, f);
+}
+
+static void _put_u64(FILE* f, uint64_t v) {
+    for (int i = 0; i < 8; ++i) fputc((int)((v >> (8 * i)) & 0xFF), f);
+}
+
+/* gọi khi giữ s_rec_mtx */
+static void _rec_write(HAL_RecType type, uint16_t chan, int32_t status,
+                       const void* a, size_t alen, const void* b, size_t blen) {
+    uint64_t now = _now_ns();
+    fputc((int)type, s_rec_f);
+    _put_varint(s_rec_f, chan);
+    _put_varint(s_rec_f, now - s_rec_last_ns);
+    _put_varint(s_rec_f, ((uint32_t)status << 1) ^ (uint32_t)(status >> 31));   /* zigzag */
+    _put_varint(s_rec_f, alen);
+    if (alen) fwrite(a, 1, alen, s_rec_f);
+    _put_varint(s_rec_f, blen);
+    if (blen) fwrite(b, 1, blen, s_rec_f);
+    s_rec_last_ns = now;
+    /* process bị kill vẫn còn log tới ~100 ms cuối (chỉ flush khi đang có I/O) */
+    if (now - s_rec_flush_ns > REC_FLUSH_NS) { fflush(s_rec_f); s_rec_flush_ns = now; }
+}
+
+int HAL_Rec_Open(const char* path) {
+    if (!path) return -1;
+    pthread_mutex_lock(&s_rec_mtx);
+    if (s_rec_f) { pthread_mutex_unlock(&s_rec_mtx); return 0; }
+
+    s_rec_f = fopen(path, "wb");
+    if (!s_rec_f) {
+        pthread_mutex_unlock(&s_rec_mtx);
+        HAL_LOGE("[HAL][REC]", "open %s failed", path);
+        return -1;
+    }
+    setvbuf(s_rec_f, NULL, _IOFBF, 1 << 16);
+    s_rec_last_ns = s_rec_flush_ns = _now_ns();
+    fwrite(REC_MAGIC, 1, REC_MAGIC_LEN, s_rec_f);
+    _put_u64(s_rec_f, s_rec_last_ns);
+    s_rec_nchan = 0;
+    s_rec_on = 1;
+    pthread_mutex_unlock(&s_rec_mtx);
+    HAL_LOGI("[HAL][REC]", "recording to %s", path);
+    return 0;
+}
+
+void HAL_Rec_Close(void) {
+    pthread_mutex_lock(&s_rec_mtx);
+    s_rec_on = 0;
+    if (s_rec_f) { fclose(s_rec_f); s_rec_f = NULL; }
+    for (unsigned i = 0; i < s_rec_nchan; ++i) { free(s_rec_names[i]); s_rec_names[i] = NULL; }
+    s_rec_nchan = 0;
+    pthread_mutex_unlock(&s_rec_mtx);
+}
+
+int HAL_Rec_Active(void) { return s_rec_on; }
+
+uint16_t HAL_Rec_Channel(const char* name) {
+    uint16_t id = 0xFFFF;
+    if (!name) return id;
+    pthread_mutex_lock(&s_rec_mtx);
+    for (uint16_t i = 0; i < s_rec_nchan; ++i)
+        if (strcmp(s_rec_names[i], name) == 0) { id = i; break; }
+    if (id == 0xFFFF && s_rec_f && s_rec_nchan < REC_MAX_CHAN) {
+        id = s_rec_nchan;
+        s_rec_names[s_rec_nchan++] = strdup(name);
+        _rec_write(HAL_REC_CHAN, id, 0, name, strlen(name), NULL, 0);
+    }
+    pthread_mutex_unlock(&s_rec_mtx);
+    return id;
+}
+
+void HAL_Rec_Put(HAL_RecType type, uint16_t chan, int32_t status,
+                 const void* a, size_t alen, const void* b, size_t blen) {
+    if (!s_rec_on || chan == 0xFFFF) return;
+    pthread_mutex_lock(&s_rec_mtx);
+    if (s_rec_f) _rec_write(type, chan, status, a, alen, b, blen);
+    pthread_mutex_unlock(&s_rec_mtx);
+}
+
+
+/* ======================= replay ======================= */
+
+typedef struct {
+    uint8_t        type;
+    uint16_t       chan;
+    int32_t        status;
+    uint64_t       t_ns;
+    const uint8_t* a; uint32_t alen;
+    const uint8_t* b; uint32_t blen;
+    int32_t        next;      /* bản ghi kế tiếp cùng (chan, type), -1 = hết */
+} RpEntry;
+
+static pthread_mutex_t s_rp_mtx = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t*        s_rp_buf = NULL;
+static RpEntry*        s_rp_ent = NULL;
+static size_t          s_rp_n   = 0;
+static char*           s_rp_names[REC_MAX_CHAN];
+static unsigned        s_rp_nchan = 0;
+static int32_t*        s_rp_cur = NULL;       /* [chan][type] -> chỉ số bản ghi kế tiếp */
+static HAL_ReplaySpeed s_rp_speed = HAL_REPLAY_AFAP;
+static uint64_t        s_rp_wall0 = 0;
+static HAL_ReplayStats s_rp_stats;
+static volatile int    s_rp_on = 0;
+
+static int _get_varint(const uint8_t** p, const uint8_t* end, uint64_t* out) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*p >= end) return -1;
+        uint8_t c = *(*p)++;
+        v |= (uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) { *out = v; return 0; }
+    }
+    return -1;
+}
+
+static int _get_bytes(const uint8_t** p, const uint8_t* end, const uint8_t** out, uint32_t* len) {
+    uint64_t n;
+    if (_get_varint(p, end, &n) != 0 || n > (uint64_t)(end - *p)) return -1;
+    *out = *p;
+    *len = (uint32_t)n;
+    *p += n;
+    return 0;
+}
+
+void HAL_Replay_Close(void) {
+    pthread_mutex_lock(&s_rp_mtx);
+    s_rp_on = 0;
+    for (unsigned i = 0; i < s_rp_nchan; ++i) { free(s_rp_names[i]); s_rp_names[i] = NULL; }
+    s_rp_nchan = 0;
+    free(s_rp_ent); s_rp_ent = NULL; s_rp_n = 0;
+    free(s_rp_cur); s_rp_cur = NULL;
+    free(s_rp_buf); s_rp_buf = NULL;
+    pthread_mutex_unlock(&s_rp_mtx);
+}
+
+int HAL_Replay_Open(const char* path, HAL_ReplaySpeed speed) {
+    FILE* f = path ? fopen(path, "rb") : NULL;
+    if (!f) { HAL_LOGE("[HAL][REPLAY]", "open %s failed", path ? path : "(null)"); return -1; }
+    fseek(f, 0, SEEK_END);
+    long sz = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* buf = (sz > 0) ? (uint8_t*)malloc((size_t)sz) : NULL;
+    size_t rd = buf ? fread(buf, 1, (size_t)sz, f) : 0;
+    fclose(f);
+    if (!buf || rd < REC_MAGIC_LEN + 8 || memcmp(buf, REC_MAGIC, REC_MAGIC_LEN) != 0) {
+        HAL_LOGE("[HAL][REPLAY]", "%s: not a HAL recording", path);
+        free(buf);
+        return -1;
+    }
+
+    HAL_Replay_Close();
+    pthread_mutex_lock(&s_rp_mtx);
+    s_rp_buf = buf;
+
+    /* 1) parse – bản ghi cuối bị cắt thì dừng ở đó */
+    size_t cap = 0;
+    uint64_t t = 0;
+    const uint8_t* p   = buf + REC_MAGIC_LEN + 8;
+    const uint8_t* end = buf + rd;
+    while (p < end) {
+        RpEntry e;
+        uint64_t chan, dt, zz;
+        e.type = *p++;
+        if (_get_varint(&p, end, &chan) || _get_varint(&p, end, &dt) || _get_varint(&p, end, &zz) ||
+            _get_bytes(&p, end, &e.a, &e.alen) || _get_bytes(&p, end, &e.b, &e.blen)) break;
+        if (e.type >= HAL_REC_TYPE_MAX || chan >= REC_MAX_CHAN) break;
+        t += dt;
+        e.chan   = (uint16_t)chan;
+        e.status = (int32_t)(((uint32_t)zz >> 1) ^ (0u - ((uint32_t)zz & 1u)));
+        e.t_ns   = t;
+        e.next   = -1;
+
+        if (e.type == HAL_REC_CHAN) {
+            if (chan >= s_rp_nchan) s_rp_nchan = (unsigned)chan + 1;
+            free(s_rp_names[chan]);
+            s_rp_names[chan] = strndup((const char*)e.a, e.alen);
+            continue;
+        }
+        if (s_rp_n == cap) {
+            cap = cap ? cap * 2 : 1024;
+            RpEntry* ne = (RpEntry*)realloc(s_rp_ent, cap * sizeof(*ne));
+            if (!ne) break;
+            s_rp_ent = ne;
+        }
+        s_rp_ent[s_rp_n++] = e;
+    }
+
+    /* 2) liên kết theo (chan, type): duyệt ngược, head = bản ghi đầu tiên */
+    s_rp_cur = (int32_t*)malloc((s_rp_nchan ? s_rp_nchan : 1) * HAL_REC_TYPE_MAX * sizeof(int32_t));
+    if (!s_rp_cur) { pthread_mutex_unlock(&s_rp_mtx); HAL_Replay_Close(); return -1; }
+    for (size_t i = 0; i < (size_t)s_rp_nchan * HAL_REC_TYPE_MAX; ++i) s_rp_cur[i] = -1;
+    for (size_t i = s_rp_n; i-- > 0;) {
+        RpEntry* e = &s_rp_ent[i];
+        if (e->chan >= s_rp_nchan) continue;
+        int32_t* head = &s_rp_cur[e->chan * HAL_REC_TYPE_MAX + e->type];
+        e->next = *head;
+        *head = (int32_t)i;
+    }
+
+    s_rp_speed = speed;
+    s_rp_wall0 = _now_ns();
+    memset(&s_rp_stats, 0, sizeof(s_rp_stats));
+    s_rp_on = 1;
+    pthread_mutex_unlock(&s_rp_mtx);
+
+    HAL_LOGI("[HAL][REPLAY]", "%s: %zu records, %u channels, %.3f s (%s)", path, s_rp_n, s_rp_nchan,
+           s_rp_n ? (double)s_rp_ent[s_rp_n - 1].t_ns / 1e9 : 0.0,
+           speed == HAL_REPLAY_REALTIME ? "realtime" : "afap");
+    return 0;
+}
+
+int HAL_Replay_Active(void) { return s_rp_on; }
+
+HAL_ReplaySpeed HAL_Replay_Speed(void) { return s_rp_speed; }
+
+const char* HAL_Replay_Target(const char* name) {
+    if (!name) return NULL;
+    if (strncmp(name, "replay:", 7) == 0) return name + 7;
+    return s_rp_on ? name : NULL;
+}
+
+int HAL_Replay_Channel(const char* name) {
+    int id = -1;
+    if (!name) return -1;
+    pthread_mutex_lock(&s_rp_mtx);
+    for (unsigned i = 0; i < s_rp_nchan; ++i)
+        if (s_rp_names[i] && strcmp(s_rp_names[i], name) == 0) { id = (int)i; break; }
+    pthread_mutex_unlock(&s_rp_mtx);
+    return id;
+}
+
+/* gọi khi giữ s_rp_mtx */
+static int32_t _cursor(int chan, HAL_RecType type) {
+    if (!s_rp_on || chan < 0 || (unsigned)chan >= s_rp_nchan || type >= HAL_REC_TYPE_MAX) return -1;
+    return s_rp_cur[chan * HAL_REC_TYPE_MAX + type];
+}
+
+static void _fill(const RpEntry* e, HAL_RecEntry* out) {
+    out->type   = (HAL_RecType)e->type;
+    out->chan   = e->chan;
+    out->status = e->status;
+    out->t_ns   = e->t_ns;
+    out->due_ns = s_rp_wall0 + e->t_ns;
+    out->a = e->a; out->alen = e->alen;
+    out->b = e->b; out->blen = e->blen;
+}
+
+int HAL_Replay_Peek(int chan, HAL_RecType type, HAL_RecEntry* out) {
+    pthread_mutex_lock(&s_rp_mtx);
+    int32_t i = _cursor(chan, type);
+    if (i >= 0 && out) _fill(&s_rp_ent[i], out);
+    pthread_mutex_unlock(&s_rp_mtx);
+    return (i >= 0) ? 0 : -1;
+}
+
+int HAL_Replay_Take(int chan, HAL_RecType type, HAL_RecEntry* out) {
+    pthread_mutex_lock(&s_rp_mtx);
+    int32_t i = _cursor(chan, type);
+    if (i < 0) {
+        s_rp_stats.exhausted++;
+        pthread_mutex_unlock(&s_rp_mtx);
+        return -1;
+    }
+    if (out) _fill(&s_rp_ent[i], out);
+    s_rp_cur[chan * HAL_REC_TYPE_MAX + type] = s_rp_ent[i].next;
+    s_rp_stats.served++;
+    pthread_mutex_unlock(&s_rp_mtx);
+    return 0;
+}
+
+int HAL_Replay_Next(int chan, HAL_RecType type, int timeout_ms, HAL_RecEntry* out) {
+    const uint64_t deadline = (timeout_ms < 0) ? UINT64_MAX : _now_ns() + (uint64_t)timeout_ms * 1000000ull;
+
+    for (;;) {
+        pthread_mutex_lock(&s_rp_mtx);
+        int32_t i = _cursor(chan, type);
+        if (i < 0) {
+            s_rp_stats.exhausted++;
+            pthread_mutex_unlock(&s_rp_mtx);
+            return -1;
+        }
+        const uint64_t due = s_rp_wall0 + s_rp_ent[i].t_ns;
+        const uint64_t now = _now_ns();
+        if (s_rp_speed == HAL_REPLAY_AFAP || due <= now) {
+            if (out) _fill(&s_rp_ent[i], out);
+            s_rp_cur[chan * HAL_REC_TYPE_MAX + type] = s_rp_ent[i].next;
+            s_rp_stats.served++;
+            pthread_mutex_unlock(&s_rp_mtx);
+            return 0;
+        }
+        pthread_mutex_unlock(&s_rp_mtx);
+
+        if (now >= deadline) return 1;
+        /* ngủ tới min(due, deadline) rồi kiểm lại (thread khác có thể đã lấy bản ghi) */
+        uint64_t until = (due < deadline) ? due : deadline;
+        struct timespec ts = { .tv_sec = (time_t)(until / 1000000000ull), .tv_nsec = (long)(until % 1000000000ull) };
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+}
+
+int HAL_Replay_Expect(int chan, HAL_RecType type, const void* a, size_t alen,
+                      const void* b, size_t blen, HAL_RecEntry* out) {
+    pthread_mutex_lock(&s_rp_mtx);
+    int32_t i = _cursor(chan, type);
+    if (i < 0) {
+        s_rp_stats.exhausted++;
+        pthread_mutex_unlock(&s_rp_mtx);
+        return -1;
+    }
+    const RpEntry* e = &s_rp_ent[i];
+    s_rp_cur[chan * HAL_REC_TYPE_MAX + type] = e->next;
+    s_rp_stats.served++;
+    int same = (e->alen == alen && (!alen || memcmp(e->a, a, alen) == 0) &&
+                (!b || (e->blen == blen && (!blen || memcmp(e->b, b, blen) == 0))));
+    if (out) _fill(e, out);
+    if (!same && s_rp_stats.mismatches++ < 8)   /* chỉ in vài lần đầu */
+        HAL_LOGW("[HAL][REPLAY]", "mismatch %s type=%d at %.6f s",
+               s_rp_names[chan] ? s_rp_names[chan] : "?", (int)type, (double)e->t_ns / 1e9);
+    int st = e->status;
+    pthread_mutex_unlock(&s_rp_mtx);
+    return st;
+}
+
+void HAL_Replay_GetStats(HAL_ReplayStats* out) {
+    if (!out) return;
+    pthread_mutex_lock(&s_rp_mtx);
+    *out = s_rp_stats;
+    pthread_mutex_unlock(&s_rp_mtx);
+}
+
+/* ======================= env ======================= */
+
+__attribute__((constructor)) static void _rec_env_init(void) {
+    const char* p = getenv("HAL_REC");
+    if (p && p[0]) HAL_Rec_Open(p);
+
+    p = getenv("HAL_REPLAY");
+    if (p && p[0]) {
+        const char* sp = getenv("HAL_REPLAY_SPEED");
+        HAL_Replay_Open(p, (sp && strcmp(sp, "afap") == 0) ? HAL_REPLAY_AFAP : HAL_REPLAY_REALTIME);
+    }
+}
+
+__attribute__((destructor)) static void _rec_env_fini(void) {
+    HAL_Rec_Close();   /* flush phần còn trong buffer khi process exit() */
+}
@@ -10,6 +10,7 @@
  */
 
 #include "hal_spi.h"
+#include "hal_log.h"
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,6 +22,9 @@
 
 #include <linux/spi/spidev.h>  // struct spi_ioc_transfer, SPI_IOC_*
 
+#include "hal_metrics.h"
+#include "hal_rec.h"
+
 /* --- weak hooks: real build will use syscalls, test can override --- */
 __attribute__((weak))
 int hal_spi_port_open(const char* path, int flags)
@@ -47,6 +51,11 @@ struct HAL_SpiBus {
     uint8_t  bits_per_word;
     uint8_t  lsb_first;
     uint32_t speed_hz;
+    uint16_t rec_chan;   // kênh ghi, 0xFFFF = không ghi
+    int      rp_chan;    // kênh replay, -1 = bus thật
+#if HAL_METRICS
+    uint16_t mx;         // hal_metrics id ("spi:<dev>")
+#endif
 };
 
 static int _starts_with(const char* s, const char* p) {
@@ -55,23 +64,86 @@ static int _starts_with(const char* s, const char* p) {
     return 1;
 }
 
+/* Gom tx/rx của mọi đoạn trong message (record: a = tx, b = rx) */
+static size_t _spi_gather(const struct spi_ioc_transfer* x, int n, int rx, uint8_t* dst) {
+    size_t total = 0;
+    for (int i = 0; i < n; ++i) {
+        const void* p = (const void*)(uintptr_t)(rx ? x[i].rx_buf : x[i].tx_buf);
+        if (!p) continue;
+        if (dst) memcpy(dst + total, p, x[i].len);
+        total += x[i].len;
+    }
+    return total;
+}
+
+#if HAL_METRICS
+/* số byte trên dây của message (full duplex: mỗi đoạn tính một lần) */
+static size_t _spi_wire_len(const struct spi_ioc_transfer* x, int n) {
+    size_t total = 0;
+    for (int i = 0; i < n; ++i) total += x[i].len;
+    return total;
+}
+#endif
+
+/* Mọi SPI_IOC_MESSAGE đi qua đây để record/replay/metrics cùng một chỗ. Trả về như ioctl(). */
+static int _spi_message(struct HAL_SpiBus* bus, int n, struct spi_ioc_transfer* x)
+{
+    if (bus->rp_chan < 0 && bus->rec_chan == 0xFFFF) {
+        HAL_MX_T0(t0);
+        int ret = hal_spi_port_ioctl(bus->fd, SPI_IOC_MESSAGE(n), x);
+        HAL_MX_REC(bus->mx, t0, ret < 0, (ret < 0) ? 0 : _spi_wire_len(x, n), 1);
+        return ret;
+    }
+
+    size_t txlen = _spi_gather(x, n, 0, NULL);
+    size_t rxlen = _spi_gather(x, n, 1, NULL);
+    uint8_t* tmp = (uint8_t*)malloc(txlen + rxlen + 1);
+    if (!tmp) { errno = ENOMEM; return -1; }
+    _spi_gather(x, n, 0, tmp);
+
+    int ret;
+    if (bus->rp_chan >= 0) {
+        HAL_RecEntry e;
+        ret = HAL_Replay_Expect(bus->rp_chan, HAL_REC_SPI_XFER, tmp, txlen, NULL, 0, &e);
+        if (ret >= 0) {        /* rải RX đã ghi vào các buffer rx của message */
+            size_t off = 0;
+            for (int i = 0; i < n && off < e.blen; ++i) {
+                if (!x[i].rx_buf) continue;
+                size_t k = (e.blen - off < x[i].len) ? e.blen - off : x[i].len;
+                memcpy((void*)(uintptr_t)x[i].rx_buf, e.b + off, k);
+                off += k;
+            }
+        }
+    } else {
+        HAL_MX_T0(t0);
+        ret = hal_spi_port_ioctl(bus->fd, SPI_IOC_MESSAGE(n), x);
+        HAL_MX_REC(bus->mx, t0, ret < 0, (ret < 0) ? 0 : _spi_wire_len(x, n), 1);
+        _spi_gather(x, n, 1, tmp + txlen);
+        HAL_Rec_Put(HAL_REC_SPI_XFER, bus->rec_chan, ret, tmp, txlen, tmp + txlen, rxlen);
+    }
+    free(tmp);
+    return ret;
+}
+
 /* Helper to apply config via ioctl */
 static HAL_SpiStatus _spi_apply_cfg(struct HAL_SpiBus* bus)
 {
+    if (bus->rp_chan >= 0) return HAL_SPI_OK;
+
     uint8_t mode_ioctl = bus->mode & 0x3;
     if (bus->lsb_first)
         mode_ioctl |= SPI_LSB_FIRST;
 
     if (hal_spi_port_ioctl(bus->fd, SPI_IOC_WR_MODE, &mode_ioctl) < 0) {
-        printf("[SPI][LINUX] set MODE fail errno=%d\r\n", errno);
+        HAL_LOGE("[SPI][LINUX]", "set MODE fail errno=%d", errno);
         return HAL_SPI_EBUS;
     }
     if (hal_spi_port_ioctl(bus->fd, SPI_IOC_WR_BITS_PER_WORD, &bus->bits_per_word) < 0) {
-        printf("[SPI][LINUX] set BPW fail errno=%d\r\n", errno);
+        HAL_LOGE("[SPI][LINUX]", "set BPW fail errno=%d", errno);
         return HAL_SPI_EBUS;
     }
     if (hal_spi_port_ioctl(bus->fd, SPI_IOC_WR_MAX_SPEED_HZ, &bus->speed_hz) < 0) {
-        printf("[SPI][LINUX] set SPEED fail errno=%d\r\n", errno);
+        HAL_LOGE("[SPI][LINUX]", "set SPEED fail errno=%d", errno);
         return HAL_SPI_EBUS;
     }
     return HAL_SPI_OK;
@@ -90,9 +162,24 @@ HAL_SpiBus* HAL_Spi_Open(const HAL_SpiConfig* cfg, HAL_SpiStatus* out_status)
         return NULL;
     }
 
-    int fd = hal_spi_port_open(cfg->dev_name, O_RDWR);
-    if (fd < 0) {
-        printf("[SPI][LINUX] open %s failed errno=%d\r\n", cfg->dev_name, errno);
+    char chan[80];
+    const char* rp = HAL_Replay_Target(cfg->dev_name);
+    bus->rec_chan = 0xFFFF;
+    bus->rp_chan  = -1;
+    if (rp) {
+        snprintf(chan, sizeof(chan), "spi:%s", rp);
+        bus->rp_chan = HAL_Replay_Channel(chan);
+        if (bus->rp_chan < 0) {
+            HAL_LOGE("[SPI][REPLAY]", "%s not in recording", chan);
+            free(bus);
+            if (out_status) *out_status = HAL_SPI_EBUS;
+            return NULL;
+        }
+    }
+
+    int fd = rp ? -1 : hal_spi_port_open(cfg->dev_name, O_RDWR);
+    if (fd < 0 && !rp) {
+        HAL_LOGE("[SPI][LINUX]", "open %s failed errno=%d", cfg->dev_name, errno);
         free(bus);
         if (out_status) *out_status = HAL_SPI_EBUS;
         return NULL;
@@ -104,10 +191,15 @@ HAL_SpiBus* HAL_Spi_Open(const HAL_SpiConfig* cfg, HAL_SpiStatus* out_status)
     bus->bits_per_word = cfg->bits_per_word ? cfg->bits_per_word : 8;
     bus->lsb_first     = cfg->lsb_first;
     bus->speed_hz      = cfg->max_speed_hz ? cfg->max_speed_hz : 1000000;
+    if (!rp && HAL_Rec_Active()) {
+        snprintf(chan, sizeof(chan), "spi:%s", cfg->dev_name);
+        bus->rec_chan = HAL_Rec_Channel(chan);
+    }
+    if (!rp) HAL_MX_OPEN(bus->mx, HAL_METRICS_SPI, "spi:%s", cfg->dev_name);
 
     HAL_SpiStatus st = _spi_apply_cfg(bus);
     if (st != HAL_SPI_OK) {
-        hal_spi_port_close(fd);
+        if (fd >= 0) hal_spi_port_close(fd);
         free(bus);
         if (out_status) *out_status = st;
         return NULL;
@@ -157,11 +249,11 @@ HAL_SpiStatus HAL_Spi_Transfer(HAL_SpiBus* bus,
     xfer.speed_hz      = bus->speed_hz;
     xfer.bits_per_word = bus->bits_per_word;
 
-    int ret = hal_spi_port_ioctl(bus->fd, SPI_IOC_MESSAGE(1), &xfer);
+    int ret = _spi_message(bus, 1, &xfer);
     if (tx_buf_alloc) free(tx_buf_alloc);
 
     if (ret < 0) {
-        printf("[SPI][LINUX] Transfer fail errno=%d\r\n", errno);
+        HAL_LOGE("[SPI][LINUX]", "Transfer fail errno=%d", errno);
         return HAL_SPI_EIO;
     }
 
@@ -220,11 +312,11 @@ HAL_SpiStatus HAL_Spi_TransferSegments(HAL_SpiBus* bus,
 
     int nxfers = (tx0 && len0) ? ((len1>0)?2:1) : ((len1>0)?1:0);
 
-    int ret = hal_spi_port_ioctl(bus->fd, SPI_IOC_MESSAGE(nxfers), xfers);
+    int ret = _spi_message(bus, nxfers, xfers);
     if (tx1_alloc) free(tx1_alloc);
 
     if (ret < 0) {
-        printf("[SPI][LINUX] Segments fail errno=%d\r\n", errno);
+        HAL_LOGE("[SPI][LINUX]", "Segments fail errno=%d", errno);
         return HAL_SPI_EIO;
     }
 
@@ -242,8 +334,9 @@ HAL_SpiStatus HAL_Spi_SetSpeed(HAL_SpiBus* bus, uint32_t hz)
 {
     if (!bus) return HAL_SPI_EINVAL;
     bus->speed_hz = hz;
+    if (bus->rp_chan >= 0) return HAL_SPI_OK;
     if (hal_spi_port_ioctl(bus->fd, SPI_IOC_WR_MAX_SPEED_HZ, &bus->speed_hz) < 0) {
-        printf("[SPI][LINUX] SetSpeed fail errno=%d\r\n", errno);
+        HAL_LOGE("[SPI][LINUX]", "SetSpeed fail errno=%d", errno);
         return HAL_SPI_EBUS;
     }
     return HAL_SPI_OK;
@@ -284,6 +377,26 @@ HAL_SpiStatus HAL_Spi_GetInfo(HAL_SpiBus* bus, HAL_SpiInfo* out)
     return HAL_SPI_OK;
 }
 
+/* spidev bufsiz: giống nhau cho mọi bus, đọc một lần */
+size_t HAL_Spi_MaxMessage(HAL_SpiBus* bus)
+{
+    static size_t s_bufsiz;
+    if (!bus) return 0;
+    if (bus->rp_chan >= 0) return 0;    /* replay: không có kernel */
+    size_t v = __atomic_load_n(&s_bufsiz, __ATOMIC_RELAXED);
+    if (v) return v;
+
+    v = 4096;                           /* mặc định của spidev */
+    FILE* f = fopen("/sys/module/spidev/parameters/bufsiz", "r");
+    if (f) {
+        unsigned long n = 0;
+        if (fscanf(f, "%lu", &n) == 1 && n > 0) v = (size_t)n;
+        fclose(f);
+    }
+    __atomic_store_n(&s_bufsiz, v, __ATOMIC_RELAXED);
+    return v;
+}
+
 /* ------------- convenience: write-only ------------- */
 HAL_SpiStatus HAL_Spi_Write(HAL_SpiBus*    bus,
                             const uint8_t* tx,
@@ -338,11 +451,11 @@ HAL_SpiStatus HAL_Spi_BurstTransfer(HAL_SpiBus*    bus,
      */
     xfer.cs_change     = cs_hold ? 1 : 0;
 
-    int ret = hal_spi_port_ioctl(bus->fd, SPI_IOC_MESSAGE(2), &xfer);
+    int ret = _spi_message(bus, 1, &xfer);   /* một xfer (MESSAGE(2) đọc quá struct) */
     if (tx_buf_alloc) free(tx_buf_alloc);
 
     if (ret < 0) {
-        printf("[SPI][LINUX] BurstTransfer fail errno=%d\r\n", errno);
+        HAL_LOGE("[SPI][LINUX]", "BurstTransfer fail errno=%d", errno);
         return HAL_SPI_EIO;
     }
 
@@ -11,6 +11,9 @@
  * The code aims to be simple, robust, and suitable for task-based apps via OSAL.
  */
 #include "hal_uart.h"
+#include "hal_log.h"
+#include "hal_metrics.h"
+#include "hal_rec.h"
 #include <stdio.h>
 #include <termios.h>
 #include <unistd.h>
@@ -22,11 +25,19 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 /** Internal UART handle. */
 struct HAL_Uart {
-    int fd;              ///< POSIX file descriptor
+    int fd;              ///< POSIX file descriptor (-1 khi replay)
     HAL_UartConfig cfg;  ///< Saved config for reference
+    uint16_t rec_chan;   ///< kênh ghi (0xFFFF = không ghi)
+    int      rp_chan;    ///< kênh replay (-1 = thiết bị thật)
+    HAL_RecEntry rp_pend;///< bản ghi RX đang trả dở (app đọc ít hơn bản ghi)
+    size_t   rp_off;
+#if HAL_METRICS
+    uint16_t mx;         ///< hal_metrics id ("uart:<dev>")
+#endif
 };
 
 /** Convert an integer baud rate into a termios speed_t flag. */
@@ -104,11 +115,32 @@ static int _apply_cfg(int fd, const HAL_UartConfig* c) {
     return 0;
 }
 
+static HAL_Uart* _open_replay(const HAL_UartConfig* cfg, const char* dev, HAL_UartStatus* out_status) {
+    char chan[96];
+    snprintf(chan, sizeof(chan), "uart:%s", dev);
+    int id = HAL_Replay_Channel(chan);
+    HAL_Uart* h = (id >= 0) ? (HAL_Uart*)calloc(1, sizeof(HAL_Uart)) : NULL;
+    if (!h) {
+        if (out_status) *out_status = HAL_UART_EIO;
+        HAL_LOGE("[UART][REPLAY]", "%s not in recording", chan);
+        return NULL;
+    }
+    h->fd = -1;
+    h->cfg = *cfg;
+    h->rec_chan = 0xFFFF;
+    h->rp_chan = id;
+    if (out_status) *out_status = HAL_UART_OK;
+    HAL_LOGI("[UART][REPLAY]", "opened %s", dev);
+    return h;
+}
+
 HAL_Uart* HAL_Uart_Open(const HAL_UartConfig* cfg, HAL_UartStatus* out_status) {
     if (!cfg || !cfg->device) {
         if (out_status) *out_status = HAL_UART_EINVAL;
         return NULL;
     }
+    const char* rp = HAL_Replay_Target(cfg->device);
+    if (rp) return _open_replay(cfg, rp, out_status);
 
     int flags = O_RDWR | O_NOCTTY;          // read/write, ignore controlling TTY
     if (cfg->non_blocking) flags |= O_NONBLOCK;
@@ -116,7 +148,7 @@ HAL_Uart* HAL_Uart_Open(const HAL_UartConfig* cfg, HAL_UartStatus* out_status) {
     int fd = open(cfg->device, flags);
     if (fd < 0) {
         if (out_status) *out_status = HAL_UART_EIO;
-        printf("[UART][LINUX] open %s failed errno=%d\r\n", cfg->device, errno);
+        HAL_LOGE("[UART][LINUX]", "open %s failed errno=%d", cfg->device, errno);
         return NULL;
     }
 
@@ -129,15 +161,23 @@ HAL_Uart* HAL_Uart_Open(const HAL_UartConfig* cfg, HAL_UartStatus* out_status) {
     memset(h, 0, sizeof(*h));
     h->fd = fd;
     h->cfg = *cfg;
+    h->rp_chan = -1;
+    h->rec_chan = 0xFFFF;
+    if (HAL_Rec_Active()) {
+        char chan[96];
+        snprintf(chan, sizeof(chan), "uart:%s", cfg->device);
+        h->rec_chan = HAL_Rec_Channel(chan);
+    }
+    HAL_MX_OPEN(h->mx, HAL_METRICS_UART, "uart:%s", cfg->device);
 
     if (_apply_cfg(fd, cfg) != 0) {
         if (out_status) *out_status = HAL_UART_ECFG;
-        printf("[UART][LINUX] termios set failed\r\n");
+        HAL_LOGE("[UART][LINUX]", "termios set failed");
         close(fd); free(h); return NULL;
     }
 
     if (out_status) *out_status = HAL_UART_OK;
-    printf("[UART][LINUX] opened %s baud=%u\r\n", cfg->device, (unsigned)cfg->baud);
+    HAL_LOGI("[UART][LINUX]", "opened %s baud=%u", cfg->device, (unsigned)cfg->baud);
     return h;
 }
 
@@ -148,17 +188,29 @@ void HAL_Uart_Close(HAL_Uart* h) {
 }
 
 long HAL_Uart_Write(HAL_Uart* h, const void* buf, size_t len) {
-    if (!h || h->fd < 0 || !buf) return -1;
+    if (!h || !buf) return -1;
+    if (h->rp_chan >= 0) {
+        int st = HAL_Replay_Expect(h->rp_chan, HAL_REC_UART_TX, buf, len, NULL, 0, NULL);
+        return (st < 0) ? (long)len : (long)st;
+    }
+    if (h->fd < 0) return -1;
     const uint8_t* p = (const uint8_t*)buf;
     size_t total = 0;
+    uint32_t calls = 0;
+    HAL_MX_T0(t0);
     while (total < len) {
         ssize_t n = write(h->fd, p + total, len - total);
+        ++calls;
         if (n < 0) {
             if (errno == EINTR) continue;  // interrupted by signal: retry
+            HAL_MX_REC(h->mx, t0, 1, total, calls);
             return -2;                     // other write error
         }
         total += (size_t)n;
     }
+    HAL_MX_REC(h->mx, t0, 0, total, calls);
+    (void)calls;
+    HAL_Rec_Put(HAL_REC_UART_TX, h->rec_chan, (int32_t)total, buf, total, NULL, 0);
     return (long)total;
 }
 
@@ -168,8 +220,34 @@ long HAL_Uart_WriteString(HAL_Uart* h, const char* s) {
     return HAL_Uart_Write(h, s, len);
 }
 
+/* Replay RX: trả tiếp bản ghi đang dở, hoặc chờ bản ghi kế tiếp (REALTIME: theo thời điểm đã ghi) */
+static long _read_replay(HAL_Uart* h, void* buf, size_t len, uint32_t timeout_ms) {
+    if (h->rp_off >= h->rp_pend.alen) {
+        int to = (timeout_ms == 0xFFFFFFFFu) ? -1 : (int)timeout_ms;
+        int rc = HAL_Replay_Next(h->rp_chan, HAL_REC_UART_RX, to, &h->rp_pend);
+        if (rc != 0) {
+            h->rp_pend.alen = 0;
+            h->rp_off = 0;
+            if (rc < 0) {   /* log hết: đường dây im lặng – ngủ như timeout để task không quay vòng */
+                uint32_t ms = (timeout_ms > 100u) ? 100u : timeout_ms;
+                struct timespec ts = { .tv_sec = 0, .tv_nsec = (long)ms * 1000000L };
+                nanosleep(&ts, NULL);
+            }
+            return 0;
+        }
+        h->rp_off = 0;
+    }
+    size_t n = h->rp_pend.alen - h->rp_off;
+    if (n > len) n = len;
+    memcpy(buf, h->rp_pend.a + h->rp_off, n);
+    h->rp_off += n;
+    return (long)n;
+}
+
 long HAL_Uart_Read(HAL_Uart* h, void* buf, size_t len, uint32_t timeout_ms) {
-    if (!h || h->fd < 0 || !buf || len == 0) return -1;
+    if (!h || !buf || len == 0) return -1;
+    if (h->rp_chan >= 0) return _read_replay(h, buf, len, timeout_ms);
+    if (h->fd < 0) return -1;
 
     struct pollfd pfd;
     pfd.fd = h->fd;
@@ -181,19 +259,24 @@ long HAL_Uart_Read(HAL_Uart* h, void* buf, size_t len, uint32_t timeout_ms) {
     int rc = poll(&pfd, 1, to);
     if (rc < 0) {
         if (errno == EINTR) return 0; // interrupted: treat as timeout to keep tasks responsive
+        HAL_MX_COUNT(h->mx, 1, 0, 1);
         return -2;
     }
     if (rc == 0) {
-        // timeout
+        // timeout (chờ dữ liệu không phải thời gian I/O: chỉ đếm)
+        HAL_MX_COUNT(h->mx, 0, 0, 1);
         return 0;
     }
 
     if (pfd.revents & POLLIN) {
+        HAL_MX_T0(t0);
         ssize_t n = read(h->fd, buf, len);
+        HAL_MX_REC(h->mx, t0, n < 0 && errno != EAGAIN && errno != EWOULDBLOCK, (n > 0) ? n : 0, 2);
         if (n < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
             return -3;
         }
+        if (n > 0) HAL_Rec_Put(HAL_REC_UART_RX, h->rec_chan, (int32_t)n, buf, (size_t)n, NULL, 0);
         return (long)n;
     }
     return 0;
@@ -0,0 +1,117 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "hal_gpio.h"
+#include "hal_i2c.h"
+#include "hal_spi.h"
+#include "hal_uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file board_desc.h
+ * @brief Board description: chips, named lines, groups, buses and devices
+ *        parsed from a text file at startup, opened lazily on first use.
+ *
+ * Format (một khai báo / dòng, '#' = comment, option dạng key=value):
+ *
+ *   chip   gpio0  gpiochip0
+ *   line   LED0   gpio0:0  out [active_low] [init=0|1] [drive=pushpull|opendrain|opensource]
+ *   line   BTN0   gpio0:8  in  [active_low] [edge=none|rising|falling|both] [bias=as_is|pull_up|pull_down|disable] [debounce=ms]
+ *   group  leds   LED0 LED1 LED2 LED3          # bit i = line thứ i
+ *   i2c    i2c0   /dev/i2c-0      [speed=100000] [match=...]
+ *   spi    spi0   /dev/spidev0.0  [mode=0] [speed=1000000] [bits=8] [lsb_first] [match=...]
+ *   uart   uart0  /dev/ttyPS0     [baud=115200] [data=8] [stop=1] [parity=none|even|odd] [flow] [nonblock] [match=...]
+ *   device tmp102 i2c0 addr=0x48  [kind=tmp102]
+ *
+ * Notes:
+ *  - Không mở gì lúc parse. BoardDesc_Line()/I2c()/Spi()/Uart() mở resource
+ *    (và chip cha) ở lần gọi đầu tiên, lần sau trả handle đã cache.
+ *    Thread-safe: mỗi resource có mutex riêng, nên các bus độc lập mở song song.
+ *  - BoardDesc_BringUp() mở trước một tập resource trên nhiều OSAL task
+ *    (mặc định: mọi chip + bus), process chỉ mở cái nó thật sự dùng.
+ *  - Lỗi mở được cache (không thử lại ở mỗi lần gọi); BoardDesc_Close() xoá cache.
+ *  - match= là chuỗi con của DEVPATH trong uevent (ví dụ cổng USB "1-1.2"),
+ *    dùng bởi device manager hot-plug (board_devmgr.h).
+ */
+
+typedef struct BoardDesc BoardDesc;
+
+typedef enum {
+    BOARD_RES_CHIP = 0,
+    BOARD_RES_LINE,
+    BOARD_RES_GROUP,
+    BOARD_RES_I2C,
+    BOARD_RES_SPI,
+    BOARD_RES_UART,
+    BOARD_RES_DEVICE,
+} BoardResKind;
+
+/* Mô tả một line (không mở) */
+typedef struct {
+    const char*        chip_dev;   ///< e.g. "gpiochip0"
+    HAL_GpioLineConfig cfg;        ///< offset, dir, active, edge...
+} BoardLineInfo;
+
+/* Một device trên bus */
+typedef struct {
+    BoardResKind bus_kind;         ///< BOARD_RES_I2C / SPI / UART
+    void*        bus;              ///< HAL_I2cBus* / HAL_SpiBus* / HAL_Uart* (đã mở)
+    uint16_t     addr;             ///< I2C addr7 (0 nếu không có)
+    const char*  kind;             ///< chuỗi kind= (có thể "")
+} BoardDevice;
+
+/* Thông tin một resource (theo chỉ số 0..Count-1) */
+typedef struct {
+    const char*  name;
+    BoardResKind kind;
+    const char*  dev;              ///< chip/bus path (device: kind=)
+    const char*  match;            ///< "" nếu không có
+} BoardResInfo;
+
+/* Parse; err (có thể NULL) nhận "line N: ..." khi lỗi */
+BoardDesc* BoardDesc_Load (const char* path, char* err, size_t err_len);
+BoardDesc* BoardDesc_Parse(const char* text, char* err, size_t err_len);
+void       BoardDesc_Free (BoardDesc* bd);   /* đóng mọi thứ đã mở */
+
+/* Tra cứu mô tả (không mở) */
+int        BoardDesc_Has(const BoardDesc* bd, BoardResKind kind, const char* name);
+int        BoardDesc_LineInfo(const BoardDesc* bd, const char* name, BoardLineInfo* out);
+
+/* Handle lazy: mở ở lần đầu; NULL nếu không có tên hoặc mở lỗi */
+HAL_GpioLine* BoardDesc_Line(BoardDesc* bd, const char* name);
+HAL_I2cBus*   BoardDesc_I2c (BoardDesc* bd, const char* name);
+HAL_SpiBus*   BoardDesc_Spi (BoardDesc* bd, const char* name);
+HAL_Uart*     BoardDesc_Uart(BoardDesc* bd, const char* name);
+
+/* Group: request mọi line của group; out->lines trỏ vào bộ nhớ của bd. Trả 0 nếu OK */
+int           BoardDesc_Group (BoardDesc* bd, const char* name, HAL_GpioGroup* out);
+/* Device: mở bus cha. Trả 0 nếu OK */
+int           BoardDesc_Device(BoardDesc* bd, const char* name, BoardDevice* out);
+
+/* Theo tên, mọi kind; NULL nếu không có / lỗi */
+void*         BoardDesc_Open(BoardDesc* bd, const char* name);
+/* Handle nếu đã mở, KHÔNG mở */
+void*         BoardDesc_Peek(BoardDesc* bd, const char* name);
+
+/* Hot-plug: đóng resource + mọi thứ phụ thuộc (line/device/group); lần dùng sau mở lại.
+ * Caller phải đảm bảo không ai còn dùng handle cũ. */
+int           BoardDesc_Close (BoardDesc* bd, const char* name);
+/* Đổi đường dẫn chip/bus (đóng trước nếu đang mở) */
+int           BoardDesc_Rebind(BoardDesc* bd, const char* name, const char* dev);
+unsigned      BoardDesc_Count (const BoardDesc* bd);
+int           BoardDesc_Info  (const BoardDesc* bd, unsigned idx, BoardResInfo* out);
+
+/**
+ * @brief Mở trước nhiều resource song song.
+ * @param names   danh sách tên (NULL = mọi chip + bus i2c/spi/uart)
+ * @param workers số task (0 = 4); caller cũng tham gia làm việc
+ * @return số resource mở lỗi (0 = tất cả OK)
+ */
+int           BoardDesc_BringUp(BoardDesc* bd, const char* const* names, unsigned count, unsigned workers);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "board_desc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file board_devmgr.h
+ * @brief Hot-plug device manager: kernel uevents (netlink) -> open/close
+ *        board-description buses incrementally, notify subscribers.
+ *
+ * Match (cho entry i2c / spi / uart trong board file):
+ *  - SUBSYSTEM phải đúng loại (tty / i2c-dev / spidev);
+ *  - nếu entry có match=..., DEVPATH phải chứa chuỗi đó (cổng USB ổn định,
+ *    ví dụ "usb1/1-1/1-1.2/"), device node mới = /dev/$DEVNAME;
+ *  - nếu không, DEVNAME phải trùng basename của dev trong board file.
+ *
+ * "add"    -> Rebind + mở (thử lại vài lần nếu node chưa kịp xuất hiện) -> ADDED.
+ * "remove" -> REMOVED (handle còn hợp lệ trong callback) -> đóng.
+ * Callback chạy trên task của manager; không được giữ handle sau REMOVED.
+ *
+ * Không cần quyền netlink để test: BoardDevMgr_Inject() đẩy một uevent
+ * (định dạng kernel "ACTION@DEVPATH\0KEY=VAL\0...", hoặc phân cách '\n')
+ * vào cùng đường xử lý.
+ */
+
+typedef enum {
+    BOARD_DEV_ADDED = 0,
+    BOARD_DEV_REMOVED,
+} BoardDevEvent;
+
+typedef void (*BoardDevCb)(const char* name, BoardDevEvent ev, void* handle, void* user);
+
+typedef struct {
+    int      no_netlink;      ///< 1 = chỉ nhận uevent qua Inject (test)
+    uint32_t retry_ms;        ///< chờ giữa các lần thử mở sau "add" (0 -> 20)
+    uint32_t retry_count;     ///< số lần thử (0 -> 10)
+    uint8_t  task_prio;       ///< 0 -> 10
+} BoardDevMgrCfg;
+
+typedef struct {
+    uint64_t uevents;         ///< uevent đã nhận (netlink + inject)
+    uint64_t matched;         ///< uevent khớp một entry
+    uint64_t opened;          ///< mở thành công sau "add"
+    uint64_t open_failed;     ///< hết lượt thử
+    uint64_t removed;
+} BoardDevMgrStats;
+
+/* bd phải sống lâu hơn manager. cfg = NULL -> mặc định. Trả 0 nếu OK */
+int  BoardDevMgr_Start(BoardDesc* bd, const BoardDevMgrCfg* cfg);
+void BoardDevMgr_Stop(void);
+
+/* name = NULL: mọi entry. Entry đang mở được báo ADDED ngay khi subscribe. Trả id >= 0 */
+int  BoardDevMgr_Subscribe(const char* name, BoardDevCb cb, void* user);
+void BoardDevMgr_Unsubscribe(int id);
+
+/* Đẩy một uevent (thread-safe). Trả 0 nếu OK */
+int  BoardDevMgr_Inject(const char* uevent, size_t len);
+
+void BoardDevMgr_GetStats(BoardDevMgrStats* out);
+
+#ifdef __cplusplus
+}
+#endif
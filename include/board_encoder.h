@@ -0,0 +1,88 @@
+#pragma once
+#include <stdint.h>
+#include "hal_gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file board_encoder.h
+ * @brief Quadrature encoder (rotary / linear) trên event cạnh GPIO.
+ *
+ * Line A/B (và index Z tuỳ chọn) được request với edge BOTH, không debounce.
+ * Mỗi vòng Poll:
+ *  - poll() chung trên event fd của mọi line (backend không có fd, vd. sim:
+ *    đọc không chờ, ngủ 1 ms nếu trống);
+ *  - HAL_GpioLine_ReadEvents() rút cả lô event của từng line (một read());
+ *  - ghép các line theo timestamp rồi cho qua bảng trạng thái 16 ô
+ *    (prev AB, next AB) -> +1 / -1 / không hợp lệ. Giải mã x4: một chu kỳ
+ *    A/B = 4 count.
+ *
+ * Thứ tự giữa các line: kernel đóng dấu thời gian ở IRQ nhưng event có thể
+ * vào hàng đợi trễ hơn một chút, nên event mới hơn (now - merge_guard_us)
+ * được giữ lại tới vòng sau thay vì giải mã sai thứ tự.
+ *
+ * Đọc từ task khác (Position / Velocity / GetStats) là wait-free: decoder
+ * publish bằng store atomic 64-bit, reader chỉ load (không lock, không retry).
+ *
+ * Velocity (M/T): số count trong cửa sổ vel_window_us chia cho khoảng thời
+ * gian giữa hai timestamp event ở hai đầu cửa sổ; không có cạnh lâu hơn
+ * vel_timeout_ms -> 0.
+ *
+ * Ví dụ:
+ *   BoardEncoderCfg c = { .chip_name = "gpiochip0", .a_offset = 17, .b_offset = 27, .z_offset = -1 };
+ *   BoardEncoder* enc;
+ *   BoardEncoder_Open(&c, &enc);
+ *   BoardEncoder_Start(enc, 10);
+ *   ... BoardEncoder_Position(enc), BoardEncoder_Velocity(enc) ...
+ */
+
+typedef struct BoardEncoder BoardEncoder;
+
+typedef struct {
+    const char*    chip_name;
+    HAL_GpioChip*  chip;              /* chip đã mở (dùng chung, Close không đóng); NULL -> mở chip_name */
+    int            a_offset, b_offset;
+    int            z_offset;          /* -1 = không có index */
+    HAL_GpioActive active;
+    HAL_GpioBias   bias;
+    uint8_t        reverse;           /* 1: đảo chiều đếm */
+    uint8_t        z_reset;           /* 1: cạnh lên của Z đưa position về 0 */
+    uint32_t       vel_window_us;     /* 0 -> 2000 */
+    uint32_t       vel_timeout_ms;    /* 0 -> 100 */
+    uint32_t       merge_guard_us;    /* 0 -> 200 */
+    /* clock của timestamp event; NULL = CLOCK_MONOTONIC (clock của kernel) */
+    uint64_t     (*now_ns)(void* ctx);
+    void*          now_ctx;
+} BoardEncoderCfg;
+
+typedef struct {
+    uint64_t edges;        /* event A/B đã giải mã */
+    uint64_t illegal;      /* chuyển trạng thái không hợp lệ (mất cạnh, nhảy 2 bước) */
+    uint64_t index;        /* số cạnh lên của Z */
+    int64_t  index_pos;    /* position tại cạnh Z gần nhất (trước khi reset) */
+    uint64_t batches;      /* vòng Poll có event */
+    uint64_t max_batch;    /* số event lớn nhất trong một vòng */
+    uint64_t late;         /* event tới sau event mới hơn của line khác đã giải mã */
+} BoardEncoderStats;
+
+/* Trả 0 nếu OK; < 0 nếu không mở được chip / line */
+int     BoardEncoder_Open (const BoardEncoderCfg* cfg, BoardEncoder** out);
+void    BoardEncoder_Close(BoardEncoder* enc);   /* Stop() nếu đang chạy */
+
+/* Một vòng: chờ tối đa timeout_ms, giải mã mọi event đã tới. Trả về số event
+ * đã giải mã, < 0 nếu lỗi. Chỉ một thread gọi (hoặc dùng Start). */
+int     BoardEncoder_Poll (BoardEncoder* enc, int timeout_ms);
+/* Task OSAL chạy Poll liên tục */
+int     BoardEncoder_Start(BoardEncoder* enc, uint8_t task_prio);
+void    BoardEncoder_Stop (BoardEncoder* enc);
+
+/* wait-free, gọi từ bất kỳ task nào */
+int64_t BoardEncoder_Position(const BoardEncoder* enc);
+double  BoardEncoder_Velocity(const BoardEncoder* enc);   /* count/s */
+void    BoardEncoder_GetStats(const BoardEncoder* enc, BoardEncoderStats* out);
+
+#ifdef __cplusplus
+}
+#endif
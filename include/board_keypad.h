@@ -0,0 +1,110 @@
+#pragma once
+#include <stdint.h>
+#include "hal_gpio.h"
+#include "osal_queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file board_keypad.h
+ * @brief Quét bàn phím ma trận N hàng x M cột (tới 32 x 32) trên HAL GPIO group.
+ *
+ * Mỗi bước quét chọn một hàng bằng một lần HAL_GpioGroup_WriteMask chỉ chạm
+ * hai line (bỏ hàng trước, chọn hàng này), rồi đọc cả M cột thành một bitmap
+ * bằng HAL_GpioGroup_ReadBitmap. Cả ma trận là N bitmap, nên:
+ *  - debounce: giữ debounce_scans lần quét gần nhất của từng hàng; phím chỉ
+ *    đổi trạng thái khi mọi lần quét trong cửa sổ cùng ấn (AND) / cùng nhả
+ *    (OR = 0). Mọi phím của một hàng xử lý cùng lúc bằng phép bit;
+ *  - ghosting: không có diode, ba phím ở ba góc hình chữ nhật làm góc thứ tư
+ *    "được ấn". Hai hàng chung >= 2 cột là có hình chữ nhật: phím mới ấn ở
+ *    các cột chung đó bị giữ lại (không phát event) tới khi hết mơ hồ; phím
+ *    đã ấn từ trước và phím nhả vẫn đi bình thường.
+ *
+ * Event ấn / nhả (BoardKeypadEvent) được gửi vào một OSAL queue, không chờ:
+ * queue đầy thì event bị bỏ và đếm vào stats.dropped.
+ *
+ * Tốc độ quét thích nghi:
+ *  - active: quét cả ma trận mỗi scan_us;
+ *  - idle: khi mọi phím đã nhả đủ idle_ms, chọn tất cả hàng cùng lúc và chờ
+ *    event cạnh trên line cột (poll() trên event fd, không tốn CPU). Ấn bất
+ *    kỳ phím nào kéo cột của nó -> thức dậy, quay lại active. Backend không có
+ *    event fd (vd. sim) thì idle đọc bitmap cột mỗi KEYPAD_IDLE_POLL_MS.
+ *
+ * Phần cứng thường gặp: hàng open-drain active-low, cột pull-up active-low:
+ *   BoardKeypadCfg c = { .chip_name = "gpiochip0",
+ *                        .row_offsets = rows, .nrows = 8, .col_offsets = cols, .ncols = 8,
+ *                        .active = HAL_GPIO_ACTIVE_LOW, .col_bias = HAL_GPIO_BIAS_PULL_UP };
+ *   BoardKeypad* kp;
+ *   BoardKeypad_Open(&c, &kp);
+ *   BoardKeypad_Start(kp, 20);
+ *   BoardKeypadEvent ev;
+ *   while (OSAL_QueueReceive(BoardKeypad_Queue(kp), &ev, OSAL_WAIT_FOREVER) == OSAL_OK) ...
+ *
+ * Hàng được request open-drain (active-low) / open-source (active-high) để hai
+ * phím cùng cột không chập hai output với nhau; rows_pushpull = 1 cho board có
+ * diode hoặc buffer trên hàng.
+ */
+
+#define BOARD_KEYPAD_MAX_ROWS 32
+#define BOARD_KEYPAD_MAX_COLS 32
+#define BOARD_KEYPAD_DEB_MAX  8
+
+typedef struct BoardKeypad BoardKeypad;
+
+typedef struct {
+    const char*      chip_name;
+    HAL_GpioChip*    chip;            /* chip đã mở (dùng chung, Close không đóng); NULL -> mở chip_name */
+    const int*       row_offsets;     /* nrows phần tử */
+    uint8_t          nrows;
+    const int*       col_offsets;     /* ncols phần tử */
+    uint8_t          ncols;
+    HAL_GpioActive   active;          /* cho cả hàng lẫn cột: logic 1 = hàng được chọn / cột bị ấn */
+    HAL_GpioBias     col_bias;
+    uint8_t          rows_pushpull;   /* 1: hàng push-pull (có diode / buffer) */
+    uint32_t         scan_us;         /* chu kỳ quét cả ma trận khi active; 0 -> 1000 */
+    uint32_t         settle_us;       /* chờ sau khi chọn hàng, trước khi đọc cột; 0 -> không chờ */
+    uint8_t          debounce_scans;  /* 1..BOARD_KEYPAD_DEB_MAX; 0 -> 4 */
+    uint32_t         idle_ms;         /* nhả hết bao lâu thì về idle; 0 -> 50 */
+    OSAL_QueueHandle queue;           /* NULL -> tạo queue riêng (depth 32) */
+    /* clock của timestamp event; NULL = CLOCK_MONOTONIC */
+    uint64_t       (*now_ns)(void* ctx);
+    void*            now_ctx;
+} BoardKeypadCfg;
+
+typedef struct {
+    uint8_t  row, col;
+    uint8_t  pressed;                 /* 1 = ấn, 0 = nhả */
+    uint64_t t_ns;                    /* thời điểm lần quét xác nhận trạng thái mới */
+} BoardKeypadEvent;
+
+typedef struct {
+    uint64_t scans;                   /* lần quét cả ma trận */
+    uint64_t events;                  /* event đã vào queue */
+    uint64_t dropped;                 /* queue đầy */
+    uint64_t ghost;                   /* lần quét có phím bị giữ vì ghosting */
+    uint64_t wakeups;                 /* idle -> active */
+} BoardKeypadStats;
+
+/* Trả 0 nếu OK; < 0 nếu cấu hình sai / không mở được chip, line, queue */
+int  BoardKeypad_Open (const BoardKeypadCfg* cfg, BoardKeypad** out);
+void BoardKeypad_Close(BoardKeypad* kp);     /* Stop() nếu đang chạy; xoá queue nếu tự tạo */
+
+/* Một bước: idle -> chờ phím tối đa timeout_ms; active -> chờ tới lượt quét
+ * (không quá timeout_ms) rồi quét cả ma trận. timeout_ms = 0: quét / kiểm tra
+ * ngay, không ngủ. Trả về số event đã phát, < 0 nếu lỗi. Chỉ một thread gọi. */
+int  BoardKeypad_Poll (BoardKeypad* kp, int timeout_ms);
+/* Task OSAL chạy Poll liên tục */
+int  BoardKeypad_Start(BoardKeypad* kp, uint8_t task_prio);
+void BoardKeypad_Stop (BoardKeypad* kp);
+
+OSAL_QueueHandle BoardKeypad_Queue(const BoardKeypad* kp);
+/* Bitmap cột đã debounce của một hàng (wait-free, gọi từ bất kỳ task nào) */
+uint32_t BoardKeypad_RowState(const BoardKeypad* kp, int row);
+int      BoardKeypad_IsIdle  (const BoardKeypad* kp);
+void     BoardKeypad_GetStats(const BoardKeypad* kp, BoardKeypadStats* out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -5,16 +5,47 @@
 extern "C" {
 #endif
 
+#define BOARD_LED_MAX        64   /* bit i của mask = LED i */
+#define BOARD_LED_MAX_CHIPS  8
+
+/* Một LED: chip + offset (LED có thể nằm rải rác trên nhiều chip) */
+typedef struct {
+    const char* chip_name;   // ví dụ: "gpiochip0"
+    unsigned    offset;
+} BoardLedPin;
+
+typedef struct {
+    const BoardLedPin* pins;      // pins[i] = LED i
+    unsigned           count;     // 1..BOARD_LED_MAX
+    int                active_low;
+    const char*        consumer;  // NULL -> "osal_led"
+} BoardLedCfg;
+
+/* Init theo platform_ctx (OSAL_GpiodCtx: 1 chip, offset liên tiếp) – giữ tương thích */
 void BoardLed_Init(void);
 
+/* Init tổng quát: mỗi chip một bulk request. Trả 0 nếu OK. */
+int  BoardLed_InitCfg(const BoardLedCfg* cfg);
+void BoardLed_Deinit(void);
+unsigned BoardLed_Count(void);
+
+/* Các hàm ghi trả 0 nếu OK, -1 nếu chưa init / index sai / ghi GPIO lỗi.
+ * Chip ghi lỗi giữ trạng thái cũ trong cache, lần ghi sau sẽ thử lại. */
+
 /* API bật/tắt toàn bộ LED */
-void BoardLed_Set(uint8_t on);
+int  BoardLed_Set(uint8_t on);
+
+/* API ghi toàn bộ LED theo mặt nạ 64 bit (bit=1 -> LED ON) */
+int  BoardLed_WriteMask(uint64_t mask);
+
+/* Chỉ các LED trong mask đổi theo value; mỗi chip bị ảnh hưởng = 1 lần ghi bulk */
+int  BoardLed_WriteMasked(uint64_t mask, uint64_t value);
 
-/* API ghi theo mặt nạ 8 bit (bit=1 -> LED ON) */
-void BoardLed_WriteMask(uint8_t mask);
+/* API ghi một LED theo chỉ số (0..count-1) */
+int  BoardLed_WriteOne(unsigned index, uint8_t on);
 
-/* API ghi một LED theo chỉ số (0..7) */
-void BoardLed_WriteOne(unsigned index, uint8_t on);
+/* Trạng thái logic hiện tại (cache, không đọc lại GPIO) */
+uint64_t BoardLed_GetState(void);
 
 #ifdef __cplusplus
 }
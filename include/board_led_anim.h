@@ -0,0 +1,79 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file board_led_anim.h
+ * @brief LED animation service on top of BoardLed.
+ *
+ * Một task OSAL chạy tick cố định (OSAL_TaskDelayUntilUs). Mỗi tick:
+ *  - mọi pattern đang chạy được ghép thành MỘT frame bitmap (bit i = LED i),
+ *    pattern priority cao hơn ghi đè LED chồng lấn;
+ *  - frame chỉ được commit (một lần ghi bulk) nếu khác frame trước, và chỉ
+ *    ghi các LED thuộc mask của pattern đang chạy (LED khác không bị đụng).
+ * => N animation = 1 task + tối đa 1 syscall / tick.
+ *
+ * Ví dụ:
+ *   BoardLedAnim_Start(NULL);                               // tick 1 ms
+ *   BoardLedAnimSpec hb = { .kind = BOARD_LED_ANIM_BREATHE, .mask = 0x01, .period_ms = 2000 };
+ *   BoardLedAnimSpec st = { .kind = BOARD_LED_ANIM_BLINK,   .mask = 0x80, .period_ms = 250, .duty_pct = 20 };
+ *   BoardLedAnim_Add(&hb);
+ *   BoardLedAnim_Add(&st);
+ */
+
+#define BOARD_LED_ANIM_MAX 32   /* số pattern chạy đồng thời */
+
+typedef enum {
+    BOARD_LED_ANIM_SOLID = 0,  /* value != 0 -> ON */
+    BOARD_LED_ANIM_BLINK,      /* period_ms = chu kỳ, duty_pct = % ON */
+    BOARD_LED_ANIM_BREATHE,    /* PWM mềm, sáng dần/tối dần trong period_ms */
+    BOARD_LED_ANIM_CHASE,      /* 1 LED chạy qua các bit của mask, mỗi bước period_ms */
+    BOARD_LED_ANIM_COUNTER,    /* hiển thị value lên các bit của mask; period_ms > 0: tự +1 */
+} BoardLedAnimKind;
+
+typedef struct {
+    BoardLedAnimKind kind;
+    uint64_t mask;        /* tập LED áp dụng (bit i = LED i) */
+    uint32_t period_ms;
+    uint8_t  duty_pct;    /* BLINK: 0 -> 50% */
+    int8_t   reverse;     /* CHASE: 1 = chạy ngược */
+    uint8_t  priority;    /* ghép frame: cao hơn thắng */
+    uint32_t value;       /* SOLID: on/off, COUNTER: giá trị đầu */
+    uint32_t repeat;      /* số chu kỳ rồi tự xoá; 0 = mãi mãi */
+} BoardLedAnimSpec;
+
+typedef struct {
+    uint32_t tick_us;     /* 0 -> 1000 */
+    uint8_t  pwm_steps;   /* mức sáng của BREATHE (chu kỳ PWM = pwm_steps tick); 0 -> 16 */
+    uint8_t  task_prio;   /* 0 -> 20 */
+} BoardLedAnimCfg;
+
+typedef struct {
+    uint64_t ticks;       /* số tick đã chạy */
+    uint64_t commits;     /* số frame thực sự ghi ra GPIO */
+    uint64_t commit_errors; /* lần ghi BoardLed lỗi (frame sẽ được ghi lại tick sau) */
+    uint64_t overruns;    /* tick bị trễ > 1 chu kỳ */
+    uint64_t frame;       /* frame hiện tại */
+    uint64_t owned;       /* LED mà animation đang điều khiển */
+    uint32_t active;      /* số pattern đang chạy */
+} BoardLedAnimStats;
+
+typedef int BoardLedAnimId;   /* > 0 hợp lệ, < 0 lỗi */
+
+/* Gọi BoardLed_Init() trước. cfg = NULL -> mặc định. Trả 0 nếu OK. */
+int            BoardLedAnim_Start(const BoardLedAnimCfg* cfg);
+void           BoardLedAnim_Stop(void);
+
+BoardLedAnimId BoardLedAnim_Add(const BoardLedAnimSpec* spec);
+int            BoardLedAnim_Remove(BoardLedAnimId id);
+void           BoardLedAnim_Clear(void);
+int            BoardLedAnim_SetValue(BoardLedAnimId id, uint32_t value);  /* SOLID / COUNTER */
+
+void           BoardLedAnim_GetStats(BoardLedAnimStats* out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,99 @@
+#pragma once
+#include <stdint.h>
+#include "hal_gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file board_ledmatrix.h
+ * @brief Quét ma trận LED multiplex hàng/cột (tới 32 x 32) với timing cố định
+ *        và độ sáng theo binary code modulation (BCM).
+ *
+ * Một task OSAL riêng (nên chạy SCHED_FIFO) quét lần lượt từng hàng. Mọi mốc
+ * thời gian là deadline tuyệt đối nối tiếp nhau (clock_nanosleep TIMER_ABSTIME
+ * trên CLOCK_MONOTONIC), nên lỗi trễ của một lần ngủ không cộng dồn sang các
+ * hàng / frame sau như khi dùng OSAL_TaskDelayMs.
+ *
+ * Thời gian của một hàng = 2^bcm_bits đơn vị (unit):
+ *
+ *   | blank | plane b-1 (2^(b-1) unit) | ... | plane 1 (2u) | plane 0 (1u) |
+ *
+ * blank: tắt cột, đổi hàng, chờ 1 unit (tránh bóng mờ sang hàng kế). Plane k
+ * là bitmap các cột có bit k của mức sáng = 1, hiện trong 2^k unit => độ sáng
+ * tuyến tính 0..2^bcm_bits - 1 mà mỗi hàng chỉ tốn bcm_bits + 1 lần đổi cột.
+ *
+ * Frame: producer vẽ vào buffer riêng (SetPixel / SetRow / Clear) rồi Commit.
+ * Commit dựng bitplane vào một trong ba slot và đổi slot "mới nhất" bằng một
+ * phép xchg atomic; task chỉ lấy frame mới ở đầu frame. Không ai chờ ai, và
+ * không bao giờ hiện nửa frame cũ nửa frame mới (không tearing).
+ *
+ * Jitter: mỗi lần thức dậy đo độ trễ so với deadline (late_*). Trễ quá một
+ * unit là overrun; trễ quá cả một hàng thì frame bắt lại mốc hiện tại.
+ *
+ * Ví dụ (8 x 8, hàng chọn bằng PNP active-low, cột sink active-high):
+ *   BoardLedMatrixCfg c = { .chip_name = "gpiochip0",
+ *                           .row_offsets = rows, .nrows = 8, .row_active = HAL_GPIO_ACTIVE_LOW,
+ *                           .col_offsets = cols, .ncols = 8,
+ *                           .refresh_hz = 200, .bcm_bits = 4 };
+ *   BoardLedMatrix* m;
+ *   BoardLedMatrix_Open(&c, &m);
+ *   BoardLedMatrix_Start(m, 90);
+ *   BoardLedMatrix_SetPixel(m, 3, 2, 15);
+ *   BoardLedMatrix_Commit(m);
+ */
+
+#define BOARD_LEDMATRIX_MAX_ROWS 32
+#define BOARD_LEDMATRIX_MAX_COLS 32
+#define BOARD_LEDMATRIX_MAX_BITS 8
+
+typedef struct BoardLedMatrix BoardLedMatrix;
+
+typedef struct {
+    const char*    chip_name;
+    HAL_GpioChip*  chip;          /* chip đã mở (dùng chung, Close không đóng); NULL -> mở chip_name */
+    const int*     row_offsets;
+    uint8_t        nrows;
+    HAL_GpioActive row_active;    /* logic 1 = hàng được chọn */
+    const int*     col_offsets;
+    uint8_t        ncols;
+    HAL_GpioActive col_active;    /* logic 1 = LED của cột sáng */
+    uint32_t       refresh_hz;    /* frame / s; 0 -> 200 */
+    uint8_t        bcm_bits;      /* 1..BOARD_LEDMATRIX_MAX_BITS; 0 -> 4 */
+} BoardLedMatrixCfg;
+
+typedef struct {
+    uint64_t frames;
+    uint64_t commits;             /* frame mới task đã lấy */
+    uint64_t col_writes;          /* line cột thực sự ghi (chỉ bit đổi) */
+    uint64_t overruns;            /* thức dậy trễ > 1 unit */
+    uint64_t resyncs;             /* trễ > 1 hàng: frame bắt lại mốc */
+    uint32_t unit_us;             /* đơn vị BCM thực tế */
+    uint32_t late_avg_us;         /* trễ trung bình so với deadline */
+    uint32_t late_max_us;
+    double   refresh_hz;          /* tốc độ frame đo được */
+} BoardLedMatrixStats;
+
+/* Trả 0 nếu OK; < 0 nếu cấu hình sai (unit < 1 µs) / không mở được chip, line */
+int  BoardLedMatrix_Open (const BoardLedMatrixCfg* cfg, BoardLedMatrix** out);
+void BoardLedMatrix_Close(BoardLedMatrix* m);              /* Stop() nếu đang chạy */
+
+int  BoardLedMatrix_Start(BoardLedMatrix* m, uint8_t task_prio);
+void BoardLedMatrix_Stop (BoardLedMatrix* m);              /* tắt mọi hàng / cột */
+
+/* Vẽ vào buffer của producer (một producer; nhiều thread thì tự khoá).
+ * level: 0..2^bcm_bits - 1 (lớn hơn bị kẹp). Chưa hiện cho tới khi Commit. */
+void BoardLedMatrix_SetPixel(BoardLedMatrix* m, int row, int col, uint8_t level);
+/* cột có bit trong bitmap = level, các cột khác = 0 */
+void BoardLedMatrix_SetRow  (BoardLedMatrix* m, int row, uint32_t bitmap, uint8_t level);
+void BoardLedMatrix_Clear   (BoardLedMatrix* m);
+void BoardLedMatrix_Commit  (BoardLedMatrix* m);
+
+/* late_* / overruns / resyncs tính từ lần ResetStats gần nhất */
+void BoardLedMatrix_GetStats  (const BoardLedMatrix* m, BoardLedMatrixStats* out);
+void BoardLedMatrix_ResetStats(BoardLedMatrix* m);
+
+#ifdef __cplusplus
+}
+#endif
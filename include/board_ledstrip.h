@@ -0,0 +1,99 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "hal_spi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file board_ledstrip.h
+ * @brief Dải LED địa chỉ hoá một dây (WS2812 / SK6812...) phát qua SPI MOSI.
+ *
+ * Mỗi bit dữ liệu của LED thành một symbol SPI 3 hoặc 4 bit (bit cao trước):
+ *   3 bit @ 2.4 MHz : 0 -> 100, 1 -> 110    (9 byte SPI / LED RGB)
+ *   4 bit @ 3.2 MHz : 0 -> 1000, 1 -> 1110  (12 byte SPI / LED RGB)
+ * Cả hai đều là 1.25 µs / bit LED (800 kHz), T0H / T1H trong dung sai WS2812B.
+ *
+ * Mã hoá: bảng tra 256 ô (một byte màu -> 3 / 4 byte SPI, một lần store).
+ * Symbol 4 bit có đường SIMD (x86 SSSE3 chọn lúc chạy, AArch64 NEON): 16 byte
+ * màu -> 64 byte SPI bằng 4 lần tra bảng nibble + store xen kẽ.
+ *
+ * Frame = toàn bộ dải + đuôi 0 dài reset_us (chốt dữ liệu ngay trong message)
+ * và được gửi bằng một HAL_Spi_Transfer. Dài hơn HAL_Spi_MaxMessage (spidev
+ * bufsiz, mặc định 4096) thì phải chia nhiều message: khoảng hở giữa hai
+ * message có thể đủ dài để LED chốt sớm -> nên tăng spidev.bufsiz.
+ *
+ * Double buffer: hai buffer SPI đi vòng qua hai OSAL queue (free -> ready).
+ * Show() mã hoá vào buffer rảnh rồi trao cho task TX; trong lúc buffer này
+ * đang trên dây, producer đã vẽ + mã hoá frame sau. Không Start() thì Show()
+ * gửi luôn trong thread gọi.
+ *
+ * Giới hạn vật lý: 24 bit x 1.25 µs = 30 µs / LED RGB, nên một dây 1000 LED
+ * tối đa ~33 fps dù CPU rảnh; 60 fps cần <= ~550 LED / dây (hoặc chia dải ra
+ * nhiều bus SPI, mỗi bus một BoardLedStrip).
+ *
+ * Ví dụ:
+ *   BoardLedStripCfg c = { .spi_dev = "/dev/spidev0.0", .count = 300 };
+ *   BoardLedStrip* s;
+ *   BoardLedStrip_Open(&c, &s);
+ *   BoardLedStrip_Start(s, 30);
+ *   for (;;) { for (i...) BoardLedStrip_SetPixel(s, i, r, g, b, 0); BoardLedStrip_Show(s); }
+ */
+
+typedef enum {
+    BOARD_LEDSTRIP_GRB = 0,      /* WS2812 / WS2812B */
+    BOARD_LEDSTRIP_RGB,
+    BOARD_LEDSTRIP_BRG,
+    BOARD_LEDSTRIP_GRBW,         /* SK6812 RGBW: 4 byte / LED */
+} BoardLedStripOrder;
+
+typedef struct BoardLedStrip BoardLedStrip;
+
+typedef struct {
+    const char*        spi_dev;      /* vd. "/dev/spidev0.0" (bỏ qua nếu có bus) */
+    HAL_SpiBus*        bus;          /* bus đã mở (dùng chung, Close không đóng); tốc độ bị đặt lại */
+    uint32_t           count;        /* số LED */
+    BoardLedStripOrder order;
+    uint8_t            sym_bits;     /* 3 hoặc 4; 0 -> 4 */
+    uint32_t           reset_us;     /* đuôi 0 để chốt; 0 -> 300 (WS2812B V5 cần >= 280) */
+    uint8_t            brightness;   /* 0 -> 255 */
+    uint8_t            no_simd;      /* 1: chỉ dùng bảng tra (so sánh / debug) */
+} BoardLedStripCfg;
+
+typedef struct {
+    uint64_t frames;                 /* frame đã gửi xong */
+    uint64_t messages;               /* HAL_Spi_Transfer đã gọi (> frames nếu bị chia) */
+    uint64_t tx_errors;
+    uint32_t frame_bytes;            /* byte SPI / frame (gồm đuôi reset) */
+    uint32_t max_message;            /* 0 = không giới hạn */
+    uint32_t encode_ns;              /* lần Show gần nhất: scale + mã hoá */
+    uint32_t tx_us;                  /* lần gửi gần nhất */
+    uint8_t  simd;                   /* đang dùng đường SIMD */
+} BoardLedStripStats;
+
+/* Trả 0 nếu OK; < 0 nếu cấu hình sai / không mở được bus / hết bộ nhớ */
+int  BoardLedStrip_Open (const BoardLedStripCfg* cfg, BoardLedStrip** out);
+void BoardLedStrip_Close(BoardLedStrip* s);                  /* Stop() + chờ frame đang gửi */
+
+/* Task TX (double buffer). Không gọi song song với Show. */
+int  BoardLedStrip_Start(BoardLedStrip* s, uint8_t task_prio);
+void BoardLedStrip_Stop (BoardLedStrip* s);
+
+/* Producer (một thread). w bỏ qua nếu không phải GRBW. */
+void     BoardLedStrip_SetPixel(BoardLedStrip* s, uint32_t i, uint8_t r, uint8_t g, uint8_t b, uint8_t w);
+void     BoardLedStrip_Fill    (BoardLedStrip* s, uint8_t r, uint8_t g, uint8_t b, uint8_t w);
+void     BoardLedStrip_SetBrightness(BoardLedStrip* s, uint8_t level);   /* áp dụng từ Show kế tiếp */
+/* Mã hoá frame hiện tại và gửi (task) / gửi luôn (không task). Chờ nếu cả
+ * hai buffer đều bận. 0 nếu OK, < 0 nếu lỗi SPI (chế độ không task). */
+int      BoardLedStrip_Show    (BoardLedStrip* s);
+/* Chờ mọi frame đã Show gửi xong */
+void     BoardLedStrip_Flush   (BoardLedStrip* s);
+uint32_t BoardLedStrip_Count   (const BoardLedStrip* s);
+
+void BoardLedStrip_GetStats(const BoardLedStrip* s, BoardLedStripStats* out);
+
+#ifdef __cplusplus
+}
+#endif
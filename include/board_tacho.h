@@ -0,0 +1,90 @@
+#pragma once
+#include <stdint.h>
+#include "hal_gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file board_tacho.h
+ * @brief Đo tần số / chu kỳ / duty / jitter cho các line input (tacho quạt,
+ *        flow meter...) từ timestamp của event cạnh.
+ *
+ * Một task OSAL cho mọi kênh: poll() chung trên event fd, rút event theo lô
+ * (HAL_GpioLine_ReadEvents), mỗi cạnh lên tạo một mẫu (period, high time).
+ * Mỗi kênh có ring cố định BOARD_TACHO_RING mẫu + tổng chạy (Σp, Σp², Σhigh):
+ * thêm/bỏ mẫu là O(1), không cấp phát, không tính lại cả cửa sổ (trừ bước
+ * chuẩn hoá lại tổng mỗi BOARD_TACHO_RING mẫu để số thực không trôi).
+ *
+ * Cửa sổ trượt theo cả số mẫu (ring) lẫn thời gian (window_ms): mẫu cũ hơn
+ * window_ms bị bỏ, và chỉ giữ BOARD_TACHO_RING chu kỳ gần nhất. Tín hiệu nhanh
+ * hơn BOARD_TACHO_RING / window_ms (64 Hz với 1 s) vì vậy được tính trên 64 chu
+ * kỳ cuối, ngắn hơn window_ms; khoảng thời gian thực sự dùng nằm trong
+ * BoardTachoResult.window_ns. Không có cạnh lên trong stall_ms -> stalled = 1,
+ * freq = 0.
+ *
+ * Kết quả publish bằng seqlock theo kênh: task ghi không bao giờ chờ reader,
+ * reader (BoardTacho_Get) không lock, chỉ đọc lại nếu đúng lúc đang ghi.
+ *
+ * Ví dụ:
+ *   BoardTacho_Start(NULL);
+ *   BoardTachoSpec fan = { .name = "fan0", .chip_name = "gpiochip0", .offset = 22,
+ *                          .bias = HAL_GPIO_BIAS_PULL_UP, .scale = 30.0 };  // 2 xung/vòng -> RPM
+ *   int id = BoardTacho_Add(&fan);
+ *   BoardTachoResult r; BoardTacho_Get(id, &r);  // r.value = RPM
+ */
+
+#define BOARD_TACHO_MAX  16    /* số kênh */
+#define BOARD_TACHO_RING 64    /* mẫu tối đa trong cửa sổ / kênh */
+
+typedef struct {
+    const char*    name;
+    const char*    chip_name;
+    HAL_GpioChip*  chip;          /* chip đã mở (dùng chung); NULL -> mở chip_name */
+    int            offset;
+    HAL_GpioActive active;
+    HAL_GpioBias   bias;
+    uint32_t       window_ms;     /* 0 -> 1000; tối đa BOARD_TACHO_RING chu kỳ */
+    uint32_t       stall_ms;      /* 0 -> 2 * window_ms */
+    double         scale;         /* value = freq_hz * scale; 0 -> 1 */
+} BoardTachoSpec;
+
+typedef struct {
+    uint64_t edges;               /* tổng cạnh lên */
+    uint32_t samples;             /* số chu kỳ trong cửa sổ */
+    uint8_t  stalled;
+    double   freq_hz;             /* 1 / period trung bình */
+    double   period_ns;
+    double   jitter_ns;           /* độ lệch chuẩn của period */
+    double   duty_pct;            /* high / period (chỉ chu kỳ có đủ 2 cạnh) */
+    double   value;               /* freq_hz * scale */
+    uint64_t window_ns;           /* thời gian các mẫu trong cửa sổ thực sự phủ */
+    uint64_t last_edge_ns;
+} BoardTachoResult;
+
+typedef struct {
+    uint8_t    task_prio;         /* 0 -> 20 */
+    uint32_t   idle_ms;           /* chu kỳ kiểm tra stall khi không có cạnh; 0 -> 50 */
+    /* clock của timestamp event; NULL = CLOCK_MONOTONIC */
+    uint64_t (*now_ns)(void* ctx);
+    void*      now_ctx;
+} BoardTachoCfg;
+
+/* cfg = NULL -> mặc định. no_task = 1: không tạo task, caller gọi BoardTacho_Poll. 0 nếu OK. */
+int  BoardTacho_Init(const BoardTachoCfg* cfg, int no_task);
+int  BoardTacho_Start(const BoardTachoCfg* cfg);     /* = Init(cfg, 0) */
+void BoardTacho_Stop(void);                          /* dừng task, release mọi kênh */
+
+/* Thêm kênh (được cả lúc task đang chạy). Trả về id >= 0, < 0 nếu lỗi. */
+int  BoardTacho_Add(const BoardTachoSpec* spec);
+/* Một vòng đo khi Init(no_task = 1); trả về số cạnh đã xử lý */
+int  BoardTacho_Poll(int timeout_ms);
+
+/* lock-free, gọi từ bất kỳ task nào. 0 nếu OK. */
+int  BoardTacho_Get(int id, BoardTachoResult* out);
+const char* BoardTacho_Name(int id);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,4 +1,5 @@
 #pragma once
+#include <stdint.h>
 #include "hal_gpio.h"
 
 #ifdef __cplusplus
@@ -7,7 +8,11 @@ extern "C" {
 
 /**
  * @brief Demo configuration (kept minimal and generic).
- * You pass offsets for LEDs (LSB at index 0) and two buttons.
+ * You pass offsets for LEDs (LSB at index 0) and two buttons, or lines that
+ * are already open (e.g. BoardDesc_Line(), opened lazily by the board): when
+ * led_lines[0] is set, led_lines[0..led_count-1] and btn_lines[] are used
+ * as-is (their own chip / active / edge config), DemoGpio does not request
+ * or release them, and chip_name / offsets / *_active_low are ignored.
  */
 typedef struct {
     const char* chip_name;     // e.g. "gpiochip0"
@@ -18,11 +23,36 @@ typedef struct {
     int         leds_active_low; // 1 if LEDs are active-low
     int         btns_active_low; // 1 if buttons active-low (pressed=0)
     int         debounce_ms;     // software debounce for buttons
+    int         poll_only;       // 1 = force 5 ms polling (default: edge events if backend supports)
+    HAL_GpioLine* led_lines[8];  // optional pre-opened LED lines (owned by caller)
+    HAL_GpioLine* btn_lines[2];  // optional pre-opened BTN0 / BTN1 (owned by caller)
 } DemoGpioCfg;
 
 void DemoGpio_Start(const DemoGpioCfg* cfg);
 void DemoGpio_Stop(void);
 
+/**
+ * @brief Debounce "settle window" của event mode (GpioTask), tách ra để đo
+ * được trên sim (bench_debounce): mỗi cạnh dời hạn chót = t_cạnh + window,
+ * hết hạn mà không có cạnh mới thì đọc mức ổn định.
+ */
+typedef struct {
+    HAL_GpioLine* line;         // request với edge != NONE, debounce_ms = 0
+    int           stable;       // mức logic đã ổn định (1 = nhấn)
+    int           pending;      // có cạnh chưa settle
+    uint64_t      settle_at_ns; // cùng đồng hồ với now_ns của Step
+    uint64_t      edges;        // số event đã rút
+    uint64_t      settles;      // số lần hết hạn -> đọc mức
+} DemoGpioSettle;
+
+/* Đọc mức ban đầu (không tính là cạnh) */
+void DemoGpio_SettleInit(DemoGpioSettle* b, HAL_GpioLine* line);
+/* drain != 0: rút hết event đang chờ (cạnh cuối quyết định hạn); rồi nếu đã
+ * hết hạn thì đọc mức. Trả 1 nếu stable vừa đổi, 0 nếu không. */
+int  DemoGpio_SettleStep(DemoGpioSettle* b, uint64_t now_ns, uint64_t window_ns, int drain);
+/* ms tới hạn settle (làm tròn lên, 0 nếu đã quá), -1 nếu không có cạnh chờ */
+int  DemoGpio_SettleTimeoutMs(const DemoGpioSettle* b, uint64_t now_ns);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,59 @@
+#pragma once
+#include "hal_gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file gpio_demo_core.h
+ * @brief Logic của gpio_daemon (BTN0 -> +1, BTN1 -> reset, đếm ra dãy LED)
+ *        tách khỏi socket/main loop, không có biến global.
+ *
+ * Mỗi GpioDemoCore là một instance độc lập (chip sim riêng), nên nhiều
+ * instance chạy song song trong cùng process được (scenario_runner).
+ * Thời gian do người gọi cấp: mỗi GpioDemoCore_Tick() là một chu kỳ poll
+ * step_ms – daemon gọi theo đồng hồ thật, runner gọi theo thời gian ảo.
+ */
+
+#define GPIO_DEMO_MAX_LEDS 8
+
+typedef struct {
+    const char* chip_name;        ///< vd "sim:sim-gpio"
+    int         led_count;        ///< 1..8
+    int         led_offsets[GPIO_DEMO_MAX_LEDS];
+    int         leds_active_low;
+    int         btn0_offset;      ///< increment
+    int         btn1_offset;      ///< reset
+    int         btns_active_low;
+    int         debounce_ms;      ///< <= 0 -> 5
+} GpioDemoCoreCfg;
+
+typedef struct {
+    GpioDemoCoreCfg cfg;
+    HAL_GpioChip*   chip;
+    HAL_GpioLine*   leds[GPIO_DEMO_MAX_LEDS];
+    HAL_GpioLine*   btn[2];
+    unsigned        count;        ///< 0..255
+    /* debounce: last = mẫu trước, acc = thời gian ổn định, stable = sau debounce */
+    int             last[2], acc[2], stable[2], prev[2];
+} GpioDemoCore;
+
+/* Tick() trả về bitmask sự kiện trong chu kỳ đó */
+#define GPIO_DEMO_EV_INC   (1u << 0)   ///< BTN0 cạnh lên -> count++
+#define GPIO_DEMO_EV_RESET (1u << 1)   ///< BTN1 cạnh lên -> count = 0
+
+/* 0 nếu OK, <0 nếu mở chip / request line lỗi (đã tự dọn) */
+int      GpioDemoCore_Init  (GpioDemoCore* d, const GpioDemoCoreCfg* cfg);
+void     GpioDemoCore_Deinit(GpioDemoCore* d);
+/* một chu kỳ poll: đọc nút, debounce, cập nhật LED */
+unsigned GpioDemoCore_Tick  (GpioDemoCore* d, int step_ms);
+
+/* Chỉ với chip sim: giả lập nhấn/thả nút idx (0/1), đọc LED thật đang xuất.
+ * GetLeds trả bitmap (bit i = LED i), out[] tuỳ chọn. */
+int      GpioDemoCore_SetButton(GpioDemoCore* d, int idx, int pressed);
+unsigned GpioDemoCore_GetLeds  (GpioDemoCore* d, int* out, int n);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,123 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file gpio_shm.h
+ * @brief Transport shared-memory cho lệnh gpio_daemon: một command ring
+ *        MPSC (mọi client -> daemon) + một completion ring / client
+ *        (daemon -> client), doorbell eventfd chỉ rung khi bên nhận đang ngủ.
+ *
+ * Thương lượng qua socket sẵn có (/tmp/gpio_sim.sock):
+ *   client -> "SHM\n"
+ *   daemon -> "OK SHM <slot>\n" + SCM_RIGHTS { memfd vùng chung, eventfd lệnh, eventfd completion }
+ *             hoặc "ERR\n" (hết slot / daemon không hỗ trợ)
+ * Socket vẫn giữ kết nối: đóng socket = daemon thu hồi slot.
+ *
+ * Hot path không có syscall: client ghi lệnh vào ring (CAS trên enq_pos),
+ * daemon poll ring giữa các tick. eventfd chỉ được ghi khi cờ idle/waiting
+ * của phía kia bật (phía kia bật cờ rồi kiểm ring lần nữa trước khi ngủ).
+ *
+ * Vùng chung dùng chung cho mọi client shm (client tin cậy, cùng máy):
+ * một client lỗi có thể làm hỏng ring của client khác, không ảnh hưởng socket.
+ */
+
+#define GPIO_SHM_MAGIC        0x52485347u   /* "GSHR" */
+#define GPIO_SHM_VERSION      1u
+#define GPIO_SHM_CMD_SLOTS    4096u         /* luỹ thừa 2 */
+#define GPIO_SHM_CPL_SLOTS    1024u         /* luỹ thừa 2; = số lệnh tối đa đang bay / client */
+#define GPIO_SHM_MAX_CLIENTS  16u
+#define GPIO_SHM_CACHELINE    64
+
+typedef enum {
+    GPIO_SHM_OP_NOP = 0,
+    GPIO_SHM_OP_PRESS,      ///< arg = nút 0/1
+    GPIO_SHM_OP_RELEASE,    ///< arg = nút 0/1
+    GPIO_SHM_OP_GETLED,
+} GpioShmOp;
+
+typedef struct {
+    uint32_t seq;           ///< sequence của cell (ring Vyukov), chỉ truy cập atomic
+    uint16_t client;        ///< slot
+    uint16_t gen;           ///< thế hệ slot: lệnh của client cũ bị bỏ
+    uint8_t  op;
+    uint8_t  arg;
+    uint16_t rsv;
+    uint32_t tag;           ///< client tự đặt, trả lại trong completion
+} GpioShmCmd;
+
+typedef struct {
+    uint32_t tag;
+    uint8_t  status;        ///< 0 OK, 1 ERR
+    uint8_t  leds;          ///< bitmap LED0..7 sau lệnh
+    uint16_t count;         ///< bộ đếm demo sau lệnh
+} GpioShmCpl;
+
+typedef struct {
+    _Alignas(GPIO_SHM_CACHELINE) uint32_t head;     ///< client đọc tới đâu (client ghi)
+    _Alignas(GPIO_SHM_CACHELINE) uint32_t tail;     ///< daemon ghi tới đâu (daemon ghi)
+    _Alignas(GPIO_SHM_CACHELINE) uint32_t waiting;  ///< 1 = client đang ngủ trên eventfd completion
+    uint32_t gen;                                   ///< thế hệ slot hiện tại (daemon ghi)
+    GpioShmCpl ring[GPIO_SHM_CPL_SLOTS];
+} GpioShmCplRing;
+
+typedef struct {
+    uint32_t magic, version, cmd_slots, cpl_slots, max_clients;
+    _Alignas(GPIO_SHM_CACHELINE) uint32_t enq_pos;  ///< producer (mọi client, CAS)
+    _Alignas(GPIO_SHM_CACHELINE) uint32_t deq_pos;  ///< consumer (daemon)
+    _Alignas(GPIO_SHM_CACHELINE) uint32_t idle;     ///< 1 = daemon sắp ngủ / đang ngủ trong select
+    _Alignas(GPIO_SHM_CACHELINE) GpioShmCmd cmd[GPIO_SHM_CMD_SLOTS];
+    GpioShmCplRing cpl[GPIO_SHM_MAX_CLIENTS];
+} GpioShmRegion;
+
+/* ======================= phía daemon ======================= */
+
+typedef struct {
+    GpioShmRegion* rg;
+    int            memfd;
+    int            cmd_efd;                         ///< doorbell client -> daemon
+    int            cpl_efd[GPIO_SHM_MAX_CLIENTS];   ///< doorbell daemon -> client, -1 = slot trống
+    uint64_t       served, dropped;
+} GpioShmServer;
+
+/* Xử lý một lệnh, điền completion (tag đã điền sẵn). */
+typedef void (*GpioShmHandler)(void* ctx, const GpioShmCmd* cmd, GpioShmCpl* out);
+
+int    GpioShmServer_Init  (GpioShmServer* s);           /* 0 OK */
+void   GpioShmServer_Deinit(GpioShmServer* s);
+/* Trả lời lệnh "SHM" trên sock_fd (gửi fd); trả về slot hoặc -1 (đã gửi "ERR\n") */
+int    GpioShmServer_Attach(GpioShmServer* s, int sock_fd);
+void   GpioShmServer_Detach(GpioShmServer* s, int slot);
+/* fd cho select/poll: đọc được khi client rung chuông */
+int    GpioShmServer_Fd    (const GpioShmServer* s);
+/* Lấy tối đa max lệnh, gọi handler, đẩy completion; trả về số lệnh đã xử lý */
+size_t GpioShmServer_Drain (GpioShmServer* s, size_t max, GpioShmHandler h, void* ctx);
+/* Trước khi ngủ: bật idle rồi kiểm lại ring. 1 = được ngủ, 0 = có lệnh (idle đã tắt) */
+int    GpioShmServer_PrepareSleep(GpioShmServer* s);
+/* Sau khi thức (select trả về / hết timeout): tắt idle, xả eventfd */
+void   GpioShmServer_Wake  (GpioShmServer* s);
+
+/* ======================= phía client ======================= */
+
+typedef struct GpioShmClient GpioShmClient;
+
+/* Kết nối socket daemon và xin transport shm; NULL nếu lỗi / daemon từ chối */
+GpioShmClient* GpioShmClient_Connect(const char* sock_path);
+void           GpioShmClient_Close  (GpioShmClient* c);
+/* Đặt một lệnh vào ring, không syscall trừ khi daemon đang ngủ.
+ * 0 OK, -1 ring đầy hoặc đã có GPIO_SHM_CPL_SLOTS lệnh đang bay (thu completion rồi thử lại). */
+int            GpioShmClient_Submit (GpioShmClient* c, GpioShmOp op, uint8_t arg, uint32_t tag);
+/* Thu completion có sẵn (không chờ); trả về số completion */
+int            GpioShmClient_Poll   (GpioShmClient* c, GpioShmCpl* out, int max);
+/* Như Poll nhưng chờ tới khi có ít nhất 1 (timeout_ms < 0 = mãi); 0 = timeout */
+int            GpioShmClient_Wait   (GpioShmClient* c, GpioShmCpl* out, int max, int timeout_ms);
+/* Số lệnh đã gửi mà chưa thu completion */
+uint32_t       GpioShmClient_InFlight(const GpioShmClient* c);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,21 @@
+#pragma once
+#include "osal_types.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void* OSAL_MutexHandle;
+
+#define OSAL_WAIT_FOREVER 0xFFFFFFFFu
+
+/* ===== Mutex (không đệ quy) ===== */
+OSAL_Status OSAL_MutexCreate(OSAL_MutexHandle* h);
+OSAL_Status OSAL_MutexDelete(OSAL_MutexHandle h);
+OSAL_Status OSAL_MutexLock(OSAL_MutexHandle h, uint32_t timeout_ms); // OSAL_WAIT_FOREVER | 0 = try
+OSAL_Status OSAL_MutexUnlock(OSAL_MutexHandle h);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+#include "osal_types.h"
+#include "osal_mutex.h"   /* OSAL_WAIT_FOREVER */
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void* OSAL_QueueHandle;
+
+/* ===== Message queue (copy theo giá trị, kích thước item cố định, FIFO) =====
+ * Như xQueue của FreeRTOS / OSQ của uC/OS: Send copy item vào queue, Receive
+ * copy ra. timeout_ms: 0 = không chờ, OSAL_WAIT_FOREVER = chờ mãi.
+ * Đầy (Send) / rỗng (Receive) khi hết timeout -> OSAL_ETIMEOUT. */
+OSAL_Status OSAL_QueueCreate (OSAL_QueueHandle* h, uint32_t item_size, uint32_t depth);
+OSAL_Status OSAL_QueueDelete (OSAL_QueueHandle h);
+OSAL_Status OSAL_QueueSend   (OSAL_QueueHandle h, const void* item, uint32_t timeout_ms);
+OSAL_Status OSAL_QueueReceive(OSAL_QueueHandle h, void* item, uint32_t timeout_ms);
+uint32_t    OSAL_QueueCount  (OSAL_QueueHandle h);   // số item đang chờ
+
+#ifdef __cplusplus
+}
+#endif
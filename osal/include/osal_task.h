@@ -35,6 +35,10 @@ OSAL_Status OSAL_TaskGetName(OSAL_TaskHandle h, const char** name);
 void        OSAL_TaskDelayMs(uint32_t ms);
 void        OSAL_TaskYield(void);
 
+/* ===== Time / periodic ===== */
+uint64_t    OSAL_TimeNowUs(void);                                         // monotonic
+void        OSAL_TaskDelayUntilUs(uint64_t* prev_wake_us, uint32_t period_us); // absolute deadline, *prev_wake_us=0 lần đầu
+
 /* ===== Utility ===== */
 uint32_t    OSAL_TaskCount(void);
 OSAL_Status OSAL_TaskForEach(void (*cb)(OSAL_TaskHandle h, void* arg), void* arg);
@@ -0,0 +1,74 @@
+// OSAL mutex backend for Linux (pthread_mutex, priority inheritance nếu có)
+// - Lock(timeout): 0 = try-lock, OSAL_WAIT_FOREVER = chờ mãi, còn lại = timedlock (CLOCK_REALTIME)
+
+#include "osal_mutex.h"
+#include "osal.h"
+
+#include <pthread.h>
+#include <time.h>
+#include <stdlib.h>
+#include <errno.h>
+
+typedef struct {
+    pthread_mutex_t m;
+} LinuxMutex;
+
+OSAL_Status OSAL_MutexCreate(OSAL_MutexHandle* out)
+{
+    if (!out) return OSAL_EINVAL;
+    LinuxMutex* mx = (LinuxMutex*)calloc(1, sizeof(*mx));
+    if (!mx) return OSAL_EOS;
+
+    pthread_mutexattr_t a;
+    pthread_mutexattr_init(&a);
+    // Task SCHED_FIFO dùng chung mutex → tránh đảo ưu tiên
+    pthread_mutexattr_setprotocol(&a, PTHREAD_PRIO_INHERIT);
+    int rc = pthread_mutex_init(&mx->m, &a);
+    pthread_mutexattr_destroy(&a);
+    if (rc != 0) {
+        OSAL_LOG("[OSAL][Mutex] init failed rc=%d\r\n", rc);
+        free(mx);
+        return OSAL_EOS;
+    }
+    *out = (OSAL_MutexHandle)mx;
+    return OSAL_OK;
+}
+
+OSAL_Status OSAL_MutexDelete(OSAL_MutexHandle h)
+{
+    LinuxMutex* mx = (LinuxMutex*)h;
+    if (!mx) return OSAL_EINVAL;
+    pthread_mutex_destroy(&mx->m);
+    free(mx);
+    return OSAL_OK;
+}
+
+OSAL_Status OSAL_MutexLock(OSAL_MutexHandle h, uint32_t timeout_ms)
+{
+    LinuxMutex* mx = (LinuxMutex*)h;
+    if (!mx) return OSAL_EINVAL;
+
+    int rc;
+    if (timeout_ms == OSAL_WAIT_FOREVER) {
+        rc = pthread_mutex_lock(&mx->m);
+    } else if (timeout_ms == 0) {
+        rc = pthread_mutex_trylock(&mx->m);
+    } else {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec  += timeout_ms / 1000u;
+        ts.tv_nsec += (long)(timeout_ms % 1000u) * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) { ts.tv_sec++; ts.tv_nsec -= 1000000000L; }
+        rc = pthread_mutex_timedlock(&mx->m, &ts);
+    }
+    if (rc == 0) return OSAL_OK;
+    if (rc == EBUSY || rc == ETIMEDOUT) return OSAL_ETIMEOUT;
+    return OSAL_EOS;
+}
+
+OSAL_Status OSAL_MutexUnlock(OSAL_MutexHandle h)
+{
+    LinuxMutex* mx = (LinuxMutex*)h;
+    if (!mx) return OSAL_EINVAL;
+    return pthread_mutex_unlock(&mx->m) == 0 ? OSAL_OK : OSAL_EOS;
+}
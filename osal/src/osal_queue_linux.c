@@ -0,0 +1,132 @@
+// OSAL message queue backend for Linux (ring buffer + pthread condvar)
+// - Item copy theo giá trị, bộ nhớ cấp một lần lúc Create (không malloc khi Send/Receive)
+// - Timeout theo CLOCK_MONOTONIC (không bị ảnh hưởng khi chỉnh giờ hệ thống)
+
+#include "osal_queue.h"
+#include "osal.h"
+
+#include <pthread.h>
+#include <time.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+
+typedef struct {
+    pthread_mutex_t m;
+    pthread_cond_t  not_empty;
+    pthread_cond_t  not_full;
+    uint32_t        item_size;
+    uint32_t        depth;
+    uint32_t        head;       // item cũ nhất
+    uint32_t        count;
+    uint8_t*        buf;        // depth * item_size
+} LinuxQueue;
+
+static void deadline_after(struct timespec* ts, uint32_t timeout_ms)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec  += timeout_ms / 1000u;
+    ts->tv_nsec += (long)(timeout_ms % 1000u) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) { ts->tv_sec++; ts->tv_nsec -= 1000000000L; }
+}
+
+// Một lần chờ trên cv (đang giữ q->m). ETIMEDOUT khi quá deadline.
+static int wait_once(LinuxQueue* q, pthread_cond_t* cv, uint32_t timeout_ms, const struct timespec* dl)
+{
+    if (timeout_ms == 0) return ETIMEDOUT;
+    if (timeout_ms == OSAL_WAIT_FOREVER) return pthread_cond_wait(cv, &q->m);
+    return pthread_cond_timedwait(cv, &q->m, dl);
+}
+
+OSAL_Status OSAL_QueueCreate(OSAL_QueueHandle* out, uint32_t item_size, uint32_t depth)
+{
+    if (!out || !item_size || !depth) return OSAL_EINVAL;
+    LinuxQueue* q = (LinuxQueue*)calloc(1, sizeof(*q));
+    if (!q) return OSAL_EOS;
+    q->buf = (uint8_t*)malloc((size_t)item_size * depth);
+    if (!q->buf) { free(q); return OSAL_EOS; }
+    q->item_size = item_size;
+    q->depth     = depth;
+
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    int rc = pthread_mutex_init(&q->m, NULL);
+    if (rc == 0) rc = pthread_cond_init(&q->not_empty, &ca);
+    if (rc == 0) rc = pthread_cond_init(&q->not_full, &ca);
+    pthread_condattr_destroy(&ca);
+    if (rc != 0) {
+        OSAL_LOG("[OSAL][Queue] init failed rc=%d\r\n", rc);
+        free(q->buf);
+        free(q);
+        return OSAL_EOS;
+    }
+    *out = (OSAL_QueueHandle)q;
+    return OSAL_OK;
+}
+
+OSAL_Status OSAL_QueueDelete(OSAL_QueueHandle h)
+{
+    LinuxQueue* q = (LinuxQueue*)h;
+    if (!q) return OSAL_EINVAL;
+    pthread_cond_destroy(&q->not_full);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_mutex_destroy(&q->m);
+    free(q->buf);
+    free(q);
+    return OSAL_OK;
+}
+
+OSAL_Status OSAL_QueueSend(OSAL_QueueHandle h, const void* item, uint32_t timeout_ms)
+{
+    LinuxQueue* q = (LinuxQueue*)h;
+    if (!q || !item) return OSAL_EINVAL;
+    struct timespec dl;
+    if (timeout_ms && timeout_ms != OSAL_WAIT_FOREVER) deadline_after(&dl, timeout_ms);
+
+    pthread_mutex_lock(&q->m);
+    while (q->count == q->depth) {
+        if (wait_once(q, &q->not_full, timeout_ms, &dl) == ETIMEDOUT && q->count == q->depth) {
+            pthread_mutex_unlock(&q->m);
+            return OSAL_ETIMEOUT;
+        }
+    }
+    uint32_t tail = (q->head + q->count) % q->depth;
+    memcpy(q->buf + (size_t)tail * q->item_size, item, q->item_size);
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->m);
+    return OSAL_OK;
+}
+
+OSAL_Status OSAL_QueueReceive(OSAL_QueueHandle h, void* item, uint32_t timeout_ms)
+{
+    LinuxQueue* q = (LinuxQueue*)h;
+    if (!q || !item) return OSAL_EINVAL;
+    struct timespec dl;
+    if (timeout_ms && timeout_ms != OSAL_WAIT_FOREVER) deadline_after(&dl, timeout_ms);
+
+    pthread_mutex_lock(&q->m);
+    while (q->count == 0) {
+        if (wait_once(q, &q->not_empty, timeout_ms, &dl) == ETIMEDOUT && q->count == 0) {
+            pthread_mutex_unlock(&q->m);
+            return OSAL_ETIMEOUT;
+        }
+    }
+    memcpy(item, q->buf + (size_t)q->head * q->item_size, q->item_size);
+    q->head = (q->head + 1u) % q->depth;
+    q->count--;
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->m);
+    return OSAL_OK;
+}
+
+uint32_t OSAL_QueueCount(OSAL_QueueHandle h)
+{
+    LinuxQueue* q = (LinuxQueue*)h;
+    if (!q) return 0;
+    pthread_mutex_lock(&q->m);
+    uint32_t n = q->count;
+    pthread_mutex_unlock(&q->m);
+    return n;
+}
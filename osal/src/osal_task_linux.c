@@ -30,6 +30,7 @@ typedef struct LinuxTask {
     pthread_cond_t    cv;
     volatile int      running;     // 1: đang chạy, 0: yêu cầu dừng (stop/delete)
     volatile int      suspended;   // 1: yêu cầu tạm dừng (cooperative)
+    volatile int      parked;      // 1: task đã thực sự "đỗ" trong Delay/Yield
     char              name[OSAL_TASK_NAME_MAX];
     uint8_t           prio_req;    // prio yêu cầu (0..255)
     OSAL_TaskEntry    entry;
@@ -241,8 +242,10 @@ OSAL_Status OSAL_TaskGetState(OSAL_TaskHandle h, OSAL_TaskState* state)
     pthread_mutex_lock(&t->mtx);
     if (!t->running) {
         *state = OSAL_TASK_STATE_INVALID;  // hoặc TERMINATED nếu bạn có enum đó
+    } else if (t->parked) {
+        *state = OSAL_TASK_STATE_SUSPENDED;  // đã đỗ thật sự
     } else if (t->suspended) {
-        *state = OSAL_TASK_STATE_WAITING;
+        *state = OSAL_TASK_STATE_WAITING;    // đã yêu cầu suspend, chưa tới điểm đỗ
     } else {
         *state = OSAL_TASK_STATE_RUNNING;
     }
@@ -260,23 +263,33 @@ OSAL_Status OSAL_TaskGetName(OSAL_TaskHandle h, const char** name)
 
 // ===== Scheduling helpers (cooperative suspend/stop hook) =====
 
-void OSAL_TaskYield(void)
+// Điểm kiểm tra suspend/stop: đỗ khi bị suspend, thoát thread khi bị delete
+static void task_checkpoint(void)
 {
-    // Nếu task đang bị suspend → chờ đến khi resume
-    if (tls_task) {
-        LinuxTask* t = tls_task;
-        pthread_mutex_lock(&t->mtx);
+    LinuxTask* t = tls_task;
+    if (!t) return;
+
+    pthread_mutex_lock(&t->mtx);
+    if (t->running && t->suspended) {
+        t->parked = 1;
         while (t->running && t->suspended) {
             pthread_cond_wait(&t->cv, &t->mtx);
         }
-        int still_running = t->running;
-        pthread_mutex_unlock(&t->mtx);
+        t->parked = 0;
+    }
+    int still_running = t->running;
+    pthread_mutex_unlock(&t->mtx);
 
-        if (!still_running) {
-            // Thoát trơn tru: return về entry → trampoline set running=0
-            pthread_exit(NULL);
-        }
+    if (!still_running) {
+        // Thoát trơn tru: return về entry → trampoline set running=0
+        pthread_exit(NULL);
     }
+}
+
+void OSAL_TaskYield(void)
+{
+    // Nếu task đang bị suspend → chờ đến khi resume
+    task_checkpoint();
     sched_yield();
 }
 
@@ -294,20 +307,37 @@ void OSAL_TaskDelayMs(uint32_t ms)
         nanosleep(&ts, NULL);
         remain -= d;
 
-        if (tls_task) {
-            LinuxTask* t = tls_task;
-            pthread_mutex_lock(&t->mtx);
-            // Nếu suspend → chờ đến khi resume
-            while (t->running && t->suspended) {
-                pthread_cond_wait(&t->cv, &t->mtx);
-            }
-            int still_running = t->running;
-            pthread_mutex_unlock(&t->mtx);
-            if (!still_running) {
-                pthread_exit(NULL);
-            }
-        }
+        // Nếu suspend → chờ đến khi resume
+        task_checkpoint();
+    }
+}
+
+uint64_t OSAL_TimeNowUs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+// Ngủ tới mốc tuyệt đối *prev_wake_us + period_us (giống vTaskDelayUntil):
+// không bị trôi chu kỳ như Delay tương đối. Trễ quá 1 chu kỳ thì không chạy bù.
+void OSAL_TaskDelayUntilUs(uint64_t* prev_wake_us, uint32_t period_us)
+{
+    if (!prev_wake_us) return;
+    uint64_t next = *prev_wake_us + period_us;
+    uint64_t now  = OSAL_TimeNowUs();
+    if (*prev_wake_us == 0 || next + period_us < now) {
+        next = now + period_us;  // lần đầu hoặc bị trễ nhiều: bám lại mốc hiện tại
     }
+
+    struct timespec ts;
+    ts.tv_sec  = (time_t)(next / 1000000ull);
+    ts.tv_nsec = (long)(next % 1000000ull) * 1000L;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+    *prev_wake_us = next;
+
+    task_checkpoint();
 }
 
 // ===== Optional: thống kê / duyệt =====
@@ -13,8 +13,11 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include "demo_gpio_hal.h"
+#include "board_desc.h"
+#include "board_devmgr.h"
 #include "hal_i2c.h"
 #include "hal_spi.h"
+#include "hal_log.h"
 
 // === Forward declarations for demos ===
 void DemoUart_Start(const char* dev, uint32_t baud, int nb);  // from demo_uart.c
@@ -30,7 +33,43 @@ static void on_sigint(int sig) {
     g_stop_requested = 1; 
 }
 
-int main(void) {
+/* Log HAL đi chung đường với OSAL_LOG của app */
+static void _hal_log_to_osal(void* ctx, HAL_LogLevel lvl, const char* tag, const char* msg) {
+    (void)ctx; (void)lvl;
+    OSAL_LOG("%s %s\r\n", tag, msg);
+}
+
+/* LED0..LED7, BTN0, BTN1 từ board description: handle lazy của board (mở ở
+ * lần gọi đầu, mỗi line theo chip + config của nó), DemoGpio dùng nguyên.
+ * Trả 0 nếu đủ line; -1 thì c không đổi. */
+static int _gpio_cfg_from_board(BoardDesc* bd, DemoGpioCfg* c) {
+    DemoGpioCfg t = *c;
+    int n = 0;
+    for (int i = 0; i < 8; ++i) {
+        char name[8];
+        snprintf(name, sizeof(name), "LED%d", i);
+        if (!BoardDesc_Has(bd, BOARD_RES_LINE, name)) break;
+        if (!(t.led_lines[n++] = BoardDesc_Line(bd, name))) {
+            printf("[APP] board line %s: open failed\n", name);
+            return -1;
+        }
+    }
+    if (!n) { printf("[APP] board has no LED0\n"); return -1; }
+    t.led_count = n;
+    for (int b = 0; b < 2; ++b) {
+        const char* name = b ? "BTN1" : "BTN0";
+        if (!(t.btn_lines[b] = BoardDesc_Line(bd, name))) {
+            printf("[APP] board line %s: missing or open failed\n", name);
+            return -1;
+        }
+    }
+    BoardLineInfo li;
+    if (BoardDesc_LineInfo(bd, "BTN0", &li) == 0 && li.cfg.debounce_ms) t.debounce_ms = (int)li.cfg.debounce_ms;
+    *c = t;
+    return 0;
+}
+
+int main(int argc, char** argv) {
     printf("=== OSAL Linux Demo App (Ctrl+C to exit) ===\n");
 
     // Install Ctrl+C handler
@@ -46,6 +85,7 @@ int main(void) {
         printf("[ERROR] OSAL_Init failed!\n");
         return -1;
     }
+    HAL_Log_SetSink(_hal_log_to_osal, NULL);
 
     // 3. Start UART HAL demo
     //    - Device: "/dev/ttyPS1" (ZedBoard's second UART port)
@@ -64,6 +104,21 @@ int main(void) {
         .btns_active_low = 1,  // thường nút kéo-up: pressed=0
         .debounce_ms = 10
     };
+
+    // Board description: argv[1] hoặc $BOARD_DESC (ví dụ boards/zedboard.board)
+    const char* board_path = (argc > 1) ? argv[1] : getenv("BOARD_DESC");
+    BoardDesc* board = NULL;
+    if (board_path) {
+        char err[128];
+        board = BoardDesc_Load(board_path, err, sizeof(err));
+        if (board) {
+            if (_gpio_cfg_from_board(board, &gpio_cfg) != 0) printf("[APP] board GPIO unusable (using defaults)\n");
+            printf("[APP] board: %s\n", board_path);
+            BoardDevMgr_Start(board, NULL);   // USB-serial / USB-I2C cắm-rút không cần restart
+        } else {
+            printf("[APP] board %s: %s (using defaults)\n", board_path, err);
+        }
+    }
     DemoGpio_Start(&gpio_cfg);
 
     // HAL_I2cStatus st;
@@ -93,6 +148,8 @@ int main(void) {
     // HAL_I2cBus_Close(bus);
 
     // DemoI2cExpander_Start(bus, 0x20);  // typical MCP23008 addr
+    // hoặc pin của expander như GPIO thường (hal_gpio_mcp23x.h):
+    //   HAL_GpioChipConfig xc = { .chip_name = "mcp23x:/dev/i2c-0@0x20,8,int=gpiochip0/17" };
     // DemoI2cTemp_Start("/dev/i2c-0");
 
     // HAL_SpiStatus st;
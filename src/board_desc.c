@@ -0,0 +1,595 @@
+/**
+ * @file board_desc.c
+ * @brief Board description loader: parse once, open lazily, bring up in parallel.
+ *
+ * Notes:
+ *  - Tên phải được khai báo trước khi dùng (chip trước line, line trước group,
+ *    bus trước device) nên parse chỉ cần một lượt.
+ *  - Mỗi resource có mutex riêng: resource con khoá cha khi cần mở cha
+ *    (line -> chip, device -> bus), không có vòng nên không deadlock.
+ */
+#include "board_desc.h"
+#include "osal.h"
+#include "osal_task.h"
+#include "osal_mutex.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+
+#define BD_NAME_MAX   32
+#define BD_DEV_MAX    64
+#define BD_GROUP_MAX  32
+#define BD_TOK_MAX    (BD_GROUP_MAX + 4)
+
+typedef struct {
+    char             name[BD_NAME_MAX];
+    BoardResKind     kind;
+    int              parent;            /* line -> chip, device -> bus, còn lại -1 */
+    char             dev[BD_DEV_MAX];   /* đường dẫn chip/bus; device: kind= */
+    char             match[BD_DEV_MAX]; /* bus: chuỗi con của DEVPATH (hot-plug) */
+    union {
+        HAL_GpioLineConfig line;
+        HAL_I2cBusConfig   i2c;
+        HAL_SpiConfig      spi;
+        HAL_UartConfig     uart;
+        uint16_t           addr;        /* device */
+        struct {
+            int           member[BD_GROUP_MAX];
+            unsigned      n;
+            HAL_GpioLine* lines[BD_GROUP_MAX];
+        } group;
+    } u;
+    void*            handle;
+    int              state;             /* 0 chưa mở, 1 đã mở, -1 lỗi */
+    OSAL_MutexHandle mtx;
+} BoardRes;
+
+struct BoardDesc {
+    BoardRes* res;
+    unsigned  n;
+    unsigned  cap;
+};
+
+static const char* const s_kind_name[] = { "chip", "line", "group", "i2c", "spi", "uart", "device" };
+
+/* ---------------- helpers ---------------- */
+
+static void _err(char* err, size_t len, int lineno, const char* fmt, ...) {
+    if (!err || !len) return;
+    int n = snprintf(err, len, "line %d: ", lineno);
+    if (n < 0 || (size_t)n >= len) return;
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(err + n, len - (size_t)n, fmt, ap);
+    va_end(ap);
+}
+
+static int _find(const BoardDesc* bd, const char* name) {
+    for (unsigned i = 0; i < bd->n; ++i)
+        if (strcmp(bd->res[i].name, name) == 0) return (int)i;
+    return -1;
+}
+
+static int _find_kind(const BoardDesc* bd, BoardResKind kind, const char* name) {
+    int i = name ? _find(bd, name) : -1;
+    return (i >= 0 && bd->res[i].kind == kind) ? i : -1;
+}
+
+/* tách token theo khoảng trắng, bỏ phần sau '#'. Trả -1 nếu nhiều hơn max token */
+static int _tokenize(char* s, char** tok, int max) {
+    int n = 0;
+    char* hash = strchr(s, '#');
+    if (hash) *hash = '\0';
+    for (char* p = strtok(s, " \t\r"); p; p = strtok(NULL, " \t\r")) {
+        if (n == max) return -1;
+        tok[n++] = p;
+    }
+    return n;
+}
+
+/* "key=value" -> value; NULL nếu token không phải key đó */
+static const char* _opt(const char* tok, const char* key) {
+    size_t k = strlen(key);
+    return (strncmp(tok, key, k) == 0 && tok[k] == '=') ? tok + k + 1 : NULL;
+}
+
+static int _parse_uint(const char* s, unsigned long* out) {
+    char* end = NULL;
+    unsigned long v = strtoul(s, &end, 0);
+    if (!s[0] || *end) return -1;
+    *out = v;
+    return 0;
+}
+
+static BoardRes* _add(BoardDesc* bd, BoardResKind kind, const char* name) {
+    if (bd->n == bd->cap) {
+        unsigned cap = bd->cap ? bd->cap * 2u : 16u;
+        BoardRes* r = (BoardRes*)realloc(bd->res, cap * sizeof(*r));
+        if (!r) return NULL;
+        bd->res = r;
+        bd->cap = cap;
+    }
+    BoardRes* r = &bd->res[bd->n];
+    memset(r, 0, sizeof(*r));
+    strncpy(r->name, name, sizeof(r->name) - 1);
+    r->kind   = kind;
+    r->parent = -1;
+    if (OSAL_MutexCreate(&r->mtx) != OSAL_OK) return NULL;
+    bd->n++;
+    return r;
+}
+
+/* ---------------- parser ---------------- */
+
+static int _parse_line_decl(BoardDesc* bd, BoardRes* r, char** tok, int nt, char* err, size_t el, int ln) {
+    /* line NAME chip:offset in|out [opts] */
+    char* colon = strchr(tok[2], ':');
+    unsigned long off;
+    if (!colon) { _err(err, el, ln, "expected <chip>:<offset>, got '%s'", tok[2]); return -1; }
+    *colon = '\0';
+    r->parent = _find_kind(bd, BOARD_RES_CHIP, tok[2]);
+    if (r->parent < 0) { _err(err, el, ln, "unknown chip '%s'", tok[2]); return -1; }
+    if (_parse_uint(colon + 1, &off) != 0) { _err(err, el, ln, "bad offset '%s'", colon + 1); return -1; }
+
+    HAL_GpioLineConfig* c = &r->u.line;
+    c->offset = (int)off;
+    c->name   = NULL;
+    c->dir    = HAL_GPIO_DIR_IN;
+    c->active = HAL_GPIO_ACTIVE_HIGH;
+    c->drive  = HAL_GPIO_DRIVE_PUSHPULL;
+    c->bias   = HAL_GPIO_BIAS_AS_IS;
+    c->edge   = HAL_GPIO_EDGE_NONE;
+
+    for (int i = 3; i < nt; ++i) {
+        const char* v;
+        unsigned long u;
+        if      (!strcmp(tok[i], "in"))          c->dir = HAL_GPIO_DIR_IN;
+        else if (!strcmp(tok[i], "out"))         c->dir = HAL_GPIO_DIR_OUT;
+        else if (!strcmp(tok[i], "active_low"))  c->active = HAL_GPIO_ACTIVE_LOW;
+        else if (!strcmp(tok[i], "active_high")) c->active = HAL_GPIO_ACTIVE_HIGH;
+        else if ((v = _opt(tok[i], "init")) && !_parse_uint(v, &u))     c->initial = u ? 1 : 0;
+        else if ((v = _opt(tok[i], "debounce")) && !_parse_uint(v, &u)) c->debounce_ms = (uint32_t)u;
+        else if ((v = _opt(tok[i], "edge"))) {
+            if      (!strcmp(v, "none"))    c->edge = HAL_GPIO_EDGE_NONE;
+            else if (!strcmp(v, "rising"))  c->edge = HAL_GPIO_EDGE_RISING;
+            else if (!strcmp(v, "falling")) c->edge = HAL_GPIO_EDGE_FALLING;
+            else if (!strcmp(v, "both"))    c->edge = HAL_GPIO_EDGE_BOTH;
+            else { _err(err, el, ln, "bad edge '%s'", v); return -1; }
+        } else if ((v = _opt(tok[i], "bias"))) {
+            if      (!strcmp(v, "as_is"))     c->bias = HAL_GPIO_BIAS_AS_IS;
+            else if (!strcmp(v, "pull_up"))   c->bias = HAL_GPIO_BIAS_PULL_UP;
+            else if (!strcmp(v, "pull_down")) c->bias = HAL_GPIO_BIAS_PULL_DOWN;
+            else if (!strcmp(v, "disable"))   c->bias = HAL_GPIO_BIAS_DISABLE;
+            else { _err(err, el, ln, "bad bias '%s'", v); return -1; }
+        } else if ((v = _opt(tok[i], "drive"))) {
+            if      (!strcmp(v, "pushpull"))   c->drive = HAL_GPIO_DRIVE_PUSHPULL;
+            else if (!strcmp(v, "opendrain"))  c->drive = HAL_GPIO_DRIVE_OPENDRAIN;
+            else if (!strcmp(v, "opensource")) c->drive = HAL_GPIO_DRIVE_OPENSOURCE;
+            else { _err(err, el, ln, "bad drive '%s'", v); return -1; }
+        } else {
+            _err(err, el, ln, "unknown line option '%s'", tok[i]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int _parse_bus_decl(BoardRes* r, char** tok, int nt, char* err, size_t el, int ln) {
+    strncpy(r->dev, tok[2], sizeof(r->dev) - 1);
+    switch (r->kind) {
+    case BOARD_RES_I2C:
+        r->u.i2c.bus_speed_hz = 100000;
+        break;
+    case BOARD_RES_SPI:
+        r->u.spi.mode          = HAL_SPI_MODE0;
+        r->u.spi.max_speed_hz  = 1000000;
+        r->u.spi.bits_per_word = 8;
+        break;
+    case BOARD_RES_UART:
+        r->u.uart.baud      = 115200;
+        r->u.uart.data_bits = 8;
+        r->u.uart.stop_bits = 1;
+        r->u.uart.parity    = HAL_UART_PARITY_NONE;
+        break;
+    default:
+        return -1;
+    }
+
+    for (int i = 3; i < nt; ++i) {
+        const char* v;
+        unsigned long u = 0;
+        int ok = 1;
+        if ((v = _opt(tok[i], "match"))) {
+            strncpy(r->match, v, sizeof(r->match) - 1);
+        } else if (r->kind == BOARD_RES_I2C) {
+            if ((v = _opt(tok[i], "speed")) && !_parse_uint(v, &u)) r->u.i2c.bus_speed_hz = (uint32_t)u;
+            else ok = 0;
+        } else if (r->kind == BOARD_RES_SPI) {
+            if      ((v = _opt(tok[i], "mode")) && !_parse_uint(v, &u) && u <= 3) r->u.spi.mode = (HAL_SpiMode)u;
+            else if ((v = _opt(tok[i], "speed")) && !_parse_uint(v, &u)) r->u.spi.max_speed_hz = (uint32_t)u;
+            else if ((v = _opt(tok[i], "bits")) && !_parse_uint(v, &u))  r->u.spi.bits_per_word = (uint8_t)u;
+            else if (!strcmp(tok[i], "lsb_first")) r->u.spi.lsb_first = 1;
+            else ok = 0;
+        } else {
+            if      ((v = _opt(tok[i], "baud")) && !_parse_uint(v, &u)) r->u.uart.baud = (uint32_t)u;
+            else if ((v = _opt(tok[i], "data")) && !_parse_uint(v, &u)) r->u.uart.data_bits = (uint8_t)u;
+            else if ((v = _opt(tok[i], "stop")) && !_parse_uint(v, &u)) r->u.uart.stop_bits = (uint8_t)u;
+            else if ((v = _opt(tok[i], "parity"))) {
+                if      (!strcmp(v, "none")) r->u.uart.parity = HAL_UART_PARITY_NONE;
+                else if (!strcmp(v, "even")) r->u.uart.parity = HAL_UART_PARITY_EVEN;
+                else if (!strcmp(v, "odd"))  r->u.uart.parity = HAL_UART_PARITY_ODD;
+                else ok = 0;
+            }
+            else if (!strcmp(tok[i], "flow"))     r->u.uart.hw_flow = 1;
+            else if (!strcmp(tok[i], "nonblock")) r->u.uart.non_blocking = 1;
+            else ok = 0;
+        }
+        if (!ok) { _err(err, el, ln, "bad %s option '%s'", s_kind_name[r->kind], tok[i]); return -1; }
+    }
+    return 0;
+}
+
+BoardDesc* BoardDesc_Parse(const char* text, char* err, size_t err_len) {
+    if (!text) return NULL;
+    if (err && err_len) err[0] = '\0';
+
+    BoardDesc* bd = (BoardDesc*)calloc(1, sizeof(*bd));
+    char* buf = strdup(text);
+    if (!bd || !buf) { free(bd); free(buf); return NULL; }
+
+    int lineno = 0, rc = 0;
+    /* tách dòng bằng tay (strtok bỏ qua dòng trống -> số dòng trong lỗi bị lệch) */
+    for (char* s = buf, *next; s && rc == 0; s = next) {
+        next = strchr(s, '\n');
+        if (next) *next++ = '\0';
+        ++lineno;
+        char* tok[BD_TOK_MAX];
+        int nt = _tokenize(s, tok, BD_TOK_MAX);
+        if (nt < 0) { _err(err, err_len, lineno, "too many tokens (max %d)", BD_TOK_MAX); rc = -1; break; }
+        if (nt == 0) continue;
+        if (nt < 3) { _err(err, err_len, lineno, "expected '<kind> <name> <target> ...'"); rc = -1; break; }
+
+        int kind = -1;
+        for (int k = 0; k <= BOARD_RES_DEVICE; ++k)
+            if (!strcmp(tok[0], s_kind_name[k])) kind = k;
+        if (kind < 0) { _err(err, err_len, lineno, "unknown kind '%s'", tok[0]); rc = -1; break; }
+        if (strlen(tok[1]) >= BD_NAME_MAX || _find(bd, tok[1]) >= 0) {
+            _err(err, err_len, lineno, "bad or duplicate name '%s'", tok[1]);
+            rc = -1;
+            break;
+        }
+
+        BoardRes* r = _add(bd, (BoardResKind)kind, tok[1]);
+        if (!r) { _err(err, err_len, lineno, "out of memory"); rc = -1; break; }
+
+        switch (r->kind) {
+        case BOARD_RES_CHIP:
+            strncpy(r->dev, tok[2], sizeof(r->dev) - 1);
+            break;
+        case BOARD_RES_LINE:
+            rc = _parse_line_decl(bd, r, tok, nt, err, err_len, lineno);
+            break;
+        case BOARD_RES_GROUP:
+            for (int i = 2; i < nt && rc == 0; ++i) {
+                int m = _find_kind(bd, BOARD_RES_LINE, tok[i]);
+                if (m < 0 || r->u.group.n >= BD_GROUP_MAX) {
+                    _err(err, err_len, lineno, "unknown line '%s' (or group > %d)", tok[i], BD_GROUP_MAX);
+                    rc = -1;
+                } else {
+                    r->u.group.member[r->u.group.n++] = m;
+                }
+            }
+            break;
+        case BOARD_RES_I2C:
+        case BOARD_RES_SPI:
+        case BOARD_RES_UART:
+            rc = _parse_bus_decl(r, tok, nt, err, err_len, lineno);
+            break;
+        case BOARD_RES_DEVICE: {
+            int b = _find(bd, tok[2]);
+            if (b < 0 || (bd->res[b].kind != BOARD_RES_I2C && bd->res[b].kind != BOARD_RES_SPI &&
+                          bd->res[b].kind != BOARD_RES_UART)) {
+                _err(err, err_len, lineno, "unknown bus '%s'", tok[2]);
+                rc = -1;
+                break;
+            }
+            r->parent = b;
+            for (int i = 3; i < nt && rc == 0; ++i) {
+                const char* v;
+                unsigned long u;
+                if ((v = _opt(tok[i], "addr")) && !_parse_uint(v, &u) && u < 0x80) r->u.addr = (uint16_t)u;
+                else if ((v = _opt(tok[i], "kind"))) strncpy(r->dev, v, sizeof(r->dev) - 1);
+                else { _err(err, err_len, lineno, "bad device option '%s'", tok[i]); rc = -1; }
+            }
+            break;
+        }
+        }
+    }
+    free(buf);
+
+    if (rc != 0) {
+        BoardDesc_Free(bd);
+        return NULL;
+    }
+    return bd;
+}
+
+BoardDesc* BoardDesc_Load(const char* path, char* err, size_t err_len) {
+    FILE* f = path ? fopen(path, "rb") : NULL;
+    if (!f) {
+        if (err && err_len) snprintf(err, err_len, "cannot open '%s'", path ? path : "(null)");
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long sz = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* text = (sz >= 0) ? (char*)malloc((size_t)sz + 1) : NULL;
+    if (!text) { fclose(f); return NULL; }
+    size_t rd = fread(text, 1, (size_t)sz, f);
+    text[rd] = '\0';
+    fclose(f);
+
+    BoardDesc* bd = BoardDesc_Parse(text, err, err_len);
+    free(text);
+    return bd;
+}
+
+/* đóng handle của một resource (không đụng tới con) */
+static void _close_handle(BoardRes* r) {
+    if (r->state == 1) {
+        switch (r->kind) {
+        case BOARD_RES_CHIP: HAL_GpioChip_Close((HAL_GpioChip*)r->handle);  break;
+        case BOARD_RES_LINE: HAL_GpioLine_Release((HAL_GpioLine*)r->handle); break;
+        case BOARD_RES_I2C:  HAL_I2cBus_Close((HAL_I2cBus*)r->handle);       break;
+        case BOARD_RES_SPI:  HAL_Spi_Close((HAL_SpiBus*)r->handle);          break;
+        case BOARD_RES_UART: HAL_Uart_Close((HAL_Uart*)r->handle);           break;
+        default: break;  /* group / device không sở hữu handle */
+        }
+    }
+    r->handle = NULL;
+    r->state  = 0;
+}
+
+void BoardDesc_Free(BoardDesc* bd) {
+    if (!bd) return;
+    /* con khai báo sau cha -> đóng ngược thứ tự */
+    for (unsigned k = bd->n; k-- > 0;) {
+        BoardRes* r = &bd->res[k];
+        _close_handle(r);
+        if (r->mtx) OSAL_MutexDelete(r->mtx);
+    }
+    free(bd->res);
+    free(bd);
+}
+
+/* ---------------- lazy open ---------------- */
+
+static void* _open(BoardDesc* bd, int idx) {
+    BoardRes* r = &bd->res[idx];
+    OSAL_MutexLock(r->mtx, OSAL_WAIT_FOREVER);
+    if (r->state == 0) {
+        void* parent = (r->parent >= 0) ? _open(bd, r->parent) : NULL;
+        void* h = NULL;
+
+        switch (r->kind) {
+        case BOARD_RES_CHIP: {
+            HAL_GpioChipConfig cc = { .chip_name = r->dev };
+            HAL_GpioChip* c = NULL;
+            if (HAL_GpioChip_Open(&cc, &c) == HAL_GPIO_OK) h = c;
+            break;
+        }
+        case BOARD_RES_LINE: {
+            HAL_GpioLine* l = NULL;
+            if (parent && HAL_GpioLine_Request((HAL_GpioChip*)parent, &r->u.line, &l) == HAL_GPIO_OK) h = l;
+            break;
+        }
+        case BOARD_RES_GROUP: {
+            unsigned ok = 0;
+            for (unsigned i = 0; i < r->u.group.n; ++i) {
+                r->u.group.lines[i] = (HAL_GpioLine*)_open(bd, r->u.group.member[i]);
+                if (r->u.group.lines[i]) ok++;
+            }
+            if (ok == r->u.group.n) h = r->u.group.lines;
+            break;
+        }
+        /* tên device gán lúc mở: bảng res có thể realloc khi parse, dev có thể đổi khi rebind */
+        case BOARD_RES_I2C: {
+            HAL_I2cStatus st;
+            r->u.i2c.bus_name = r->dev;
+            h = HAL_I2cBus_Open(&r->u.i2c, &st);
+            break;
+        }
+        case BOARD_RES_SPI: {
+            HAL_SpiStatus st;
+            r->u.spi.dev_name = r->dev;
+            h = HAL_Spi_Open(&r->u.spi, &st);
+            break;
+        }
+        case BOARD_RES_UART: {
+            HAL_UartStatus st;
+            r->u.uart.device = r->dev;
+            h = HAL_Uart_Open(&r->u.uart, &st);
+            break;
+        }
+        case BOARD_RES_DEVICE:
+            h = parent;
+            break;
+        }
+
+        r->handle = h;
+        r->state  = h ? 1 : -1;
+        if (!h) OSAL_LOG("[BOARD] open %s '%s' failed\r\n", s_kind_name[r->kind], r->name);
+    }
+    void* out = r->handle;
+    OSAL_MutexUnlock(r->mtx);
+    return out;
+}
+
+int BoardDesc_Has(const BoardDesc* bd, BoardResKind kind, const char* name) {
+    return bd && _find_kind(bd, kind, name) >= 0;
+}
+
+int BoardDesc_LineInfo(const BoardDesc* bd, const char* name, BoardLineInfo* out) {
+    int i = bd ? _find_kind(bd, BOARD_RES_LINE, name) : -1;
+    if (i < 0 || !out) return -1;
+    out->chip_dev = bd->res[bd->res[i].parent].dev;
+    out->cfg      = bd->res[i].u.line;
+    return 0;
+}
+
+static void* _open_named(BoardDesc* bd, BoardResKind kind, const char* name) {
+    int i = bd ? _find_kind(bd, kind, name) : -1;
+    return (i >= 0) ? _open(bd, i) : NULL;
+}
+
+HAL_GpioLine* BoardDesc_Line(BoardDesc* bd, const char* name) { return (HAL_GpioLine*)_open_named(bd, BOARD_RES_LINE, name); }
+HAL_I2cBus*   BoardDesc_I2c (BoardDesc* bd, const char* name) { return (HAL_I2cBus*)_open_named(bd, BOARD_RES_I2C, name); }
+HAL_SpiBus*   BoardDesc_Spi (BoardDesc* bd, const char* name) { return (HAL_SpiBus*)_open_named(bd, BOARD_RES_SPI, name); }
+HAL_Uart*     BoardDesc_Uart(BoardDesc* bd, const char* name) { return (HAL_Uart*)_open_named(bd, BOARD_RES_UART, name); }
+
+int BoardDesc_Group(BoardDesc* bd, const char* name, HAL_GpioGroup* out) {
+    int i = bd ? _find_kind(bd, BOARD_RES_GROUP, name) : -1;
+    if (i < 0 || !out || !_open(bd, i)) return -1;
+    out->lines = bd->res[i].u.group.lines;
+    out->count = bd->res[i].u.group.n;
+    return 0;
+}
+
+int BoardDesc_Device(BoardDesc* bd, const char* name, BoardDevice* out) {
+    int i = bd ? _find_kind(bd, BOARD_RES_DEVICE, name) : -1;
+    if (i < 0 || !out) return -1;
+    void* bus = _open(bd, i);
+    if (!bus) return -1;
+    out->bus_kind = bd->res[bd->res[i].parent].kind;
+    out->bus      = bus;
+    out->addr     = bd->res[i].u.addr;
+    out->kind     = bd->res[i].dev;
+    return 0;
+}
+
+/* ---------------- hot-plug hooks ---------------- */
+
+unsigned BoardDesc_Count(const BoardDesc* bd) { return bd ? bd->n : 0; }
+
+int BoardDesc_Info(const BoardDesc* bd, unsigned idx, BoardResInfo* out) {
+    if (!bd || idx >= bd->n || !out) return -1;
+    const BoardRes* r = &bd->res[idx];
+    out->name  = r->name;
+    out->kind  = r->kind;
+    out->dev   = r->dev;
+    out->match = r->match;
+    return 0;
+}
+
+void* BoardDesc_Open(BoardDesc* bd, const char* name) {
+    int i = (bd && name) ? _find(bd, name) : -1;
+    return (i >= 0) ? _open(bd, i) : NULL;
+}
+
+void* BoardDesc_Peek(BoardDesc* bd, const char* name) {
+    int i = (bd && name) ? _find(bd, name) : -1;
+    if (i < 0) return NULL;
+    BoardRes* r = &bd->res[i];
+    OSAL_MutexLock(r->mtx, OSAL_WAIT_FOREVER);
+    void* h = (r->state == 1) ? r->handle : NULL;
+    OSAL_MutexUnlock(r->mtx);
+    return h;
+}
+
+/* đóng idx và mọi thứ phụ thuộc (line/device con, group chứa line) */
+static void _close_tree(BoardDesc* bd, int idx) {
+    for (unsigned j = bd->n; j-- > (unsigned)idx + 1u;) {
+        BoardRes* c = &bd->res[j];
+        int dep = (c->parent == idx);
+        if (c->kind == BOARD_RES_GROUP)
+            for (unsigned k = 0; k < c->u.group.n; ++k) dep |= (c->u.group.member[k] == idx);
+        if (dep) _close_tree(bd, (int)j);
+    }
+    /* con được đóng trước, không giữ lock cha khi khoá con (thứ tự khoá như _open) */
+    BoardRes* r = &bd->res[idx];
+    OSAL_MutexLock(r->mtx, OSAL_WAIT_FOREVER);
+    _close_handle(r);
+    OSAL_MutexUnlock(r->mtx);
+}
+
+int BoardDesc_Close(BoardDesc* bd, const char* name) {
+    int i = (bd && name) ? _find(bd, name) : -1;
+    if (i < 0) return -1;
+    _close_tree(bd, i);
+    return 0;
+}
+
+int BoardDesc_Rebind(BoardDesc* bd, const char* name, const char* dev) {
+    int i = (bd && name && dev) ? _find(bd, name) : -1;
+    if (i < 0 || strlen(dev) >= BD_DEV_MAX) return -1;
+    BoardResKind k = bd->res[i].kind;
+    if (k != BOARD_RES_CHIP && k != BOARD_RES_I2C && k != BOARD_RES_SPI && k != BOARD_RES_UART) return -1;
+    _close_tree(bd, i);
+    BoardRes* r = &bd->res[i];
+    OSAL_MutexLock(r->mtx, OSAL_WAIT_FOREVER);
+    memset(r->dev, 0, sizeof(r->dev));
+    strncpy(r->dev, dev, sizeof(r->dev) - 1);
+    OSAL_MutexUnlock(r->mtx);
+    return 0;
+}
+
+/* ---------------- parallel bring-up ---------------- */
+
+typedef struct {
+    BoardDesc*   bd;
+    int*         idx;
+    unsigned     n;
+    unsigned     next;    /* atomic */
+    int          fails;   /* atomic */
+} BringUpJob;
+
+static void _bringup_worker(void* arg) {
+    BringUpJob* job = (BringUpJob*)arg;
+    unsigned i;
+    while ((i = __atomic_fetch_add(&job->next, 1u, __ATOMIC_RELAXED)) < job->n) {
+        if (!_open(job->bd, job->idx[i])) __atomic_fetch_add(&job->fails, 1, __ATOMIC_RELAXED);
+    }
+}
+
+int BoardDesc_BringUp(BoardDesc* bd, const char* const* names, unsigned count, unsigned workers) {
+    if (!bd) return -1;
+    BringUpJob job = { .bd = bd, .idx = (int*)calloc(bd->n ? bd->n : 1, sizeof(int)) };
+    if (!job.idx) return -1;
+
+    int unknown = 0;
+    if (names) {
+        for (unsigned k = 0; k < count && job.n < bd->n; ++k) {
+            int i = _find(bd, names[k]);
+            if (i < 0) { OSAL_LOG("[BOARD] bring-up: unknown '%s'\r\n", names[k]); unknown++; continue; }
+            job.idx[job.n++] = i;
+        }
+    } else {
+        for (unsigned i = 0; i < bd->n; ++i) {
+            BoardResKind k = bd->res[i].kind;
+            if (k == BOARD_RES_CHIP || k == BOARD_RES_I2C || k == BOARD_RES_SPI || k == BOARD_RES_UART)
+                job.idx[job.n++] = (int)i;
+        }
+    }
+
+    if (!workers) workers = 4;
+    if (workers > job.n) workers = job.n;
+
+    /* workers-1 task + caller; thiếu slot OSAL thì caller làm phần còn lại */
+    OSAL_TaskHandle th[16];
+    unsigned nt = 0;
+    for (unsigned w = 1; w < workers && nt < 16; ++w) {
+        OSAL_TaskAttr a = { .name = "BoardUp", .stack_size = 4096, .prio = 0 };
+        if (OSAL_TaskCreate(&th[nt], _bringup_worker, &job, &a) != OSAL_OK) break;
+        nt++;
+    }
+    _bringup_worker(&job);
+    for (unsigned w = 0; w < nt; ++w) OSAL_TaskDelete(th[w]);   /* join */
+
+    OSAL_LOG("[BOARD] bring-up: %u resource(s), %u worker(s), %d failed\r\n",
+             job.n, nt + 1u, job.fails + unknown);
+    free(job.idx);
+    return job.fails + unknown;
+}
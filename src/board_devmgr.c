@@ -0,0 +1,363 @@
+/**
+ * @file board_devmgr.c
+ * @brief Hot-plug device manager on top of board_desc (netlink uevent + inject).
+ *
+ * Notes:
+ *  - Một task OSAL poll() trên: eventfd (stop), socketpair (inject) và
+ *    socket NETLINK_KOBJECT_UEVENT (kernel, group 1). Inject và netlink đi
+ *    chung một hàm xử lý nên test không cần quyền root.
+ *  - Chỉ nhận uevent từ kernel (nl_pid == 0), bỏ bản tin "libudev".
+ *  - Sau "add", node trong /dev có thể chưa sẵn (udev đổi quyền/đổi tên):
+ *    thử mở lại mỗi retry_ms, tối đa retry_count lần.
+ */
+#define _GNU_SOURCE
+#include "board_devmgr.h"
+#include "osal.h"
+#include "osal_task.h"
+#include "osal_mutex.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+
+#define DEVMGR_MAX_SUBS   16
+#define DEVMGR_MSG_MAX    8192
+
+typedef struct {
+    uint8_t    used;
+    char       name[32];      /* "" = mọi entry */
+    BoardDevCb cb;
+    void*      user;
+} DevSub;
+
+typedef struct {
+    const char* action;
+    const char* devpath;
+    const char* subsystem;
+    const char* devname;
+} UEvent;
+
+static BoardDesc*        s_bd      = NULL;
+static BoardDevMgrCfg    s_cfg;
+static OSAL_TaskHandle   s_task    = NULL;
+static volatile int      s_run     = 0;
+static int               s_wake_fd = -1;
+static int               s_nl_fd   = -1;
+static int               s_inj[2]  = { -1, -1 };
+
+static DevSub            s_subs[DEVMGR_MAX_SUBS];
+static OSAL_MutexHandle  s_sub_mtx = NULL;
+
+static uint32_t*         s_retry   = NULL;    /* số lần thử còn lại, theo chỉ số entry */
+static uint64_t          s_next_retry_ns = 0;
+static BoardDevMgrStats  s_stats;
+
+/* ---------------- helpers ---------------- */
+
+static uint64_t _now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static const char* _subsystem_of(BoardResKind k) {
+    switch (k) {
+    case BOARD_RES_UART: return "tty";
+    case BOARD_RES_I2C:  return "i2c-dev";
+    case BOARD_RES_SPI:  return "spidev";
+    default:             return NULL;
+    }
+}
+
+/* buf: "ACTION@DEVPATH\0KEY=VAL\0..." (chấp nhận cả '\n') – sửa buf tại chỗ */
+static int _parse_uevent(char* buf, size_t len, UEvent* ev) {
+    memset(ev, 0, sizeof(*ev));
+    if (len >= 7 && memcmp(buf, "libudev", 7) == 0) return -1;
+    for (size_t i = 0; i < len; ++i)
+        if (buf[i] == '\n') buf[i] = '\0';
+    buf[len] = '\0';
+
+    for (char* p = buf; p < buf + len; p += strlen(p) + 1) {
+        if      (!strncmp(p, "ACTION=", 7))    ev->action    = p + 7;
+        else if (!strncmp(p, "DEVPATH=", 8))   ev->devpath   = p + 8;
+        else if (!strncmp(p, "SUBSYSTEM=", 10)) ev->subsystem = p + 10;
+        else if (!strncmp(p, "DEVNAME=", 8))   ev->devname   = p + 8;
+    }
+    return (ev->action && ev->devpath && ev->subsystem) ? 0 : -1;
+}
+
+static int _entry_matches(const BoardResInfo* ri, const UEvent* ev) {
+    const char* sub = _subsystem_of(ri->kind);
+    if (!sub || strcmp(sub, ev->subsystem) != 0) return 0;
+    if (ri->match[0]) return strstr(ev->devpath, ri->match) != NULL;
+    if (!ev->devname) return 0;
+    /* không có match=: so DEVNAME với dev trong board file (bỏ "/dev/") */
+    const char* dev = ri->dev;
+    if (!strncmp(dev, "/dev/", 5)) dev += 5;
+    return strcmp(dev, ev->devname) == 0;
+}
+
+static void _notify(const char* name, BoardDevEvent e, void* handle) {
+    DevSub local[DEVMGR_MAX_SUBS];
+    unsigned n = 0;
+
+    OSAL_MutexLock(s_sub_mtx, OSAL_WAIT_FOREVER);
+    for (unsigned i = 0; i < DEVMGR_MAX_SUBS; ++i) {
+        if (s_subs[i].used && (!s_subs[i].name[0] || !strcmp(s_subs[i].name, name)))
+            local[n++] = s_subs[i];
+    }
+    OSAL_MutexUnlock(s_sub_mtx);
+
+    /* gọi ngoài lock: callback được phép Subscribe/Unsubscribe */
+    for (unsigned i = 0; i < n; ++i) local[i].cb(name, e, handle, local[i].user);
+}
+
+static int _try_open(unsigned idx, const char* name) {
+    void* h = BoardDesc_Open(s_bd, name);
+    if (!h) {
+        BoardDesc_Close(s_bd, name);   /* xoá lỗi đã cache để lần sau thử lại */
+        return -1;
+    }
+    s_retry[idx] = 0;
+    s_stats.opened++;
+    OSAL_LOG("[DEVMGR] %s up\r\n", name);
+    _notify(name, BOARD_DEV_ADDED, h);
+    return 0;
+}
+
+static void _drop(const char* name) {
+    void* h = BoardDesc_Peek(s_bd, name);
+    if (!h) return;
+    _notify(name, BOARD_DEV_REMOVED, h);
+    BoardDesc_Close(s_bd, name);
+    s_stats.removed++;
+    OSAL_LOG("[DEVMGR] %s down\r\n", name);
+}
+
+static void _handle_uevent(char* buf, size_t len) {
+    UEvent ev;
+    s_stats.uevents++;
+    if (_parse_uevent(buf, len, &ev) != 0) return;
+
+    const int add = !strcmp(ev.action, "add");
+    const int rem = !strcmp(ev.action, "remove");
+    if (!add && !rem) return;
+
+    for (unsigned i = 0, n = BoardDesc_Count(s_bd); i < n; ++i) {
+        BoardResInfo ri;
+        if (BoardDesc_Info(s_bd, i, &ri) != 0 || !_entry_matches(&ri, &ev)) continue;
+        s_stats.matched++;
+
+        if (rem) {
+            s_retry[i] = 0;
+            _drop(ri.name);
+            continue;
+        }
+
+        /* add: trỏ entry vào node mới (ttyUSB0 có thể thành ttyUSB1 sau replug) */
+        if (ri.match[0] && ev.devname) {
+            char dev[64];
+            snprintf(dev, sizeof(dev), "/dev/%s", ev.devname);
+            if (BoardDesc_Peek(s_bd, ri.name) && !strcmp(ri.dev, dev)) continue;  /* trùng */
+            _drop(ri.name);
+            BoardDesc_Rebind(s_bd, ri.name, dev);
+        } else {
+            if (BoardDesc_Peek(s_bd, ri.name)) continue;
+            BoardDesc_Close(s_bd, ri.name);
+        }
+
+        if (_try_open(i, ri.name) != 0) {
+            s_retry[i] = s_cfg.retry_count;
+            s_next_retry_ns = _now_ns() + (uint64_t)s_cfg.retry_ms * 1000000ull;
+        }
+    }
+}
+
+static int _retry_pending(void) {
+    for (unsigned i = 0, n = BoardDesc_Count(s_bd); i < n; ++i)
+        if (s_retry[i]) return 1;
+    return 0;
+}
+
+static void _retry_pass(void) {
+    for (unsigned i = 0, n = BoardDesc_Count(s_bd); i < n; ++i) {
+        BoardResInfo ri;
+        if (!s_retry[i] || BoardDesc_Info(s_bd, i, &ri) != 0) continue;
+        if (_try_open(i, ri.name) == 0) continue;
+        if (--s_retry[i] == 0) {
+            s_stats.open_failed++;
+            OSAL_LOG("[DEVMGR] %s: open %s failed, giving up\r\n", ri.name, ri.dev);
+        }
+    }
+    s_next_retry_ns = _now_ns() + (uint64_t)s_cfg.retry_ms * 1000000ull;
+}
+
+static int _netlink_open(void) {
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if (fd < 0) return -1;
+    struct sockaddr_nl sa = { .nl_family = AF_NETLINK, .nl_groups = 1 };
+    if (bind(fd, (struct sockaddr*)&sa, sizeof(sa)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* ---------------- task ---------------- */
+
+static void DevMgrTask(void* arg) {
+    (void)arg;
+    static char buf[DEVMGR_MSG_MAX + 1];
+
+    while (s_run) {
+        int timeout = -1;
+        if (_retry_pending()) {
+            uint64_t now = _now_ns();
+            timeout = (s_next_retry_ns > now) ? (int)((s_next_retry_ns - now) / 1000000ull) : 0;
+        }
+
+        struct pollfd pfd[3] = {
+            { .fd = s_wake_fd, .events = POLLIN },
+            { .fd = s_inj[0],  .events = POLLIN },
+            { .fd = s_nl_fd,   .events = POLLIN },   /* fd < 0 -> poll bỏ qua */
+        };
+        int rc = poll(pfd, 3, timeout);
+        if (!s_run) break;
+        if (rc < 0) {
+            if (errno == EINTR) continue;
+            OSAL_LOG("[DEVMGR] poll: %s\r\n", strerror(errno));
+            break;
+        }
+
+        if (pfd[1].revents & POLLIN) {
+            ssize_t n = recv(s_inj[0], buf, DEVMGR_MSG_MAX, MSG_DONTWAIT);
+            if (n > 0) _handle_uevent(buf, (size_t)n);
+        }
+        if (pfd[2].revents & POLLIN) {
+            struct sockaddr_nl from;
+            socklen_t fl = sizeof(from);
+            ssize_t n;
+            while ((n = recvfrom(s_nl_fd, buf, DEVMGR_MSG_MAX, MSG_DONTWAIT,
+                                 (struct sockaddr*)&from, &fl)) > 0) {
+                if (from.nl_pid == 0) _handle_uevent(buf, (size_t)n);   /* chỉ từ kernel */
+                fl = sizeof(from);
+            }
+        }
+        if (_retry_pending() && _now_ns() >= s_next_retry_ns) _retry_pass();
+    }
+    OSAL_LOG("[DEVMGR] task exit\r\n");
+}
+
+/* ---------------- API ---------------- */
+
+int BoardDevMgr_Start(BoardDesc* bd, const BoardDevMgrCfg* cfg) {
+    if (s_run) return 0;
+    if (!bd) return -1;
+
+    memset(&s_cfg, 0, sizeof(s_cfg));
+    if (cfg) s_cfg = *cfg;
+    if (!s_cfg.retry_ms)    s_cfg.retry_ms    = 20;
+    if (!s_cfg.retry_count) s_cfg.retry_count = 10;
+    if (!s_cfg.task_prio)   s_cfg.task_prio   = 10;
+
+    if (!s_sub_mtx && OSAL_MutexCreate(&s_sub_mtx) != OSAL_OK) return -1;
+
+    s_bd = bd;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_retry = (uint32_t*)calloc(BoardDesc_Count(bd) ? BoardDesc_Count(bd) : 1, sizeof(uint32_t));
+    s_wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (!s_retry || s_wake_fd < 0 ||
+        socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, s_inj) != 0) {
+        OSAL_LOG("[DEVMGR] setup failed: %s\r\n", strerror(errno));
+        goto fail;
+    }
+
+    if (!s_cfg.no_netlink) {
+        s_nl_fd = _netlink_open();
+        if (s_nl_fd < 0)
+            OSAL_LOG("[DEVMGR] netlink uevent unavailable (%s), inject only\r\n", strerror(errno));
+    }
+
+    s_run = 1;
+    OSAL_TaskAttr a = { .name = "DevMgr", .stack_size = 4096, .prio = s_cfg.task_prio };
+    if (OSAL_TaskCreate(&s_task, DevMgrTask, NULL, &a) != OSAL_OK) {
+        OSAL_LOG("[DEVMGR] task create failed\r\n");
+        s_run = 0;
+        goto fail;
+    }
+    OSAL_LOG("[DEVMGR] started (%s)\r\n", s_nl_fd >= 0 ? "netlink" : "inject only");
+    return 0;
+
+fail:
+    BoardDevMgr_Stop();
+    return -1;
+}
+
+void BoardDevMgr_Stop(void) {
+    if (s_run) {
+        uint64_t one = 1;
+        s_run = 0;
+        if (write(s_wake_fd, &one, sizeof(one)) < 0) { /* task vẫn thoát ở vòng poll kế */ }
+        OSAL_TaskDelete(s_task);
+        s_task = NULL;
+    }
+    if (s_nl_fd >= 0)   { close(s_nl_fd);   s_nl_fd = -1; }
+    if (s_inj[0] >= 0)  { close(s_inj[0]);  s_inj[0] = -1; }
+    if (s_inj[1] >= 0)  { close(s_inj[1]);  s_inj[1] = -1; }
+    if (s_wake_fd >= 0) { close(s_wake_fd); s_wake_fd = -1; }
+    free(s_retry);
+    s_retry = NULL;
+}
+
+int BoardDevMgr_Subscribe(const char* name, BoardDevCb cb, void* user) {
+    if (!cb) return -1;
+    if (!s_sub_mtx && OSAL_MutexCreate(&s_sub_mtx) != OSAL_OK) return -1;
+
+    int id = -1;
+    OSAL_MutexLock(s_sub_mtx, OSAL_WAIT_FOREVER);
+    for (unsigned i = 0; i < DEVMGR_MAX_SUBS; ++i) {
+        if (s_subs[i].used) continue;
+        memset(&s_subs[i], 0, sizeof(s_subs[i]));
+        if (name) strncpy(s_subs[i].name, name, sizeof(s_subs[i].name) - 1);
+        s_subs[i].cb   = cb;
+        s_subs[i].user = user;
+        s_subs[i].used = 1;
+        id = (int)i;
+        break;
+    }
+    OSAL_MutexUnlock(s_sub_mtx);
+    if (id < 0 || !s_bd) return id;
+
+    /* báo ngay các entry đang mở để subscriber không phải tự dò */
+    for (unsigned i = 0, n = BoardDesc_Count(s_bd); i < n; ++i) {
+        BoardResInfo ri;
+        if (BoardDesc_Info(s_bd, i, &ri) != 0 || !_subsystem_of(ri.kind)) continue;
+        if (name && strcmp(name, ri.name) != 0) continue;
+        void* h = BoardDesc_Peek(s_bd, ri.name);
+        if (h) cb(ri.name, BOARD_DEV_ADDED, h, user);
+    }
+    return id;
+}
+
+void BoardDevMgr_Unsubscribe(int id) {
+    if (id < 0 || id >= DEVMGR_MAX_SUBS || !s_sub_mtx) return;
+    OSAL_MutexLock(s_sub_mtx, OSAL_WAIT_FOREVER);
+    s_subs[id].used = 0;
+    OSAL_MutexUnlock(s_sub_mtx);
+}
+
+int BoardDevMgr_Inject(const char* uevent, size_t len) {
+    if (!uevent || !len || len > DEVMGR_MSG_MAX || s_inj[1] < 0) return -1;
+    return (send(s_inj[1], uevent, len, MSG_DONTWAIT | MSG_NOSIGNAL) == (ssize_t)len) ? 0 : -1;
+}
+
+void BoardDevMgr_GetStats(BoardDevMgrStats* out) {
+    if (out) *out = s_stats;
+}
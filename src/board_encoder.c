@@ -0,0 +1,307 @@
+/**
+ * @file board_encoder.c
+ * @brief Quadrature decoder: batched event read per line, merge by timestamp,
+ *        16-entry transition table, wait-free published position/velocity.
+ *
+ * Notes:
+ *  - Trạng thái decoder (ab, raw, cửa sổ velocity, hàng đợi event) chỉ thuộc
+ *    thread gọi Poll. Những gì task khác đọc nằm ở các trường pub_* và chỉ
+ *    được ghi bằng __atomic_store_n (relaxed): load 64-bit không bao giờ rách
+ *    (ARMv7 dùng ldrexd/ldrd, x86-64/AArch64 là một lệnh load).
+ *  - Position được publish một lần mỗi vòng Poll, không phải mỗi cạnh.
+ */
+#include "board_encoder.h"
+#include "osal.h"
+#include "osal_task.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ENC_LINES   3          /* A, B, Z */
+#define ENC_PEND    256        /* event chờ ghép / line */
+#define ENC_IDLE_MS 50         /* timeout của task khi không có gì giữ lại */
+
+typedef struct {
+    HAL_GpioEvent ev[ENC_PEND];
+    unsigned      head, n;
+} EncQueue;
+
+struct BoardEncoder {
+    BoardEncoderCfg cfg;
+    HAL_GpioChip*   chip;
+    HAL_GpioLine*   line[ENC_LINES];
+    int             nlines;
+    struct pollfd   pfd[ENC_LINES];
+    int             pollable;          /* mọi line có event fd */
+    EncQueue        q[ENC_LINES];
+
+    /* decoder (chỉ thread Poll) */
+    uint8_t         ab;                /* (A << 1) | B, mức logic */
+    int64_t         raw;
+    uint64_t        last_ns;           /* timestamp event đã giải mã gần nhất */
+    uint64_t        w_ns;              /* đầu cửa sổ velocity (0 = chưa có) */
+    int64_t         w_pos;
+    uint64_t        edges, illegal, index, batches, max_batch, late;
+
+    /* publish (store atomic bởi decoder, load bởi bất kỳ ai) */
+    int64_t         pub_pos;
+    int64_t         pub_vel_mcps;      /* milli-count / s */
+    int64_t         pub_index_pos;
+    uint64_t        pub_edges, pub_illegal, pub_index, pub_batches, pub_max_batch, pub_late;
+
+    OSAL_TaskHandle task;
+    volatile int    run;
+};
+
+/* idx = (prev << 2) | next; chiều thuận 00 -> 10 -> 11 -> 01 -> 00.
+ * Chỉ tra khi có cạnh, nên prev == next nghĩa là mất một cạnh (kênh đó đã
+ * đổi hai lần), còn đổi cả hai bit là nhảy cóc: cả hai đều không hợp lệ (2). */
+static const int8_t k_qdec[16] = {
+     2, -1, +1,  2,
+    +1,  2,  2, -1,
+    -1,  2,  2, +1,
+     2, +1, -1,  2,
+};
+
+static uint64_t _mono_ns(void* ctx) {
+    (void)ctx;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#define PUB(field_, v_) __atomic_store_n(&e->field_, (v_), __ATOMIC_RELAXED)
+#define GET(field_)     __atomic_load_n(&enc->field_, __ATOMIC_RELAXED)
+
+/* --- decode --- */
+
+static void _velocity(BoardEncoder* e, uint64_t ts) {
+    if (!e->w_ns) {
+        e->w_ns  = ts;
+        e->w_pos = e->raw;
+        return;
+    }
+    uint64_t dt = ts - e->w_ns;
+    if (ts <= e->w_ns || dt < (uint64_t)e->cfg.vel_window_us * 1000ull) return;
+    double v = (double)(e->raw - e->w_pos) * 1e12 / (double)dt;   /* milli-count/s */
+    PUB(pub_vel_mcps, (int64_t)v);
+    e->w_ns  = ts;
+    e->w_pos = e->raw;
+}
+
+static void _decode(BoardEncoder* e, int li, const HAL_GpioEvent* ev) {
+    if (ev->timestamp_ns < e->last_ns) e->late++;
+    else                               e->last_ns = ev->timestamp_ns;
+
+    if (li == 2) {   /* Z */
+        if (ev->edge != HAL_GPIO_EDGE_FALLING) {
+            e->index++;
+            PUB(pub_index_pos, e->raw);
+            if (e->cfg.z_reset) {
+                e->w_pos -= e->raw;
+                e->raw    = 0;
+            }
+        }
+        return;
+    }
+
+    uint8_t bit  = (li == 0) ? 2u : 1u;
+    uint8_t next = (ev->edge == HAL_GPIO_EDGE_RISING)  ? (uint8_t)(e->ab | bit)
+                 : (ev->edge == HAL_GPIO_EDGE_FALLING) ? (uint8_t)(e->ab & ~bit)
+                 :                                       (uint8_t)(e->ab ^ bit);
+    int8_t d = k_qdec[(e->ab << 2) | next];
+    e->ab = next;
+    e->edges++;
+    if (d == 2) {
+        e->illegal++;
+        return;
+    }
+    e->raw += e->cfg.reverse ? -d : d;
+    _velocity(e, ev->timestamp_ns);
+}
+
+/* rút hết event đang chờ của mọi line vào hàng đợi riêng */
+static void _drain(BoardEncoder* e) {
+    for (int i = 0; i < e->nlines; ++i) {
+        EncQueue* q = &e->q[i];
+        if (q->head) {
+            memmove(q->ev, q->ev + q->head, q->n * sizeof(q->ev[0]));
+            q->head = 0;
+        }
+        while (q->n < ENC_PEND) {
+            size_t got = 0;
+            if (HAL_GpioLine_ReadEvents(e->line[i], 0, q->ev + q->n, ENC_PEND - q->n, &got) != HAL_GPIO_OK) break;
+            q->n += (unsigned)got;
+        }
+    }
+}
+
+/* ghép theo timestamp mọi event <= upto; trả về số event đã giải mã */
+static int _merge(BoardEncoder* e, uint64_t upto) {
+    int n = 0;
+    for (;;) {
+        int best = -1;
+        uint64_t bts = 0;
+        for (int i = 0; i < e->nlines; ++i) {
+            const EncQueue* q = &e->q[i];
+            if (!q->n) continue;
+            uint64_t ts = q->ev[q->head].timestamp_ns;
+            if (ts > upto) continue;
+            if (best < 0 || ts < bts) { best = i; bts = ts; }
+        }
+        if (best < 0) break;
+        EncQueue* q = &e->q[best];
+        _decode(e, best, &q->ev[q->head]);
+        q->head++;
+        q->n--;
+        ++n;
+    }
+    return n;
+}
+
+static int _held(const BoardEncoder* e) {
+    for (int i = 0; i < e->nlines; ++i) if (e->q[i].n) return 1;
+    return 0;
+}
+
+int BoardEncoder_Poll(BoardEncoder* e, int timeout_ms) {
+    if (!e) return -1;
+    /* event đang bị giữ: quay lại sớm để xả khi hết guard */
+    if (_held(e) && (timeout_ms < 0 || timeout_ms > 1)) timeout_ms = 1;
+
+    if (e->pollable) {
+        int rc = poll(e->pfd, (nfds_t)e->nlines, timeout_ms);
+        if (rc < 0 && errno != EINTR) return -1;
+    }
+    uint64_t now = e->cfg.now_ns(e->cfg.now_ctx);
+    _drain(e);
+    if (!e->pollable && !_held(e) && timeout_ms != 0) {
+        (void)poll(NULL, 0, 1);    /* không có fd để chờ */
+        now = e->cfg.now_ns(e->cfg.now_ctx);
+        _drain(e);
+    }
+
+    uint64_t guard = (uint64_t)e->cfg.merge_guard_us * 1000ull;
+    int n = _merge(e, now > guard ? now - guard : 0);
+
+    if (e->last_ns && now > e->last_ns &&
+        now - e->last_ns > (uint64_t)e->cfg.vel_timeout_ms * 1000000ull) {
+        PUB(pub_vel_mcps, 0);
+        e->w_ns = 0;
+    }
+    if (n) {
+        e->batches++;
+        if ((uint64_t)n > e->max_batch) e->max_batch = (uint64_t)n;
+        PUB(pub_pos, e->raw);
+        PUB(pub_edges, e->edges);
+        PUB(pub_illegal, e->illegal);
+        PUB(pub_index, e->index);
+        PUB(pub_batches, e->batches);
+        PUB(pub_max_batch, e->max_batch);
+        PUB(pub_late, e->late);
+    }
+    return n;
+}
+
+/* --- reader (wait-free) --- */
+
+int64_t BoardEncoder_Position(const BoardEncoder* enc) {
+    return enc ? GET(pub_pos) : 0;
+}
+
+double BoardEncoder_Velocity(const BoardEncoder* enc) {
+    return enc ? (double)GET(pub_vel_mcps) / 1000.0 : 0.0;
+}
+
+void BoardEncoder_GetStats(const BoardEncoder* enc, BoardEncoderStats* out) {
+    if (!enc || !out) return;
+    out->edges     = GET(pub_edges);
+    out->illegal   = GET(pub_illegal);
+    out->index     = GET(pub_index);
+    out->index_pos = GET(pub_index_pos);
+    out->batches   = GET(pub_batches);
+    out->max_batch = GET(pub_max_batch);
+    out->late      = GET(pub_late);
+}
+
+/* --- lifetime --- */
+
+static void EncoderTask(void* arg) {
+    BoardEncoder* e = (BoardEncoder*)arg;
+    while (e->run) {
+        if (BoardEncoder_Poll(e, ENC_IDLE_MS) < 0) OSAL_TaskDelayMs(10);
+    }
+}
+
+int BoardEncoder_Start(BoardEncoder* e, uint8_t task_prio) {
+    if (!e) return -1;
+    if (e->run) return 0;
+    e->run = 1;
+    OSAL_TaskAttr a = { .name = "Encoder", .stack_size = 4096, .prio = task_prio };
+    if (OSAL_TaskCreate(&e->task, EncoderTask, e, &a) != OSAL_OK) {
+        OSAL_LOG("[ENC] task create failed\r\n");
+        e->run = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void BoardEncoder_Stop(BoardEncoder* e) {
+    if (!e || !e->run) return;
+    e->run = 0;
+    OSAL_TaskDelete(e->task);
+    e->task = NULL;
+}
+
+int BoardEncoder_Open(const BoardEncoderCfg* cfg, BoardEncoder** out) {
+    if (!cfg || !out || cfg->a_offset < 0 || cfg->b_offset < 0) return -1;
+    BoardEncoder* e = (BoardEncoder*)calloc(1, sizeof(*e));
+    if (!e) return -1;
+    e->cfg = *cfg;
+    if (!e->cfg.vel_window_us)  e->cfg.vel_window_us  = 2000;
+    if (!e->cfg.vel_timeout_ms) e->cfg.vel_timeout_ms = 100;
+    if (!e->cfg.merge_guard_us) e->cfg.merge_guard_us = 200;
+    if (!e->cfg.now_ns)         e->cfg.now_ns         = _mono_ns;
+
+    HAL_GpioChipConfig cc = { .chip_name = cfg->chip_name };
+    e->chip = cfg->chip;
+    if (!e->chip && HAL_GpioChip_Open(&cc, &e->chip) != HAL_GPIO_OK) {
+        OSAL_LOG("[ENC] open chip %s failed\r\n", cfg->chip_name ? cfg->chip_name : "(null)");
+        free(e);
+        return -1;
+    }
+    const int offs[ENC_LINES] = { cfg->a_offset, cfg->b_offset, cfg->z_offset };
+    e->nlines   = (cfg->z_offset >= 0) ? 3 : 2;
+    e->pollable = 1;
+    for (int i = 0; i < e->nlines; ++i) {
+        HAL_GpioLineConfig lc = {
+            .offset = offs[i], .dir = HAL_GPIO_DIR_IN, .active = cfg->active,
+            .bias = cfg->bias, .edge = HAL_GPIO_EDGE_BOTH, .debounce_ms = 0,
+        };
+        if (HAL_GpioLine_Request(e->chip, &lc, &e->line[i]) != HAL_GPIO_OK) {
+            OSAL_LOG("[ENC] request line %d failed\r\n", offs[i]);
+            BoardEncoder_Close(e);
+            return -1;
+        }
+        e->pfd[i].fd     = HAL_GpioLine_GetEventFd(e->line[i]);
+        e->pfd[i].events = POLLIN;
+        if (e->pfd[i].fd < 0) e->pollable = 0;
+    }
+    int a = 0, b = 0;
+    HAL_GpioLine_Read(e->line[0], &a);
+    HAL_GpioLine_Read(e->line[1], &b);
+    e->ab = (uint8_t)(((a ? 1 : 0) << 1) | (b ? 1 : 0));
+    *out = e;
+    return 0;
+}
+
+void BoardEncoder_Close(BoardEncoder* e) {
+    if (!e) return;
+    BoardEncoder_Stop(e);
+    for (int i = 0; i < ENC_LINES; ++i) HAL_GpioLine_Release(e->line[i]);
+    if (!e->cfg.chip) HAL_GpioChip_Close(e->chip);
+    free(e);
+}
@@ -0,0 +1,389 @@
+/**
+ * @file board_keypad.c
+ * @brief Matrix keypad scanner: masked row writes, column bitmaps, bitwise
+ *        debounce + ghost masking, events into an OSAL queue, idle on edge wake.
+ *
+ * Notes:
+ *  - Trạng thái quét (hist, state, row_val, idle) chỉ thuộc thread gọi Poll.
+ *    Task khác chỉ đọc các trường pub_* (store / load atomic relaxed).
+ *  - row_val là mức logic hiện tại của cả nhóm hàng: đổi hàng chỉ ghi các
+ *    line có bit khác (row_val ^ want), thường là hai line.
+ *  - Line cột luôn request edge BOTH: lúc active event vẫn dồn vào hàng đợi
+ *    của kernel (không ai đọc, đầy thì kernel bỏ), nên xả hết trước khi vào idle.
+ */
+#include "board_keypad.h"
+#include "osal.h"
+#include "osal_task.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define KEYPAD_QUEUE_DEPTH  32
+#define KEYPAD_IDLE_MS      100    /* timeout của task lúc idle (để Stop không phải chờ lâu) */
+#define KEYPAD_IDLE_POLL_MS 10     /* idle không có event fd: chu kỳ đọc bitmap cột */
+#define KEYPAD_ALL          (-2)   /* _select: mọi hàng */
+
+struct BoardKeypad {
+    BoardKeypadCfg   cfg;
+    HAL_GpioChip*    chip;
+    HAL_GpioLine*    rows[BOARD_KEYPAD_MAX_ROWS];
+    HAL_GpioLine*    cols[BOARD_KEYPAD_MAX_COLS];
+    HAL_GpioGroup    rgrp, cgrp;
+    uint32_t         all_rows;
+    uint32_t         row_val;          /* mức logic đang ghi lên nhóm hàng */
+    struct pollfd    pfd[BOARD_KEYPAD_MAX_COLS];
+    int              pollable;         /* mọi cột có event fd */
+    OSAL_QueueHandle q;
+    int              own_q;
+
+    /* quét (chỉ thread Poll) */
+    uint32_t         hist[BOARD_KEYPAD_MAX_ROWS][BOARD_KEYPAD_DEB_MAX];
+    unsigned         hidx;
+    uint32_t         state[BOARD_KEYPAD_MAX_ROWS];
+    int              idle;
+    uint64_t         last_key_ns;      /* lần quét gần nhất còn thấy phím */
+    struct timespec  next;             /* deadline lần quét kế tiếp (CLOCK_MONOTONIC) */
+    uint64_t         scans, events, dropped, ghost, wakeups;
+
+    /* publish */
+    uint32_t         pub_state[BOARD_KEYPAD_MAX_ROWS];
+    int              pub_idle;
+    uint64_t         pub_scans, pub_events, pub_dropped, pub_ghost, pub_wakeups;
+
+    OSAL_TaskHandle  task;
+    volatile int     run;
+};
+
+static uint64_t _mono_ns(void* ctx) {
+    (void)ctx;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#define PUB(field_, v_) __atomic_store_n(&k->field_, (v_), __ATOMIC_RELAXED)
+#define GET(field_)     __atomic_load_n(&kp->field_, __ATOMIC_RELAXED)
+
+static void _ts_add_us(struct timespec* ts, uint32_t us) {
+    ts->tv_sec  += us / 1000000u;
+    ts->tv_nsec += (long)(us % 1000000u) * 1000L;
+    if (ts->tv_nsec >= 1000000000L) { ts->tv_sec++; ts->tv_nsec -= 1000000000L; }
+}
+
+static int _ts_before(const struct timespec* a, const struct timespec* b) {
+    return a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+/* vài µs: spin, nanosleep ngắn thường trễ hơn cả khoảng cần chờ */
+static void _settle(uint32_t us) {
+    if (!us) return;
+    uint64_t end = _mono_ns(NULL) + (uint64_t)us * 1000ull;
+    while (_mono_ns(NULL) < end) { }
+}
+
+/* row: >= 0 một hàng, -1 không hàng nào, KEYPAD_ALL mọi hàng */
+static void _select(BoardKeypad* k, int row) {
+    uint32_t want = (row == KEYPAD_ALL) ? k->all_rows : (row < 0) ? 0u : (1u << row);
+    uint32_t diff = k->row_val ^ want;
+    if (!diff) return;
+    HAL_GpioGroup_WriteMask(&k->rgrp, diff, want);
+    k->row_val = want;
+}
+
+static void _drain_cols(BoardKeypad* k) {
+    HAL_GpioEvent evs[16];
+    for (int c = 0; c < k->cfg.ncols; ++c) {
+        size_t n = 0;
+        while (HAL_GpioLine_ReadEvents(k->cols[c], 0, evs, 16, &n) == HAL_GPIO_OK && n) { }
+    }
+}
+
+static void _emit(BoardKeypad* k, int row, int col, int pressed, uint64_t t) {
+    BoardKeypadEvent ev = { .row = (uint8_t)row, .col = (uint8_t)col, .pressed = (uint8_t)pressed, .t_ns = t };
+    if (OSAL_QueueSend(k->q, &ev, 0) == OSAL_OK) k->events++;
+    else                                         k->dropped++;
+}
+
+/* phím mới ấn nằm trên hình chữ nhật (hai hàng chung >= 2 cột) bị bỏ khỏi raw */
+static int _mask_ghosts(BoardKeypad* k, uint32_t* raw) {
+    uint32_t gm[BOARD_KEYPAD_MAX_ROWS] = { 0 };
+    int any = 0;
+    for (int r1 = 0; r1 < k->cfg.nrows; ++r1) {
+        if (__builtin_popcount(raw[r1]) < 2) continue;
+        for (int r2 = r1 + 1; r2 < k->cfg.nrows; ++r2) {
+            uint32_t c = raw[r1] & raw[r2];
+            if (__builtin_popcount(c) < 2) continue;
+            gm[r1] |= c;
+            gm[r2] |= c;
+            any = 1;
+        }
+    }
+    if (!any) return 0;
+    int blocked = 0;
+    for (int r = 0; r < k->cfg.nrows; ++r) {
+        uint32_t b = raw[r] & gm[r] & ~k->state[r];
+        if (b) { raw[r] &= ~b; blocked = 1; }
+    }
+    return blocked;
+}
+
+/* quét cả ma trận; trả về số event */
+static int _scan(BoardKeypad* k) {
+    uint32_t raw[BOARD_KEYPAD_MAX_ROWS];
+    for (int r = 0; r < k->cfg.nrows; ++r) {
+        _select(k, r);
+        _settle(k->cfg.settle_us);
+        raw[r] = 0;
+        HAL_GpioGroup_ReadBitmap(&k->cgrp, &raw[r]);
+    }
+    uint64_t now = k->cfg.now_ns(k->cfg.now_ctx);
+    k->scans++;
+    if (_mask_ghosts(k, raw)) k->ghost++;
+
+    /* debounce: ấn khi cả cửa sổ đều ấn (AND), nhả khi cả cửa sổ đều nhả (OR = 0) */
+    unsigned d = k->cfg.debounce_scans;
+    unsigned slot = k->hidx;
+    k->hidx = (k->hidx + 1u) % d;
+    int n = 0;
+    uint32_t keys = 0;
+    for (int r = 0; r < k->cfg.nrows; ++r) {
+        k->hist[r][slot] = raw[r];
+        uint32_t all = ~0u, some = 0;
+        for (unsigned i = 0; i < d; ++i) {
+            all  &= k->hist[r][i];
+            some |= k->hist[r][i];
+        }
+        uint32_t next = (k->state[r] | all) & some;
+        uint32_t diff = next ^ k->state[r];
+        while (diff) {
+            int c = __builtin_ctz(diff);
+            diff &= diff - 1u;
+            _emit(k, r, c, (int)((next >> c) & 1u), now);
+            ++n;
+        }
+        if (next != k->state[r]) {
+            k->state[r] = next;
+            PUB(pub_state[r], next);
+        }
+        keys |= next | raw[r];
+    }
+    if (keys) k->last_key_ns = now;
+    return n;
+}
+
+/* chọn mọi hàng và chờ cạnh cột; 0 nếu đã vào idle, 1 nếu vẫn có phím */
+static int _enter_idle(BoardKeypad* k) {
+    _select(k, KEYPAD_ALL);
+    _settle(k->cfg.settle_us);
+    _drain_cols(k);
+    uint32_t bm = 0;
+    HAL_GpioGroup_ReadBitmap(&k->cgrp, &bm);
+    if (bm) return 1;
+    k->idle = 1;
+    return 0;
+}
+
+/* idle: chờ tối đa timeout_ms; 1 nếu có phím (đã thoát idle) */
+static int _idle_wait(BoardKeypad* k, int timeout_ms) {
+    if (k->pollable) {
+        int rc = poll(k->pfd, (nfds_t)k->cfg.ncols, timeout_ms);
+        if (rc < 0 && errno != EINTR) return -1;
+        if (rc > 0) _drain_cols(k);
+    } else if (timeout_ms != 0) {
+        int ms = (timeout_ms < 0 || timeout_ms > KEYPAD_IDLE_POLL_MS) ? KEYPAD_IDLE_POLL_MS : timeout_ms;
+        (void)poll(NULL, 0, ms);
+    }
+    /* cạnh có thể là nhiễu / bounce: chỉ thức khi bitmap thật sự có phím */
+    uint32_t bm = 0;
+    HAL_GpioGroup_ReadBitmap(&k->cgrp, &bm);
+    if (!bm) return 0;
+    k->idle = 0;
+    k->wakeups++;
+    k->last_key_ns = k->cfg.now_ns(k->cfg.now_ctx);
+    clock_gettime(CLOCK_MONOTONIC, &k->next);
+    return 1;
+}
+
+static void _publish(BoardKeypad* k) {
+    PUB(pub_idle, k->idle);
+    PUB(pub_scans, k->scans);
+    PUB(pub_events, k->events);
+    PUB(pub_dropped, k->dropped);
+    PUB(pub_ghost, k->ghost);
+    PUB(pub_wakeups, k->wakeups);
+}
+
+int BoardKeypad_Poll(BoardKeypad* k, int timeout_ms) {
+    if (!k) return -1;
+    if (k->idle) {
+        int rc = _idle_wait(k, timeout_ms);
+        if (rc <= 0) {
+            _publish(k);
+            return rc;
+        }
+    } else if (timeout_ms != 0) {
+        /* chờ tới lượt quét, không quá timeout_ms */
+        struct timespec now, lim;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        lim = now;
+        if (timeout_ms > 0) _ts_add_us(&lim, (uint32_t)timeout_ms * 1000u);
+        if (timeout_ms > 0 && _ts_before(&lim, &k->next)) {
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &lim, NULL);
+            return 0;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &k->next, NULL);
+        _ts_add_us(&k->next, k->cfg.scan_us);
+        /* trễ hơn một chu kỳ (bị preempt): quét lại từ bây giờ, không dồn */
+        if (_ts_before(&k->next, &now)) {
+            k->next = now;
+            _ts_add_us(&k->next, k->cfg.scan_us);
+        }
+    }
+
+    int n = _scan(k);
+    uint64_t now = k->cfg.now_ns(k->cfg.now_ctx);
+    /* cột vẫn thấy phím khi chọn mọi hàng (ấn ngay sau lần quét, rò hàng -> cột):
+     * ở lại active và tính lại idle_ms từ đây, không thử lại ở mỗi lần quét */
+    if (now - k->last_key_ns >= (uint64_t)k->cfg.idle_ms * 1000000ull && _enter_idle(k))
+        k->last_key_ns = now;
+    _publish(k);
+    return n;
+}
+
+/* --- reader (wait-free) --- */
+
+OSAL_QueueHandle BoardKeypad_Queue(const BoardKeypad* kp) {
+    return kp ? kp->q : NULL;
+}
+
+uint32_t BoardKeypad_RowState(const BoardKeypad* kp, int row) {
+    if (!kp || row < 0 || row >= kp->cfg.nrows) return 0;
+    return GET(pub_state[row]);
+}
+
+int BoardKeypad_IsIdle(const BoardKeypad* kp) {
+    return kp ? GET(pub_idle) : 0;
+}
+
+void BoardKeypad_GetStats(const BoardKeypad* kp, BoardKeypadStats* out) {
+    if (!kp || !out) return;
+    out->scans   = GET(pub_scans);
+    out->events  = GET(pub_events);
+    out->dropped = GET(pub_dropped);
+    out->ghost   = GET(pub_ghost);
+    out->wakeups = GET(pub_wakeups);
+}
+
+/* --- lifetime --- */
+
+static void KeypadTask(void* arg) {
+    BoardKeypad* k = (BoardKeypad*)arg;
+    while (k->run) {
+        if (BoardKeypad_Poll(k, KEYPAD_IDLE_MS) < 0) OSAL_TaskDelayMs(10);
+    }
+}
+
+int BoardKeypad_Start(BoardKeypad* k, uint8_t task_prio) {
+    if (!k) return -1;
+    if (k->run) return 0;
+    k->run = 1;
+    clock_gettime(CLOCK_MONOTONIC, &k->next);
+    OSAL_TaskAttr a = { .name = "Keypad", .stack_size = 4096, .prio = task_prio };
+    if (OSAL_TaskCreate(&k->task, KeypadTask, k, &a) != OSAL_OK) {
+        OSAL_LOG("[KEYPAD] task create failed\r\n");
+        k->run = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void BoardKeypad_Stop(BoardKeypad* k) {
+    if (!k || !k->run) return;
+    k->run = 0;
+    OSAL_TaskDelete(k->task);
+    k->task = NULL;
+}
+
+int BoardKeypad_Open(const BoardKeypadCfg* cfg, BoardKeypad** out) {
+    if (!cfg || !out || !cfg->row_offsets || !cfg->col_offsets ||
+        !cfg->nrows || cfg->nrows > BOARD_KEYPAD_MAX_ROWS ||
+        !cfg->ncols || cfg->ncols > BOARD_KEYPAD_MAX_COLS ||
+        cfg->debounce_scans > BOARD_KEYPAD_DEB_MAX) return -1;
+    BoardKeypad* k = (BoardKeypad*)calloc(1, sizeof(*k));
+    if (!k) return -1;
+    k->cfg = *cfg;
+    if (!k->cfg.scan_us)        k->cfg.scan_us        = 1000;
+    if (!k->cfg.debounce_scans) k->cfg.debounce_scans = 4;
+    if (!k->cfg.idle_ms)        k->cfg.idle_ms        = 50;
+    if (!k->cfg.now_ns)         k->cfg.now_ns         = _mono_ns;
+    k->all_rows = (cfg->nrows == 32) ? ~0u : ((1u << cfg->nrows) - 1u);
+
+    k->q = cfg->queue;
+    if (!k->q) {
+        if (OSAL_QueueCreate(&k->q, sizeof(BoardKeypadEvent), KEYPAD_QUEUE_DEPTH) != OSAL_OK) {
+            free(k);
+            return -1;
+        }
+        k->own_q = 1;
+    }
+
+    HAL_GpioChipConfig cc = { .chip_name = cfg->chip_name };
+    k->chip = cfg->chip;
+    if (!k->chip && HAL_GpioChip_Open(&cc, &k->chip) != HAL_GPIO_OK) {
+        OSAL_LOG("[KEYPAD] open chip %s failed\r\n", cfg->chip_name ? cfg->chip_name : "(null)");
+        k->chip = NULL;
+        BoardKeypad_Close(k);
+        return -1;
+    }
+
+    HAL_GpioDrive drive = cfg->rows_pushpull ? HAL_GPIO_DRIVE_PUSHPULL
+                        : (cfg->active == HAL_GPIO_ACTIVE_LOW) ? HAL_GPIO_DRIVE_OPENDRAIN
+                        :                                        HAL_GPIO_DRIVE_OPENSOURCE;
+    for (int r = 0; r < cfg->nrows; ++r) {
+        HAL_GpioLineConfig lc = {
+            .offset = cfg->row_offsets[r], .dir = HAL_GPIO_DIR_OUT, .active = cfg->active,
+            .drive = drive, .initial = 0,
+        };
+        if (HAL_GpioLine_Request(k->chip, &lc, &k->rows[r]) != HAL_GPIO_OK) {
+            OSAL_LOG("[KEYPAD] request row line %d failed\r\n", cfg->row_offsets[r]);
+            BoardKeypad_Close(k);
+            return -1;
+        }
+    }
+    k->pollable = 1;
+    for (int c = 0; c < cfg->ncols; ++c) {
+        HAL_GpioLineConfig lc = {
+            .offset = cfg->col_offsets[c], .dir = HAL_GPIO_DIR_IN, .active = cfg->active,
+            .bias = cfg->col_bias, .edge = HAL_GPIO_EDGE_BOTH, .debounce_ms = 0,
+        };
+        if (HAL_GpioLine_Request(k->chip, &lc, &k->cols[c]) != HAL_GPIO_OK) {
+            OSAL_LOG("[KEYPAD] request column line %d failed\r\n", cfg->col_offsets[c]);
+            BoardKeypad_Close(k);
+            return -1;
+        }
+        k->pfd[c].fd     = HAL_GpioLine_GetEventFd(k->cols[c]);
+        k->pfd[c].events = POLLIN;
+        if (k->pfd[c].fd < 0) k->pollable = 0;
+    }
+    k->rgrp = (HAL_GpioGroup){ .lines = k->rows, .count = cfg->nrows };
+    k->cgrp = (HAL_GpioGroup){ .lines = k->cols, .count = cfg->ncols };
+
+    /* bắt đầu active: có phím đang giữ lúc mở thì thấy ngay, không thì về idle sau idle_ms */
+    k->last_key_ns = k->cfg.now_ns(k->cfg.now_ctx);
+    clock_gettime(CLOCK_MONOTONIC, &k->next);
+    *out = k;
+    return 0;
+}
+
+void BoardKeypad_Close(BoardKeypad* k) {
+    if (!k) return;
+    BoardKeypad_Stop(k);
+    for (int i = 0; i < BOARD_KEYPAD_MAX_COLS; ++i) HAL_GpioLine_Release(k->cols[i]);
+    for (int i = 0; i < BOARD_KEYPAD_MAX_ROWS; ++i) HAL_GpioLine_Release(k->rows[i]);
+    if (k->chip && !k->cfg.chip) HAL_GpioChip_Close(k->chip);
+    if (k->own_q) OSAL_QueueDelete(k->q);
+    free(k);
+}
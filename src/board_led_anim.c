@@ -0,0 +1,317 @@
+/**
+ * @file board_led_anim.c
+ * @brief LED animation service: compose all patterns into one frame per tick,
+ *        commit with one BoardLed bulk write only when the frame changes.
+ *
+ * Notes:
+ *  - Thời gian của pattern tính theo số tick (tick_us cố định), nên animation
+ *    không trôi theo jitter của scheduler; nếu task bị trễ, số tick được
+ *    cộng theo thời gian thật (không "tua chậm").
+ *  - API có thể gọi từ task khác: bảng pattern được bảo vệ bằng OSAL mutex,
+ *    giữ lock chỉ trong lúc ghép frame (không giữ khi ghi GPIO).
+ *  - Chỉ ghi các LED mà ít nhất một pattern đang sở hữu (hợp các mask): LED
+ *    khác do code khác điều khiển không bị ghi đè. LED vừa hết chủ (pattern
+ *    xong / bị xoá) được tắt một lần; Stop chỉ tắt LED đang sở hữu.
+ */
+#include "board_led_anim.h"
+#include "board_led.h"
+#include "osal.h"
+#include "osal_task.h"
+#include "osal_mutex.h"
+
+#include <string.h>
+
+typedef struct {
+    uint8_t          used;
+    uint16_t         gen;         /* tăng mỗi lần slot được dùng lại (id cũ -> không hợp lệ) */
+    BoardLedAnimSpec spec;
+    uint64_t         start_tick;
+    uint32_t         value;
+} AnimSlot;
+
+static AnimSlot          s_slots[BOARD_LED_ANIM_MAX];
+static uint8_t           s_order[BOARD_LED_ANIM_MAX];  /* slot theo priority tăng dần */
+static unsigned          s_order_n = 0;
+
+static BoardLedAnimCfg   s_cfg;
+static OSAL_MutexHandle  s_mtx   = NULL;
+static OSAL_TaskHandle   s_task  = NULL;
+static volatile int      s_run   = 0;
+
+static uint64_t          s_tick  = 0;
+static uint64_t          s_frame = 0;
+static uint64_t          s_owned = 0;      /* các LED của frame đã commit */
+static int               s_frame_valid = 0;
+static uint64_t          s_commits  = 0;
+static uint64_t          s_commit_errors = 0;
+static uint64_t          s_overruns = 0;
+
+/* --- helpers --- */
+
+static unsigned _popcount64(uint64_t v) {
+    return (unsigned)__builtin_popcountll(v);
+}
+
+/* bit thứ k (0-based) đang bật trong mask */
+static uint64_t _nth_bit(uint64_t mask, unsigned k) {
+    while (k--) mask &= mask - 1;
+    return mask & (~mask + 1);
+}
+
+/* rải các bit thấp của v lên các bit của mask (pdep mềm) */
+static uint64_t _scatter(uint64_t v, uint64_t mask) {
+    uint64_t out = 0;
+    for (uint64_t m = mask; m && v; m &= m - 1, v >>= 1) {
+        if (v & 1u) out |= m & (~m + 1);
+    }
+    return out;
+}
+
+/* rebuild thứ tự ghép (insertion sort, ổn định theo slot) – gọi khi giữ lock */
+static void _rebuild_order(void) {
+    s_order_n = 0;
+    for (unsigned i = 0; i < BOARD_LED_ANIM_MAX; ++i) {
+        if (!s_slots[i].used) continue;
+        unsigned j = s_order_n++;
+        while (j > 0 && s_slots[s_order[j - 1]].spec.priority > s_slots[i].spec.priority) {
+            s_order[j] = s_order[j - 1];
+            --j;
+        }
+        s_order[j] = (uint8_t)i;
+    }
+}
+
+static int _id_to_slot(BoardLedAnimId id) {
+    if (id <= 0) return -1;
+    int idx = (id & 0xFF) - 1;
+    if (idx < 0 || idx >= BOARD_LED_ANIM_MAX) return -1;
+    if (!s_slots[idx].used || s_slots[idx].gen != (uint16_t)(id >> 8)) return -1;
+    return idx;
+}
+
+/**
+ * @brief Giá trị pattern tại tick hiện tại (chỉ các bit trong mask).
+ * @param[out] finished 1 nếu đã chạy đủ repeat chu kỳ
+ */
+static uint64_t _eval(const AnimSlot* a, uint64_t tick, int* finished) {
+    const BoardLedAnimSpec* sp = &a->spec;
+    const uint64_t t_ms   = (tick - a->start_tick) * s_cfg.tick_us / 1000u;
+    const uint64_t period = sp->period_ms ? sp->period_ms : 1;
+    uint64_t cycles = 0, bits = 0;
+
+    switch (sp->kind) {
+    case BOARD_LED_ANIM_SOLID:
+        bits = a->value ? sp->mask : 0;
+        break;
+
+    case BOARD_LED_ANIM_BLINK: {
+        const unsigned duty = sp->duty_pct ? (sp->duty_pct > 100 ? 100 : sp->duty_pct) : 50;
+        bits   = ((t_ms % period) * 100u < period * duty) ? sp->mask : 0;
+        cycles = t_ms / period;
+        break;
+    }
+
+    case BOARD_LED_ANIM_BREATHE: {
+        /* tam giác 0..S..0 trong period, gamma ~2 cho mắt, rồi PWM theo tick */
+        const uint64_t S  = s_cfg.pwm_steps;
+        const uint64_t ph = t_ms % period;
+        const uint64_t tri = (ph * 2u < period) ? (ph * 2u * S) / period
+                                                : ((period - ph) * 2u * S) / period;
+        const uint64_t level = (tri * tri) / S;
+        bits   = ((tick % S) < level) ? sp->mask : 0;
+        cycles = t_ms / period;
+        break;
+    }
+
+    case BOARD_LED_ANIM_CHASE: {
+        const unsigned n = _popcount64(sp->mask);
+        if (!n) break;
+        const uint64_t step = t_ms / period;
+        unsigned k = (unsigned)(step % n);
+        if (sp->reverse) k = n - 1u - k;
+        bits   = _nth_bit(sp->mask, k);
+        cycles = step / n;
+        break;
+    }
+
+    case BOARD_LED_ANIM_COUNTER: {
+        uint64_t v = a->value;
+        if (sp->period_ms) v += t_ms / sp->period_ms;
+        bits = _scatter(v, sp->mask);
+        break;
+    }
+    }
+
+    *finished = (sp->repeat && cycles >= sp->repeat);
+    return bits;
+}
+
+/* ghép frame – gọi khi giữ lock. owned = hợp mask của các pattern còn chạy */
+static uint64_t _compose(uint64_t tick, uint64_t* owned) {
+    uint64_t frame = 0, own = 0;
+    int removed = 0;
+    for (unsigned i = 0; i < s_order_n; ++i) {
+        AnimSlot* a = &s_slots[s_order[i]];
+        int finished = 0;
+        uint64_t bits = _eval(a, tick, &finished);
+        if (finished) { a->used = 0; removed = 1; continue; }
+        frame = (frame & ~a->spec.mask) | bits;
+        own  |= a->spec.mask;
+    }
+    if (removed) _rebuild_order();
+    *owned = own;
+    return frame;
+}
+
+static void _commit(uint64_t owned, uint64_t frame) {
+    if (s_frame_valid && frame == s_frame && owned == s_owned) return;
+    /* owned | s_owned: LED vừa hết chủ được tắt (frame = 0 ở đó) */
+    if (BoardLed_WriteMasked(owned | s_owned, frame) != 0) {
+        /* giữ cả LED cũ trong s_owned để lần sau / Stop vẫn dọn chúng */
+        s_owned |= owned;
+        s_frame_valid = 0;
+        s_commit_errors++;
+        return;
+    }
+    s_frame = frame;
+    s_owned = owned;
+    s_frame_valid = 1;
+    s_commits++;
+}
+
+static void AnimTask(void* arg) {
+    (void)arg;
+    uint64_t prev = 0;
+
+    while (s_run) {
+        uint64_t last = prev;
+        OSAL_TaskDelayUntilUs(&prev, s_cfg.tick_us);
+        if (!s_run) break;
+
+        /* bị trễ hoặc re-anchor: cộng theo thời gian thật */
+        uint64_t adv = last ? (prev - last) / s_cfg.tick_us : 1;
+        if (adv > 1) s_overruns++;
+
+        uint64_t owned;
+        OSAL_MutexLock(s_mtx, OSAL_WAIT_FOREVER);
+        s_tick += adv ? adv : 1;
+        uint64_t frame = _compose(s_tick, &owned);
+        OSAL_MutexUnlock(s_mtx);
+
+        _commit(owned, frame);
+    }
+    OSAL_LOG("[LED][Anim] task exit\r\n");
+}
+
+/* --- API --- */
+
+int BoardLedAnim_Start(const BoardLedAnimCfg* cfg) {
+    if (s_run) return 0;
+
+    memset(&s_cfg, 0, sizeof(s_cfg));
+    if (cfg) s_cfg = *cfg;
+    if (!s_cfg.tick_us)   s_cfg.tick_us   = 1000;
+    if (!s_cfg.pwm_steps) s_cfg.pwm_steps = 16;
+    if (!s_cfg.task_prio) s_cfg.task_prio = 20;
+
+    if (!s_mtx && OSAL_MutexCreate(&s_mtx) != OSAL_OK) {
+        OSAL_LOG("[LED][Anim] mutex create failed\r\n");
+        return -1;
+    }
+    s_frame_valid = 0;
+    s_frame = s_owned = 0;
+    s_commits = s_commit_errors = s_overruns = 0;
+
+    s_run = 1;
+    OSAL_TaskAttr a = { .name = "LedAnim", .stack_size = 2048, .prio = s_cfg.task_prio };
+    if (OSAL_TaskCreate(&s_task, AnimTask, NULL, &a) != OSAL_OK) {
+        OSAL_LOG("[LED][Anim] task create failed\r\n");
+        s_run = 0;
+        return -1;
+    }
+    OSAL_LOG("[LED][Anim] started (tick=%uus, pwm=%u steps)\r\n",
+             (unsigned)s_cfg.tick_us, (unsigned)s_cfg.pwm_steps);
+    return 0;
+}
+
+void BoardLedAnim_Stop(void) {
+    if (!s_run) return;
+    s_run = 0;
+    OSAL_TaskDelete(s_task);
+    s_task = NULL;
+    BoardLedAnim_Clear();
+    /* chỉ tắt LED của animation, LED khác giữ nguyên */
+    if (s_owned && BoardLed_WriteMasked(s_owned, 0) != 0) s_commit_errors++;
+    s_frame = s_owned = 0;
+    s_frame_valid = 0;
+}
+
+BoardLedAnimId BoardLedAnim_Add(const BoardLedAnimSpec* spec) {
+    if (!spec || !spec->mask || !s_mtx) return -1;
+    if (spec->kind > BOARD_LED_ANIM_COUNTER) return -1;
+
+    BoardLedAnimId id = -1;
+    OSAL_MutexLock(s_mtx, OSAL_WAIT_FOREVER);
+    for (unsigned i = 0; i < BOARD_LED_ANIM_MAX; ++i) {
+        AnimSlot* a = &s_slots[i];
+        if (a->used) continue;
+        a->gen = (uint16_t)((a->gen + 1u) & 0x7FFFu);
+        if (!a->gen) a->gen = 1;
+        a->spec       = *spec;
+        a->value      = spec->value;
+        a->start_tick = s_tick;
+        a->used       = 1;
+        _rebuild_order();
+        id = (BoardLedAnimId)(((int)a->gen << 8) | (int)(i + 1));
+        break;
+    }
+    OSAL_MutexUnlock(s_mtx);
+    return id;
+}
+
+int BoardLedAnim_Remove(BoardLedAnimId id) {
+    if (!s_mtx) return -1;
+    OSAL_MutexLock(s_mtx, OSAL_WAIT_FOREVER);
+    int idx = _id_to_slot(id);
+    if (idx >= 0) {
+        s_slots[idx].used = 0;
+        _rebuild_order();
+    }
+    OSAL_MutexUnlock(s_mtx);
+    return idx >= 0 ? 0 : -1;
+}
+
+void BoardLedAnim_Clear(void) {
+    if (!s_mtx) return;
+    OSAL_MutexLock(s_mtx, OSAL_WAIT_FOREVER);
+    for (unsigned i = 0; i < BOARD_LED_ANIM_MAX; ++i) s_slots[i].used = 0;
+    s_order_n = 0;
+    OSAL_MutexUnlock(s_mtx);
+}
+
+int BoardLedAnim_SetValue(BoardLedAnimId id, uint32_t value) {
+    if (!s_mtx) return -1;
+    OSAL_MutexLock(s_mtx, OSAL_WAIT_FOREVER);
+    int idx = _id_to_slot(id);
+    if (idx >= 0) {
+        s_slots[idx].value      = value;
+        s_slots[idx].start_tick = s_tick;   /* COUNTER tự đếm tiếp từ value */
+    }
+    OSAL_MutexUnlock(s_mtx);
+    return idx >= 0 ? 0 : -1;
+}
+
+void BoardLedAnim_GetStats(BoardLedAnimStats* out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!s_mtx) return;
+    OSAL_MutexLock(s_mtx, OSAL_WAIT_FOREVER);
+    out->ticks    = s_tick;
+    out->commits  = s_commits;
+    out->commit_errors = s_commit_errors;
+    out->overruns = s_overruns;
+    out->frame    = s_frame;
+    out->owned    = s_owned;
+    out->active   = s_order_n;
+    OSAL_MutexUnlock(s_mtx);
+}
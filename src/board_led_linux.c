@@ -1,6 +1,10 @@
 // board_led_linux_gpiod.c
+// - LED rải trên nhiều gpiochip: mỗi chip MỘT bulk request (libgpiod v1)
+// - Ghi theo mặt nạ 64 bit: chỉ chip có LED thay đổi mới bị ghi (1 ioctl / chip)
+//   => 40 LED trên 3 chip = tối đa 3 ioctl, không phải 40
 #include "board_led.h"
 #include "osal.h"
+#include "osal_mutex.h"
 #include <gpiod.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -16,18 +20,114 @@ typedef struct {
     unsigned    count;       // số LED, mặc định 8
 } OSAL_GpiodCtx;
 
-static struct gpiod_chip*     s_chip  = NULL;
-static struct gpiod_line_bulk s_bulk;
-static struct gpiod_line*     s_lines[OSAL_GPIOD_MAX]; /* truy cập từng line nhanh */
-static unsigned               s_count = 0;
+typedef struct {
+    struct gpiod_chip*     chip;
+    char                   name[32];
+    struct gpiod_line_bulk bulk;
+    uint8_t                led[GPIOD_LINE_BULK_MAX_LINES]; /* bulk line j -> LED index */
+    uint64_t               mask;                           /* các LED thuộc chip này */
+    uint8_t                requested;
+} LedChip;
+
+static LedChip          s_chips[BOARD_LED_MAX_CHIPS];
+static unsigned         s_nchips     = 0;
+static unsigned         s_count      = 0;
+static int              s_active_low = 0;
+static uint64_t         s_state      = 0;   /* logic, bit i = LED i */
+static OSAL_MutexHandle s_mtx        = NULL;
+
+static uint64_t _all_mask(void) {
+    return (s_count >= 64) ? ~0ull : ((1ull << s_count) - 1ull);
+}
 
-static int _ints_all(int *dst, int v, unsigned n){
-    for (unsigned i=0;i<n;i++) dst[i]=v;
-    return 0;
+static LedChip* _chip_get_or_open(const char* name) {
+    for (unsigned i = 0; i < s_nchips; ++i)
+        if (strcmp(s_chips[i].name, name) == 0) return &s_chips[i];
+    if (s_nchips >= BOARD_LED_MAX_CHIPS) return NULL;
+
+    LedChip* c = &s_chips[s_nchips];
+    memset(c, 0, sizeof(*c));
+    c->chip = gpiod_chip_open_by_name(name);
+    if (!c->chip) {
+        OSAL_LOG("[LED][GPIOD] open %s failed\r\n", name);
+        return NULL;
+    }
+    strncpy(c->name, name, sizeof(c->name) - 1);
+    gpiod_line_bulk_init(&c->bulk);
+    s_nchips++;
+    return c;
+}
+
+/* ghi 1 chip theo trạng thái logic st – gọi khi giữ lock. Trả 0 nếu OK */
+static int _chip_commit(LedChip* c, uint64_t st) {
+    int vals[GPIOD_LINE_BULK_MAX_LINES];
+    for (unsigned j = 0; j < c->bulk.num_lines; ++j)
+        vals[j] = (int)((st >> c->led[j]) & 1u) ^ s_active_low;
+    if (gpiod_line_set_value_bulk(&c->bulk, vals) == 0) return 0;
+
+    /* fallback từng line */
+    int rc = 0;
+    for (unsigned j = 0; j < c->bulk.num_lines; ++j)
+        if (gpiod_line_set_value(c->bulk.lines[j], vals[j]) != 0) rc = -1;
+    return rc;
 }
 
-static void _fill_vals_from_mask(int* vals, uint8_t mask, unsigned n) {
-    for (unsigned i = 0; i < n; ++i) vals[i] = (mask >> i) & 0x1;
+void BoardLed_Deinit(void)
+{
+    for (unsigned i = 0; i < s_nchips; ++i) {
+        if (s_chips[i].requested) gpiod_line_release_bulk(&s_chips[i].bulk);
+        if (s_chips[i].chip) gpiod_chip_close(s_chips[i].chip);
+        memset(&s_chips[i], 0, sizeof(s_chips[i]));
+    }
+    s_nchips = 0;
+    s_count  = 0;
+    s_state  = 0;
+}
+
+int BoardLed_InitCfg(const BoardLedCfg* cfg)
+{
+    if (!cfg || !cfg->pins || cfg->count == 0 || cfg->count > BOARD_LED_MAX) return -1;
+    if (!s_mtx && OSAL_MutexCreate(&s_mtx) != OSAL_OK) return -1;
+
+    BoardLed_Deinit();
+    s_active_low = cfg->active_low ? 1 : 0;
+
+    /* 1) gom line theo chip */
+    for (unsigned i = 0; i < cfg->count; ++i) {
+        const char* name = cfg->pins[i].chip_name ? cfg->pins[i].chip_name : "gpiochip0";
+        LedChip* c = _chip_get_or_open(name);
+        if (!c) goto fail;
+        if (c->bulk.num_lines >= GPIOD_LINE_BULK_MAX_LINES) goto fail;
+        struct gpiod_line* ln = gpiod_chip_get_line(c->chip, cfg->pins[i].offset);
+        if (!ln) {
+            OSAL_LOG("[LED][GPIOD] %s line %u not found\r\n", name, cfg->pins[i].offset);
+            goto fail;
+        }
+        c->led[c->bulk.num_lines] = (uint8_t)i;
+        gpiod_line_bulk_add(&c->bulk, ln);
+        c->mask |= 1ull << i;
+    }
+
+    /* 2) mỗi chip một bulk request, mặc định OFF */
+    const char* consumer = cfg->consumer ? cfg->consumer : "osal_led";
+    for (unsigned i = 0; i < s_nchips; ++i) {
+        int init[GPIOD_LINE_BULK_MAX_LINES];
+        for (unsigned j = 0; j < s_chips[i].bulk.num_lines; ++j) init[j] = s_active_low;
+        if (gpiod_line_request_bulk_output(&s_chips[i].bulk, consumer, init) != 0) {
+            OSAL_LOG("[LED][GPIOD] request output failed on %s\r\n", s_chips[i].name);
+            goto fail;
+        }
+        s_chips[i].requested = 1;
+    }
+
+    s_count = cfg->count;
+    s_state = 0;
+    OSAL_LOG("[LED][GPIOD] ready: %u LED on %u chip(s)\r\n", s_count, s_nchips);
+    return 0;
+
+fail:
+    BoardLed_Deinit();
+    return -1;
 }
 
 void BoardLed_Init(void)
@@ -36,71 +136,73 @@ void BoardLed_Init(void)
 
     const char* chip_name = (ctx && ctx->chip_name) ? ctx->chip_name : "gpiochip0";
     unsigned line_base    = (ctx) ? ctx->line_base : 0;
-    s_count               = (ctx && ctx->count) ? ctx->count : 8;
-    if (s_count > OSAL_GPIOD_MAX) s_count = OSAL_GPIOD_MAX;
+    unsigned count        = (ctx && ctx->count) ? ctx->count : OSAL_GPIOD_MAX;
+    if (count > BOARD_LED_MAX) count = BOARD_LED_MAX;
 
-    s_chip = gpiod_chip_open_by_name(chip_name);
-    if (!s_chip) {
-        OSAL_LOG("[LED][GPIOD] open %s failed\r\n", chip_name);
-        return;
+    BoardLedPin pins[BOARD_LED_MAX];
+    for (unsigned i = 0; i < count; ++i) {
+        pins[i].chip_name = chip_name;
+        pins[i].offset    = line_base + i;
     }
+    BoardLedCfg cfg = { .pins = pins, .count = count, .active_low = 0, .consumer = "osal_led" };
+    if (BoardLed_InitCfg(&cfg) != 0)
+        OSAL_LOG("[LED][GPIOD] init failed (%s base=%u, count=%u)\r\n", chip_name, line_base, count);
+}
 
-    unsigned offs[OSAL_GPIOD_MAX];
-    for (unsigned i=0;i<s_count;i++) offs[i] = line_base + i;
-
-    // if (gpiod_line_bulk_init(&s_bulk) != 0) {
-    //     OSAL_LOG("[LED][GPIOD] bulk init failed\r\n");
-    //     return;
-    // }
-    gpiod_line_bulk_init(&s_bulk);
+unsigned BoardLed_Count(void) { return s_count; }
 
-    if (gpiod_chip_get_lines(s_chip, offs, s_count, &s_bulk) != 0) {
-        OSAL_LOG("[LED][GPIOD] get lines failed (base=%u, count=%u)\r\n", line_base, s_count);
-        return;
-    }
-    int zeros[OSAL_GPIOD_MAX]; 
-    _ints_all(zeros, 0, s_count);
-    if (gpiod_line_request_bulk_output(&s_bulk, "osal_led", zeros) != 0) {
-        OSAL_LOG("[LED][GPIOD] request output failed\r\n");
-        return;
+int BoardLed_WriteMasked(uint64_t mask, uint64_t value)
+{
+    if (!s_count) return -1;
+    mask &= _all_mask();
+
+    int rc = 0;
+    OSAL_MutexLock(s_mtx, OSAL_WAIT_FOREVER);
+    uint64_t next    = (s_state & ~mask) | (value & mask);
+    uint64_t changed = next ^ s_state;
+    for (unsigned i = 0; i < s_nchips && changed; ++i) {
+        if (!(s_chips[i].mask & changed)) continue;
+        if (_chip_commit(&s_chips[i], next) != 0) {
+            /* chip lỗi: giữ trạng thái cũ để lần ghi sau thử lại */
+            next = (next & ~s_chips[i].mask) | (s_state & s_chips[i].mask);
+            rc = -1;
+        }
     }
-    OSAL_LOG("[LED][GPIOD] ready on %s, base=%u, count=%u\r\n", chip_name, line_base, s_count);
+    s_state = next;
+    OSAL_MutexUnlock(s_mtx);
+    return rc;
 }
 
-void BoardLed_Set(uint8_t on)
+int BoardLed_Set(uint8_t on)
 {
-    if (!s_chip) return;
-    int vals[OSAL_GPIOD_MAX];
-    for (unsigned i=0;i<s_count;i++) vals[i] = on ? 1 : 0;
-    gpiod_line_set_value_bulk(&s_bulk, vals);
+    return BoardLed_WriteMasked(~0ull, on ? ~0ull : 0);
 }
 
-/* API ghi theo mặt nạ 8-bit */
-void BoardLed_WriteMask(uint8_t mask)
+/* API ghi theo mặt nạ 64-bit */
+int BoardLed_WriteMask(uint64_t mask)
 {
-    if (!s_chip) return;
-    int vals[OSAL_GPIOD_MAX];
-    _fill_vals_from_mask(vals, mask, s_count);
-
-    if (gpiod_line_set_value_bulk(&s_bulk, vals) == 0) return;
-
-    /* fallback từng line */
-    for (unsigned i = 0; i < s_count; ++i)
-        if (s_lines[i]) gpiod_line_set_value(s_lines[i], vals[i]);
+    return BoardLed_WriteMasked(~0ull, mask);
 }
 
-/* API ghi một LED theo chỉ số */
-void BoardLed_WriteOne(unsigned index, uint8_t on)
+/* API ghi một LED theo chỉ số: ghi bulk có mặt nạ trên chip chứa LED đó */
+int BoardLed_WriteOne(unsigned index, uint8_t on)
 {
-    if (!s_chip || index >= s_count) return;
-    if (s_lines[index])
-        gpiod_line_set_value(s_lines[index], on ? 1 : 0);
+    if (index >= s_count) return -1;
+    return BoardLed_WriteMasked(1ull << index, on ? (1ull << index) : 0);
 }
 
+uint64_t BoardLed_GetState(void) { return s_state; }
+
 /*
 BoardLed_Set(1);  // all ON
 // ví dụ: chỉ bật LED0, LED3, LED7
 BoardLed_WriteMask( (1u<<0) | (1u<<3) | (1u<<7) );
 BoardLed_WriteOne(3, 1);  // bật LED3
 BoardLed_WriteOne(3, 0);  // tắt LED3
-*/
\ No newline at end of file
+
+// 40 LED trên 3 chip
+static const BoardLedPin panel[40] = { {"gpiochip0", 0}, ..., {"gpiochip2", 7} };
+BoardLedCfg c = { .pins = panel, .count = 40 };
+BoardLed_InitCfg(&c);
+BoardLed_WriteMask(0xFFull << 16);   // tối đa 3 ioctl
+*/
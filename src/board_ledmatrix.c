@@ -0,0 +1,299 @@
+/**
+ * @file board_ledmatrix.c
+ * @brief Multiplexed LED matrix refresh: chained absolute deadlines per BCM
+ *        plane, lock-free triple-slot frame hand-off, wake lateness stats.
+ *
+ * Notes:
+ *  - Ba slot bitplane: task giữ `front`, producer giữ `back`, slot còn lại
+ *    là "mới nhất" nằm trong ready (bit 0..1 = slot, bit 2 = chưa lấy).
+ *    Commit: dựng back rồi xchg vào ready. Task: đầu frame nếu có bit mới
+ *    thì xchg front vào ready. Mỗi bên chỉ đụng slot của mình.
+ *  - Cột chỉ ghi line có bit đổi (col_val ^ want); đổi hàng luôn tắt cột
+ *    trước để không chớp hàng kế với dữ liệu của hàng trước.
+ *  - Thống kê do task ghi, publish bằng store atomic (như board_encoder).
+ */
+#include "board_ledmatrix.h"
+#include "osal.h"
+#include "osal_task.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LM_FRESH 4u
+
+typedef struct {
+    uint32_t plane[BOARD_LEDMATRIX_MAX_ROWS][BOARD_LEDMATRIX_MAX_BITS];
+} LmFrame;
+
+struct BoardLedMatrix {
+    BoardLedMatrixCfg cfg;
+    HAL_GpioChip*     chip;
+    HAL_GpioLine*     rows[BOARD_LEDMATRIX_MAX_ROWS];
+    HAL_GpioLine*     cols[BOARD_LEDMATRIX_MAX_COLS];
+    HAL_GpioGroup     rgrp, cgrp;
+    uint32_t          unit_us;
+    uint8_t           max_level;
+
+    /* frame hand-off */
+    LmFrame           slot[3];
+    uint8_t           ready;           /* slot mới nhất | LM_FRESH */
+    uint8_t           back;            /* producer */
+    uint8_t           front;           /* task */
+    uint8_t           level[BOARD_LEDMATRIX_MAX_ROWS][BOARD_LEDMATRIX_MAX_COLS];   /* producer */
+
+    /* task */
+    uint32_t          row_val, col_val;
+    uint64_t          t_ns;            /* deadline vừa qua (CLOCK_MONOTONIC) */
+    uint64_t          late_sum, late_n, late_max;
+    uint64_t          frames, commits, col_writes, overruns, resyncs;
+    uint64_t          win_t0_ns, win_frames;
+    int               reset_req;
+
+    /* publish */
+    uint64_t          pub_frames, pub_commits, pub_col_writes, pub_overruns, pub_resyncs;
+    uint64_t          pub_late_avg, pub_late_max, pub_refresh_mhz;
+
+    OSAL_TaskHandle   task;
+    volatile int      run;
+};
+
+static uint64_t _mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#define PUB(field_, v_) __atomic_store_n(&m->field_, (v_), __ATOMIC_RELAXED)
+#define GET(field_)     __atomic_load_n(&m->field_, __ATOMIC_RELAXED)
+
+/* --- output --- */
+
+static void _rows(BoardLedMatrix* m, uint32_t want) {
+    uint32_t diff = m->row_val ^ want;
+    if (!diff) return;
+    HAL_GpioGroup_WriteMask(&m->rgrp, diff, want);
+    m->row_val = want;
+}
+
+static void _cols(BoardLedMatrix* m, uint32_t want) {
+    uint32_t diff = m->col_val ^ want;
+    if (!diff) return;
+    HAL_GpioGroup_WriteMask(&m->cgrp, diff, want);
+    m->col_val = want;
+    m->col_writes += (uint64_t)__builtin_popcount(diff);
+}
+
+/* --- timing --- */
+
+/* ngủ tới deadline kế (m->t_ns + us), đo trễ khi thức dậy. Không bắt lại mốc
+ * từng đoạn như OSAL_TaskDelayUntilUs: plane trễ chỉ làm plane sau ngắn đi,
+ * còn tốc độ frame vẫn giữ đúng (bắt lại mốc chỉ ở đầu frame, xem MatrixTask). */
+static void _wait(BoardLedMatrix* m, uint32_t us) {
+    m->t_ns += (uint64_t)us * 1000ull;
+    struct timespec ts = { (time_t)(m->t_ns / 1000000000ull), (long)(m->t_ns % 1000000000ull) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) { }
+    uint64_t now  = _mono_ns();
+    uint64_t late = (now > m->t_ns) ? (now - m->t_ns) / 1000ull : 0;
+    m->late_sum += late;
+    m->late_n++;
+    if (late > m->late_max) m->late_max = late;
+    if (late > m->unit_us) m->overruns++;
+}
+
+static void _publish(BoardLedMatrix* m, uint64_t now) {
+    PUB(pub_frames, m->frames);
+    PUB(pub_commits, m->commits);
+    PUB(pub_col_writes, m->col_writes);
+    PUB(pub_overruns, m->overruns);
+    PUB(pub_resyncs, m->resyncs);
+    PUB(pub_late_avg, m->late_n ? m->late_sum / m->late_n : 0);
+    PUB(pub_late_max, m->late_max);
+    if (now > m->win_t0_ns && m->win_frames)
+        PUB(pub_refresh_mhz, (uint64_t)((double)m->win_frames * 1e12 / (double)(now - m->win_t0_ns)));
+}
+
+static void _reset_window(BoardLedMatrix* m, uint64_t now) {
+    m->late_sum = m->late_n = m->late_max = 0;
+    m->overruns = m->resyncs = 0;
+    m->win_t0_ns  = now;
+    m->win_frames = 0;
+}
+
+static void MatrixTask(void* arg) {
+    BoardLedMatrix* m = (BoardLedMatrix*)arg;
+    const unsigned bits = m->cfg.bcm_bits;
+    const uint64_t row_ns = ((uint64_t)m->unit_us << bits) * 1000ull;
+    m->t_ns = _mono_ns();
+    _reset_window(m, m->t_ns);
+
+    while (m->run) {
+        uint64_t now = _mono_ns();
+        if (__atomic_exchange_n(&m->reset_req, 0, __ATOMIC_ACQ_REL)) _reset_window(m, now);
+        /* trễ quá một hàng (bị preempt lâu): bắt lại mốc, không quét bù */
+        if (now > m->t_ns + row_ns) {
+            m->t_ns = now;
+            m->resyncs++;
+        }
+        if (__atomic_load_n(&m->ready, __ATOMIC_ACQUIRE) & LM_FRESH) {
+            m->front = __atomic_exchange_n(&m->ready, m->front, __ATOMIC_ACQ_REL) & 3u;
+            m->commits++;
+        }
+        const LmFrame* f = &m->slot[m->front];
+
+        for (int r = 0; r < m->cfg.nrows && m->run; ++r) {
+            _cols(m, 0);
+            _rows(m, 1u << r);
+            _wait(m, m->unit_us);                            /* blank */
+            for (int b = (int)bits - 1; b >= 0; --b) {
+                _cols(m, f->plane[r][b]);
+                _wait(m, m->unit_us << b);
+            }
+        }
+        m->frames++;
+        m->win_frames++;
+        _publish(m, _mono_ns());
+    }
+    _cols(m, 0);
+    _rows(m, 0);
+}
+
+/* --- producer --- */
+
+void BoardLedMatrix_SetPixel(BoardLedMatrix* m, int row, int col, uint8_t level) {
+    if (!m || row < 0 || row >= m->cfg.nrows || col < 0 || col >= m->cfg.ncols) return;
+    m->level[row][col] = (level > m->max_level) ? m->max_level : level;
+}
+
+void BoardLedMatrix_SetRow(BoardLedMatrix* m, int row, uint32_t bitmap, uint8_t level) {
+    if (!m || row < 0 || row >= m->cfg.nrows) return;
+    if (level > m->max_level) level = m->max_level;
+    for (int c = 0; c < m->cfg.ncols; ++c) m->level[row][c] = ((bitmap >> c) & 1u) ? level : 0;
+}
+
+void BoardLedMatrix_Clear(BoardLedMatrix* m) {
+    if (m) memset(m->level, 0, sizeof(m->level));
+}
+
+void BoardLedMatrix_Commit(BoardLedMatrix* m) {
+    if (!m) return;
+    LmFrame* f = &m->slot[m->back];
+    memset(f, 0, sizeof(*f));
+    for (int r = 0; r < m->cfg.nrows; ++r) {
+        for (int c = 0; c < m->cfg.ncols; ++c) {
+            uint8_t lv = m->level[r][c];
+            for (unsigned b = 0; lv; ++b, lv >>= 1)
+                if (lv & 1u) f->plane[r][b] |= 1u << c;
+        }
+    }
+    m->back = __atomic_exchange_n(&m->ready, (uint8_t)(m->back | LM_FRESH), __ATOMIC_ACQ_REL) & 3u;
+}
+
+/* --- stats --- */
+
+void BoardLedMatrix_GetStats(const BoardLedMatrix* m, BoardLedMatrixStats* out) {
+    if (!m || !out) return;
+    out->frames      = GET(pub_frames);
+    out->commits     = GET(pub_commits);
+    out->col_writes  = GET(pub_col_writes);
+    out->overruns    = GET(pub_overruns);
+    out->resyncs     = GET(pub_resyncs);
+    out->unit_us     = m->unit_us;
+    out->late_avg_us = (uint32_t)GET(pub_late_avg);
+    out->late_max_us = (uint32_t)GET(pub_late_max);
+    out->refresh_hz  = (double)GET(pub_refresh_mhz) / 1000.0;
+}
+
+void BoardLedMatrix_ResetStats(BoardLedMatrix* m) {
+    if (m) __atomic_store_n(&m->reset_req, 1, __ATOMIC_RELEASE);
+}
+
+/* --- lifetime --- */
+
+int BoardLedMatrix_Start(BoardLedMatrix* m, uint8_t task_prio) {
+    if (!m) return -1;
+    if (m->run) return 0;
+    m->run = 1;
+    OSAL_TaskAttr a = { .name = "LedMatrix", .stack_size = 4096, .prio = task_prio };
+    if (OSAL_TaskCreate(&m->task, MatrixTask, m, &a) != OSAL_OK) {
+        OSAL_LOG("[LEDMX] task create failed\r\n");
+        m->run = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void BoardLedMatrix_Stop(BoardLedMatrix* m) {
+    if (!m || !m->run) return;
+    m->run = 0;
+    OSAL_TaskDelete(m->task);
+    m->task = NULL;
+}
+
+int BoardLedMatrix_Open(const BoardLedMatrixCfg* cfg, BoardLedMatrix** out) {
+    if (!cfg || !out || !cfg->row_offsets || !cfg->col_offsets ||
+        !cfg->nrows || cfg->nrows > BOARD_LEDMATRIX_MAX_ROWS ||
+        !cfg->ncols || cfg->ncols > BOARD_LEDMATRIX_MAX_COLS ||
+        cfg->bcm_bits > BOARD_LEDMATRIX_MAX_BITS) return -1;
+    BoardLedMatrix* m = (BoardLedMatrix*)calloc(1, sizeof(*m));
+    if (!m) return -1;
+    m->cfg = *cfg;
+    if (!m->cfg.refresh_hz) m->cfg.refresh_hz = 200;
+    if (!m->cfg.bcm_bits)   m->cfg.bcm_bits   = 4;
+    m->max_level = (uint8_t)((1u << m->cfg.bcm_bits) - 1u);
+    /* một frame = nrows hàng x 2^bits unit */
+    m->unit_us = (uint32_t)(1000000ull / ((uint64_t)m->cfg.refresh_hz * m->cfg.nrows << m->cfg.bcm_bits));
+    if (!m->unit_us) {
+        OSAL_LOG("[LEDMX] %u Hz x %u rows x %u bits: BCM unit < 1 us\r\n",
+                 m->cfg.refresh_hz, m->cfg.nrows, m->cfg.bcm_bits);
+        free(m);
+        return -1;
+    }
+    m->ready = 0;
+    m->front = 1;
+    m->back  = 2;
+
+    HAL_GpioChipConfig cc = { .chip_name = cfg->chip_name };
+    m->chip = cfg->chip;
+    if (!m->chip && HAL_GpioChip_Open(&cc, &m->chip) != HAL_GPIO_OK) {
+        OSAL_LOG("[LEDMX] open chip %s failed\r\n", cfg->chip_name ? cfg->chip_name : "(null)");
+        free(m);
+        return -1;
+    }
+    for (int r = 0; r < cfg->nrows; ++r) {
+        HAL_GpioLineConfig lc = {
+            .offset = cfg->row_offsets[r], .dir = HAL_GPIO_DIR_OUT, .active = cfg->row_active, .initial = 0,
+        };
+        if (HAL_GpioLine_Request(m->chip, &lc, &m->rows[r]) != HAL_GPIO_OK) {
+            OSAL_LOG("[LEDMX] request row line %d failed\r\n", cfg->row_offsets[r]);
+            BoardLedMatrix_Close(m);
+            return -1;
+        }
+    }
+    for (int c = 0; c < cfg->ncols; ++c) {
+        HAL_GpioLineConfig lc = {
+            .offset = cfg->col_offsets[c], .dir = HAL_GPIO_DIR_OUT, .active = cfg->col_active, .initial = 0,
+        };
+        if (HAL_GpioLine_Request(m->chip, &lc, &m->cols[c]) != HAL_GPIO_OK) {
+            OSAL_LOG("[LEDMX] request column line %d failed\r\n", cfg->col_offsets[c]);
+            BoardLedMatrix_Close(m);
+            return -1;
+        }
+    }
+    m->rgrp = (HAL_GpioGroup){ .lines = m->rows, .count = cfg->nrows };
+    m->cgrp = (HAL_GpioGroup){ .lines = m->cols, .count = cfg->ncols };
+    if (m->unit_us < 50)
+        OSAL_LOG("[LEDMX] BCM unit %u us: cần SCHED_FIFO / PREEMPT_RT để giữ timing\r\n", m->unit_us);
+    *out = m;
+    return 0;
+}
+
+void BoardLedMatrix_Close(BoardLedMatrix* m) {
+    if (!m) return;
+    BoardLedMatrix_Stop(m);
+    for (int i = 0; i < BOARD_LEDMATRIX_MAX_COLS; ++i) HAL_GpioLine_Release(m->cols[i]);
+    for (int i = 0; i < BOARD_LEDMATRIX_MAX_ROWS; ++i) HAL_GpioLine_Release(m->rows[i]);
+    if (!m->cfg.chip) HAL_GpioChip_Close(m->chip);
+    free(m);
+}
@@ -0,0 +1,364 @@
+/**
+ * @file board_ledstrip.c
+ * @brief WS2812-class strip over SPI: compile-time symbol LUTs, SSSE3 / NEON
+ *        4-bit encoder, reset tail in-frame, two wire buffers cycled through
+ *        free/ready OSAL queues.
+ *
+ * Notes:
+ *  - px giữ màu theo thứ tự trên dây (GRB...) chưa scale; Show scale (nếu
+ *    brightness < 255) vào tmp rồi mã hoá vào wire[idx].
+ *  - Chỉ số buffer là thứ đi qua queue: free_q = buffer producer được ghi,
+ *    ready_q = buffer chờ task gửi. Buffer luôn nằm ở đúng một nơi (producer,
+ *    một trong hai queue, hoặc task) nên không cần khoá.
+ *  - Symbol 3 bit: store 4 byte rồi tiến 3 (byte thừa = 0 bị byte sau ghi
+ *    đè, byte cuối rơi vào đuôi reset vốn là 0).
+ */
+#include "board_ledstrip.h"
+#include "osal.h"
+#include "osal_queue.h"
+#include "osal_task.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <immintrin.h>
+#  define LS_SIMD_X86 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define LS_SIMD_NEON 1
+#endif
+
+#define LS_WIRE_BUFS 2
+#define LS_TASK_MS   100    /* timeout chờ frame của task (để Stop không chờ lâu) */
+
+/* --- bảng mã hoá (tính lúc compile) --- */
+
+/* 4 bit: 0 -> 1000, 1 -> 1110; một byte màu -> 4 byte, mỗi byte 2 symbol */
+#define SY4(b, k)  ((((b) >> (k)) & 1) ? 0xE : 0x8)
+#define E4(b)      { (uint8_t)(SY4(b, 7) << 4 | SY4(b, 6)), (uint8_t)(SY4(b, 5) << 4 | SY4(b, 4)), \
+                     (uint8_t)(SY4(b, 3) << 4 | SY4(b, 2)), (uint8_t)(SY4(b, 1) << 4 | SY4(b, 0)) }
+/* 3 bit: 0 -> 100, 1 -> 110; 8 symbol = 24 bit = 3 byte (+1 byte 0 cho store 4 byte) */
+#define SY3(b, k)  ((uint32_t)((((b) >> (k)) & 1) ? 6u : 4u) << (3 * (k)))
+#define V3(b)      (SY3(b, 7) | SY3(b, 6) | SY3(b, 5) | SY3(b, 4) | SY3(b, 3) | SY3(b, 2) | SY3(b, 1) | SY3(b, 0))
+#define E3(b)      { (uint8_t)(V3(b) >> 16), (uint8_t)(V3(b) >> 8), (uint8_t)V3(b), 0 }
+
+#define T4(E, n)   E(n), E((n) + 1), E((n) + 2), E((n) + 3)
+#define T16(E, n)  T4(E, n), T4(E, (n) + 4), T4(E, (n) + 8), T4(E, (n) + 12)
+#define T64(E, n)  T16(E, n), T16(E, (n) + 16), T16(E, (n) + 32), T16(E, (n) + 48)
+#define T256(E)    T64(E, 0), T64(E, 64), T64(E, 128), T64(E, 192)
+
+static const uint8_t k_enc4[256][4] = { T256(E4) };
+static const uint8_t k_enc3[256][4] = { T256(E3) };
+
+struct BoardLedStrip {
+    BoardLedStripCfg cfg;
+    HAL_SpiBus*      bus;
+    unsigned         bpl;              /* byte màu / LED */
+    size_t           data_len;         /* count * bpl */
+    size_t           wire_len;         /* byte SPI / frame gồm đuôi reset */
+    size_t           max_msg;
+    int              simd;
+    uint8_t          scale[256];
+    uint8_t          brightness;
+
+    uint8_t*         px;               /* producer */
+    uint8_t*         tmp;
+    uint8_t*         wire[LS_WIRE_BUFS];
+    OSAL_QueueHandle free_q, ready_q;
+
+    uint64_t         frames, messages, tx_errors;
+    uint32_t         encode_ns, tx_us;
+    int              warned;
+
+    OSAL_TaskHandle  task;
+    volatile int     run;
+};
+
+static uint64_t _mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* --- encoders --- */
+
+static void _enc3(uint8_t* d, const uint8_t* s, size_t n) {
+    for (size_t i = 0; i < n; ++i, d += 3) memcpy(d, k_enc3[s[i]], 4);
+}
+
+static void _enc4(uint8_t* d, const uint8_t* s, size_t n) {
+    for (size_t i = 0; i < n; ++i, d += 4) memcpy(d, k_enc4[s[i]], 4);
+}
+
+/* Một nibble (b3..b0) -> 2 byte SPI: byte đầu từ cặp bit cao, byte sau từ cặp thấp.
+ * k_pair[p] = symbol của 2 bit p; k_nib_hi[n] = k_pair[n >> 2], k_nib_lo[n] = k_pair[n & 3]. */
+#if LS_SIMD_X86 || LS_SIMD_NEON
+static const uint8_t k_nib_hi[16] = { 0x88, 0x88, 0x88, 0x88, 0x8E, 0x8E, 0x8E, 0x8E,
+                                      0xE8, 0xE8, 0xE8, 0xE8, 0xEE, 0xEE, 0xEE, 0xEE };
+static const uint8_t k_nib_lo[16] = { 0x88, 0x8E, 0xE8, 0xEE, 0x88, 0x8E, 0xE8, 0xEE,
+                                      0x88, 0x8E, 0xE8, 0xEE, 0x88, 0x8E, 0xE8, 0xEE };
+#endif
+
+#if LS_SIMD_X86
+/* 16 byte màu / vòng: 4 pshufb (byte 0..3 của mỗi output) rồi xen kẽ bằng unpack */
+__attribute__((target("ssse3")))
+static void _enc4_simd(uint8_t* d, const uint8_t* s, size_t n) {
+    const __m128i th = _mm_loadu_si128((const __m128i*)k_nib_hi);
+    const __m128i tl = _mm_loadu_si128((const __m128i*)k_nib_lo);
+    const __m128i m4 = _mm_set1_epi8(0x0F);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16, d += 64) {
+        __m128i x  = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), m4);
+        __m128i lo = _mm_and_si128(x, m4);
+        __m128i b0 = _mm_shuffle_epi8(th, hi), b1 = _mm_shuffle_epi8(tl, hi);
+        __m128i b2 = _mm_shuffle_epi8(th, lo), b3 = _mm_shuffle_epi8(tl, lo);
+        __m128i p01l = _mm_unpacklo_epi8(b0, b1), p01h = _mm_unpackhi_epi8(b0, b1);
+        __m128i p23l = _mm_unpacklo_epi8(b2, b3), p23h = _mm_unpackhi_epi8(b2, b3);
+        _mm_storeu_si128((__m128i*)(d +  0), _mm_unpacklo_epi16(p01l, p23l));
+        _mm_storeu_si128((__m128i*)(d + 16), _mm_unpackhi_epi16(p01l, p23l));
+        _mm_storeu_si128((__m128i*)(d + 32), _mm_unpacklo_epi16(p01h, p23h));
+        _mm_storeu_si128((__m128i*)(d + 48), _mm_unpackhi_epi16(p01h, p23h));
+    }
+    _enc4(d, s + i, n - i);
+}
+
+static int _simd_available(void) {
+    return __builtin_cpu_supports("ssse3");
+}
+#elif LS_SIMD_NEON
+/* 16 byte màu / vòng: 4 tbl, vst4 tự xen kẽ byte 0..3 của mỗi output */
+static void _enc4_simd(uint8_t* d, const uint8_t* s, size_t n) {
+    const uint8x16_t th = vld1q_u8(k_nib_hi);
+    const uint8x16_t tl = vld1q_u8(k_nib_lo);
+    const uint8x16_t m4 = vdupq_n_u8(0x0F);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16, d += 64) {
+        uint8x16_t x  = vld1q_u8(s + i);
+        uint8x16_t hi = vshrq_n_u8(x, 4);
+        uint8x16_t lo = vandq_u8(x, m4);
+        uint8x16x4_t o = { { vqtbl1q_u8(th, hi), vqtbl1q_u8(tl, hi), vqtbl1q_u8(th, lo), vqtbl1q_u8(tl, lo) } };
+        vst4q_u8(d, o);
+    }
+    _enc4(d, s + i, n - i);
+}
+
+static int _simd_available(void) {
+    return 1;
+}
+#else
+static void _enc4_simd(uint8_t* d, const uint8_t* s, size_t n) {
+    _enc4(d, s, n);
+}
+
+static int _simd_available(void) {
+    return 0;
+}
+#endif
+
+static void _encode(BoardLedStrip* s, uint8_t* dst) {
+    const uint8_t* src = s->px;
+    if (s->brightness != 255) {
+        for (size_t i = 0; i < s->data_len; ++i) s->tmp[i] = s->scale[s->px[i]];
+        src = s->tmp;
+    }
+    if (s->cfg.sym_bits == 3) _enc3(dst, src, s->data_len);
+    else if (s->simd)         _enc4_simd(dst, src, s->data_len);
+    else                      _enc4(dst, src, s->data_len);
+}
+
+/* --- wire --- */
+
+static int _send(BoardLedStrip* s, const uint8_t* buf) {
+    uint64_t t0 = _mono_ns();
+    size_t len  = s->wire_len;
+    size_t step = (s->max_msg && s->max_msg < len) ? s->max_msg : len;
+    int rc = 0;
+    for (size_t off = 0; off < len; off += step) {
+        size_t n = (len - off < step) ? len - off : step;
+        HAL_SpiStatus st = (off + n < len) ? HAL_Spi_BurstTransfer(s->bus, buf + off, NULL, n, 1)
+                                           : HAL_Spi_Transfer(s->bus, buf + off, NULL, n);
+        __atomic_add_fetch(&s->messages, 1, __ATOMIC_RELAXED);
+        if (st != HAL_SPI_OK) {
+            __atomic_add_fetch(&s->tx_errors, 1, __ATOMIC_RELAXED);
+            rc = -1;
+            break;
+        }
+    }
+    __atomic_store_n(&s->tx_us, (uint32_t)((_mono_ns() - t0) / 1000ull), __ATOMIC_RELAXED);
+    if (!rc) __atomic_add_fetch(&s->frames, 1, __ATOMIC_RELAXED);
+    return rc;
+}
+
+static void StripTask(void* arg) {
+    BoardLedStrip* s = (BoardLedStrip*)arg;
+    while (s->run) {
+        uint8_t idx;
+        if (OSAL_QueueReceive(s->ready_q, &idx, LS_TASK_MS) != OSAL_OK) continue;
+        (void)_send(s, s->wire[idx]);
+        OSAL_QueueSend(s->free_q, &idx, OSAL_WAIT_FOREVER);
+    }
+}
+
+/* --- producer --- */
+
+void BoardLedStrip_SetPixel(BoardLedStrip* s, uint32_t i, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    if (!s || i >= s->cfg.count) return;
+    uint8_t* p = s->px + (size_t)i * s->bpl;
+    switch (s->cfg.order) {
+    case BOARD_LEDSTRIP_RGB:  p[0] = r; p[1] = g; p[2] = b; break;
+    case BOARD_LEDSTRIP_BRG:  p[0] = b; p[1] = r; p[2] = g; break;
+    case BOARD_LEDSTRIP_GRBW: p[0] = g; p[1] = r; p[2] = b; p[3] = w; break;
+    default:                  p[0] = g; p[1] = r; p[2] = b; break;
+    }
+}
+
+void BoardLedStrip_Fill(BoardLedStrip* s, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    if (!s || !s->cfg.count) return;
+    BoardLedStrip_SetPixel(s, 0, r, g, b, w);
+    for (uint32_t i = 1; i < s->cfg.count; ++i) memcpy(s->px + (size_t)i * s->bpl, s->px, s->bpl);
+}
+
+void BoardLedStrip_SetBrightness(BoardLedStrip* s, uint8_t level) {
+    if (!s) return;
+    s->brightness = level;
+    for (unsigned v = 0; v < 256; ++v) s->scale[v] = (uint8_t)((v * level + 127u) / 255u);
+}
+
+int BoardLedStrip_Show(BoardLedStrip* s) {
+    if (!s) return -1;
+    uint8_t idx;
+    if (OSAL_QueueReceive(s->free_q, &idx, OSAL_WAIT_FOREVER) != OSAL_OK) return -1;
+    uint64_t t0 = _mono_ns();
+    _encode(s, s->wire[idx]);
+    __atomic_store_n(&s->encode_ns, (uint32_t)(_mono_ns() - t0), __ATOMIC_RELAXED);
+
+    if (s->run) {
+        OSAL_QueueSend(s->ready_q, &idx, OSAL_WAIT_FOREVER);
+        return 0;
+    }
+    int rc = _send(s, s->wire[idx]);
+    OSAL_QueueSend(s->free_q, &idx, OSAL_WAIT_FOREVER);
+    if (rc && !s->warned) {
+        s->warned = 1;
+        OSAL_LOG("[LEDSTRIP] SPI transfer failed (frame %u byte, max message %u)\r\n",
+                 (unsigned)s->wire_len, (unsigned)s->max_msg);
+    }
+    return rc;
+}
+
+void BoardLedStrip_Flush(BoardLedStrip* s) {
+    if (!s) return;
+    uint8_t idx[LS_WIRE_BUFS];
+    for (int i = 0; i < LS_WIRE_BUFS; ++i) OSAL_QueueReceive(s->free_q, &idx[i], OSAL_WAIT_FOREVER);
+    for (int i = 0; i < LS_WIRE_BUFS; ++i) OSAL_QueueSend(s->free_q, &idx[i], OSAL_WAIT_FOREVER);
+}
+
+uint32_t BoardLedStrip_Count(const BoardLedStrip* s) {
+    return s ? s->cfg.count : 0;
+}
+
+void BoardLedStrip_GetStats(const BoardLedStrip* s, BoardLedStripStats* out) {
+    if (!s || !out) return;
+    out->frames      = __atomic_load_n(&s->frames, __ATOMIC_RELAXED);
+    out->messages    = __atomic_load_n(&s->messages, __ATOMIC_RELAXED);
+    out->tx_errors   = __atomic_load_n(&s->tx_errors, __ATOMIC_RELAXED);
+    out->frame_bytes = (uint32_t)s->wire_len;
+    out->max_message = (uint32_t)s->max_msg;
+    out->encode_ns   = __atomic_load_n(&s->encode_ns, __ATOMIC_RELAXED);
+    out->tx_us       = __atomic_load_n(&s->tx_us, __ATOMIC_RELAXED);
+    out->simd        = (uint8_t)s->simd;
+}
+
+/* --- lifetime --- */
+
+int BoardLedStrip_Start(BoardLedStrip* s, uint8_t task_prio) {
+    if (!s) return -1;
+    if (s->run) return 0;
+    s->run = 1;
+    OSAL_TaskAttr a = { .name = "LedStrip", .stack_size = 4096, .prio = task_prio };
+    if (OSAL_TaskCreate(&s->task, StripTask, s, &a) != OSAL_OK) {
+        OSAL_LOG("[LEDSTRIP] task create failed\r\n");
+        s->run = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void BoardLedStrip_Stop(BoardLedStrip* s) {
+    if (!s || !s->run) return;
+    BoardLedStrip_Flush(s);
+    s->run = 0;
+    OSAL_TaskDelete(s->task);
+    s->task = NULL;
+}
+
+int BoardLedStrip_Open(const BoardLedStripCfg* cfg, BoardLedStrip** out) {
+    if (!cfg || !out || !cfg->count || (!cfg->bus && !cfg->spi_dev) ||
+        (cfg->sym_bits && cfg->sym_bits != 3 && cfg->sym_bits != 4) ||
+        cfg->order > BOARD_LEDSTRIP_GRBW) return -1;
+    BoardLedStrip* s = (BoardLedStrip*)calloc(1, sizeof(*s));
+    if (!s) return -1;
+    s->cfg = *cfg;
+    if (!s->cfg.sym_bits)   s->cfg.sym_bits   = 4;
+    if (!s->cfg.reset_us)   s->cfg.reset_us   = 300;
+    if (!s->cfg.brightness) s->cfg.brightness = 255;
+    s->bpl      = (s->cfg.order == BOARD_LEDSTRIP_GRBW) ? 4u : 3u;
+    s->data_len = (size_t)s->cfg.count * s->bpl;
+    s->simd     = (s->cfg.sym_bits == 4 && !s->cfg.no_simd && _simd_available());
+    BoardLedStrip_SetBrightness(s, s->cfg.brightness);
+
+    /* 800 kHz bit LED x sym_bits symbol / bit */
+    uint32_t hz   = 800000u * s->cfg.sym_bits;
+    size_t   tail = ((size_t)s->cfg.reset_us * hz + 7999999u) / 8000000u;
+    s->wire_len   = s->data_len * s->cfg.sym_bits + (tail ? tail : 1);
+
+    s->px  = (uint8_t*)calloc(1, s->data_len);
+    s->tmp = (uint8_t*)malloc(s->data_len);
+    for (int i = 0; i < LS_WIRE_BUFS; ++i) s->wire[i] = (uint8_t*)calloc(1, s->wire_len + 4);
+    if (!s->px || !s->tmp || !s->wire[0] || !s->wire[1] ||
+        OSAL_QueueCreate(&s->free_q, 1, LS_WIRE_BUFS) != OSAL_OK ||
+        OSAL_QueueCreate(&s->ready_q, 1, LS_WIRE_BUFS) != OSAL_OK) {
+        BoardLedStrip_Close(s);
+        return -1;
+    }
+    for (uint8_t i = 0; i < LS_WIRE_BUFS; ++i) OSAL_QueueSend(s->free_q, &i, 0);
+
+    s->bus = cfg->bus;
+    if (s->bus) {
+        if (HAL_Spi_SetSpeed(s->bus, hz) != HAL_SPI_OK) {
+            BoardLedStrip_Close(s);
+            return -1;
+        }
+    } else {
+        HAL_SpiConfig sc = { .dev_name = cfg->spi_dev, .mode = HAL_SPI_MODE0, .max_speed_hz = hz, .bits_per_word = 8 };
+        HAL_SpiStatus st = HAL_SPI_EBUS;
+        s->bus = HAL_Spi_Open(&sc, &st);
+        if (!s->bus) {
+            OSAL_LOG("[LEDSTRIP] open %s failed (%d)\r\n", cfg->spi_dev, (int)st);
+            BoardLedStrip_Close(s);
+            return -1;
+        }
+    }
+    s->max_msg = HAL_Spi_MaxMessage(s->bus);
+    if (s->max_msg && s->wire_len > s->max_msg)
+        OSAL_LOG("[LEDSTRIP] frame %u byte > spidev bufsiz %u: chia %u message, nên tăng spidev.bufsiz\r\n",
+                 (unsigned)s->wire_len, (unsigned)s->max_msg,
+                 (unsigned)((s->wire_len + s->max_msg - 1) / s->max_msg));
+    *out = s;
+    return 0;
+}
+
+void BoardLedStrip_Close(BoardLedStrip* s) {
+    if (!s) return;
+    BoardLedStrip_Stop(s);
+    if (s->bus && !s->cfg.bus) HAL_Spi_Close(s->bus);
+    if (s->ready_q) OSAL_QueueDelete(s->ready_q);
+    if (s->free_q)  OSAL_QueueDelete(s->free_q);
+    for (int i = 0; i < LS_WIRE_BUFS; ++i) free(s->wire[i]);
+    free(s->tmp);
+    free(s->px);
+    free(s);
+}
@@ -0,0 +1,318 @@
+/**
+ * @file board_tacho.c
+ * @brief Tacho / flow meter service: one task, batched edge events, fixed
+ *        ring + running sums per channel, seqlock-published results.
+ *
+ * Notes:
+ *  - Tổng chạy lưu theo độ lệch so với mốc K (period trung bình lúc chuẩn
+ *    hoá gần nhất): Σ(p-K), Σ(p-K)². Phương sai = (Σd² - (Σd)²/n) / n không
+ *    bị triệt tiêu số khi jitter nhỏ hơn period hàng triệu lần.
+ *  - Mỗi BOARD_TACHO_RING mẫu, tổng được tính lại từ ring (O(RING) mỗi RING
+ *    mẫu = O(1) trung bình) để sai số cộng/trừ số thực không tích luỹ.
+ *  - Add() chạy được khi task đang chạy: slot được điền xong rồi mới bật cờ
+ *    active (store release), task đọc cờ bằng load acquire.
+ */
+#include "board_tacho.h"
+#include "osal.h"
+#include "osal_task.h"
+#include "osal_mutex.h"
+
+#include <errno.h>
+#include <math.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define TACHO_EV_BATCH 64
+
+typedef struct {
+    int              active;        /* store release sau khi slot sẵn sàng */
+    BoardTachoSpec   spec;
+    char             name[24];
+    HAL_GpioChip*    chip;
+    int              own_chip;
+    HAL_GpioLine*    line;
+    int              fd;
+
+    /* chỉ thread đo */
+    uint64_t         t[BOARD_TACHO_RING];      /* timestamp cạnh lên kết thúc chu kỳ */
+    uint64_t         per[BOARD_TACHO_RING];
+    uint64_t         high[BOARD_TACHO_RING];   /* 0 = không biết (thiếu cạnh xuống) */
+    unsigned         head, n;
+    double           k;                        /* mốc của tổng lệch */
+    double           sd, sd2;                  /* Σ(p-K), Σ(p-K)² */
+    double           sh, shp;                  /* Σhigh, Σperiod của chu kỳ có high */
+    unsigned         since_rebase;
+    uint64_t         last_rise, last_fall, edges;
+
+    /* seqlock: lẻ = đang ghi */
+    uint32_t         seq;
+    BoardTachoResult pub;
+} TachoChan;
+
+static TachoChan        s_ch[BOARD_TACHO_MAX];
+static int              s_nch = 0;           /* slot cao nhất đã dùng + 1 */
+static BoardTachoCfg    s_cfg;
+static int              s_init = 0;
+static OSAL_MutexHandle s_mtx  = NULL;
+static OSAL_TaskHandle  s_task = NULL;
+static volatile int     s_run  = 0;
+
+static uint64_t _mono_ns(void* ctx) {
+    (void)ctx;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* --- ring + tổng chạy --- */
+
+static void _rebase(TachoChan* c) {
+    double sum = 0.0;
+    for (unsigned i = 0; i < c->n; ++i) sum += (double)c->per[(c->head + i) % BOARD_TACHO_RING];
+    c->k  = c->n ? sum / c->n : 0.0;
+    c->sd = c->sd2 = c->sh = c->shp = 0.0;
+    for (unsigned i = 0; i < c->n; ++i) {
+        unsigned j = (c->head + i) % BOARD_TACHO_RING;
+        double d = (double)c->per[j] - c->k;
+        c->sd  += d;
+        c->sd2 += d * d;
+        if (c->high[j]) { c->sh += (double)c->high[j]; c->shp += (double)c->per[j]; }
+    }
+    c->since_rebase = 0;
+}
+
+static void _pop(TachoChan* c) {
+    unsigned j = c->head;
+    double d = (double)c->per[j] - c->k;
+    c->sd  -= d;
+    c->sd2 -= d * d;
+    if (c->high[j]) { c->sh -= (double)c->high[j]; c->shp -= (double)c->per[j]; }
+    c->head = (c->head + 1u) % BOARD_TACHO_RING;
+    if (--c->n == 0) c->sd = c->sd2 = c->sh = c->shp = 0.0;
+}
+
+static void _push(TachoChan* c, uint64_t t, uint64_t per, uint64_t high) {
+    if (c->n == BOARD_TACHO_RING) _pop(c);
+    if (c->n == 0) c->k = (double)per;
+    unsigned j = (c->head + c->n) % BOARD_TACHO_RING;
+    c->t[j] = t; c->per[j] = per; c->high[j] = high;
+    c->n++;
+    double d = (double)per - c->k;
+    c->sd  += d;
+    c->sd2 += d * d;
+    if (high) { c->sh += (double)high; c->shp += (double)per; }
+    if (++c->since_rebase >= BOARD_TACHO_RING) _rebase(c);
+}
+
+static void _on_event(TachoChan* c, const HAL_GpioEvent* ev) {
+    if (ev->edge == HAL_GPIO_EDGE_FALLING) {
+        c->last_fall = ev->timestamp_ns;
+        return;
+    }
+    if (ev->edge != HAL_GPIO_EDGE_RISING || !ev->timestamp_ns) return;
+    c->edges++;
+    if (c->last_rise && ev->timestamp_ns > c->last_rise) {
+        uint64_t high = (c->last_fall > c->last_rise && c->last_fall < ev->timestamp_ns)
+                      ? c->last_fall - c->last_rise : 0;
+        _push(c, ev->timestamp_ns, ev->timestamp_ns - c->last_rise, high);
+    }
+    c->last_rise = ev->timestamp_ns;
+}
+
+/* bỏ mẫu ra khỏi cửa sổ thời gian; stall thì bỏ hết */
+static int _expire(TachoChan* c, uint64_t now) {
+    uint64_t stall = (uint64_t)c->spec.stall_ms * 1000000ull;
+    if (!c->last_rise || now > c->last_rise + stall) {
+        while (c->n) _pop(c);
+        return 1;
+    }
+    uint64_t win = (uint64_t)c->spec.window_ms * 1000000ull;
+    while (c->n && c->t[c->head] + win < now) _pop(c);
+    return 0;
+}
+
+static void _publish(TachoChan* c, int stalled) {
+    BoardTachoResult r;
+    memset(&r, 0, sizeof(r));
+    r.edges        = c->edges;
+    r.samples      = c->n;
+    r.stalled      = (uint8_t)stalled;
+    r.last_edge_ns = c->last_rise;
+    if (c->n) {
+        double mean = c->k + c->sd / c->n;
+        double var  = (c->sd2 - c->sd * c->sd / c->n) / c->n;
+        r.period_ns = mean;
+        r.freq_hz   = (mean > 0.0) ? 1e9 / mean : 0.0;
+        r.jitter_ns = (var > 0.0) ? sqrt(var) : 0.0;
+        r.duty_pct  = (c->shp > 0.0) ? 100.0 * c->sh / c->shp : 0.0;
+        r.value     = r.freq_hz * c->spec.scale;
+        /* từ cạnh lên mở đầu mẫu cũ nhất tới cạnh lên cuối */
+        unsigned last = (c->head + c->n - 1u) % BOARD_TACHO_RING;
+        r.window_ns = c->t[last] - (c->t[c->head] - c->per[c->head]);
+    }
+    uint32_t s = c->seq;
+    __atomic_store_n(&c->seq, s + 1u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    c->pub = r;
+    __atomic_store_n(&c->seq, s + 2u, __ATOMIC_RELEASE);
+}
+
+/* --- vòng đo --- */
+
+int BoardTacho_Poll(int timeout_ms) {
+    if (!s_init) return -1;
+    struct pollfd pfd[BOARD_TACHO_MAX];
+    int nfd = 0, nofd = 0;
+    int nch = __atomic_load_n(&s_nch, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < nch; ++i) {
+        TachoChan* c = &s_ch[i];
+        if (!__atomic_load_n(&c->active, __ATOMIC_ACQUIRE)) continue;
+        if (c->fd >= 0) { pfd[nfd].fd = c->fd; pfd[nfd].events = POLLIN; ++nfd; }
+        else            ++nofd;
+    }
+    /* kênh không có fd (sim): chờ tối đa 1 ms rồi đọc không chặn */
+    if (nofd && (timeout_ms < 0 || timeout_ms > 1)) timeout_ms = 1;
+    if (timeout_ms != 0 && poll(nfd ? pfd : NULL, (nfds_t)nfd, timeout_ms) < 0 && errno != EINTR) return -1;
+
+    uint64_t now = s_cfg.now_ns(s_cfg.now_ctx);
+    int total = 0;
+    for (int i = 0; i < nch; ++i) {
+        TachoChan* c = &s_ch[i];
+        if (!__atomic_load_n(&c->active, __ATOMIC_ACQUIRE)) continue;
+        HAL_GpioEvent evs[TACHO_EV_BATCH];
+        size_t n = 0;
+        while (HAL_GpioLine_ReadEvents(c->line, 0, evs, TACHO_EV_BATCH, &n) == HAL_GPIO_OK) {
+            for (size_t k = 0; k < n; ++k) _on_event(c, &evs[k]);
+            total += (int)n;
+            if (n < TACHO_EV_BATCH) break;
+        }
+        _publish(c, _expire(c, now));
+    }
+    return total;
+}
+
+/* --- reader --- */
+
+int BoardTacho_Get(int id, BoardTachoResult* out) {
+    if (id < 0 || id >= BOARD_TACHO_MAX || !out) return -1;
+    TachoChan* c = &s_ch[id];
+    if (!__atomic_load_n(&c->active, __ATOMIC_ACQUIRE)) return -1;
+    for (;;) {
+        uint32_t s1 = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1u) continue;
+        *out = c->pub;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&c->seq, __ATOMIC_RELAXED) == s1) return 0;
+    }
+}
+
+const char* BoardTacho_Name(int id) {
+    if (id < 0 || id >= BOARD_TACHO_MAX || !__atomic_load_n(&s_ch[id].active, __ATOMIC_ACQUIRE)) return NULL;
+    return s_ch[id].name;
+}
+
+/* --- kênh --- */
+
+int BoardTacho_Add(const BoardTachoSpec* spec) {
+    if (!s_init || !spec || spec->offset < 0) return -1;
+    OSAL_MutexLock(s_mtx, OSAL_WAIT_FOREVER);
+    int id = -1;
+    for (int i = 0; i < BOARD_TACHO_MAX; ++i) {
+        if (!s_ch[i].active && !s_ch[i].line) { id = i; break; }
+    }
+    if (id < 0) {
+        OSAL_MutexUnlock(s_mtx);
+        OSAL_LOG("[TACHO] no free channel\r\n");
+        return -1;
+    }
+    TachoChan* c = &s_ch[id];
+    memset(c, 0, sizeof(*c));
+    c->spec = *spec;
+    if (!c->spec.window_ms) c->spec.window_ms = 1000;
+    if (!c->spec.stall_ms)  c->spec.stall_ms  = 2u * c->spec.window_ms;
+    if (c->spec.scale == 0.0) c->spec.scale   = 1.0;
+    snprintf(c->name, sizeof(c->name), "%s", spec->name ? spec->name : "tacho");
+    c->spec.name = c->name;
+
+    c->chip = spec->chip;
+    if (!c->chip) {
+        HAL_GpioChipConfig cc = { .chip_name = spec->chip_name };
+        if (HAL_GpioChip_Open(&cc, &c->chip) != HAL_GPIO_OK) c->chip = NULL;
+        c->own_chip = 1;
+    }
+    HAL_GpioLineConfig lc = {
+        .offset = spec->offset, .dir = HAL_GPIO_DIR_IN, .active = spec->active,
+        .bias = spec->bias, .edge = HAL_GPIO_EDGE_BOTH,
+    };
+    if (!c->chip || HAL_GpioLine_Request(c->chip, &lc, &c->line) != HAL_GPIO_OK) {
+        OSAL_LOG("[TACHO] %s: request line %d failed\r\n", c->name, spec->offset);
+        if (c->own_chip) HAL_GpioChip_Close(c->chip);
+        memset(c, 0, sizeof(*c));
+        OSAL_MutexUnlock(s_mtx);
+        return -1;
+    }
+    c->fd = HAL_GpioLine_GetEventFd(c->line);
+    if (id >= s_nch) __atomic_store_n(&s_nch, id + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&c->active, 1, __ATOMIC_RELEASE);
+    OSAL_MutexUnlock(s_mtx);
+    return id;
+}
+
+/* --- lifetime --- */
+
+static void TachoTask(void* arg) {
+    (void)arg;
+    while (s_run) {
+        if (BoardTacho_Poll((int)s_cfg.idle_ms) < 0) OSAL_TaskDelayMs(10);
+    }
+}
+
+int BoardTacho_Init(const BoardTachoCfg* cfg, int no_task) {
+    if (s_init) return 0;
+    memset(&s_cfg, 0, sizeof(s_cfg));
+    if (cfg) s_cfg = *cfg;
+    if (!s_cfg.idle_ms)   s_cfg.idle_ms   = 50;
+    if (!s_cfg.task_prio) s_cfg.task_prio = 20;
+    if (!s_cfg.now_ns)    s_cfg.now_ns    = _mono_ns;
+
+    if (!s_mtx && OSAL_MutexCreate(&s_mtx) != OSAL_OK) {
+        OSAL_LOG("[TACHO] mutex create failed\r\n");
+        return -1;
+    }
+    s_init = 1;
+    if (no_task) return 0;
+
+    s_run = 1;
+    OSAL_TaskAttr a = { .name = "Tacho", .stack_size = 4096, .prio = s_cfg.task_prio };
+    if (OSAL_TaskCreate(&s_task, TachoTask, NULL, &a) != OSAL_OK) {
+        OSAL_LOG("[TACHO] task create failed\r\n");
+        s_run  = 0;
+        s_init = 0;
+        return -1;
+    }
+    return 0;
+}
+
+int BoardTacho_Start(const BoardTachoCfg* cfg) {
+    return BoardTacho_Init(cfg, 0);
+}
+
+void BoardTacho_Stop(void) {
+    if (!s_init) return;
+    if (s_run) {
+        s_run = 0;
+        OSAL_TaskDelete(s_task);
+        s_task = NULL;
+    }
+    for (int i = 0; i < BOARD_TACHO_MAX; ++i) {
+        TachoChan* c = &s_ch[i];
+        __atomic_store_n(&c->active, 0, __ATOMIC_RELEASE);
+        if (c->line) HAL_GpioLine_Release(c->line);
+        if (c->own_chip) HAL_GpioChip_Close(c->chip);
+        memset(c, 0, sizeof(*c));
+    }
+    s_nch  = 0;
+    s_init = 0;
+}
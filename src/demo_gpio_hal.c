@@ -1,7 +1,16 @@
 /**
  * @file demo_gpio_hal.c
  * @brief Demo: BTN0 increments LED counter (up to 255), BTN1 resets.
- * Uses generalized HAL GPIO (line-based). Polling with soft debounce.
+ * Uses generalized HAL GPIO (line-based).
+ *
+ * Modes:
+ *  - Event (mặc định): nút request với HAL_GPIO_EDGE_BOTH, task ngủ trong
+ *    poll() trên event fd của 2 nút (+ eventfd để Stop). Debounce kiểu
+ *    "settle window": mỗi cạnh dời hạn chót = t_cạnh + debounce_ms; hết hạn
+ *    mà không có cạnh mới thì đọc mức ổn định. CPU idle = 0, trễ nhấn->LED
+ *    = đúng cửa sổ debounce.
+ *  - Polling 5 ms: khi backend không có event (sim, edge request lỗi) hoặc
+ *    cfg->poll_only = 1.
  */
 #include "demo_gpio_hal.h"
 #include "osal.h"
@@ -9,6 +18,11 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
 
 static HAL_GpioChip*   s_chip    = NULL;
 static HAL_GpioLine*   s_leds[8] = {0};
@@ -19,6 +33,9 @@ static HAL_GpioLine*   s_btn1    = NULL;
 static volatile int    s_run     = 0;
 static OSAL_TaskHandle s_task    = NULL;
 static unsigned        s_count   = 0;  // 0..255
+static int             s_use_events = 0;
+static int             s_wake_fd = -1; // eventfd: Stop() đánh thức task đang poll()
+static int             s_borrowed = 0; // line do caller mở (board): không release
 
 static void _leds_show8(unsigned val) {
     for (int i = 0; i < s_led_n; ++i) {
@@ -26,11 +43,43 @@ static void _leds_show8(unsigned val) {
     }
 }
 
-static void GpioTask(void* arg) {
-    (void)arg;
+/* Release whatever has been requested so far (safe on partial bring-up). */
+static void _release_all(void) {
+    for (int i = 0; i < 8; ++i) {
+        if (s_leds[i] && !s_borrowed) HAL_GpioLine_Release(s_leds[i]);
+        s_leds[i] = NULL;
+    }
+    s_led_n = 0;
+
+    if (s_btn0 && !s_borrowed) HAL_GpioLine_Release(s_btn0);
+    if (s_btn1 && !s_borrowed) HAL_GpioLine_Release(s_btn1);
+    s_btn0 = s_btn1 = NULL;
+    s_borrowed = 0;
+
+    if (s_chip) { HAL_GpioChip_Close(s_chip); s_chip = NULL; }
+
+    if (s_wake_fd >= 0) { close(s_wake_fd); s_wake_fd = -1; }
+}
+
+static uint64_t _now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void _on_press(int btn) {
+    if (btn == 0) {
+        if (s_count < 255) s_count++;
+        OSAL_LOG("[GPIO][BTN0] ++ -> %u\r\n", s_count);
+    } else {
+        s_count = 0;
+        OSAL_LOG("[GPIO][BTN1] reset -> %u\r\n", s_count);
+    }
+    _leds_show8(s_count);
+}
 
+static void _task_poll(int debounce_ms) {
     const int step_ms = 5;
-    const int debounce_ms = ((const DemoGpioCfg*)arg)->debounce_ms > 0 ? ((const DemoGpioCfg*)arg)->debounce_ms : 5;
 
     int last0 = 0, last1 = 0;
     int stable0 = 0, stable1 = 0;
@@ -55,16 +104,8 @@ static void GpioTask(void* arg) {
         int rising0 = (stable0 && !prev0);
         int rising1 = (stable1 && !prev1);
 
-        if (rising0) {
-            if (s_count < 255) s_count++;
-            OSAL_LOG("[GPIO][BTN0] ++ -> %u\r\n", s_count);
-            _leds_show8(s_count);
-        }
-        if (rising1) {
-            s_count = 0;
-            OSAL_LOG("[GPIO][BTN1] reset -> %u\r\n", s_count);
-            _leds_show8(s_count);
-        }
+        if (rising0) _on_press(0);
+        if (rising1) _on_press(1);
 
         prev0 = stable0;
         prev1 = stable1;
@@ -73,19 +114,146 @@ static void GpioTask(void* arg) {
 
         OSAL_TaskDelayMs(step_ms);
     }
+}
+
+/*
+ * Timestamp của event: libgpiod v1 trên kernel >= 5.7 dùng CLOCK_MONOTONIC,
+ * kernel cũ dùng REALTIME. Nếu lệch quá 1 s so với monotonic thì dùng thời
+ * điểm nhận event thay thế.
+ */
+static uint64_t _evt_time_ns(const HAL_GpioEvent* ev, uint64_t now) {
+    uint64_t t = ev->timestamp_ns;
+    if (t == 0 || t > now || now - t > 1000000000ull) return now;
+    return t;
+}
+
+/* ---- settle window (event mode) ---- */
+
+void DemoGpio_SettleInit(DemoGpioSettle* b, HAL_GpioLine* line) {
+    memset(b, 0, sizeof(*b));
+    b->line = line;
+    HAL_GpioLine_Read(line, &b->stable);  /* mức ban đầu, không tính là nhấn */
+}
+
+int DemoGpio_SettleStep(DemoGpioSettle* b, uint64_t now_ns, uint64_t window_ns, int drain) {
+    if (drain) {
+        HAL_GpioEvent ev;
+        /* rút hết event đang chờ; cạnh cuối quyết định hạn settle */
+        while (HAL_GpioLine_WaitEvent(b->line, 0, &ev) == HAL_GPIO_OK) {
+            b->settle_at_ns = _evt_time_ns(&ev, now_ns) + window_ns;
+            b->pending = 1;
+            b->edges++;
+        }
+    }
+    if (!b->pending || now_ns < b->settle_at_ns) return 0;
+
+    int v = b->stable;
+    b->pending = 0;
+    b->settles++;
+    if (HAL_GpioLine_Read(b->line, &v) != HAL_GPIO_OK || v == b->stable) return 0;
+    b->stable = v;
+    return 1;
+}
+
+int DemoGpio_SettleTimeoutMs(const DemoGpioSettle* b, uint64_t now_ns) {
+    if (!b->pending) return -1;
+    uint64_t left = (b->settle_at_ns > now_ns) ? b->settle_at_ns - now_ns : 0;
+    return (int)((left + 999999ull) / 1000000ull);
+}
+
+static void _task_events(int debounce_ms) {
+    const uint64_t window = (uint64_t)debounce_ms * 1000000ull;
+    DemoGpioSettle b[2];
+    struct pollfd pfd[3];
+
+    DemoGpio_SettleInit(&b[0], s_btn0);
+    DemoGpio_SettleInit(&b[1], s_btn1);
+    for (int i = 0; i < 2; ++i) {
+        pfd[i].fd     = HAL_GpioLine_GetEventFd(b[i].line);
+        pfd[i].events = POLLIN;
+    }
+    pfd[2].fd     = s_wake_fd;
+    pfd[2].events = POLLIN;
+
+    while (s_run) {
+        /* timeout = hạn settle gần nhất, không có thì chờ vô hạn */
+        uint64_t now = _now_ns();
+        int timeout_ms = -1;
+        for (int i = 0; i < 2; ++i) {
+            int ms = DemoGpio_SettleTimeoutMs(&b[i], now);
+            if (ms >= 0 && (timeout_ms < 0 || ms < timeout_ms)) timeout_ms = ms;
+        }
+
+        int rc = poll(pfd, 3, timeout_ms);
+        if (rc < 0 && errno != EINTR) {
+            OSAL_LOG("[DemoGPIO] poll failed (errno=%d)\r\n", errno);
+            break;
+        }
+        if (!s_run) break;
+
+        now = _now_ns();
+        for (int i = 0; i < 2; ++i) {
+            int drain = (rc > 0 && (pfd[i].revents & POLLIN));
+            if (DemoGpio_SettleStep(&b[i], now, window, drain) && b[i].stable) _on_press(i);
+        }
+    }
+}
+
+static void GpioTask(void* arg) {
+    const DemoGpioCfg* cfg = (const DemoGpioCfg*)arg;
+    const int debounce_ms = cfg->debounce_ms > 0 ? cfg->debounce_ms : 5;
+
+    _leds_show8(s_count);
+
+    if (s_use_events) _task_events(debounce_ms);
+    else              _task_poll(debounce_ms);
+
     OSAL_LOG("[DemoGPIO] task exit\r\n");
 }
 
-void DemoGpio_Start(const DemoGpioCfg* cfg) {
-    if (!cfg || !cfg->chip_name || cfg->led_count <= 0 || cfg->led_count > 8) {
-        OSAL_LOG("[DemoGPIO] invalid cfg\r\n");
-        return;
+/* Request nút: thử EDGE_BOTH (debounce do task làm theo timestamp), lỗi thì
+ * request lại không event -> polling. */
+static HAL_GpioStatus _request_btn(const DemoGpioCfg* cfg, int offset, HAL_GpioLine** out) {
+    HAL_GpioLineConfig bc = {
+        .offset  = offset,
+        .name    = NULL,
+        .dir     = HAL_GPIO_DIR_IN,
+        .active  = cfg->btns_active_low ? HAL_GPIO_ACTIVE_LOW : HAL_GPIO_ACTIVE_HIGH,
+        .drive   = HAL_GPIO_DRIVE_PUSHPULL, /* ignored for input */
+        .bias    = HAL_GPIO_BIAS_AS_IS,     /* or PULL_UP if supported */
+        .initial = 0,
+        .edge    = cfg->poll_only ? HAL_GPIO_EDGE_NONE : HAL_GPIO_EDGE_BOTH,
+        .debounce_ms = 0  /* HAL debounce drop cạnh cuối -> task tự debounce */
+    };
+    HAL_GpioStatus st = HAL_GpioLine_Request(s_chip, &bc, out);
+    if (st != HAL_GPIO_OK && bc.edge != HAL_GPIO_EDGE_NONE) {
+        bc.edge = HAL_GPIO_EDGE_NONE;
+        st = HAL_GpioLine_Request(s_chip, &bc, out);
     }
+    return st;
+}
 
+/* Line mở sẵn (board): chỉ kiểm tra đủ, không request */
+static int _use_lines(const DemoGpioCfg* cfg) {
+    for (int i = 0; i < cfg->led_count; ++i) {
+        if (!cfg->led_lines[i]) { OSAL_LOG("[DemoGPIO] LED line %d missing\r\n", i); return -1; }
+    }
+    if (!cfg->btn_lines[0] || !cfg->btn_lines[1]) { OSAL_LOG("[DemoGPIO] BTN line missing\r\n"); return -1; }
+    s_borrowed = 1;
+    s_led_n    = cfg->led_count;
+    for (int i = 0; i < s_led_n; ++i) s_leds[i] = cfg->led_lines[i];
+    s_btn0 = cfg->btn_lines[0];
+    s_btn1 = cfg->btn_lines[1];
+    return 0;
+}
+
+/* Mở chip + request LED / nút theo offset. -1 nếu lỗi (caller dọn bằng _release_all) */
+static int _open_lines(const DemoGpioCfg* cfg) {
     /* 1) Open chip */
     HAL_GpioChipConfig cc = { .chip_name = cfg->chip_name };
     if (HAL_GpioChip_Open(&cc, &s_chip) != HAL_GPIO_OK) {
-        OSAL_LOG("[DemoGPIO] chip open failed\r\n"); return;
+        OSAL_LOG("[DemoGPIO] chip open failed\r\n");
+        return -1;
     }
 
     /* 2) Request LEDs */
@@ -104,31 +272,40 @@ void DemoGpio_Start(const DemoGpioCfg* cfg) {
         };
         if (HAL_GpioLine_Request(s_chip, &lc, &s_leds[i]) != HAL_GPIO_OK) {
             OSAL_LOG("[DemoGPIO] LED line %d request failed\r\n", i);
-            return;
+            return -1;
         }
     }
 
-    /* 3) Request BTN0 / BTN1 as inputs (no event API here; we'll poll) */
-    HAL_GpioLineConfig bc = {
-        .offset  = cfg->btn0_offset,
-        .name    = NULL,
-        .dir     = HAL_GPIO_DIR_IN,
-        .active  = cfg->btns_active_low ? HAL_GPIO_ACTIVE_LOW : HAL_GPIO_ACTIVE_HIGH,
-        .drive   = HAL_GPIO_DRIVE_PUSHPULL, /* ignored for input */
-        .bias    = HAL_GPIO_BIAS_AS_IS,     /* or PULL_UP if supported */
-        .initial = 0,
-        .edge    = HAL_GPIO_EDGE_NONE,
-        .debounce_ms = (uint32_t)cfg->debounce_ms
-    };
-    if (HAL_GpioLine_Request(s_chip, &bc, &s_btn0) != HAL_GPIO_OK) {
-        // printf("status : %s", HAL_GpioLine_Request(s_chip, &bc, &s_btn0));
-        OSAL_LOG("[DemoGPIO] BTN0 request failed\r\n"); 
+    /* 3) Request BTN0 / BTN1 as inputs (edge events when the backend has them) */
+    if (_request_btn(cfg, cfg->btn0_offset, &s_btn0) != HAL_GPIO_OK) {
+        OSAL_LOG("[DemoGPIO] BTN0 request failed\r\n");
+        return -1;
+    }
+    if (_request_btn(cfg, cfg->btn1_offset, &s_btn1) != HAL_GPIO_OK) {
+        OSAL_LOG("[DemoGPIO] BTN1 request failed\r\n");
+        return -1;
+    }
+    return 0;
+}
+
+void DemoGpio_Start(const DemoGpioCfg* cfg) {
+    const int borrowed = cfg && cfg->led_lines[0];
+    if (!cfg || (!borrowed && !cfg->chip_name) || cfg->led_count <= 0 || cfg->led_count > 8) {
+        OSAL_LOG("[DemoGPIO] invalid cfg\r\n");
         return;
     }
-    bc.offset = cfg->btn1_offset;
-    if (HAL_GpioLine_Request(s_chip, &bc, &s_btn1) != HAL_GPIO_OK) {
-        // printf("status : %s", HAL_GpioLine_Request(s_chip, &bc, &s_btn1));
-        OSAL_LOG("[DemoGPIO] BTN1 request failed\r\n"); return;
+
+    /* 1..3) line mở sẵn từ caller (board, lazy) hoặc tự mở theo offset */
+    if ((borrowed ? _use_lines(cfg) : _open_lines(cfg)) != 0) {
+        _release_all();
+        return;
+    }
+
+    /* 4) Event mode nếu cả 2 nút có event fd (poll_only: luôn polling) */
+    s_use_events = 0;
+    if (!cfg->poll_only && HAL_GpioLine_GetEventFd(s_btn0) >= 0 && HAL_GpioLine_GetEventFd(s_btn1) >= 0) {
+        s_wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        s_use_events = (s_wake_fd >= 0);
     }
 
     s_run = 1;
@@ -137,22 +314,20 @@ void DemoGpio_Start(const DemoGpioCfg* cfg) {
     OSAL_TaskAttr a = { .name="DemoGPIO", .stack_size=2048, .prio=18 };
     OSAL_TaskCreate(&s_task, GpioTask, &s_cfg_copy, &a);
 
-    OSAL_LOG("[DemoGPIO] started (BTN0=+1..255, BTN1=reset)\r\n");
+    OSAL_LOG("[DemoGPIO] started (BTN0=+1..255, BTN1=reset, %s)\r\n",
+             s_use_events ? "edge events" : "polling 5ms");
 }
 
 void DemoGpio_Stop(void) {
     s_run = 0;
-    OSAL_TaskDelayMs(50);
-
-    for (int i = 0; i < s_led_n; ++i) {
-        if (s_leds[i]) { HAL_GpioLine_Release(s_leds[i]); s_leds[i] = NULL; }
+    if (s_wake_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t w = write(s_wake_fd, &one, sizeof(one));
+        (void)w;
     }
-    s_led_n = 0;
+    if (s_task) { OSAL_TaskDelete(s_task); s_task = NULL; }
 
-    if (s_btn0) { HAL_GpioLine_Release(s_btn0); s_btn0 = NULL; }
-    if (s_btn1) { HAL_GpioLine_Release(s_btn1); s_btn1 = NULL; }
-
-    if (s_chip) { HAL_GpioChip_Close(s_chip); s_chip = NULL; }
+    _release_all();
 
     OSAL_LOG("[DemoGPIO] stopped\r\n");
 }
@@ -10,6 +10,20 @@
  *   "RELEASE 0\n" -> giả lập thả BTN0
  *   "RELEASE 1\n" -> giả lập thả BTN1
  *   "GETLED\n"    -> trả về "LED a b c d\n"
+ *   "SHM\n"       -> chuyển sang transport shared-memory (gpio_shm.h):
+ *                    trả "OK SHM <slot>\n" kèm fd, lệnh sau đó đi qua ring
+ *   "METRICS\n"   -> bộ đếm HAL (hal_metrics.h), mỗi handle một dòng, kết thúc "END\n"
+ *                    ("ERR\n" nếu build không có HAL_METRICS)
+ *   "METRICS RESET\n" -> đặt lại mốc 0, trả "OK\n"
+ *
+ * Wiring: board description argv[1], hoặc $BOARD_DESC, mặc định boards/sim.board
+ * (LED0..LED7, BTN0, BTN1 trên cùng một chip sim; xem board_desc.h). Không đọc
+ * được file thì dùng wiring sim dựng sẵn (LED 0-3, BTN 12/13).
+ *
+ * Env HAL_METRICS_LOG_S=<n>: in bộ đếm HAL ra stdout mỗi n giây.
+ *
+ * Nhiều client có thể kết nối cùng lúc (tối đa MAX_CLIENTS); mỗi client có
+ * thể gửi nhiều lệnh liên tiếp (pipelining), daemon trả lời theo thứ tự.
  */
 
 #include <stdio.h>
@@ -20,103 +34,37 @@
 #include <sys/un.h>
 #include <errno.h>
 #include <sys/select.h>
+#include <stdint.h>
+#include <time.h>
+#include <signal.h>
+#include <stdarg.h>
 
-#include "hal_gpio.h"
-
-/* các hàm SIM phía C mà ta cần để giả lập nút và đọc LED */
-HAL_GpioStatus HAL_GpioSim_SetInput(HAL_GpioChip* chip, int offset, int logic_val);
-HAL_GpioStatus HAL_GpioSim_GetOutput(HAL_GpioChip* chip, int offset, int* out_logic);
+#include "board_desc.h"
+#include "gpio_demo_core.h"
+#include "gpio_shm.h"
+#include "hal_metrics.h"
+#include "osal.h"
 
 #define SOCK_PATH "/tmp/gpio_sim.sock"
+#define BOARD_DEFAULT "boards/sim.board"
+#define MAX_CLIENTS 64
+#define CLIENT_RX_MAX 512
+#define SHM_BATCH     4096   /* số lệnh shm tối đa mỗi lần xả, giữa hai lần select */
 
-/* ====== phần giống demo_gpio_hal.c ====== */
-
-/* cấu hình demo (giống DemoGpioCfg trong demo_gpio_hal.c) */
+/* mỗi client giữ buffer riêng để ghép dòng (nhiều lệnh / 1 lần read, hoặc 1 lệnh / nhiều read) */
 typedef struct {
-    const char* chip_name;
-    int         led_count;
-    int         led_offsets[8];
-    int         leds_active_low;
-    int         btn0_offset;
-    int         btn1_offset;
-    int         btns_active_low;
-    int         debounce_ms;
-} DemoCfg;
-
-/* biến global như trong demo_gpio_hal.c */
-static HAL_GpioChip*   s_chip    = NULL;
-static HAL_GpioLine*   s_leds[8] = {0};
-static int             s_led_n   = 0;
-static HAL_GpioLine*   s_btn0    = NULL;
-static HAL_GpioLine*   s_btn1    = NULL;
-static unsigned        s_count   = 0;  /* 0..255 */
+    int    fd;
+    int    shm_slot;         /* -1 = chỉ dùng socket */
+    size_t len;
+    char   rx[CLIENT_RX_MAX];
+} Client;
+
+/* instance duy nhất của logic demo (gpio_demo_core.c) */
+static GpioDemoCore    s_demo;
 static int             s_run     = 1;
-
-/* hiển thị giá trị 8 bit ra dãy LED */
-static void leds_show8(unsigned val)
-{
-    for (int i = 0; i < s_led_n; ++i) {
-        if (s_leds[i]) {
-            HAL_GpioLine_Write(s_leds[i], (val >> i) & 1u);
-        }
-    }
-}
-
-/* init GPIO demo: mở chip, request LED, request BTN0/BTN1 */
-static int demo_init(const DemoCfg* cfg)
-{
-    HAL_GpioChipConfig cc = { .chip_name = cfg->chip_name };
-    if (HAL_GpioChip_Open(&cc, &s_chip) != HAL_GPIO_OK) {
-        fprintf(stderr, "[DAEMON] open chip fail\n");
-        return -1;
-    }
-
-    /* request LED lines */
-    s_led_n = cfg->led_count;
-    for (int i = 0; i < s_led_n; ++i) {
-        HAL_GpioLineConfig lc = {
-            .offset  = cfg->led_offsets[i],
-            .name    = NULL,
-            .dir     = HAL_GPIO_DIR_OUT,
-            .active  = cfg->leds_active_low ? HAL_GPIO_ACTIVE_LOW : HAL_GPIO_ACTIVE_HIGH,
-            .drive   = HAL_GPIO_DRIVE_PUSHPULL,
-            .bias    = HAL_GPIO_BIAS_AS_IS,
-            .initial = 0,
-            .edge    = HAL_GPIO_EDGE_NONE,
-            .debounce_ms = 0
-        };
-        if (HAL_GpioLine_Request(s_chip, &lc, &s_leds[i]) != HAL_GPIO_OK) {
-            fprintf(stderr, "[DAEMON] LED %d request failed\n", i);
-            return -2;
-        }
-    }
-
-    /* request BTN0/BTN1 */
-    HAL_GpioLineConfig bc = {
-        .offset  = cfg->btn0_offset,
-        .name    = NULL,
-        .dir     = HAL_GPIO_DIR_IN,
-        .active  = cfg->btns_active_low ? HAL_GPIO_ACTIVE_LOW : HAL_GPIO_ACTIVE_HIGH,
-        .drive   = HAL_GPIO_DRIVE_PUSHPULL,
-        .bias    = HAL_GPIO_BIAS_AS_IS,
-        .initial = 0,
-        .edge    = HAL_GPIO_EDGE_NONE,
-        .debounce_ms = cfg->debounce_ms
-    };
-    if (HAL_GpioLine_Request(s_chip, &bc, &s_btn0) != HAL_GPIO_OK) {
-        fprintf(stderr, "[DAEMON] BTN0 request failed\n");
-        return -3;
-    }
-    bc.offset = cfg->btn1_offset;
-    if (HAL_GpioLine_Request(s_chip, &bc, &s_btn1) != HAL_GPIO_OK) {
-        fprintf(stderr, "[DAEMON] BTN1 request failed\n");
-        return -4;
-    }
-
-    s_count = 0;
-    leds_show8(s_count);
-    return 0;
-}
+/* transport shm dùng chung cho mọi client đã gửi "SHM" (s_shm_ok = 0 nếu init lỗi) */
+static GpioShmServer   s_shm;
+static int             s_shm_ok  = 0;
 
 /* ====== socket setup ====== */
 
@@ -141,7 +89,7 @@ static int setup_socket(void)
         return -1;
     }
 
-    if (listen(fd, 1) < 0) {
+    if (listen(fd, MAX_CLIENTS) < 0) {
         perror("listen");
         close(fd);
         return -1;
@@ -151,39 +99,197 @@ static int setup_socket(void)
     return fd;
 }
 
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/* xử lý 1 lệnh lấy từ command ring shm */
+static void handle_shm_cmd(void* ctx, const GpioShmCmd* cmd, GpioShmCpl* out)
+{
+    GpioDemoCore* d = (GpioDemoCore*)ctx;
+    switch (cmd->op) {
+    case GPIO_SHM_OP_NOP:
+        break;
+    case GPIO_SHM_OP_PRESS:
+    case GPIO_SHM_OP_RELEASE:
+        if (GpioDemoCore_SetButton(d, cmd->arg, cmd->op == GPIO_SHM_OP_PRESS) != 0) out->status = 1;
+        break;
+    case GPIO_SHM_OP_GETLED:
+        out->leds = (uint8_t)GpioDemoCore_GetLeds(d, NULL, 0);
+        break;
+    default:
+        out->status = 1;
+        break;
+    }
+    out->count = (uint16_t)d->count;
+}
+
+/* gửi hết len byte (reply nhiều dòng có thể lớn hơn một lần write) */
+static void write_all(int fd, const char* p, size_t len)
+{
+    while (len) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        p += n;
+        len -= (size_t)n;
+    }
+}
+
+static void reply_metrics(int cfd)
+{
+    static char out[HAL_METRICS_MAX_HANDLES * 192 + 8];
+    size_t n = HAL_Metrics_Format(out, sizeof(out) - 4);
+    memcpy(out + n, "END\n", 4);
+    write_all(cfd, out, n + 4);
+}
+
 /* xử lý 1 dòng lệnh từ client */
-static void handle_cmd(const char* buf, int cfd, const DemoCfg* cfg)
+static void handle_cmd(const char* buf, Client* c)
 {
+    int cfd = c->fd;
     if (strncmp(buf, "PRESS", 5) == 0) {
-        int idx = atoi(buf + 6);
-        int offset = (idx == 0) ? cfg->btn0_offset : cfg->btn1_offset;
-        HAL_GpioSim_SetInput(s_chip, offset, 1);
+        GpioDemoCore_SetButton(&s_demo, atoi(buf + 6), 1);
         write(cfd, "OK\n", 3);
     } else if (strncmp(buf, "RELEASE", 7) == 0) {
-        int idx = atoi(buf + 8);
-        int offset = (idx == 0) ? cfg->btn0_offset : cfg->btn1_offset;
-        HAL_GpioSim_SetInput(s_chip, offset, 0);
+        GpioDemoCore_SetButton(&s_demo, atoi(buf + 8), 0);
         write(cfd, "OK\n", 3);
     } else if (strncmp(buf, "GETLED", 6) == 0) {
         int v[4] = {0};
-        for (int i = 0; i < cfg->led_count; ++i) {
-            int tmp = 0;
-            HAL_GpioSim_GetOutput(s_chip, cfg->led_offsets[i], &tmp);
-            v[i] = tmp;
-        }
+        GpioDemoCore_GetLeds(&s_demo, v, 4);
         char out[128];
         int len = snprintf(out, sizeof(out), "LED %d %d %d %d\n", v[0], v[1], v[2], v[3]);
         write(cfd, out, len);
+    } else if (strncmp(buf, "METRICS", 7) == 0) {
+        if (!HAL_Metrics_Enabled()) {
+            write(cfd, "ERR\n", 4);
+        } else if (strncmp(buf + 7, " RESET", 6) == 0) {
+            HAL_Metrics_Reset();
+            write(cfd, "OK\n", 3);
+        } else {
+            reply_metrics(cfd);
+        }
+    } else if (strncmp(buf, "SHM", 3) == 0) {
+        if (c->shm_slot >= 0 || !s_shm_ok) {
+            write(cfd, "ERR\n", 4);
+        } else {
+            c->shm_slot = GpioShmServer_Attach(&s_shm, cfd);
+            if (c->shm_slot >= 0) printf("[DAEMON] client switched to shm (slot %d)\n", c->shm_slot);
+        }
     } else {
         write(cfd, "ERR\n", 4);
     }
 }
 
-int main(void)
+/* nhận client mới; hết slot thì đóng luôn */
+static void accept_client(int lfd, Client* clients)
 {
-    /* cấu hình mô phỏng giống bạn đang làm */
-    DemoCfg cfg = {
-        .chip_name       = "sim-gpio",
+    int cfd = accept(lfd, NULL, NULL);
+    if (cfd < 0) {
+        perror("accept");
+        return;
+    }
+    for (int i = 0; i < MAX_CLIENTS; ++i) {
+        if (clients[i].fd < 0) {
+            clients[i].fd       = cfd;
+            clients[i].shm_slot = -1;
+            clients[i].len      = 0;
+            printf("[DAEMON] client connected (slot %d)\n", i);
+            return;
+        }
+    }
+    fprintf(stderr, "[DAEMON] too many clients, reject\n");
+    close(cfd);
+}
+
+/* đọc dữ liệu của 1 client, tách theo '\n' và xử lý từng lệnh (hỗ trợ pipelining) */
+static void service_client(Client* c)
+{
+    ssize_t n = read(c->fd, c->rx + c->len, sizeof(c->rx) - 1 - c->len);
+    if (n <= 0) {
+        if (n < 0 && (errno == EINTR || errno == EAGAIN)) return;
+        printf("[DAEMON] client disconnected\n");
+        if (c->shm_slot >= 0) GpioShmServer_Detach(&s_shm, c->shm_slot);
+        c->shm_slot = -1;
+        close(c->fd);
+        c->fd  = -1;
+        c->len = 0;
+        return;
+    }
+    c->len += (size_t)n;
+    c->rx[c->len] = '\0';
+
+    char* line = c->rx;
+    char* nl;
+    while ((nl = memchr(line, '\n', c->len - (size_t)(line - c->rx))) != NULL) {
+        *nl = '\0';
+        handle_cmd(line, c);
+        line = nl + 1;
+    }
+    size_t rest = c->len - (size_t)(line - c->rx);
+    if (rest == sizeof(c->rx) - 1) {
+        /* dòng quá dài, không có '\n' → bỏ */
+        write(c->fd, "ERR\n", 4);
+        rest = 0;
+    }
+    memmove(c->rx, line, rest);
+    c->len = rest;
+}
+
+/* sink của OSAL_LOG (board_desc) */
+static void _osal_log(const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+}
+
+/* LED0..LED7, BTN0, BTN1 từ board description. Demo core mở một chip duy
+ * nhất (SetButton / GetLeds cần chip sim), nên mọi line phải cùng chip.
+ * Trả 0 nếu OK, -1 (kèm lý do trong err) nếu board không dùng được. */
+static int _cfg_from_board(const BoardDesc* bd, GpioDemoCoreCfg* c, char* err, size_t err_len)
+{
+    BoardLineInfo li;
+    int n = 0;
+    for (int i = 0; i < GPIO_DEMO_MAX_LEDS; ++i) {
+        char name[8];
+        snprintf(name, sizeof(name), "LED%d", i);
+        if (BoardDesc_LineInfo(bd, name, &li) != 0) break;
+        if (n == 0) c->chip_name = li.chip_dev;
+        else if (strcmp(c->chip_name, li.chip_dev) != 0) {
+            snprintf(err, err_len, "%s on %s, LED0 on %s", name, li.chip_dev, c->chip_name);
+            return -1;
+        }
+        c->led_offsets[n++] = li.cfg.offset;
+        c->leds_active_low  = (li.cfg.active == HAL_GPIO_ACTIVE_LOW);
+    }
+    if (n == 0) { snprintf(err, err_len, "no LED0"); return -1; }
+    c->led_count = n;
+
+    for (int b = 0; b < 2; ++b) {
+        const char* name = b ? "BTN1" : "BTN0";
+        if (BoardDesc_LineInfo(bd, name, &li) != 0) { snprintf(err, err_len, "no %s", name); return -1; }
+        if (strcmp(li.chip_dev, c->chip_name) != 0) {
+            snprintf(err, err_len, "%s on %s, LEDs on %s", name, li.chip_dev, c->chip_name);
+            return -1;
+        }
+        if (b) c->btn1_offset = li.cfg.offset;
+        else   c->btn0_offset = li.cfg.offset;
+        c->btns_active_low = (li.cfg.active == HAL_GPIO_ACTIVE_LOW);
+        if (li.cfg.debounce_ms) c->debounce_ms = (int)li.cfg.debounce_ms;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    /* wiring dựng sẵn, chỉ dùng khi không đọc được board description */
+    GpioDemoCoreCfg cfg = {
+        .chip_name       = "sim:sim-gpio",
         .led_count       = 4,
         .led_offsets     = {0,1,2,3,0,0,0,0},
         .leds_active_low = 0,
@@ -193,96 +299,134 @@ int main(void)
         .debounce_ms     = 5
     };
 
-    if (demo_init(&cfg) != 0) {
+    /* log của board_desc đi qua OSAL_LOG */
+    OSAL_Config ocfg = { .backend = OSAL_BACKEND_LINUX, .log = _osal_log, .platform_ctx = NULL };
+    OSAL_Init(&ocfg);
+
+    /* Board description: argv[1] hoặc $BOARD_DESC, mặc định boards/sim.board */
+    const char* board_path = (argc > 1) ? argv[1] : getenv("BOARD_DESC");
+    if (!board_path || !board_path[0]) board_path = BOARD_DEFAULT;
+    char err[128];
+    BoardDesc* board = BoardDesc_Load(board_path, err, sizeof(err));
+    if (board) {
+        GpioDemoCoreCfg bcfg = cfg;
+        if (_cfg_from_board(board, &bcfg, err, sizeof(err)) == 0) {
+            cfg = bcfg;
+            printf("[DAEMON] board: %s (%s, %d LED)\n", board_path, cfg.chip_name, cfg.led_count);
+        } else {
+            printf("[DAEMON] board %s: %s (using defaults)\n", board_path, err);
+        }
+    } else {
+        printf("[DAEMON] board %s: %s (using defaults)\n", board_path, err);
+    }
+
+    if (GpioDemoCore_Init(&s_demo, &cfg) != 0) {
+        fprintf(stderr, "[DAEMON] demo gpio init fail\n");
         return 1;
     }
     printf("[DAEMON] demo gpio init ok\n");
 
+    /* client đóng kết nối khi còn lệnh chưa trả lời: write() phải trả EPIPE, không giết daemon */
+    signal(SIGPIPE, SIG_IGN);
+
     int lfd = setup_socket();
     if (lfd < 0) return 1;
 
-    int cfd = accept(lfd, NULL, NULL);
-    if (cfd < 0) {
-        perror("accept");
-        return 1;
-    }
-    printf("[DAEMON] client connected\n");
+    s_shm_ok = (GpioShmServer_Init(&s_shm) == 0);
+    if (!s_shm_ok) fprintf(stderr, "[DAEMON] shm transport disabled\n");
 
-    /* ====== vòng lặp giống demo_gpio_hal.c ====== */
+    Client clients[MAX_CLIENTS];
+    for (int i = 0; i < MAX_CLIENTS; ++i) clients[i].fd = -1;
 
-    const int step_ms     = 5;
-    const int debounce_ms = (cfg.debounce_ms > 0) ? cfg.debounce_ms : 5;
+    /* ====== vòng lặp giống demo_gpio_hal.c ====== */
 
-    int last0 = 0, last1 = 0;
-    int stable0 = 0, stable1 = 0;
-    int acc0 = 0, acc1 = 0;
-    int prev0 = 0, prev1 = 0;
+    const int step_ms = 5;
+    uint64_t next_tick_us = now_us();
 
-    leds_show8(s_count);
+    const char* mx_env = getenv("HAL_METRICS_LOG_S");
+    uint64_t mx_period_us = (mx_env && HAL_Metrics_Enabled()) ? strtoull(mx_env, NULL, 10) * 1000000u : 0;
+    uint64_t mx_next_us   = next_tick_us + mx_period_us;
 
     while (s_run) {
-        /* 1) đọc BTN giống demo */
-        int v0 = 0, v1 = 0;
-        HAL_GpioLine_Read(s_btn0, &v0);
-        HAL_GpioLine_Read(s_btn1, &v1);
-
-        /* debounce BTN0 */
-        if (v0 == last0) { acc0 += step_ms; if (acc0 >= debounce_ms) stable0 = v0; }
-        else             { acc0 = 0; }
-        /* debounce BTN1 */
-        if (v1 == last1) { acc1 += step_ms; if (acc1 >= debounce_ms) stable1 = v1; }
-        else             { acc1 = 0; }
-
-        /* rising edge detect */
-        int rising0 = (stable0 && !prev0);
-        int rising1 = (stable1 && !prev1);
-
-        if (rising0) {
-            if (s_count < 255) s_count++;
-            printf("[DAEMON][BTN0] ++ -> %u\n", s_count);
-            leds_show8(s_count);
-        }
-        if (rising1) {
-            s_count = 0;
-            printf("[DAEMON][BTN1] reset -> %u\n", s_count);
-            leds_show8(s_count);
+        /* 1) đọc BTN, debounce, cập nhật LED */
+        unsigned ev = GpioDemoCore_Tick(&s_demo, step_ms);
+        if (ev & GPIO_DEMO_EV_INC)   printf("[DAEMON][BTN0] ++ -> %u\n", s_demo.count);
+        if (ev & GPIO_DEMO_EV_RESET) printf("[DAEMON][BTN1] reset -> %u\n", s_demo.count);
+
+        if (mx_period_us && next_tick_us >= mx_next_us) {
+            static char mx[HAL_METRICS_MAX_HANDLES * 192];
+            HAL_Metrics_Format(mx, sizeof(mx));
+            printf("[DAEMON][METRICS]\n%s", mx);
+            fflush(stdout);
+            mx_next_us = next_tick_us + mx_period_us;
         }
 
-        prev0 = stable0;
-        prev1 = stable1;
-        last0 = v0;
-        last1 = v1;
-
-        /* 2) xử lý lệnh từ Python nếu có (non-blocking) */
-        fd_set rfds;
-        FD_ZERO(&rfds);
-        FD_SET(cfd, &rfds);
-        struct timeval tv = {0, 0};
-        int rv = select(cfd + 1, &rfds, NULL, NULL, &tv);
-        if (rv > 0 && FD_ISSET(cfd, &rfds)) {
-            char buf[128];
-            ssize_t n = read(cfd, buf, sizeof(buf)-1);
-            if (n > 0) {
-                buf[n] = '\0';
-                handle_cmd(buf, cfd, &cfg);
+        /* 2) xử lý lệnh từ client cho tới tick kế tiếp (thay cho usleep(5ms)):
+         *    lệnh được trả lời ngay khi tới, không phải chờ hết chu kỳ */
+        next_tick_us += (uint64_t)step_ms * 1000u;
+        for (;;) {
+            uint64_t now = now_us();
+            if (now >= next_tick_us) break;
+
+            /* lệnh shm: xả một lô; còn việc thì chỉ liếc socket (timeout 0) rồi xả tiếp,
+             * hết việc thì bật idle để client rung eventfd và ngủ trong select như cũ */
+            int sleep_ok = 1;
+            if (s_shm_ok) {
+                size_t n = GpioShmServer_Drain(&s_shm, SHM_BATCH, handle_shm_cmd, &s_demo);
+                sleep_ok = (n == 0) && GpioShmServer_PrepareSleep(&s_shm);
             }
-        }
 
-        /* 3) delay giống OSAL_TaskDelayMs(5) */
-        usleep(step_ms * 1000);
+            fd_set rfds;
+            FD_ZERO(&rfds);
+            FD_SET(lfd, &rfds);
+            int maxfd = lfd;
+            if (s_shm_ok) {
+                int efd = GpioShmServer_Fd(&s_shm);
+                FD_SET(efd, &rfds);
+                if (efd > maxfd) maxfd = efd;
+            }
+            for (int i = 0; i < MAX_CLIENTS; ++i) {
+                if (clients[i].fd < 0) continue;
+                FD_SET(clients[i].fd, &rfds);
+                if (clients[i].fd > maxfd) maxfd = clients[i].fd;
+            }
+            uint64_t wait_us = sleep_ok ? next_tick_us - now : 0;
+            struct timeval tv = { (time_t)(wait_us / 1000000u), (suseconds_t)(wait_us % 1000000u) };
+            int rv = select(maxfd + 1, &rfds, NULL, NULL, &tv);
+            if (sleep_ok && s_shm_ok) GpioShmServer_Wake(&s_shm);
+            if (rv < 0) {
+                if (errno == EINTR) continue;
+                perror("select");
+                break;
+            }
+            if (rv == 0) {
+                if (sleep_ok) break;
+                continue;
+            }
+
+            if (FD_ISSET(lfd, &rfds)) {
+                accept_client(lfd, clients);
+            }
+            for (int i = 0; i < MAX_CLIENTS; ++i) {
+                if (clients[i].fd >= 0 && FD_ISSET(clients[i].fd, &rfds)) {
+                    service_client(&clients[i]);
+                }
+            }
+        }
+        /* bị trễ quá 1 chu kỳ (VD: bị preempt) → bám lại mốc hiện tại, không chạy bù */
+        if (now_us() > next_tick_us + (uint64_t)step_ms * 1000u) next_tick_us = now_us();
     }
 
     /* cleanup (nếu cần) */
-    close(cfd);
+    for (int i = 0; i < MAX_CLIENTS; ++i) {
+        if (clients[i].fd >= 0) close(clients[i].fd);
+    }
     close(lfd);
     unlink(SOCK_PATH);
+    if (s_shm_ok) GpioShmServer_Deinit(&s_shm);
 
-    for (int i = 0; i < s_led_n; ++i) {
-        if (s_leds[i]) HAL_GpioLine_Release(s_leds[i]);
-    }
-    if (s_btn0) HAL_GpioLine_Release(s_btn0);
-    if (s_btn1) HAL_GpioLine_Release(s_btn1);
-    if (s_chip) HAL_GpioChip_Close(s_chip);
+    GpioDemoCore_Deinit(&s_demo);
+    if (board) BoardDesc_Free(board);   /* cfg.chip_name trỏ vào board */
 
     return 0;
 }
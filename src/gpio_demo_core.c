@@ -0,0 +1,145 @@
+/*
+ * gpio_demo_core.c
+ * Logic đếm BTN0/BTN1 -> LED của gpio_daemon, dạng instance (xem gpio_demo_core.h).
+ */
+
+#include <string.h>
+
+#include "gpio_demo_core.h"
+#include "hal_gpio_sim.h"   /* giả lập nút và đọc LED */
+
+/* hiển thị giá trị 8 bit ra dãy LED */
+static void _leds_show8(GpioDemoCore* d, unsigned val)
+{
+    for (int i = 0; i < d->cfg.led_count; ++i) {
+        if (d->leds[i]) HAL_GpioLine_Write(d->leds[i], (val >> i) & 1u);
+    }
+}
+
+int GpioDemoCore_Init(GpioDemoCore* d, const GpioDemoCoreCfg* cfg)
+{
+    if (!d || !cfg || cfg->led_count < 0 || cfg->led_count > GPIO_DEMO_MAX_LEDS) return -1;
+    memset(d, 0, sizeof(*d));
+    d->cfg = *cfg;
+    if (d->cfg.debounce_ms <= 0) d->cfg.debounce_ms = 5;
+
+    HAL_GpioChipConfig cc = { .chip_name = cfg->chip_name };
+    if (HAL_GpioChip_Open(&cc, &d->chip) != HAL_GPIO_OK) return -1;
+
+    /* request LED lines */
+    for (int i = 0; i < cfg->led_count; ++i) {
+        HAL_GpioLineConfig lc = {
+            .offset  = cfg->led_offsets[i],
+            .name    = NULL,
+            .dir     = HAL_GPIO_DIR_OUT,
+            .active  = cfg->leds_active_low ? HAL_GPIO_ACTIVE_LOW : HAL_GPIO_ACTIVE_HIGH,
+            .drive   = HAL_GPIO_DRIVE_PUSHPULL,
+            .bias    = HAL_GPIO_BIAS_AS_IS,
+            .initial = 0,
+            .edge    = HAL_GPIO_EDGE_NONE,
+            .debounce_ms = 0
+        };
+        if (HAL_GpioLine_Request(d->chip, &lc, &d->leds[i]) != HAL_GPIO_OK) {
+            GpioDemoCore_Deinit(d);
+            return -2;
+        }
+    }
+
+    /* request BTN0/BTN1 */
+    HAL_GpioLineConfig bc = {
+        .offset  = cfg->btn0_offset,
+        .name    = NULL,
+        .dir     = HAL_GPIO_DIR_IN,
+        .active  = cfg->btns_active_low ? HAL_GPIO_ACTIVE_LOW : HAL_GPIO_ACTIVE_HIGH,
+        .drive   = HAL_GPIO_DRIVE_PUSHPULL,
+        .bias    = HAL_GPIO_BIAS_AS_IS,
+        .initial = 0,
+        .edge    = HAL_GPIO_EDGE_NONE,
+        .debounce_ms = d->cfg.debounce_ms
+    };
+    if (HAL_GpioLine_Request(d->chip, &bc, &d->btn[0]) != HAL_GPIO_OK) {
+        GpioDemoCore_Deinit(d);
+        return -3;
+    }
+    bc.offset = cfg->btn1_offset;
+    if (HAL_GpioLine_Request(d->chip, &bc, &d->btn[1]) != HAL_GPIO_OK) {
+        GpioDemoCore_Deinit(d);
+        return -4;
+    }
+
+    /* sim: nút active-low phải bắt đầu ở mức "thả" (vật lý 1); chip khác bỏ qua */
+    if (d->cfg.btns_active_low) {
+        HAL_GpioSim_SetInput(d->chip, cfg->btn0_offset, 1);
+        HAL_GpioSim_SetInput(d->chip, cfg->btn1_offset, 1);
+    }
+
+    d->count = 0;
+    _leds_show8(d, d->count);
+    return 0;
+}
+
+void GpioDemoCore_Deinit(GpioDemoCore* d)
+{
+    if (!d) return;
+    for (int i = 0; i < GPIO_DEMO_MAX_LEDS; ++i) {
+        if (d->leds[i]) HAL_GpioLine_Release(d->leds[i]);
+        d->leds[i] = NULL;
+    }
+    for (int i = 0; i < 2; ++i) {
+        if (d->btn[i]) HAL_GpioLine_Release(d->btn[i]);
+        d->btn[i] = NULL;
+    }
+    if (d->chip) HAL_GpioChip_Close(d->chip);
+    d->chip = NULL;
+}
+
+unsigned GpioDemoCore_Tick(GpioDemoCore* d, int step_ms)
+{
+    unsigned ev = 0;
+
+    for (int b = 0; b < 2; ++b) {
+        int v = 0;
+        HAL_GpioLine_Read(d->btn[b], &v);
+
+        /* debounce: giá trị phải giữ nguyên debounce_ms mới được nhận */
+        if (v == d->last[b]) { d->acc[b] += step_ms; if (d->acc[b] >= d->cfg.debounce_ms) d->stable[b] = v; }
+        else                 { d->acc[b] = 0; }
+
+        /* rising edge detect */
+        if (d->stable[b] && !d->prev[b]) ev |= (b == 0) ? GPIO_DEMO_EV_INC : GPIO_DEMO_EV_RESET;
+
+        d->prev[b] = d->stable[b];
+        d->last[b] = v;
+    }
+
+    if (ev & GPIO_DEMO_EV_INC) {
+        if (d->count < 255) d->count++;
+        _leds_show8(d, d->count);
+    }
+    if (ev & GPIO_DEMO_EV_RESET) {
+        d->count = 0;
+        _leds_show8(d, d->count);
+    }
+    return ev;
+}
+
+int GpioDemoCore_SetButton(GpioDemoCore* d, int idx, int pressed)
+{
+    if (!d || idx < 0 || idx > 1) return -1;
+    int offset = (idx == 0) ? d->cfg.btn0_offset : d->cfg.btn1_offset;
+    /* SetInput đặt mức vật lý: nút active-low "nhấn" = 0 */
+    int level = (pressed ? 1 : 0) ^ (d->cfg.btns_active_low ? 1 : 0);
+    return (HAL_GpioSim_SetInput(d->chip, offset, level) == HAL_GPIO_OK) ? 0 : -1;
+}
+
+unsigned GpioDemoCore_GetLeds(GpioDemoCore* d, int* out, int n)
+{
+    unsigned bm = 0;
+    for (int i = 0; i < d->cfg.led_count; ++i) {
+        int tmp = 0;
+        HAL_GpioSim_GetOutput(d->chip, d->cfg.led_offsets[i], &tmp);
+        if (tmp) bm |= 1u << i;
+        if (out && i < n) out[i] = tmp;
+    }
+    return bm;
+}
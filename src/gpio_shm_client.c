@@ -0,0 +1,208 @@
+/*
+ * gpio_shm_client.c
+ * Phía client của transport shared-memory (xem gpio_shm.h): xin vùng chung
+ * qua socket gpio_daemon, đẩy lệnh vào command ring, thu completion.
+ * Một GpioShmClient chỉ dùng từ một thread.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "gpio_shm.h"
+
+#define _CMD_MASK   (GPIO_SHM_CMD_SLOTS - 1u)
+#define _CPL_MASK   (GPIO_SHM_CPL_SLOTS - 1u)
+#define _SPIN_POLLS 2000     /* số lần poll ring trước khi ngủ trên eventfd */
+
+struct GpioShmClient {
+    int             sock;       ///< giữ kết nối: đóng = daemon thu hồi slot
+    GpioShmRegion*  rg;
+    int             cmd_efd, cpl_efd;
+    uint16_t        slot, gen;
+    uint32_t        head;       ///< bản local của cpl.head
+    uint32_t        submitted, completed;
+};
+
+/* nhận "OK SHM <slot>\n" + 3 fd; trả về slot hoặc -1 */
+static int _recv_fds(int sock, int fds[3])
+{
+    char line[64];
+    char ctrl[CMSG_SPACE(3 * sizeof(int))];
+    struct iovec iov = { line, sizeof(line) - 1 };
+    struct msghdr msg = {
+        .msg_iov = &iov, .msg_iovlen = 1,
+        .msg_control = ctrl, .msg_controllen = sizeof(ctrl),
+    };
+    ssize_t n;
+    do { n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC); } while (n < 0 && errno == EINTR);
+    if (n <= 0) return -1;
+    line[n] = '\0';
+
+    int got = 0;
+    for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS &&
+            cm->cmsg_len == CMSG_LEN(3 * sizeof(int))) {
+            memcpy(fds, CMSG_DATA(cm), 3 * sizeof(int));
+            got = 1;
+        }
+    }
+    int slot = -1;
+    if (!got || sscanf(line, "OK SHM %d", &slot) != 1 || slot < 0 || slot >= (int)GPIO_SHM_MAX_CLIENTS) {
+        if (got) { close(fds[0]); close(fds[1]); close(fds[2]); }
+        return -1;
+    }
+    return slot;
+}
+
+GpioShmClient* GpioShmClient_Connect(const char* sock_path)
+{
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) return NULL;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, sock_path, sizeof(addr.sun_path) - 1);
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        write(sock, "SHM\n", 4) != 4) {
+        close(sock);
+        return NULL;
+    }
+
+    int fds[3];
+    int slot = _recv_fds(sock, fds);
+    if (slot < 0) {
+        close(sock);
+        return NULL;
+    }
+
+    void* p = mmap(NULL, sizeof(GpioShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    close(fds[0]);                                  /* mapping giữ vùng nhớ */
+    GpioShmRegion* rg = (p == MAP_FAILED) ? NULL : (GpioShmRegion*)p;
+    if (!rg || __atomic_load_n(&rg->magic, __ATOMIC_ACQUIRE) != GPIO_SHM_MAGIC ||
+        rg->version != GPIO_SHM_VERSION || rg->cmd_slots != GPIO_SHM_CMD_SLOTS ||
+        rg->cpl_slots != GPIO_SHM_CPL_SLOTS) {
+        fprintf(stderr, "[SHM] region layout mismatch\n");
+        if (rg) munmap(rg, sizeof(GpioShmRegion));
+        close(fds[1]); close(fds[2]); close(sock);
+        return NULL;
+    }
+
+    GpioShmClient* c = calloc(1, sizeof(*c));
+    if (!c) {
+        munmap(rg, sizeof(GpioShmRegion));
+        close(fds[1]); close(fds[2]); close(sock);
+        return NULL;
+    }
+    c->sock    = sock;
+    c->rg      = rg;
+    c->cmd_efd = fds[1];
+    c->cpl_efd = fds[2];
+    c->slot    = (uint16_t)slot;
+    c->gen     = (uint16_t)__atomic_load_n(&rg->cpl[slot].gen, __ATOMIC_ACQUIRE);
+    return c;
+}
+
+void GpioShmClient_Close(GpioShmClient* c)
+{
+    if (!c) return;
+    munmap(c->rg, sizeof(GpioShmRegion));
+    close(c->cmd_efd);
+    close(c->cpl_efd);
+    close(c->sock);
+    free(c);
+}
+
+uint32_t GpioShmClient_InFlight(const GpioShmClient* c)
+{
+    return c->submitted - c->completed;
+}
+
+int GpioShmClient_Submit(GpioShmClient* c, GpioShmOp op, uint8_t arg, uint32_t tag)
+{
+    /* credit = chỗ trống trong completion ring của mình → daemon không bao giờ phải bỏ lệnh */
+    if (c->submitted - c->completed >= GPIO_SHM_CPL_SLOTS) return -1;
+
+    GpioShmRegion* rg = c->rg;
+    uint32_t pos = __atomic_load_n(&rg->enq_pos, __ATOMIC_RELAXED);
+    GpioShmCmd* cell;
+    for (;;) {
+        cell = &rg->cmd[pos & _CMD_MASK];
+        uint32_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        int32_t dif = (int32_t)(seq - pos);
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&rg->enq_pos, &pos, pos + 1u, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (dif < 0) {
+            return -1;                                  /* ring đầy: daemon chưa xả kịp */
+        } else {
+            pos = __atomic_load_n(&rg->enq_pos, __ATOMIC_RELAXED);
+        }
+    }
+    cell->client = c->slot;
+    cell->gen    = c->gen;
+    cell->op     = (uint8_t)op;
+    cell->arg    = arg;
+    cell->tag    = tag;
+    __atomic_store_n(&cell->seq, pos + 1u, __ATOMIC_RELEASE);
+    c->submitted++;
+
+    /* cặp với GpioShmServer_PrepareSleep: chỉ rung chuông khi daemon đang/sắp ngủ */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&rg->idle, __ATOMIC_RELAXED)) {
+        uint64_t one = 1;
+        if (write(c->cmd_efd, &one, sizeof(one)) < 0) { /* EAGAIN: counter đã khác 0 */ }
+    }
+    return 0;
+}
+
+int GpioShmClient_Poll(GpioShmClient* c, GpioShmCpl* out, int max)
+{
+    GpioShmCplRing* cr = &c->rg->cpl[c->slot];
+    uint32_t tail = __atomic_load_n(&cr->tail, __ATOMIC_ACQUIRE);
+    int n = 0;
+    while (c->head != tail && n < max) {
+        out[n++] = cr->ring[c->head & _CPL_MASK];
+        c->head++;
+    }
+    if (n) {
+        __atomic_store_n(&cr->head, c->head, __ATOMIC_RELEASE);
+        c->completed += (uint32_t)n;
+    }
+    return n;
+}
+
+int GpioShmClient_Wait(GpioShmClient* c, GpioShmCpl* out, int max, int timeout_ms)
+{
+    GpioShmCplRing* cr = &c->rg->cpl[c->slot];
+    for (int i = 0; i < _SPIN_POLLS; ++i) {
+        int n = GpioShmClient_Poll(c, out, max);
+        if (n) return n;
+    }
+    for (;;) {
+        __atomic_store_n(&cr->waiting, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        int n = GpioShmClient_Poll(c, out, max);
+        if (n) {
+            __atomic_store_n(&cr->waiting, 0, __ATOMIC_RELAXED);
+            return n;
+        }
+        struct pollfd pfd = { c->cpl_efd, POLLIN, 0 };
+        int rv = poll(&pfd, 1, timeout_ms);
+        __atomic_store_n(&cr->waiting, 0, __ATOMIC_RELAXED);
+        if (rv < 0 && errno != EINTR) return -1;
+        if (rv == 0) return GpioShmClient_Poll(c, out, max);
+        uint64_t v;
+        if (rv > 0 && read(c->cpl_efd, &v, sizeof(v)) < 0) { /* EAGAIN */ }
+        n = GpioShmClient_Poll(c, out, max);
+        if (n) return n;
+    }
+}
@@ -0,0 +1,213 @@
+/*
+ * gpio_shm_server.c
+ * Phía daemon của transport shared-memory (xem gpio_shm.h):
+ * tạo vùng chung (memfd), trao fd cho client qua SCM_RIGHTS, xả command ring
+ * giữa các tick và đẩy completion về ring riêng của từng client.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+
+#include "gpio_shm.h"
+
+#define _CMD_MASK (GPIO_SHM_CMD_SLOTS - 1u)
+#define _CPL_MASK (GPIO_SHM_CPL_SLOTS - 1u)
+
+int GpioShmServer_Init(GpioShmServer* s)
+{
+    if (!s) return -1;
+    memset(s, 0, sizeof(*s));
+    s->memfd = s->cmd_efd = -1;
+    for (unsigned i = 0; i < GPIO_SHM_MAX_CLIENTS; ++i) s->cpl_efd[i] = -1;
+
+    s->memfd = memfd_create("gpio_shm", MFD_CLOEXEC);
+    if (s->memfd < 0 || ftruncate(s->memfd, sizeof(GpioShmRegion)) < 0) {
+        perror("[SHM] memfd");
+        GpioShmServer_Deinit(s);
+        return -1;
+    }
+    void* p = mmap(NULL, sizeof(GpioShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, s->memfd, 0);
+    if (p == MAP_FAILED) {
+        perror("[SHM] mmap");
+        GpioShmServer_Deinit(s);
+        return -1;
+    }
+    s->rg = (GpioShmRegion*)p;
+    s->cmd_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (s->cmd_efd < 0) {
+        perror("[SHM] eventfd");
+        GpioShmServer_Deinit(s);
+        return -1;
+    }
+
+    /* memfd mới luôn toàn 0; chỉ cần header + seq ban đầu của cell (Vyukov: seq = index) */
+    GpioShmRegion* rg = s->rg;
+    rg->version     = GPIO_SHM_VERSION;
+    rg->cmd_slots   = GPIO_SHM_CMD_SLOTS;
+    rg->cpl_slots   = GPIO_SHM_CPL_SLOTS;
+    rg->max_clients = GPIO_SHM_MAX_CLIENTS;
+    for (uint32_t i = 0; i < GPIO_SHM_CMD_SLOTS; ++i) rg->cmd[i].seq = i;
+    __atomic_store_n(&rg->magic, GPIO_SHM_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void GpioShmServer_Deinit(GpioShmServer* s)
+{
+    if (!s) return;
+    for (unsigned i = 0; i < GPIO_SHM_MAX_CLIENTS; ++i) {
+        if (s->cpl_efd[i] >= 0) close(s->cpl_efd[i]);
+        s->cpl_efd[i] = -1;
+    }
+    if (s->rg) munmap(s->rg, sizeof(GpioShmRegion));
+    if (s->memfd >= 0) close(s->memfd);
+    if (s->cmd_efd >= 0) close(s->cmd_efd);
+    s->rg = NULL;
+    s->memfd = s->cmd_efd = -1;
+}
+
+/* gửi dòng trả lời kèm 3 fd */
+static int _send_fds(int sock_fd, const char* line, const int fds[3])
+{
+    char ctrl[CMSG_SPACE(3 * sizeof(int))];
+    memset(ctrl, 0, sizeof(ctrl));
+    struct iovec iov = { (void*)line, strlen(line) };
+    struct msghdr msg = {
+        .msg_iov = &iov, .msg_iovlen = 1,
+        .msg_control = ctrl, .msg_controllen = sizeof(ctrl),
+    };
+    struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type  = SCM_RIGHTS;
+    cm->cmsg_len   = CMSG_LEN(3 * sizeof(int));
+    memcpy(CMSG_DATA(cm), fds, 3 * sizeof(int));
+
+    ssize_t n;
+    do { n = sendmsg(sock_fd, &msg, MSG_NOSIGNAL); } while (n < 0 && errno == EINTR);
+    return (n == (ssize_t)iov.iov_len) ? 0 : -1;
+}
+
+int GpioShmServer_Attach(GpioShmServer* s, int sock_fd)
+{
+    int slot = -1;
+    if (s && s->rg) {
+        for (unsigned i = 0; i < GPIO_SHM_MAX_CLIENTS; ++i) {
+            if (s->cpl_efd[i] < 0) { slot = (int)i; break; }
+        }
+    }
+    int efd = (slot >= 0) ? eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) : -1;
+    if (efd < 0) {
+        if (write(sock_fd, "ERR\n", 4) < 0) { /* client đã đi, socket loop sẽ dọn */ }
+        return -1;
+    }
+
+    /* slot mới: gen++ để lệnh còn sót của client cũ trong ring bị bỏ */
+    GpioShmCplRing* cr = &s->rg->cpl[slot];
+    cr->head = cr->tail = 0;
+    __atomic_store_n(&cr->waiting, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&cr->gen, (uint16_t)(cr->gen + 1), __ATOMIC_RELEASE);
+
+    char line[32];
+    snprintf(line, sizeof(line), "OK SHM %d\n", slot);
+    int fds[3] = { s->memfd, s->cmd_efd, efd };
+    if (_send_fds(sock_fd, line, fds) != 0) {
+        close(efd);
+        return -1;
+    }
+    s->cpl_efd[slot] = efd;
+    return slot;
+}
+
+void GpioShmServer_Detach(GpioShmServer* s, int slot)
+{
+    if (!s || slot < 0 || slot >= (int)GPIO_SHM_MAX_CLIENTS || s->cpl_efd[slot] < 0) return;
+    close(s->cpl_efd[slot]);
+    s->cpl_efd[slot] = -1;
+}
+
+int GpioShmServer_Fd(const GpioShmServer* s)
+{
+    return s ? s->cmd_efd : -1;
+}
+
+/* 1 nếu cell ở deq_pos đã được producer publish */
+static int _cmd_ready(const GpioShmRegion* rg)
+{
+    uint32_t pos = rg->deq_pos;
+    uint32_t seq = __atomic_load_n(&rg->cmd[pos & _CMD_MASK].seq, __ATOMIC_ACQUIRE);
+    return seq == pos + 1u;
+}
+
+size_t GpioShmServer_Drain(GpioShmServer* s, size_t max, GpioShmHandler h, void* ctx)
+{
+    if (!s || !s->rg) return 0;
+    GpioShmRegion* rg = s->rg;
+    uint32_t pushed = 0;           /* bitmap slot có completion mới trong lô này */
+    size_t n = 0;
+
+    while (n < max) {
+        uint32_t pos = rg->deq_pos;
+        GpioShmCmd* cell = &rg->cmd[pos & _CMD_MASK];
+        if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != pos + 1u) break;
+
+        GpioShmCmd cmd = *cell;
+        rg->deq_pos = pos + 1u;
+        __atomic_store_n(&cell->seq, pos + GPIO_SHM_CMD_SLOTS, __ATOMIC_RELEASE);
+        ++n;
+
+        if (cmd.client >= GPIO_SHM_MAX_CLIENTS || s->cpl_efd[cmd.client] < 0 ||
+            cmd.gen != (uint16_t)rg->cpl[cmd.client].gen) {
+            ++s->dropped;              /* client đã detach / slot đã đổi chủ */
+            continue;
+        }
+        GpioShmCplRing* cr = &rg->cpl[cmd.client];
+        uint32_t tail = cr->tail;
+        if (tail - __atomic_load_n(&cr->head, __ATOMIC_ACQUIRE) >= GPIO_SHM_CPL_SLOTS) {
+            ++s->dropped;              /* client vượt credit: không có chỗ trả lời */
+            continue;
+        }
+        GpioShmCpl* out = &cr->ring[tail & _CPL_MASK];
+        memset(out, 0, sizeof(*out));
+        out->tag = cmd.tag;
+        h(ctx, &cmd, out);
+        __atomic_store_n(&cr->tail, tail + 1u, __ATOMIC_RELEASE);
+        pushed |= 1u << cmd.client;
+        ++s->served;
+    }
+
+    if (pushed) {
+        /* cặp với client: waiting=1; fence; kiểm tail — một trong hai bên chắc chắn thấy bên kia */
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        for (unsigned i = 0; pushed; ++i, pushed >>= 1) {
+            if (!(pushed & 1u) || !__atomic_load_n(&rg->cpl[i].waiting, __ATOMIC_RELAXED)) continue;
+            uint64_t one = 1;
+            if (write(s->cpl_efd[i], &one, sizeof(one)) < 0) { /* EAGAIN: counter đã khác 0 */ }
+        }
+    }
+    return n;
+}
+
+int GpioShmServer_PrepareSleep(GpioShmServer* s)
+{
+    if (!s || !s->rg) return 1;
+    __atomic_store_n(&s->rg->idle, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (_cmd_ready(s->rg)) {
+        __atomic_store_n(&s->rg->idle, 0, __ATOMIC_RELAXED);
+        return 0;
+    }
+    return 1;
+}
+
+void GpioShmServer_Wake(GpioShmServer* s)
+{
+    if (!s || !s->rg) return;
+    __atomic_store_n(&s->rg->idle, 0, __ATOMIC_RELAXED);
+    uint64_t v;
+    if (read(s->cmd_efd, &v, sizeof(v)) < 0) { /* EAGAIN: không ai rung */ }
+}
@@ -0,0 +1,492 @@
+/**
+ * @file scenario_runner.c
+ * @brief Chạy song song các kịch bản kích thích (nhấn/thả nút, LED mong đợi,
+ *        ràng buộc thời gian) trên logic của gpio_daemon + chip sim, trong process.
+ *
+ * Mỗi lần chạy một scenario là một GpioDemoCore riêng (chip sim riêng), không
+ * socket, không /tmp/gpio_sim.sock -> chạy bao nhiêu cũng được cùng lúc.
+ * Thời gian là thời gian ảo: mỗi tick = step_ms của daemon (5 ms), không sleep,
+ * nên kết quả deterministic và thời gian chạy chỉ phụ thuộc CPU.
+ *
+ * Scheduler: mỗi worker (mặc định = số core) có một deque job riêng; worker lấy
+ * job ở đuôi deque của mình, hết thì đi "trộm" ở đầu deque của worker khác.
+ * Scenario dài/ngắn lẫn lộn vẫn cân tải, tổng thời gian ~ tổng công việc / số core.
+ *
+ * Format file kịch bản (một lệnh / dòng, '#' = comment, thời gian tính bằng ms):
+ *
+ *   scenario inc_twice [debounce=5] [leds=4]
+ *     0    press 0
+ *     30   release 0
+ *     60   press 0
+ *     90   release 0
+ *     90   expect leds 0 1 0 0 within 20    # LED0..3, phải đúng trong [90, 110] ms
+ *     200  expect count 2                   # đúng tại tick 200 ms
+ *
+ * Usage:
+ *   scenario_runner [-w workers] [-r repeat] [-j] [-v] file.scn [file2.scn ...]
+ * Exit code: 0 nếu mọi lần chạy pass, 1 nếu có fail, 2 nếu lỗi input.
+ */
+#define _GNU_SOURCE
+#include "bench_hist.h"
+#include "gpio_demo_core.h"
+
+#include <ctype.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define STEP_MS      5        /* chu kỳ poll của gpio_daemon */
+#define MAX_WORKERS  256
+#define MAX_STEPS    256
+#define FAIL_MSG_MAX 160
+
+typedef enum { SK_PRESS = 0, SK_RELEASE, SK_EXPECT_LEDS, SK_EXPECT_COUNT } StepKind;
+
+typedef struct {
+    uint32_t t_ms;
+    StepKind kind;
+    int      arg;        /* nút 0/1 */
+    unsigned value;      /* bitmap LED / count */
+    uint32_t within_ms;  /* expect: cửa sổ [t, t+within] */
+    int      line;       /* dòng trong file (báo lỗi) */
+} Step;
+
+typedef struct {
+    char     name[48];
+    char     file[64];
+    int      debounce_ms;
+    int      led_count;
+    Step     steps[MAX_STEPS];
+    int      nsteps;
+    uint32_t end_ms;     /* tick cuối cần chạy */
+} Scenario;
+
+/* kết quả theo scenario (mỗi worker một bản, gộp cuối) */
+typedef struct {
+    uint64_t runs, fails;
+    uint64_t wall_ns_sum, wall_ns_max;
+    char     first_fail[FAIL_MSG_MAX];
+} ScnStats;
+
+typedef struct {
+    pthread_mutex_t mtx;
+    uint32_t*       jobs;       /* job = scenario * repeat + rep */
+    int             head, tail; /* [head, tail) còn lại; chủ lấy ở tail, kẻ trộm lấy ở head */
+    /* thống kê riêng của worker, không cần khoá */
+    ScnStats*       st;
+    BenchHist       lat_ms;     /* độ trễ expect ... within (ms ảo) */
+    BenchHist       wall_ns;    /* thời gian thật mỗi lần chạy */
+    uint64_t        executed, stolen;
+    unsigned        rng;
+    int             id;
+} Worker;
+
+static Scenario* s_scn  = NULL;
+static int       s_nscn = 0;
+static int       s_repeat = 1;
+static Worker*   s_workers = NULL;
+static int       s_nworkers = 0;
+static int       s_verbose = 0;
+
+static uint64_t _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* ====== parser ====== */
+
+static char* _trim(char* s)
+{
+    while (isspace((unsigned char)*s)) s++;
+    char* e = s + strlen(s);
+    while (e > s && isspace((unsigned char)e[-1])) *--e = '\0';
+    return s;
+}
+
+static int _parse_step(Scenario* sc, char* rest, uint32_t t, int ln, const char* path)
+{
+    if (sc->nsteps >= MAX_STEPS) { fprintf(stderr, "%s:%d: too many steps\n", path, ln); return -1; }
+    Step* st = &sc->steps[sc->nsteps];
+    memset(st, 0, sizeof(*st));
+    st->t_ms = t;
+    st->line = ln;
+
+    char* tok = strtok(rest, " \t");
+    if (!tok) goto bad;
+    if (strcmp(tok, "press") == 0 || strcmp(tok, "release") == 0) {
+        st->kind = (tok[0] == 'p') ? SK_PRESS : SK_RELEASE;
+        char* a = strtok(NULL, " \t");
+        if (!a || (strcmp(a, "0") != 0 && strcmp(a, "1") != 0)) goto bad;
+        st->arg = atoi(a);
+    } else if (strcmp(tok, "expect") == 0) {
+        char* what = strtok(NULL, " \t");
+        if (!what) goto bad;
+        if (strcmp(what, "leds") == 0) {
+            st->kind = SK_EXPECT_LEDS;
+            for (int i = 0; i < sc->led_count; ++i) {
+                char* b = strtok(NULL, " \t");
+                if (!b || (b[0] != '0' && b[0] != '1') || b[1]) goto bad;
+                if (b[0] == '1') st->value |= 1u << i;
+            }
+        } else if (strcmp(what, "count") == 0) {
+            char* v = strtok(NULL, " \t");
+            if (!v) goto bad;
+            st->kind  = SK_EXPECT_COUNT;
+            st->value = (unsigned)strtoul(v, NULL, 0);
+        } else goto bad;
+        char* w = strtok(NULL, " \t");
+        if (w) {
+            char* ms = strtok(NULL, " \t");
+            if (strcmp(w, "within") != 0 || !ms) goto bad;
+            st->within_ms = (uint32_t)strtoul(ms, NULL, 0);
+        }
+    } else goto bad;
+
+    if (strtok(NULL, " \t")) goto bad;
+    uint32_t last = st->t_ms + st->within_ms;
+    if (last > sc->end_ms) sc->end_ms = last;
+    sc->nsteps++;
+    return 0;
+bad:
+    fprintf(stderr, "%s:%d: bad step\n", path, ln);
+    return -1;
+}
+
+static int _load_file(const char* path)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) { perror(path); return -1; }
+
+    const char* base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+
+    char buf[256];
+    int ln = 0, rc = 0;
+    Scenario* cur = NULL;
+    while (rc == 0 && fgets(buf, sizeof(buf), f)) {
+        ln++;
+        char* hash = strchr(buf, '#');
+        if (hash) *hash = '\0';
+        char* s = _trim(buf);
+        if (!*s) continue;
+
+        if (strncmp(s, "scenario", 8) == 0 && isspace((unsigned char)s[8])) {
+            Scenario* n = (Scenario*)realloc(s_scn, (size_t)(s_nscn + 1) * sizeof(Scenario));
+            if (!n) { rc = -1; break; }
+            s_scn = n;
+            cur = &s_scn[s_nscn++];
+            memset(cur, 0, sizeof(*cur));
+            cur->debounce_ms = 5;
+            cur->led_count   = 4;
+            snprintf(cur->file, sizeof(cur->file), "%s", base);
+            char* tok = strtok(s + 9, " \t");
+            snprintf(cur->name, sizeof(cur->name), "%s", tok ? tok : "?");
+            while ((tok = strtok(NULL, " \t")) != NULL) {
+                if      (strncmp(tok, "debounce=", 9) == 0) cur->debounce_ms = atoi(tok + 9);
+                else if (strncmp(tok, "leds=", 5) == 0)     cur->led_count   = atoi(tok + 5);
+                else { fprintf(stderr, "%s:%d: unknown option '%s'\n", path, ln, tok); rc = -1; }
+            }
+            if (cur->led_count < 1 || cur->led_count > GPIO_DEMO_MAX_LEDS) {
+                fprintf(stderr, "%s:%d: leds must be 1..%d\n", path, ln, GPIO_DEMO_MAX_LEDS);
+                rc = -1;
+            }
+            continue;
+        }
+
+        char* end = NULL;
+        unsigned long t = strtoul(s, &end, 10);
+        if (!cur || end == s || !isspace((unsigned char)*end)) {
+            fprintf(stderr, "%s:%d: expected 'scenario <name>' or '<t_ms> <step>'\n", path, ln);
+            rc = -1;
+            break;
+        }
+        if (cur->nsteps && t < cur->steps[cur->nsteps - 1].t_ms) {
+            fprintf(stderr, "%s:%d: steps must be in time order\n", path, ln);
+            rc = -1;
+            break;
+        }
+        rc = _parse_step(cur, end, (uint32_t)t, ln, path);
+    }
+    fclose(f);
+    return rc;
+}
+
+/* ====== chạy một scenario ====== */
+
+static int _check(GpioDemoCore* d, const Step* st, unsigned* got)
+{
+    *got = (st->kind == SK_EXPECT_LEDS) ? GpioDemoCore_GetLeds(d, NULL, 0) : d->count;
+    return *got == st->value;
+}
+
+/* 0 = pass; fail -> msg */
+static int _run_scenario(const Scenario* sc, int job, Worker* w, char* msg, size_t msg_len)
+{
+    GpioDemoCoreCfg cfg = {
+        .chip_name       = "sim:scenario",
+        .led_count       = sc->led_count,
+        .led_offsets     = {0, 1, 2, 3, 4, 5, 6, 7},
+        .leds_active_low = 0,
+        .btn0_offset     = 12,
+        .btn1_offset     = 13,
+        .btns_active_low = 0,
+        .debounce_ms     = sc->debounce_ms
+    };
+    GpioDemoCore d;
+    if (GpioDemoCore_Init(&d, &cfg) != 0) {
+        snprintf(msg, msg_len, "init failed");
+        return -1;
+    }
+
+    int next_stim = 0;     /* stimulus kế tiếp chưa áp */
+    int first_exp = 0;     /* mọi expect trước chỉ số này đã xong */
+    uint8_t done[MAX_STEPS] = {0};
+    int rc = 0;
+
+    for (uint32_t t = 0; t <= sc->end_ms && rc == 0; t += STEP_MS) {
+        /* 1) áp mọi stimulus tới hạn (trước tick, như client gửi PRESS giữa hai tick) */
+        for (; next_stim < sc->nsteps && sc->steps[next_stim].t_ms <= t; ++next_stim) {
+            const Step* st = &sc->steps[next_stim];
+            if (st->kind == SK_PRESS)   GpioDemoCore_SetButton(&d, st->arg, 1);
+            if (st->kind == SK_RELEASE) GpioDemoCore_SetButton(&d, st->arg, 0);
+        }
+
+        /* 2) một chu kỳ của daemon */
+        GpioDemoCore_Tick(&d, STEP_MS);
+
+        /* 3) kiểm các expect đang mở */
+        for (int i = first_exp; i < sc->nsteps && sc->steps[i].t_ms <= t; ++i) {
+            const Step* st = &sc->steps[i];
+            if (done[i] || st->kind == SK_PRESS || st->kind == SK_RELEASE) continue;
+            unsigned got = 0;
+            if (_check(&d, st, &got)) {
+                done[i] = 1;
+                if (st->within_ms) BenchHist_Record(&w->lat_ms, t - st->t_ms);
+            } else if (t >= st->t_ms + st->within_ms) {
+                if (st->kind == SK_EXPECT_LEDS)
+                    snprintf(msg, msg_len, "%s:%d: t=%u ms expect leds 0x%x, got 0x%x (job %d)",
+                             sc->file, st->line, t, st->value, got, job);
+                else
+                    snprintf(msg, msg_len, "%s:%d: t=%u ms expect count %u, got %u (job %d)",
+                             sc->file, st->line, t, st->value, got, job);
+                rc = -1;
+                break;
+            }
+        }
+        while (first_exp < sc->nsteps &&
+               (done[first_exp] || sc->steps[first_exp].kind <= SK_RELEASE) &&
+               sc->steps[first_exp].t_ms <= t) first_exp++;
+    }
+
+    GpioDemoCore_Deinit(&d);
+    return rc;
+}
+
+/* ====== work-stealing scheduler ====== */
+
+static int _pop_own(Worker* w, uint32_t* job)
+{
+    int ok = 0;
+    pthread_mutex_lock(&w->mtx);
+    if (w->tail > w->head) { *job = w->jobs[--w->tail]; ok = 1; }
+    pthread_mutex_unlock(&w->mtx);
+    return ok;
+}
+
+static int _steal(Worker* victim, uint32_t* job)
+{
+    int ok = 0;
+    if (pthread_mutex_trylock(&victim->mtx) != 0) return 0;   /* đang bận -> thử nạn nhân khác */
+    if (victim->tail > victim->head) { *job = victim->jobs[victim->head++]; ok = 1; }
+    pthread_mutex_unlock(&victim->mtx);
+    return ok;
+}
+
+/* hết job ở mọi deque? (không có job sinh thêm nên "rỗng hết" = xong) */
+static int _all_empty(void)
+{
+    for (int i = 0; i < s_nworkers; ++i) {
+        Worker* v = &s_workers[i];
+        pthread_mutex_lock(&v->mtx);
+        int empty = (v->tail <= v->head);
+        pthread_mutex_unlock(&v->mtx);
+        if (!empty) return 0;
+    }
+    return 1;
+}
+
+static int _next_job(Worker* w, uint32_t* job)
+{
+    if (_pop_own(w, job)) return 1;
+    for (;;) {
+        /* bắt đầu từ nạn nhân ngẫu nhiên để kẻ trộm không dồn vào worker 0 */
+        w->rng = w->rng * 1103515245u + 12345u;
+        int start = (int)((w->rng >> 8) % (unsigned)s_nworkers);
+        for (int k = 0; k < s_nworkers; ++k) {
+            Worker* v = &s_workers[(start + k) % s_nworkers];
+            if (v != w && _steal(v, job)) { w->stolen++; return 1; }
+        }
+        if (_all_empty()) return 0;
+    }
+}
+
+static void* _worker(void* arg)
+{
+    Worker* w = (Worker*)arg;
+    uint32_t job;
+    char msg[FAIL_MSG_MAX];
+    while (_next_job(w, &job)) {
+        int si = (int)(job / (uint32_t)s_repeat);
+        uint64_t t0 = _now_ns();
+        int rc = _run_scenario(&s_scn[si], (int)job, w, msg, sizeof(msg));
+        uint64_t dt = _now_ns() - t0;
+
+        ScnStats* st = &w->st[si];
+        st->runs++;
+        st->wall_ns_sum += dt;
+        if (dt > st->wall_ns_max) st->wall_ns_max = dt;
+        BenchHist_Record(&w->wall_ns, dt);
+        if (rc != 0) {
+            if (st->fails++ == 0) snprintf(st->first_fail, sizeof(st->first_fail), "%s", msg);
+            if (s_verbose) fprintf(stderr, "[SCN] FAIL %s\n", msg);
+        }
+        w->executed++;
+    }
+    return NULL;
+}
+
+/* ====== main ====== */
+
+static void _usage(const char* prog)
+{
+    fprintf(stderr,
+        "usage: %s [-w workers] [-r repeat] [-j] [-v] file.scn [...]\n"
+        "  -w N   worker threads (default: online cores)\n"
+        "  -r N   run every scenario N times (soak)\n"
+        "  -j     JSON summary on stdout\n"
+        "  -v     print every failure\n", prog);
+}
+
+int main(int argc, char** argv)
+{
+    int json = 0;
+    int opt;
+    s_nworkers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    while ((opt = getopt(argc, argv, "w:r:jvh")) != -1) {
+        switch (opt) {
+            case 'w': s_nworkers = atoi(optarg); break;
+            case 'r': s_repeat   = atoi(optarg); break;
+            case 'j': json = 1; break;
+            case 'v': s_verbose = 1; break;
+            default:  _usage(argv[0]); return 2;
+        }
+    }
+    if (optind >= argc || s_repeat < 1) { _usage(argv[0]); return 2; }
+    if (s_nworkers < 1) s_nworkers = 1;
+    if (s_nworkers > MAX_WORKERS) s_nworkers = MAX_WORKERS;
+
+    for (int i = optind; i < argc; ++i)
+        if (_load_file(argv[i]) != 0) return 2;
+    if (s_nscn == 0) { fprintf(stderr, "[SCN] no scenario\n"); return 2; }
+
+    uint64_t njobs = (uint64_t)s_nscn * (uint64_t)s_repeat;
+    if (njobs > 0xFFFFFFFFull) { fprintf(stderr, "[SCN] too many jobs\n"); return 2; }
+    if ((uint64_t)s_nworkers > njobs) s_nworkers = (int)njobs;
+
+    /* chia job round-robin: mỗi deque có đủ loại scenario, phần lệch tải do trộm bù */
+    s_workers = (Worker*)calloc((size_t)s_nworkers, sizeof(Worker));
+    if (!s_workers) return 2;
+    for (int i = 0; i < s_nworkers; ++i) {
+        Worker* w = &s_workers[i];
+        pthread_mutex_init(&w->mtx, NULL);
+        w->jobs = (uint32_t*)malloc((size_t)(njobs / (uint64_t)s_nworkers + 1) * sizeof(uint32_t));
+        w->st   = (ScnStats*)calloc((size_t)s_nscn, sizeof(ScnStats));
+        if (!w->jobs || !w->st) return 2;
+        BenchHist_Reset(&w->lat_ms);
+        BenchHist_Reset(&w->wall_ns);
+        w->rng = 0x9E3779B9u * (unsigned)(i + 1);
+        w->id  = i;
+    }
+    for (uint32_t j = 0; j < (uint32_t)njobs; ++j) {
+        Worker* w = &s_workers[j % (uint32_t)s_nworkers];
+        w->jobs[w->tail++] = j;
+    }
+
+    uint64_t t0 = _now_ns();
+    pthread_t th[MAX_WORKERS];
+    for (int i = 1; i < s_nworkers; ++i) pthread_create(&th[i], NULL, _worker, &s_workers[i]);
+    _worker(&s_workers[0]);                                  /* thread gọi cũng là worker */
+    for (int i = 1; i < s_nworkers; ++i) pthread_join(th[i], NULL);
+    double elapsed = (double)(_now_ns() - t0) / 1e9;
+
+    /* gộp kết quả */
+    ScnStats* tot = (ScnStats*)calloc((size_t)s_nscn, sizeof(ScnStats));
+    static BenchHist lat, wall;
+    BenchHist_Reset(&lat);
+    BenchHist_Reset(&wall);
+    uint64_t runs = 0, fails = 0, stolen = 0;
+    for (int i = 0; i < s_nworkers; ++i) {
+        Worker* w = &s_workers[i];
+        BenchHist_Merge(&lat, &w->lat_ms);
+        BenchHist_Merge(&wall, &w->wall_ns);
+        stolen += w->stolen;
+        for (int s = 0; s < s_nscn; ++s) {
+            ScnStats* a = &tot[s];
+            const ScnStats* b = &w->st[s];
+            if (!a->fails && b->fails) snprintf(a->first_fail, sizeof(a->first_fail), "%s", b->first_fail);
+            a->runs  += b->runs;
+            a->fails += b->fails;
+            a->wall_ns_sum += b->wall_ns_sum;
+            if (b->wall_ns_max > a->wall_ns_max) a->wall_ns_max = b->wall_ns_max;
+        }
+    }
+    for (int s = 0; s < s_nscn; ++s) { runs += tot[s].runs; fails += tot[s].fails; }
+
+    if (json) {
+        printf("{\"workers\":%d,\"runs\":%llu,\"fails\":%llu,\"stolen\":%llu,\"elapsed_s\":%.3f,\"scenarios\":[",
+               s_nworkers, (unsigned long long)runs, (unsigned long long)fails,
+               (unsigned long long)stolen, elapsed);
+        for (int s = 0; s < s_nscn; ++s) {
+            printf("%s{\"name\":\"%s\",\"file\":\"%s\",\"runs\":%llu,\"fails\":%llu,\"wall_us_mean\":%.1f,\"wall_us_max\":%.1f}",
+                   s ? "," : "", s_scn[s].name, s_scn[s].file,
+                   (unsigned long long)tot[s].runs, (unsigned long long)tot[s].fails,
+                   tot[s].runs ? (double)tot[s].wall_ns_sum / (double)tot[s].runs / 1e3 : 0.0,
+                   (double)tot[s].wall_ns_max / 1e3);
+        }
+        printf("],\"latency_ms\":");
+        BenchHist_PrintJson(stdout, &lat);
+        printf(",\"wall_ns\":");
+        BenchHist_PrintJson(stdout, &wall);
+        printf("}\n");
+    } else {
+        printf("%-24s %-16s %8s %8s %12s %12s\n", "scenario", "file", "runs", "fails", "mean(us)", "max(us)");
+        for (int s = 0; s < s_nscn; ++s) {
+            printf("%-24s %-16s %8llu %8llu %12.1f %12.1f\n", s_scn[s].name, s_scn[s].file,
+                   (unsigned long long)tot[s].runs, (unsigned long long)tot[s].fails,
+                   tot[s].runs ? (double)tot[s].wall_ns_sum / (double)tot[s].runs / 1e3 : 0.0,
+                   (double)tot[s].wall_ns_max / 1e3);
+            if (tot[s].fails) printf("    first failure: %s\n", tot[s].first_fail);
+        }
+        BenchHist_PrintSummary(stdout, "expect latency", &lat, 1.0, "ms");
+        BenchHist_PrintSummary(stdout, "run wall time ", &wall, 1000.0, "us");
+        printf("%llu run(s), %llu failed, %d worker(s), %llu stolen, %.3f s (%.0f runs/s)\n",
+               (unsigned long long)runs, (unsigned long long)fails, s_nworkers,
+               (unsigned long long)stolen, elapsed, elapsed > 0 ? (double)runs / elapsed : 0.0);
+    }
+
+    for (int i = 0; i < s_nworkers; ++i) {
+        pthread_mutex_destroy(&s_workers[i].mtx);
+        free(s_workers[i].jobs);
+        free(s_workers[i].st);
+    }
+    free(s_workers);
+    free(tot);
+    free(s_scn);
+    return fails ? 1 : 0;
+}